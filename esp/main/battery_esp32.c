@@ -7,6 +7,7 @@
 #include "ble/gatt-service/battery_service_server.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "loop_esp32.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -118,6 +119,6 @@ void battery_monitor_init(void)
     printf("[battery] Initial level: %d%%\n", pct);
 
     // Start background task
-    xTaskCreate(battery_task_fn, "battery", BATTERY_TASK_STACK_SIZE,
-                NULL, BATTERY_TASK_PRIORITY, NULL);
+    xTaskCreatePinnedToCore(battery_task_fn, "battery", BATTERY_TASK_STACK_SIZE,
+                            NULL, BATTERY_TASK_PRIORITY, NULL, LOOP_HOUSEKEEPING_CORE);
 }
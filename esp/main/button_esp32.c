@@ -2,10 +2,14 @@
 //
 // Implements the button.h API using ESP-IDF GPIO.
 // Same state machine as RP2040 button.c but using platform HAL.
+// Both edges wake the I/O loop; while a click, hold or bounce is still being
+// timed, button_task() asks the loop back for the moment it ends.
 
 #include "core/services/button/button.h"
 #include "platform/platform.h"
+#include "loop_esp32.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
 #include <stdio.h>
 
 // Button GPIO pin (can be overridden via Kconfig/compile definition)
@@ -47,6 +51,9 @@ static bool read_button_debounced(void)
         if (now - last_change_ms >= BUTTON_DEBOUNCE_MS) {
             last_raw_state = raw;
             last_change_ms = now;
+        } else {
+            // Settled on the other level inside the window; no edge will follow
+            loop_esp32_wake_in(BUTTON_DEBOUNCE_MS - (now - last_change_ms));
         }
     }
 
@@ -58,6 +65,19 @@ static uint32_t elapsed_ms_since(uint32_t since)
     return platform_time_ms() - since;
 }
 
+// Time left until since + ms, for loop_esp32_wake_in()
+static uint32_t ms_left(uint32_t since, uint32_t ms)
+{
+    uint32_t elapsed = elapsed_ms_since(since);
+    return elapsed < ms ? ms - elapsed : 0;
+}
+
+static void IRAM_ATTR button_isr(void* arg)
+{
+    (void)arg;
+    loop_esp32_wake(LOOP_WAKE_INPUT);
+}
+
 static button_event_t fire_event(button_event_t event)
 {
     if (event != BUTTON_EVENT_NONE) {
@@ -85,10 +105,18 @@ void button_init(void)
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_ENABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
     };
     gpio_config(&io_conf);
 
+    // ISR service may already be installed by the MAX3421E driver
+    esp_err_t isr_err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (isr_err == ESP_OK || isr_err == ESP_ERR_INVALID_STATE) {
+        gpio_isr_handler_add(BUTTON_USER_GPIO, button_isr, NULL);
+    } else {
+        printf("[button] ISR service install failed: %d\n", isr_err);
+    }
+
     state = STATE_IDLE;
     last_raw_state = false;
     last_change_ms = platform_time_ms();
@@ -184,6 +212,13 @@ button_event_t button_task(void)
             break;
     }
 
+    // Releases and presses arrive as edges; only timeouts need the loop back
+    if (state == STATE_PRESSED && !hold_event_fired) {
+        loop_esp32_wake_in(ms_left(press_time_ms, BUTTON_HOLD_MS));
+    } else if (state == STATE_WAIT_DOUBLE || state == STATE_WAIT_TRIPLE) {
+        loop_esp32_wake_in(ms_left(release_time_ms, BUTTON_DOUBLE_CLICK_MS));
+    }
+
     return event;
 }
 
@@ -12,6 +12,7 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "loop_esp32.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -56,8 +57,8 @@ static void display_task_fn(void *arg)
 static void display_start_task(void)
 {
     display_set_async(true);
-    xTaskCreate(display_task_fn, "display", DISPLAY_TASK_STACK_SIZE,
-                NULL, DISPLAY_TASK_PRIORITY, NULL);
+    xTaskCreatePinnedToCore(display_task_fn, "display", DISPLAY_TASK_STACK_SIZE,
+                            NULL, DISPLAY_TASK_PRIORITY, NULL, LOOP_HOUSEKEEPING_CORE);
     printf("[display] Background flush task started\n");
 }
 
@@ -7,6 +7,14 @@
 // box-downsamples 2x2, so edges come out anti-aliased and the accent class
 // (Taby's red mouth) blends properly. Only built for the LilyGo board (see
 // main/CMakeLists.txt), which sets EYES_SCALE.
+//
+// Damage tracking: display_pixel() marks the DMG_TILE-square canvas tiles it
+// writes. A tile can only differ from what the panel shows if it was drawn
+// this frame or last frame (display_clear() only wipes last frame's tiles;
+// the rest of the canvas is already black). Those candidates are checksummed
+// and the ones whose content changed are merged into rects and re-sent via
+// amoled_blit_idx8_rects(), so a frame where only the pupils moved pushes
+// just the pupils.
 #ifdef BOARD_LILYGO_TDISPLAY_S3_AMOLED
 
 #include <stdint.h>
@@ -18,6 +26,7 @@
 #include "platform/platform.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "loop_esp32.h"
 #include "esp_heap_caps.h"
 #include "esp_log.h"
 
@@ -30,8 +39,36 @@
 static uint8_t* s_fb = NULL;
 static uint8_t s_color = FACE_COLOR_MAIN;
 
+// Damage tiles: one bit per tile column, one word per tile row.
+#define DMG_TILE      32
+#define DMG_COLS      ((EYES_W + DMG_TILE - 1) / DMG_TILE)     // 24
+#define DMG_ROWS      ((EYES_H + DMG_TILE - 1) / DMG_TILE)     // 11
+#define DMG_MAX_RECTS 24
+static uint32_t s_drawn[DMG_ROWS];        // tiles written this frame
+static uint32_t s_prev_drawn[DMG_ROWS];   // tiles written last frame
+static uint32_t s_tile_sum[DMG_ROWS][DMG_COLS];   // content as last sent
+static bool s_full = true;                // next flush sends everything
+
 // --- display.h backend ---
-void display_clear(void) { if (s_fb) memset(s_fb, 0, (size_t)EYES_W * EYES_H); }
+void display_clear(void)
+{
+    if (!s_fb) return;
+    // Only last frame's tiles hold pixels; wipe those column strips.
+    for (int ty = 0; ty < DMG_ROWS; ty++) {
+        uint32_t bits = s_drawn[ty];
+        int y0 = ty * DMG_TILE;
+        int n = (y0 + DMG_TILE <= EYES_H) ? DMG_TILE : EYES_H - y0;
+        while (bits) {
+            int tx = __builtin_ctz(bits);
+            bits &= bits - 1;
+            int x1 = (tx + 1) * DMG_TILE < EYES_W ? (tx + 1) * DMG_TILE : EYES_W;
+            for (int x = tx * DMG_TILE; x < x1; x++)
+                memset(&s_fb[(size_t)x * EYES_H + y0], 0, n);
+        }
+        s_prev_drawn[ty] = s_drawn[ty];
+        s_drawn[ty] = 0;
+    }
+}
 
 void display_set_color(uint8_t color_index) { s_color = color_index; }
 
@@ -39,6 +76,84 @@ void display_pixel(int16_t x, int16_t y, bool on)
 {
     if (!s_fb || (unsigned)x >= EYES_W || (unsigned)y >= EYES_H) return;
     s_fb[(size_t)x * EYES_H + y] = on ? s_color : 0;   // column-major (blit-friendly)
+    s_drawn[y / DMG_TILE] |= 1u << (x / DMG_TILE);
+}
+
+// Checksum of one tile (column strips are word aligned: EYES_H % 4 == 0)
+static uint32_t tile_sum(int tx, int ty)
+{
+    int y0 = ty * DMG_TILE;
+    int n = ((y0 + DMG_TILE <= EYES_H) ? DMG_TILE : EYES_H - y0) / 4;
+    int x1 = (tx + 1) * DMG_TILE < EYES_W ? (tx + 1) * DMG_TILE : EYES_W;
+    uint32_t h = 2166136261u;
+    for (int x = tx * DMG_TILE; x < x1; x++) {
+        const uint32_t* p = (const uint32_t*)&s_fb[(size_t)x * EYES_H + y0];
+        for (int i = 0; i < n; i++) h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Push the tiles that changed since the last flush
+static void eyes_flush(uint16_t main565, uint16_t accent565)
+{
+    uint32_t dirty[DMG_ROWS];
+    int tiles = 0;
+    for (int ty = 0; ty < DMG_ROWS; ty++) {
+        uint32_t bits = s_full ? (1u << DMG_COLS) - 1 : s_drawn[ty] | s_prev_drawn[ty];
+        dirty[ty] = 0;
+        while (bits) {
+            int tx = __builtin_ctz(bits);
+            bits &= bits - 1;
+            uint32_t sum = tile_sum(tx, ty);
+            if (s_full || sum != s_tile_sum[ty][tx]) {
+                s_tile_sum[ty][tx] = sum;
+                dirty[ty] |= 1u << tx;
+                tiles++;
+            }
+        }
+    }
+
+    // Most of the face moved (or first frame): one pipelined full blit
+    // beats many small windows.
+    if (s_full || tiles * 2 > DMG_ROWS * DMG_COLS) {
+        amoled_blit_idx8(s_fb, EYES_W, EYES_H, main565, accent565);
+        s_full = false;
+        return;
+    }
+
+    // Runs of dirty tiles per tile row, merged down while the run repeats
+    amoled_rect_t rects[DMG_MAX_RECTS];
+    int n = 0;
+    for (int ty = 0; ty < DMG_ROWS; ty++) {
+        uint32_t bits = dirty[ty];
+        while (bits) {
+            int tx0 = __builtin_ctz(bits);
+            int tx1 = tx0;
+            while (tx1 + 1 < DMG_COLS && (bits & (1u << (tx1 + 1)))) tx1++;
+            bits &= ~(((1u << (tx1 - tx0 + 1)) - 1) << tx0);
+
+            uint16_t x = (uint16_t)(tx0 * DMG_TILE);
+            uint16_t w = (uint16_t)(((tx1 + 1) * DMG_TILE < EYES_W ? (tx1 + 1) * DMG_TILE : EYES_W) - x);
+            uint16_t y = (uint16_t)(ty * DMG_TILE);
+            uint16_t h = (uint16_t)(y + DMG_TILE <= EYES_H ? DMG_TILE : EYES_H - y);
+            int m = n - 1;
+            while (m >= 0 && !(rects[m].x == x && rects[m].w == w && rects[m].y + rects[m].h == y)) m--;
+            if (m >= 0) {
+                rects[m].h += h;
+            } else if (n < DMG_MAX_RECTS) {
+                rects[n++] = (amoled_rect_t){ x, y, w, h };
+            } else {
+                // Out of rects: grow the last one over this run too
+                amoled_rect_t* r = &rects[n - 1];
+                uint16_t rx0 = r->x < x ? r->x : x;
+                uint16_t rx1 = r->x + r->w > x + w ? r->x + r->w : x + w;
+                r->x = rx0; r->w = rx1 - rx0;
+                r->h = y + h - r->y;
+            }
+        }
+    }
+    // Even with nothing dirty: a new palette or shift is a full blit there
+    amoled_blit_idx8_rects(s_fb, EYES_W, EYES_H, main565, accent565, rects, n);
 }
 
 // Per-style main + accent colors (RGB565).
@@ -153,6 +268,7 @@ static void eyes_task(void* arg)
         vTaskDelete(NULL);
         return;
     }
+    memset(s_fb, 0, (size_t)EYES_W * EYES_H);
 
     face_init(EYES_W, EYES_H);
     face_set_style(FACE_STYLE_TABY);
@@ -191,9 +307,7 @@ static void eyes_task(void* arg)
         static uint8_t idle_skip = 0;
         if (!face_settled() || (++idle_skip & 7) == 0) {
             face_render();
-            amoled_blit_idx8(s_fb, EYES_W, EYES_H,
-                             style_color(face_get_style()),
-                             style_accent(face_get_style()));
+            eyes_flush(style_color(face_get_style()), style_accent(face_get_style()));
         }
         vTaskDelay(pdMS_TO_TICKS(10));
     }
@@ -201,7 +315,7 @@ static void eyes_task(void* arg)
 
 void eyes_start(void)
 {
-    xTaskCreate(eyes_task, "eyes", 8192, NULL, 3, NULL);
+    xTaskCreatePinnedToCore(eyes_task, "eyes", 8192, NULL, 3, NULL, LOOP_HOUSEKEEPING_CORE);
 }
 
 #endif // BOARD_LILYGO_TDISPLAY_S3_AMOLED
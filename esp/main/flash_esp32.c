@@ -132,9 +132,11 @@ void flash_task(void)
 {
     if (!save_pending) return;
 
-    uint32_t now = platform_time_ms();
-    if (now - last_change_ms >= SAVE_DEBOUNCE_MS) {
+    uint32_t waited = platform_time_ms() - last_change_ms;
+    if (waited >= SAVE_DEBOUNCE_MS) {
         flash_save_now(&pending_settings);
+    } else {
+        platform_loop_wake_in(SAVE_DEBOUNCE_MS - waited);
     }
 }
 
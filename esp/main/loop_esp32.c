@@ -0,0 +1,131 @@
+// loop_esp32.c - Event-driven main loop for ESP32-S3
+//
+// Wake requests come from other tasks (BTstack), other cores and ISRs
+// (USB, MAX3421E), so the pending timestamp is guarded by a spinlock that
+// works in all three contexts. Everything here that an ISR can reach is
+// in IRAM.
+
+#include "loop_esp32.h"
+#include "core/loop_stats.h"
+#include "platform/platform.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include <stdbool.h>
+
+static TaskHandle_t loop_task = NULL;
+static portMUX_TYPE loop_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Time of the first wake since the last serviced pass
+static int64_t wake_stamp_us = 0;
+static bool wake_stamped = false;
+
+// Soonest loop_esp32_wake_in() deadline since the last wait (esp_timer us).
+// Only the loop task touches it.
+static int64_t due_us = 0;
+static bool due_set = false;
+
+void loop_esp32_bind(void)
+{
+    loop_task = xTaskGetCurrentTaskHandle();
+}
+
+void IRAM_ATTR loop_esp32_wake(uint32_t sources)
+{
+    portENTER_CRITICAL_SAFE(&loop_mux);
+    if (!wake_stamped) {
+        wake_stamp_us = esp_timer_get_time();
+        wake_stamped = true;
+    }
+    portEXIT_CRITICAL_SAFE(&loop_mux);
+
+    if (!loop_task) return;
+
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(loop_task, sources, eSetBits, &woken);
+        if (woken) portYIELD_FROM_ISR();
+    } else {
+        xTaskNotify(loop_task, sources, eSetBits);
+    }
+}
+
+void loop_esp32_wake_in(uint32_t ms)
+{
+    int64_t due = esp_timer_get_time() + (int64_t)ms * 1000;
+    if (!due_set || due < due_us) {
+        due_us = due;
+        due_set = true;
+    }
+}
+
+uint32_t loop_esp32_wait(void)
+{
+#if LOOP_EVENT_DRIVEN
+    uint32_t wait_ms = LOOP_IDLE_MS;
+    if (due_set) {
+        int64_t left_us = due_us - esp_timer_get_time();
+        if (left_us <= 0) {
+            wait_ms = 0;
+        } else if (left_us < (int64_t)wait_ms * 1000) {
+            wait_ms = (uint32_t)((left_us + 999) / 1000);
+        }
+        due_set = false;
+    }
+
+    // A wait of 0 ticks only collects bits that are already pending
+    uint32_t sources = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &sources, pdMS_TO_TICKS(wait_ms));
+    return sources;
+#else
+    vTaskDelay(1);
+    return 0;
+#endif
+}
+
+void loop_esp32_serviced(void)
+{
+    int64_t stamp = 0;
+    bool stamped;
+
+    portENTER_CRITICAL(&loop_mux);
+    stamped = wake_stamped;
+    if (stamped) {
+        stamp = wake_stamp_us;
+        wake_stamped = false;
+    }
+    portEXIT_CRITICAL(&loop_mux);
+
+    if (stamped) {
+        loop_stats_record((uint32_t)(esp_timer_get_time() - stamp));
+    }
+}
+
+// ============================================================================
+// WAKE HOOKS
+// ============================================================================
+
+void platform_loop_wake(void)
+{
+    loop_esp32_wake(LOOP_WAKE_INPUT);
+}
+
+void platform_loop_wake_in(uint32_t ms)
+{
+    loop_esp32_wake_in(ms);
+}
+
+// TinyUSB calls these whenever it queues an event for tud_task/tuh_task,
+// usually from the USB ISR
+void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr)
+{
+    (void)rhport; (void)eventid; (void)in_isr;
+    loop_esp32_wake(LOOP_WAKE_USBD);
+}
+
+void tuh_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr)
+{
+    (void)rhport; (void)eventid; (void)in_isr;
+    loop_esp32_wake(LOOP_WAKE_USBH);
+}
@@ -0,0 +1,59 @@
+// loop_esp32.h - Event-driven main loop for ESP32-S3
+//
+// The input→output loop runs in one high-priority task pinned to
+// LOOP_IO_CORE and blocks on its task notification between passes. Input
+// arrival (router, incl. BTstack), TinyUSB device/host events, the
+// MAX3421E interrupt and the user button each set a wake bit. There is no
+// fixed tick: work due at a time rather than on an event asks for its next
+// pass with loop_esp32_wake_in() / platform_loop_wake_in(), and the wait
+// times out at the soonest request, or after LOOP_IDLE_MS with nothing due.
+// LEDs and storage run at the end of each pass; the display, eyes and
+// battery tasks run at low priority on the other core.
+
+#ifndef LOOP_ESP32_H
+#define LOOP_ESP32_H
+
+#include <stdint.h>
+
+// Core assignment. BTstack/VHCI and the USB interrupt stay on core 0 with
+// the display/eyes/battery tasks; the I/O loop gets core 1 to itself.
+#define LOOP_IO_CORE            1
+#define LOOP_HOUSEKEEPING_CORE  0
+
+// Longest sleep with no event and nothing due. Only a backstop for polled
+// timers that don't ask for a pass (player and hotkey timeouts, app
+// housekeeping); everything with a deadline calls loop_esp32_wake_in().
+#define LOOP_IDLE_MS            100
+
+// Set to 0 to fall back to the old vTaskDelay(1) polling loop (the latency
+// histogram still records, for before/after comparison)
+#ifndef LOOP_EVENT_DRIVEN
+#define LOOP_EVENT_DRIVEN       1
+#endif
+
+// Wake sources (task notification bits)
+#define LOOP_WAKE_INPUT     (1u << 0)   // Router input (BTstack, USB host, native)
+#define LOOP_WAKE_USBD      (1u << 1)   // TinyUSB device event
+#define LOOP_WAKE_USBH      (1u << 2)   // TinyUSB host event
+#define LOOP_WAKE_MAX3421   (1u << 3)   // MAX3421E INT pin
+
+// Bind the calling task as the loop task (call once from it)
+void loop_esp32_bind(void);
+
+// Request a loop pass. Safe from any task, any core, and from IRAM ISRs.
+void loop_esp32_wake(uint32_t sources);
+
+// Ask for a pass within ms, event or not. One-shot: the soonest request
+// since the last wait wins, and work that stays due asks again each pass.
+// Loop task only; other tasks and ISRs use loop_esp32_wake().
+void loop_esp32_wake_in(uint32_t ms);
+
+// Block until woken, the soonest loop_esp32_wake_in() request is due, or
+// LOOP_IDLE_MS elapses. Returns the wake bits (0 = timeout).
+uint32_t loop_esp32_wait(void);
+
+// Mark the end of a pass that ran the outputs: records wake-to-service
+// latency into the shared loop_stats histogram.
+void loop_esp32_serviced(void);
+
+#endif // LOOP_ESP32_H
@@ -2,7 +2,10 @@
 //
 // FreeRTOS entry point for Joypad apps on ESP32-S3.
 // BTstack runs in its own FreeRTOS task (created by btstack_run_loop_freertos).
-// Main task handles USB device, app logic, LED, and storage.
+// app_main initializes everything, then hands off to the "io" task: inputs,
+// USB, outputs, app logic, LEDs and storage. High priority, pinned to
+// LOOP_IO_CORE, event-driven (see loop_esp32.h). LED and settings state is
+// written from app and CDC code on this task, so it is serviced here too.
 
 #include <stdio.h>
 #include <string.h>
@@ -20,6 +23,7 @@
 #include "core/services/players/manager.h"
 #include "core/services/leds/leds.h"
 #include "core/services/storage/storage.h"
+#include "loop_esp32.h"
 
 static const char *TAG = "joypad";
 
@@ -43,6 +47,9 @@ static uint8_t input_count = 0;
 const OutputInterface* active_output = NULL;
 const OutputInterface* native_output = NULL;
 
+#define IO_TASK_STACK_SIZE              16384
+#define IO_TASK_PRIORITY                (configMAX_PRIORITIES - 3)  // Below BTstack
+
 // Redirect stdout/stderr to UART1 on header TX/RX pins.
 // ESP-IDF console UART0 custom pin remapping doesn't work reliably on ESP32-S3
 // when USB OTG owns the default UART0 pins, so we use UART1 explicitly.
@@ -78,6 +85,55 @@ static void uart1_console_init(void)
 }
 #endif
 
+// Input → router → output. Runs a pass whenever an event arrives (input,
+// USB, MAX3421E interrupt, user button), when a task's loop_esp32_wake_in()
+// request is due, and at least every LOOP_IDLE_MS.
+static void io_task(void* arg)
+{
+    (void)arg;
+    loop_esp32_bind();
+
+    while (1) {
+#ifdef CONFIG_MAX3421
+        // Process deferred MAX3421E interrupts from task context.
+        // Cannot call hcd_int_handler from ISR — TinyUSB code is in flash, not IRAM.
+        max3421_poll();
+#endif
+
+        players_task();
+
+        // Poll input interfaces
+        for (uint8_t i = 0; i < input_count; i++) {
+            if (inputs[i] && inputs[i]->task) {
+                inputs[i]->task();
+            }
+        }
+
+        // Flush CDC streaming data immediately after input polling
+        // (don't wait for output task's tud_task_ext call)
+        tud_task_ext(0, false);
+
+        // Run output interface tasks
+        for (uint8_t i = 0; i < output_count; i++) {
+            if (outputs[i] && outputs[i]->task) {
+                outputs[i]->task();
+            }
+        }
+
+        app_task();
+
+        loop_esp32_serviced();
+
+        // LEDs and debounced flash writes, after the latency stamp. They
+        // share state with flash_save()/leds_set_*() callers on this task,
+        // so they must not move to another core.
+        leds_task();
+        storage_task();
+
+        loop_esp32_wait();
+    }
+}
+
 void app_main(void)
 {
 #ifdef BOARD_FEATHER_ESP32S3
@@ -174,41 +230,8 @@ void app_main(void)
     // Publish active interfaces so shared code (CDC, router) can introspect.
     app_registry_set(inputs, input_count, outputs, output_count);
 
-    ESP_LOGI(TAG, "Entering main loop");
-
-    // Main loop
-    while (1) {
-        leds_task();
-        players_task();
-        storage_task();
-
-        // Poll input interfaces
-        for (uint8_t i = 0; i < input_count; i++) {
-            if (inputs[i] && inputs[i]->task) {
-                inputs[i]->task();
-            }
-        }
-
-        // Flush CDC streaming data immediately after input polling
-        // (don't wait for output task's tud_task_ext call)
-        tud_task_ext(0, false);
-
-        // Run output interface tasks
-        for (uint8_t i = 0; i < output_count; i++) {
-            if (outputs[i] && outputs[i]->task) {
-                outputs[i]->task();
-            }
-        }
-
-        app_task();
-
-#ifdef CONFIG_MAX3421
-        // Process deferred MAX3421E interrupts from main loop context.
-        // Cannot call hcd_int_handler from ISR — TinyUSB code is in flash, not IRAM.
-        max3421_poll();
-#endif
-
-        // Yield to other FreeRTOS tasks (BTstack runs in its own task)
-        vTaskDelay(1);
-    }
+    ESP_LOGI(TAG, "Starting I/O loop on core %d", LOOP_IO_CORE);
+    xTaskCreatePinnedToCore(io_task, "io", IO_TASK_STACK_SIZE,
+                            NULL, IO_TASK_PRIORITY, NULL, LOOP_IO_CORE);
+    // app_main returns; its task is deleted and the stack freed
 }
@@ -18,6 +18,7 @@
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
 #include "esp_attr.h"
+#include "loop_esp32.h"
 #include <stdio.h>
 
 // ============================================================================
@@ -121,7 +122,7 @@ void tuh_max3421_int_api(uint8_t rhport, bool enabled)
 // GPIO INTERRUPT HANDLER
 // ============================================================================
 
-// GPIO ISR: just set flag, defer hcd_int_handler to main loop.
+// GPIO ISR: just set flag and wake the I/O loop, which runs hcd_int_handler.
 // On ESP32, hcd_int_handler and all TinyUSB code is in flash (not IRAM),
 // so calling it from ISR context crashes on flash cache miss.
 static void IRAM_ATTR max3421_int_isr(void *arg)
@@ -129,6 +130,7 @@ static void IRAM_ATTR max3421_int_isr(void *arg)
     (void)arg;
     isr_count++;
     int_pending = true;
+    loop_esp32_wake(LOOP_WAKE_MAX3421);
 }
 
 // Called from main loop to process deferred MAX3421E interrupt
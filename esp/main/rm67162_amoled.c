@@ -215,28 +215,42 @@ void amoled_blit_mono(const uint8_t* mono, int w, int h, uint16_t color)
     }
 }
 
-void amoled_blit_idx8(const uint8_t* fb, int w, int h,
-                      uint16_t main565, uint16_t accent565)
+// ---- idx8 blits (full frame and damage rects) ----
+
+// Geometry LUTs (panel row -> canvas col, panel col -> canvas row).
+static uint16_t s_xlut[AMOLED_H];
+static uint16_t s_ylut[AMOLED_W];
+static int s_lut_w = 0, s_lut_h = 0;
+
+// Color LUT: index = main_count*65 + accent_weight. Each of the 4 sampled
+// canvas pixels contributes 16 sixteenths of main (class 1) or 16..1
+// sixteenths of accent (classes 2..17 — the FACE_COLOR_ACCENT_LVL ramp),
+// so accent_weight spans 0..64. Blends black -> main/accent
+// proportionally, output byte-swapped RGB565.
+static uint16_t s_clut[5 * 65];
+static uint16_t s_cm = 0, s_ca = 0;
+static bool s_clut_ready = false;
+static uint8_t s_awq[32];   // class -> accent sixteenths: class 2 = 16 (full) down to class 17 = 1
+
+// Canvas column cache in internal SRAM. Adjacent panel rows sample the same
+// or neighbouring canvas columns, so each PSRAM column is copied in once
+// (one burst) and the 2x2 sampling reads hit internal RAM.
+#define COL_CACHE_SLOTS 4
+static uint8_t* s_cols = NULL;
+static int s_cols_h = 0;
+static int s_col_tag[COL_CACHE_SLOTS];
+static int s_col_lo, s_col_n;      // canvas rows held per column
+
+static int s_blit_shift = 0x7FFF;  // shift the panel last got a full frame at
+
+static void idx8_prepare(int w, int h, uint16_t main565, uint16_t accent565)
 {
-    if (!s_io || !s_band) return;
-    // Geometry LUTs (panel row -> canvas col, panel col -> canvas row).
-    static uint16_t xlut[AMOLED_H];
-    static uint16_t ylut[AMOLED_W];
-    static int lut_w = 0, lut_h = 0;
-    if (lut_w != w || lut_h != h) {
-        for (int py = 0; py < AMOLED_H; py++) xlut[py] = (uint16_t)((py * w) / AMOLED_H);
-        for (int px = 0; px < AMOLED_W; px++) ylut[px] = (uint16_t)((px * h) / AMOLED_W);
-        lut_w = w; lut_h = h;
+    if (s_lut_w != w || s_lut_h != h) {
+        for (int py = 0; py < AMOLED_H; py++) s_xlut[py] = (uint16_t)((py * w) / AMOLED_H);
+        for (int px = 0; px < AMOLED_W; px++) s_ylut[px] = (uint16_t)((px * h) / AMOLED_W);
+        s_lut_w = w; s_lut_h = h;
     }
-    // Color LUT: index = main_count*65 + accent_weight. Each of the 4 sampled
-    // canvas pixels contributes 16 sixteenths of main (class 1) or 16..1
-    // sixteenths of accent (classes 2..17 — the FACE_COLOR_ACCENT_LVL ramp),
-    // so accent_weight spans 0..64. Blends black -> main/accent
-    // proportionally, output byte-swapped RGB565.
-    static uint16_t clut[5 * 65];
-    static uint16_t cm = 0, ca = 0;
-    static bool clut_ready = false;
-    if (!clut_ready || cm != main565 || ca != accent565) {
+    if (!s_clut_ready || s_cm != main565 || s_ca != accent565) {
         int mr = (main565 >> 11) & 31, mg = (main565 >> 5) & 63, mb = main565 & 31;
         int ar = (accent565 >> 11) & 31, ag = (accent565 >> 5) & 63, ab = accent565 & 31;
         for (int cw = 0; cw <= 4; cw++) {
@@ -254,57 +268,136 @@ void amoled_blit_idx8(const uint8_t* fb, int w, int h,
                 if (g > 63) g = 63;
                 if (b > 31) b = 31;
                 uint16_t v = (uint16_t)((r << 11) | (g << 5) | b);
-                clut[cw * 65 + aw] = (uint16_t)((v >> 8) | (v << 8));
+                s_clut[cw * 65 + aw] = (uint16_t)((v >> 8) | (v << 8));
             }
         }
-        cm = main565; ca = accent565; clut_ready = true;
+        for (int i = 0; i < 32; i++)
+            s_awq[i] = (i >= 2 && i <= 17) ? (uint8_t)(18 - i) : 0;
+        s_cm = main565; s_ca = accent565; s_clut_ready = true;
+    }
+    if (s_cols_h != h) {
+        heap_caps_free(s_cols);
+        s_cols = heap_caps_malloc((size_t)COL_CACHE_SLOTS * h, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        s_cols_h = s_cols ? h : 0;
+    }
+}
+
+// Start a blit that samples canvas rows lo..hi: drop cached columns.
+static void col_cache_reset(int lo, int hi)
+{
+    for (int i = 0; i < COL_CACHE_SLOTS; i++) s_col_tag[i] = -1;
+    s_col_lo = lo;
+    s_col_n = hi - lo + 1;
+}
+
+// Canvas column ex, indexed from row s_col_lo. Falls back to reading PSRAM
+// directly if the cache couldn't be allocated.
+static const uint8_t* col_fetch(const uint8_t* fb, int h, int ex)
+{
+    if (!s_cols) return fb + (size_t)ex * h + s_col_lo;
+    int slot = ex & (COL_CACHE_SLOTS - 1);
+    uint8_t* c = s_cols + (size_t)slot * h;
+    if (s_col_tag[slot] != ex) {
+        memcpy(c, fb + (size_t)ex * h + s_col_lo, s_col_n);
+        s_col_tag[slot] = ex;
+    }
+    return c;
+}
+
+// Convert panel columns px0..px1 of one panel row (canvas column ex) into
+// out. Canvas is column-major (x*h + y), so both sampled columns are walked
+// sequentially as px advances.
+static void idx8_row(uint16_t* out, const uint8_t* fb, int w, int h, int ex, int px0, int px1)
+{
+    if (ex < 0 || ex >= w) {                  // shifted past the canvas: black row
+        memset(out, 0, (size_t)(px1 - px0 + 1) * 2);
+        return;
     }
-    // class -> accent sixteenths: class 2 = 16 (full) down to class 17 = 1
-    static uint8_t awq[32];
-    for (int i = 0; i < 32; i++)
-        awq[i] = (i >= 2 && i <= 17) ? (uint8_t)(18 - i) : 0;
-
-    // Pipelined: one window for the whole frame, first band as RAMWR (0x2C),
-    // the rest as memory-write-continue (0x3C). While one band buffer is in
-    // DMA flight, the other is being filled — compute overlaps transfer.
-    set_window(0, 0, AMOLED_W - 1, AMOLED_H - 1);
+    int ex2 = (ex + 1 < w) ? ex + 1 : ex;
+    const uint8_t* c0 = col_fetch(fb, h, ex);
+    const uint8_t* c1 = col_fetch(fb, h, ex2);
+    for (int px = px0; px <= px1; px++) {
+        int ey = s_ylut[px];
+        int ey2 = ((ey + 1 < h) ? ey + 1 : ey) - s_col_lo;
+        ey -= s_col_lo;
+        uint8_t v0 = c0[ey];
+        uint8_t v1 = c1[ey];
+        uint8_t v2 = c0[ey2];
+        uint8_t v3 = c1[ey2];
+        int cw = (v0 == 1) + (v1 == 1) + (v2 == 1) + (v3 == 1);
+        int aw = s_awq[v0 & 31] + s_awq[v1 & 31] + s_awq[v2 & 31] + s_awq[v3 & 31];
+        *out++ = s_clut[cw * 65 + aw];
+    }
+}
+
+// Send panel window (px0..px1, py0..py1) in bands. One window, first band as
+// RAMWR (0x2C), the rest as memory-write-continue (0x3C). While one band
+// buffer is in DMA flight, the other is being filled — compute overlaps
+// transfer.
+static void idx8_window(const uint8_t* fb, int w, int h, int px0, int py0, int px1, int py1)
+{
+    int cols = px1 - px0 + 1;
+    int band_rows = (AMOLED_W * BAND_ROWS) / cols;
+    int cshift = (s_face_shift * w) / AMOLED_H;   // panel px -> canvas px
     uint16_t* bufs[2] = { s_band, s_band2 };
     int cur = 0, pending = 0;
     bool first = true;
-    for (uint16_t y = 0; y < AMOLED_H; y += BAND_ROWS) {
-        uint16_t rows = (y + BAND_ROWS <= AMOLED_H) ? BAND_ROWS : (AMOLED_H - y);
+
+    col_cache_reset(s_ylut[px0], (s_ylut[px1] + 1 < h) ? s_ylut[px1] + 1 : s_ylut[px1]);
+    set_window(px0, py0, px1, py1);
+    for (int y = py0; y <= py1; y += band_rows) {
+        int rows = (y + band_rows <= py1 + 1) ? band_rows : (py1 + 1 - y);
         uint16_t* band = bufs[cur];
-        int cshift = (s_face_shift * w) / AMOLED_H;   // panel px -> canvas px
-        for (uint16_t r = 0; r < rows; r++) {
-            int ex = xlut[y + r] + cshift;
-            if (ex < 0 || ex >= w) {                  // shifted past the canvas: black row
-                memset(&band[r * AMOLED_W], 0, AMOLED_W * 2);
-                continue;
-            }
-            int ex2 = (ex + 1 < w) ? ex + 1 : ex;
-            // Canvas is column-major (x*h + y): both sampled columns are
-            // walked sequentially as px advances — cache-friendly in PSRAM.
-            const uint8_t* c0 = fb + (size_t)ex  * h;
-            const uint8_t* c1 = fb + (size_t)ex2 * h;
-            uint16_t* out = &band[r * AMOLED_W];
-            for (uint16_t px = 0; px < AMOLED_W; px++) {
-                int ey = ylut[px];
-                int ey2 = (ey + 1 < h) ? ey + 1 : ey;
-                uint8_t v0 = c0[ey];
-                uint8_t v1 = c1[ey];
-                uint8_t v2 = c0[ey2];
-                uint8_t v3 = c1[ey2];
-                int cw = (v0 == 1) + (v1 == 1) + (v2 == 1) + (v3 == 1);
-                int aw = awq[v0 & 31] + awq[v1 & 31] + awq[v2 & 31] + awq[v3 & 31];
-                out[px] = clut[cw * 65 + aw];
-            }
-        }
+        // Both bands in flight: this one is the older, wait it out first
         if (pending == 2) { xSemaphoreTake(s_done, portMAX_DELAY); pending--; }
-        esp_lcd_panel_io_tx_color(s_io, first ? 0x2C : 0x3C, band,
-                                  (size_t)AMOLED_W * rows * 2);
+        for (int r = 0; r < rows; r++)
+            idx8_row(&band[r * cols], fb, w, h, s_xlut[y + r] + cshift, px0, px1);
+        esp_lcd_panel_io_tx_color(s_io, first ? 0x2C : 0x3C, band, (size_t)cols * rows * 2);
         pending++; first = false; cur ^= 1;
     }
     while (pending) { xSemaphoreTake(s_done, portMAX_DELAY); pending--; }
 }
 
+void amoled_blit_idx8(const uint8_t* fb, int w, int h,
+                      uint16_t main565, uint16_t accent565)
+{
+    if (!s_io || !s_band) return;
+    idx8_prepare(w, h, main565, accent565);
+    idx8_window(fb, w, h, 0, 0, AMOLED_W - 1, AMOLED_H - 1);
+    s_blit_shift = s_face_shift;
+}
+
+uint32_t amoled_blit_idx8_rects(const uint8_t* fb, int w, int h,
+                                uint16_t main565, uint16_t accent565,
+                                const amoled_rect_t* rects, int count)
+{
+    if (!s_io || !s_band) return 0;
+    // A new palette or shift changes every lit pixel on the panel
+    if (!s_clut_ready || s_cm != main565 || s_ca != accent565 ||
+        s_lut_w != w || s_lut_h != h || s_blit_shift != s_face_shift) {
+        amoled_blit_idx8(fb, w, h, main565, accent565);
+        return (uint32_t)AMOLED_W * AMOLED_H;
+    }
+
+    int cshift = (s_face_shift * w) / AMOLED_H;
+    uint32_t sent = 0;
+    for (int i = 0; i < count; i++) {
+        // Panel pixels whose 2x2 sample touches the rect: the sample at
+        // canvas (ex, ey) also reads ex+1 / ey+1, so reach one canvas px
+        // up/left of it. The LUTs are monotonic, so scan for the ends.
+        int cx0 = rects[i].x - 1, cx1 = rects[i].x + rects[i].w - 1;
+        int cy0 = rects[i].y - 1, cy1 = rects[i].y + rects[i].h - 1;
+        int py0 = 0, py1 = AMOLED_H - 1, px0 = 0, px1 = AMOLED_W - 1;
+        while (py0 < AMOLED_H && s_xlut[py0] + cshift < cx0) py0++;
+        while (py1 >= 0 && s_xlut[py1] + cshift > cx1) py1--;
+        while (px0 < AMOLED_W && s_ylut[px0] < cy0) px0++;
+        while (px1 >= 0 && s_ylut[px1] > cy1) px1--;
+        if (py0 > py1 || px0 > px1) continue;     // off the panel
+
+        idx8_window(fb, w, h, px0, py0, px1, py1);
+        sent += (uint32_t)(px1 - px0 + 1) * (py1 - py0 + 1);
+    }
+    return sent;
+}
+
 #endif // BOARD_LILYGO_TDISPLAY_S3_AMOLED
@@ -33,6 +33,19 @@ void amoled_blit_mono(const uint8_t* mono, int w, int h, uint16_t color);
 void amoled_blit_idx8(const uint8_t* fb, int w, int h,
                       uint16_t main565, uint16_t accent565);
 
+// Canvas-space rectangle for amoled_blit_idx8_rects().
+typedef struct {
+    uint16_t x, y, w, h;
+} amoled_rect_t;
+
+// As amoled_blit_idx8(), but only re-sends the panel pixels whose 2x2 sample
+// covers one of the given canvas rects (one window + pipelined bands each).
+// Falls back to a full blit when the colors, canvas size or shift changed
+// since the last full blit. Returns the number of panel pixels sent.
+uint32_t amoled_blit_idx8_rects(const uint8_t* fb, int w, int h,
+                                uint16_t main565, uint16_t accent565,
+                                const amoled_rect_t* rects, int count);
+
 // Shift the blitted face along the panel long axis (panel pixels, +/-) to
 // center it on the physical module (active area is off-center in the glass).
 void amoled_set_shift(int panel_px);
@@ -55,6 +55,7 @@ static uint32_t state_change_ms = 0;
 
 #define BLINK_OFF_MS    200
 #define BLINK_ON_MS     100
+#define LED_FRAME_MS    20
 
 // Breathing brightness scale (0-255) — triangle wave with quadratic easing
 static inline uint8_t breathing_scale(int t)
@@ -225,14 +226,28 @@ void neopixel_task(int pat)
                 led_state = LED_IDLE;
                 break;
         }
+
+        // Come back when this blink phase ends (at once when the last one did)
+        if (led_state == LED_IDLE) {
+            platform_loop_wake_in(0);
+        } else {
+            uint32_t hold = (led_state == LED_BLINK_ON) ? BLINK_ON_MS : BLINK_OFF_MS;
+            platform_loop_wake_in(hold - (now - state_change_ms));
+        }
         return;
     }
 
     // Rate limit updates (~50Hz)
-    if (now - last_update_ms < 20) return;
+    if (now - last_update_ms < LED_FRAME_MS) {
+        platform_loop_wake_in(LED_FRAME_MS - (now - last_update_ms));
+        return;
+    }
     last_update_ms = now;
     tic++;
 
+    // Breathing advances every frame; solid colours don't
+    if (pat == 0) platform_loop_wake_in(LED_FRAME_MS);
+
     if (has_override_color) {
         if (pat == 0) {
             // Not connected: breathing pulse with override color
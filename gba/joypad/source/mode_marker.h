@@ -38,6 +38,8 @@ typedef enum {
     JOYPAD_MODE_PCEMINI        = 12,
     JOYPAD_MODE_CDC            = 13,
     JOYPAD_MODE_GBA_LINK       = 14,
+    JOYPAD_MODE_SWITCH_PRO     = 15,
+    JOYPAD_MODE_XBOX_ORIGINAL_4P = 16,
     JOYPAD_MODE_UNKNOWN        = 0xFF,
 } joypad_mode_id_t;
 
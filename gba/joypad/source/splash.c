@@ -416,10 +416,12 @@ void splash_render(joypad_mode_id_t mode)
         case JOYPAD_MODE_XINPUT:          splash_xinput();          break;
         case JOYPAD_MODE_PS3:             splash_ps3();             break;
         case JOYPAD_MODE_PS4:             splash_ps4();             break;
-        case JOYPAD_MODE_SWITCH:          splash_switch();          break;
+        case JOYPAD_MODE_SWITCH:
+        case JOYPAD_MODE_SWITCH_PRO:      splash_switch();          break;
         case JOYPAD_MODE_KEYBOARD_MOUSE:  splash_keyboard_mouse();  break;
         case JOYPAD_MODE_XBONE:           splash_xbone();           break;
-        case JOYPAD_MODE_XBOX_ORIGINAL:   splash_xbox_og();         break;
+        case JOYPAD_MODE_XBOX_ORIGINAL:
+        case JOYPAD_MODE_XBOX_ORIGINAL_4P: splash_xbox_og();        break;
         case JOYPAD_MODE_GC_ADAPTER:      splash_gc_adapter();      break;
         case JOYPAD_MODE_CDC:             splash_cdc();             break;
         default:                          splash_generic(mode);     break;
@@ -437,6 +439,7 @@ void splash_palette(joypad_mode_id_t mode, uint16_t* fg, uint16_t* pupil)
             *pupil = RGB5(31, 31, 31);  // white X
             break;
         case JOYPAD_MODE_XBOX_ORIGINAL:
+        case JOYPAD_MODE_XBOX_ORIGINAL_4P:
             *fg    = RGB5( 8, 31,  8);  // brighter green diamond
             *pupil = RGB5( 5, 18,  3);  // darker green X
             break;
@@ -447,6 +450,7 @@ void splash_palette(joypad_mode_id_t mode, uint16_t* fg, uint16_t* pupil)
             *pupil = RGB5( 2,  6, 16);  // navy
             break;
         case JOYPAD_MODE_SWITCH:
+        case JOYPAD_MODE_SWITCH_PRO:
             *fg    = RGB5(31,  4,  6);  // joycon red
             *pupil = RGB5( 3, 18, 31);  // joycon blue
             break;
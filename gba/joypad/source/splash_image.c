@@ -63,7 +63,8 @@ const splash_image_t* splash_image_for(joypad_mode_id_t mode)
         case JOYPAD_MODE_GC_ADAPTER:      return &splash_img_gc_adapter;
 #endif
 #ifdef HAVE_SPLASH_XBOX_ORIGINAL
-        case JOYPAD_MODE_XBOX_ORIGINAL:   return &splash_img_xbox_original;
+        case JOYPAD_MODE_XBOX_ORIGINAL:
+        case JOYPAD_MODE_XBOX_ORIGINAL_4P: return &splash_img_xbox_original;
 #endif
 #ifdef HAVE_SPLASH_XBONE
         case JOYPAD_MODE_XBONE:           return &splash_img_xbone;
@@ -105,6 +106,7 @@ const char* splash_image_mode_name(joypad_mode_id_t mode)
         case JOYPAD_MODE_KEYBOARD_MOUSE: return "KB MOUSE";
         case JOYPAD_MODE_XBONE:          return "XBOX ONE";
         case JOYPAD_MODE_XBOX_ORIGINAL:  return "XBOX OG";
+        case JOYPAD_MODE_XBOX_ORIGINAL_4P: return "XBOX OG 4P";
         case JOYPAD_MODE_GC_ADAPTER:     return "GC ADAPTER";
         case JOYPAD_MODE_CDC:            return "CDC";
         case JOYPAD_MODE_PSCLASSIC:      return "PS CLASSIC";
@@ -1,12 +1,15 @@
 // button_nrf.c - Button driver for nRF52840 boards
 //
 // Implements button.h using Zephyr GPIO. Active low with internal pull-up.
+// Both edges wake the main loop; while a click, hold or bounce is still being
+// timed, button_task() asks the loop back for the moment it ends.
 //
 // XIAO nRF52840:   D1 = P0.03 on gpio0
 // Feather nRF52840: User switch = P1.02 on gpio1
 
 #include "core/services/button/button.h"
 #include "platform/platform.h"
+#include "loop_nrf.h"
 #include <zephyr/drivers/gpio.h>
 #include <stdio.h>
 
@@ -21,6 +24,9 @@
 #endif
 
 static const struct device *button_port;
+#ifndef DISABLE_USER_BUTTON
+static struct gpio_callback button_cb;
+#endif
 
 // ============================================================================
 // STATE
@@ -58,6 +64,9 @@ static bool read_button_debounced(void)
         if (now - last_change_ms >= BUTTON_DEBOUNCE_MS) {
             last_raw_state = raw;
             last_change_ms = now;
+        } else {
+            // Settled on the other level inside the window; no edge will follow
+            loop_nrf_wake_in(BUTTON_DEBOUNCE_MS - (now - last_change_ms));
         }
     }
 
@@ -69,6 +78,21 @@ static uint32_t elapsed_ms_since(uint32_t since)
     return platform_time_ms() - since;
 }
 
+// Time left until since + ms, for loop_nrf_wake_in()
+static uint32_t ms_left(uint32_t since, uint32_t ms)
+{
+    uint32_t elapsed = elapsed_ms_since(since);
+    return elapsed < ms ? ms - elapsed : 0;
+}
+
+#ifndef DISABLE_USER_BUTTON
+static void button_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+    (void)dev; (void)cb; (void)pins;
+    loop_nrf_wake(LOOP_WAKE_INPUT);
+}
+#endif
+
 static button_event_t fire_event(button_event_t event)
 {
     if (event != BUTTON_EVENT_NONE) {
@@ -105,6 +129,9 @@ void button_init(void)
     }
 
     gpio_pin_configure(button_port, BUTTON_PIN, GPIO_INPUT | GPIO_PULL_UP);
+    gpio_init_callback(&button_cb, button_isr, BIT(BUTTON_PIN));
+    gpio_add_callback(button_port, &button_cb);
+    gpio_pin_interrupt_configure(button_port, BUTTON_PIN, GPIO_INT_EDGE_BOTH);
 
     state = STATE_IDLE;
     last_raw_state = false;
@@ -202,6 +229,13 @@ button_event_t button_task(void)
             break;
     }
 
+    // Releases and presses arrive as edges; only timeouts need the loop back
+    if (state == STATE_PRESSED && !hold_event_fired) {
+        loop_nrf_wake_in(ms_left(press_time_ms, BUTTON_HOLD_MS));
+    } else if (state == STATE_WAIT_DOUBLE || state == STATE_WAIT_TRIPLE) {
+        loop_nrf_wake_in(ms_left(release_time_ms, BUTTON_DOUBLE_CLICK_MS));
+    }
+
     return event;
 }
 
@@ -4,11 +4,13 @@
 // XIAO nRF52840:   SSD1306 on i2c1 (XIAO Expansion Board)
 // Feather nRF52840: SH1107 on i2c0 (FeatherWing OLED)
 //
-// Display flush runs in a low-priority background thread so I2C
-// transfers (~35ms at 400kHz) don't block the main loop.
+// Display flush runs as a delayable work item on the low-priority
+// housekeeping queue so I2C transfers (~35ms at 400kHz) don't block the
+// I/O loop.
 
 #include "core/services/display/display.h"
 #include "core/services/display/display_transport.h"
+#include "loop_nrf.h"
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/i2c.h>
@@ -35,36 +37,28 @@ static void i2c_write_data(const uint8_t* data, size_t len)
 }
 
 // ============================================================================
-// BACKGROUND FLUSH THREAD
+// BACKGROUND FLUSH
 // ============================================================================
 
-#define DISPLAY_THREAD_STACK_SIZE 1024
-#define DISPLAY_THREAD_PRIORITY  K_PRIO_PREEMPT(14)  // Low priority
 #define DISPLAY_FLUSH_INTERVAL_MS 50  // 20fps
 
-K_THREAD_STACK_DEFINE(display_stack, DISPLAY_THREAD_STACK_SIZE);
-static struct k_thread display_thread;
+static struct k_work_delayable display_work;
 
-static void display_thread_fn(void *p1, void *p2, void *p3)
+static void display_work_fn(struct k_work *work)
 {
-    (void)p1; (void)p2; (void)p3;
-    while (1) {
-        if (display_is_dirty()) {
-            display_flush();
-        }
-        k_msleep(DISPLAY_FLUSH_INTERVAL_MS);
+    (void)work;
+    if (display_is_dirty()) {
+        display_flush();
     }
+    loop_nrf_schedule(&display_work, DISPLAY_FLUSH_INTERVAL_MS);
 }
 
-static void display_start_thread(void)
+static void display_start_flush(void)
 {
     display_set_async(true);
-    k_thread_create(&display_thread, display_stack,
-                     DISPLAY_THREAD_STACK_SIZE,
-                     display_thread_fn, NULL, NULL, NULL,
-                     DISPLAY_THREAD_PRIORITY, 0, K_NO_WAIT);
-    k_thread_name_set(&display_thread, "display");
-    printf("[display] Background flush thread started\n");
+    k_work_init_delayable(&display_work, display_work_fn);
+    loop_nrf_schedule(&display_work, DISPLAY_FLUSH_INTERVAL_MS);
+    printf("[display] Background flush scheduled\n");
 }
 
 // ============================================================================
@@ -100,8 +94,8 @@ void display_i2c_init(const display_i2c_config_t* config)
     display_set_transport(i2c_write_cmd, i2c_write_data);
     display_set_col_offset(0);
 
-    // Start background thread for async I2C flush
-    display_start_thread();
+    // Schedule async I2C flush on the housekeeping queue
+    display_start_flush();
 
     printf("[display] I2C transport initialized (addr=0x%02X)\n", i2c_addr);
 }
@@ -2,8 +2,14 @@
 //
 // Direct I2C register driver (NOT the Zephyr sensor driver, whose boot-time
 // init proved fragile). Runs at runtime, after the regulator has powered the
-// IMU. Reads accel + gyro and stamps motion into the router, from where
-// sinput_mode emits it in the SInput IMU report. No-op if no IMU node.
+// IMU. No-op if no IMU node.
+//
+// The IMU samples into its own FIFO at 416 Hz and raises INT1 at a watermark
+// of a few sets. imu_task() then drains it with non-blocking (EasyDMA) I2C
+// transfers: FIFO status, then the data, each completing in a callback that
+// wakes the main loop. Every sample gets a timestamp rebuilt from the ODR
+// (lsm6_fifo.c) and goes to the router as a batch, from where gyro aim
+// integrates all of them and sinput_mode reports the newest.
 
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
@@ -15,8 +21,11 @@
 
 #include <zephyr/drivers/i2c.h>
 #include <hal/nrf_gpio.h>
+#include <zephyr/drivers/gpio.h>
 #include "core/router/router.h"
 #include "platform/platform.h"
+#include "lsm6_fifo.h"
+#include "loop_nrf.h"
 
 #define IMU_PWR_PIN (32 + 8)  // P1.08 = LSM6DS3TR-C power enable (active high)
 
@@ -26,22 +35,114 @@
 #define REG_CTRL1_XL    0x10   // accel ODR + full-scale
 #define REG_CTRL2_G     0x11   // gyro  ODR + full-scale
 #define REG_CTRL3_C     0x12   // BDU / auto-increment
-#define REG_OUTX_L_G    0x22   // gyro X,Y,Z then accel X,Y,Z (12 bytes, auto-inc)
 #define WHOAMI_VALUE    0x6A
 
 // The raw 16-bit output at these full-scales already matches the int16 range
 // SInput expects, so no conversion is needed — just hand it over with the range.
 #define IMU_ACCEL_RANGE_MG  4000    // ±4 g  → CTRL1_XL FS_XL = 0b10
 #define IMU_GYRO_RANGE_DPS  2000    // ±2000 dps → CTRL2_G FS_G = 0b11
-#define CTRL1_XL_VAL  0x48          // ODR 104Hz (0100), ±4g (10)
-#define CTRL2_G_VAL   0x4C          // ODR 104Hz (0100), ±2000dps (11)
+#define IMU_ODR_HZ    416
+#define CTRL1_XL_VAL  0x68          // ODR 416Hz (0110), ±4g (10)
+#define CTRL2_G_VAL   0x6C          // ODR 416Hz (0110), ±2000dps (11)
 #define CTRL3_C_VAL   0x44          // BDU=1, IF_INC=1
-#define IMU_POLL_MS   10            // ~100 Hz
+
+// FIFO: gyro + accel undecimated, continuous mode at the ODR, INT1 at the
+// watermark. 4 sets = one burst per ~9.6 ms, about the old poll rate, with
+// every sample kept.
+#define IMU_FIFO_WATERMARK_SETS  4
+#define FIFO_CTRL3_VAL  0x09        // DEC_FIFO_GYRO=001, DEC_FIFO_XL=001
+#define FIFO_CTRL5_VAL  0x36        // ODR_FIFO 416Hz (0110), continuous (110)
+#define INT1_CTRL_VAL   0x08        // INT1_FTH
+
+// Largest burst: the FIFO holds ~170 sets; a stalled loop catches up over
+// a few bursts rather than one long transfer
+#define IMU_FIFO_MAX_SETS  32
+// Read anyway if INT1 stays quiet this long (missed edge, no IRQ wired)
+#define IMU_POLL_US   20000
 
 static const struct device *i2c_dev;
 static uint8_t imu_addr;
 static bool imu_ok;
 
+#if DT_NODE_HAS_PROP(DT_NODELABEL(lsm6ds3tr_c), irq_gpios)
+static const struct gpio_dt_spec imu_irq = GPIO_DT_SPEC_GET(DT_NODELABEL(lsm6ds3tr_c), irq_gpios);
+static struct gpio_callback imu_irq_cb;
+#endif
+static volatile bool irq_pending;
+
+// Transfer in flight. Buffers and messages stay put until its callback.
+typedef enum {
+    IMU_XFER_IDLE,
+    IMU_XFER_STATUS,        // Reading FIFO_STATUS1-4
+    IMU_XFER_DATA,          // Reading FIFO_DATA_OUT
+} imu_xfer_t;
+
+static imu_xfer_t xfer_state = IMU_XFER_IDLE;
+static volatile bool xfer_done;
+static volatile int xfer_result;
+static volatile uint32_t xfer_done_us;
+static bool xfer_async = true;      // Off if the bus driver has no callback API
+static uint8_t xfer_reg;
+static struct i2c_msg xfer_msgs[2];
+
+static uint8_t fifo_status_buf[LSM6_FIFO_STATUS_LEN];
+static uint8_t fifo_buf[IMU_FIFO_MAX_SETS * LSM6_FIFO_SET_WORDS * 2];
+static lsm6_fifo_status_t fifo_status;
+static uint32_t fifo_status_us;
+static uint16_t fifo_words;
+static uint32_t last_read_us;
+static lsm6_fifo_clock_t fifo_clock;
+static onboard_motion_sample_t samples[IMU_FIFO_MAX_SETS];
+
+#if DT_NODE_HAS_PROP(DT_NODELABEL(lsm6ds3tr_c), irq_gpios)
+static void imu_irq_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+    (void)dev; (void)cb; (void)pins;
+    irq_pending = true;
+    loop_nrf_wake(LOOP_WAKE_INPUT);
+}
+#endif
+
+#ifdef CONFIG_I2C_CALLBACK
+static void imu_xfer_cb(const struct device *dev, int result, void *data)
+{
+    (void)dev; (void)data;
+    xfer_result = result;
+    xfer_done_us = platform_time_us();
+    xfer_done = true;
+    loop_nrf_wake(LOOP_WAKE_INPUT);
+}
+#endif
+
+// Start reading len bytes from reg. Completes in imu_xfer_cb, or right here
+// (blocking) if the bus driver can't do callbacks.
+static int imu_read_start(uint8_t reg, uint8_t *buf, uint32_t len)
+{
+    xfer_reg = reg;
+    xfer_msgs[0].buf = &xfer_reg;
+    xfer_msgs[0].len = 1;
+    xfer_msgs[0].flags = I2C_MSG_WRITE;
+    xfer_msgs[1].buf = buf;
+    xfer_msgs[1].len = len;
+    xfer_msgs[1].flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP;
+    xfer_done = false;
+
+#ifdef CONFIG_I2C_CALLBACK
+    if (xfer_async) {
+        int err = i2c_transfer_cb(i2c_dev, xfer_msgs, 2, imu_addr, imu_xfer_cb, NULL);
+        if (err != -ENOSYS) return err;
+        printf("[imu] i2c callbacks unsupported, reading FIFO blocking\n");
+        xfer_async = false;
+    }
+#endif
+
+    xfer_result = i2c_transfer(i2c_dev, xfer_msgs, 2, imu_addr);
+    xfer_done_us = platform_time_us();
+    xfer_done = true;
+    loop_nrf_wake_in(0);    // no callback will wake the loop for the next step
+    return 0;
+}
+
 void imu_init(void)
 {
     i2c_dev = DEVICE_DT_GET(DT_NODELABEL(i2c0));
@@ -72,6 +173,27 @@ void imu_init(void)
     i2c_reg_write_byte(i2c_dev, imu_addr, REG_CTRL1_XL, CTRL1_XL_VAL);
     i2c_reg_write_byte(i2c_dev, imu_addr, REG_CTRL2_G,  CTRL2_G_VAL);
     i2c_reg_write_byte(i2c_dev, imu_addr, REG_CTRL3_C,  CTRL3_C_VAL);
+
+    // FIFO: bypass first to clear anything left from before a reset
+    uint16_t fth = IMU_FIFO_WATERMARK_SETS * LSM6_FIFO_SET_WORDS;
+    i2c_reg_write_byte(i2c_dev, imu_addr, LSM6_REG_FIFO_CTRL5, 0x00);
+    i2c_reg_write_byte(i2c_dev, imu_addr, LSM6_REG_FIFO_CTRL1, (uint8_t)(fth & 0xFF));
+    i2c_reg_write_byte(i2c_dev, imu_addr, LSM6_REG_FIFO_CTRL2, (uint8_t)((fth >> 8) & 0x07));
+    i2c_reg_write_byte(i2c_dev, imu_addr, LSM6_REG_FIFO_CTRL3, FIFO_CTRL3_VAL);
+    i2c_reg_write_byte(i2c_dev, imu_addr, LSM6_REG_FIFO_CTRL4, 0x00);
+    i2c_reg_write_byte(i2c_dev, imu_addr, LSM6_REG_FIFO_CTRL5, FIFO_CTRL5_VAL);
+    i2c_reg_write_byte(i2c_dev, imu_addr, LSM6_REG_INT1_CTRL,  INT1_CTRL_VAL);
+    lsm6_fifo_clock_init(&fifo_clock, IMU_ODR_HZ);
+
+#if DT_NODE_HAS_PROP(DT_NODELABEL(lsm6ds3tr_c), irq_gpios)
+    if (gpio_is_ready_dt(&imu_irq) && gpio_pin_configure_dt(&imu_irq, GPIO_INPUT) == 0) {
+        gpio_init_callback(&imu_irq_cb, imu_irq_isr, BIT(imu_irq.pin));
+        gpio_add_callback(imu_irq.port, &imu_irq_cb);
+        gpio_pin_interrupt_configure_dt(&imu_irq, GPIO_INT_EDGE_TO_ACTIVE);
+    } else {
+        printf("[imu] INT1 not available, polling the FIFO\n");
+    }
+#endif
     imu_ok = true;
 
     // Mounting orientation → SInput canonical device frame (report X=left,
@@ -85,10 +207,11 @@ void imu_init(void)
     // (USB + BLE alike); still overridable live via the IMU.MAP CDC command.
     router_set_motion_remap(-2, -1, -3);
 
-    // Mark motion valid (imu_task fills in real values every ~10ms).
+    // Mark motion valid (imu_task fills in real values every FIFO burst).
     int16_t z[3] = {0};
     router_set_onboard_motion(z, z, IMU_ACCEL_RANGE_MG, IMU_GYRO_RANGE_DPS);
-    printf("[imu] LSM6DS3TR-C @0x%02x configured (104 Hz, ±4 g, ±2000 dps)\n", imu_addr);
+    printf("[imu] LSM6DS3TR-C @0x%02x configured (%d Hz FIFO, ±4 g, ±2000 dps)\n",
+           imu_addr, IMU_ODR_HZ);
 }
 
 // Cut the IMU's power rail before System OFF. The SoC RETAINS GPIO output state
@@ -99,6 +222,9 @@ void imu_init(void)
 void imu_power_off(void)
 {
     imu_ok = false;
+#if DT_NODE_HAS_PROP(DT_NODELABEL(lsm6ds3tr_c), irq_gpios)
+    gpio_pin_interrupt_configure_dt(&imu_irq, GPIO_INT_DISABLE);
+#endif
     nrf_gpio_pin_clear(IMU_PWR_PIN);
 }
 
@@ -106,25 +232,62 @@ void imu_task(void)
 {
     if (!imu_ok) return;
 
-    static uint32_t last_ms = 0;
-    uint32_t now = platform_time_ms();
-    if (now - last_ms < IMU_POLL_MS) return;
-    last_ms = now;
-
-    uint8_t b[12];
-    if (i2c_burst_read(i2c_dev, imu_addr, REG_OUTX_L_G, b, sizeof(b)) != 0) return;
-
-    int16_t gyro[3] = {
-        (int16_t)(b[0]  | (b[1]  << 8)),
-        (int16_t)(b[2]  | (b[3]  << 8)),
-        (int16_t)(b[4]  | (b[5]  << 8)),
-    };
-    int16_t accel[3] = {
-        (int16_t)(b[6]  | (b[7]  << 8)),
-        (int16_t)(b[8]  | (b[9]  << 8)),
-        (int16_t)(b[10] | (b[11] << 8)),
-    };
-    router_set_onboard_motion(accel, gyro, IMU_ACCEL_RANGE_MG, IMU_GYRO_RANGE_DPS);
+    uint32_t now = platform_time_us();
+
+    switch (xfer_state) {
+        case IMU_XFER_IDLE:
+            if (!irq_pending && (now - last_read_us) < IMU_POLL_US) {
+                // INT1 normally wakes us first; this is the IMU_POLL_US fallback
+                loop_nrf_wake_in((IMU_POLL_US - (now - last_read_us) + 999) / 1000);
+                return;
+            }
+            irq_pending = false;
+            last_read_us = now;
+            xfer_state = IMU_XFER_STATUS;
+            if (imu_read_start(LSM6_REG_FIFO_STATUS1, fifo_status_buf, sizeof(fifo_status_buf)) != 0) {
+                xfer_state = IMU_XFER_IDLE;
+            }
+            break;
+
+        case IMU_XFER_STATUS:
+            if (!xfer_done) return;
+            xfer_state = IMU_XFER_IDLE;
+            if (xfer_result != 0) return;
+
+            // The samples counted here were all taken by the time it completed
+            lsm6_fifo_decode_status(fifo_status_buf, &fifo_status);
+            fifo_status_us = xfer_done_us;
+            fifo_words = lsm6_fifo_words_to_read(&fifo_status, IMU_FIFO_MAX_SETS * LSM6_FIFO_SET_WORDS);
+            if (fifo_words == 0) return;
+
+            xfer_state = IMU_XFER_DATA;
+            if (imu_read_start(LSM6_REG_FIFO_DATA_OUT, fifo_buf, fifo_words * 2u) != 0) {
+                xfer_state = IMU_XFER_IDLE;
+            }
+            break;
+
+        case IMU_XFER_DATA: {
+            if (!xfer_done) return;
+            xfer_state = IMU_XFER_IDLE;
+            if (xfer_result != 0) return;
+
+            uint16_t n = lsm6_fifo_parse(fifo_buf, fifo_words, fifo_status.pattern,
+                                         samples, IMU_FIFO_MAX_SETS);
+            uint16_t unread = (uint16_t)((fifo_status.words - fifo_words) / LSM6_FIFO_SET_WORDS);
+            lsm6_fifo_clock_stamp(&fifo_clock, samples, n, fifo_status_us, unread,
+                                  fifo_status.overrun);
+            if (n) {
+                router_set_onboard_motion_batch(samples, n, IMU_ACCEL_RANGE_MG, IMU_GYRO_RANGE_DPS);
+            }
+
+            // Burst was capped: go straight back for the rest
+            if (fifo_status.words > fifo_words + LSM6_FIFO_SET_WORDS) {
+                irq_pending = true;
+                loop_nrf_wake_in(0);
+            }
+            break;
+        }
+    }
 }
 
 #else  // no IMU node on this board — no-op
@@ -5,7 +5,9 @@
 // Initialize the onboard IMU. No-op if the board has no IMU node.
 void imu_init(void);
 
-// Poll the IMU (throttled internally to ~100 Hz) and push motion to the router.
+// Drain the IMU's FIFO when INT1 signals the watermark (or the fallback poll
+// is due) and push the timestamped samples to the router. Non-blocking: each
+// I2C transfer completes in the background and is picked up on a later call.
 void imu_task(void);
 
 // Cut the IMU power rail (P1.08) before deep sleep so it draws nothing in
@@ -0,0 +1,187 @@
+// loop_nrf.c - Event-driven main loop for nRF52840 (Zephyr)
+//
+// Wake requests come from the BTstack thread and from ISRs (USBD,
+// MAX3421E GPIO), so the pending timestamp is guarded by a spinlock and
+// the wake itself is a k_event post, both of which are ISR-safe.
+
+#include "loop_nrf.h"
+#include "core/loop_stats.h"
+#include "platform/platform.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+K_EVENT_DEFINE(loop_events);
+static struct k_spinlock loop_lock;
+
+// Time of the first wake since the last serviced pass
+static uint32_t wake_stamp_cyc = 0;
+static bool wake_stamped = false;
+
+// Soonest loop_nrf_wake_in() deadline since the last wait (k_uptime ms).
+// Only the I/O thread touches it.
+static int64_t due_ms = 0;
+static bool due_set = false;
+
+// Housekeeping work queue
+K_THREAD_STACK_DEFINE(housekeeping_stack, LOOP_HOUSEKEEPING_STACK);
+static struct k_work_q housekeeping_q;
+
+#if LOOP_PROFILE
+// One-second window for the comparison log
+static uint32_t prof_window_start = 0;
+static uint32_t prof_passes = 0;
+static uint32_t prof_source[5];        // input, usbd, usbh, max3421, timeout
+static uint32_t prof_serviced = 0;
+static uint32_t prof_latency_total = 0;
+static uint32_t prof_latency_max = 0;
+#endif
+
+void loop_nrf_init(void)
+{
+    k_work_queue_start(&housekeeping_q, housekeeping_stack,
+                       K_THREAD_STACK_SIZEOF(housekeeping_stack),
+                       LOOP_HOUSEKEEPING_PRIORITY, NULL);
+    k_thread_name_set(&housekeeping_q.thread, "housekeeping");
+}
+
+void loop_nrf_schedule(struct k_work_delayable* work, uint32_t delay_ms)
+{
+    k_work_schedule_for_queue(&housekeeping_q, work, K_MSEC(delay_ms));
+}
+
+void loop_nrf_bind(void)
+{
+    k_thread_priority_set(k_current_get(), LOOP_IO_PRIORITY);
+    k_thread_name_set(k_current_get(), "io");
+}
+
+void loop_nrf_wake(uint32_t sources)
+{
+    k_spinlock_key_t key = k_spin_lock(&loop_lock);
+    if (!wake_stamped) {
+        wake_stamp_cyc = k_cycle_get_32();
+        wake_stamped = true;
+    }
+    k_spin_unlock(&loop_lock, key);
+
+    k_event_post(&loop_events, sources);
+}
+
+void loop_nrf_wake_in(uint32_t ms)
+{
+    int64_t due = k_uptime_get() + ms;
+    if (!due_set || due < due_ms) {
+        due_ms = due;
+        due_set = true;
+    }
+}
+
+uint32_t loop_nrf_wait(void)
+{
+#if LOOP_EVENT_DRIVEN
+    int64_t wait_ms = LOOP_IDLE_MS;
+    if (due_set) {
+        int64_t left = due_ms - k_uptime_get();
+        if (left < wait_ms) wait_ms = left > 0 ? left : 0;
+        due_set = false;
+    }
+    k_event_wait(&loop_events, LOOP_WAKE_ALL, false, K_MSEC(wait_ms));
+#else
+    k_msleep(1);
+#endif
+    // Consume the bits with one atomic read-and-clear. Clearing what the
+    // wait returned would drop a post that lands between the two calls;
+    // anything posted after this stays set for the next wait.
+    uint32_t sources = k_event_clear(&loop_events, LOOP_WAKE_ALL);
+
+#if LOOP_PROFILE
+    prof_passes++;
+    if (!sources) prof_source[4]++;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (sources & (1u << i)) prof_source[i]++;
+    }
+#endif
+    return sources;
+}
+
+#if LOOP_PROFILE
+static void loop_profile_report(void)
+{
+    uint32_t now = platform_time_ms();
+    if (prof_window_start == 0) prof_window_start = now;
+    uint32_t elapsed = now - prof_window_start;
+    if (elapsed < 1000) return;
+
+    printf("[loop] %lu wakes/s (input %lu usbd %lu usbh %lu max3421 %lu timeout %lu) "
+           "latency avg %lu us max %lu us\n",
+           (unsigned long)(prof_passes * 1000u / elapsed),
+           (unsigned long)prof_source[0], (unsigned long)prof_source[1],
+           (unsigned long)prof_source[2], (unsigned long)prof_source[3],
+           (unsigned long)prof_source[4],
+           (unsigned long)(prof_serviced ? prof_latency_total / prof_serviced : 0),
+           (unsigned long)prof_latency_max);
+
+    prof_window_start = now;
+    prof_passes = 0;
+    for (uint8_t i = 0; i < 5; i++) prof_source[i] = 0;
+    prof_serviced = 0;
+    prof_latency_total = 0;
+    prof_latency_max = 0;
+}
+#endif
+
+void loop_nrf_serviced(void)
+{
+    uint32_t stamp = 0;
+    bool stamped;
+
+    k_spinlock_key_t key = k_spin_lock(&loop_lock);
+    stamped = wake_stamped;
+    if (stamped) {
+        stamp = wake_stamp_cyc;
+        wake_stamped = false;
+    }
+    k_spin_unlock(&loop_lock, key);
+
+    if (stamped) {
+        uint32_t latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - stamp);
+        loop_stats_record(latency_us);
+#if LOOP_PROFILE
+        prof_serviced++;
+        prof_latency_total += latency_us;
+        if (latency_us > prof_latency_max) prof_latency_max = latency_us;
+#endif
+    }
+
+#if LOOP_PROFILE
+    loop_profile_report();
+#endif
+}
+
+// ============================================================================
+// WAKE HOOKS
+// ============================================================================
+
+void platform_loop_wake(void)
+{
+    loop_nrf_wake(LOOP_WAKE_INPUT);
+}
+
+void platform_loop_wake_in(uint32_t ms)
+{
+    loop_nrf_wake_in(ms);
+}
+
+// TinyUSB calls these whenever it queues an event for tud_task/tuh_task,
+// usually from the USBD or MAX3421E interrupt
+void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr)
+{
+    (void)rhport; (void)eventid; (void)in_isr;
+    loop_nrf_wake(LOOP_WAKE_USBD);
+}
+
+void tuh_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr)
+{
+    (void)rhport; (void)eventid; (void)in_isr;
+    loop_nrf_wake(LOOP_WAKE_USBH);
+}
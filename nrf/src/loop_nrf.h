@@ -0,0 +1,80 @@
+// loop_nrf.h - Event-driven main loop for nRF52840 (Zephyr)
+//
+// After init the main thread raises itself to a cooperative priority and
+// becomes the I/O thread: it owns the router, USB device/host and output
+// path, and blocks on a k_event between passes. Input arrival (router,
+// incl. BTstack), TinyUSB device/host events and the MAX3421E interrupt
+// each post a wake bit. There is no fixed tick: work that is due at a time
+// rather than on an event (LED animation, the settings debounce, a USB mode's
+// report cadence, polled sensors) asks for its next pass with
+// loop_nrf_wake_in() / platform_loop_wake_in(), and the wait times out at
+// the soonest request. With nothing due the thread sleeps up to LOOP_IDLE_MS.
+// LEDs, storage and the battery guard run at the end of each pass, on the
+// thread that changes their state. The display flush runs as a
+// k_work_delayable item on a low-priority work queue so it never sits
+// between an input and its report.
+
+#ifndef LOOP_NRF_H
+#define LOOP_NRF_H
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+// I/O thread priority. Below the BTstack thread (K_PRIO_COOP(2)) so HCI
+// traffic is never starved, above every preemptible thread.
+#define LOOP_IO_PRIORITY            K_PRIO_COOP(4)
+
+// Housekeeping work queue
+#define LOOP_HOUSEKEEPING_PRIORITY  K_PRIO_PREEMPT(14)
+#define LOOP_HOUSEKEEPING_STACK     2048
+
+// Longest sleep with no event and nothing due. Only a backstop for polled
+// timers that don't ask for a pass (player and hotkey timeouts, app
+// housekeeping); everything with a deadline calls loop_nrf_wake_in().
+#define LOOP_IDLE_MS                100
+
+// Set to 0 to fall back to the old k_msleep(1) polling loop (the latency
+// histogram still records, for before/after comparison)
+#ifndef LOOP_EVENT_DRIVEN
+#define LOOP_EVENT_DRIVEN           1
+#endif
+
+// Set to 1 to print wakeups/sec per source and wake-to-report latency
+// once a second, for power/latency comparison between the two loop modes
+#ifndef LOOP_PROFILE
+#define LOOP_PROFILE                0
+#endif
+
+// Wake sources (k_event bits)
+#define LOOP_WAKE_INPUT     (1u << 0)   // Router input (BTstack, USB host, native)
+#define LOOP_WAKE_USBD      (1u << 1)   // TinyUSB device event
+#define LOOP_WAKE_USBH      (1u << 2)   // TinyUSB host event
+#define LOOP_WAKE_MAX3421   (1u << 3)   // MAX3421E INT pin
+#define LOOP_WAKE_ALL       (LOOP_WAKE_INPUT | LOOP_WAKE_USBD | LOOP_WAKE_USBH | LOOP_WAKE_MAX3421)
+
+// Start the housekeeping work queue (call once, before scheduling work)
+void loop_nrf_init(void);
+
+// Schedule a housekeeping item on the low-priority queue
+void loop_nrf_schedule(struct k_work_delayable* work, uint32_t delay_ms);
+
+// Raise the calling thread to LOOP_IO_PRIORITY; it becomes the I/O thread
+void loop_nrf_bind(void);
+
+// Request a loop pass. Safe from any thread and from ISRs.
+void loop_nrf_wake(uint32_t sources);
+
+// Ask for a pass within ms, event or not. One-shot: the soonest request
+// since the last wait wins, and work that stays due asks again each pass.
+// I/O thread only; other threads and ISRs use loop_nrf_wake().
+void loop_nrf_wake_in(uint32_t ms);
+
+// Block until woken, the soonest loop_nrf_wake_in() request is due, or
+// LOOP_IDLE_MS elapses. Returns the wake bits (0 = timeout).
+uint32_t loop_nrf_wait(void);
+
+// Mark the end of a pass that ran the outputs: records wake-to-service
+// latency into the shared loop_stats histogram.
+void loop_nrf_serviced(void);
+
+#endif // LOOP_NRF_H
@@ -0,0 +1,141 @@
+// lsm6_fifo.c - LSM6DS3TR-C FIFO parsing and sample timestamps
+
+#include "lsm6_fifo.h"
+
+// Period: measured over a long baseline of read times, so interrupt and
+// loop latency jitter averages out. Starts after RATE_MIN_SAMPLES; the
+// baseline is halved past RATE_MAX_SAMPLES so it follows temperature drift.
+#define RATE_MIN_SAMPLES        64
+#define RATE_MAX_SAMPLES        8192
+// The oscillator is within a few percent of nominal
+#define PERIOD_TOL_DIV          20      // +/-5%
+
+// Phase: moves 1/PHASE_DIV of the way to each read's estimate. Errors beyond
+// GAP_PERIODS mean samples went missing (or the reads stalled) and the clock
+// restarts from the read time.
+#define PHASE_DIV               8
+#define GAP_PERIODS             4
+
+// ============================================================================
+// FIFO
+// ============================================================================
+
+void lsm6_fifo_decode_status(const uint8_t st[LSM6_FIFO_STATUS_LEN], lsm6_fifo_status_t* out)
+{
+    out->words = (uint16_t)(st[0] | ((st[1] & 0x07) << 8));
+    out->watermark = (st[1] & 0x80) != 0;
+    out->overrun = (st[1] & 0x40) != 0;
+    out->empty = (st[1] & 0x10) != 0;
+    out->pattern = (uint16_t)(st[2] | ((st[3] & 0x03) << 8));
+}
+
+uint16_t lsm6_fifo_words_to_read(const lsm6_fifo_status_t* st, uint16_t max_words)
+{
+    if (st->empty) return 0;
+
+    uint16_t avail = st->words < max_words ? st->words : max_words;
+    uint16_t lead = (uint16_t)((LSM6_FIFO_SET_WORDS - st->pattern % LSM6_FIFO_SET_WORDS) % LSM6_FIFO_SET_WORDS);
+    if (avail < lead) return 0;
+
+    // The cut-off tail (if any), then whole sets
+    return (uint16_t)(lead + ((avail - lead) / LSM6_FIFO_SET_WORDS) * LSM6_FIFO_SET_WORDS);
+}
+
+uint16_t lsm6_fifo_parse(const uint8_t* data, uint16_t words, uint16_t pattern,
+                         onboard_motion_sample_t* out, uint16_t max)
+{
+    uint16_t i = (uint16_t)((LSM6_FIFO_SET_WORDS - pattern % LSM6_FIFO_SET_WORDS) % LSM6_FIFO_SET_WORDS);
+    uint16_t n = 0;
+
+    while (i + LSM6_FIFO_SET_WORDS <= words && n < max) {
+        const uint8_t* b = &data[i * 2];
+        for (int a = 0; a < 3; a++) {
+            out[n].gyro[a] = (int16_t)(b[a * 2] | (b[a * 2 + 1] << 8));
+            out[n].accel[a] = (int16_t)(b[6 + a * 2] | (b[6 + a * 2 + 1] << 8));
+        }
+        out[n].t_us = 0;
+        n++;
+        i += LSM6_FIFO_SET_WORDS;
+    }
+    return n;
+}
+
+// ============================================================================
+// TIMESTAMPS
+// ============================================================================
+
+void lsm6_fifo_clock_init(lsm6_fifo_clock_t* clk, uint32_t odr_hz)
+{
+    clk->nominal_q8 = (uint32_t)((256000000ULL + odr_hz / 2) / odr_hz);
+    clk->period_q8 = clk->nominal_q8;
+    clk->newest_q8 = 0;
+    clk->base_q8 = 0;
+    clk->base_count = 0;
+    clk->period_count = 0;
+    clk->primed = false;
+}
+
+void lsm6_fifo_clock_stamp(lsm6_fifo_clock_t* clk, onboard_motion_sample_t* samples,
+                           uint16_t count, uint32_t read_us, uint16_t unread, bool overrun)
+{
+    if (count == 0) return;
+
+    int64_t period = clk->period_q8;
+
+    // The newest sample read was taken on average half a period before the
+    // read, and earlier by the sets left behind in the FIFO
+    int64_t age = period / 2 + period * unread;
+
+    if (!clk->primed) {
+        clk->newest_q8 = ((uint64_t)read_us << 8) - (uint64_t)age;
+        clk->base_q8 = clk->newest_q8;
+        clk->base_count = 0;
+        clk->primed = true;
+    } else {
+        // Where the ODR puts the newest sample, and where the read time does
+        uint64_t predicted = clk->newest_q8 + (uint64_t)(period * count);
+        int32_t err_us = (int32_t)(read_us - (uint32_t)(predicted >> 8));
+        int64_t err = (int64_t)err_us * 256 - (int64_t)(predicted & 0xFF) - age;
+        uint64_t anchor = predicted + (uint64_t)err;
+
+        if (overrun || err > period * GAP_PERIODS || -err > period * GAP_PERIODS) {
+            clk->newest_q8 = anchor;
+            clk->base_q8 = anchor;
+            clk->base_count = 0;
+        } else {
+            clk->base_count += count;
+            // After a restart the old period stands until the new baseline
+            // is as long as the one that measured it
+            uint32_t need = clk->period_count < RATE_MAX_SAMPLES / 2 ? clk->period_count : RATE_MAX_SAMPLES / 2;
+            if (need < RATE_MIN_SAMPLES) need = RATE_MIN_SAMPLES;
+            if (clk->base_count >= need) {
+                int64_t p = (int64_t)(anchor - clk->base_q8) / (int64_t)clk->base_count;
+                int64_t tol = clk->nominal_q8 / PERIOD_TOL_DIV;
+                if (p > (int64_t)clk->nominal_q8 + tol) p = clk->nominal_q8 + tol;
+                if (p < (int64_t)clk->nominal_q8 - tol) p = clk->nominal_q8 - tol;
+                clk->period_q8 = (uint32_t)p;
+                clk->period_count = clk->base_count;
+            }
+            if (clk->base_count >= RATE_MAX_SAMPLES) {
+                clk->base_count /= 2;
+                clk->period_count = clk->base_count;
+                clk->base_q8 = anchor - (uint64_t)((int64_t)clk->period_q8 * clk->base_count);
+            }
+
+            // Keep the first new sample at least half a period after the
+            // last one stamped, so times never run backwards
+            int64_t p = clk->period_q8;
+            int64_t shift = err / PHASE_DIV;
+            int64_t min_shift = -(period * count) + (p / 2) + p * (count - 1);
+            if (shift < min_shift) shift = min_shift;
+
+            period = p;
+            clk->newest_q8 = predicted + (uint64_t)shift;
+        }
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint64_t t = clk->newest_q8 - (uint64_t)(period * (count - 1 - i));
+        samples[i].t_us = (uint32_t)(t >> 8);
+    }
+}
@@ -0,0 +1,78 @@
+// lsm6_fifo.h - LSM6DS3TR-C FIFO parsing and sample timestamps
+//
+// The IMU queues gyro + accel sets in its FIFO at the ODR; imu_nrf.c drains
+// it in bursts. This is the part with no Zephyr dependency: decoding the
+// FIFO status, splitting the FIFO_DATA_OUT words into samples, and giving
+// each sample the time it was taken. The chip has no timestamp in this FIFO
+// mode, so times are rebuilt from the ODR, with the period and phase pulled
+// toward the read times so the chip's oscillator error doesn't drift.
+//
+// tools/lsm6-fifo-check builds this on the host.
+
+#ifndef LSM6_FIFO_H
+#define LSM6_FIFO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/router/router.h"
+
+// FIFO registers
+#define LSM6_REG_FIFO_CTRL1     0x06   // FTH[7:0], watermark in 16-bit words
+#define LSM6_REG_FIFO_CTRL2     0x07   // FTH[10:8]
+#define LSM6_REG_FIFO_CTRL3     0x08   // gyro / accel decimation
+#define LSM6_REG_FIFO_CTRL4     0x09
+#define LSM6_REG_FIFO_CTRL5     0x0A   // FIFO ODR + mode
+#define LSM6_REG_INT1_CTRL      0x0D
+#define LSM6_REG_FIFO_STATUS1   0x3A   // 4 bytes: DIFF_FIFO, flags, FIFO_PATTERN
+#define LSM6_REG_FIFO_DATA_OUT  0x3E   // Burst reads wrap on 0x3E/0x3F
+
+#define LSM6_FIFO_STATUS_LEN    4
+#define LSM6_FIFO_SET_WORDS     6      // Gyro X Y Z, then accel X Y Z
+
+typedef struct {
+    uint16_t words;             // Unread 16-bit words (DIFF_FIFO)
+    uint16_t pattern;           // Position of the next word within its set
+    bool watermark;             // At or above the FTH watermark
+    bool overrun;               // Full: old sets were overwritten
+    bool empty;
+} lsm6_fifo_status_t;
+
+// Decode FIFO_STATUS1-4
+void lsm6_fifo_decode_status(const uint8_t st[LSM6_FIFO_STATUS_LEN], lsm6_fifo_status_t* out);
+
+// Words to burst-read so the read ends on a set boundary, at most max_words.
+// 0 if not even one set is complete.
+uint16_t lsm6_fifo_words_to_read(const lsm6_fifo_status_t* st, uint16_t max_words);
+
+// Split `words` FIFO words (little-endian bytes) into samples. `pattern` is
+// the status read just before: words ahead of the first set boundary are the
+// tail of a set cut by an overrun and are skipped. Timestamps are left 0.
+// Returns the number of samples written (at most max).
+uint16_t lsm6_fifo_parse(const uint8_t* data, uint16_t words, uint16_t pattern,
+                         onboard_motion_sample_t* out, uint16_t max);
+
+// ============================================================================
+// TIMESTAMPS
+// ============================================================================
+
+typedef struct {
+    uint32_t nominal_q8;        // ODR period from the datasheet, us x 256
+    uint32_t period_q8;         // Tracked period, us x 256
+    uint64_t newest_q8;         // Time of the newest sample stamped, us x 256
+    uint64_t base_q8;           // Start of the period measurement baseline
+    uint32_t base_count;        // Samples from base_q8 to the latest read
+    uint32_t period_count;      // Baseline length behind period_q8
+    bool primed;
+} lsm6_fifo_clock_t;
+
+void lsm6_fifo_clock_init(lsm6_fifo_clock_t* clk, uint32_t odr_hz);
+
+// Stamp a batch (oldest first). read_us is when the FIFO status that counted
+// these samples was read; unread is how many sets that status counted beyond
+// the batch (a capped burst), so the newest one was taken unread periods
+// (plus up to one) before. Pass overrun from that status: samples were lost,
+// so the clock restarts.
+void lsm6_fifo_clock_stamp(lsm6_fifo_clock_t* clk, onboard_motion_sample_t* samples,
+                           uint16_t count, uint32_t read_us, uint16_t unread, bool overrun);
+
+#endif // LSM6_FIFO_H
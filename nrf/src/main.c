@@ -3,7 +3,11 @@
 // Zephyr entry point for bt2usb/usb2usb apps on nRF52840 boards.
 // bt2usb: BTstack runs in its own Zephyr thread (created by bt_transport_nrf.c).
 // usb2usb: USB host via MAX3421E SPI, no Bluetooth.
-// Main thread handles USB device, app logic, LED, and storage.
+// After init the main thread becomes the cooperative I/O thread (USB device/
+// host, router, outputs, app logic) and sleeps on its wake event between
+// passes. LEDs, storage and the battery guard run at the end of each pass;
+// the display flush runs as delayable work on the housekeeping queue (see
+// loop_nrf.h).
 
 #include <stdio.h>
 #include <string.h>
@@ -24,6 +28,7 @@
 #include "core/services/players/manager.h"
 #include "core/services/leds/leds.h"
 #include "core/services/storage/storage.h"
+#include "loop_nrf.h"
 #ifdef CONFIG_CONTROLLER_BTUSB
 #include "imu_nrf.h"
 #include "bt/ble_output/ble_output.h"
@@ -180,6 +185,7 @@ static void power_task(void)
         return;
     }
 
+    // An idle loop still passes every LOOP_IDLE_MS, well inside PWR_CHECK_MS
     if ((uint32_t)(now - last_check) < PWR_CHECK_MS) return;
     last_check = now;
 
@@ -227,6 +233,9 @@ int main(void)
     printf("[joypad] Starting bt2usb on Seeed XIAO nRF52840...\n");
 #endif
 
+    // Housekeeping queue first: display/storage init may schedule work
+    loop_nrf_init();
+
     // Initialize shared services
     leds_init();
     storage_init();
@@ -288,20 +297,24 @@ int main(void)
 
     printf("[joypad] Entering main loop\n");
 
+    // This thread now owns the router and output path
+    loop_nrf_bind();
+
 #ifdef CONFIG_MAX3421
     uint32_t diag_time = 0;
 #endif
 
-    // Main loop
+    // Main loop: one pass per wake event or loop_nrf_wake_in() request
     while (1) {
-        // Poll TinyUSB device (non-blocking)
+        // Process TinyUSB device events (non-blocking)
         tud_task_ext(0, false);
 
 #ifdef CONFIG_MAX3421
         // Process TinyUSB host events (MAX3421E ISR handles SPI directly)
         tuh_task_ext(0, false);
 
-        // Periodic diagnostic (every 5s for first 60s)
+        // Periodic diagnostic (every 5s for first 60s). Stays on this thread:
+        // it shares the MAX3421E SPI bus with tuh_task.
         {
             extern void max3421_print_diag(void);
             uint32_t now = platform_time_ms();
@@ -312,9 +325,7 @@ int main(void)
         }
 #endif
 
-        leds_task();
         players_task();
-        storage_task();
 
         // Poll input interfaces
         for (uint8_t i = 0; i < input_count; i++) {
@@ -323,6 +334,10 @@ int main(void)
             }
         }
 
+#ifdef CONFIG_CONTROLLER_BTUSB
+        imu_task();  // drain onboard IMU FIFO → router (non-blocking)
+#endif
+
         // Run output interface tasks
         for (uint8_t i = 0; i < output_count; i++) {
             if (outputs[i] && outputs[i]->task) {
@@ -332,16 +347,24 @@ int main(void)
 
         app_task();
 
-#ifdef CONFIG_CONTROLLER_BTUSB
-        imu_task();  // sample onboard IMU → router (throttled to ~100 Hz)
-#endif
+        loop_nrf_serviced();
+
+        // LEDs and debounced flash writes, after the latency stamp. They
+        // share state with flash_save()/leds_set_*() callers on this thread,
+        // so they must not run from the housekeeping queue.
+        leds_task();
+        storage_task();
 
 #if defined(CONFIG_CONTROLLER_BTUSB) && defined(CONFIG_BOARD_XIAO_BLE)
-        power_task();  // low-battery cutoff + idle deep-sleep (protects the cell)
+        // Battery cutoff and idle deep sleep. platform_deep_sleep() must not
+        // be preempted halfway, so it stays on this cooperative thread.
+        power_task();
 #endif
 
-        // Yield to other Zephyr threads (BTstack runs in its own thread)
-        k_msleep(1);
+        // Sleep until input, a USB/MAX3421E event or the soonest time a task
+        // asked to run again. BTstack (higher cooperative priority) and
+        // housekeeping run meanwhile.
+        loop_nrf_wait();
     }
 
     return 0;
@@ -13,6 +13,7 @@
 //   IRQ:  D9  = P0.26 (active low, falling edge)
 
 #include "tusb.h"
+#include "loop_nrf.h"
 
 #if CFG_TUH_MAX3421
 
@@ -147,6 +148,7 @@ static void max3421_int_isr(const struct device *dev, struct gpio_callback *cb,
     (void)dev; (void)cb; (void)pins;
     isr_count++;
     hcd_int_handler(1, true);
+    loop_nrf_wake(LOOP_WAKE_MAX3421);
 }
 
 // ============================================================================
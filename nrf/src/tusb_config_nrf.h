@@ -58,6 +58,7 @@
 // Xbox Original (XID) mode support
 #define CFG_TUD_XID                 1
 #define CFG_TUD_XID_EP_BUFSIZE      32
+#define CFG_TUD_XID_PORTS           4   // Four-port XID mode (EP1-4 IN/OUT)
 
 // Xbox 360 (XInput) mode support
 #define CFG_TUD_XINPUT              1
@@ -11,6 +11,8 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
 
+#include "loop_nrf.h"
+
 #ifdef BOARD_FEATHER_NRF52840
 
 // ============================================================================
@@ -213,6 +215,7 @@ static uint32_t state_change_ms = 0;
 
 #define BLINK_OFF_MS    200
 #define BLINK_ON_MS     100
+#define LED_FRAME_MS    20
 
 #ifndef BOARD_FEATHER_NRF52840
 // ============================================================================
@@ -407,14 +410,28 @@ void neopixel_task(int pat)
                 led_state = LED_IDLE;
                 break;
         }
+
+        // Come back when this blink phase ends (at once when the last one did)
+        if (led_state == LED_IDLE) {
+            loop_nrf_wake_in(0);
+        } else {
+            uint32_t hold = (led_state == LED_BLINK_ON) ? BLINK_ON_MS : BLINK_OFF_MS;
+            loop_nrf_wake_in(hold - (now - state_change_ms));
+        }
         return;
     }
 
     // Rate limit updates (~50Hz)
-    if (now - last_update_ms < 20) return;
+    if (now - last_update_ms < LED_FRAME_MS) {
+        loop_nrf_wake_in(LED_FRAME_MS - (now - last_update_ms));
+        return;
+    }
     last_update_ms = now;
     tic++;
 
+    // Breathing and blinking advance every frame; solid colours don't
+    if (pat == 0) loop_nrf_wake_in(LED_FRAME_MS);
+
 #ifdef BOARD_FEATHER_NRF52840
     // --- Feather: NeoPixel + blue LED ---
     if (has_override_color) {
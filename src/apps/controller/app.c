@@ -21,6 +21,9 @@
 #include "pad/pad_input.h"
 #include "pad/pad_config_flash.h"
 #include "usb/usbd/usbd.h"
+#ifdef CONFIG_JOCP_OUTPUT
+#include "wifi/jocp/jocp_output.h"
+#endif
 #include "core/buttons.h"
 #include "tusb.h"
 #include "pico/stdlib.h"
@@ -203,6 +206,9 @@ const InputInterface** app_get_input_interfaces(uint8_t* count)
 
 static const OutputInterface* output_interfaces[] = {
     &usbd_output_interface,
+#ifdef CONFIG_JOCP_OUTPUT
+    &jocp_output_interface,
+#endif
 };
 
 const OutputInterface** app_get_output_interfaces(uint8_t* count)
@@ -304,12 +310,20 @@ void app_init(void)
                pad_config->qwiic_tx, pad_config->qwiic_rx);
     }
 
-    // Configure router for Pad → USB Device
+    // Configure router for Pad → USB Device (and JOCP, which needs MERGE
+    // so both routes receive the pad)
     router_config_t router_cfg = {
+#ifdef CONFIG_JOCP_OUTPUT
+        .mode = ROUTING_MODE_MERGE,
+#else
         .mode = ROUTING_MODE_SIMPLE,
+#endif
         .merge_mode = MERGE_PRIORITY,
         .max_players_per_output = {
             [OUTPUT_TARGET_USB_DEVICE] = 1,
+#ifdef CONFIG_JOCP_OUTPUT
+            [OUTPUT_TARGET_JOCP] = 1,
+#endif
         },
         .merge_all_inputs = false,
         .transform_flags = 0,
@@ -326,12 +340,19 @@ void app_init(void)
 
     // Add route: Pad → USB Device
     router_add_route(INPUT_SOURCE_GPIO, OUTPUT_TARGET_USB_DEVICE, 0);
+#ifdef CONFIG_JOCP_OUTPUT
+    // Add route: Pad → JOCP (WiFi dongle)
+    router_add_route(INPUT_SOURCE_GPIO, OUTPUT_TARGET_JOCP, 0);
+#endif
 
     // UART link forwarding is handled in app_task() via router_get_output()
     // (not via tap, since usbd already owns the USB_DEVICE tap)
 
     printf("[app:controller] Initialization complete\n");
     printf("[app:controller]   Routing: Pad → USB Device (HID Gamepad)\n");
+#ifdef CONFIG_JOCP_OUTPUT
+    printf("[app:controller]   Routing: Pad → JOCP (WiFi dongle)\n");
+#endif
 #ifdef I2C_PEER_ENABLED
     if (i2c_peer_enabled) {
         printf("[app:controller]   I2C Peer: Slave mode (connect via STEMMA QT)\n");
@@ -560,6 +581,24 @@ void app_task(void)
         if (usbd_output_interface.get_rumble) {
             rumble = usbd_output_interface.get_rumble();
         }
+#ifdef CONFIG_JOCP_OUTPUT
+        // Dongle feedback: rumble joins the USB host's, a player colour
+        // replaces the mode colour on a single LED
+        static output_feedback_t jocp_fb = {0};
+        output_feedback_t fb;
+        if (jocp_output_interface.get_feedback(&fb)) {
+            if ((fb.led_r || fb.led_g || fb.led_b) &&
+                (fb.led_r != jocp_fb.led_r || fb.led_g != jocp_fb.led_g ||
+                 fb.led_b != jocp_fb.led_b) &&
+                pad_config->led_count <= 1 && !neopixel_has_custom_colors()) {
+                leds_set_color(fb.led_r, fb.led_g, fb.led_b);
+            }
+            jocp_fb = fb;
+        }
+        uint8_t jocp_rumble = jocp_fb.rumble_left > jocp_fb.rumble_right
+                            ? jocp_fb.rumble_left : jocp_fb.rumble_right;
+        if (jocp_rumble > rumble) rumble = jocp_rumble;
+#endif
         // Handle rumble feedback via speaker (if initialized)
         if (speaker_is_initialized()) {
             speaker_set_rumble(rumble);
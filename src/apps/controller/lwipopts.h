@@ -0,0 +1,97 @@
+// lwipopts.h - LWIP configuration for the WiFi controller builds
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// Lightweight LWIP configuration for WiFi station mode with JOCP output
+// (CONFIG_JOCP_OUTPUT). Only the builds that link pico_cyw43_arch_lwip_*
+// read it. One UDP packet out per change, one TCP connection in for
+// feedback, DHCP client for the dongle's address.
+
+#ifndef _LWIPOPTS_H
+#define _LWIPOPTS_H
+
+// No operating system
+#define NO_SYS                      1
+
+// No socket API needed (we use raw UDP/TCP)
+#define LWIP_SOCKET                 0
+
+// Memory configuration (poll mode compatible)
+#define MEM_LIBC_MALLOC             1
+#define MEM_ALIGNMENT               4
+#define MEM_SIZE                    4000
+
+// TCP/UDP configuration (the control channel only carries small commands)
+#define MEMP_NUM_TCP_SEG            8
+#define MEMP_NUM_ARP_QUEUE          4
+#define PBUF_POOL_SIZE              8
+#define TCP_MSS                     536
+#define TCP_WND                     (2 * TCP_MSS)
+#define TCP_SND_BUF                 (2 * TCP_MSS)
+#define TCP_SND_QUEUELEN            ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
+
+// Protocol support
+#define LWIP_ARP                    1
+#define LWIP_ETHERNET               1
+#define LWIP_ICMP                   1
+#define LWIP_RAW                    1
+#define LWIP_IPV4                   1
+#define LWIP_TCP                    1
+#define LWIP_UDP                    1
+#define LWIP_DNS                    0
+#define LWIP_DHCP                   1
+#define LWIP_TCP_KEEPALIVE          1
+
+// Netif callbacks
+#define LWIP_NETIF_STATUS_CALLBACK  1
+#define LWIP_NETIF_LINK_CALLBACK    1
+#define LWIP_NETIF_HOSTNAME         1
+#define LWIP_NETIF_TX_SINGLE_PBUF   1
+
+// No netconn API
+#define LWIP_NETCONN                0
+
+// Disable stats for smaller footprint
+#define MEM_STATS                   0
+#define SYS_STATS                   0
+#define MEMP_STATS                  0
+#define LINK_STATS                  0
+
+// Checksum optimization
+#define LWIP_CHKSUM_ALGORITHM       3
+
+// DHCP configuration
+#define DHCP_DOES_ARP_CHECK         0
+#define LWIP_DHCP_DOES_ACD_CHECK    0
+
+// Debug configuration (disable in release)
+#ifndef NDEBUG
+#define LWIP_DEBUG                  1
+#define LWIP_STATS                  1
+#define LWIP_STATS_DISPLAY          1
+#endif
+
+// Debug levels (all off by default)
+#define ETHARP_DEBUG                LWIP_DBG_OFF
+#define NETIF_DEBUG                 LWIP_DBG_OFF
+#define PBUF_DEBUG                  LWIP_DBG_OFF
+#define ICMP_DEBUG                  LWIP_DBG_OFF
+#define INET_DEBUG                  LWIP_DBG_OFF
+#define IP_DEBUG                    LWIP_DBG_OFF
+#define RAW_DEBUG                   LWIP_DBG_OFF
+#define MEM_DEBUG                   LWIP_DBG_OFF
+#define MEMP_DEBUG                  LWIP_DBG_OFF
+#define SYS_DEBUG                   LWIP_DBG_OFF
+#define TCP_DEBUG                   LWIP_DBG_OFF
+#define TCP_INPUT_DEBUG             LWIP_DBG_OFF
+#define TCP_OUTPUT_DEBUG            LWIP_DBG_OFF
+#define TCP_RTO_DEBUG               LWIP_DBG_OFF
+#define TCP_CWND_DEBUG              LWIP_DBG_OFF
+#define TCP_WND_DEBUG               LWIP_DBG_OFF
+#define TCP_FR_DEBUG                LWIP_DBG_OFF
+#define TCP_QLEN_DEBUG              LWIP_DBG_OFF
+#define TCP_RST_DEBUG               LWIP_DBG_OFF
+#define UDP_DEBUG                   LWIP_DBG_OFF
+#define DHCP_DEBUG                  LWIP_DBG_OFF
+
+#endif // _LWIPOPTS_H
@@ -398,8 +398,8 @@ const OutputInterface** app_get_output_interfaces(uint8_t* count)
 #if REQUIRE_BLE_OUTPUT
 // Deep-sleep config (set in app_init from the pad config).
 // Idle timeout: power down after this long with no input. 0 = disabled.
-// Only nRF implements platform_deep_sleep; elsewhere it's a no-op, so leave
-// the idle timer off there to avoid pointless periodic checks.
+// Only nRF builds of this app run on a battery, so leave the idle timer off
+// elsewhere to avoid pointless periodic checks.
 #ifndef CONTROLLER_BTUSB_IDLE_SLEEP_MS
 #ifdef PLATFORM_NRF
 #define CONTROLLER_BTUSB_IDLE_SLEEP_MS (5u * 60u * 1000u)  // 5 minutes
@@ -0,0 +1,106 @@
+// app.c - USB2JVS App Entry Point
+// USB/BT controllers to JVS arcade mainboard adapter
+//
+// Initializes the JVS I/O board output and USB host input.
+// Two players, simple 1:1 routing (first controller = player 1).
+
+#include "app.h"
+#include "profiles.h"
+#include "core/router/router.h"
+#include "core/services/players/manager.h"
+#include "core/services/profiles/profile.h"
+#include "core/input_interface.h"
+#include "core/output_interface.h"
+#include "native/device/jvs/jvs_device.h"
+#include "native/device/jvs/jvs_node.h"
+#include "usb/usbh/usbh.h"
+#include <stdio.h>
+
+// ============================================================================
+// APP PROFILE CONFIGURATION
+// ============================================================================
+
+static const profile_config_t app_profile_config = {
+    .output_profiles = {
+        [OUTPUT_TARGET_JVS] = &jvs_profile_set,
+    },
+    .shared_profiles = NULL,
+};
+
+// ============================================================================
+// APP INPUT INTERFACES
+// ============================================================================
+
+static const InputInterface* input_interfaces[] = {
+    &usbh_input_interface,
+};
+
+const InputInterface** app_get_input_interfaces(uint8_t* count)
+{
+    *count = sizeof(input_interfaces) / sizeof(input_interfaces[0]);
+    return input_interfaces;
+}
+
+// ============================================================================
+// APP OUTPUT INTERFACES
+// ============================================================================
+
+static const OutputInterface* output_interfaces[] = {
+    &jvs_output_interface,
+};
+
+const OutputInterface** app_get_output_interfaces(uint8_t* count)
+{
+    *count = sizeof(output_interfaces) / sizeof(output_interfaces[0]);
+    return output_interfaces;
+}
+
+// ============================================================================
+// APP INITIALIZATION
+// ============================================================================
+
+void app_init(void)
+{
+    printf("[app:usb2jvs] Initializing usb2jvs v%s\n", JOYPAD_VERSION);
+
+    // Configure router: each controller is one side of the cabinet
+    router_config_t router_cfg = {
+        .mode = ROUTING_MODE,
+        .merge_mode = MERGE_MODE,
+        .max_players_per_output = {
+            [OUTPUT_TARGET_JVS] = JVS_NODE_PLAYERS,
+        },
+        .merge_all_inputs = false,
+        .transform_flags = TRANSFORM_FLAGS,
+        .mouse_drain_rate = 0,      // Rotary counts come from every mouse delta
+    };
+    router_init(&router_cfg);
+
+    // Add route: USB -> JVS
+    router_add_route(INPUT_SOURCE_USB_HOST, OUTPUT_TARGET_JVS, 0);
+
+    // Configure player management
+    player_config_t player_cfg = {
+        .slot_mode       = PLAYER_SLOT_MODE,
+        .max_slots       = MAX_PLAYER_SLOTS,
+        .auto_assign_on_press = AUTO_ASSIGN_ON_PRESS,
+    };
+    players_init_with_config(&player_cfg);
+
+    // Initialize profile system
+    profile_init(&app_profile_config);
+
+    printf("[app:usb2jvs] Init complete\n");
+    printf("[app:usb2jvs]   Board:  %s\n", BOARD);
+    printf("[app:usb2jvs]   Output: JVS I/O board (%s)\n", JVS_NODE_IDENT);
+    printf("[app:usb2jvs]   Coin: Select, Test: Home, Service: Capture\n");
+}
+
+// ============================================================================
+// APP TASK
+// ============================================================================
+
+void app_task(void)
+{
+    // No app-specific periodic work needed
+}
@@ -0,0 +1,60 @@
+// app.h - USB2JVS App Manifest
+// USB/BT controllers to JVS arcade mainboard adapter
+//
+// The adapter acts as a two-player JVS I/O board on RS-485, so modern
+// controllers can drive Naomi, Triforce, Chihiro and Lindbergh games.
+
+#ifndef APP_USB2JVS_H
+#define APP_USB2JVS_H
+
+// ============================================================================
+// APP METADATA
+// ============================================================================
+#define APP_NAME        "USB2JVS"
+#define APP_DESCRIPTION "USB/BT to JVS arcade I/O board adapter"
+#define APP_AUTHOR      "RobertDaleSmith"
+
+// ============================================================================
+// CORE DEPENDENCIES (What drivers to compile in)
+// ============================================================================
+
+// Input drivers
+#define REQUIRE_USB_HOST        1
+#define MAX_USB_DEVICES         4
+
+// Output drivers
+#define REQUIRE_NATIVE_JVS_OUTPUT   1
+
+// Services
+#define REQUIRE_FLASH_SETTINGS      1
+#define REQUIRE_PLAYER_MANAGEMENT   1
+
+// ============================================================================
+// ROUTING CONFIGURATION
+// ============================================================================
+#define ROUTING_MODE    ROUTING_MODE_SIMPLE     // Each controller is one cabinet player
+#define MERGE_MODE      MERGE_ALL
+#define APP_MAX_ROUTES  1
+#define TRANSFORM_FLAGS 0
+
+// ============================================================================
+// PLAYER MANAGEMENT
+// ============================================================================
+#define PLAYER_SLOT_MODE        PLAYER_SLOT_FIXED   // Players keep their side of the panel
+#define MAX_PLAYER_SLOTS        2
+#define AUTO_ASSIGN_ON_PRESS    1
+
+// ============================================================================
+// HARDWARE CONFIGURATION
+// ============================================================================
+#define BOARD               "rp2040zero"
+#define CPU_OVERCLOCK_KHZ   0
+#define UART_DEBUG          0
+
+// ============================================================================
+// APP INTERFACE (OS calls these)
+// ============================================================================
+void app_init(void);
+void app_task(void);
+
+#endif // APP_USB2JVS_H
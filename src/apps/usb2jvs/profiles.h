@@ -0,0 +1,45 @@
+// profiles.h - USB2JVS Button Mapping Profiles
+//
+// Profile 1 (Default): 6-button panel — pass-through, the jvs_buttons.h
+//                      layout puts PUSH1-3 on the top row (B3, B4, R1) and
+//                      PUSH4-6 on the bottom row (B1, B2, R2)
+// Profile 2: 4-button — face buttons as PUSH1-4 for games that only read
+//            the first four buttons
+
+#pragma once
+
+#include "core/services/profiles/profile.h"
+#include "native/device/jvs/jvs_buttons.h"
+
+// Profile 1: 6-button panel
+static const profile_t jvs_profile_default = {
+    .name             = "6-Button",
+    .button_map       = NULL,
+    .button_map_count = 0,
+};
+
+// Profile 2: face buttons in reading order
+static const button_map_entry_t jvs_4button_map[] = {
+    MAP_BUTTON(JP_BUTTON_B1, JVS_BUTTON_PUSH1),  // South -> PUSH1
+    MAP_BUTTON(JP_BUTTON_B2, JVS_BUTTON_PUSH2),  // East  -> PUSH2
+    MAP_BUTTON(JP_BUTTON_B3, JVS_BUTTON_PUSH3),  // West  -> PUSH3
+    MAP_BUTTON(JP_BUTTON_B4, JVS_BUTTON_PUSH4),  // North -> PUSH4
+};
+
+static const profile_t jvs_profile_4button = {
+    .name             = "4-Button",
+    .button_map       = jvs_4button_map,
+    .button_map_count = sizeof(jvs_4button_map) / sizeof(jvs_4button_map[0]),
+};
+
+// Profile array and set
+static const profile_t jvs_profiles[] = {
+    jvs_profile_default,
+    jvs_profile_4button,
+};
+
+static const profile_set_t jvs_profile_set = {
+    .profiles      = jvs_profiles,
+    .profile_count = sizeof(jvs_profiles) / sizeof(jvs_profiles[0]),
+    .default_index = 0,
+};
@@ -0,0 +1,93 @@
+// app.c - USB2KB App Entry Point
+// USB/BT keyboards to PS/2 and Amiga keyboard adapter
+//
+// Initializes the PS/2 and Amiga keyboard outputs and USB host input.
+// Every keyboard merges into one; both outputs get every key transition.
+
+#include "app.h"
+#include "core/router/router.h"
+#include "core/services/players/manager.h"
+#include "core/input_interface.h"
+#include "core/output_interface.h"
+#include "native/device/ps2/ps2_device.h"
+#include "native/device/amiga/amiga_kb_device.h"
+#include "usb/usbh/usbh.h"
+#include <stdio.h>
+
+// ============================================================================
+// APP INPUT INTERFACES
+// ============================================================================
+
+static const InputInterface* input_interfaces[] = {
+    &usbh_input_interface,
+};
+
+const InputInterface** app_get_input_interfaces(uint8_t* count)
+{
+    *count = sizeof(input_interfaces) / sizeof(input_interfaces[0]);
+    return input_interfaces;
+}
+
+// ============================================================================
+// APP OUTPUT INTERFACES
+// ============================================================================
+
+static const OutputInterface* output_interfaces[] = {
+    &ps2_output_interface,
+    &amiga_kb_output_interface,
+};
+
+const OutputInterface** app_get_output_interfaces(uint8_t* count)
+{
+    *count = sizeof(output_interfaces) / sizeof(output_interfaces[0]);
+    return output_interfaces;
+}
+
+// ============================================================================
+// APP INITIALIZATION
+// ============================================================================
+
+void app_init(void)
+{
+    printf("[app:usb2kb] Initializing usb2kb v%s\n", JOYPAD_VERSION);
+
+    // Configure router: all keyboards are one, fed to both outputs
+    router_config_t router_cfg = {
+        .mode = ROUTING_MODE,
+        .merge_mode = MERGE_MODE,
+        .max_players_per_output = {
+            [OUTPUT_TARGET_PS2] = 1,
+            [OUTPUT_TARGET_AMIGA_KB] = 1,
+        },
+        .merge_all_inputs = true,
+        .transform_flags = TRANSFORM_FLAGS,
+        .mouse_drain_rate = 0,
+    };
+    router_init(&router_cfg);
+
+    // Add routes: USB -> PS/2, USB -> Amiga keyboard
+    router_add_route(INPUT_SOURCE_USB_HOST, OUTPUT_TARGET_PS2, 0);
+    router_add_route(INPUT_SOURCE_USB_HOST, OUTPUT_TARGET_AMIGA_KB, 0);
+
+    // Configure player management
+    player_config_t player_cfg = {
+        .slot_mode       = PLAYER_SLOT_MODE,
+        .max_slots       = MAX_PLAYER_SLOTS,
+        .auto_assign_on_press = AUTO_ASSIGN_ON_PRESS,
+    };
+    players_init_with_config(&player_cfg);
+
+    printf("[app:usb2kb] Init complete\n");
+    printf("[app:usb2kb]   Board:  %s\n", BOARD);
+    printf("[app:usb2kb]   PS/2:   DATA=%d CLK=%d\n", PS2_PIN_DATA, PS2_PIN_CLK);
+    printf("[app:usb2kb]   Amiga:  KDAT=%d KCLK=%d\n", AMIGA_KB_PIN_KDAT, AMIGA_KB_PIN_KCLK);
+}
+
+// ============================================================================
+// APP TASK
+// ============================================================================
+
+void app_task(void)
+{
+    // No app-specific periodic work needed
+}
@@ -0,0 +1,63 @@
+// app.h - USB2KB App Manifest
+// USB/BT keyboards to PS/2 and Amiga keyboard adapter
+//
+// The adapter is a PS/2 keyboard and an Amiga keyboard at the same time:
+// plug whichever port the machine has. Every key transition the USB or
+// Bluetooth keyboard reports is queued and sent in order at each
+// protocol's own pace.
+
+#ifndef APP_USB2KB_H
+#define APP_USB2KB_H
+
+// ============================================================================
+// APP METADATA
+// ============================================================================
+#define APP_NAME        "USB2KB"
+#define APP_DESCRIPTION "USB/BT to PS/2 and Amiga keyboard adapter"
+#define APP_AUTHOR      "RobertDaleSmith"
+
+// ============================================================================
+// CORE DEPENDENCIES (What drivers to compile in)
+// ============================================================================
+
+// Input drivers
+#define REQUIRE_USB_HOST        1
+#define MAX_USB_DEVICES         4
+
+// Output drivers
+#define REQUIRE_NATIVE_PS2_OUTPUT       1
+#define REQUIRE_NATIVE_AMIGA_KB_OUTPUT  1
+
+// Services
+#define REQUIRE_FLASH_SETTINGS      1
+#define REQUIRE_PLAYER_MANAGEMENT   1
+
+// ============================================================================
+// ROUTING CONFIGURATION
+// ============================================================================
+#define ROUTING_MODE    ROUTING_MODE_MERGE      // One keyboard toward the machine
+#define MERGE_MODE      MERGE_ALL
+#define APP_MAX_ROUTES  2
+#define TRANSFORM_FLAGS 0
+
+// ============================================================================
+// PLAYER MANAGEMENT
+// ============================================================================
+#define PLAYER_SLOT_MODE        PLAYER_SLOT_SHIFT
+#define MAX_PLAYER_SLOTS        4       // Any attached keyboard types; all merge to one
+#define AUTO_ASSIGN_ON_PRESS    1
+
+// ============================================================================
+// HARDWARE CONFIGURATION
+// ============================================================================
+#define BOARD               "rp2040zero"
+#define CPU_OVERCLOCK_KHZ   0
+#define UART_DEBUG          0
+
+// ============================================================================
+// APP INTERFACE (OS calls these)
+// ============================================================================
+void app_init(void);
+void app_task(void);
+
+#endif // APP_USB2KB_H
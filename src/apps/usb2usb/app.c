@@ -551,7 +551,9 @@ static void oled_update_display(void) {
 
     // Only tick + render the visible page's animation. The other state
     // machines stay frozen until their page is selected; events above
-    // still update them so the freeze is benign.
+    // still update them so the freeze is benign. Drawing stays on Core 0
+    // with the state it reads; display_update() hands a copy of the
+    // finished frame to Core 1 for the panel flush.
     switch (oled_current_page) {
         case OLED_PAGE_JOY:
             joy_anim_tick(now);
@@ -617,7 +619,9 @@ void app_init(void)
     button_init();
     button_set_callback(on_button_event);
 
-    // Configure router for USB2USB
+    // Configure router for USB2USB. Multi-port output modes (Xbox OG 4-Port)
+    // give each controller its own port instead of merging to one gamepad.
+    uint8_t usb_ports = usbd_get_port_count();
     router_config_t router_cfg = {
         .mode = ROUTING_MODE,
         .merge_mode = MERGE_MODE,
@@ -632,6 +636,11 @@ void app_init(void)
         .mouse_target_y = MOUSE_AXIS_DISABLED,  // Y disabled (X-only for camera pan)
         .mouse_drain_rate = 0,                  // No drain - hold position until head returns
     };
+    if (usb_ports > 1) {
+        router_cfg.mode = ROUTING_MODE_SIMPLE;
+        router_cfg.merge_all_inputs = false;
+        router_cfg.max_players_per_output[OUTPUT_TARGET_USB_DEVICE] = usb_ports;
+    }
     router_init(&router_cfg);
 
     // Add default route: USB Host → USB Device
@@ -762,7 +771,15 @@ void app_task(void)
     // Route feedback from USB device output to USB host input controllers
     // The output interface receives rumble/LED from the console/host
     // and we forward it to connected controllers via the feedback system
-    if (usbd_output_interface.get_feedback) {
+    if (usbd_get_port_count() > 1) {
+        // One port per player: each port's rumble goes to its own controller
+        for (int i = 0; i < playersCount && i < usbd_get_port_count(); i++) {
+            output_feedback_t fb;
+            if (usbd_get_port_feedback(i, &fb)) {
+                feedback_set_rumble(i, fb.rumble_left, fb.rumble_right);
+            }
+        }
+    } else if (usbd_output_interface.get_feedback) {
         output_feedback_t fb;
         if (usbd_output_interface.get_feedback(&fb)) {
             // Set feedback for all active players
@@ -21,6 +21,7 @@ extern const uint8_t *ble_xbox_profile_data;
 #include "core/buttons.h"
 #include "core/input_event.h"
 #include "core/router/router.h"
+#include "core/power.h"
 #include "core/services/players/feedback.h"
 #include "core/services/storage/flash.h"
 #include "usb/usbd/cdc/cdc_commands.h"
@@ -482,6 +483,7 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
             con_handle = HCI_CON_HANDLE_INVALID;
             ble_connected = false;
             pending_type = PENDING_NONE;
+            power_note_activity();
 
             // Distinguish a deliberate host disconnect from a dropped link:
             //   0x13 = remote user terminated   (host "disconnected")
@@ -526,6 +528,7 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
                     con_handle = hids_subevent_input_report_enable_get_con_handle(packet);
                     ble_connected = true;
                     printf("[ble_output] BLE connected (handle=0x%04x)\n", con_handle);
+                    power_note_activity();  // stay at full speed through setup
                     // A connection stops advertising (single adv set on nRF).
                     adv_on = false;
                     break;
@@ -569,6 +572,11 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
                             default:
                                 break;
                         }
+                        // A changed report means real input reached the host
+                        // (mouse motion never shows up as router activity).
+                        // SInput streams IMU samples continuously, so only
+                        // the pad's own activity tracking counts there.
+                        if (pending_type != PENDING_SINPUT) power_note_activity();
                         pending_type = PENDING_NONE;
                     }
                     break;
@@ -637,6 +645,11 @@ void ble_output_init(void)
     printf("[ble_output] Initializing BLE output (mode: %s)\n",
            ble_output_get_mode_name(current_mode));
 
+    // Battery-capable output: idle the main loop between inputs. The radio's
+    // host-wake line interrupts an idle wait; BTstack timers run on the next
+    // tick (at most POWER_GATED_TICK_US late).
+    power_enable();
+
     // Initialize reports to neutral state
     memset(&pending_gamepad, 0, sizeof(pending_gamepad));
     pending_gamepad.hat = BLE_HAT_CENTER;
@@ -11,6 +11,7 @@
 #include "core/buttons.h"
 #include "core/services/players/manager.h"
 #include "core/services/players/feedback.h"
+#include "usb/usbh/hid/devices/vendors/nintendo/switch_cal.h"  // Shared with the USB host driver (no tusb.h)
 #include "platform/platform.h"
 #include <string.h>
 #include <stdio.h>
@@ -21,6 +22,7 @@
 
 // Report IDs
 #define SWITCH_REPORT_INPUT_STANDARD    0x30    // Standard full input report
+#define SWITCH_REPORT_SUBCMD_REPLY      0x21    // Subcommand reply (same input prefix as 0x30)
 #define SWITCH_REPORT_INPUT_SIMPLE      0x3F    // Simple HID mode
 #define SWITCH_REPORT_OUTPUT            0x01    // Output report with subcommand
 #define SWITCH_REPORT_RUMBLE_ONLY       0x10    // Rumble only (no subcommand)
@@ -38,6 +40,11 @@
 // Init delay between subcommands (ms)
 #define SWITCH_INIT_DELAY_MS            200
 
+// SPI calibration reads are reply-driven: per-read timeout and retries
+// before giving up on a controller that doesn't answer subcommand 0x10
+#define SWITCH_CAL_READ_TIMEOUT_MS      100
+#define SWITCH_CAL_READ_RETRIES         2
+
 // ============================================================================
 // SWITCH PRO REPORT STRUCTURE
 // ============================================================================
@@ -126,7 +133,9 @@ typedef struct __attribute__((packed)) {
 
 typedef enum {
     SWITCH_STATE_WAIT_READY,        // Wait before sending first subcommand
+    SWITCH_STATE_READ_CAL,          // SPI reads (0x10) for stick/IMU calibration, skipped on cache hit
     SWITCH_STATE_SET_INPUT_MODE,    // Send set input mode (0x03 → 0x30)
+    SWITCH_STATE_ENABLE_IMU,        // Send enable IMU (0x40 → 0x01)
     SWITCH_STATE_ENABLE_VIBRATION,  // Send enable vibration (0x48 → 0x01)
     SWITCH_STATE_SET_PLAYER_LED,    // Send player LED (0x30)
     SWITCH_STATE_ACTIVE,            // Init complete, monitor feedback
@@ -145,6 +154,16 @@ typedef struct {
     uint32_t init_time;     // Timestamp for init delays
     uint8_t rumble_left;    // Cached rumble state
     uint8_t rumble_right;
+
+    // SPI flash calibration, read before 0x30 streaming starts or loaded
+    // from the cache by BD_ADDR
+    switch_cal_t cal;
+    bool cal_pending;
+    uint8_t cal_region;
+    uint8_t cal_retries;
+    bool cal_store;         // All regions read, write them to the cache
+    bool imu_enabled;
+    uint8_t imu_last[SWITCH_IMU_FRAME_SIZE];  // Newest raw IMU frame already forwarded
 } switch_bt_data_t;
 
 static switch_bt_data_t switch_data[BTHID_MAX_DEVICES];
@@ -215,6 +234,17 @@ static void switch_send_subcommand(bthid_device_t* device, uint8_t subcmd,
     bthid_send_output_report(device->conn_index, SWITCH_REPORT_OUTPUT, buf, 10 + len);
 }
 
+// Read the next calibration region from SPI flash
+static void switch_send_cal_read(bthid_device_t* device)
+{
+    switch_bt_data_t* sw = (switch_bt_data_t*)device->driver_data;
+    uint8_t args[5];
+    switch_cal_spi_args(sw->cal_region, args);
+    switch_send_subcommand(device, SWITCH_SUBCMD_SPI_READ, args, sizeof(args));
+    sw->cal_pending = true;
+    sw->init_time = platform_time_ms();
+}
+
 static void switch_send_rumble(bthid_device_t* device, uint8_t left, uint8_t right)
 {
     switch_bt_data_t* sw = (switch_bt_data_t*)device->driver_data;
@@ -278,6 +308,19 @@ static bool switch_init(bthid_device_t* device)
             switch_data[i].output_seq = 0;
             switch_data[i].rumble_left = 0;
             switch_data[i].rumble_right = 0;
+            switch_data[i].cal_pending = false;
+            switch_data[i].cal_region = 0;
+            switch_data[i].cal_retries = 0;
+            switch_data[i].cal_store = false;
+            switch_data[i].imu_enabled = false;
+            memset(switch_data[i].imu_last, 0, sizeof(switch_data[i].imu_last));
+
+            // Known controller: calibration from the cache, skip the SPI reads
+            switch_cal_init(&switch_data[i].cal);
+            if (switch_cal_cache_load(device->bd_addr, &switch_data[i].cal)) {
+                printf("[SWITCH_BT] Calibration from cache\n");
+                switch_data[i].cal_region = SWITCH_CAL_REGION_COUNT;
+            }
 
             // Start init state machine — commands sent from task()
             switch_data[i].init_state = SWITCH_STATE_WAIT_READY;
@@ -304,11 +347,24 @@ static void switch_process_report(bthid_device_t* device, const uint8_t* data, u
 
     uint8_t report_id = data[0];
 
-    if (report_id == SWITCH_REPORT_INPUT_STANDARD && len >= 13) {
-        // Full input report (0x30)
+    // SPI calibration reply
+    if (report_id == SWITCH_REPORT_SUBCMD_REPLY && sw->cal_pending &&
+        switch_cal_spi_reply(&sw->cal, sw->cal_region, data, len)) {
+        sw->cal_pending = false;
+        sw->cal_retries = 0;
+        if (++sw->cal_region == SWITCH_CAL_REGION_COUNT) {
+            sw->cal_store = true;  // Written from task(), not the HID callback
+        }
+    }
+
+    if ((report_id == SWITCH_REPORT_INPUT_STANDARD || report_id == SWITCH_REPORT_SUBCMD_REPLY) && len >= 13) {
+        // Full input report (0x30), or a subcommand reply carrying the same
+        // input prefix
         const switch_input_report_t* rpt = (const switch_input_report_t*)data;
 
-        sw->full_report_mode = true;
+        if (report_id == SWITCH_REPORT_INPUT_STANDARD) {
+            sw->full_report_mode = true;
+        }
 
         // Build button state
         uint32_t buttons = 0x00000000;
@@ -347,18 +403,52 @@ static void switch_process_report(bthid_device_t* device, const uint8_t* data, u
         uint16_t rx = unpack_stick_12bit(rpt->right_stick, false);
         uint16_t ry = unpack_stick_12bit(rpt->right_stick, true);
 
-        // Scale to 8-bit and invert Y (Nintendo: up=high, HID: up=low)
-        sw->event.analog[ANALOG_LX] = scale_12bit_to_8bit(lx);
-        sw->event.analog[ANALOG_LY] = 255 - scale_12bit_to_8bit(ly);
-        sw->event.analog[ANALOG_RX] = scale_12bit_to_8bit(rx);
-        sw->event.analog[ANALOG_RY] = 255 - scale_12bit_to_8bit(ry);
+        // Scale to 8-bit and invert Y (Nintendo: up=high, HID: up=low).
+        // SPI calibration when the controller has it for that stick.
+        const switch_stick_cal_t* lcal = &sw->cal.stick[0];
+        const switch_stick_cal_t* rcal = &sw->cal.stick[1];
+        if (lcal->valid) {
+            sw->event.analog[ANALOG_LX] = switch_cal_stick_axis(lcal, 0, lx);
+            sw->event.analog[ANALOG_LY] = 255 - switch_cal_stick_axis(lcal, 1, ly);
+        } else {
+            sw->event.analog[ANALOG_LX] = scale_12bit_to_8bit(lx);
+            sw->event.analog[ANALOG_LY] = 255 - scale_12bit_to_8bit(ly);
+        }
+        if (rcal->valid) {
+            sw->event.analog[ANALOG_RX] = switch_cal_stick_axis(rcal, 0, rx);
+            sw->event.analog[ANALOG_RY] = 255 - switch_cal_stick_axis(rcal, 1, ry);
+        } else {
+            sw->event.analog[ANALOG_RX] = scale_12bit_to_8bit(rx);
+            sw->event.analog[ANALOG_RY] = 255 - scale_12bit_to_8bit(ry);
+        }
 
         // Battery: bits 7-4 = level (0/2/4/6/8), bit 3 = charging
         uint8_t bat_raw = rpt->battery_conn >> 4;
         sw->event.battery_level = (bat_raw > 8) ? 100 : bat_raw * 12 + 5;
         sw->event.battery_charging = (rpt->battery_conn & 0x08) != 0;
 
-        router_submit_input(&sw->event);
+        // IMU: one event per new sample, oldest first, so per-event
+        // consumers (router taps) see motion at the sensor's 5 ms rate.
+        // A report with no new frame resends the newest sample.
+        if (sw->imu_enabled && report_id == SWITCH_REPORT_INPUT_STANDARD &&
+            len >= SWITCH_IMU_REPORT_MIN_LEN) {
+            const uint8_t* imu = &data[SWITCH_IMU_OFFSET];
+            uint8_t fresh = switch_cal_new_imu_frames(imu, sw->imu_last);
+
+            sw->event.has_motion = true;
+            sw->event.accel_range = SWITCH_IMU_ACCEL_RANGE;
+            sw->event.gyro_range = SWITCH_IMU_GYRO_RANGE;
+            sw->event.motion_dt_us = fresh ? SWITCH_IMU_SAMPLE_US : MOTION_DT_REPEAT;
+            if (fresh == 0) fresh = 1;
+            for (int i = fresh - 1; i >= 0; i--) {
+                switch_cal_imu_frame(&sw->cal.imu, &imu[i * SWITCH_IMU_FRAME_SIZE],
+                                     sw->event.accel, sw->event.gyro);
+                router_submit_input(&sw->event);
+            }
+        } else {
+            sw->event.motion_dt_us = MOTION_DT_REPEAT;  // Any motion is the last sample again
+            router_submit_input(&sw->event);
+        }
 
     } else if (report_id == SWITCH_REPORT_INPUT_SIMPLE && len >= 12) {
         // Simple HID report (0x3F) - used before full mode enabled
@@ -409,15 +499,57 @@ static void switch_task(bthid_device_t* device)
         case SWITCH_STATE_WAIT_READY:
             // Wait before sending first subcommand
             if (now - sw->init_time >= SWITCH_INIT_DELAY_MS) {
-                printf("[SWITCH_BT] Sending set input mode (0x30)\n");
-                uint8_t mode = SWITCH_INPUT_MODE_FULL;
-                switch_send_subcommand(device, SWITCH_SUBCMD_SET_INPUT_MODE, &mode, 1);
-                sw->init_state = SWITCH_STATE_SET_INPUT_MODE;
-                sw->init_time = now;
+                sw->init_state = SWITCH_STATE_READ_CAL;
+                if (sw->cal_region < SWITCH_CAL_REGION_COUNT) {
+                    printf("[SWITCH_BT] Reading calibration\n");
+                    switch_send_cal_read(device);
+                }
+            }
+            break;
+
+        case SWITCH_STATE_READ_CAL: {
+            // Calibration is read before switching to 0x30 so the first full
+            // report is already calibrated. Replies advance cal_region.
+            if (sw->cal_pending) {
+                if (now - sw->init_time < SWITCH_CAL_READ_TIMEOUT_MS) break;
+                sw->cal_pending = false;
+                if (++sw->cal_retries <= SWITCH_CAL_READ_RETRIES) {
+                    switch_send_cal_read(device);
+                    break;
+                }
+                printf("[SWITCH_BT] No SPI calibration reply, using defaults\n");
+                sw->cal_region = SWITCH_CAL_REGION_COUNT;
+            } else if (sw->cal_region < SWITCH_CAL_REGION_COUNT) {
+                switch_send_cal_read(device);
+                break;
+            }
+
+            if (sw->cal_store) {
+                switch_cal_cache_store(device->bd_addr, &sw->cal);
+                sw->cal_store = false;
             }
+
+            printf("[SWITCH_BT] Sending set input mode (0x30)\n");
+            uint8_t mode = SWITCH_INPUT_MODE_FULL;
+            switch_send_subcommand(device, SWITCH_SUBCMD_SET_INPUT_MODE, &mode, 1);
+            sw->init_state = SWITCH_STATE_SET_INPUT_MODE;
+            sw->init_time = now;
             break;
+        }
 
         case SWITCH_STATE_SET_INPUT_MODE:
+            if (now - sw->init_time >= SWITCH_INIT_DELAY_MS) {
+                printf("[SWITCH_BT] Sending enable IMU\n");
+                uint8_t enable = 0x01;
+                switch_send_subcommand(device, SWITCH_SUBCMD_ENABLE_IMU, &enable, 1);
+                sw->imu_enabled = true;
+                memset(sw->imu_last, 0, sizeof(sw->imu_last));
+                sw->init_state = SWITCH_STATE_ENABLE_IMU;
+                sw->init_time = now;
+            }
+            break;
+
+        case SWITCH_STATE_ENABLE_IMU:
             if (now - sw->init_time >= SWITCH_INIT_DELAY_MS) {
                 printf("[SWITCH_BT] Sending enable vibration\n");
                 uint8_t enable = 0x01;
@@ -1,6 +1,7 @@
 // wiimote_bt.c - Nintendo Wiimote Bluetooth Driver
 //
 // Supports the Wiimote (RVL-CNT-01) core buttons and Nunchuk extension.
+// The IR camera is enabled and tracked (wiimote_ir.c) as a screen pointer.
 // Device name: "Nintendo RVL-CNT-01"
 //
 // References:
@@ -8,6 +9,7 @@
 // - https://wiibrew.org/wiki/Wiimote
 
 #include "wiimote_bt.h"
+#include "wiimote_ir.h"
 #include "bt/bthid/bthid.h"
 #include "bt/btstack/btstack_host.h"
 #include "core/input_event.h"
@@ -111,9 +113,26 @@ typedef enum {
 // Output report IDs
 #define WII_CMD_LED             0x11
 #define WII_CMD_REPORT_MODE     0x12
+#define WII_CMD_IR_ENABLE       0x13
 #define WII_CMD_STATUS_REQ      0x15
 #define WII_CMD_WRITE_DATA      0x16
 #define WII_CMD_READ_DATA       0x17
+#define WII_CMD_IR_ENABLE2      0x1A
+
+// Memory/register address spaces for read and write
+#define WII_SPACE_EEPROM        0x00
+#define WII_SPACE_REGISTER      0x04
+
+// IR camera registers
+#define WII_IR_REG_CONTROL      0xB00030
+#define WII_IR_REG_SENS1        0xB00000
+#define WII_IR_REG_SENS2        0xB0001A
+#define WII_IR_REG_MODE         0xB00033
+
+// Camera enable: two output reports, then five register writes
+#define WII_IR_STEPS            7
+// Output reports 0x13/0x1A: give the camera a moment before the register writes
+#define WII_IR_ENABLE_DELAY_US  50000
 
 // ============================================================================
 // DRIVER STATE
@@ -130,6 +149,10 @@ typedef enum {
     WII_STATE_WAIT_EXT_INIT2_ACK,
     WII_STATE_READ_EXT_TYPE,
     WII_STATE_WAIT_EXT_TYPE,
+    WII_STATE_READ_ACCEL_CAL,
+    WII_STATE_WAIT_ACCEL_CAL,
+    WII_STATE_SEND_IR_STEP,
+    WII_STATE_WAIT_IR_STEP,
     WII_STATE_SEND_REPORT_MODE,
     WII_STATE_WAIT_REPORT_ACK,
     WII_STATE_SEND_LED,
@@ -160,6 +183,10 @@ typedef struct {
     bool rumble_on;
     wiimote_orient_t orientation;
     bool orient_hotkey_active;  // Prevent repeated hotkey triggers
+    bool accel_cal_read;        // EEPROM accel calibration tried
+    uint8_t ir_mode;            // Camera data mode set up (0 = off)
+    uint8_t ir_step;            // Position in the camera enable sequence
+    wiimote_ir_t ir;
 } wiimote_data_t;
 
 static wiimote_data_t wiimote_data[BTHID_MAX_DEVICES];
@@ -190,27 +217,35 @@ static bool wiimote_request_status(bthid_device_t* device)
     return btstack_wiimote_send_control(device->conn_index, buf, sizeof(buf));
 }
 
-static bool wiimote_write_data(bthid_device_t* device, uint32_t address, uint8_t data)
+// Write up to 16 bytes to the register space
+static bool wiimote_write_block(bthid_device_t* device, uint32_t address,
+                                const uint8_t* data, uint8_t size)
 {
     uint8_t buf[23];
+    if (size > 16) size = 16;
     memset(buf, 0, sizeof(buf));
     buf[0] = 0xA2;
     buf[1] = WII_CMD_WRITE_DATA;
-    buf[2] = 0x04;  // Extension register space
+    buf[2] = WII_SPACE_REGISTER;
     buf[3] = (uint8_t)((address >> 16) & 0xFF);
     buf[4] = (uint8_t)((address >> 8) & 0xFF);
     buf[5] = (uint8_t)(address & 0xFF);
-    buf[6] = 0x01;  // Size = 1
-    buf[7] = data;
+    buf[6] = size;
+    memcpy(&buf[7], data, size);
     return btstack_wiimote_send_control(device->conn_index, buf, sizeof(buf));
 }
 
-static bool wiimote_read_data(bthid_device_t* device, uint32_t address, uint16_t size)
+static bool wiimote_write_data(bthid_device_t* device, uint32_t address, uint8_t data)
+{
+    return wiimote_write_block(device, address, &data, 1);
+}
+
+static bool wiimote_read_data(bthid_device_t* device, uint8_t space, uint32_t address, uint16_t size)
 {
     uint8_t buf[8];
     buf[0] = 0xA2;
     buf[1] = WII_CMD_READ_DATA;
-    buf[2] = 0x04;  // Extension register space
+    buf[2] = space;
     buf[3] = (uint8_t)((address >> 16) & 0xFF);
     buf[4] = (uint8_t)((address >> 8) & 0xFF);
     buf[5] = (uint8_t)(address & 0xFF);
@@ -221,14 +256,58 @@ static bool wiimote_read_data(bthid_device_t* device, uint32_t address, uint16_t
 
 static void wiimote_set_report_mode(bthid_device_t* device, bool has_extension)
 {
-    // 0x35 = buttons + accel + 16 ext bytes (for orientation detection + extension)
-    // 0x31 = buttons + accel only (for orientation detection, no extension)
-    uint8_t mode = has_extension ? 0x35 : 0x31;
+    // Accel for orientation detection and IR roll, IR for the pointer:
+    // 0x37 = buttons + accel + 10 basic IR + 6 ext bytes
+    // 0x33 = buttons + accel + 12 extended IR (no extension)
+    uint8_t mode = has_extension ? WII_REPORT_BUTTONS_ACC_IR_EXT6 : WII_REPORT_BUTTONS_ACC_IR;
     uint8_t buf[4] = { 0xA2, WII_CMD_REPORT_MODE, 0x00, mode };
     printf("[WIIMOTE] Setting report mode 0x%02X\n", mode);
     btstack_wiimote_send_raw(device->conn_index, buf, sizeof(buf));
 }
 
+// Camera data format that fits the report mode
+static uint8_t wiimote_ir_mode_wanted(const wiimote_data_t* wii)
+{
+    return wii->extension_connected ? WIIMOTE_IR_MODE_BASIC : WIIMOTE_IR_MODE_EXTENDED;
+}
+
+// Send one step of the IR camera enable sequence (wiibrew "Initialization").
+// Returns true if the step is a register write that gets a 0x22 ACK.
+static bool wiimote_ir_send_step(bthid_device_t* device, wiimote_data_t* wii)
+{
+    // Sensitivity: wiibrew's "level 3" (Marcan), a good default for most bars
+    static const uint8_t sens1[9] = { 0x02, 0x00, 0x00, 0x71, 0x01, 0x00, 0xAA, 0x00, 0x64 };
+    static const uint8_t sens2[2] = { 0x63, 0x03 };
+
+    switch (wii->ir_step) {
+        case 0: {
+            uint8_t buf[3] = { 0xA2, WII_CMD_IR_ENABLE, 0x04 };
+            btstack_wiimote_send_raw(device->conn_index, buf, sizeof(buf));
+            return false;
+        }
+        case 1: {
+            uint8_t buf[3] = { 0xA2, WII_CMD_IR_ENABLE2, 0x04 };
+            btstack_wiimote_send_raw(device->conn_index, buf, sizeof(buf));
+            return false;
+        }
+        case 2:
+        case 6:
+            wiimote_write_data(device, WII_IR_REG_CONTROL, 0x08);
+            return true;
+        case 3:
+            wiimote_write_block(device, WII_IR_REG_SENS1, sens1, sizeof(sens1));
+            return true;
+        case 4:
+            wiimote_write_block(device, WII_IR_REG_SENS2, sens2, sizeof(sens2));
+            return true;
+        case 5:
+            wiimote_write_data(device, WII_IR_REG_MODE, wiimote_ir_mode_wanted(wii));
+            return true;
+        default:
+            return false;
+    }
+}
+
 // Set rumble on/off
 // Report 0x10: rumble only, bit 0 = on/off
 static void wiimote_set_rumble(bthid_device_t* device, bool on)
@@ -334,6 +413,9 @@ static bool wiimote_init(bthid_device_t* device)
             wiimote_data[i].event.button_count = 11;  // Wiimote has fewer buttons
             wiimote_data[i].ext_type = WII_EXT_NONE;
             wiimote_data[i].extension_connected = false;
+            wiimote_data[i].accel_cal_read = false;
+            wiimote_data[i].ir_mode = 0;
+            wiimote_ir_init(&wiimote_data[i].ir);
 
             device->driver_data = &wiimote_data[i];
 
@@ -456,6 +538,12 @@ static void wiimote_process_report(bthid_device_t* device, const uint8_t* data,
                 ext_len = 16;
             }
 
+            else if (report_id == WII_REPORT_BUTTONS_ACC_IR_EXT6 && len >= 22) {
+                // Report 0x37: extension at offset 16 (after 10 bytes of basic IR)
+                ext = &data[16];
+                ext_len = 6;
+            }
+
             // Parse extension data
             if (ext != NULL && ext_len >= 6) {
 
@@ -595,6 +683,21 @@ static void wiimote_process_report(bthid_device_t* device, const uint8_t* data,
                 buttons = wiimote_rotate_controls(buttons, wii->orientation);
             }
 
+            // IR pointer: absolute position plus matching mouse deltas. Where
+            // the right stick is free it also aims like a GunCon (0-255 across
+            // the screen, centred when off screen).
+            if (wiimote_ir_report(&wii->ir, data, len, platform_time_us())) {
+                wii->event.has_pointer = wii->ir.visible;
+                wii->event.pointer_x = wii->ir.x;
+                wii->event.pointer_y = wii->ir.y;
+                wii->event.delta_x = wii->ir.dx;
+                wii->event.delta_y = wii->ir.dy;
+                if (wii->ext_type != WII_EXT_CLASSIC) {
+                    wii->event.analog[ANALOG_RX] = wii->ir.visible ? (uint8_t)(wii->ir.x >> 8) : 128;
+                    wii->event.analog[ANALOG_RY] = wii->ir.visible ? (uint8_t)(wii->ir.y >> 8) : 128;
+                }
+            }
+
             wii->event.buttons = buttons;
 
             if (wii->state == WII_STATE_READY) {
@@ -657,6 +760,9 @@ static void wiimote_process_report(bthid_device_t* device, const uint8_t* data,
                 wii->state = WII_STATE_SEND_EXT_INIT2;
             } else if (wii->state == WII_STATE_WAIT_EXT_INIT2_ACK && acked_report == WII_CMD_WRITE_DATA) {
                 wii->state = WII_STATE_READ_EXT_TYPE;
+            } else if (wii->state == WII_STATE_WAIT_IR_STEP && acked_report == WII_CMD_WRITE_DATA) {
+                wii->ir_step++;
+                wii->state = WII_STATE_SEND_IR_STEP;
             } else if (wii->state == WII_STATE_WAIT_REPORT_ACK && acked_report == WII_CMD_REPORT_MODE) {
                 wii->state = WII_STATE_SEND_LED;
             } else if (wii->state == WII_STATE_WAIT_LED_ACK && acked_report == WII_CMD_LED) {
@@ -676,6 +782,19 @@ static void wiimote_process_report(bthid_device_t* device, const uint8_t* data,
 
         printf("[WIIMOTE] Read response: SE=0x%02X size=%d error=%d len=%d\n", se, size, error, len);
 
+        if (wii->state == WII_STATE_WAIT_ACCEL_CAL) {
+            // Accelerometer calibration for the IR roll compensation
+            if (error == 0 && len >= 6 + WIIMOTE_ACCEL_CAL_LEN &&
+                wiimote_ir_set_accel_cal(&wii->ir, &data[6])) {
+                printf("[WIIMOTE] Accel cal: zero %02X %02X %02X, 1g %02X %02X %02X\n",
+                       data[6], data[7], data[8], data[10], data[11], data[12]);
+            } else {
+                printf("[WIIMOTE] Accel cal unreadable, using nominal\n");
+            }
+            wii->accel_cal_read = true;
+            wii->state = WII_STATE_SEND_REPORT_MODE;
+        }
+
         if (wii->state == WII_STATE_WAIT_EXT_TYPE) {
             // Extension type data starts at offset 6
             if (error == 0 && len >= 12) {
@@ -792,7 +911,7 @@ static void wiimote_task(bthid_device_t* device)
 
         case WII_STATE_READ_EXT_TYPE:
             if (btstack_wiimote_can_send(device->conn_index)) {
-                wiimote_read_data(device, 0xA400FA, 6);
+                wiimote_read_data(device, WII_SPACE_REGISTER, 0xA400FA, 6);
                 wii->state = WII_STATE_WAIT_EXT_TYPE;
                 wii->init_time = now + 1000000;
             }
@@ -804,7 +923,53 @@ static void wiimote_task(bthid_device_t* device)
             }
             break;
 
+        case WII_STATE_READ_ACCEL_CAL:
+            if (btstack_wiimote_can_send(device->conn_index)) {
+                wiimote_read_data(device, WII_SPACE_EEPROM, WIIMOTE_ACCEL_CAL_ADDR, WIIMOTE_ACCEL_CAL_LEN);
+                wii->state = WII_STATE_WAIT_ACCEL_CAL;
+                wii->init_time = now + 1000000;
+            }
+            break;
+
+        case WII_STATE_WAIT_ACCEL_CAL:
+            if ((int32_t)(now - wii->init_time) >= 0) {
+                wii->accel_cal_read = true;
+                wii->state = WII_STATE_SEND_REPORT_MODE;
+            }
+            break;
+
+        case WII_STATE_SEND_IR_STEP:
+            if (wii->ir_step >= WII_IR_STEPS) {
+                wii->ir_mode = wiimote_ir_mode_wanted(wii);
+                printf("[WIIMOTE] IR camera on (%s)\n",
+                       wii->ir_mode == WIIMOTE_IR_MODE_BASIC ? "basic" : "extended");
+                wii->state = WII_STATE_SEND_REPORT_MODE;
+            } else if (btstack_wiimote_can_send(device->conn_index)) {
+                bool acked = wiimote_ir_send_step(device, wii);
+                wii->state = WII_STATE_WAIT_IR_STEP;
+                wii->init_time = now + (acked ? 1000000 : WII_IR_ENABLE_DELAY_US);
+            }
+            break;
+
+        case WII_STATE_WAIT_IR_STEP:
+            // Register writes move on at their ACK; enables and lost ACKs here
+            if ((int32_t)(now - wii->init_time) >= 0) {
+                wii->ir_step++;
+                wii->state = WII_STATE_SEND_IR_STEP;
+            }
+            break;
+
         case WII_STATE_SEND_REPORT_MODE:
+            // Calibration and camera first, so the first IR report is usable
+            if (!wii->accel_cal_read) {
+                wii->state = WII_STATE_READ_ACCEL_CAL;
+                break;
+            }
+            if (wii->ir_mode != wiimote_ir_mode_wanted(wii)) {
+                wii->ir_step = 0;
+                wii->state = WII_STATE_SEND_IR_STEP;
+                break;
+            }
             if (btstack_wiimote_can_send(device->conn_index)) {
                 wiimote_set_report_mode(device, wii->extension_connected);
                 wii->state = WII_STATE_WAIT_REPORT_ACK;
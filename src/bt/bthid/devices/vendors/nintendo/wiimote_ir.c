@@ -0,0 +1,392 @@
+// wiimote_ir.c - Wiimote IR camera pointer tracking
+
+#include "wiimote_ir.h"
+#include <string.h>
+
+// ============================================================================
+// TUNING
+// ============================================================================
+
+// Camera area that maps to the whole screen. Smaller than the sensor so the
+// edges can be reached before a dot leaves the frame.
+#define SPAN_X                  768
+#define SPAN_Y                  576
+
+// Nominal accelerometer (10-bit) until the EEPROM calibration is read
+#define ACCEL_ZERO_NOMINAL      0x200
+#define ACCEL_ONE_G_NOMINAL     0x268
+
+// Gravity weaker than this (in the X/Z plane, 1/1024 g) leaves the roll as
+// it was: pointing straight up or down, or being swung hard
+#define ROLL_MIN_G              512
+#define ROLL_SMOOTH_SHIFT       1
+
+// Pairing: dots closer than this are one blob; pairs steeper than this after
+// roll compensation are a reflection, not the sensor bar (Q8 slope)
+#define PAIR_MIN_SEP            (16 * 8)
+#define PAIR_MAX_SLOPE          128
+
+// A lone dot is placed against the last pair for this long
+#define PAIR_HOLD_US            1000000
+// Lost for longer than this: the filter restarts where the pointer reappears
+#define REACQUIRE_US            100000
+
+// Report timing bounds (the Wiimote sends ~100 Hz, in bursts over BT)
+#define MIN_DT_US               1000
+#define MAX_DT_US               50000
+
+// One-Euro: cutoff = MIN_CUTOFF + BETA x speed. mHz, speed in pointer units/s.
+#define MIN_CUTOFF_MHZ          1000
+#define BETA_MHZ_PER_KUPS       90      // mHz per 1000 units/s
+#define MAX_CUTOFF_MHZ          60000
+#define D_CUTOFF_MHZ            5000
+// The filter lags by its time constant; predict forward by that much, up to
+// this horizon, so at speed the pointer is where the hand is
+#define LEAD_MAX_US             20000
+// Speed below this (pointer units/s) is sensor noise, not a hand moving, and
+// isn't predicted; without it a still pointer shimmers
+#define LEAD_DEADBAND_UPS       4000
+
+#define Q14                     16384
+#define POINTER_MAX             65535
+#define UNITS_PER_COUNT         ((POINTER_MAX + 1) / WIIMOTE_IR_MOUSE_COUNTS)
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static inline int32_t abs32(int32_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+static uint32_t isqrt(uint32_t v)
+{
+    uint32_t r = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return r;
+}
+
+// Smoothing factor for a low-pass at cutoff over dt, Q16:
+// a = r / (r + 1), r = 2 pi fc dt
+static int32_t euro_alpha(uint32_t cutoff_mhz, uint32_t dt_us)
+{
+    int64_t r = (int64_t)6283 * cutoff_mhz * dt_us;            // x 1e12
+    return (int32_t)((r << 16) / (r + 1000000000000LL));
+}
+
+// ============================================================================
+// DECODE
+// ============================================================================
+
+static void set_dot(wiimote_ir_dot_t* d, uint16_t x, uint16_t y, uint8_t size)
+{
+    d->x = x;
+    d->y = y;
+    d->size = size;
+    d->valid = !(x == 0x3FF && y == 0x3FF) && x < WIIMOTE_IR_CAM_W && y < WIIMOTE_IR_CAM_H;
+}
+
+void wiimote_ir_decode_basic(const uint8_t ir[10], wiimote_ir_dot_t dots[WIIMOTE_IR_DOTS])
+{
+    // Two dots per 5 bytes: X1 Y1 [Y1 9:8|X1 9:8|Y2 9:8|X2 9:8] X2 Y2
+    for (int p = 0; p < 2; p++) {
+        const uint8_t* b = &ir[p * 5];
+        set_dot(&dots[p * 2],     b[0] | ((b[2] & 0x30) << 4), b[1] | ((b[2] & 0xC0) << 2), 0);
+        set_dot(&dots[p * 2 + 1], b[3] | ((b[2] & 0x03) << 8), b[4] | ((b[2] & 0x0C) << 6), 0);
+    }
+}
+
+void wiimote_ir_decode_extended(const uint8_t ir[12], wiimote_ir_dot_t dots[WIIMOTE_IR_DOTS])
+{
+    // Three bytes per dot: X Y [Y 9:8|X 9:8|size]
+    for (int i = 0; i < WIIMOTE_IR_DOTS; i++) {
+        const uint8_t* b = &ir[i * 3];
+        set_dot(&dots[i], b[0] | ((b[2] & 0x30) << 4), b[1] | ((b[2] & 0xC0) << 2), b[2] & 0x0F);
+    }
+}
+
+// ============================================================================
+// ROLL
+// ============================================================================
+
+// Gravity in the Wiimote's X/Z plane gives the roll. Face up, Z reads +1 g;
+// rolled clockwise (seen from behind, right side down) X reads positive.
+static void update_roll(wiimote_ir_t* ir, const uint16_t accel[3])
+{
+    int32_t g[3];
+    for (int i = 0; i < 3; i += 2) {
+        int32_t span = (int32_t)ir->accel_one_g[i] - ir->accel_zero[i];
+        if (span <= 0) span = ACCEL_ONE_G_NOMINAL - ACCEL_ZERO_NOMINAL;
+        g[i] = (((int32_t)accel[i] - ir->accel_zero[i]) * 1024) / span;
+    }
+
+    int32_t mag = (int32_t)isqrt((uint32_t)(g[0] * g[0] + g[2] * g[2]));
+    if (mag < ROLL_MIN_G) return;
+
+    int32_t c = (g[2] * Q14) / mag;
+    int32_t s = (g[0] * Q14) / mag;
+    ir->roll_cos += (c - ir->roll_cos) >> ROLL_SMOOTH_SHIFT;
+    ir->roll_sin += (s - ir->roll_sin) >> ROLL_SMOOTH_SHIFT;
+
+    // Keep it a unit vector while the roll turns
+    int32_t len = (int32_t)isqrt((uint32_t)(ir->roll_cos * ir->roll_cos + ir->roll_sin * ir->roll_sin));
+    if (len > 0) {
+        ir->roll_cos = (ir->roll_cos * Q14) / len;
+        ir->roll_sin = (ir->roll_sin * Q14) / len;
+    }
+}
+
+// Camera dot -> roll-compensated pointer frame, 1/8 pixel, origin at the
+// camera centre. The camera sees the bar move opposite to the pointer in X.
+static void dot_to_frame(const wiimote_ir_t* ir, const wiimote_ir_dot_t* d, int32_t out[2])
+{
+    int32_t u = (1023 - 2 * (int32_t)d->x) * 4;
+    int32_t v = (2 * (int32_t)d->y - 767) * 4;
+    out[0] = (u * ir->roll_cos - v * ir->roll_sin) / Q14;
+    out[1] = (u * ir->roll_sin + v * ir->roll_cos) / Q14;
+}
+
+// ============================================================================
+// PAIRING
+// ============================================================================
+
+static int64_t dist2(const int32_t a[2], const int32_t b[2])
+{
+    int64_t du = a[0] - b[0], dv = a[1] - b[1];
+    return du * du + dv * dv;
+}
+
+// Find the sensor bar midpoint. Returns false if it can't be placed.
+static bool find_midpoint(wiimote_ir_t* ir, const wiimote_ir_dot_t dots[WIIMOTE_IR_DOTS],
+                          uint32_t now_us, int32_t mid[2])
+{
+    int32_t p[WIIMOTE_IR_DOTS][2];
+    int n = 0;
+    for (int i = 0; i < WIIMOTE_IR_DOTS; i++) {
+        if (dots[i].valid) dot_to_frame(ir, &dots[i], p[n++]);
+    }
+
+    // Two or more: the flattest pair, preferring the separation we had
+    int best_a = -1, best_b = -1;
+    int32_t best_cost = 0;
+    int32_t sep = ir->has_pair ? ir->right[0] - ir->left[0] : 0;
+    for (int a = 0; a < n; a++) {
+        for (int b = a + 1; b < n; b++) {
+            int32_t du = abs32(p[b][0] - p[a][0]);
+            int32_t dv = abs32(p[b][1] - p[a][1]);
+            if (du < PAIR_MIN_SEP) continue;
+            int32_t slope = (dv * 256) / du;
+            if (slope > PAIR_MAX_SLOPE) continue;
+            int32_t cost = slope;
+            if (sep > 0) cost += (abs32(du - sep) * 256) / sep;
+            if (best_a < 0 || cost < best_cost) {
+                best_a = a;
+                best_b = b;
+                best_cost = cost;
+            }
+        }
+    }
+
+    if (best_a >= 0) {
+        int l = p[best_a][0] < p[best_b][0] ? best_a : best_b;
+        int r = l == best_a ? best_b : best_a;
+        memcpy(ir->left, p[l], sizeof(ir->left));
+        memcpy(ir->right, p[r], sizeof(ir->right));
+        ir->has_pair = true;
+        ir->pair_us = now_us;
+        mid[0] = (ir->left[0] + ir->right[0]) / 2;
+        mid[1] = (ir->left[1] + ir->right[1]) / 2;
+        return true;
+    }
+
+    // One dot: whichever end of the last pair it is nearest, the other end
+    // is the same offset away
+    if (n >= 1 && ir->has_pair && (now_us - ir->pair_us) < PAIR_HOLD_US) {
+        int32_t off[2] = { ir->right[0] - ir->left[0], ir->right[1] - ir->left[1] };
+        int nearest = 0;
+        int64_t nearest_d = -1;
+        bool is_left = true;
+        for (int i = 0; i < n; i++) {
+            int64_t dl = dist2(p[i], ir->left);
+            int64_t dr = dist2(p[i], ir->right);
+            int64_t d = dl < dr ? dl : dr;
+            if (nearest_d < 0 || d < nearest_d) {
+                nearest = i;
+                nearest_d = d;
+                is_left = dl < dr;
+            }
+        }
+        if (is_left) {
+            memcpy(ir->left, p[nearest], sizeof(ir->left));
+            ir->right[0] = ir->left[0] + off[0];
+            ir->right[1] = ir->left[1] + off[1];
+        } else {
+            memcpy(ir->right, p[nearest], sizeof(ir->right));
+            ir->left[0] = ir->right[0] - off[0];
+            ir->left[1] = ir->right[1] - off[1];
+        }
+        mid[0] = (ir->left[0] + ir->right[0]) / 2;
+        mid[1] = (ir->left[1] + ir->right[1]) / 2;
+        return true;
+    }
+
+    if (ir->has_pair && (now_us - ir->pair_us) >= PAIR_HOLD_US) {
+        ir->has_pair = false;
+    }
+    return false;
+}
+
+// ============================================================================
+// FILTER
+// ============================================================================
+
+// One-Euro step on one axis; returns the lag-compensated position. The speed
+// comes from successive raw samples rather than from the filtered position
+// (as in the original), so it is the hand's speed and can be used to predict.
+static int32_t euro_step(wiimote_ir_axis_t* ax, int32_t value, uint32_t dt_us)
+{
+    int32_t v16 = value * 16;
+
+    int64_t raw_dx = ((int64_t)(value - ax->raw) * 1000000) / dt_us;
+    ax->raw = value;
+    int32_t a_d = euro_alpha(D_CUTOFF_MHZ, dt_us);
+    ax->dx += (int32_t)(((raw_dx - ax->dx) * a_d) >> 16);
+
+    uint32_t cutoff = MIN_CUTOFF_MHZ + (uint32_t)(((int64_t)abs32(ax->dx) * BETA_MHZ_PER_KUPS) / 1000);
+    if (cutoff > MAX_CUTOFF_MHZ) cutoff = MAX_CUTOFF_MHZ;
+    int32_t a = euro_alpha(cutoff, dt_us);
+    ax->x += (int32_t)(((int64_t)(v16 - ax->x) * a) >> 16);
+
+    // Time constant 1 / (2 pi fc), capped
+    uint32_t lead = (uint32_t)(1000000000ULL / (6283ULL * cutoff / 1000));
+    if (lead > LEAD_MAX_US) lead = LEAD_MAX_US;
+
+    int32_t speed = abs32(ax->dx) - LEAD_DEADBAND_UPS;
+    if (speed <= 0) return ax->x / 16;
+    if (ax->dx < 0) speed = -speed;
+    return ax->x / 16 + (int32_t)(((int64_t)speed * lead) / 1000000);
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+void wiimote_ir_init(wiimote_ir_t* ir)
+{
+    memset(ir, 0, sizeof(*ir));
+    for (int i = 0; i < 3; i++) {
+        ir->accel_zero[i] = ACCEL_ZERO_NOMINAL;
+        ir->accel_one_g[i] = ACCEL_ONE_G_NOMINAL;
+    }
+    ir->roll_cos = Q14;
+    ir->x = ir->y = 32768;
+}
+
+bool wiimote_ir_set_accel_cal(wiimote_ir_t* ir, const uint8_t cal[WIIMOTE_ACCEL_CAL_LEN])
+{
+    // Bytes 0-2 zero, 4-6 +1 g (upper 8 bits), 3 and 7 their low bits
+    // (X 5:4, Y 3:2, Z 1:0); byte 9 = sum of 0-8 + 0x55
+    uint8_t sum = 0x55;
+    for (int i = 0; i < 9; i++) sum += cal[i];
+    if (sum != cal[9]) return false;
+
+    uint16_t zero[3], one_g[3];
+    for (int i = 0; i < 3; i++) {
+        int shift = 4 - 2 * i;
+        zero[i] = (uint16_t)((cal[i] << 2) | ((cal[3] >> shift) & 0x03));
+        one_g[i] = (uint16_t)((cal[4 + i] << 2) | ((cal[7] >> shift) & 0x03));
+        if (one_g[i] <= zero[i]) return false;
+    }
+    memcpy(ir->accel_zero, zero, sizeof(zero));
+    memcpy(ir->accel_one_g, one_g, sizeof(one_g));
+    return true;
+}
+
+void wiimote_ir_update(wiimote_ir_t* ir, const wiimote_ir_dot_t dots[WIIMOTE_IR_DOTS],
+                       const uint16_t accel[3], uint32_t now_us)
+{
+    update_roll(ir, accel);
+
+    ir->dx = ir->dy = 0;
+    int32_t mid[2];
+    if (!find_midpoint(ir, dots, now_us, mid)) {
+        if (ir->visible) ir->lost_us = now_us;
+        ir->visible = false;
+        return;
+    }
+
+    int32_t target[2];
+    target[0] = 32768 + (mid[0] * 65536) / (SPAN_X * 8);
+    target[1] = 32768 + (mid[1] * 65536) / (SPAN_Y * 8);
+
+    uint32_t dt = now_us - ir->last_us;
+    if (!ir->primed || (!ir->visible && (now_us - ir->lost_us) >= REACQUIRE_US)) {
+        // Start over where the pointer is now
+        for (int a = 0; a < 2; a++) {
+            ir->axis[a].x = target[a] * 16;
+            ir->axis[a].dx = 0;
+            ir->axis[a].raw = target[a];
+            ir->prev[a] = target[a] < 0 ? 0 : (target[a] > POINTER_MAX ? POINTER_MAX : target[a]);
+            ir->carry[a] = 0;
+        }
+        ir->primed = true;
+        dt = 0;
+    }
+    ir->last_us = now_us;
+    if (dt > MAX_DT_US) dt = MAX_DT_US;
+
+    int32_t out[2];
+    for (int a = 0; a < 2; a++) {
+        out[a] = dt ? euro_step(&ir->axis[a], target[a], dt < MIN_DT_US ? MIN_DT_US : dt)
+                    : target[a];
+        if (out[a] < 0) out[a] = 0;
+        if (out[a] > POINTER_MAX) out[a] = POINTER_MAX;
+    }
+
+    // Mouse counts with the remainder carried, so a slow drift still moves
+    int16_t* d[2] = { &ir->dx, &ir->dy };
+    for (int a = 0; a < 2; a++) {
+        int32_t moved = out[a] - ir->prev[a] + ir->carry[a];
+        *d[a] = (int16_t)(moved / UNITS_PER_COUNT);
+        ir->carry[a] = moved - *d[a] * UNITS_PER_COUNT;
+        ir->prev[a] = out[a];
+    }
+
+    ir->x = (uint16_t)out[0];
+    ir->y = (uint16_t)out[1];
+    ir->visible = true;
+}
+
+bool wiimote_ir_report(wiimote_ir_t* ir, const uint8_t* report, uint16_t len, uint32_t now_us)
+{
+    // [0]=id, [1-2]=buttons (+ accel low bits), [3-5]=accel, [6..]=IR
+    wiimote_ir_dot_t dots[WIIMOTE_IR_DOTS];
+    if (report[0] == 0x33 && len >= 18) {
+        wiimote_ir_decode_extended(&report[6], dots);
+    } else if (report[0] == 0x37 && len >= 16) {
+        wiimote_ir_decode_basic(&report[6], dots);
+    } else {
+        return false;
+    }
+
+    // 10-bit accel: X low bits in byte 1 bits 6:5, Y and Z bit 1 in byte 2
+    // bits 5 and 6
+    uint16_t accel[3] = {
+        (uint16_t)((report[3] << 2) | ((report[1] >> 5) & 0x03)),
+        (uint16_t)((report[4] << 2) | ((report[2] >> 4) & 0x02)),
+        (uint16_t)((report[5] << 2) | ((report[2] >> 5) & 0x02)),
+    };
+    wiimote_ir_update(ir, dots, accel, now_us);
+    return true;
+}
@@ -0,0 +1,114 @@
+// wiimote_ir.h - Wiimote IR camera pointer tracking
+//
+// Turns the IR camera dots in report 0x33 (extended IR) or 0x37 (basic IR)
+// into a screen pointer:
+//   - decodes the dots,
+//   - levels them with the accelerometer's roll (fixed point),
+//   - picks the sensor bar pair (and carries on from one dot when the other
+//     leaves the frame),
+//   - smooths the midpoint with a One-Euro filter whose lag is predicted
+//     away over a short horizon, so it is steady at rest and still keeps up
+//     with a flick.
+//
+// No platform dependency (tools/wiimote-ir-replay builds it on the host).
+//
+// Pointer frame: 0-65535 across the screen, x right, y down, 32768 = centre.
+//
+// References:
+// - https://wiibrew.org/wiki/Wiimote#IR_Camera
+// - Casiez, Roussel, Vogel: "1€ Filter" (CHI 2012)
+
+#ifndef WIIMOTE_IR_H
+#define WIIMOTE_IR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// CAMERA
+// ============================================================================
+
+#define WIIMOTE_IR_DOTS         4
+#define WIIMOTE_IR_CAM_W        1024
+#define WIIMOTE_IR_CAM_H        768
+
+// IR camera data modes (register 0xB00033)
+#define WIIMOTE_IR_MODE_BASIC       0x01    // 10 bytes, report 0x36/0x37
+#define WIIMOTE_IR_MODE_EXTENDED    0x03    // 12 bytes, report 0x33
+
+// Accelerometer calibration in EEPROM (memory space, 10 bytes)
+#define WIIMOTE_ACCEL_CAL_ADDR      0x0016
+#define WIIMOTE_ACCEL_CAL_LEN       10
+
+typedef struct {
+    uint16_t x;                 // 0-1023, 1023 with y 1023 = no dot
+    uint16_t y;                 // 0-767
+    uint8_t size;               // 0-15, extended mode only
+    bool valid;
+} wiimote_ir_dot_t;
+
+// Decode the IR block of a report into four dots
+void wiimote_ir_decode_basic(const uint8_t ir[10], wiimote_ir_dot_t dots[WIIMOTE_IR_DOTS]);
+void wiimote_ir_decode_extended(const uint8_t ir[12], wiimote_ir_dot_t dots[WIIMOTE_IR_DOTS]);
+
+// ============================================================================
+// TRACKER
+// ============================================================================
+
+// One-Euro filter state for one axis
+typedef struct {
+    int32_t x;                  // Filtered position, pointer units x 16
+    int32_t dx;                 // Filtered speed, pointer units per second
+    int32_t raw;                // Previous unfiltered position, pointer units
+} wiimote_ir_axis_t;
+
+typedef struct {
+    // Accelerometer calibration, 10-bit
+    uint16_t accel_zero[3];
+    uint16_t accel_one_g[3];
+
+    // Roll from gravity, Q14 unit vector
+    int32_t roll_cos;
+    int32_t roll_sin;
+
+    // Sensor bar, roll-compensated pointer frame (1/8 camera pixel)
+    int32_t left[2];
+    int32_t right[2];
+    bool has_pair;              // left/right are from a recent frame with both dots
+    uint32_t pair_us;           // Last frame with both dots
+
+    // Filter
+    wiimote_ir_axis_t axis[2];
+    bool primed;
+    uint32_t last_us;           // Previous tracked report
+    uint32_t lost_us;           // When the dots were lost (valid while !visible)
+
+    // Output
+    bool visible;               // Pointer is on screen
+    uint16_t x;                 // Pointer, 0-65535 (held while !visible)
+    uint16_t y;
+    int16_t dx;                 // Mouse counts this report
+    int16_t dy;
+    int32_t carry[2];           // Sub-count remainder, pointer units
+    int32_t prev[2];            // Pointer at the previous report, for dx/dy
+} wiimote_ir_t;
+
+// Mouse counts across the full screen width/height
+#define WIIMOTE_IR_MOUSE_COUNTS     2048
+
+void wiimote_ir_init(wiimote_ir_t* ir);
+
+// Load the accelerometer calibration read from WIIMOTE_ACCEL_CAL_ADDR.
+// Returns false (nominal values kept) if the checksum doesn't match.
+bool wiimote_ir_set_accel_cal(wiimote_ir_t* ir, const uint8_t cal[WIIMOTE_ACCEL_CAL_LEN]);
+
+// Track one frame of dots. accel is the 10-bit X/Y/Z reading. Updates
+// visible, x, y, dx and dy; dx/dy are zero while the pointer is off screen.
+void wiimote_ir_update(wiimote_ir_t* ir, const wiimote_ir_dot_t dots[WIIMOTE_IR_DOTS],
+                       const uint16_t accel[3], uint32_t now_us);
+
+// Decode and track a whole input report. Returns false if it carries no IR
+// (report ID other than 0x33 / 0x37, or too short).
+bool wiimote_ir_report(wiimote_ir_t* ir, const uint8_t* report, uint16_t len, uint32_t now_us);
+
+#endif // WIIMOTE_IR_H
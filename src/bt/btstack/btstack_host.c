@@ -2885,14 +2885,16 @@ static struct {
 // Host->device NUS write queue (drained on the BTstack run loop — see
 // btstack_host_mouthpad_nus_send below). Declared here so mp_nus_reset() can
 // flush it on disconnect.
-#define MP_TX_SLOTS      8                  // host->device queue depth (low-rate)
+#define MP_TX_SLOTS      16                 // host->device queue depth (power of two)
 #define MP_TX_SLOT_SIZE  247                // <= NUS MTU payload
 typedef struct { uint16_t len; uint8_t data[MP_TX_SLOT_SIZE]; } mp_tx_slot_t;
 static mp_tx_slot_t      mp_tx[MP_TX_SLOTS];
 static volatile uint32_t mp_tx_head;        // write index (producer: main loop)
 static volatile uint32_t mp_tx_tail;        // read index (consumer: run loop)
 static volatile bool     mp_tx_scheduled;
+static bool              mp_tx_waiting;     // parked on a can-write request (run loop only)
 static btstack_context_callback_registration_t mp_tx_cb;
+static btstack_context_callback_registration_t mp_tx_credit_cb;
 
 static void (*mp_nus_rx_cb)(const uint8_t* data, uint16_t len) = NULL;
 
@@ -2961,9 +2963,11 @@ static void mp_nus_reset(void)
     mp_nus.rx_value_handle = 0;
     mp_nus.last_battery = 0;
     mp_nus.firmware[0] = '\0';
-    // Discard any queued host->device writes for the gone MouthPad.
+    // Discard any queued host->device writes for the gone MouthPad. A pending
+    // can-write request dies with the connection, so stop waiting on it.
     mp_tx_tail = mp_tx_head;
     mp_tx_scheduled = false;
+    mp_tx_waiting = false;
 }
 
 static void mp_nus_disconnected(hci_con_handle_t handle)
@@ -3127,23 +3131,58 @@ static void mp_hid_setup_task(void)
 // Single producer (main loop) + single consumer (run loop); both on one core,
 // so volatile indices + a publish-after-copy are race-free under preemption.
 // (The queue + indices are declared up by the mp_nus struct.)
+//
+// Writes go out back-to-back for as long as the controller has ACL buffers
+// (its credits). When it runs out, the write is left at the head of the queue
+// and the pump parks on gatt_client_request_to_write_without_response(), which
+// calls it again as soon as a buffer frees up. Nothing is dropped while the
+// link is up, so bulk transfers (firmware/config) run at link speed; the CDC
+// side holds off reading once the queue is nearly full.
 // ---------------------------------------------------------------------------
 
+static void mp_tx_pump(void* ctx);
+
+// Runs on the BTstack run loop when the controller can take another write.
+static void mp_tx_credit(void* ctx)
+{
+    mp_tx_waiting = false;
+    mp_tx_pump(ctx);
+}
+
 // Runs on the BTstack run loop (BTstack thread) — drain the queue.
 static void mp_tx_pump(void* ctx)
 {
     (void)ctx;
     mp_tx_scheduled = false;                 // clear first so a late enqueue re-schedules
+    if (mp_tx_waiting) return;               // mp_tx_credit will resume
+
     while (mp_tx_head != mp_tx_tail) {
         mp_tx_slot_t* s = &mp_tx[mp_tx_tail % MP_TX_SLOTS];
-        if (mp_nus.state == MP_NUS_READY && mp_nus.rx_value_handle != 0) {
-            gatt_client_write_value_of_characteristic_without_response(
-                mp_nus.handle, mp_nus.rx_value_handle, s->len, s->data);
+        if (mp_nus.state != MP_NUS_READY || mp_nus.rx_value_handle == 0) {
+            mp_tx_tail++;                    // link gone: discard
+            continue;
+        }
+        uint8_t st = gatt_client_write_value_of_characteristic_without_response(
+            mp_nus.handle, mp_nus.rx_value_handle, s->len, s->data);
+        if (st != ERROR_CODE_SUCCESS) {
+            // Out of credits: keep this write and wait for the next one.
+            mp_tx_credit_cb.callback = &mp_tx_credit;
+            mp_tx_credit_cb.context  = NULL;
+            if (gatt_client_request_to_write_without_response(&mp_tx_credit_cb, mp_nus.handle)
+                    == ERROR_CODE_SUCCESS) {
+                mp_tx_waiting = true;
+            }
+            return;
         }
         mp_tx_tail++;
     }
 }
 
+uint32_t btstack_host_mouthpad_nus_tx_space(void)
+{
+    return MP_TX_SLOTS - (mp_tx_head - mp_tx_tail);
+}
+
 bool btstack_host_mouthpad_nus_send(const uint8_t* data, uint16_t len)
 {
     if (mp_nus.state != MP_NUS_READY || mp_nus.rx_value_handle == 0) return false;
@@ -129,6 +129,11 @@ bool btstack_host_mouthpad_nus_send(const uint8_t* data, uint16_t len);
 // True once NUS service discovery has completed for a connected peer.
 bool btstack_host_mouthpad_nus_ready(void);
 
+// Free slots in the host->device write queue (one write each). Writes are
+// paced by the controller's ACL buffers, so a full queue means the link is
+// the bottleneck; callers should hold off rather than drop.
+uint32_t btstack_host_mouthpad_nus_tx_space(void);
+
 // Generic aliases — the NUS client serves any recognized peer, not just the
 // MouthPad. New callers (e.g. the FACE.* relay to a JoypadOS face controller)
 // should use these names.
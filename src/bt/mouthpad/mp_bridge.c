@@ -10,6 +10,7 @@
 #include "mp_bridge.h"
 #include "mp_relay.h"
 #include "bt/btstack/btstack_host.h"
+#include "platform/platform.h"
 #include "tusb.h"
 #include <string.h>
 #include <stdio.h>
@@ -39,23 +40,44 @@ static volatile uint32_t to_host_high;    // max ring occupancy seen (bytes)
 
 static inline uint32_t ring_count(void) { return to_host_head - to_host_tail; }
 
-static void ring_push(const uint8_t* data, uint32_t len)
+// Copy into the ring at absolute index `at` (at most two memcpy segments).
+static void ring_write(uint32_t at, const uint8_t* data, uint32_t len)
 {
-    // Drop the frame if it doesn't fit (better than corrupting the stream).
-    // This runs in the BTstack NUS-notification context — do NOT printf here
-    // (stdio is UART and blocks ~4ms, stalling BTstack + the CDC drain and
-    // cascading into more drops). Just count; surfaced via MP.STATS.
-    uint32_t used = ring_count();
-    if (len > TO_HOST_RING_SIZE - used) {
+    uint32_t off = at & TO_HOST_RING_MASK;
+    uint32_t first = TO_HOST_RING_SIZE - off;
+    if (first > len) first = len;
+    memcpy(&to_host_buf[off], data, first);
+    memcpy(to_host_buf, data + first, len - first);
+}
+
+// Reserve `len` bytes for a frame. Drops the frame if it doesn't fit (better
+// than corrupting the stream). This runs in the BTstack NUS-notification
+// context — do NOT printf here (stdio is UART and blocks ~4ms, stalling
+// BTstack + the CDC drain and cascading into more drops). Just count;
+// surfaced via MP.STATS.
+static bool ring_reserve(uint32_t len)
+{
+    if (len > TO_HOST_RING_SIZE - ring_count()) {
         to_host_drops++;
-        return;
-    }
-    for (uint32_t i = 0; i < len; i++) {
-        to_host_buf[(to_host_head + i) & TO_HOST_RING_MASK] = data[i];
+        return false;
     }
+    return true;
+}
+
+// Publish a frame written after the current head.
+static void ring_commit(uint32_t len)
+{
+    uint32_t used = ring_count() + len;
     to_host_head += len;   // publish after the copy
     mp_frames++;
-    if (used + len > to_host_high) to_host_high = used + len;
+    if (used > to_host_high) to_host_high = used;
+}
+
+static void ring_push(const uint8_t* data, uint32_t len)
+{
+    if (!ring_reserve(len)) return;
+    ring_write(to_host_head, data, len);
+    ring_commit(len);
 }
 
 static mp_relay_rx_t relay_rx;
@@ -73,13 +95,34 @@ void mp_bridge_get_stats(uint32_t* frames, uint32_t* drops,
 
 // ---------------------------------------------------------------------------
 // device -> host: NUS notification (BTstack ctx) -> frame -> ring
+//
+// The frame is written straight into the ring: header and protobuf prefix,
+// then the notification payload (CRC'd on the way), then the CRC.
 // ---------------------------------------------------------------------------
 static void on_nus_rx(const uint8_t* data, uint16_t len)
 {
-    uint8_t frame[MP_RELAY_MAX_FRAME];
-    size_t n = mp_relay_encode_to_app(data, len, frame, sizeof(frame));
-    if (n) ring_push(frame, (uint32_t)n);
-    else   mp_encode_fails++;
+    uint8_t hdr[MP_RELAY_TO_APP_HEADER_MAX];
+    uint16_t crc;
+    size_t hlen = mp_relay_to_app_header(len, hdr, &crc);
+    if (!hlen) {
+        mp_encode_fails++;
+        return;
+    }
+
+    uint32_t frame_len = (uint32_t)(hlen + len + 2);
+    if (!ring_reserve(frame_len)) return;
+
+    crc = mp_relay_crc16_update(crc, data, len);
+    uint8_t tail[2] = { (uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF) };
+
+    uint32_t at = to_host_head;
+    ring_write(at, hdr, (uint32_t)hlen);
+    ring_write(at + (uint32_t)hlen, data, len);
+    ring_write(at + (uint32_t)hlen + len, tail, 2);
+    ring_commit(frame_len);
+
+    // cdc_task() drains the ring on the main loop
+    platform_loop_wake();
 }
 
 // Format a BLE address (big-endian bd_addr) as "AA:BB:CC:DD:EE:FF".
@@ -170,14 +213,17 @@ static void on_relay_request(mp_relay_req_t type, const uint8_t* data, uint16_t
 }
 
 // ---------------------------------------------------------------------------
-// CDC RX demux filter. Returns true if the byte was consumed as part of a
-// MouthPad relay frame; false to let the JoypadOS command parser handle it.
+// CDC RX demux filter. Returns how many leading bytes of the chunk belong to
+// MouthPad relay frames; the byte after them (if any) goes to the JoypadOS
+// command parser.
 //
 // Both framings begin with 0xAA (JoypadOS = 0xAA + LE len; MouthPad = 0xAA 0x55
 // + BE len), so we use a 1-byte lookahead: hold 0xAA, and on the next byte
 // commit to a relay frame iff it's 0x55, otherwise replay the buffered 0xAA to
 // the command parser. Inside a relay frame we count payload+CRC bytes from its
-// BE length so we know exactly when to hand the stream back to the parser.
+// BE length so we know exactly when to hand the stream back to the parser, and
+// hand the reconstructor whole spans rather than single bytes. A frame that
+// sits entirely inside the chunk goes over in one feed (parsed in place).
 // ---------------------------------------------------------------------------
 enum { DX_IDLE, DX_GOT_AA, DX_IN_FRAME };
 static uint8_t  dx_state = DX_IDLE;
@@ -185,7 +231,7 @@ static uint8_t  dx_after;          // bytes seen after the 0xAA 0x55 magic
 static uint8_t  dx_lenbuf[2];      // BE length bytes
 static uint16_t dx_remaining;      // payload+CRC bytes left in the frame
 
-static bool relay_cdc_filter(uint8_t b)
+static size_t relay_cdc_filter(const uint8_t* data, size_t len)
 {
     // Demux whenever a host is on the CDC port, NOT only when a MouthPad is
     // connected. The desktop utility polls dongle-level queries (device_info /
@@ -197,46 +243,85 @@ static bool relay_cdc_filter(uint8_t b)
     // connected there's no CDC RX, so this is inert.
     if (!tud_cdc_connected()) {
         dx_state = DX_IDLE;
-        return false;
+        return 0;
     }
 
-    switch (dx_state) {
-    case DX_IDLE:
-        if (b == 0xAA) { dx_state = DX_GOT_AA; return true; }   // hold, disambiguate
-        return false;
+    size_t used = 0;
+    while (used < len) {
+        const uint8_t* p = data + used;
+        size_t left = len - used;
 
-    case DX_GOT_AA:
-        if (b == 0x55) {
+        switch (dx_state) {
+        case DX_IDLE:
+            if (p[0] != 0xAA) return used;
+            // Whole frame in this chunk: one feed, no per-byte state
+            if (left >= 4 && p[1] == 0x55) {
+                uint16_t plen = ((uint16_t)p[2] << 8) | p[3];
+                size_t frame_len = 4 + (size_t)plen + 2;
+                if (plen <= MP_RELAY_MAX_PROTO && frame_len <= left) {
+                    mp_relay_rx_feed(&relay_rx, p, frame_len);
+                    used += frame_len;
+                    break;
+                }
+            }
+            dx_state = DX_GOT_AA;               // hold, disambiguate
+            used++;
+            break;
+
+        case DX_GOT_AA:
+            if (p[0] != 0x55) {
+                // Not a relay frame: replay the buffered 0xAA, then let this
+                // byte fall through to the command parser too.
+                dx_state = DX_IDLE;
+                cdc_feed_command_byte(0xAA);
+                return used;
+            }
             dx_state = DX_IN_FRAME;
             dx_after = 0;
-            uint8_t magic[2] = { 0xAA, 0x55 };
-            mp_relay_rx_feed(&relay_rx, magic, 2);
-            return true;
-        }
-        // Not a relay frame: replay the buffered 0xAA, then let this byte fall
-        // through to the command parser too.
-        dx_state = DX_IDLE;
-        cdc_feed_command_byte(0xAA);
-        return false;
+            {
+                static const uint8_t magic[2] = { 0xAA, 0x55 };
+                mp_relay_rx_feed(&relay_rx, magic, 2);
+            }
+            used++;
+            break;
 
-    case DX_IN_FRAME:
-        mp_relay_rx_feed(&relay_rx, &b, 1);
-        if (dx_after < 2) {
-            dx_lenbuf[dx_after] = b;
-            if (++dx_after == 2) {
-                uint16_t plen = ((uint16_t)dx_lenbuf[0] << 8) | dx_lenbuf[1];
-                if (plen > MP_RELAY_MAX_NUS_PAYLOAD + 16) {
-                    dx_state = DX_IDLE;        // implausible — abort, resync
-                } else {
-                    dx_remaining = plen + 2;   // payload + 2-byte CRC
+        case DX_IN_FRAME:
+            if (dx_after < 2) {
+                mp_relay_rx_feed(&relay_rx, p, 1);
+                used++;
+                dx_lenbuf[dx_after] = p[0];
+                if (++dx_after == 2) {
+                    uint16_t plen = ((uint16_t)dx_lenbuf[0] << 8) | dx_lenbuf[1];
+                    if (plen > MP_RELAY_MAX_PROTO) {
+                        dx_state = DX_IDLE;        // implausible — abort, resync
+                    } else {
+                        dx_remaining = plen + 2;   // payload + 2-byte CRC
+                    }
                 }
+            } else {
+                // Jump over as much of the frame body as this chunk holds
+                size_t n = dx_remaining < left ? dx_remaining : left;
+                mp_relay_rx_feed(&relay_rx, p, n);
+                used += n;
+                dx_remaining -= (uint16_t)n;
+                if (dx_remaining == 0) dx_state = DX_IDLE;   // frame complete
             }
-        } else if (dx_remaining == 0 || --dx_remaining == 0) {
-            dx_state = DX_IDLE;                 // frame complete
+            break;
         }
-        return true;
     }
-    return false;
+    return used;
+}
+
+// CDC RX hold: stop reading while the NUS write queue is nearly full, so
+// firmware/config transfers are paced by the BLE link instead of dropped. A
+// 64-byte CDC chunk can complete at most MP_NUS_TX_RESERVE passthrough frames
+// (11 bytes minimum each, plus one carried over from the previous chunk).
+#define MP_NUS_TX_RESERVE 6
+
+static bool relay_cdc_hold(void)
+{
+    return btstack_host_mouthpad_nus_ready() &&
+           btstack_host_mouthpad_nus_tx_space() < MP_NUS_TX_RESERVE;
 }
 
 // ---------------------------------------------------------------------------
@@ -249,14 +334,12 @@ static void relay_cdc_pump(void)
     while (ring_count() > 0) {
         uint32_t avail = tud_cdc_write_available();
         if (avail == 0) break;
+        // Straight from the ring: up to the wrap point per write
+        uint32_t off = to_host_tail & TO_HOST_RING_MASK;
         uint32_t chunk = ring_count();
+        if (chunk > TO_HOST_RING_SIZE - off) chunk = TO_HOST_RING_SIZE - off;
         if (chunk > avail) chunk = avail;
-        uint8_t tmp[64];
-        if (chunk > sizeof(tmp)) chunk = sizeof(tmp);
-        for (uint32_t i = 0; i < chunk; i++) {
-            tmp[i] = to_host_buf[(to_host_tail + i) & TO_HOST_RING_MASK];
-        }
-        uint32_t wrote = tud_cdc_write(tmp, chunk);
+        uint32_t wrote = tud_cdc_write(&to_host_buf[off], chunk);
         to_host_tail += wrote;
         if (wrote < chunk) break;
     }
@@ -269,7 +352,7 @@ void mp_bridge_init(void)
     dx_state = DX_IDLE;
     mp_relay_rx_init(&relay_rx, on_relay_request, NULL);
     btstack_host_set_mouthpad_nus_rx_cb(on_nus_rx);
-    cdc_register_relay(relay_cdc_filter, relay_cdc_pump);
+    cdc_register_relay(relay_cdc_filter, relay_cdc_pump, relay_cdc_hold);
     printf("[MP_BRIDGE] Relay attached to CDC (ambient; demux gated on MouthPad link)\n");
 }
 
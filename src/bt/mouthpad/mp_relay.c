@@ -11,21 +11,57 @@
 
 // ---------------------------------------------------------------------------
 // CRC-16/CCITT-FALSE (init 0xFFFF, poly 0x1021, no reflection) — matches the
-// utility's PacketFramer CRC16.calculate() byte-for-byte.
+// utility's PacketFramer CRC16.calculate() byte-for-byte. Table-driven: one
+// lookup per byte instead of eight shift/xor steps.
 // ---------------------------------------------------------------------------
-uint16_t mp_relay_crc16(const uint8_t* data, size_t len)
+static const uint16_t crc16_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+uint16_t mp_relay_crc16_update(uint16_t crc, const uint8_t* data, size_t len)
 {
-    uint16_t crc = 0xFFFF;
     for (size_t i = 0; i < len; i++) {
-        crc ^= (uint16_t)data[i] << 8;
-        for (int b = 0; b < 8; b++) {
-            if (crc & 0x8000) crc = (uint16_t)((crc << 1) ^ 0x1021);
-            else              crc = (uint16_t)(crc << 1);
-        }
+        crc = (uint16_t)((crc << 8) ^ crc16_table[(crc >> 8) ^ data[i]]);
     }
     return crc;
 }
 
+uint16_t mp_relay_crc16(const uint8_t* data, size_t len)
+{
+    return mp_relay_crc16_update(0xFFFF, data, len);
+}
+
 // ---------------------------------------------------------------------------
 // Minimal protobuf helpers
 // ---------------------------------------------------------------------------
@@ -61,11 +97,39 @@ static bool pb_get_varint(const uint8_t* buf, size_t len, size_t* pos, uint32_t*
     return false;
 }
 
+// ---------------------------------------------------------------------------
+// Framing. Encoders size the message first, then write the protobuf straight
+// into the frame at out+4 — no intermediate message buffers.
+// ---------------------------------------------------------------------------
+static void put_be16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)(v & 0xFF);
+}
+
+// Write the frame header. Returns where the protobuf goes, or NULL if the
+// frame won't fit in out_cap.
+static uint8_t* frame_begin(uint8_t* out, size_t out_cap, size_t proto_len)
+{
+    if (4 + proto_len + 2 > out_cap) return NULL;
+    out[0] = 0xAA;
+    out[1] = 0x55;
+    put_be16(out + 2, (uint16_t)proto_len);
+    return out + 4;
+}
+
+// Append the CRC over the protobuf written since frame_begin(). Returns the
+// total framed length.
+static size_t frame_end(uint8_t* out, size_t proto_len)
+{
+    put_be16(out + 4 + proto_len, mp_relay_crc16(out + 4, proto_len));
+    return 4 + proto_len + 2;
+}
+
 // ---------------------------------------------------------------------------
 // Encode device->host: RelayToAppMessage{ pass_through_to_app{ data=payload } }
 // ---------------------------------------------------------------------------
-size_t mp_relay_encode_to_app(const uint8_t* payload, uint16_t len,
-                              uint8_t* out, size_t out_cap)
+size_t mp_relay_to_app_header(uint16_t len, uint8_t* hdr, uint16_t* crc)
 {
     if (len > MP_RELAY_MAX_NUS_PAYLOAD) return 0;
 
@@ -73,37 +137,37 @@ size_t mp_relay_encode_to_app(const uint8_t* payload, uint16_t len,
     size_t inner_len = 1 + pb_varint_size(len) + len;
     // Outer RelayToAppMessage { pass_through_to_app(field3,len-delim) = inner }
     size_t proto_len = 1 + pb_varint_size((uint32_t)inner_len) + inner_len;
-    // Frame: 2 magic + 2 length + proto + 2 crc
-    size_t frame_len = 4 + proto_len + 2;
-    if (frame_len > out_cap) return 0;
 
-    // Build the protobuf payload at out+4 (after the header) so we can CRC it.
-    uint8_t* proto = out + 4;
-    size_t p = 0;
-    proto[p++] = PB_KEY_FIELD3_LEN;
-    p = pb_put_varint(proto, p, (uint32_t)inner_len);
-    proto[p++] = PB_KEY_FIELD1_LEN;
-    p = pb_put_varint(proto, p, len);
-    memcpy(proto + p, payload, len);
-    p += len;
-    // p == proto_len
+    hdr[0] = 0xAA;
+    hdr[1] = 0x55;
+    put_be16(hdr + 2, (uint16_t)proto_len);
+    size_t p = 4;
+    hdr[p++] = PB_KEY_FIELD3_LEN;
+    p = pb_put_varint(hdr, p, (uint32_t)inner_len);
+    hdr[p++] = PB_KEY_FIELD1_LEN;
+    p = pb_put_varint(hdr, p, len);
 
-    // Header
-    out[0] = 0xAA;
-    out[1] = 0x55;
-    out[2] = (uint8_t)(proto_len >> 8);
-    out[3] = (uint8_t)(proto_len & 0xFF);
+    // CRC covers the protobuf only (not magic/length)
+    *crc = mp_relay_crc16(hdr + 4, p - 4);
+    return p;
+}
 
-    // CRC over the protobuf payload, big-endian
-    uint16_t crc = mp_relay_crc16(proto, proto_len);
-    out[4 + proto_len + 0] = (uint8_t)(crc >> 8);
-    out[4 + proto_len + 1] = (uint8_t)(crc & 0xFF);
+size_t mp_relay_encode_to_app(const uint8_t* payload, uint16_t len,
+                              uint8_t* out, size_t out_cap)
+{
+    uint8_t hdr[MP_RELAY_TO_APP_HEADER_MAX];
+    uint16_t crc;
+    size_t hlen = mp_relay_to_app_header(len, hdr, &crc);
+    if (hlen == 0 || hlen + len + 2 > out_cap) return 0;
 
-    return frame_len;
+    memcpy(out, hdr, hlen);
+    memcpy(out + hlen, payload, len);
+    put_be16(out + hlen + len, mp_relay_crc16_update(crc, payload, len));
+    return hlen + len + 2;
 }
 
 // ---------------------------------------------------------------------------
-// Append helpers for building outgoing protobuf messages.
+// Append helpers for building outgoing protobuf messages, and their sizes.
 // ---------------------------------------------------------------------------
 static size_t pb_put_bytes_field(uint8_t* buf, size_t pos, uint32_t field,
                                  const uint8_t* data, size_t len)
@@ -120,20 +184,20 @@ static size_t pb_put_varint_field(uint8_t* buf, size_t pos, uint32_t field, uint
     return pb_put_varint(buf, pos, v);
 }
 
-// Wrap a complete protobuf payload as a framed packet (magic + BE len + crc).
-static size_t frame_wrap(const uint8_t* proto, size_t proto_len, uint8_t* out, size_t out_cap)
+// Single-byte keys only (field numbers < 16)
+static size_t pb_bytes_field_size(size_t len)
 {
-    size_t frame_len = 4 + proto_len + 2;
-    if (frame_len > out_cap) return 0;
-    out[0] = 0xAA;
-    out[1] = 0x55;
-    out[2] = (uint8_t)(proto_len >> 8);
-    out[3] = (uint8_t)(proto_len & 0xFF);
-    memcpy(out + 4, proto, proto_len);
-    uint16_t crc = mp_relay_crc16(proto, proto_len);
-    out[4 + proto_len + 0] = (uint8_t)(crc >> 8);
-    out[4 + proto_len + 1] = (uint8_t)(crc & 0xFF);
-    return frame_len;
+    return 1 + pb_varint_size((uint32_t)len) + len;
+}
+
+static size_t pb_varint_field_size(uint32_t v)
+{
+    return 1 + pb_varint_size(v);
+}
+
+static size_t str_len(const char* s)
+{
+    return (s && s[0]) ? strlen(s) : 0;
 }
 
 // ---------------------------------------------------------------------------
@@ -142,26 +206,34 @@ static size_t frame_wrap(const uint8_t* proto, size_t proto_len, uint8_t* out, s
 size_t mp_relay_encode_device_info(const mp_relay_device_info_t* info,
                                    uint8_t* out, size_t out_cap)
 {
-    uint8_t inner[256];
-    size_t ip = 0;
-    if (info->name && info->name[0])
-        ip = pb_put_bytes_field(inner, ip, 1, (const uint8_t*)info->name, strlen(info->name));
-    if (info->firmware && info->firmware[0])
-        ip = pb_put_bytes_field(inner, ip, 2, (const uint8_t*)info->firmware, strlen(info->firmware));
-    if (info->address && info->address[0])
-        ip = pb_put_bytes_field(inner, ip, 3, (const uint8_t*)info->address, strlen(info->address));
-    if (info->vid)    ip = pb_put_varint_field(inner, ip, 4, info->vid);
-    if (info->pid)    ip = pb_put_varint_field(inner, ip, 5, info->pid);
-    if (info->family) ip = pb_put_varint_field(inner, ip, 6, info->family);
-    if (info->board)  ip = pb_put_varint_field(inner, ip, 7, info->board);
-
-    uint8_t proto[280];
-    size_t pp = 0;
-    proto[pp++] = (4 << 3) | 2;             // RelayToAppMessage.device_info_response
-    pp = pb_put_varint(proto, pp, (uint32_t)ip);
-    memcpy(proto + pp, inner, ip);
-    pp += ip;
-    return frame_wrap(proto, pp, out, out_cap);
+    size_t name_len = str_len(info->name);
+    size_t fw_len   = str_len(info->firmware);
+    size_t addr_len = str_len(info->address);
+
+    size_t inner_len = 0;
+    if (name_len)     inner_len += pb_bytes_field_size(name_len);
+    if (fw_len)       inner_len += pb_bytes_field_size(fw_len);
+    if (addr_len)     inner_len += pb_bytes_field_size(addr_len);
+    if (info->vid)    inner_len += pb_varint_field_size(info->vid);
+    if (info->pid)    inner_len += pb_varint_field_size(info->pid);
+    if (info->family) inner_len += pb_varint_field_size(info->family);
+    if (info->board)  inner_len += pb_varint_field_size(info->board);
+    size_t proto_len = 1 + pb_varint_size((uint32_t)inner_len) + inner_len;
+
+    uint8_t* proto = frame_begin(out, out_cap, proto_len);
+    if (!proto) return 0;
+
+    size_t p = 0;
+    proto[p++] = (4 << 3) | 2;              // RelayToAppMessage.device_info_response
+    p = pb_put_varint(proto, p, (uint32_t)inner_len);
+    if (name_len)     p = pb_put_bytes_field(proto, p, 1, (const uint8_t*)info->name, name_len);
+    if (fw_len)       p = pb_put_bytes_field(proto, p, 2, (const uint8_t*)info->firmware, fw_len);
+    if (addr_len)     p = pb_put_bytes_field(proto, p, 3, (const uint8_t*)info->address, addr_len);
+    if (info->vid)    p = pb_put_varint_field(proto, p, 4, info->vid);
+    if (info->pid)    p = pb_put_varint_field(proto, p, 5, info->pid);
+    if (info->family) p = pb_put_varint_field(proto, p, 6, info->family);
+    if (info->board)  p = pb_put_varint_field(proto, p, 7, info->board);
+    return frame_end(out, proto_len);
 }
 
 // ---------------------------------------------------------------------------
@@ -170,19 +242,21 @@ size_t mp_relay_encode_device_info(const mp_relay_device_info_t* info,
 size_t mp_relay_encode_conn_status(mp_relay_conn_status_t status, int32_t rssi,
                                    uint32_t battery, uint8_t* out, size_t out_cap)
 {
-    uint8_t inner[24];
-    size_t ip = 0;
-    ip = pb_put_varint_field(inner, ip, 1, (uint32_t)status);          // connection_status
-    if (rssi)    ip = pb_put_varint_field(inner, ip, 2, (uint32_t)rssi);   // int32 (small negatives ok)
-    if (battery) ip = pb_put_varint_field(inner, ip, 3, battery);         // battery_level
-
-    uint8_t proto[32];
-    size_t pp = 0;
-    proto[pp++] = (1 << 3) | 2;             // RelayToAppMessage.ble_connection_status_response
-    pp = pb_put_varint(proto, pp, (uint32_t)ip);
-    memcpy(proto + pp, inner, ip);
-    pp += ip;
-    return frame_wrap(proto, pp, out, out_cap);
+    size_t inner_len = pb_varint_field_size((uint32_t)status);
+    if (rssi)    inner_len += pb_varint_field_size((uint32_t)rssi);
+    if (battery) inner_len += pb_varint_field_size(battery);
+    size_t proto_len = 1 + pb_varint_size((uint32_t)inner_len) + inner_len;
+
+    uint8_t* proto = frame_begin(out, out_cap, proto_len);
+    if (!proto) return 0;
+
+    size_t p = 0;
+    proto[p++] = (1 << 3) | 2;              // RelayToAppMessage.ble_connection_status_response
+    p = pb_put_varint(proto, p, (uint32_t)inner_len);
+    p = pb_put_varint_field(proto, p, 1, (uint32_t)status);           // connection_status
+    if (rssi)    p = pb_put_varint_field(proto, p, 2, (uint32_t)rssi);    // int32 (small negatives ok)
+    if (battery) p = pb_put_varint_field(proto, p, 3, battery);          // battery_level
+    return frame_end(out, proto_len);
 }
 
 // ---------------------------------------------------------------------------
@@ -190,17 +264,17 @@ size_t mp_relay_encode_conn_status(mp_relay_conn_status_t status, int32_t rssi,
 // ---------------------------------------------------------------------------
 size_t mp_relay_encode_clear_bonds_response(bool success, uint8_t* out, size_t out_cap)
 {
-    uint8_t inner[4];
-    size_t ip = 0;
-    if (success) ip = pb_put_varint_field(inner, ip, 1, 1);   // success = true (false omitted)
-
-    uint8_t proto[12];
-    size_t pp = 0;
-    proto[pp++] = (5 << 3) | 2;             // RelayToAppMessage.clear_bonds_response
-    pp = pb_put_varint(proto, pp, (uint32_t)ip);
-    memcpy(proto + pp, inner, ip);
-    pp += ip;
-    return frame_wrap(proto, pp, out, out_cap);
+    size_t inner_len = success ? pb_varint_field_size(1) : 0;   // false omitted
+    size_t proto_len = 1 + pb_varint_size((uint32_t)inner_len) + inner_len;
+
+    uint8_t* proto = frame_begin(out, out_cap, proto_len);
+    if (!proto) return 0;
+
+    size_t p = 0;
+    proto[p++] = (5 << 3) | 2;              // RelayToAppMessage.clear_bonds_response
+    p = pb_put_varint(proto, p, (uint32_t)inner_len);
+    if (success) p = pb_put_varint_field(proto, p, 1, 1);
+    return frame_end(out, proto_len);
 }
 
 // ---------------------------------------------------------------------------
@@ -275,66 +349,84 @@ void mp_relay_rx_init(mp_relay_rx_t* rx, mp_relay_request_cb cb, void* ctx)
     rx->ctx = ctx;
 }
 
-// Drop the first `n` bytes from the accumulator (resync).
-static void acc_drop(mp_relay_rx_t* rx, uint16_t n)
+// Check and dispatch one complete frame (magic already matched). Returns
+// false on a CRC mismatch.
+static bool rx_frame(mp_relay_rx_t* rx, const uint8_t* frame, uint16_t plen)
 {
-    if (n >= rx->acc_len) { rx->acc_len = 0; return; }
-    memmove(rx->acc, rx->acc + n, rx->acc_len - n);
-    rx->acc_len -= n;
+    const uint8_t* proto = frame + 4;
+    uint16_t rx_crc = ((uint16_t)proto[plen] << 8) | proto[plen + 1];
+    if (mp_relay_crc16(proto, plen) != rx_crc) return false;
+
+    if (rx->cb) {
+        const uint8_t* d = NULL; uint16_t dl = 0;
+        mp_relay_req_t type = classify_request(proto, plen, &d, &dl);
+        if (type != MP_RELAY_REQ_NONE) rx->cb(type, d, dl, rx->ctx);
+    }
+    return true;
+}
+
+// Drop the first `n` buffered bytes, then everything up to the next 0xAA.
+static void acc_resync(mp_relay_rx_t* rx, uint16_t n)
+{
+    const uint8_t* aa = NULL;
+    if (n < rx->acc_len) aa = memchr(rx->acc + n, 0xAA, rx->acc_len - n);
+    if (!aa) { rx->acc_len = 0; return; }
+    uint16_t skip = (uint16_t)(aa - rx->acc);
+    memmove(rx->acc, aa, rx->acc_len - skip);
+    rx->acc_len -= skip;
 }
 
 void mp_relay_rx_feed(mp_relay_rx_t* rx, const uint8_t* data, size_t len)
 {
-    for (size_t i = 0; i < len; i++) {
-        if (rx->acc_len < MP_RELAY_MAX_FRAME) {
-            rx->acc[rx->acc_len++] = data[i];
-        } else {
-            // Overflow without a valid frame — drop a byte and keep scanning.
-            acc_drop(rx, 1);
-            rx->acc[rx->acc_len++] = data[i];
-        }
+    for (;;) {
+        if (rx->acc_len == 0) {
+            // Nothing buffered: hunt for the magic and take whole frames
+            // straight from the input, jumping by their length.
+            if (len == 0) return;
+            const uint8_t* aa = memchr(data, 0xAA, len);
+            if (!aa) return;
+            len -= (size_t)(aa - data);
+            data = aa;
 
-        // Try to parse as many complete frames as are buffered.
-        for (;;) {
-            // Need at least the 4-byte header.
-            if (rx->acc_len < 4) break;
-
-            // Resync to magic 0xAA 0x55.
-            if (rx->acc[0] != 0xAA || rx->acc[1] != 0x55) {
-                // Find next 0xAA and drop everything before it.
-                uint16_t j = 1;
-                while (j < rx->acc_len && rx->acc[j] != 0xAA) j++;
-                acc_drop(rx, j);
-                if (rx->acc_len < 4) break;
-                if (rx->acc[0] != 0xAA || rx->acc[1] != 0x55) {
-                    // Lone 0xAA without 0x55 follower — drop it and retry.
-                    if (rx->acc_len >= 2 && rx->acc[1] != 0x55) { acc_drop(rx, 1); }
+            if (len >= 2 && data[1] != 0x55) { data++; len--; continue; }
+            if (len >= 4) {
+                uint16_t plen = ((uint16_t)data[2] << 8) | data[3];
+                if (plen > MP_RELAY_MAX_PROTO) {
+                    // Implausible length — bad header, resync past this magic.
+                    data += 2; len -= 2;
+                    continue;
+                }
+                size_t frame_len = 4 + (size_t)plen + 2;
+                if (len >= frame_len) {
+                    // CRC fail — drop the magic and resync.
+                    size_t used = rx_frame(rx, data, plen) ? frame_len : 2;
+                    data += used; len -= used;
                     continue;
                 }
             }
+            // Partial frame: fall through and buffer it.
+        }
 
+        // Top up the split frame: first the 4-byte header, then the rest.
+        uint16_t want = 4;
+        if (rx->acc_len >= 4) {
             uint16_t plen = ((uint16_t)rx->acc[2] << 8) | rx->acc[3];
-            if (plen > MP_RELAY_MAX_NUS_PAYLOAD + 16) {
-                // Implausible length — bad header, resync past this magic.
-                acc_drop(rx, 2);
-                continue;
-            }
-            uint16_t frame_len = 4 + plen + 2;
-            if (rx->acc_len < frame_len) break;   // wait for more bytes
-
-            const uint8_t* proto = rx->acc + 4;
-            uint16_t rx_crc = ((uint16_t)rx->acc[4 + plen] << 8) | rx->acc[4 + plen + 1];
-            if (mp_relay_crc16(proto, plen) == rx_crc) {
-                if (rx->cb) {
-                    const uint8_t* d = NULL; uint16_t dl = 0;
-                    mp_relay_req_t type = classify_request(proto, plen, &d, &dl);
-                    if (type != MP_RELAY_REQ_NONE) rx->cb(type, d, dl, rx->ctx);
-                }
-                acc_drop(rx, frame_len);
-            } else {
-                // CRC fail — drop the magic and resync.
-                acc_drop(rx, 2);
-            }
+            if (rx->acc[1] != 0x55) { acc_resync(rx, 1); continue; }      // lone 0xAA
+            if (plen > MP_RELAY_MAX_PROTO) { acc_resync(rx, 2); continue; }
+            want = 4 + plen + 2;
         }
+        if (rx->acc_len < want) {
+            size_t take = want - rx->acc_len;
+            if (take > len) take = len;
+            memcpy(rx->acc + rx->acc_len, data, take);
+            rx->acc_len += (uint16_t)take;
+            data += take; len -= take;
+            if (rx->acc_len < want) return;     // wait for more bytes
+        }
+        if (want == 4) continue;                // header complete, check it
+
+        // After a resync the buffer can run past this frame; what follows it
+        // is the start of the next one, so keep it and carry on parsing.
+        acc_resync(rx, rx_frame(rx, rx->acc, (uint16_t)(want - 6)) ? want : 2);
     }
 }
@@ -29,15 +29,32 @@
 #define MP_RELAY_MAX_NUS_PAYLOAD   247
 #define MP_RELAY_MAX_FRAME         320
 
+// A frame length above this is treated as a bad header (resync).
+#define MP_RELAY_MAX_PROTO         (MP_RELAY_MAX_NUS_PAYLOAD + 16)
+
+// Frame header + protobuf prefix in front of a pass_through_to_app payload:
+// 4 (magic, length) + 1 key + 2 varint + 1 key + 2 varint.
+#define MP_RELAY_TO_APP_HEADER_MAX 10
+
 // CRC-16/CCITT-FALSE over `data` (init 0xFFFF, poly 0x1021, no reflection).
 uint16_t mp_relay_crc16(const uint8_t* data, size_t len);
 
+// Continue a CRC-16/CCITT-FALSE over more bytes (start from 0xFFFF).
+uint16_t mp_relay_crc16_update(uint16_t crc, const uint8_t* data, size_t len);
+
 // Encode device->host: wrap `payload` (raw NUS bytes from the MouthPad) as a
 // framed RelayToAppMessage{pass_through_to_app{data}}. Writes into `out`.
 // Returns total framed length, or 0 if payload too large / out_cap too small.
 size_t mp_relay_encode_to_app(const uint8_t* payload, uint16_t len,
                               uint8_t* out, size_t out_cap);
 
+// Split form of mp_relay_encode_to_app for writing straight into a TX ring:
+// writes the frame header and protobuf prefix for a `len`-byte payload into
+// `hdr` (MP_RELAY_TO_APP_HEADER_MAX bytes) and returns its length, with *crc
+// seeded over the prefix. The frame is then hdr + payload + the big-endian
+// mp_relay_crc16_update(*crc, payload, len). Returns 0 if len is too large.
+size_t mp_relay_to_app_header(uint16_t len, uint8_t* hdr, uint16_t* crc);
+
 // ---------------------------------------------------------------------------
 // Dongle-level response encoders. The desktop utility's connection handshake is
 // addressed to the relay/dongle itself (destination=relay), not the MouthPad:
@@ -87,6 +104,9 @@ size_t mp_relay_encode_clear_bonds_response(bool success, uint8_t* out, size_t o
 // frame the callback fires with the classified request. For PASSTHROUGH the
 // data/len carry the inner NUS payload (to write to the MouthPad's NUS RX); the
 // dongle-level reads carry no payload (the handler synthesizes a response).
+//
+// Frames that arrive whole within one feed are parsed in place; only a frame
+// split across feeds is copied into `acc`, one header and one body memcpy.
 // ---------------------------------------------------------------------------
 typedef enum {
     MP_RELAY_REQ_NONE = 0,
@@ -101,7 +121,7 @@ typedef void (*mp_relay_request_cb)(mp_relay_req_t type, const uint8_t* data,
                                     uint16_t len, void* ctx);
 
 typedef struct {
-    uint8_t  acc[MP_RELAY_MAX_FRAME];   // frame-assembly buffer
+    uint8_t  acc[MP_RELAY_MAX_FRAME];   // split-frame assembly (starts with 0xAA)
     uint16_t acc_len;                   // bytes currently buffered
     mp_relay_request_cb cb;
     void*    ctx;
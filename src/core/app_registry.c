@@ -72,6 +72,7 @@ const char* app_registry_output_target_name(output_target_t target)
         case OUTPUT_TARGET_BLE_PERIPHERAL: return "ble_peripheral";
         case OUTPUT_TARGET_UART:           return "uart";
         case OUTPUT_TARGET_WII_EXTENSION:  return "wii_extension";
+        case OUTPUT_TARGET_JOCP:           return "jocp";
         case OUTPUT_TARGET_COUNT:          break;
     }
     return "unknown";
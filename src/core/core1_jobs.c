@@ -0,0 +1,119 @@
+// core1_jobs.c
+// Background job executor for an otherwise idle Core 1.
+//
+// Lock-free SPSC ring: only Core 0 writes head, only Core 1 writes tail
+// and done. Index updates use release stores and the other side reads
+// them with acquire loads, so a slot is fully written before it becomes
+// visible. Wake-up is __sev(): the SIO FIFO is left alone because Core 1's
+// flash lockout handler (flash_safe_execute_core_init) owns its IRQ.
+
+#include "core/core1_jobs.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+typedef struct {
+    core1_job_fn_t fn;
+    void*          ctx;
+    uint32_t       deadline_us;   // Absolute time_us_32(), valid if has_deadline
+    uint8_t        flags;
+    bool           has_deadline;
+} core1_job_t;
+
+static core1_job_t ring[CORE1_JOB_QUEUE_SIZE];
+static uint32_t head = 0;   // Next slot Core 0 fills
+static uint32_t tail = 0;   // Next slot Core 1 takes
+static uint32_t done = 0;   // Jobs Core 1 has finished
+static bool attached = false;
+
+static core1_job_stats_t stats;
+
+void core1_jobs_attach(void)
+{
+    __atomic_store_n(&attached, true, __ATOMIC_RELEASE);
+}
+
+bool core1_jobs_available(void)
+{
+    return __atomic_load_n(&attached, __ATOMIC_ACQUIRE);
+}
+
+static bool run_inline(core1_job_fn_t fn, void* ctx, uint32_t flags)
+{
+    if (flags & CORE1_JOB_NO_INLINE) {
+        stats.rejected++;
+        return false;
+    }
+    stats.ran_inline++;
+    fn(ctx);
+    return true;
+}
+
+bool core1_job_submit_within(core1_job_fn_t fn, void* ctx, uint32_t flags, uint32_t within_us)
+{
+    stats.submitted++;
+
+    // Protocol task on Core 1, or already on Core 1: no hand-off
+    if (!core1_jobs_available() || get_core_num() != 0) {
+        return run_inline(fn, ctx, flags);
+    }
+
+    uint32_t h = head;
+    uint32_t depth = h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    if (depth >= CORE1_JOB_QUEUE_SIZE) {
+        return run_inline(fn, ctx, flags);
+    }
+
+    core1_job_t* job = &ring[h & (CORE1_JOB_QUEUE_SIZE - 1)];
+    job->fn = fn;
+    job->ctx = ctx;
+    job->flags = (uint8_t)flags;
+    job->has_deadline = within_us != 0;
+    job->deadline_us = time_us_32() + within_us;
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+
+    if (depth + 1 > stats.high_water) stats.high_water = (uint8_t)(depth + 1);
+
+    __sev();
+    return true;
+}
+
+bool core1_job_submit(core1_job_fn_t fn, void* ctx, uint32_t flags)
+{
+    return core1_job_submit_within(fn, ctx, flags, 0);
+}
+
+uint32_t core1_jobs_run(void)
+{
+    uint32_t count = 0;
+    uint32_t t = tail;
+
+    while (t != __atomic_load_n(&head, __ATOMIC_ACQUIRE)) {
+        core1_job_t job = ring[t & (CORE1_JOB_QUEUE_SIZE - 1)];
+        __atomic_store_n(&tail, ++t, __ATOMIC_RELEASE);
+
+        bool late = job.has_deadline && (int32_t)(time_us_32() - job.deadline_us) > 0;
+        if (late) stats.late++;
+
+        if (late && (job.flags & CORE1_JOB_DROP_LATE)) {
+            stats.dropped++;
+        } else {
+            job.fn(job.ctx);
+            stats.ran_core1++;
+        }
+
+        __atomic_store_n(&done, done + 1, __ATOMIC_RELEASE);
+        count++;
+    }
+    return count;
+}
+
+bool core1_jobs_busy(void)
+{
+    return __atomic_load_n(&done, __ATOMIC_ACQUIRE) != __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+}
+
+void core1_jobs_get_stats(core1_job_stats_t* out)
+{
+    memcpy(out, &stats, sizeof(*out));
+}
@@ -0,0 +1,91 @@
+// core1_jobs.h
+// Background job executor for an otherwise idle Core 1 (RP2040/RP2350).
+//
+// Apps whose outputs don't give Core 1 a protocol task (usb2usb, bt2usb,
+// the wifi builds) leave it parked in core1_wrapper()'s __wfe() loop. Core 0
+// can hand bulk work (display flushes) to it through a single-producer/
+// single-consumer ring: Core 0 pushes and __sev()s, Core 1 drains on every
+// wake.
+//
+// When Core 1 runs a timing-critical protocol (core1_task set) or the ring
+// is full, core1_job_submit() runs the job inline on the caller instead,
+// so callers never need a second code path. Calls made from Core 1 itself
+// also run inline. Queued jobs run in submission order; a job that falls
+// back to inline can overtake ones still queued.
+//
+// Jobs must not call flash APIs or printf (same rules as core1_idle_hook),
+// and must not read state Core 0 keeps changing: hand the job its own copy
+// (display_update() snapshots the frame it queues).
+// On ESP32, nRF and CH32 there is no second core to hand work to, and the
+// API below reduces to an inline call.
+
+#ifndef CORE1_JOBS_H
+#define CORE1_JOBS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef void (*core1_job_fn_t)(void* ctx);
+
+// Submission flags
+#define CORE1_JOB_DEFAULT     0
+#define CORE1_JOB_NO_INLINE   (1u << 0)  // Return false instead of running inline
+#define CORE1_JOB_DROP_LATE   (1u << 1)  // Skip (don't call fn) if Core 1 starts it past its deadline
+
+// Ring size (power of two)
+#define CORE1_JOB_QUEUE_SIZE  16
+
+typedef struct {
+    uint32_t submitted;     // Jobs handed to core1_job_submit*()
+    uint32_t ran_core1;     // Executed on Core 1
+    uint32_t ran_inline;    // Executed inline by the caller
+    uint32_t late;          // Started on Core 1 after their deadline
+    uint32_t dropped;       // Late CORE1_JOB_DROP_LATE jobs that were skipped
+    uint32_t rejected;      // CORE1_JOB_NO_INLINE jobs refused
+    uint8_t  high_water;    // Deepest the ring has been
+} core1_job_stats_t;
+
+#if defined(PLATFORM_ESP32) || defined(PLATFORM_NRF) || defined(PLATFORM_CH32)
+
+static inline bool core1_jobs_available(void) { return false; }
+
+static inline bool core1_job_submit_within(core1_job_fn_t fn, void* ctx,
+                                           uint32_t flags, uint32_t within_us)
+{
+    (void)within_us;
+    if (flags & CORE1_JOB_NO_INLINE) return false;
+    fn(ctx);
+    return true;
+}
+
+static inline bool core1_job_submit(core1_job_fn_t fn, void* ctx, uint32_t flags)
+{
+    return core1_job_submit_within(fn, ctx, flags, 0);
+}
+
+#else
+
+// Called once by Core 1 when it enters its idle loop; jobs are queued
+// from then on. Never called when Core 1 runs a protocol task.
+void core1_jobs_attach(void);
+
+// Core 1 idle loop: run every queued job. Returns the number run.
+uint32_t core1_jobs_run(void);
+
+// True once Core 1 is accepting jobs
+bool core1_jobs_available(void);
+
+// Queue fn(ctx) on Core 1, or run it inline (see above). within_us is the
+// deadline relative to now (0 = none). Returns false only for a refused
+// CORE1_JOB_NO_INLINE job.
+bool core1_job_submit_within(core1_job_fn_t fn, void* ctx, uint32_t flags, uint32_t within_us);
+bool core1_job_submit(core1_job_fn_t fn, void* ctx, uint32_t flags);
+
+// True while jobs are queued or running on Core 1
+bool core1_jobs_busy(void);
+
+void core1_jobs_get_stats(core1_job_stats_t* out);
+
+#endif
+
+#endif // CORE1_JOBS_H
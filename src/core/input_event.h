@@ -118,6 +118,10 @@ typedef enum {
 // Unified Input Event Structure
 // ============================================================================
 
+// input_event_t.motion_dt_us: a resend of the previous motion sample (report
+// arrived faster than the sensor), nothing new to integrate
+#define MOTION_DT_REPEAT 0xFFFF
+
 typedef struct {
     // Device identification
     uint8_t dev_addr;           // Device address (USB: 1-127, BT: conn_index, Native: port)
@@ -192,6 +196,9 @@ typedef struct {
     uint16_t gyro_range;        // Gyro full-scale range in dps (e.g., 100 for DS3, 2000 for DS4/DS5)
     uint16_t accel_range;       // Accel full-scale range in milli-g (e.g., 2000 for DS3, 4000 for DS4/DS5)
     bool has_motion;            // Motion data is valid
+    uint16_t motion_dt_us;      // Sensor time this gyro sample covers (µs). 0 = not
+                                // reported, the router times it by arrival.
+                                // MOTION_DT_REPEAT = sample already delivered
 
     // Pressure-sensitive button data (DS3)
     // Order: up, right, down, left, l2, r2, l1, r1, triangle, circle, cross, square
@@ -206,6 +213,13 @@ typedef struct {
     } touch[2];
     bool has_touch;             // Touch data is valid
 
+    // Absolute screen pointer (Wiimote IR camera). 0-65535 across the screen,
+    // 32768 = centre. Set alongside delta_x/delta_y so mouse outputs move the
+    // same way; lightgun-style outputs read the position directly.
+    uint16_t pointer_x;
+    uint16_t pointer_y;
+    bool has_pointer;           // Pointer is on screen
+
     // Battery level
     uint8_t battery_level;      // 0-100 percent (0 = unknown/not reported)
     bool battery_charging;      // True if charging / cable connected
@@ -266,6 +280,9 @@ static inline void init_input_event(input_event_t* event) {
 
     // Clear touch data
     event->has_touch = false;
+
+    // Pointer off screen
+    event->has_pointer = false;
 }
 
 // Convert old post_globals() parameters to input_event_t (for migration)
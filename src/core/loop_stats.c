@@ -0,0 +1,33 @@
+// loop_stats.c
+// Main loop latency histogram.
+
+#include "core/loop_stats.h"
+#include <string.h>
+
+const uint16_t loop_stats_bounds_us[LOOP_STATS_BUCKETS - 1] = {
+    50, 100, 250, 500, 1000, 2000, 5000
+};
+
+static loop_stats_t stats;
+
+void loop_stats_record(uint32_t latency_us)
+{
+    uint8_t bin = 0;
+    while (bin < LOOP_STATS_BUCKETS - 1 && latency_us >= loop_stats_bounds_us[bin]) {
+        bin++;
+    }
+    stats.bins[bin]++;
+    stats.count++;
+    stats.total_us += latency_us;
+    if (latency_us > stats.max_us) stats.max_us = latency_us;
+}
+
+void loop_stats_get(loop_stats_t* out)
+{
+    if (out) *out = stats;
+}
+
+void loop_stats_reset(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,33 @@
+// loop_stats.h
+// Main loop latency histogram.
+//
+// Measures how long it takes the main loop to service an event: from the
+// first wake request (input arrival, USB or interrupt event) to the end of
+// the loop pass that ran the outputs. Ports record samples; the CDC
+// LOOP.STATS command reads them.
+
+#ifndef LOOP_STATS_H
+#define LOOP_STATS_H
+
+#include <stdint.h>
+
+// Bucket upper bounds in microseconds. The last bucket counts everything
+// at or above the final bound.
+#define LOOP_STATS_BUCKETS  8
+extern const uint16_t loop_stats_bounds_us[LOOP_STATS_BUCKETS - 1];
+
+typedef struct {
+    uint32_t bins[LOOP_STATS_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+} loop_stats_t;
+
+// Add one wake-to-service sample (main loop context only)
+void loop_stats_record(uint32_t latency_us);
+
+// Snapshot / clear the histogram
+void loop_stats_get(loop_stats_t* out);
+void loop_stats_reset(void);
+
+#endif // LOOP_STATS_H
@@ -0,0 +1,368 @@
+// power.c
+// Tiered idle power management for the Core 0 main loop.
+//
+// Waits are __wfi() with interrupts masked around the final check, so an
+// alarm or edge that lands between the check and the instruction still
+// wakes it. Each wait arms a one-shot alarm for the tier's tick; wake pin
+// edges are only armed while below ACTIVE, so play costs no interrupts.
+
+#include "core/power.h"
+#include "core/router/router.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/structs/clocks.h"
+#include "hardware/structs/i2c.h"
+#include "hardware/structs/pio.h"
+#include "hardware/structs/pwm.h"
+#include "hardware/structs/resets.h"
+#include "hardware/structs/scb.h"
+#include <stdio.h>
+#include <string.h>
+
+// USB needs clk_sys to keep up with its DPRAM; don't go below clk_usb
+#define POWER_IDLE_MIN_USB_HZ   48000000u
+
+#define WAKE_EDGES (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)
+
+static bool enabled = false;
+static bool started = false;
+static bool core1_busy = false;
+
+static power_tier_t tier = POWER_ACTIVE;
+static uint32_t tier_since_us = 0;
+static volatile uint32_t last_activity_ms = 0;
+
+// clk_sys while active; 0 = not running from pll_sys, never lowered
+static uint32_t sys_hz_full = 0;
+static bool downclocked = false;
+
+static uint32_t wake_mask = 0;          // Pins registered for edge wake
+static uint32_t wake_irq_mask = 0;      // Pins the IRQ handler owns
+static volatile bool edge_pending = false;
+static volatile uint32_t edge_us = 0;
+static volatile bool tick_fired = false;
+
+#if !PICO_RP2350
+static uint32_t sleep_en0_full, sleep_en1_full;
+#endif
+
+static power_stats_t stats;
+
+void power_enable(void)
+{
+    enabled = true;
+}
+
+void power_wake_on_gpio(uint8_t gpio)
+{
+    if (gpio < 32) wake_mask |= 1u << gpio;
+}
+
+power_tier_t power_get_tier(void)
+{
+    return tier;
+}
+
+// ============================================================================
+// WAKE SOURCES
+// ============================================================================
+
+static void wake_gpio_irq(void)
+{
+    uint32_t now = time_us_32();
+    bool hit = false;
+    for (uint32_t m = wake_irq_mask; m; m &= m - 1) {
+        uint gpio = (uint)__builtin_ctz(m);
+        uint32_t ev = gpio_get_irq_event_mask(gpio) & WAKE_EDGES;
+        if (ev) {
+            gpio_acknowledge_irq(gpio, ev);
+            hit = true;
+        }
+    }
+    if (hit && !edge_pending) {
+        edge_us = now;
+        edge_pending = true;
+    }
+}
+
+static void arm_wake_pins(bool on)
+{
+    for (uint32_t m = wake_irq_mask; m; m &= m - 1) {
+        gpio_set_irq_enabled((uint)__builtin_ctz(m), WAKE_EDGES, on);
+    }
+}
+
+static int64_t tick_alarm(alarm_id_t id, void* user_data)
+{
+    (void)id; (void)user_data;
+    tick_fired = true;
+    return 0;
+}
+
+void power_note_activity(void)
+{
+    last_activity_ms = to_ms_since_boot(get_absolute_time());
+    if (edge_pending) {
+        uint32_t us = time_us_32() - edge_us;
+        edge_pending = false;
+        stats.first_input_count++;
+        stats.first_input_last_us = us;
+        stats.first_input_total_us += us;
+        if (us > stats.first_input_max_us) stats.first_input_max_us = us;
+    }
+}
+
+// ============================================================================
+// CLOCKS
+// ============================================================================
+
+// Anything clocked by clk_sys that would change speed with it
+static bool sys_clock_in_use(void)
+{
+    if ((pio0_hw->ctrl | pio1_hw->ctrl) & PIO_CTRL_SM_ENABLE_BITS) return true;
+#if PICO_RP2350
+    if (pio2_hw->ctrl & PIO_CTRL_SM_ENABLE_BITS) return true;
+#endif
+    return !(resets_hw->reset & RESETS_RESET_PWM_BITS) && pwm_hw->en != 0;
+}
+
+static void set_sys_clock(bool low)
+{
+    if (low == downclocked || !sys_hz_full) return;
+
+    uint32_t hz = sys_hz_full;
+    if (low) {
+        hz = sys_hz_full / POWER_IDLE_SYS_DIV;
+        if (!(resets_hw->reset & RESETS_RESET_USBCTRL_BITS)) {
+            while (hz < POWER_IDLE_MIN_USB_HZ && hz < sys_hz_full) {
+                hz = sys_hz_full / (sys_hz_full / hz - 1);
+            }
+        }
+        if (hz >= sys_hz_full) return;
+        stats.downclocks++;
+        stats.sys_khz_idle = hz / 1000;
+    }
+
+    clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                    CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, sys_hz_full, hz);
+    downclocked = low;
+}
+
+// ============================================================================
+// CLOCK GATING (RP2040)
+// ============================================================================
+//
+// sleep_en0/1 choose which clocks keep running while both cores are in deep
+// sleep. Blocks held in reset, PIO blocks with every state machine stopped,
+// and disabled PWM/I2C are dropped; everything else (timer, IO, USB, DMA,
+// XIP, SRAM) stays so wake sources and running transfers are unaffected.
+
+#if !PICO_RP2350
+typedef struct {
+    uint32_t reset;
+    uint32_t en0;
+    uint32_t en1;
+} gate_t;
+
+static const gate_t gates[] = {
+    { RESETS_RESET_ADC_BITS,  CLOCKS_SLEEP_EN0_CLK_SYS_ADC_BITS | CLOCKS_SLEEP_EN0_CLK_ADC_ADC_BITS, 0 },
+    { RESETS_RESET_RTC_BITS,  CLOCKS_SLEEP_EN0_CLK_SYS_RTC_BITS | CLOCKS_SLEEP_EN0_CLK_RTC_RTC_BITS, 0 },
+    { RESETS_RESET_SPI0_BITS, CLOCKS_SLEEP_EN0_CLK_SYS_SPI0_BITS | CLOCKS_SLEEP_EN0_CLK_PERI_SPI0_BITS, 0 },
+    { RESETS_RESET_SPI1_BITS, CLOCKS_SLEEP_EN0_CLK_SYS_SPI1_BITS | CLOCKS_SLEEP_EN0_CLK_PERI_SPI1_BITS, 0 },
+    { RESETS_RESET_UART0_BITS, 0, CLOCKS_SLEEP_EN1_CLK_SYS_UART0_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART0_BITS },
+    { RESETS_RESET_UART1_BITS, 0, CLOCKS_SLEEP_EN1_CLK_SYS_UART1_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART1_BITS },
+    { RESETS_RESET_USBCTRL_BITS, 0, CLOCKS_SLEEP_EN1_CLK_SYS_USBCTRL_BITS | CLOCKS_SLEEP_EN1_CLK_USB_USBCTRL_BITS },
+    { RESETS_RESET_PIO0_BITS, CLOCKS_SLEEP_EN0_CLK_SYS_PIO0_BITS, 0 },
+    { RESETS_RESET_PIO1_BITS, CLOCKS_SLEEP_EN0_CLK_SYS_PIO1_BITS, 0 },
+    { RESETS_RESET_PWM_BITS,  CLOCKS_SLEEP_EN0_CLK_SYS_PWM_BITS, 0 },
+    { RESETS_RESET_I2C0_BITS, CLOCKS_SLEEP_EN0_CLK_SYS_I2C0_BITS, 0 },
+    { RESETS_RESET_I2C1_BITS, CLOCKS_SLEEP_EN0_CLK_SYS_I2C1_BITS, 0 },
+};
+
+// Out of reset but idle (only read once the block is known to be clocked)
+static bool block_idle(uint32_t reset)
+{
+    switch (reset) {
+        case RESETS_RESET_PIO0_BITS: return !(pio0_hw->ctrl & PIO_CTRL_SM_ENABLE_BITS);
+        case RESETS_RESET_PIO1_BITS: return !(pio1_hw->ctrl & PIO_CTRL_SM_ENABLE_BITS);
+        case RESETS_RESET_PWM_BITS:  return pwm_hw->en == 0;
+        case RESETS_RESET_I2C0_BITS: return !(i2c0_hw->enable & I2C_IC_ENABLE_ENABLE_BITS);
+        case RESETS_RESET_I2C1_BITS: return !(i2c1_hw->enable & I2C_IC_ENABLE_ENABLE_BITS);
+        default: return false;
+    }
+}
+
+static void set_gating(bool on)
+{
+    if (!on) {
+        clocks_hw->sleep_en0 = sleep_en0_full;
+        clocks_hw->sleep_en1 = sleep_en1_full;
+        scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+        return;
+    }
+
+    uint32_t en0 = sleep_en0_full, en1 = sleep_en1_full;
+    uint32_t in_reset = resets_hw->reset;
+    for (uint i = 0; i < count_of(gates); i++) {
+        if ((in_reset & gates[i].reset) || block_idle(gates[i].reset)) {
+            en0 &= ~gates[i].en0;
+            en1 &= ~gates[i].en1;
+        }
+    }
+    clocks_hw->sleep_en0 = en0;
+    clocks_hw->sleep_en1 = en1;
+    scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+}
+#else
+static inline void set_gating(bool on) { (void)on; }
+#endif
+
+void power_core1_attach(void)
+{
+#if !PICO_RP2350
+    // Per-core register: Core 1's __wfe() now reports deep sleep. With the
+    // default (all-on) sleep_en masks that changes nothing.
+    scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+#endif
+}
+
+// ============================================================================
+// TIERS
+// ============================================================================
+
+static void set_tier(power_tier_t next)
+{
+    uint32_t now = time_us_32();
+    stats.tier_us[tier] += now - tier_since_us;
+    tier_since_us = now;
+    if (next == tier) return;
+
+    if (next == POWER_ACTIVE) {
+        // Full speed first: the next pass is the one that reads the input
+        set_sys_clock(false);
+        set_gating(false);
+        arm_wake_pins(false);
+    } else {
+        if (tier == POWER_ACTIVE) {
+            edge_pending = false;
+            arm_wake_pins(true);
+        }
+        set_gating(next == POWER_GATED);
+    }
+
+    stats.entries[next]++;
+    tier = next;
+}
+
+static void wait_tick(uint32_t tick_us)
+{
+    tick_fired = false;
+    alarm_id_t id = add_alarm_in_us(tick_us, tick_alarm, NULL, true);
+    if (id < 0) return;
+
+    stats.waits++;
+    uint32_t save = save_and_disable_interrupts();
+    if (!tick_fired && !edge_pending) __wfi();
+    restore_interrupts(save);
+
+    if (!tick_fired) cancel_alarm(id);
+}
+
+void power_init(bool core1_protocol)
+{
+    core1_busy = core1_protocol;
+    if (!enabled || core1_busy) return;
+
+    // Lowering clk_sys is only safe while it runs straight off pll_sys, and
+    // only if clk_peri doesn't follow it (UART/SPI baud rates). Move clk_peri
+    // onto pll_sys directly: same frequency, so nothing notices.
+    uint32_t ctrl = clocks_hw->clk[clk_sys].ctrl;
+    bool from_pll =
+        ((ctrl & CLOCKS_CLK_SYS_CTRL_SRC_BITS) >> CLOCKS_CLK_SYS_CTRL_SRC_LSB) ==
+            CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX &&
+        ((ctrl & CLOCKS_CLK_SYS_CTRL_AUXSRC_BITS) >> CLOCKS_CLK_SYS_CTRL_AUXSRC_LSB) ==
+            CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS &&
+        clocks_hw->clk[clk_sys].div == (1u << CLOCKS_CLK_SYS_DIV_INT_LSB);
+    if (from_pll) {
+        sys_hz_full = clock_get_hz(clk_sys);
+        uint32_t peri = clocks_hw->clk[clk_peri].ctrl;
+        if (((peri & CLOCKS_CLK_PERI_CTRL_AUXSRC_BITS) >> CLOCKS_CLK_PERI_CTRL_AUXSRC_LSB) ==
+                CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS &&
+            clock_get_hz(clk_peri) == sys_hz_full) {
+            clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS,
+                            sys_hz_full, sys_hz_full);
+        } else if (((peri & CLOCKS_CLK_PERI_CTRL_AUXSRC_BITS) >> CLOCKS_CLK_PERI_CTRL_AUXSRC_LSB) ==
+                   CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS) {
+            sys_hz_full = 0;    // Divided clk_peri off clk_sys: leave clocks alone
+        }
+    }
+    stats.sys_khz_full = clock_get_hz(clk_sys) / 1000;
+
+#if !PICO_RP2350
+    sleep_en0_full = clocks_hw->sleep_en0;
+    sleep_en1_full = clocks_hw->sleep_en1;
+#endif
+
+    // Edge wake for pins registered so far (pad buttons register at init)
+    wake_irq_mask = wake_mask;
+    if (wake_irq_mask) {
+        gpio_add_raw_irq_handler_masked(wake_irq_mask, wake_gpio_irq);
+        irq_set_enabled(IO_IRQ_BANK0, true);
+    }
+
+    last_activity_ms = to_ms_since_boot(get_absolute_time());
+    tier_since_us = time_us_32();
+    started = true;
+
+    printf("[power] Idle tiers on: clk_sys %lu kHz%s, %u wake pins\n",
+           (unsigned long)stats.sys_khz_full, sys_hz_full ? "" : " (fixed)",
+           (unsigned)__builtin_popcount(wake_irq_mask));
+}
+
+void power_idle_wait(void)
+{
+    if (!started) return;
+
+    // Input from any source counts, not only sources that call in here
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    uint32_t idle_ms = now_ms - last_activity_ms;
+    uint32_t routed_ms = router_ms_since_activity();
+    if (routed_ms < idle_ms) idle_ms = routed_ms;
+
+    power_tier_t want = idle_ms >= POWER_GATED_AFTER_MS ? POWER_GATED :
+                        idle_ms >= POWER_IDLE_AFTER_MS  ? POWER_IDLE  : POWER_ACTIVE;
+    set_tier(want);
+    if (tier == POWER_ACTIVE) return;
+
+    // Re-checked every wait: a PIO program or PWM started since must not
+    // run at the lowered clock
+    set_sys_clock(!sys_clock_in_use());
+
+    wait_tick(tier == POWER_GATED ? POWER_GATED_TICK_US : POWER_IDLE_TICK_US);
+
+    if (edge_pending) {
+        // The edge is the activity; stay up until the input is delivered
+        stats.edge_wakes++;
+        last_activity_ms = to_ms_since_boot(get_absolute_time());
+        set_tier(POWER_ACTIVE);
+    }
+}
+
+void power_get_stats(power_stats_t* out)
+{
+    uint32_t save = save_and_disable_interrupts();
+    *out = stats;
+    restore_interrupts(save);
+    out->tier_us[tier] += time_us_32() - tier_since_us;
+}
+
+void power_reset_stats(void)
+{
+    uint32_t full = stats.sys_khz_full;
+    memset(&stats, 0, sizeof(stats));
+    stats.sys_khz_full = full;
+    tier_since_us = time_us_32();
+}
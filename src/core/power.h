@@ -0,0 +1,98 @@
+// power.h
+// Tiered idle power management for the Core 0 main loop (RP2040/RP2350).
+//
+// Battery builds (pad controllers, BLE output) call power_enable(); nothing
+// changes for anything else. Once enabled, and only while Core 1 is not
+// running a timing-critical protocol, the main loop steps down as input
+// goes quiet:
+//
+//   ACTIVE   spin at full clock (any activity returns here at once)
+//   IDLE     POWER_IDLE_AFTER_MS without activity: __wfi() between passes,
+//            each wait capped at POWER_IDLE_TICK_US so polled inputs are
+//            still sampled. clk_sys drops to pll_sys / POWER_IDLE_SYS_DIV
+//            when no PIO state machine or PWM slice depends on it.
+//   GATED    POWER_GATED_AFTER_MS without activity: as IDLE, plus the clocks
+//            of peripherals held in reset, stopped PIO blocks and disabled
+//            PWM/I2C are gated whenever both cores sleep (RP2040 only), and
+//            the wait cap stretches to POWER_GATED_TICK_US.
+//
+// Pins registered with power_wake_on_gpio() end any wait on an edge, and the
+// loop restores full clock before the pass that reads them. The time from
+// such an edge to the input being delivered (power_note_activity()) is
+// measured; CDC POWER.STATS reports it. Inputs without a wake pin are seen
+// within one tick.
+//
+// The deepest tier, dormant with GPIO-edge wake, is platform_deep_sleep();
+// callers that own a wake button (ble_output, controller apps) enter it.
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define POWER_IDLE_AFTER_MS     2000
+#define POWER_GATED_AFTER_MS    30000
+#define POWER_IDLE_TICK_US      1000    // Longest wait in IDLE
+#define POWER_GATED_TICK_US     4000    // Longest wait in GATED
+#define POWER_IDLE_SYS_DIV      4       // clk_sys divider while idle
+
+typedef enum {
+    POWER_ACTIVE = 0,
+    POWER_IDLE,
+    POWER_GATED,
+    POWER_TIER_COUNT
+} power_tier_t;
+
+typedef struct {
+    uint64_t tier_us[POWER_TIER_COUNT];     // Time spent in each tier
+    uint32_t entries[POWER_TIER_COUNT];     // Times each tier was entered
+    uint32_t waits;                         // __wfi() calls
+    uint32_t edge_wakes;                    // Waits ended by a wake pin edge
+    uint32_t downclocks;                    // Times clk_sys was lowered
+    uint32_t first_input_count;             // Edge-to-delivery samples
+    uint32_t first_input_last_us;
+    uint32_t first_input_max_us;
+    uint64_t first_input_total_us;
+    uint32_t sys_khz_full;
+    uint32_t sys_khz_idle;                  // 0 = never lowered
+} power_stats_t;
+
+#if defined(PLATFORM_ESP32) || defined(PLATFORM_NRF) || defined(PLATFORM_CH32)
+
+static inline void power_enable(void) {}
+static inline void power_note_activity(void) {}
+static inline void power_wake_on_gpio(uint8_t gpio) { (void)gpio; }
+
+#else
+
+// Opt in to idle power management. Call during init (output/input init or
+// app_init); power_init() decides once. Safe to call more than once.
+void power_enable(void);
+
+// Core 0, once the schedule is set up. core1_busy: Core 1 runs a protocol
+// task, which pins the manager to ACTIVE.
+void power_init(bool core1_busy);
+
+// Core 1 idle loop, once: lets its __wfe() count as deep sleep so clock
+// gating can apply when both cores are idle.
+void power_core1_attach(void);
+
+// Input was seen (task context). Returns the loop to ACTIVE and, after an
+// edge wake, records the edge-to-delivery latency.
+void power_note_activity(void);
+
+// An edge on this GPIO ends an idle wait immediately.
+void power_wake_on_gpio(uint8_t gpio);
+
+// Between main loop passes: step tiers and wait as the current tier allows.
+void power_idle_wait(void);
+
+#endif
+
+// Introspection (CDC POWER.STATS)
+power_tier_t power_get_tier(void);
+void power_get_stats(power_stats_t* out);
+void power_reset_stats(void);
+
+#endif // POWER_H
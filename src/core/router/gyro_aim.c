@@ -0,0 +1,194 @@
+// gyro_aim.c - Gyro aiming for outputs without motion
+
+#include "gyro_aim.h"
+#include <string.h>
+
+// ============================================================================
+// TUNING
+// ============================================================================
+
+// Longest gap one arrival-timed sample may cover. Anything longer is a
+// dropout, not rotation the controller measured.
+#define MAX_SAMPLE_DT_US        50000
+
+// Stillness: every axis within STILL_MDPS of the reference for STILL_SAMPLES
+// in a row. Before the bias has converged the reference is the start of the
+// still run; afterwards it is the bias itself, with a tighter window so slow
+// deliberate aiming isn't mistaken for drift.
+#define STILL_MDPS              1500
+#define STILL_MDPS_CALIBRATED   500
+#define STILL_SAMPLES           40
+// No real gyro is off by more than this at rest; steady turning faster than
+// it is never taken for bias, calibrated or not
+#define STILL_MAX_MDPS          10000
+
+// Bias EMA: 1/8 for the first CAL_FAST_UPDATES updates, then 1/2048 (about
+// ten seconds at 200 Hz) so it follows temperature, not the player.
+#define CAL_FAST_SHIFT          3
+#define CAL_SLOW_SHIFT          11
+#define CAL_FAST_UPDATES        32
+
+// Aim units: integration runs in 1e-10 degree (mdps x us x tenths of sens)
+// and hands out micro-degrees.
+#define SUB_UDEG                10000
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static inline int32_t abs32(int32_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+// Cheap vector length (alpha-max plus beta-min, within ~7%)
+static inline int32_t magnitude(int32_t x, int32_t y)
+{
+    int32_t ax = abs32(x), ay = abs32(y);
+    int32_t hi = ax > ay ? ax : ay;
+    int32_t lo = ax > ay ? ay : ax;
+    return hi + (lo * 3) / 8;
+}
+
+static void track_bias(gyro_aim_source_t* src, const int32_t rate[3])
+{
+    bool calibrated = src->cal_samples >= CAL_FAST_UPDATES;
+    bool still = true;
+    int32_t window = calibrated ? STILL_MDPS_CALIBRATED : STILL_MDPS;
+    for (int i = 0; i < 3; i++) {
+        int32_t ref = calibrated ? src->bias[i] / GYRO_AIM_BIAS_SCALE : src->anchor[i];
+        if (abs32(rate[i] - ref) > window || abs32(rate[i]) > STILL_MAX_MDPS) still = false;
+    }
+
+    if (!still) {
+        src->still = 0;
+        for (int i = 0; i < 3; i++) src->anchor[i] = rate[i];
+        return;
+    }
+
+    if (src->still < STILL_SAMPLES) {
+        src->still++;
+        return;
+    }
+
+    int32_t div = calibrated ? (1 << CAL_SLOW_SHIFT) : (1 << CAL_FAST_SHIFT);
+    for (int i = 0; i < 3; i++) {
+        src->bias[i] += (rate[i] * GYRO_AIM_BIAS_SCALE - src->bias[i]) / div;
+    }
+    if (!calibrated) src->cal_samples++;
+}
+
+// ============================================================================
+// INPUT SIDE
+// ============================================================================
+
+void gyro_aim_source_init(gyro_aim_source_t* src)
+{
+    memset(src, 0, sizeof(*src));
+}
+
+bool gyro_aim_active(gyro_aim_source_t* src, uint8_t activation, bool button_held)
+{
+    bool active;
+    switch (activation) {
+        case GYRO_AIM_HOLD:
+            active = button_held;
+            break;
+        case GYRO_AIM_HOLD_OFF:
+            active = !button_held;
+            break;
+        case GYRO_AIM_TOGGLE:
+            if (button_held && !src->held) src->toggled = !src->toggled;
+            active = src->toggled;
+            break;
+        default:
+            active = true;
+            break;
+    }
+    src->held = button_held;
+    return active;
+}
+
+bool gyro_aim_sample(gyro_aim_source_t* src, const gyro_aim_config_t* cfg,
+                     const int16_t gyro[3], uint16_t gyro_range,
+                     uint32_t dt_us, uint32_t now_us, bool active, int32_t out[2])
+{
+    out[0] = out[1] = 0;
+
+    if (dt_us == 0 && src->timed) {
+        dt_us = now_us - src->last_us;
+        if (dt_us > MAX_SAMPLE_DT_US) dt_us = MAX_SAMPLE_DT_US;
+    }
+    src->last_us = now_us;
+    src->timed = true;
+
+    int32_t rate[3];
+    for (int i = 0; i < 3; i++) {
+        rate[i] = (int32_t)(((int64_t)gyro[i] * gyro_range * 1000) / 32768);
+    }
+    track_bias(src, rate);
+
+    if (!active || dt_us == 0 || cfg->mode == GYRO_AIM_OFF) {
+        src->frac[0] = src->frac[1] = 0;
+        return false;
+    }
+
+    int32_t pitch = rate[0] - src->bias[0] / GYRO_AIM_BIAS_SCALE;
+    int32_t yaw   = rate[1] - src->bias[1] / GYRO_AIM_BIAS_SCALE;
+    int32_t roll  = rate[2] - src->bias[2] / GYRO_AIM_BIAS_SCALE;
+
+    // Counter-clockwise positive: turning right is negative yaw, tilting up
+    // is positive pitch. Output x is right, y is down (HID).
+    int32_t v[2];
+    v[0] = -((cfg->flags & GYRO_AIM_FLAG_ROLL) ? roll : yaw);
+    v[1] = -pitch;
+    if (cfg->flags & GYRO_AIM_FLAG_INVERT_X) v[0] = -v[0];
+    if (cfg->flags & GYRO_AIM_FLAG_INVERT_Y) v[1] = -v[1];
+
+    int32_t mag = magnitude(v[0], v[1]);
+
+    // Deadzone with a recovery ramp: nothing below dz, then scale back up to
+    // 1:1 at 2*dz so slow aiming doesn't jump when it crosses the edge
+    int32_t dz = cfg->deadzone * 100;
+    if (dz > 0) {
+        if (mag <= dz) return false;
+        if (mag < 2 * dz) {
+            for (int a = 0; a < 2; a++) {
+                v[a] = (int32_t)(((int64_t)v[a] * (mag - dz)) / dz);
+            }
+            mag = (int32_t)(((int64_t)mag * (mag - dz)) / dz);
+        }
+    }
+
+    // Acceleration: sens_min at rest rising linearly to sens_max at accel_dps
+    int64_t num = cfg->sens_min;
+    int64_t den = 1;
+    if (cfg->accel_dps) {
+        int32_t thr = cfg->accel_dps * 1000;
+        int32_t m = mag < thr ? mag : thr;
+        num = (int64_t)cfg->sens_min * thr + (int64_t)(cfg->sens_max - cfg->sens_min) * m;
+        den = thr;
+    }
+
+    bool moved = false;
+    for (int a = 0; a < 2; a++) {
+        int64_t scaled = ((int64_t)v[a] * num) / den;         // mdps x tenths
+        int64_t sub = src->frac[a] + scaled * dt_us;          // 1e-10 deg
+        out[a] = (int32_t)(sub / SUB_UDEG);
+        src->frac[a] = sub - (int64_t)out[a] * SUB_UDEG;
+        if (out[a]) moved = true;
+    }
+    return moved;
+}
+
+// ============================================================================
+// OUTPUT SIDE
+// ============================================================================
+
+void gyro_aim_accum_init(gyro_aim_accum_t* acc)
+{
+    acc->total[0] = acc->total[1] = 0;
+    acc->consumed[0] = acc->consumed[1] = 0;
+    acc->last_us = 0;
+    acc->primed = false;
+}
@@ -0,0 +1,212 @@
+// gyro_aim.h - Gyro aiming for outputs without motion
+//
+// Turns controller rotation into right-stick deflection or mouse deltas so
+// consoles with no motion input (GC, N64, PS2, Dreamcast, XInput...) can be
+// aimed with the gyro. Every IMU sample is integrated as it arrives; outputs
+// drain the integrated rotation when they build a report, so nothing between
+// reports is lost no matter how the two rates line up.
+//
+// Split in two halves so the router can hand rotation from the input core to
+// the output core without locks:
+//   gyro_aim_source_t — per input device, input side only. Calibrates the
+//                       gyro, applies deadzone and acceleration curve, and
+//                       integrates each sample into micro-degrees of aim.
+//   gyro_aim_accum_t  — per output player. The input side only ever adds to
+//                       `total` (32-bit stores); the output side only moves
+//                       `consumed`, so the two never write the same word.
+//
+// Fixed point throughout, no platform dependency (tools/gyro-aim-replay
+// builds it on the host).
+//
+// Axis convention is the DS4 / SDL one the motion path already uses:
+// gyro[0] = pitch, gyro[1] = yaw, gyro[2] = roll, counter-clockwise positive.
+
+#ifndef GYRO_AIM_H
+#define GYRO_AIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+typedef enum {
+    GYRO_AIM_OFF = 0,
+    GYRO_AIM_STICK,             // Blend into the right stick
+    GYRO_AIM_MOUSE,             // Add to delta_x / delta_y
+} gyro_aim_mode_t;
+
+typedef enum {
+    GYRO_AIM_ALWAYS = 0,        // Always on
+    GYRO_AIM_HOLD,              // On while the button is held
+    GYRO_AIM_TOGGLE,            // Button press toggles on/off
+    GYRO_AIM_HOLD_OFF,          // On except while the button is held (ratchet)
+} gyro_aim_activation_t;
+
+// Flags
+#define GYRO_AIM_FLAG_INVERT_X  (1 << 0)
+#define GYRO_AIM_FLAG_INVERT_Y  (1 << 1)
+#define GYRO_AIM_FLAG_ROLL      (1 << 2)    // Horizontal from roll instead of yaw
+
+// Output scale at 1.0x sensitivity
+#define GYRO_AIM_MOUSE_COUNTS_PER_DEG   16
+#define GYRO_AIM_STICK_FULL_DPS         254     // 2 dps per stick unit, 127 = full
+
+typedef struct {
+    uint8_t mode;               // gyro_aim_mode_t
+    uint8_t sens_min;           // Sensitivity at rest, tenths (10 = 1.0x)
+    uint8_t sens_max;           // Sensitivity at accel_dps and above, tenths
+    uint8_t accel_dps;          // Speed where sens_max is reached; 0 = flat sens_min
+    uint8_t deadzone;           // Rotation below this is dropped, tenths of a dps
+    uint8_t stick_min;          // Stick mode: smallest deflection sent (game deadzone)
+    uint8_t flags;              // GYRO_AIM_FLAG_*
+} gyro_aim_config_t;
+
+// ============================================================================
+// INPUT SIDE
+// ============================================================================
+
+// Bias is kept in fractions of an mdps so the slow EMA can still move it
+#define GYRO_AIM_BIAS_SCALE     256
+
+typedef struct {
+    int32_t bias[3];            // Gyro zero-rate offset, mdps x GYRO_AIM_BIAS_SCALE
+    int32_t anchor[3];          // Rate at the start of the current still run, mdps
+    uint16_t still;             // Consecutive samples below the stillness threshold
+    uint8_t cal_samples;        // Bias updates so far (fast convergence at first)
+    bool timed;                 // last_us is valid
+    uint32_t last_us;           // Arrival of the previous sample
+    int64_t frac[2];            // Sub-micro-degree remainder carried between samples
+    bool toggled;               // GYRO_AIM_TOGGLE state
+    bool held;                  // Activation button state on the previous event
+} gyro_aim_source_t;
+
+void gyro_aim_source_init(gyro_aim_source_t* src);
+
+// Track the activation button. Returns true if aiming is on for this event.
+bool gyro_aim_active(gyro_aim_source_t* src, uint8_t activation, bool button_held);
+
+// Integrate one gyro sample. `gyro` is int16 scaled to ±gyro_range dps.
+// `dt_us` is the sensor time the sample covers; pass 0 to time it by arrival
+// (now_us minus the previous sample). The bias keeps tracking while inactive;
+// only active samples produce aim. Writes the aim in micro-degrees (x right,
+// y down) to `out` and returns true if it is non-zero.
+bool gyro_aim_sample(gyro_aim_source_t* src, const gyro_aim_config_t* cfg,
+                     const int16_t gyro[3], uint16_t gyro_range,
+                     uint32_t dt_us, uint32_t now_us, bool active, int32_t out[2]);
+
+// ============================================================================
+// OUTPUT SIDE
+// ============================================================================
+
+typedef struct {
+    volatile uint32_t total[2]; // Aim added by the input side, micro-degrees (wraps)
+    uint32_t consumed[2];       // Aim emitted by the output side (wraps)
+    uint32_t last_us;           // Previous stick drain
+    bool primed;                // last_us is valid
+} gyro_aim_accum_t;
+
+void gyro_aim_accum_init(gyro_aim_accum_t* acc);
+
+// Most aim an accumulator holds for an output that isn't draining it, so a
+// stalled output can't wrap the counters
+#define GYRO_AIM_PENDING_MAX_UDEG       90000000    // 90 degrees
+
+// Aim not yet emitted, micro-degrees
+static inline int32_t gyro_aim_accum_pending(const gyro_aim_accum_t* acc, int axis)
+{
+    return (int32_t)(acc->total[axis] - acc->consumed[axis]);
+}
+
+// Input side: add one sample's aim, saturating pending at the cap
+static inline void gyro_aim_accum_add(gyro_aim_accum_t* acc, const int32_t aim[2])
+{
+    for (int a = 0; a < 2; a++) {
+        int32_t pending = gyro_aim_accum_pending(acc, a);
+        int32_t next = pending + aim[a];
+        if (next > GYRO_AIM_PENDING_MAX_UDEG) next = GYRO_AIM_PENDING_MAX_UDEG;
+        if (next < -GYRO_AIM_PENDING_MAX_UDEG) next = -GYRO_AIM_PENDING_MAX_UDEG;
+        acc->total[a] += (uint32_t)(next - pending);
+    }
+}
+
+// Output side, at report time. Inline and call-free, so router_get_output()
+// can drain from core 1 or an IRQ while flash is busy.
+
+// Aim units on the output side
+#define GYRO_AIM_MOUSE_UDEG_PER_COUNT   (1000000 / GYRO_AIM_MOUSE_COUNTS_PER_DEG)
+#define GYRO_AIM_STICK_UDEG_PER_UNIT_US (GYRO_AIM_STICK_FULL_DPS / 127)   // Per unit held 1 us
+#define GYRO_AIM_MAX_DRAIN_DT_US        1000000     // Longest interval one stick drain averages over
+
+// Stick: deflect rx/ry (0-255, blended on top of the physical stick) by the
+// average rate since the previous drain; whatever the stick can't show
+// (clamped, or below one unit) stays for the next report.
+static inline void gyro_aim_drain_stick(gyro_aim_accum_t* acc, const gyro_aim_config_t* cfg,
+                                        uint32_t now_us, uint8_t* rx, uint8_t* ry)
+{
+    if (!acc->primed) {
+        acc->primed = true;
+        acc->last_us = now_us;
+        return;
+    }
+
+    uint32_t dt = now_us - acc->last_us;
+    if (dt == 0) return;
+    acc->last_us = now_us;
+    if (dt > GYRO_AIM_MAX_DRAIN_DT_US) dt = GYRO_AIM_MAX_DRAIN_DT_US;
+
+    int32_t unit = (int32_t)dt * GYRO_AIM_STICK_UDEG_PER_UNIT_US;  // Aim of one unit over dt
+    uint8_t* axis[2] = { rx, ry };
+
+    for (int a = 0; a < 2; a++) {
+        int32_t phys = (int32_t)*axis[a] - 128;
+        int32_t want = gyro_aim_accum_pending(acc, a) / unit;
+
+        int32_t out = phys + want;
+        if (out > 127) out = 127;
+        if (out < -128) out = -128;
+        int32_t used = out - phys;
+        if (used == 0) continue;
+
+        acc->consumed[a] += (uint32_t)(used * unit);
+
+        // Push past the game's own deadzone. The accounting above stays in
+        // linear units; this only changes what the game is shown.
+        if (cfg->stick_min) {
+            int32_t mag = cfg->stick_min + ((used < 0 ? -used : used) * (127 - cfg->stick_min)) / 127;
+            used = used < 0 ? -mag : mag;
+        }
+        out = phys + used;
+        if (out > 127) out = 127;
+        if (out < -128) out = -128;
+        *axis[a] = (uint8_t)(128 + out);
+    }
+}
+
+// Mouse: add whole counts to dx/dy, keeping the sub-count remainder
+static inline void gyro_aim_drain_mouse(gyro_aim_accum_t* acc, int16_t* dx, int16_t* dy)
+{
+    int16_t* axis[2] = { dx, dy };
+
+    for (int a = 0; a < 2; a++) {
+        int32_t counts = gyro_aim_accum_pending(acc, a) / GYRO_AIM_MOUSE_UDEG_PER_COUNT;
+        int32_t sum = *axis[a] + counts;
+        if (sum > 32767) sum = 32767;
+        if (sum < -32767) sum = -32767;
+        counts = sum - *axis[a];
+
+        acc->consumed[a] += (uint32_t)(counts * GYRO_AIM_MOUSE_UDEG_PER_COUNT);
+        *axis[a] = (int16_t)sum;
+    }
+}
+
+// Drop anything pending (aim turned off)
+static inline void gyro_aim_drain_discard(gyro_aim_accum_t* acc)
+{
+    acc->consumed[0] = acc->total[0];
+    acc->consumed[1] = acc->total[1];
+    acc->primed = false;
+}
+
+#endif // GYRO_AIM_H
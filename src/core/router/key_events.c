@@ -0,0 +1,112 @@
+// key_events.c - Ordered key press/release queue for keyboard outputs
+
+#include "key_events.h"
+#include <string.h>
+
+// Usages below this are error codes (ErrorRollOver, POSTFail, ErrorUndefined)
+#define FIRST_KEY_USAGE         0x04
+#define FIRST_MODIFIER_USAGE    0xE0
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static bool has_key(const uint8_t keys[KEY_EVENTS_ROLLOVER], uint8_t usage)
+{
+    for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) {
+        if (keys[i] == usage) return true;
+    }
+    return false;
+}
+
+static bool push(key_events_t* q, uint8_t usage, bool pressed)
+{
+    uint8_t head = q->head;
+    uint8_t next = (uint8_t)((head + 1) & (KEY_EVENTS_QUEUE_SIZE - 1));
+    if (next == q->tail) return false;
+
+    q->events[head].usage = usage;
+    q->events[head].pressed = pressed;
+    KEY_EVENTS_BARRIER();
+    q->head = next;
+    return true;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+void key_events_init(key_events_t* q)
+{
+    memset(q, 0, sizeof(*q));
+}
+
+void key_events_pump(key_events_t* q)
+{
+    // Key releases
+    for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) {
+        uint8_t k = q->queued_keys[i];
+        if (!k || has_key(q->held_keys, k)) continue;
+        if (!push(q, k, false)) return;
+        q->queued_keys[i] = 0;
+    }
+
+    // Modifier releases, then presses
+    for (int bit = 0; bit < 8; bit++) {
+        uint8_t mask = (uint8_t)(1u << bit);
+        if (!(q->queued_modifier & mask) || (q->held_modifier & mask)) continue;
+        if (!push(q, (uint8_t)(FIRST_MODIFIER_USAGE + bit), false)) return;
+        q->queued_modifier &= (uint8_t)~mask;
+    }
+    for (int bit = 0; bit < 8; bit++) {
+        uint8_t mask = (uint8_t)(1u << bit);
+        if ((q->queued_modifier & mask) || !(q->held_modifier & mask)) continue;
+        if (!push(q, (uint8_t)(FIRST_MODIFIER_USAGE + bit), true)) return;
+        q->queued_modifier |= mask;
+    }
+
+    // Key presses, in report order. Every release is queued by now, so
+    // there's always a free entry in queued_keys.
+    for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) {
+        uint8_t k = q->held_keys[i];
+        if (!k || has_key(q->queued_keys, k)) continue;
+        if (!push(q, k, true)) return;
+        for (int j = 0; j < KEY_EVENTS_ROLLOVER; j++) {
+            if (!q->queued_keys[j]) {
+                q->queued_keys[j] = k;
+                break;
+            }
+        }
+    }
+}
+
+void key_events_update(key_events_t* q, uint8_t modifier, const uint8_t keys[KEY_EVENTS_ROLLOVER])
+{
+    // Phantom state: too many keys for the keyboard to tell apart
+    bool rollover = true;
+    for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) {
+        if (keys[i] != 0x01) {
+            rollover = false;
+            break;
+        }
+    }
+    if (rollover) return;
+
+    q->held_modifier = modifier;
+    for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) {
+        uint8_t k = keys[i];
+        // Drop error codes and repeats so each held key appears once
+        if (k < FIRST_KEY_USAGE) k = 0;
+        for (int j = 0; j < i && k; j++) {
+            if (q->held_keys[j] == k) k = 0;
+        }
+        q->held_keys[i] = k;
+    }
+    key_events_pump(q);
+}
+
+void key_events_release_all(key_events_t* q)
+{
+    static const uint8_t none[KEY_EVENTS_ROLLOVER] = { 0 };
+    key_events_update(q, 0, none);
+}
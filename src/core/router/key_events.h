@@ -0,0 +1,112 @@
+// key_events.h - Ordered key press/release queue for keyboard outputs
+//
+// HID keyboards report level state: the modifier byte and up to six held
+// keys. Keyboard protocols (PS/2, the Amiga keyboard line, the 3DO's PS/2
+// stream) carry transitions, one at a time, at their own pace. Diffing
+// router_get_output() once per console read loses every press that came and
+// went between two reads. Here every report is diffed as it is routed and
+// each press and release is queued in order; the output drains the queue as
+// fast as its wire allows.
+//
+// Split in two halves like mouse_motion.h, so events cross from the input
+// core to the output core without locks:
+//   the input side (router, core 0) only writes `head` and the tracking state;
+//   the output side (the protocol, any core or IRQ) only writes `tail`.
+//
+// If the queue fills, nothing is dropped: `queued` lags `held` and the rest
+// of the difference is queued as room frees up (key_events_pump). Only a key
+// pressed and released entirely while the queue is full can go unseen, and
+// the output always ends with the keyboard's real state.
+//
+// No platform dependency (tools/key-events-replay builds it on the host).
+
+#ifndef KEY_EVENTS_H
+#define KEY_EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+// Events per queue, power of two
+#ifndef KEY_EVENTS_QUEUE_SIZE
+#define KEY_EVENTS_QUEUE_SIZE   64
+#endif
+
+#define KEY_EVENTS_ROLLOVER     6       // HID boot keyboard: six keys plus modifiers
+
+// One transition. Modifiers come through as their own usages (0xE0-0xE7),
+// so outputs see one kind of event.
+typedef struct {
+    uint8_t usage;              // HID Keyboard page (0x07) usage
+    bool pressed;
+} key_event_t;
+
+typedef struct {
+    key_event_t events[KEY_EVENTS_QUEUE_SIZE];
+    volatile uint8_t head;      // Written by the input side
+    volatile uint8_t tail;      // Written by the output side
+
+    // Input side only
+    uint8_t held_modifier;      // Latest report
+    uint8_t held_keys[KEY_EVENTS_ROLLOVER];
+    uint8_t queued_modifier;    // State the queued events leave the output in
+    uint8_t queued_keys[KEY_EVENTS_ROLLOVER];
+} key_events_t;
+
+void key_events_init(key_events_t* q);
+
+// ============================================================================
+// INPUT SIDE
+// ============================================================================
+
+// New keyboard report. Queues what changed since the last one, in this
+// order: key releases, modifier releases, modifier presses, key presses (so
+// Shift is down before the key it shifts and up after it). A report of all
+// ErrorRollOver (0x01) is ignored, keeping the last real state.
+void key_events_update(key_events_t* q, uint8_t modifier, const uint8_t keys[KEY_EVENTS_ROLLOVER]);
+
+// Queue whatever an earlier update couldn't fit. Call from the input side
+// now and then; cheap when there's nothing to do.
+void key_events_pump(key_events_t* q);
+
+// Release everything (keyboard unplugged)
+void key_events_release_all(key_events_t* q);
+
+// ============================================================================
+// OUTPUT SIDE
+// ============================================================================
+// Inline and call-free, so protocol code on core 1 or in an IRQ can use them
+// while flash is busy.
+
+// Orders the event data against the index that publishes or frees it
+#define KEY_EVENTS_BARRIER()    __asm__ volatile("" ::: "memory")
+
+static inline uint8_t key_events_count(const key_events_t* q)
+{
+    return (uint8_t)((q->head - q->tail) & (KEY_EVENTS_QUEUE_SIZE - 1));
+}
+
+static inline bool key_events_peek(const key_events_t* q, key_event_t* ev)
+{
+    uint8_t tail = q->tail;
+    if (tail == q->head) return false;
+    KEY_EVENTS_BARRIER();
+    *ev = q->events[tail];
+    return true;
+}
+
+static inline bool key_events_pop(key_events_t* q, key_event_t* ev)
+{
+    uint8_t tail = q->tail;
+    if (tail == q->head) return false;
+    KEY_EVENTS_BARRIER();
+    *ev = q->events[tail];
+    KEY_EVENTS_BARRIER();
+    q->tail = (uint8_t)((tail + 1) & (KEY_EVENTS_QUEUE_SIZE - 1));
+    return true;
+}
+
+#endif // KEY_EVENTS_H
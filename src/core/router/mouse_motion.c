@@ -0,0 +1,83 @@
+// mouse_motion.c - Lossless mouse motion for console mouse outputs
+
+#include "mouse_motion.h"
+
+// ============================================================================
+// TUNING
+// ============================================================================
+
+// Gap used for the speed when events arrive back to back (8 kHz mice) or
+// after a pause; beyond MAX the pointer is taken to have started from rest.
+#define MIN_EVENT_DT_US         125
+#define MAX_EVENT_DT_US         100000
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static inline int32_t abs32(int32_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+// Cheap vector length (alpha-max plus beta-min, within ~7%)
+static inline int32_t magnitude(int32_t x, int32_t y)
+{
+    int32_t ax = abs32(x), ay = abs32(y);
+    int32_t hi = ax > ay ? ax : ay;
+    int32_t lo = ax > ay ? ay : ax;
+    return hi + (lo * 3) / 8;
+}
+
+// Add to one axis, saturating pending at the cap
+static inline void add_axis(mouse_motion_accum_t* acc, int axis, int64_t v)
+{
+    if (v == 0) return;
+    int32_t pending = mouse_motion_pending(acc, axis);
+    int64_t next = pending + v;
+    if (next > MOUSE_MOTION_PENDING_MAX) next = MOUSE_MOTION_PENDING_MAX;
+    if (next < -MOUSE_MOTION_PENDING_MAX) next = -MOUSE_MOTION_PENDING_MAX;
+    acc->total[axis] += (uint32_t)((int32_t)next - pending);
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+void mouse_motion_init(mouse_motion_accum_t* acc)
+{
+    for (int a = 0; a < MOUSE_MOTION_AXES; a++) {
+        acc->total[a] = 0;
+        acc->consumed[a] = 0;
+    }
+    acc->last_us = 0;
+    acc->primed = false;
+}
+
+void mouse_motion_add(mouse_motion_accum_t* acc, const mouse_motion_config_t* cfg,
+                      int32_t dx, int32_t dy, int32_t wheel, uint32_t now_us)
+{
+    if (dx == 0 && dy == 0 && wheel == 0) return;
+
+    uint32_t dt = MAX_EVENT_DT_US;
+    if (acc->primed) {
+        dt = now_us - acc->last_us;
+        if (dt < MIN_EVENT_DT_US) dt = MIN_EVENT_DT_US;
+        if (dt > MAX_EVENT_DT_US) dt = MAX_EVENT_DT_US;
+    }
+    acc->last_us = now_us;
+    acc->primed = true;
+
+    // Gain: sens_min at rest rising linearly to sens_max at accel_cps.
+    // Integer 1/256 steps, so each event adds exactly dx * gain.
+    int32_t gain = cfg->sens_min;
+    if (cfg->accel_cps && cfg->sens_max != cfg->sens_min) {
+        int64_t speed = ((int64_t)magnitude(dx, dy) * 1000000) / dt;
+        if (speed > cfg->accel_cps) speed = cfg->accel_cps;
+        gain += (int32_t)(((int64_t)(cfg->sens_max - cfg->sens_min) * speed) / cfg->accel_cps);
+    }
+
+    add_axis(acc, MOUSE_MOTION_X, (int64_t)dx * gain);
+    add_axis(acc, MOUSE_MOTION_Y, (int64_t)dy * gain);
+    add_axis(acc, MOUSE_MOTION_WHEEL, (int64_t)wheel * MOUSE_MOTION_ONE);
+}
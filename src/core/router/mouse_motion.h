@@ -0,0 +1,102 @@
+// mouse_motion.h - Lossless mouse motion for console mouse outputs
+//
+// Console mice are read at the console's pace (a PCE scan, a Maple condition
+// request, a PBUS frame, a joybus poll) and each read can only carry so much
+// movement. USB mice report far faster than that. Keeping only the latest
+// event's delta drops most of the motion; scaling each event down on its own
+// drops every sub-count step. Here every event is scaled and added as it
+// arrives, and each console read takes whole counts up to its protocol limit,
+// leaving the rest (and the fraction) for the next read.
+//
+// Split in two halves like gyro_aim.h, so motion crosses from the input core
+// to the output core without locks:
+//   the input side (router, core 0) only ever adds to `total`;
+//   the output side (the console read, any core or IRQ) only moves
+//   `consumed`, so the two never write the same word.
+//
+// Fixed point throughout, no platform dependency (tools/mouse-motion-replay
+// builds it on the host).
+
+#ifndef MOUSE_MOTION_H
+#define MOUSE_MOTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+// Motion is kept in 1/256 counts
+#define MOUSE_MOTION_ONE        256
+
+typedef enum {
+    MOUSE_MOTION_X = 0,
+    MOUSE_MOTION_Y,
+    MOUSE_MOTION_WHEEL,
+    MOUSE_MOTION_AXES,
+} mouse_motion_axis_t;
+
+// Per output. Gains are in 1/256 (256 = 1.0x): sens_min at rest, rising
+// linearly with pointer speed to sens_max at accel_cps counts per second.
+// accel_cps 0 = flat sens_min. The wheel is never scaled.
+typedef struct {
+    uint16_t sens_min;
+    uint16_t sens_max;
+    uint16_t accel_cps;
+} mouse_motion_config_t;
+
+// Most motion an accumulator holds for an output that isn't reading it, so a
+// console that stops polling doesn't fling the pointer when it comes back
+#define MOUSE_MOTION_PENDING_MAX    (4096 * MOUSE_MOTION_ONE)
+
+typedef struct {
+    volatile uint32_t total[MOUSE_MOTION_AXES];    // Added by the input side, 1/256 counts (wraps)
+    uint32_t consumed[MOUSE_MOTION_AXES];          // Taken by the output side (wraps)
+    uint32_t last_us;           // Input side: previous event, for the speed
+    bool primed;                // Input side: last_us is valid
+} mouse_motion_accum_t;
+
+void mouse_motion_init(mouse_motion_accum_t* acc);
+
+// ============================================================================
+// INPUT SIDE
+// ============================================================================
+
+// Scale one event's deltas by the output's curve and add them. Deltas are
+// HID counts (x right, y down, wheel up).
+void mouse_motion_add(mouse_motion_accum_t* acc, const mouse_motion_config_t* cfg,
+                      int32_t dx, int32_t dy, int32_t wheel, uint32_t now_us);
+
+// ============================================================================
+// OUTPUT SIDE
+// ============================================================================
+// Inline and call-free, so console reads on core 1 or in an IRQ can use them
+// while flash is busy.
+
+// Motion not yet taken, 1/256 counts
+static inline int32_t mouse_motion_pending(const mouse_motion_accum_t* acc, int axis)
+{
+    return (int32_t)(acc->total[axis] - acc->consumed[axis]);
+}
+
+// One console read: whole counts of `axis`, at most ±limit. Whatever doesn't
+// fit, and the fraction, stays for the next read.
+static inline int32_t mouse_motion_take(mouse_motion_accum_t* acc, int axis, int32_t limit)
+{
+    int32_t counts = mouse_motion_pending(acc, axis) / MOUSE_MOTION_ONE;
+    if (counts > limit) counts = limit;
+    if (counts < -limit) counts = -limit;
+    acc->consumed[axis] += (uint32_t)(counts * MOUSE_MOTION_ONE);
+    return counts;
+}
+
+// Drop anything pending (mouse unplugged, slot changed device type)
+static inline void mouse_motion_discard(mouse_motion_accum_t* acc)
+{
+    for (int a = 0; a < MOUSE_MOTION_AXES; a++) {
+        acc->consumed[a] = acc->total[a];
+    }
+}
+
+#endif // MOUSE_MOTION_H
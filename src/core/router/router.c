@@ -5,6 +5,9 @@
 // Replaces console-specific post_input_event() with unified routing.
 
 #include "router.h"
+#include "gyro_aim.h"
+#include "mouse_motion.h"
+#include "key_events.h"
 #include "core/buttons.h"
 #include "core/services/storage/flash.h"
 #include "core/services/profiles/profile.h"
@@ -333,6 +336,8 @@ void router_get_motion_remap(int out[3]) {
     for (int i = 0; i < 3; i++) out[i] = motion_remap[i];
 }
 
+static void gyro_aim_onboard_sample(const int16_t gyro[3], uint16_t gyro_range, uint32_t t_us);
+
 static inline int16_t remap_one(const int16_t v[3], int8_t m) {
     int idx = (m < 0 ? -m : m) - 1;
     int16_t val = v[idx];
@@ -342,9 +347,23 @@ static inline int16_t remap_one(const int16_t v[3], int8_t m) {
 
 void router_set_onboard_motion(const int16_t accel[3], const int16_t gyro[3],
                                uint16_t accel_range, uint16_t gyro_range) {
+    onboard_motion_sample_t s;
     for (int i = 0; i < 3; i++) {
-        onboard_motion.accel[i] = remap_one(accel, motion_remap[i]);
-        onboard_motion.gyro[i]  = remap_one(gyro,  motion_remap[i]);
+        s.accel[i] = accel[i];
+        s.gyro[i] = gyro[i];
+    }
+    s.t_us = platform_time_us();
+    router_set_onboard_motion_batch(&s, 1, accel_range, gyro_range);
+}
+
+void router_set_onboard_motion_batch(const onboard_motion_sample_t* samples, uint16_t count,
+                                     uint16_t accel_range, uint16_t gyro_range) {
+    for (uint16_t n = 0; n < count; n++) {
+        for (int i = 0; i < 3; i++) {
+            onboard_motion.accel[i] = remap_one(samples[n].accel, motion_remap[i]);
+            onboard_motion.gyro[i]  = remap_one(samples[n].gyro,  motion_remap[i]);
+        }
+        gyro_aim_onboard_sample(onboard_motion.gyro, gyro_range, samples[n].t_us);
     }
     onboard_motion.accel_range = accel_range;
     onboard_motion.gyro_range = gyro_range;
@@ -360,6 +379,287 @@ bool router_onboard_motion_get(int16_t accel[3], int16_t gyro[3]) {
     return true;
 }
 
+// ============================================================================
+// GYRO AIM
+// ============================================================================
+
+// Rotation → right stick / mouse for outputs without motion (gyro_aim.h). The
+// input side (router_submit_input, core 0) integrates every IMU sample per
+// source device and adds the aim of the event being routed to each output
+// player it lands on. The output side drains it when a report is built:
+// router_get_output() for polled outputs, router_gyro_aim_apply() for outputs
+// that coalesce tap events.
+#ifndef ROUTER_GYRO_AIM_PLAYERS
+#define ROUTER_GYRO_AIM_PLAYERS 4
+#endif
+#define GYRO_AIM_SOURCES 4
+
+static struct {
+    bool used;
+    uint8_t dev_addr;
+    int8_t instance;
+    gyro_aim_source_t src;
+} gyro_sources[GYRO_AIM_SOURCES];
+
+static gyro_aim_accum_t gyro_accums[MAX_OUTPUTS][ROUTER_GYRO_AIM_PLAYERS];
+static gyro_aim_config_t gyro_cfg;          // From the active custom profile
+
+// Onboard IMU: samples arrive via router_set_onboard_motion(), not on events,
+// so their aim waits here until the next motion-less event carries it out.
+// Activation follows that device's own buttons, from the latest event.
+static gyro_aim_source_t gyro_onboard;
+static int32_t gyro_onboard_pending[2];
+static bool gyro_onboard_active = false;
+
+// Aim of the event currently being routed
+static int32_t gyro_event_aim[2];
+static bool gyro_event_has_aim = false;
+
+static void gyro_aim_load_config(const custom_profile_t* cp) {
+    if (!cp || cp->gyro_mode == GYRO_AIM_OFF || cp->gyro_mode > GYRO_AIM_MOUSE) {
+        gyro_cfg.mode = GYRO_AIM_OFF;
+        return;
+    }
+    gyro_cfg.sens_min = cp->gyro_sens_min ? cp->gyro_sens_min : 10;
+    gyro_cfg.sens_max = cp->gyro_sens_max ? cp->gyro_sens_max : gyro_cfg.sens_min;
+    gyro_cfg.accel_dps = cp->gyro_accel_dps;
+    gyro_cfg.deadzone = cp->gyro_deadzone;
+    gyro_cfg.stick_min = cp->gyro_stick_min > 127 ? 127 : cp->gyro_stick_min;
+    gyro_cfg.flags = cp->gyro_flags;
+    gyro_cfg.mode = cp->gyro_mode;
+}
+
+static gyro_aim_source_t* gyro_find_source(uint8_t dev_addr, int8_t instance) {
+    int free_slot = -1;
+    for (int i = 0; i < GYRO_AIM_SOURCES; i++) {
+        if (gyro_sources[i].used) {
+            if (gyro_sources[i].dev_addr == dev_addr && gyro_sources[i].instance == instance) {
+                return &gyro_sources[i].src;
+            }
+        } else if (free_slot < 0) {
+            free_slot = i;
+        }
+    }
+    if (free_slot < 0) return NULL;
+
+    gyro_sources[free_slot].used = true;
+    gyro_sources[free_slot].dev_addr = dev_addr;
+    gyro_sources[free_slot].instance = instance;
+    gyro_aim_source_init(&gyro_sources[free_slot].src);
+    return &gyro_sources[free_slot].src;
+}
+
+// Timed by the gap to the previous sample's t_us (sensor time for FIFO
+// batches, arrival time for single samples).
+static void gyro_aim_onboard_sample(const int16_t gyro[3], uint16_t gyro_range, uint32_t t_us) {
+    if (gyro_cfg.mode == GYRO_AIM_OFF) return;
+
+    int32_t aim[2];
+    if (gyro_aim_sample(&gyro_onboard, &gyro_cfg, gyro, gyro_range, 0,
+                        t_us, gyro_onboard_active, aim)) {
+        gyro_onboard_pending[0] += aim[0];
+        gyro_onboard_pending[1] += aim[1];
+    }
+}
+
+// Input side: integrate this event's sample (or pick up the onboard IMU's)
+// and note its aim for the route stage. `buttons` is the physical button
+// state, before any remap, so the activation button can be remapped or
+// disabled in the profile without losing its gyro role.
+static void gyro_aim_input(const input_event_t* event, uint32_t buttons,
+                           const custom_profile_t* cp) {
+    gyro_event_has_aim = false;
+    gyro_aim_load_config(cp);
+    if (gyro_cfg.mode == GYRO_AIM_OFF) return;
+
+    bool held = cp->gyro_button >= 1 && cp->gyro_button <= BUTTON_MAP_MAX_TARGET &&
+                (buttons & (1u << (cp->gyro_button - 1)));
+
+    if (event->has_motion) {
+        if (event->motion_dt_us == MOTION_DT_REPEAT) return;
+        gyro_aim_source_t* src = gyro_find_source(event->dev_addr, event->instance);
+        if (!src) return;
+        bool active = gyro_aim_active(src, cp->gyro_activation, held);
+        gyro_event_has_aim = gyro_aim_sample(src, &gyro_cfg, event->gyro, event->gyro_range,
+                                             event->motion_dt_us, platform_time_us(),
+                                             active, gyro_event_aim);
+    } else if (onboard_motion.valid) {
+        gyro_onboard_active = gyro_aim_active(&gyro_onboard, cp->gyro_activation, held);
+        if (gyro_onboard_pending[0] || gyro_onboard_pending[1]) {
+            gyro_event_aim[0] = gyro_onboard_pending[0];
+            gyro_event_aim[1] = gyro_onboard_pending[1];
+            gyro_onboard_pending[0] = gyro_onboard_pending[1] = 0;
+            gyro_event_has_aim = true;
+        }
+    }
+}
+
+// Route stage: the event just landed on output/player
+static inline void gyro_aim_route(output_target_t output, int player_index) {
+    if (!gyro_event_has_aim) return;
+    if (player_index < 0 || player_index >= ROUTER_GYRO_AIM_PLAYERS) return;
+    gyro_aim_accum_add(&gyro_accums[output][player_index], gyro_event_aim);
+}
+
+// Runs from RAM (the drains are inline) since router_get_output() calls it
+// from core 1 and IRQ outputs
+void __not_in_flash_func(router_gyro_aim_apply)(output_target_t output, uint8_t player_id, input_event_t* event) {
+    if (output < 0 || output >= MAX_OUTPUTS || player_id >= ROUTER_GYRO_AIM_PLAYERS) return;
+    gyro_aim_accum_t* acc = &gyro_accums[output][player_id];
+
+    switch (gyro_cfg.mode) {
+        case GYRO_AIM_STICK:
+            gyro_aim_drain_stick(acc, &gyro_cfg, platform_time_us(),
+                                 &event->analog[ANALOG_RX], &event->analog[ANALOG_RY]);
+            break;
+        case GYRO_AIM_MOUSE:
+            gyro_aim_drain_mouse(acc, &event->delta_x, &event->delta_y);
+            break;
+        default:
+            // Off: nothing to do unless aim was left over from before
+            if (!acc->primed && !gyro_aim_accum_pending(acc, 0) && !gyro_aim_accum_pending(acc, 1)) {
+                return;
+            }
+            gyro_aim_drain_discard(acc);
+            break;
+    }
+}
+
+// ============================================================================
+// MOUSE MOTION
+// ============================================================================
+
+// Console mouse outputs (mouse_motion.h). An output that opts in gets every
+// routed event's deltas added as the event lands on a player; its console
+// reads take from the accumulator instead of the delta in router_get_output().
+// Slots are claimed by the output's init, which runs before router_init(), so
+// router_init() leaves them alone.
+#ifndef ROUTER_MOUSE_MOTION_OUTPUTS
+#define ROUTER_MOUSE_MOTION_OUTPUTS 2
+#endif
+
+static struct {
+    mouse_motion_config_t cfg;
+    mouse_motion_accum_t acc[MAX_PLAYERS_PER_OUTPUT];
+} mouse_motion_slots[ROUTER_MOUSE_MOTION_OUTPUTS];
+static uint8_t mouse_motion_slot_count = 0;
+static uint8_t mouse_motion_slot_of[MAX_OUTPUTS];  // Slot + 1, 0 = not enabled
+
+bool router_mouse_motion_enable(output_target_t output, const mouse_motion_config_t* cfg) {
+    if (output < 0 || output >= MAX_OUTPUTS || !cfg) return false;
+
+    int slot = mouse_motion_slot_of[output] - 1;
+    if (slot < 0) {
+        if (mouse_motion_slot_count >= ROUTER_MOUSE_MOTION_OUTPUTS) {
+            printf(LOG_TAG "No mouse motion slot left for output %d\n", output);
+            return false;
+        }
+        slot = mouse_motion_slot_count++;
+        for (uint8_t player = 0; player < MAX_PLAYERS_PER_OUTPUT; player++) {
+            mouse_motion_init(&mouse_motion_slots[slot].acc[player]);
+        }
+    }
+    mouse_motion_slots[slot].cfg = *cfg;
+    mouse_motion_slot_of[output] = (uint8_t)(slot + 1);
+    return true;
+}
+
+mouse_motion_accum_t* router_mouse_motion_get(output_target_t output, uint8_t player_id) {
+    if (output < 0 || output >= MAX_OUTPUTS || player_id >= MAX_PLAYERS_PER_OUTPUT) return NULL;
+    if (!mouse_motion_slot_of[output]) return NULL;
+    return &mouse_motion_slots[mouse_motion_slot_of[output] - 1].acc[player_id];
+}
+
+// Route stage: the event just landed on output/player
+static inline void mouse_motion_route(output_target_t output, int player_index,
+                                      const input_event_t* event) {
+    if (!mouse_motion_slot_of[output]) return;
+    if (!event->delta_x && !event->delta_y && !event->delta_wheel) return;
+    if (player_index < 0 || player_index >= MAX_PLAYERS_PER_OUTPUT) return;
+
+    int slot = mouse_motion_slot_of[output] - 1;
+    mouse_motion_add(&mouse_motion_slots[slot].acc[player_index], &mouse_motion_slots[slot].cfg,
+                     event->delta_x, event->delta_y, event->delta_wheel, platform_time_us());
+}
+
+// ============================================================================
+// KEY EVENTS
+// ============================================================================
+
+// Keyboard protocol outputs (key_events.h). An output that opts in gets every
+// routed keyboard report diffed into an ordered press/release queue per
+// player, so transitions between two protocol reads aren't lost. Claimed from
+// the output's init, like the mouse motion slots.
+#ifndef ROUTER_KEY_EVENTS_OUTPUTS
+#define ROUTER_KEY_EVENTS_OUTPUTS 2
+#endif
+
+static struct {
+    key_events_t queue[MAX_PLAYERS_PER_OUTPUT];
+    uint8_t dev_addr[MAX_PLAYERS_PER_OUTPUT];   // Keyboard feeding each queue
+    int8_t instance[MAX_PLAYERS_PER_OUTPUT];
+} key_events_slots[ROUTER_KEY_EVENTS_OUTPUTS];
+static uint8_t key_events_slot_count = 0;
+static uint8_t key_events_slot_of[MAX_OUTPUTS];    // Slot + 1, 0 = not enabled
+
+bool router_key_events_enable(output_target_t output) {
+    if (output < 0 || output >= MAX_OUTPUTS) return false;
+    if (key_events_slot_of[output]) return true;
+
+    if (key_events_slot_count >= ROUTER_KEY_EVENTS_OUTPUTS) {
+        printf(LOG_TAG "No key event slot left for output %d\n", output);
+        return false;
+    }
+    int slot = key_events_slot_count++;
+    for (uint8_t player = 0; player < MAX_PLAYERS_PER_OUTPUT; player++) {
+        key_events_init(&key_events_slots[slot].queue[player]);
+        key_events_slots[slot].instance[player] = -1;
+    }
+    key_events_slot_of[output] = (uint8_t)(slot + 1);
+    return true;
+}
+
+key_events_t* router_key_events_get(output_target_t output, uint8_t player_id) {
+    if (output < 0 || output >= MAX_OUTPUTS || player_id >= MAX_PLAYERS_PER_OUTPUT) return NULL;
+    if (!key_events_slot_of[output]) return NULL;
+    return &key_events_slots[key_events_slot_of[output] - 1].queue[player_id];
+}
+
+void router_key_events_pump(output_target_t output) {
+    if (output < 0 || output >= MAX_OUTPUTS || !key_events_slot_of[output]) return;
+    int slot = key_events_slot_of[output] - 1;
+    for (uint8_t player = 0; player < MAX_PLAYERS_PER_OUTPUT; player++) {
+        key_events_pump(&key_events_slots[slot].queue[player]);
+    }
+}
+
+// Route stage: the event just landed on output/player
+static inline void key_events_route(output_target_t output, int player_index,
+                                    const input_event_t* event) {
+    if (!key_events_slot_of[output]) return;
+    if (event->type != INPUT_TYPE_KEYBOARD) return;
+    if (player_index < 0 || player_index >= MAX_PLAYERS_PER_OUTPUT) return;
+
+    int slot = key_events_slot_of[output] - 1;
+    key_events_slots[slot].dev_addr[player_index] = event->dev_addr;
+    key_events_slots[slot].instance[player_index] = event->instance;
+    key_events_update(&key_events_slots[slot].queue[player_index],
+                      event->kb_modifier, event->kb_keys);
+}
+
+// Keyboard unplugged: let go of whatever it was holding
+static void key_events_disconnected(uint8_t dev_addr, int8_t instance) {
+    for (int slot = 0; slot < key_events_slot_count; slot++) {
+        for (uint8_t player = 0; player < MAX_PLAYERS_PER_OUTPUT; player++) {
+            if (key_events_slots[slot].dev_addr[player] == dev_addr &&
+                key_events_slots[slot].instance[player] == instance) {
+                key_events_release_all(&key_events_slots[slot].queue[player]);
+                key_events_slots[slot].instance[player] = -1;
+            }
+        }
+    }
+}
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -415,6 +715,17 @@ void router_init(const router_config_t* config) {
         }
     }
 
+    // Initialize gyro aim
+    for (uint8_t output = 0; output < MAX_OUTPUTS; output++) {
+        for (uint8_t player = 0; player < ROUTER_GYRO_AIM_PLAYERS; player++) {
+            gyro_aim_accum_init(&gyro_accums[output][player]);
+        }
+    }
+    for (int i = 0; i < GYRO_AIM_SOURCES; i++) {
+        gyro_sources[i].used = false;
+    }
+    gyro_aim_source_init(&gyro_onboard);
+
     // Initialize routing table
     router_clear_routes();
 
@@ -673,6 +984,10 @@ static inline void router_simple_mode(const input_event_t* event, output_target_
     }
 
     if (player_index >= 0 && player_index < router_config.max_players_per_output[output]) {
+        gyro_aim_route(output, player_index);
+        mouse_motion_route(output, player_index, event);
+        key_events_route(output, player_index, event);
+
         // Avoid struct copy when no transformations are active (common case)
         const input_event_t* final_event;
         input_event_t transformed;
@@ -849,6 +1164,13 @@ static inline void router_merge_mode(const input_event_t* event, output_target_t
                         x_current_state.touch[1] = dev->touch[1];
                     }
 
+                    // Pointer: use first device that is on screen
+                    if (dev->has_pointer && !x_current_state.has_pointer) {
+                        x_current_state.has_pointer = true;
+                        x_current_state.pointer_x = dev->pointer_x;
+                        x_current_state.pointer_y = dev->pointer_y;
+                    }
+
                     // Battery: use first device that reports battery
                     if (dev->battery_level > 0 && x_current_state.battery_level == 0) {
                         x_current_state.battery_level = dev->battery_level;
@@ -896,6 +1218,9 @@ static inline void router_merge_mode(const input_event_t* event, output_target_t
             break;
     }
 
+    gyro_aim_route(output, 0);
+    mouse_motion_route(output, 0, event);
+    key_events_route(output, 0, event);
     router_outputs[output][0].updated = true;
     router_outputs[output][0].source = INPUT_SOURCE_USB_HOST;
 
@@ -930,6 +1255,10 @@ void router_submit_input(const input_event_t* event) {
     if (!event) return;
     if (route_count == 0) return;
 
+    // Input can arrive from another task (BTstack on ESP32); let an
+    // event-driven main loop service the outputs now rather than next tick
+    platform_loop_wake();
+
     // Track activity for idle-sleep: any button, or a stick off-center.
     if (event->buttons != 0) {
         s_last_activity_ms = platform_time_ms();
@@ -989,6 +1318,10 @@ void router_submit_input(const input_event_t* event) {
     static input_event_t remapped;
     bool did_remap = false;
 
+    // Physical buttons, before injection and remap (gyro aim activation)
+    uint32_t physical_buttons = event->buttons;
+    const custom_profile_t* active_cp = flash_get_active_custom_profile();
+
     // Host-side synthetic button overlay (INPUT.INJECT) — OR'd into the
     // real event so chat-driven button presses merge with the streamer's
     // controller regardless of routing mode (works on SIMPLE, MERGE,
@@ -1003,7 +1336,7 @@ void router_submit_input(const input_event_t* event) {
     // Apply custom profile (button remap, stick sens, SOCD, flags, thresholds).
     // Done here in the router so it applies uniformly to ALL output interfaces.
     {
-        const custom_profile_t* cp = flash_get_active_custom_profile();
+        const custom_profile_t* cp = active_cp;
         if (cp) {
             remapped = *event;
 
@@ -1268,6 +1601,10 @@ void router_submit_input(const input_event_t* event) {
         event = &remapped;
     }
 
+    // Gyro aim: integrate this event's IMU sample now, as it arrives; the
+    // route stage below hands its aim to every output player it reaches
+    gyro_aim_input(event, physical_buttons, active_cp);
+
     // Find first active route to determine output target
     output_target_t output = OUTPUT_TARGET_USB_DEVICE;
     for (uint8_t i = 0; i < MAX_ROUTES; i++) {
@@ -1327,6 +1664,10 @@ void router_submit_input(const input_event_t* event) {
                             const input_event_t* final_event;
                             input_event_t transformed;
 
+                            gyro_aim_route(target, target_player);
+                            mouse_motion_route(target, target_player, event);
+                            key_events_route(target, target_player, event);
+
                             if (router_config.transform_flags) {
                                 transformed = *event;
                                 apply_transformations(&transformed, target, target_player);
@@ -1375,6 +1716,9 @@ const input_event_t* __not_in_flash_func(router_get_output)(output_target_t outp
         // Clear deltas from original (they've been consumed)
         router_outputs[output][player_id].current_state.delta_x = 0;
         router_outputs[output][player_id].current_state.delta_y = 0;
+
+        // Report time: hand out the gyro aim integrated since the last read
+        router_gyro_aim_apply(output, player_id, &router_output_copy[output][player_id]);
         
         return &router_output_copy[output][player_id];
     }
@@ -1513,6 +1857,16 @@ void router_device_disconnected(uint8_t dev_addr, int8_t instance) {
         }
     }
 
+    key_events_disconnected(dev_addr, instance);
+
+    // Forget its gyro calibration
+    for (int i = 0; i < GYRO_AIM_SOURCES; i++) {
+        if (gyro_sources[i].used && gyro_sources[i].dev_addr == dev_addr &&
+            gyro_sources[i].instance == instance) {
+            gyro_sources[i].used = false;
+        }
+    }
+
     // Clear blend device tracking for this device (MERGE_BLEND mode)
     for (uint8_t out = 0; out < MAX_OUTPUTS; out++) {
         for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
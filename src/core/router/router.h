@@ -10,6 +10,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "core/input_event.h"
+#include "core/router/mouse_motion.h"
+#include "core/router/key_events.h"
 
 // ============================================================================
 // ROUTING MODES
@@ -71,6 +73,10 @@ typedef enum {
     OUTPUT_TARGET_UART,             // UART bridge to ESP32/other MCU
     OUTPUT_TARGET_WII_EXTENSION,              // Wii extension I2C slave (bt2wiiex apps)
     OUTPUT_TARGET_AMIGA,
+    OUTPUT_TARGET_JVS,              // JVS I/O board toward an arcade mainboard
+    OUTPUT_TARGET_PS2,              // PS/2 keyboard toward a PC or PS/2-port machine
+    OUTPUT_TARGET_AMIGA_KB,         // Amiga keyboard line (KCLK/KDAT)
+    OUTPUT_TARGET_JOCP,             // JOCP over WiFi toward a Joypad dongle
     OUTPUT_TARGET_COUNT             // Must be last — used to size arrays
 } output_target_t;
 
@@ -164,6 +170,19 @@ bool router_onboard_battery_charging(void);
 void router_set_onboard_motion(const int16_t accel[3], const int16_t gyro[3],
                                uint16_t accel_range, uint16_t gyro_range);
 
+// One onboard IMU sample and when the sensor took it (platform_time_us base)
+typedef struct {
+    int16_t accel[3];
+    int16_t gyro[3];
+    uint32_t t_us;
+} onboard_motion_sample_t;
+
+// Batched form for an IMU drained from its FIFO: every sample goes to gyro
+// aim at its own timestamp, none are dropped, and the newest becomes the
+// current onboard motion. Samples oldest first.
+void router_set_onboard_motion_batch(const onboard_motion_sample_t* samples, uint16_t count,
+                                     uint16_t accel_range, uint16_t gyro_range);
+
 // Read back the current onboard motion (for diagnostics). Returns false if no
 // onboard IMU has reported yet.
 bool router_onboard_motion_get(int16_t accel[3], int16_t gyro[3]);
@@ -176,6 +195,35 @@ bool router_onboard_motion_get(int16_t accel[3], int16_t gyro[3]);
 void router_set_motion_remap(int x, int y, int z);
 void router_get_motion_remap(int out[3]);
 
+// Gyro aim (core/router/gyro_aim.h): rotation from a motion controller or the
+// onboard IMU, driven by the active custom profile's gyro_* fields, turned into
+// right-stick deflection or mouse deltas for outputs that carry no motion.
+// Every sample is integrated as it arrives; the rotation is handed out when
+// the output builds its report. router_get_output() does this itself;
+// outputs that coalesce tap events (usbd) call router_gyro_aim_apply() on the
+// event they are about to send.
+void router_gyro_aim_apply(output_target_t output, uint8_t player_id, input_event_t* event);
+
+// Mouse motion (core/router/mouse_motion.h): lossless mouse deltas for console
+// mouse outputs. router_mouse_motion_enable() (from the output's init) makes
+// the router scale and add every event's deltas to a per-player accumulator
+// as they are routed; the output's console read takes from the accumulator
+// returned by router_mouse_motion_get(), which stays valid for the lifetime
+// of the firmware. Returns false if no slot is left.
+bool router_mouse_motion_enable(output_target_t output, const mouse_motion_config_t* cfg);
+mouse_motion_accum_t* router_mouse_motion_get(output_target_t output, uint8_t player_id);
+
+// Key events (core/router/key_events.h): ordered press/release queues for
+// keyboard protocol outputs. router_key_events_enable() (from the output's
+// init) makes the router diff every keyboard report into the player's queue
+// as it is routed (merge mode: every keyboard feeds player 0 and the latest
+// report wins); the output pops transitions from the queue returned by
+// router_key_events_get() at its own pace. router_key_events_pump() queues
+// anything a full queue held back; call it from the output's core 0 task.
+bool router_key_events_enable(output_target_t output);
+key_events_t* router_key_events_get(output_target_t output, uint8_t player_id);
+void router_key_events_pump(output_target_t output);
+
 // Host-side synthetic input "press overlay" — buttons set via INPUT.INJECT
 // are OR'd into every real input event as it passes through the router.
 // Works in any routing mode (SIMPLE, MERGE, BROADCAST). Pass 0 to release.
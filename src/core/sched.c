@@ -0,0 +1,164 @@
+// sched.c
+// Budgeted cooperative scheduler for the Core 0 main loop.
+
+#include "core/sched.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+// Sorted by class, then priority (insertion order breaks ties)
+static sched_task_t tasks[SCHED_MAX_TASKS];
+static uint8_t task_count = 0;
+
+static sched_stats_t stats;
+static uint32_t last_hot_us = 0;
+static bool hot_ran = false;
+
+bool sched_add(const sched_task_t* task)
+{
+    if (task_count >= SCHED_MAX_TASKS || (!task->run && !task->step)) return false;
+
+    uint8_t pos = task_count;
+    while (pos > 0 && (tasks[pos - 1].cls > task->cls ||
+                       (tasks[pos - 1].cls == task->cls &&
+                        tasks[pos - 1].priority > task->priority))) {
+        tasks[pos] = tasks[pos - 1];
+        pos--;
+    }
+
+    tasks[pos] = *task;
+    tasks[pos].next_due_us = time_us_32();
+    tasks[pos].deferred = 0;
+    memset(&tasks[pos].stats, 0, sizeof(tasks[pos].stats));
+    task_count++;
+    return true;
+}
+
+static inline bool is_due(const sched_task_t* t, uint32_t now)
+{
+    return t->period_us == 0 || (int32_t)(now - t->next_due_us) >= 0;
+}
+
+static void __not_in_flash_func(record)(sched_task_t* t, uint32_t elapsed)
+{
+    t->stats.runs++;
+    t->stats.total_us += elapsed;
+    if (elapsed > t->stats.max_us) t->stats.max_us = elapsed;
+    if (t->budget_us && elapsed > t->budget_us) t->stats.overruns++;
+}
+
+// Run one task (all steps that fit). Returns true if a step task still has
+// work left.
+static bool __not_in_flash_func(run_task)(sched_task_t* t, uint32_t pass_start)
+{
+    uint32_t start = time_us_32();
+    bool more = false;
+
+    if (t->step) {
+        do {
+            more = t->step();
+        } while (more && t->budget_us &&
+                 time_us_32() - start < t->budget_us &&
+                 time_us_32() - pass_start < SCHED_PASS_BUDGET_US);
+    } else {
+        t->run();
+    }
+
+    record(t, time_us_32() - start);
+    return more;
+}
+
+static void __not_in_flash_func(schedule_next)(sched_task_t* t, uint32_t now, bool more)
+{
+    if (more || t->period_us == 0) {
+        t->next_due_us = now;
+        return;
+    }
+    t->next_due_us += t->period_us;
+    // Fell more than a period behind: don't burst to catch up
+    if ((int32_t)(now - t->next_due_us) >= (int32_t)t->period_us) {
+        t->next_due_us = now + t->period_us;
+    }
+}
+
+void __not_in_flash_func(sched_run_pass)(void)
+{
+    uint32_t now = time_us_32();
+    uint8_t i = 0;
+
+    // Hot path: input → router → output, every pass
+    if (hot_ran) {
+        uint32_t gap = now - last_hot_us;
+        stats.hot_gap_total_us += gap;
+        if (gap > stats.hot_gap_max_us) stats.hot_gap_max_us = gap;
+    }
+    last_hot_us = now;
+    hot_ran = true;
+
+    for (; i < task_count && tasks[i].cls == SCHED_HOT; i++) {
+        sched_task_t* t = &tasks[i];
+        if (!is_due(t, now)) continue;
+        bool more = run_task(t, now);
+        schedule_next(t, time_us_32(), more);
+    }
+
+    // Everything else, while the pass budget lasts. Past the budget, the
+    // task that has waited longest still runs once it has waited
+    // SCHED_MAX_DEFERRALS passes (earliest in table order on a tie), so
+    // tasks that keep coming due early in the table can't starve later ones.
+    uint32_t pass_start = time_us_32();
+    sched_task_t* starved = NULL;
+    for (; i < task_count; i++) {
+        sched_task_t* t = &tasks[i];
+        now = time_us_32();
+        if (!is_due(t, now)) continue;
+
+        if (now - pass_start >= SCHED_PASS_BUDGET_US) {
+            if (t->deferred >= SCHED_MAX_DEFERRALS &&
+                (!starved || t->deferred > starved->deferred)) {
+                sched_task_t* swap = starved;
+                starved = t;
+                t = swap;
+                if (!t) continue;
+            }
+            t->deferred++;
+            t->stats.deferrals++;
+            continue;
+        }
+
+        t->deferred = 0;
+        bool more = run_task(t, pass_start);
+        schedule_next(t, time_us_32(), more);
+    }
+
+    if (starved) {
+        starved->deferred = 0;
+        bool more = run_task(starved, pass_start);
+        schedule_next(starved, time_us_32(), more);
+    }
+
+    stats.passes++;
+}
+
+uint8_t sched_task_count(void)
+{
+    return task_count;
+}
+
+const sched_task_t* sched_get_task(uint8_t index)
+{
+    return index < task_count ? &tasks[index] : NULL;
+}
+
+void sched_get_stats(sched_stats_t* out)
+{
+    *out = stats;
+}
+
+void sched_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    hot_ran = false;
+    for (uint8_t i = 0; i < task_count; i++) {
+        memset(&tasks[i].stats, 0, sizeof(tasks[i].stats));
+    }
+}
@@ -0,0 +1,74 @@
+// sched.h
+// Budgeted cooperative scheduler for the Core 0 main loop (RP2040/RP2350).
+//
+// Every pass runs the hot class first (input → router → output), then as
+// many due normal/background tasks as fit in SCHED_PASS_BUDGET_US, in
+// class then priority order. Once the budget is spent, one task per pass
+// still runs: the one deferred longest, once that is SCHED_MAX_DEFERRALS
+// passes in a row, so nothing starves. The gap between two hot-path runs
+// is therefore bounded by the hot path, the pass budget and two of the
+// longest non-hot tasks (one that straddles the budget, one forced).
+//
+// Long work can be split into steps: a step task's step() does one bounded
+// piece and returns true while more remains. The scheduler keeps calling
+// it until its own budget or the pass budget is spent, and resumes it on
+// the next pass.
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHED_MAX_TASKS         24
+#define SCHED_PASS_BUDGET_US    500     // Non-hot work per pass
+#define SCHED_MAX_DEFERRALS     4       // Passes a due task may wait for budget
+
+typedef enum {
+    SCHED_HOT = 0,          // Every pass, before anything else
+    SCHED_NORMAL,           // Due tasks, within the pass budget
+    SCHED_BACKGROUND,       // Same, after all normal tasks
+} sched_class_t;
+
+typedef struct {
+    uint32_t runs;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t overruns;      // Runs longer than budget_us
+    uint32_t deferrals;     // Passes it was due but the budget was spent
+} sched_task_stats_t;
+
+typedef struct {
+    const char*   name;
+    void          (*run)(void);     // One-shot task, or NULL
+    bool          (*step)(void);    // Split-phase task: true while more remains
+    sched_class_t cls;
+    uint8_t       priority;         // Lower runs first within the class
+    uint32_t      period_us;        // 0 = every pass
+    uint32_t      budget_us;        // 0 = unbudgeted: no overruns, one step per pass
+
+    // Scheduler state
+    uint32_t           next_due_us;
+    uint8_t            deferred;    // Consecutive deferrals
+    sched_task_stats_t stats;
+} sched_task_t;
+
+typedef struct {
+    uint32_t passes;
+    uint32_t hot_gap_max_us;        // Worst time between hot-path runs
+    uint64_t hot_gap_total_us;
+} sched_stats_t;
+
+// Register a task (copied). Returns false when the table is full.
+bool sched_add(const sched_task_t* task);
+
+// Run one scheduler pass
+void sched_run_pass(void);
+
+// Introspection (CDC SCHED.STATS)
+uint8_t sched_task_count(void);
+const sched_task_t* sched_get_task(uint8_t index);
+void sched_get_stats(sched_stats_t* out);
+void sched_reset_stats(void);
+
+#endif // SCHED_H
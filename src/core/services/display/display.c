@@ -4,6 +4,7 @@
 
 #include "display.h"
 #include "display_transport.h"
+#include "core/core1_jobs.h"
 #include "platform/platform.h"
 #include <string.h>
 #include <stdio.h>
@@ -391,10 +392,7 @@ bool display_flush_step(void) {
     }
 }
 
-void display_flush(void) {
-    if (!initialized) return;
-    dirty = false;
-
+static void flush_buffer(uint8_t fb[][DISPLAY_WIDTH]) {
     if (rotated_panel) {
         // SH1107: native 64x128 panel rotated 90° to landscape 128x64.
         // Memory: 16 pages (8px each along 128-pixel axis) × 64 columns.
@@ -413,7 +411,7 @@ void display_flush(void) {
                 uint8_t fb_bit = y % 8;
                 for (uint8_t bit = 0; bit < 8; bit++) {
                     uint8_t x = page * 8 + bit;
-                    if (x < DISPLAY_WIDTH && (framebuffer[fb_page][x] & (1 << fb_bit))) {
+                    if (x < DISPLAY_WIDTH && (fb[fb_page][x] & (1 << fb_bit))) {
                         byte |= (1 << bit);
                     }
                 }
@@ -427,18 +425,73 @@ void display_flush(void) {
             write_cmd(SH110X_SET_PAGE_ADDR | page);
             write_cmd(SH110X_SET_LOW_COLUMN | (col_offset & 0x0F));
             write_cmd(SH110X_SET_HIGH_COLUMN | (col_offset >> 4));
-            write_data(framebuffer[page], DISPLAY_WIDTH);
+            write_data(fb[page], DISPLAY_WIDTH);
         }
     }
 }
 
+void display_flush(void) {
+    if (!initialized) return;
+    dirty = false;
+    flush_buffer(framebuffer);
+}
+
+// Synchronous mode: the flush runs as a Core 1 job when Core 1 is idle
+// (inline otherwise). Core 0 goes on drawing into framebuffer while a
+// flush is on the wire, so display_update() copies the finished frame into
+// a snapshot slot and publishes it; the job sends the newest published
+// slot. With three slots Core 0 always has one that is neither published
+// nor being sent, and a frame published mid-flush replaces any older
+// unsent one. Each field has a single writer and the handoff is plain
+// loads/stores with seq_cst ordering (the M0+ has no atomic RMW).
+#define SNAPSHOT_NONE 0xFF
+
+static uint8_t snapshots[3][DISPLAY_HEIGHT / 8][DISPLAY_WIDTH];
+static uint32_t snapshot_published = 0;          // (seq << 2) | slot, Core 0 only
+static uint8_t snapshot_sending = SNAPSHOT_NONE; // Slot the job is sending, job only
+static uint32_t snapshot_sent = 0;               // Last published value sent, job only
+static bool flush_job_queued = false;            // Set by Core 0, cleared by the job
+
+static void display_flush_job(void* ctx) {
+    (void)ctx;
+    __atomic_store_n(&flush_job_queued, false, __ATOMIC_SEQ_CST);
+    for (;;) {
+        uint32_t pub = __atomic_load_n(&snapshot_published, __ATOMIC_SEQ_CST);
+        if (pub == snapshot_sent) break;
+        // Claim the slot, then confirm it is still the published one: if
+        // Core 0 published in between, it may already be reusing it.
+        __atomic_store_n(&snapshot_sending, (uint8_t)(pub & 3), __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&snapshot_published, __ATOMIC_SEQ_CST) != pub) continue;
+        flush_buffer(snapshots[pub & 3]);
+        snapshot_sent = pub;
+    }
+    __atomic_store_n(&snapshot_sending, SNAPSHOT_NONE, __ATOMIC_SEQ_CST);
+}
+
 void display_update(void) {
     if (!initialized) return;
-    if (async_mode) {
-        dirty = true;
+    dirty = true;
+    if (async_mode) return;
+
+    uint32_t pub = snapshot_published;
+    uint8_t sending = __atomic_load_n(&snapshot_sending, __ATOMIC_SEQ_CST);
+    uint8_t slot = 0;
+    while (slot == (pub & 3) || slot == sending) slot++;
+    memcpy(snapshots[slot], framebuffer, sizeof(framebuffer));
+    dirty = false;
+    __atomic_store_n(&snapshot_published, (((pub >> 2) + 1) << 2) | slot, __ATOMIC_SEQ_CST);
+
+    // A queued job that hasn't started yet picks this frame up
+    if (__atomic_load_n(&flush_job_queued, __ATOMIC_SEQ_CST)) return;
+    __atomic_store_n(&flush_job_queued, true, __ATOMIC_SEQ_CST);
+    if (!core1_jobs_available()) {
+        display_flush_job(NULL);
         return;
     }
-    display_flush();
+    // Never inline while Core 1 may be mid-flush: wait out a full ring
+    while (!core1_job_submit(display_flush_job, NULL, CORE1_JOB_NO_INLINE)) {
+        platform_sleep_us(10);
+    }
 }
 
 void display_set_async(bool async) {
@@ -119,14 +119,17 @@ void face_set_emotion(face_emotion e) {
 face_emotion face_get_emotion(void) { return cur_emo; }
 
 void face_look(float x, float y) {
-    if (x < -1) x = -1; if (x > 1) x = 1;
-    if (y < -1) y = -1; if (y > 1) y = 1;
+    if (x < -1) x = -1;
+    if (x > 1) x = 1;
+    if (y < -1) y = -1;
+    if (y > 1) y = 1;
     target.gaze_x = x; target.gaze_y = y;
     last_look_ms = last_ms;
 }
 
 void face_set_speaking(float env) {
-    if (env < 0) env = 0; if (env > 1) env = 1;
+    if (env < 0) env = 0;
+    if (env > 1) env = 1;
     if (env > speak_env) speak_env = env;
 }
 
@@ -140,7 +143,8 @@ void face_blink(void) {
 
 void face_tick(uint32_t now_ms) {
     float dt = last_ms ? (float)(now_ms - last_ms) / 1000.0f : 0.016f;
-    if (dt < 0) dt = 0; if (dt > 0.05f) dt = 0.05f;
+    if (dt < 0) dt = 0;
+    if (dt > 0.05f) dt = 0.05f;
     last_ms = now_ms;
 
     const float R = 8.0f;    // ease rate (~0.4s to close the gap)
@@ -212,23 +216,6 @@ static void fill_ellipse(int cx, int cy, int rx, int ry, float shear, bool on) {
     }
 }
 
-// Vertical capsule (rounded rect, full-round ends) — for Astro eyes.
-static void fill_capsule(int cx, int cy, int hw, int hh, bool on) {
-    int r = hw; // full round ends
-    for (int y = -hh; y <= hh; y++) {
-        int py = cy + y;
-        if (py < 0 || py >= face_h) continue;
-        int half = hw;
-        int top = hh - r, bot = -(hh - r);
-        if (y > top) { int d = r - (y - top); int dd = r * r - (r - d) * (r - d); half = (dd > 0) ? (int)sqrtf((float)dd) : 0; }
-        else if (y < bot) { int d = r - (bot - y); int dd = r * r - (r - d) * (r - d); half = (dd > 0) ? (int)sqrtf((float)dd) : 0; }
-        for (int x = -half; x <= half; x++) {
-            int px = cx + x;
-            if (px >= 0 && px < face_w) display_pixel((int16_t)px, (int16_t)py, on);
-        }
-    }
-}
-
 // Bottom-up parabolic smile-arc cut (draws OFF), used to carve ⌒ shapes.
 static void cut_smile_arc(int cx, int cy_bottom, int half_w, int depth) {
     if (depth <= 0 || half_w <= 0) return;
@@ -292,7 +279,8 @@ static void effective(face_pose* p, float* bob_out) {
         uint32_t e = last_ms - blink_start_ms;
         float half = BLINK_MS / 2.0f;
         float amt = (e < half) ? (e / half) : ((BLINK_MS - e) / half);
-        if (amt < 0) amt = 0; if (amt > 1) amt = 1;
+        if (amt < 0) amt = 0;
+        if (amt > 1) amt = 1;
         p->eye_open_l *= (1.0f - amt);
         p->eye_open_r *= (1.0f - amt);
     }
@@ -698,7 +686,8 @@ static float astro_eye_d(const astro_ctx* c, float pxf, float pyf, int e) {
     if (c->hearts) {
         float r = sqrtf(nx * nx + ny * ny);
         int bin = (int)((atan2f(-ny, nx) + (float)M_PI) * (64.0f / (2.0f * (float)M_PI)));
-        if (bin < 0) bin = 0; if (bin > 63) bin = 63;
+        if (bin < 0) bin = 0;
+        if (bin > 63) bin = 63;
         float rb = c->rlut[bin];
         return rb > 0.001f ? r / rb : 9e9f;
     }
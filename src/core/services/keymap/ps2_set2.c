@@ -0,0 +1,155 @@
+// ps2_set2.c - HID keyboard usage -> PS/2 Scan Code Set 2 (see ps2_set2.h)
+
+#include "ps2_set2.h"
+#include <stddef.h>
+
+#define HID_USAGE_TABLE_SIZE 0xE8
+
+// HID Keyboard Page (0x07) usage ID -> PS/2 Set 2 scancode.
+// Encoding: low 8 bits = scancode, bit 8 = 1 -> emit 0xE0 prefix first (extended).
+// Zero = unmapped (skip silently).
+//
+// Reference: https://wiki.osdev.org/PS/2_Keyboard#Scan_Code_Set_2 cross-checked
+// with the Linux kernel atkbd map. Set 2 specifically — Set 1 is XT-legacy,
+// Set 3 is rarely supported.
+static const uint16_t hid_to_set2[HID_USAGE_TABLE_SIZE] = {
+    [0x04] = 0x001C, // A
+    [0x05] = 0x0032, // B
+    [0x06] = 0x0021, // C
+    [0x07] = 0x0023, // D
+    [0x08] = 0x0024, // E
+    [0x09] = 0x002B, // F
+    [0x0A] = 0x0034, // G
+    [0x0B] = 0x0033, // H
+    [0x0C] = 0x0043, // I
+    [0x0D] = 0x003B, // J
+    [0x0E] = 0x0042, // K
+    [0x0F] = 0x004B, // L
+    [0x10] = 0x003A, // M
+    [0x11] = 0x0031, // N
+    [0x12] = 0x0044, // O
+    [0x13] = 0x004D, // P
+    [0x14] = 0x0015, // Q
+    [0x15] = 0x002D, // R
+    [0x16] = 0x001B, // S
+    [0x17] = 0x002C, // T
+    [0x18] = 0x003C, // U
+    [0x19] = 0x002A, // V
+    [0x1A] = 0x001D, // W
+    [0x1B] = 0x0022, // X
+    [0x1C] = 0x0035, // Y
+    [0x1D] = 0x001A, // Z
+    [0x1E] = 0x0016, // 1
+    [0x1F] = 0x001E, // 2
+    [0x20] = 0x0026, // 3
+    [0x21] = 0x0025, // 4
+    [0x22] = 0x002E, // 5
+    [0x23] = 0x0036, // 6
+    [0x24] = 0x003D, // 7
+    [0x25] = 0x003E, // 8
+    [0x26] = 0x0046, // 9
+    [0x27] = 0x0045, // 0
+    [0x28] = 0x005A, // Enter
+    [0x29] = 0x0076, // Esc
+    [0x2A] = 0x0066, // Backspace
+    [0x2B] = 0x000D, // Tab
+    [0x2C] = 0x0029, // Space
+    [0x2D] = 0x004E, // -_
+    [0x2E] = 0x0055, // =+
+    [0x2F] = 0x0054, // [{
+    [0x30] = 0x005B, // ]}
+    [0x31] = 0x005D, // \|
+    [0x32] = 0x005D, // Non-US #~   (same key position as \|)
+    [0x33] = 0x004C, // ;:
+    [0x34] = 0x0052, // '"
+    [0x35] = 0x000E, // `~
+    [0x36] = 0x0041, // ,<
+    [0x37] = 0x0049, // .>
+    [0x38] = 0x004A, // /?
+    [0x39] = 0x0058, // CapsLock
+    [0x3A] = 0x0005, // F1
+    [0x3B] = 0x0006, // F2
+    [0x3C] = 0x0004, // F3
+    [0x3D] = 0x000C, // F4
+    [0x3E] = 0x0003, // F5
+    [0x3F] = 0x000B, // F6
+    [0x40] = 0x0083, // F7
+    [0x41] = 0x000A, // F8
+    [0x42] = 0x0001, // F9
+    [0x43] = 0x0009, // F10
+    [0x44] = 0x0078, // F11
+    [0x45] = 0x0007, // F12
+    [0x47] = 0x007E, // ScrollLock
+    [0x49] = 0x0170, // Insert      (extended)
+    [0x4A] = 0x016C, // Home        (extended)
+    [0x4B] = 0x017D, // PageUp      (extended)
+    [0x4C] = 0x0171, // Delete      (extended)
+    [0x4D] = 0x0169, // End         (extended)
+    [0x4E] = 0x017A, // PageDown    (extended)
+    [0x4F] = 0x0174, // RightArrow  (extended)
+    [0x50] = 0x016B, // LeftArrow   (extended)
+    [0x51] = 0x0172, // DownArrow   (extended)
+    [0x52] = 0x0175, // UpArrow     (extended)
+    [0x53] = 0x0077, // NumLock
+    [0x54] = 0x014A, // KP /        (extended)
+    [0x55] = 0x007C, // KP *
+    [0x56] = 0x007B, // KP -
+    [0x57] = 0x0079, // KP +
+    [0x58] = 0x015A, // KP Enter    (extended)
+    [0x59] = 0x0069, // KP 1
+    [0x5A] = 0x0072, // KP 2
+    [0x5B] = 0x007A, // KP 3
+    [0x5C] = 0x006B, // KP 4
+    [0x5D] = 0x0073, // KP 5
+    [0x5E] = 0x0074, // KP 6
+    [0x5F] = 0x006C, // KP 7
+    [0x60] = 0x0075, // KP 8
+    [0x61] = 0x007D, // KP 9
+    [0x62] = 0x0070, // KP 0
+    [0x63] = 0x0071, // KP .
+    [0x64] = 0x0061, // Non-US \|
+    [0x65] = 0x012F, // Application (extended)
+    [0xE0] = 0x0014, // LCtrl
+    [0xE1] = 0x0012, // LShift
+    [0xE2] = 0x0011, // LAlt
+    [0xE3] = 0x011F, // LGUI        (extended)
+    [0xE4] = 0x0114, // RCtrl       (extended)
+    [0xE5] = 0x0059, // RShift
+    [0xE6] = 0x0111, // RAlt        (extended)
+    [0xE7] = 0x0127, // RGUI        (extended)
+};
+
+uint16_t ps2_set2_from_hid(uint8_t usage)
+{
+    if (usage >= HID_USAGE_TABLE_SIZE) return 0;
+    return hid_to_set2[usage];
+}
+
+uint8_t ps2_set2_encode(uint8_t usage, bool pressed, uint8_t out[PS2_SET2_MAX_BYTES])
+{
+    static const uint8_t print_screen_make[]  = { 0xE0, 0x12, 0xE0, 0x7C };
+    static const uint8_t print_screen_break[] = { 0xE0, 0xF0, 0x7C, 0xE0, 0xF0, 0x12 };
+    static const uint8_t pause_make[]         = { 0xE1, 0x14, 0x77, 0xE1, 0xF0, 0x14, 0xF0, 0x77 };
+
+    const uint8_t* seq = NULL;
+    uint8_t n = 0;
+    if (usage == PS2_SET2_PRINT_SCREEN) {
+        seq = pressed ? print_screen_make : print_screen_break;
+        n = pressed ? sizeof(print_screen_make) : sizeof(print_screen_break);
+    } else if (usage == PS2_SET2_PAUSE) {
+        if (!pressed) return 0;
+        seq = pause_make;
+        n = sizeof(pause_make);
+    }
+    if (seq) {
+        for (uint8_t i = 0; i < n; i++) out[i] = seq[i];
+        return n;
+    }
+
+    uint16_t code = ps2_set2_from_hid(usage);
+    if (code == 0) return 0;
+    if (code & PS2_SET2_EXTENDED) out[n++] = 0xE0;
+    if (!pressed) out[n++] = 0xF0;
+    out[n++] = (uint8_t)(code & 0xFF);
+    return n;
+}
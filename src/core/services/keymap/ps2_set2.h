@@ -0,0 +1,31 @@
+// ps2_set2.h - HID keyboard usage -> PS/2 Scan Code Set 2
+//
+// Shared by the keyboard outputs that speak Set 2: the PS/2 device output
+// and the 3DO keyboard (whose driverlet consumes a Set 2 byte stream).
+//
+// Pure data-in / bytes-out; no platform deps.
+
+#ifndef PS2_SET2_H
+#define PS2_SET2_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PS2_SET2_EXTENDED       0x100   // Code takes an 0xE0 prefix
+#define PS2_SET2_MAX_BYTES      8       // Longest sequence (Pause)
+
+// HID usages whose Set 2 sequences aren't one prefixed code
+#define PS2_SET2_PRINT_SCREEN   0x46
+#define PS2_SET2_PAUSE          0x48
+
+// Set 2 code for a HID Keyboard page (0x07) usage: low 8 bits the code,
+// PS2_SET2_EXTENDED if it takes the 0xE0 prefix. 0 = unmapped (also for
+// PrintScreen and Pause, see ps2_set2_encode).
+uint16_t ps2_set2_from_hid(uint8_t usage);
+
+// Bytes a keyboard sends for one press or release (0xE0 prefix, 0xF0 break
+// prefix, and the fake-shift sequences of PrintScreen and Pause). Returns
+// the count, 0 if the usage is unmapped. Pause has no break code.
+uint8_t ps2_set2_encode(uint8_t usage, bool pressed, uint8_t out[PS2_SET2_MAX_BYTES]);
+
+#endif // PS2_SET2_H
@@ -44,7 +44,19 @@ typedef struct {
     uint8_t socd_mode;         // SOCD cleaning mode (0=passthrough, 1=neutral, 2=up-priority, 3=last-win)
     uint8_t l2_threshold;      // Analog L2 → digital threshold; 0 = use default (128)
     uint8_t r2_threshold;      // Analog R2 → digital threshold; 0 = use default (128)
-    uint8_t reserved[20];      // Future use
+    // Gyro aim (core/router/gyro_aim.h). Carved from reserved[] under the
+    // zero-reserved exception (see FLASH_SCHEMA_VERSION): old profiles read
+    // gyro_mode 0 = off, so no schema bump.
+    uint8_t gyro_mode;         // 0=off, 1=right stick, 2=mouse
+    uint8_t gyro_activation;   // 0=always, 1=hold, 2=toggle, 3=off while held
+    uint8_t gyro_button;       // Activation button, 1-based like button_map (1=B1 ... 24=F2)
+    uint8_t gyro_sens_min;     // Tenths (10 = 1.0x); 0 = 1.0x
+    uint8_t gyro_sens_max;     // Tenths, reached at gyro_accel_dps
+    uint8_t gyro_accel_dps;    // 0 = no acceleration (gyro_sens_min throughout)
+    uint8_t gyro_deadzone;     // Tenths of a dps
+    uint8_t gyro_stick_min;    // Stick mode: minimum deflection (0-127)
+    uint8_t gyro_flags;        // Bit 0: invert X, Bit 1: invert Y, Bit 2: roll for X
+    uint8_t reserved[11];      // Future use
 } custom_profile_t;
 
 // Profile flags
@@ -62,6 +74,12 @@ typedef struct {
 // removed, or reinterpreted. On load, a magic-OK record with mismatched
 // schema_version is treated as stale and wiped — see flash_init().
 //
+// One exception: a field carved from a reserved[] array, where 0 means the
+// old behaviour, needs no bump. Every writer leaves reserved bytes zero
+// (flash_init() and custom_profile_init() memset, PROFILE.DELETE clears the
+// freed slot), so records from before the carve read the new field as 0.
+// shoulder_swap and the custom_profile_t gyro_* fields were added this way.
+//
 // Pre-versioning records (v1.9.0 and v2.0.0) have schema_version == 0
 // because the byte was reserved and zero-initialized. Bumping to 1 forces
 // a one-time wipe for those users; subsequent bumps wipe their own range.
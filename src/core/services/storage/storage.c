@@ -4,6 +4,7 @@
 
 #include "storage.h"
 #include "flash.h"
+#include "usb/usbh/hid/devices/vendors/nintendo/switch_cal.h"
 
 void storage_init(void)
 {
@@ -13,4 +14,5 @@ void storage_init(void)
 void storage_task(void)
 {
     flash_task();
+    switch_cal_cache_task();
 }
@@ -0,0 +1,288 @@
+// switch_cal_flash.c - Flash cache for Switch Pro / Joy-Con calibration
+//
+// Keeps the stick and IMU calibration the host drivers read from a
+// controller's SPI flash, keyed by its MAC, so a reconnect skips the SPI
+// reads and is calibrated on its very first report. Overrides the weak
+// no-op cache in switch_cal.c.
+//
+// Flash layout (from end of flash):
+//   [... firmware ...]
+//   [Switch cal sector — 4KB]   <-- this module
+//   [PS4 auth / pad config sector — 4KB]
+//   [Settings Sector B — 4KB]
+//   [Settings Sector A — 4KB]
+//   [BTstack — 8KB]
+//   [end of flash]
+//
+// The sector is a journal of 256-byte slots (one flash page each). Saves
+// program the next empty slot; when the sector is full it is erased and the
+// most recent controllers are written back.
+//
+// Stores come from the host drivers (the BT packet handler, the USB host
+// driver), where a sector erase would stall the radio or the bus. They are
+// queued in RAM and written from storage_task(), like flash_save().
+//
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+
+#include "usb/usbh/hid/devices/vendors/nintendo/switch_cal.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "pico/flash.h"
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// FLASH OFFSET
+// Must stay in sync with flash.c / ps4_auth_flash.c layout.
+// ============================================================================
+
+#define BTSTACK_FLASH_SIZE  (FLASH_SECTOR_SIZE * 2)   // 8KB for BTstack
+
+#if PICO_RP2350 && PICO_RP2350_A2_SUPPORTED
+#define _SECTOR_A_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE - BTSTACK_FLASH_SIZE - FLASH_SECTOR_SIZE)
+#else
+#define _SECTOR_A_OFFSET (PICO_FLASH_SIZE_BYTES - BTSTACK_FLASH_SIZE - FLASH_SECTOR_SIZE)
+#endif
+
+#define _SECTOR_B_OFFSET        (_SECTOR_A_OFFSET - FLASH_SECTOR_SIZE)
+#define _PS4_AUTH_OFFSET        (_SECTOR_B_OFFSET - FLASH_SECTOR_SIZE)
+#define FLASH_SWITCH_CAL_OFFSET (_PS4_AUTH_OFFSET - FLASH_SECTOR_SIZE)
+
+// ============================================================================
+// ENTRY
+// ============================================================================
+
+// Magic number for a Switch calibration slot: "SWCL"
+#define SWITCH_CAL_FLASH_MAGIC  0x5357434C
+
+#define SLOT_SIZE       FLASH_PAGE_SIZE
+#define SLOT_COUNT      (FLASH_SECTOR_SIZE / SLOT_SIZE)     // 16
+#define KEEP_ON_ERASE   8       // Controllers written back after a full sector
+
+typedef struct {
+    uint32_t magic;         // SWITCH_CAL_FLASH_MAGIC, 0xFFFFFFFF = empty slot
+    uint32_t sequence;      // Higher = newer
+    uint8_t  mac[6];
+    uint8_t  reserved[2];
+    switch_cal_t cal;
+    uint32_t crc32;         // CRC-32 of everything above
+} switch_cal_entry_t;
+
+_Static_assert(sizeof(switch_cal_entry_t) <= SLOT_SIZE, "switch_cal_entry_t must fit one flash page");
+
+#define CRC_LENGTH  offsetof(switch_cal_entry_t, crc32)
+
+static uint32_t crc32_compute(const uint8_t* data, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+static const switch_cal_entry_t* get_slot(uint8_t slot)
+{
+    return (const switch_cal_entry_t*)(XIP_BASE + FLASH_SWITCH_CAL_OFFSET + slot * SLOT_SIZE);
+}
+
+static bool slot_valid(const switch_cal_entry_t* e)
+{
+    return e->magic == SWITCH_CAL_FLASH_MAGIC &&
+           e->crc32 == crc32_compute((const uint8_t*)e, CRC_LENGTH);
+}
+
+// Newest valid slot for this MAC, or -1
+static int find_mac(const uint8_t mac[6])
+{
+    int best = -1;
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+        const switch_cal_entry_t* e = get_slot(i);
+        if (!slot_valid(e) || memcmp(e->mac, mac, 6) != 0) continue;
+        if (best < 0 || e->sequence > get_slot(best)->sequence) best = i;
+    }
+    return best;
+}
+
+// ============================================================================
+// FLASH WORKERS (must not be in flash — called during flash operations)
+// ============================================================================
+
+typedef struct {
+    uint32_t       offset;
+    const uint8_t* data;
+} switch_cal_flash_params_t;
+
+static void __no_inline_not_in_flash_func(do_flash_erase)(void* param)
+{
+    switch_cal_flash_params_t* p = (switch_cal_flash_params_t*)param;
+    flash_range_erase(p->offset, FLASH_SECTOR_SIZE);
+}
+
+static void __no_inline_not_in_flash_func(do_flash_program)(void* param)
+{
+    switch_cal_flash_params_t* p = (switch_cal_flash_params_t*)param;
+    flash_range_program(p->offset, p->data, SLOT_SIZE);
+}
+
+static void write_slot(uint8_t slot, const switch_cal_entry_t* entry)
+{
+    // Page buffer static so it survives the flash operation
+    static uint8_t page[SLOT_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, entry, sizeof(*entry));
+
+    switch_cal_flash_params_t p = {
+        .offset = FLASH_SWITCH_CAL_OFFSET + slot * SLOT_SIZE,
+        .data = page,
+    };
+    flash_safe_execute(do_flash_program, &p, UINT32_MAX);
+}
+
+// Erase the sector and write back the newest KEEP_ON_ERASE controllers.
+// Returns the first free slot.
+static uint8_t compact(void)
+{
+    static switch_cal_entry_t keep[KEEP_ON_ERASE];
+    uint8_t kept = 0;
+
+    // Pick newest-first, one entry per MAC
+    uint32_t below = UINT32_MAX;
+    while (kept < KEEP_ON_ERASE) {
+        int pick = -1;
+        for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+            const switch_cal_entry_t* e = get_slot(i);
+            if (!slot_valid(e) || e->sequence >= below) continue;
+            if (pick < 0 || e->sequence > get_slot(pick)->sequence) pick = i;
+        }
+        if (pick < 0) break;
+
+        const switch_cal_entry_t* e = get_slot(pick);
+        below = e->sequence;
+
+        bool dup = false;
+        for (uint8_t k = 0; k < kept; k++) {
+            if (memcmp(keep[k].mac, e->mac, 6) == 0) dup = true;
+        }
+        if (!dup) keep[kept++] = *e;
+    }
+
+    printf("[switch_cal] Cache full, compacting (%u kept)\n", kept);
+    switch_cal_flash_params_t p = { .offset = FLASH_SWITCH_CAL_OFFSET };
+    flash_safe_execute(do_flash_erase, &p, UINT32_MAX);
+
+    // Oldest first so slot order still follows sequence
+    for (uint8_t k = 0; k < kept; k++) {
+        write_slot(k, &keep[kept - 1 - k]);
+    }
+    return kept;
+}
+
+// Write one controller's calibration, unless flash already has it
+static void store_now(const uint8_t mac[6], const switch_cal_t* cal)
+{
+    int existing = find_mac(mac);
+    if (existing >= 0 && memcmp(&get_slot(existing)->cal, cal, sizeof(*cal)) == 0) {
+        return;  // Unchanged — no flash write
+    }
+
+    uint32_t newest = 0;
+    int free_slot = -1;
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+        const switch_cal_entry_t* e = get_slot(i);
+        if (e->magic == 0xFFFFFFFF) {
+            if (free_slot < 0) free_slot = i;
+        } else if (slot_valid(e) && e->sequence > newest) {
+            newest = e->sequence;
+        }
+    }
+    if (free_slot < 0) {
+        free_slot = compact();
+    }
+
+    static switch_cal_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.magic = SWITCH_CAL_FLASH_MAGIC;
+    entry.sequence = newest + 1;
+    memcpy(entry.mac, mac, 6);
+    entry.cal = *cal;
+    entry.crc32 = crc32_compute((const uint8_t*)&entry, CRC_LENGTH);
+
+    write_slot((uint8_t)free_slot, &entry);
+    printf("[switch_cal] Cached calibration for %02X:%02X:%02X:%02X:%02X:%02X (slot %d)\n",
+           mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], free_slot);
+}
+
+// ============================================================================
+// PENDING STORES
+// ============================================================================
+
+#define PENDING_MAX     4       // Controllers connected at once, in practice
+
+typedef struct {
+    uint8_t      mac[6];
+    switch_cal_t cal;
+} switch_cal_pending_t;
+
+static switch_cal_pending_t pending[PENDING_MAX];   // Oldest first
+static uint8_t pending_count = 0;
+
+static int find_pending(const uint8_t mac[6])
+{
+    for (uint8_t i = 0; i < pending_count; i++) {
+        if (memcmp(pending[i].mac, mac, 6) == 0) return i;
+    }
+    return -1;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+bool switch_cal_cache_load(const uint8_t mac[6], switch_cal_t* cal)
+{
+    // A controller can reconnect before its store has been written
+    int p = find_pending(mac);
+    if (p >= 0) {
+        *cal = pending[p].cal;
+        return true;
+    }
+
+    int slot = find_mac(mac);
+    if (slot < 0) return false;
+
+    *cal = get_slot(slot)->cal;
+    return true;
+}
+
+void switch_cal_cache_store(const uint8_t mac[6], const switch_cal_t* cal)
+{
+    int p = find_pending(mac);
+    if (p < 0) {
+        if (pending_count == PENDING_MAX) {
+            // Drop the oldest; that controller re-reads SPI next time
+            memmove(&pending[0], &pending[1], (PENDING_MAX - 1) * sizeof(pending[0]));
+            pending_count--;
+        }
+        p = pending_count++;
+        memcpy(pending[p].mac, mac, 6);
+    }
+    pending[p].cal = *cal;
+}
+
+void switch_cal_cache_task(void)
+{
+    if (!pending_count) {
+        return;
+    }
+
+    // One controller per call keeps each storage_task() pass short
+    store_now(pending[0].mac, &pending[0].cal);
+    pending_count--;
+    memmove(&pending[0], &pending[1], pending_count * sizeof(pending[0]));
+}
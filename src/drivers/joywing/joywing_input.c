@@ -33,6 +33,9 @@
 // Device address — 0xE0 range for standalone, 0xF0 when merged with pad
 #define JOYWING_MAX_INSTANCES 2
 
+// Poll period per instance (seesaw I2C reads)
+#define JOYWING_POLL_MS    10
+
 // Auto-calibrating ADC scaling — tracks min/max per axis
 // Starts with a narrow assumed range and widens as extremes are seen
 typedef struct {
@@ -194,7 +197,7 @@ static void joywing_poll_instance(uint8_t idx)
     if (!jw->initialized) return;
 
     uint32_t now = platform_time_ms();
-    if (now - jw->last_poll < 10) return;
+    if (now - jw->last_poll < JOYWING_POLL_MS) return;
     jw->last_poll = now;
 
     // Read buttons (active low)
@@ -268,6 +271,9 @@ static void joywing_task(void)
     if (!merge_with_pad) {
         router_submit_input(&joywing_event);
     }
+
+    // Next poll, on ports that sleep between events
+    platform_loop_wake_in(JOYWING_POLL_MS);
 }
 
 static bool joywing_is_connected(void)
@@ -24,11 +24,15 @@
 #include "pico/flash.h"
 
 #include "core/app_registry.h"
+#include "core/core1_jobs.h"
+#include "core/power.h"
+#include "core/sched.h"
 #include "core/input_interface.h"
 #include "core/output_interface.h"
 #include "core/services/players/manager.h"
 #include "core/services/leds/leds.h"
 #include "core/services/storage/storage.h"
+#include "core/services/display/display.h"
 
 // App layer (linked per-product)
 extern void app_init(void);
@@ -86,50 +90,86 @@ static void core1_wrapper(void) {
   if (core1_actual_task) {
     core1_actual_task();
   } else {
-    // No task - idle while handling flash lockout requests and optional hook work.
+    // No task - idle while handling flash lockout requests, optional hook work
+    // and background jobs from Core 0 (core1_job_submit()).
     // core1_idle_hook() is a weak no-op by default; output modes may override it
     // (e.g. PS4 auth offloads RSA signing here to avoid blocking Core 0).
+    core1_jobs_attach();
+    power_core1_attach();
     while (1) {
       core1_idle_hook();
+      core1_jobs_run();
       __wfe();  // Wait for event (woken by __sev() or interrupt)
     }
   }
 }
 
-// Core 0 main loop - pinned in SRAM for consistent timing
+// ============================================================================
+// CORE 0 SCHEDULE
+// ============================================================================
+//
+// Hot path (every pass, first): inputs, then outputs, so outputs read the
+// freshest router state. Normal: app logic, player feedback and, when
+// Core 1 is busy with a protocol, the display flush one page per step.
+// Background: LEDs and storage. See core/sched.h for the budget rules.
+
+#define SCHED_APP_BUDGET_US       1000
+#define SCHED_PLAYERS_PERIOD_US   1000
+#define SCHED_DISPLAY_BUDGET_US   300
+#define SCHED_LEDS_PERIOD_US      2000
+#define SCHED_STORAGE_PERIOD_US   10000
+
+static void sched_setup(void)
+{
+  for (uint8_t i = 0; i < input_count; i++) {
+    if (inputs[i] && inputs[i]->task) {
+      sched_add(&(sched_task_t){ .name = inputs[i]->name, .run = inputs[i]->task,
+                                 .cls = SCHED_HOT, .priority = i });
+    }
+  }
+  for (uint8_t i = 0; i < output_count; i++) {
+    if (outputs[i] && outputs[i]->task) {
+      sched_add(&(sched_task_t){ .name = outputs[i]->name, .run = outputs[i]->task,
+                                 .cls = SCHED_HOT, .priority = 64 + i });
+    }
+  }
+
+  sched_add(&(sched_task_t){ .name = "app", .run = app_task,
+                             .cls = SCHED_NORMAL, .priority = 0,
+                             .budget_us = SCHED_APP_BUDGET_US });
+  sched_add(&(sched_task_t){ .name = "players", .run = players_task,
+                             .cls = SCHED_NORMAL, .priority = 1,
+                             .period_us = SCHED_PLAYERS_PERIOD_US });
+
+  // With Core 1 running a protocol, display_update() would flush inline
+  // (~57 ms over I2C). Mark frames dirty instead and flush page by page.
+  if (core1_actual_task) {
+    display_set_async(true);
+    sched_add(&(sched_task_t){ .name = "display", .step = display_flush_step,
+                               .cls = SCHED_NORMAL, .priority = 2,
+                               .budget_us = SCHED_DISPLAY_BUDGET_US });
+  }
+
+  sched_add(&(sched_task_t){ .name = "leds", .run = leds_task,
+                             .cls = SCHED_BACKGROUND, .priority = 0,
+                             .period_us = SCHED_LEDS_PERIOD_US });
+  sched_add(&(sched_task_t){ .name = "storage", .run = storage_task,
+                             .cls = SCHED_BACKGROUND, .priority = 1,
+                             .period_us = SCHED_STORAGE_PERIOD_US });
+}
+
+// Core 0 main loop - pinned in SRAM for consistent timing. Between passes,
+// builds that opted in to power management drop into idle tiers once input
+// goes quiet (see core/power.h); everything else returns immediately.
 static void __not_in_flash_func(core0_main)(void)
 {
   printf("[joypad] Entering main loop\n");
-  static bool first_loop = true;
+  sched_setup();
+  power_init(core1_actual_task != NULL);
   while (1)
   {
-    if (first_loop) printf("[joypad] Loop: leds\n");
-    leds_task();
-    if (first_loop) printf("[joypad] Loop: players\n");
-    players_task();
-    if (first_loop) printf("[joypad] Loop: storage\n");
-    storage_task();
-
-    // Poll all input interfaces FIRST so output reads freshest data this iteration
-    // (Eliminates one-loop-iteration latency vs polling input after output)
-    for (uint8_t i = 0; i < input_count; i++) {
-      if (inputs[i] && inputs[i]->task) {
-        if (first_loop) printf("[joypad] Loop: input %s\n", inputs[i]->name);
-        inputs[i]->task();
-      }
-    }
-
-    // Run output interface tasks (reads router state populated by input above)
-    for (uint8_t i = 0; i < output_count; i++) {
-      if (outputs[i] && outputs[i]->task) {
-        if (first_loop) printf("[joypad] Loop: output %s\n", outputs[i]->name);
-        outputs[i]->task();
-      }
-    }
-
-    if (first_loop) printf("[joypad] Loop: app\n");
-    app_task();
-    first_loop = false;
+    sched_run_pass();
+    power_idle_wait();
   }
 }
 
@@ -101,6 +101,10 @@ volatile uint32_t pio_irq_count = 0;  // Track PIO IRQ calls (incremented in IRQ
 // (~60Hz), regardless of how many main-loop iterations happen in between.
 static volatile bool kb_advance_needed[MAX_PLAYERS] = {true, true, true, true, true, true, true, true};
 
+// Mouse motion per slot, added by the router as events arrive and taken by
+// each PBUS poll (mouse_take)
+static mouse_motion_accum_t* mouse_acc[MAX_PLAYERS];
+
 // Forward declarations
 static void start_dma_transfer(uint8_t channel, uint8_t *buffer, uint32_t count);
 static void report_done(uint8_t instance);
@@ -155,6 +159,21 @@ static void start_dma_transfer(uint8_t channel, uint8_t *buffer, uint32_t count)
 // Report Management Functions
 //-----------------------------------------------------------------------------
 
+// Called before a mouse slot's report is copied out: this poll's movement,
+// up to the 10-bit delta the report carries. The rest waits for the next poll.
+static void mouse_take(uint8_t instance) {
+  mouse_motion_accum_t* acc = mouse_acc[instance];
+  if (!acc) return;
+
+  _3do_mouse_report* report = (_3do_mouse_report*)&current_reports[instance][0];
+  uint16_t dx10 = (uint16_t)mouse_motion_take(acc, MOUSE_MOTION_X, 511) & 0x03FF;
+  uint16_t dy10 = (uint16_t)mouse_motion_take(acc, MOUSE_MOTION_Y, 511) & 0x03FF;
+  report->dx_low = dx10 & 0xFF;          // X[7..0]
+  report->dx_up  = (dx10 >> 8) & 0x03;   // X[9..8]
+  report->dy_low = dy10 & 0x3F;          // Y[5..0]
+  report->dy_up  = (dy10 >> 6) & 0x0F;   // Y[9..6]
+}
+
 // Called after report is sent to clear relative data (e.g., mouse delta)
 static void report_done(uint8_t instance) {
   if (instance >= MAX_PLAYERS) return;
@@ -206,6 +225,7 @@ void on_pio0_irq(void) {
   // Copy all USB controller reports to DMA buffer
   int total_report_size = 0;
   for (int i = 0; i < max_usb_controller; i++) {
+    if (current_reports[i][0] == 0x49) mouse_take(i);
     memcpy(&controller_buffer[total_report_size], &current_reports[i][0], report_sizes[i]);
     report_done(i);
     total_report_size += report_sizes[i];
@@ -685,6 +705,20 @@ void _3do_init(void) {
   pio_gpio_init(pio1, DATA_OUT_PIN);
   pio_sm_set_consecutive_pindirs(pio1, sm_output, DATA_OUT_PIN, 1, true);
 
+  const mouse_motion_config_t mouse_cfg = {
+    .sens_min = TDO_MOUSE_SENS,
+    .sens_max = TDO_MOUSE_SENS_MAX,
+    .accel_cps = TDO_MOUSE_ACCEL_CPS,
+  };
+  if (router_mouse_motion_enable(OUTPUT_TARGET_3DO, &mouse_cfg)) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+      mouse_acc[i] = router_mouse_motion_get(OUTPUT_TARGET_3DO, i);
+    }
+  }
+
+  // Keyboard slots drain the router's key event queue, one byte per poll
+  router_key_events_enable(OUTPUT_TARGET_3DO);
+
   // Profile system is initialized by app_init() - we just set up the callbacks
   profile_set_player_count_callback(tdo_get_player_count_for_profile);
   profile_set_output_mode_callback(tdo_output_mode_switch_callback);
@@ -809,6 +843,9 @@ void _3do_task() {
     }
   }
 
+  // Queue any key transitions a full key event queue held back
+  router_key_events_pump(OUTPUT_TARGET_3DO);
+
   // Update all player reports from router
   // This replaces the old post_globals() call chain
   for (int i = 0; i < MAX_PLAYERS; i++) {
@@ -853,9 +890,8 @@ void __not_in_flash_func(update_3do_report)(uint8_t player_index) {
   bool is_kb_slot = (current_reports[player_index][0] == 0x4B) ||
                     (event && event->type == INPUT_TYPE_KEYBOARD);
   if (is_kb_slot) {
-    if (event && event->type == INPUT_TYPE_KEYBOARD) {
-      tdo_kb_process_event(player_index, event);
-    }
+    // Key transitions come from the router's key event queue, not from this
+    // event's level state: a key tapped between two polls still goes out.
     if (kb_advance_needed[player_index]) {
       _3do_keyboard_report report = new_3do_keyboard_report();
       report.scancode = tdo_kb_next_byte(player_index);
@@ -886,16 +922,8 @@ void __not_in_flash_func(update_3do_report)(uint8_t player_index) {
     // 3DO mouse delta: 10-bit signed two's complement.
     // Per Portfolio MouseDriver: X is bits 0..9, Y is bits 10..19 of the
     // big-endian 32-bit word. Split: X = 8+2, Y = 6+4.
-    // Router clears deltas on read so they don't repeat across frames.
-    int16_t dx = (int16_t)event->delta_x;
-    int16_t dy = (int16_t)event->delta_y;
-    uint16_t dx10 = (uint16_t)(dx & 0x03FF);
-    uint16_t dy10 = (uint16_t)(dy & 0x03FF);
-    report.dx_low = dx10 & 0xFF;          // X[7..0]
-    report.dx_up  = (dx10 >> 8) & 0x03;   // X[9..8]
-    report.dy_low = dy10 & 0x3F;          // Y[5..0]
-    report.dy_up  = (dy10 >> 6) & 0x0F;   // Y[9..6]
-
+    // Filled in by mouse_take() as the PBUS poll copies the report out, from
+    // every event the router has accumulated since the previous poll.
     update_3do_mouse(report, player_index);
     return;
   }
@@ -30,6 +30,18 @@
 #define UART_TX_PIN 0       // UART0 TX
 #define UART_RX_PIN 1       // UART0 RX
 
+// Mouse gain in 1/256 (256 = 1.0x). Raise TDO_MOUSE_SENS_MAX above it for
+// acceleration, reached at TDO_MOUSE_ACCEL_CPS counts per second.
+#ifndef TDO_MOUSE_SENS
+#define TDO_MOUSE_SENS      256
+#endif
+#ifndef TDO_MOUSE_SENS_MAX
+#define TDO_MOUSE_SENS_MAX  TDO_MOUSE_SENS
+#endif
+#ifndef TDO_MOUSE_ACCEL_CPS
+#define TDO_MOUSE_ACCEL_CPS 0
+#endif
+
 // Include PIO headers AFTER pin definitions
 #include "sampling.pio.h"
 #include "output.pio.h"
@@ -5,8 +5,9 @@
 // consumes a PS/2 Set 2 byte stream from byte 1 of each PBUS field
 // (3-byte device class, ID 0x02 or 0x4B).
 //
-// Inputs: full USB HID kb state per slot (8-bit modifier + 6 keycodes).
-// Output: per-slot PS/2 byte queue with one byte popped per PBUS poll.
+// Inputs: the router's key event queue per slot (key_events.h), filled as
+// each USB report is routed, so no press between two polls is lost.
+// Output: the PS/2 bytes of one transition at a time, one byte per PBUS poll.
 //
 // Spec: joypad-tester/.dev/docs/3do_keyboard_protocol.md
 
@@ -15,16 +16,11 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "core/input_event.h"
 
-// Diff the slot's previous HID kb state against this event, push PS/2 down/up
-// sequences (with 0xE0 extended prefixes and 0xF0 release prefixes) into the
-// per-slot ring buffer. On first call for a slot, also enqueues 0xAA so the
-// host driverlet sees the equivalent of a PS/2 self-test pass and clears its
-// key matrix.
-void tdo_kb_process_event(uint8_t slot, const input_event_t* event);
-
-// Pop the next byte to put in the report's scancode slot. Implements the
+// Pop the next byte to put in the report's scancode slot, taking the next
+// key event from the queue once the previous one's bytes are out. On first
+// call for a slot, sends 0xAA so the host driverlet sees the equivalent of a
+// PS/2 self-test pass and clears its key matrix. Implements the
 // alternation pattern (every other PBUS frame is 0x00) so the driverlet's
 // change-detection always sees a transition between consecutive bytes —
 // required when the queue would otherwise emit the same scancode twice
@@ -0,0 +1,267 @@
+// amiga_kb.c - Amiga keyboard protocol for JoypadOS
+
+#include "amiga_kb.h"
+
+#define HID_USAGE_TABLE_SIZE 0xE8
+
+// Table entries carry this bit so the zero default means unmapped (0x00 is
+// a real key, the one left of 1)
+#define MAPPED                  0x80
+
+// HID usages of the reset combo
+#define HID_LCTRL               0xE0
+#define HID_LGUI                0xE3
+#define HID_RCTRL               0xE4
+#define HID_RGUI                0xE7
+#define HID_CAPS_LOCK           0x39
+
+#define RESET_CTRL              0x01
+#define RESET_LAMIGA            0x02
+#define RESET_RAMIGA            0x04
+#define RESET_ALL               (RESET_CTRL | RESET_LAMIGA | RESET_RAMIGA)
+
+// HID Keyboard Page (0x07) usage -> Amiga key code (US A500/A2000 layout,
+// Hardware Reference Manual appendix H). The Amiga keys with no PC
+// counterpart land on their nearest neighbours: Help on Insert, the
+// keypad's ( and ) on Num Lock and Scroll Lock, both Ctrls on Ctrl, and
+// the GUI keys on the Amiga keys.
+static const uint8_t hid_to_amiga[HID_USAGE_TABLE_SIZE] = {
+    [0x04] = MAPPED | 0x20, // A
+    [0x05] = MAPPED | 0x35, // B
+    [0x06] = MAPPED | 0x33, // C
+    [0x07] = MAPPED | 0x22, // D
+    [0x08] = MAPPED | 0x12, // E
+    [0x09] = MAPPED | 0x23, // F
+    [0x0A] = MAPPED | 0x24, // G
+    [0x0B] = MAPPED | 0x25, // H
+    [0x0C] = MAPPED | 0x17, // I
+    [0x0D] = MAPPED | 0x26, // J
+    [0x0E] = MAPPED | 0x27, // K
+    [0x0F] = MAPPED | 0x28, // L
+    [0x10] = MAPPED | 0x37, // M
+    [0x11] = MAPPED | 0x36, // N
+    [0x12] = MAPPED | 0x18, // O
+    [0x13] = MAPPED | 0x19, // P
+    [0x14] = MAPPED | 0x10, // Q
+    [0x15] = MAPPED | 0x13, // R
+    [0x16] = MAPPED | 0x21, // S
+    [0x17] = MAPPED | 0x14, // T
+    [0x18] = MAPPED | 0x16, // U
+    [0x19] = MAPPED | 0x34, // V
+    [0x1A] = MAPPED | 0x11, // W
+    [0x1B] = MAPPED | 0x32, // X
+    [0x1C] = MAPPED | 0x15, // Y
+    [0x1D] = MAPPED | 0x31, // Z
+    [0x1E] = MAPPED | 0x01, // 1
+    [0x1F] = MAPPED | 0x02, // 2
+    [0x20] = MAPPED | 0x03, // 3
+    [0x21] = MAPPED | 0x04, // 4
+    [0x22] = MAPPED | 0x05, // 5
+    [0x23] = MAPPED | 0x06, // 6
+    [0x24] = MAPPED | 0x07, // 7
+    [0x25] = MAPPED | 0x08, // 8
+    [0x26] = MAPPED | 0x09, // 9
+    [0x27] = MAPPED | 0x0A, // 0
+    [0x28] = MAPPED | 0x44, // Return
+    [0x29] = MAPPED | 0x45, // Esc
+    [0x2A] = MAPPED | 0x41, // Backspace
+    [0x2B] = MAPPED | 0x42, // Tab
+    [0x2C] = MAPPED | 0x40, // Space
+    [0x2D] = MAPPED | 0x0B, // -_
+    [0x2E] = MAPPED | 0x0C, // =+
+    [0x2F] = MAPPED | 0x1A, // [{
+    [0x30] = MAPPED | 0x1B, // ]}
+    [0x31] = MAPPED | 0x0D, // \|
+    [0x32] = MAPPED | 0x2B, // Non-US #~    (international key left of Return)
+    [0x33] = MAPPED | 0x29, // ;:
+    [0x34] = MAPPED | 0x2A, // '"
+    [0x35] = MAPPED | 0x00, // `~
+    [0x36] = MAPPED | 0x38, // ,<
+    [0x37] = MAPPED | 0x39, // .>
+    [0x38] = MAPPED | 0x3A, // /?
+    [0x39] = MAPPED | 0x62, // Caps Lock
+    [0x3A] = MAPPED | 0x50, // F1
+    [0x3B] = MAPPED | 0x51, // F2
+    [0x3C] = MAPPED | 0x52, // F3
+    [0x3D] = MAPPED | 0x53, // F4
+    [0x3E] = MAPPED | 0x54, // F5
+    [0x3F] = MAPPED | 0x55, // F6
+    [0x40] = MAPPED | 0x56, // F7
+    [0x41] = MAPPED | 0x57, // F8
+    [0x42] = MAPPED | 0x58, // F9
+    [0x43] = MAPPED | 0x59, // F10
+    [0x47] = MAPPED | 0x5B, // Scroll Lock -> KP )
+    [0x49] = MAPPED | 0x5F, // Insert      -> Help
+    [0x4C] = MAPPED | 0x46, // Delete
+    [0x4F] = MAPPED | 0x4E, // Right
+    [0x50] = MAPPED | 0x4F, // Left
+    [0x51] = MAPPED | 0x4D, // Down
+    [0x52] = MAPPED | 0x4C, // Up
+    [0x53] = MAPPED | 0x5A, // Num Lock    -> KP (
+    [0x54] = MAPPED | 0x5C, // KP /
+    [0x55] = MAPPED | 0x5D, // KP *
+    [0x56] = MAPPED | 0x4A, // KP -
+    [0x57] = MAPPED | 0x5E, // KP +
+    [0x58] = MAPPED | 0x43, // KP Enter
+    [0x59] = MAPPED | 0x1D, // KP 1
+    [0x5A] = MAPPED | 0x1E, // KP 2
+    [0x5B] = MAPPED | 0x1F, // KP 3
+    [0x5C] = MAPPED | 0x2D, // KP 4
+    [0x5D] = MAPPED | 0x2E, // KP 5
+    [0x5E] = MAPPED | 0x2F, // KP 6
+    [0x5F] = MAPPED | 0x3D, // KP 7
+    [0x60] = MAPPED | 0x3E, // KP 8
+    [0x61] = MAPPED | 0x3F, // KP 9
+    [0x62] = MAPPED | 0x0F, // KP 0
+    [0x63] = MAPPED | 0x3C, // KP .
+    [0x64] = MAPPED | 0x30, // Non-US \|    (international key left of Z)
+    [0xE0] = MAPPED | 0x63, // LCtrl       -> Ctrl
+    [0xE1] = MAPPED | 0x60, // LShift
+    [0xE2] = MAPPED | 0x64, // LAlt
+    [0xE3] = MAPPED | 0x66, // LGUI        -> Left Amiga
+    [0xE4] = MAPPED | 0x63, // RCtrl       -> Ctrl
+    [0xE5] = MAPPED | 0x61, // RShift
+    [0xE6] = MAPPED | 0x65, // RAlt
+    [0xE7] = MAPPED | 0x67, // RGUI        -> Right Amiga
+};
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static void track_reset_keys(amiga_kb_t* kb, const key_event_t* ev)
+{
+    uint8_t bit = 0;
+    if (ev->usage == HID_LCTRL || ev->usage == HID_RCTRL) bit = RESET_CTRL;
+    else if (ev->usage == HID_LGUI) bit = RESET_LAMIGA;
+    else if (ev->usage == HID_RGUI) bit = RESET_RAMIGA;
+    if (!bit) return;
+
+    uint8_t before = kb->reset_keys;
+    if (ev->pressed) kb->reset_keys |= bit;
+    else kb->reset_keys &= (uint8_t)~bit;
+
+    if (kb->reset_keys == RESET_ALL && before != RESET_ALL) {
+        kb->reset_pending = true;
+    }
+}
+
+// Next key event that has an Amiga code, as the byte to send
+static bool load_code(amiga_kb_t* kb)
+{
+    key_event_t ev;
+    while (key_events_pop(kb->events, &ev)) {
+        track_reset_keys(kb, &ev);
+
+        uint8_t code = amiga_kb_from_hid(ev.usage);
+        if (code == AMIGA_KB_UNMAPPED) continue;
+
+        if (ev.usage == HID_CAPS_LOCK) {
+            if (!ev.pressed) continue;
+            kb->caps_on = !kb->caps_on;
+            code = kb->caps_on ? AMIGA_KB_CAPS_LOCK : (AMIGA_KB_CAPS_LOCK | AMIGA_KB_KEY_UP);
+        } else if (!ev.pressed) {
+            code |= AMIGA_KB_KEY_UP;
+        }
+
+        kb->code = code;
+        kb->have_code = true;
+        return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+uint8_t amiga_kb_from_hid(uint8_t usage)
+{
+    if (usage >= HID_USAGE_TABLE_SIZE || !hid_to_amiga[usage]) return AMIGA_KB_UNMAPPED;
+    return hid_to_amiga[usage] & (uint8_t)~MAPPED;
+}
+
+void amiga_kb_init(amiga_kb_t* kb, key_events_t* events)
+{
+    kb->events = events;
+    kb->have_code = false;
+    kb->reset_keys = 0;
+    amiga_kb_restart(kb);
+}
+
+void amiga_kb_restart(amiga_kb_t* kb)
+{
+    kb->syncing = true;
+    kb->powered_up = false;
+    kb->reset_pending = false;
+    kb->special_len = kb->special_pos = 0;
+    kb->in_flight = AMIGA_KB_IDLE;
+    kb->in_flight_special = false;
+    kb->caps_on = false;        // The computer boots with Caps Lock off
+}
+
+amiga_kb_action_t amiga_kb_next(amiga_kb_t* kb, uint8_t* byte)
+{
+    if (kb->in_flight != AMIGA_KB_IDLE) return AMIGA_KB_IDLE;
+
+    if (kb->reset_pending) {
+        kb->reset_pending = false;
+        return AMIGA_KB_RESET;
+    }
+
+    if (kb->syncing) {
+        kb->in_flight = AMIGA_KB_SYNC;
+        return AMIGA_KB_SYNC;
+    }
+
+    if (kb->special_pos < kb->special_len) {
+        *byte = kb->special[kb->special_pos];
+        kb->in_flight_special = true;
+    } else if (kb->have_code || (kb->events && load_code(kb))) {
+        *byte = kb->code;
+        kb->in_flight_special = false;
+    } else {
+        return AMIGA_KB_IDLE;
+    }
+
+    kb->in_flight = AMIGA_KB_BYTE;
+    return AMIGA_KB_BYTE;
+}
+
+void amiga_kb_done(amiga_kb_t* kb, bool handshake)
+{
+    amiga_kb_action_t action = kb->in_flight;
+    kb->in_flight = AMIGA_KB_IDLE;
+
+    if (action == AMIGA_KB_SYNC) {
+        if (!handshake) return;                 // Keep clocking 1 bits
+        kb->syncing = false;
+        kb->special_len = kb->special_pos = 0;
+        if (!kb->powered_up) {
+            kb->special[kb->special_len++] = AMIGA_KB_POWERUP_START;
+            kb->special[kb->special_len++] = AMIGA_KB_POWERUP_END;
+            kb->powered_up = true;
+        } else {
+            // What follows is the byte that wasn't handshaken
+            kb->special[kb->special_len++] = AMIGA_KB_LOST_SYNC;
+        }
+        return;
+    }
+    if (action != AMIGA_KB_BYTE) return;
+
+    if (!handshake) {
+        // Lost sync. A power-up byte that got lost goes again from the
+        // start; a key code stays in have_code for after the F9.
+        kb->syncing = true;
+        if (kb->in_flight_special && kb->special[kb->special_pos] != AMIGA_KB_LOST_SYNC) {
+            kb->powered_up = false;
+        }
+        return;
+    }
+
+    if (kb->in_flight_special) {
+        kb->special_pos++;
+    } else {
+        kb->have_code = false;
+    }
+}
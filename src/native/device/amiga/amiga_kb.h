@@ -0,0 +1,111 @@
+// amiga_kb.h - Amiga keyboard protocol for JoypadOS
+//
+// What an Amiga keyboard sends, with no pico-sdk dependency. Key codes come
+// from the router's key event queue; amiga_kb_device.c moves them over
+// KCLK/KDAT with amiga_kb.pio.
+//
+// Every byte must be handshaken by the computer within 143 ms. Until the
+// first handshake the keyboard clocks out single 1 bits (sync); after it,
+// it sends the power-up stream (FD, FE). A byte that isn't handshaken puts
+// the keyboard back into sync, then it sends Lost Sync (F9) and the same
+// byte again, so no key code is lost to a busy computer.
+//
+// Caps Lock latches like on the real keyboard: each press toggles the LED
+// state, sent as 0x62 (on) or 0xE2 (off), and its release isn't sent.
+// Ctrl + Left Amiga + Right Amiga asks for a hard reset (KCLK held low).
+
+#ifndef AMIGA_KB_H
+#define AMIGA_KB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/router/key_events.h"
+
+// ============================================================================
+// PROTOCOL CONSTANTS
+// ============================================================================
+
+#define AMIGA_KB_LOST_SYNC          0xF9
+#define AMIGA_KB_POWERUP_START      0xFD
+#define AMIGA_KB_POWERUP_END        0xFE
+
+#define AMIGA_KB_CAPS_LOCK          0x62
+#define AMIGA_KB_KEY_UP             0x80
+#define AMIGA_KB_UNMAPPED           0xFF
+
+#define AMIGA_KB_HANDSHAKE_US       143000
+#define AMIGA_KB_RESET_US           500000  // KCLK low time for a hard reset
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+typedef enum {
+    AMIGA_KB_IDLE,              // Nothing to send
+    AMIGA_KB_SYNC,              // Clock out one 1 bit, wait for the handshake
+    AMIGA_KB_BYTE,              // Send a byte, wait for the handshake
+    AMIGA_KB_RESET,             // Hold KCLK low AMIGA_KB_RESET_US, then amiga_kb_restart()
+} amiga_kb_action_t;
+
+typedef struct {
+    key_events_t* events;       // Router queue the key codes come from
+
+    bool syncing;               // Clocking out 1 bits until a handshake
+    bool powered_up;            // Power-up stream sent since the last (re)start
+    bool reset_pending;
+
+    // Protocol bytes (FD, FE, F9) to go before the next key code
+    uint8_t special[3];
+    uint8_t special_len;
+    uint8_t special_pos;
+
+    // Key code in flight, or waiting to be sent again after a lost sync
+    bool have_code;
+    uint8_t code;
+
+    amiga_kb_action_t in_flight;
+    bool in_flight_special;
+
+    bool caps_on;
+    uint8_t reset_keys;         // Ctrl / Left Amiga / Right Amiga held
+} amiga_kb_t;
+
+// Power-up state: syncing, then FD FE
+void amiga_kb_init(amiga_kb_t* kb, key_events_t* events);
+
+// After a reset: the computer boots again, so sync and power-up stream again
+void amiga_kb_restart(amiga_kb_t* kb);
+
+// ============================================================================
+// WIRE SIDE
+// ============================================================================
+
+// What to put on the wire next. For AMIGA_KB_BYTE, *byte is the code as
+// the computer reads it (key number, bit 7 = key up); amiga_kb_wire_word()
+// does the bit order.
+amiga_kb_action_t amiga_kb_next(amiga_kb_t* kb, uint8_t* byte);
+
+// Outcome of the SYNC or BYTE from amiga_kb_next()
+void amiga_kb_done(amiga_kb_t* kb, bool handshake);
+
+// Amiga key code for a HID Keyboard page usage, AMIGA_KB_UNMAPPED if none
+uint8_t amiga_kb_from_hid(uint8_t usage);
+
+// ============================================================================
+// FRAMING (shared with amiga_kb.pio)
+// ============================================================================
+
+// TX word for one action: bits go out 6-5-4-3-2-1-0-7 (key-up bit last),
+// so the code is rotated left one and sent MSB first. A sync is a single
+// 1 bit. The handshake timeout is counted in 5 us steps.
+static inline uint32_t amiga_kb_wire_word(amiga_kb_action_t action, uint8_t byte)
+{
+    const uint32_t timeout = AMIGA_KB_HANDSHAKE_US / 5;
+    if (action == AMIGA_KB_SYNC) {
+        return (0u << 29) | (timeout << 14) | (1u << 13);
+    }
+    uint8_t rotated = (uint8_t)((byte << 1) | (byte >> 7));
+    return (7u << 29) | (timeout << 14) | ((uint32_t)rotated << 6);
+}
+
+#endif // AMIGA_KB_H
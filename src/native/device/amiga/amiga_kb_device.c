@@ -0,0 +1,108 @@
+// amiga_kb_device.c - Amiga keyboard output for JoypadOS
+//
+// Runs on core 0 as an output task. The PIO sends one byte (or sync bit)
+// at a time and pushes back whether the computer handshook it within
+// 143 ms; the task hands that to amiga_kb.c and queues the next.
+
+#include "amiga_kb_device.h"
+#include "amiga_kb.h"
+#include "amiga_kb.pio.h"
+#include "core/router/router.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/pio.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+// RX FIFO status word for a missed handshake (amiga_kb.pio)
+#define PIO_NO_HANDSHAKE        0xFFFFFFFFu
+
+// ============================================================================
+// INTERNAL STATE
+// ============================================================================
+
+static amiga_kb_t kb;
+static uint sm;
+
+static bool resetting = false;
+static uint32_t reset_start_us;
+
+// KCLK held low over the PIO's head: the pin's output value is already 0,
+// so forcing its output enable pulls the line down
+static void hold_kclk(bool hold) {
+    gpio_set_oeover(AMIGA_KB_PIN_KCLK, hold ? GPIO_OVERRIDE_HIGH : GPIO_OVERRIDE_NORMAL);
+}
+
+// ============================================================================
+// DEVICE TASK
+// ============================================================================
+
+void amiga_kb_device_task(void) {
+    // Transitions a full queue held back
+    router_key_events_pump(OUTPUT_TARGET_AMIGA_KB);
+
+    if (resetting) {
+        if (time_us_32() - reset_start_us < AMIGA_KB_RESET_US) return;
+        hold_kclk(false);
+        resetting = false;
+        amiga_kb_restart(&kb);
+    }
+
+    if (!pio_sm_is_rx_fifo_empty(AMIGA_KB_PIO, sm)) {
+        amiga_kb_done(&kb, pio_sm_get(AMIGA_KB_PIO, sm) != PIO_NO_HANDSHAKE);
+    }
+
+    uint8_t byte = 0;
+    amiga_kb_action_t action = amiga_kb_next(&kb, &byte);
+    switch (action) {
+        case AMIGA_KB_SYNC:
+        case AMIGA_KB_BYTE:
+            pio_sm_put(AMIGA_KB_PIO, sm, amiga_kb_wire_word(action, byte));
+            break;
+
+        case AMIGA_KB_RESET:
+            printf("[amiga_kb] Ctrl-Amiga-Amiga: reset\n");
+            hold_kclk(true);
+            resetting = true;
+            reset_start_us = time_us_32();
+            break;
+
+        case AMIGA_KB_IDLE:
+            break;
+    }
+}
+
+// ============================================================================
+// DEVICE INIT
+// ============================================================================
+
+void amiga_kb_device_init(void) {
+    // Claimed before router_init(), which leaves these slots alone
+    router_key_events_enable(OUTPUT_TARGET_AMIGA_KB);
+    amiga_kb_init(&kb, router_key_events_get(OUTPUT_TARGET_AMIGA_KB, 0));
+
+    sm = pio_claim_unused_sm(AMIGA_KB_PIO, true);
+    uint offset = pio_add_program(AMIGA_KB_PIO, &amiga_kb_program);
+    amiga_kb_program_init(AMIGA_KB_PIO, sm, offset, AMIGA_KB_PIN_KDAT, AMIGA_KB_PIN_KCLK);
+
+    printf("[amiga_kb] Init complete — KDAT=%d KCLK=%d\n", AMIGA_KB_PIN_KDAT, AMIGA_KB_PIN_KCLK);
+}
+
+// ============================================================================
+// OUTPUT INTERFACE
+// ============================================================================
+
+const OutputInterface amiga_kb_output_interface = {
+    .name = "Amiga Keyboard",
+    .target = OUTPUT_TARGET_AMIGA_KB,
+    .init = amiga_kb_device_init,
+    .task = amiga_kb_device_task,
+    .core1_task = NULL,
+    .get_rumble = NULL,
+    .get_player_led = NULL,
+    .get_profile_count = NULL,
+    .get_active_profile = NULL,
+    .set_active_profile = NULL,
+    .get_profile_name = NULL,
+    .get_trigger_threshold = NULL,
+};
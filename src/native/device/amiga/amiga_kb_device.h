@@ -0,0 +1,46 @@
+// amiga_kb_device.h - Amiga keyboard output for JoypadOS
+//
+// The adapter is the keyboard of an Amiga 500, 1000, 2000, 3000 or 4000
+// (KCLK/KDAT on the keyboard connector). The protocol lives in amiga_kb.c;
+// this file owns the pins and the PIO, which clocks the bits and times the
+// computer's handshake (amiga_kb.pio).
+//
+// Key presses come from the router's key event queue (player 0), so every
+// transition goes out in order, one byte per handshake.
+//
+// KCLK and KDAT are open-collector 5 V lines: use a level shifter (or at
+// least series resistors) on the GPIOs.
+
+#ifndef AMIGA_KB_DEVICE_H
+#define AMIGA_KB_DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "core/output_interface.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#ifndef AMIGA_KB_PIN_KDAT
+#define AMIGA_KB_PIN_KDAT     4
+#endif
+#ifndef AMIGA_KB_PIN_KCLK
+#define AMIGA_KB_PIN_KCLK     5
+#endif
+
+#ifndef AMIGA_KB_PIO
+#define AMIGA_KB_PIO          pio0
+#endif
+
+// ============================================================================
+// API
+// ============================================================================
+
+void amiga_kb_device_init(void);
+void amiga_kb_device_task(void);
+
+extern const OutputInterface amiga_kb_output_interface;
+
+#endif // AMIGA_KB_DEVICE_H
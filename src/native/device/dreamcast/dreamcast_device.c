@@ -89,7 +89,8 @@ enum {
     FUNC_MEMORY_CARD = 2,
     FUNC_LCD = 4,
     FUNC_TIMER = 8,
-    FUNC_VIBRATION = 256
+    FUNC_VIBRATION = 256,
+    FUNC_MOUSE = 512
 };
 
 // ============================================================================
@@ -138,6 +139,17 @@ typedef struct __attribute__((packed)) {
     uint8_t JoyY2;
 } PacketControllerCondition;
 
+// Mouse condition: buttons, then eight 10-bit axes centred on 0x200
+// (X, Y, wheel, rest unused)
+#define DC_MOUSE_AXIS_CENTER    0x200
+#define DC_MOUSE_AXIS_LIMIT     511
+
+typedef struct __attribute__((packed)) {
+    uint32_t Condition;
+    uint32_t Buttons;       // Active-low
+    uint16_t Axis[8];
+} PacketMouseCondition;
+
 // Puru Puru (vibration) info structure
 typedef struct __attribute__((packed)) {
     uint32_t Func;      // Function type (big endian)
@@ -179,6 +191,13 @@ typedef struct __attribute__((packed)) {
     uint32_t CRC;
 } FControllerPacket;
 
+typedef struct __attribute__((packed)) {
+    uint32_t BitPairsMinus1;
+    PacketHeader Header;
+    PacketMouseCondition Mouse;
+    uint32_t CRC;
+} FMousePacket;
+
 typedef struct __attribute__((packed)) {
     uint32_t BitPairsMinus1;
     PacketHeader Header;
@@ -263,6 +282,12 @@ static FACKPacket * volatile pACKPacket = &ACKPacket;
 #endif
 static FPuruPuruDeviceInfoPacket PuruPuruDeviceInfoPacket;
 static FPuruPuruInfoPacket PuruPuruInfoPacket;
+
+// Mouse mode packets — no sub-peripherals, so nothing to switch for VMU
+static FInfoPacket MouseInfoPacket;
+static FAllInfoPacket MouseAllInfoPacket;
+static FMousePacket MousePacket;
+static FACKPacket MouseACKPacket;
 static FPuruPuruConditionPacket PuruPuruConditionPacket;
 static FPuruPuruBlockReadPacket PuruPuruBlockReadPacket;
 
@@ -291,6 +316,17 @@ static uint32_t last_rumble_time[MAX_PLAYERS] = {0};
 static volatile dc_controller_state_t dc_state[MAX_PLAYERS];
 static uint8_t dc_rumble[MAX_PLAYERS];
 
+// Mouse mode (port 0). Core 0 switches it and the buttons; movement is taken
+// by Core 1 from the router's accumulator on each condition request.
+static volatile bool dc_mouse_mode = false;
+static volatile uint32_t dc_mouse_buttons = 0xFFFFFFFF;
+static mouse_motion_accum_t* dc_mouse_acc = NULL;
+
+// Set on a mouse/controller switch: Core 1 ignores the bus until
+// dc_detach_until_us so the console re-enumerates the port
+static volatile bool dc_detached = false;
+static volatile uint32_t dc_detach_until_us = 0;
+
 // ============================================================================
 // SEND STATE
 // ============================================================================
@@ -314,6 +350,10 @@ typedef enum {
     SEND_VMU_WRITE_COMPLETE_ACK, // WR_COMPLETE ACK — always fires, aborts any stuck DMA
     SEND_CONTROLLER_AND_VMU_INFO,
     SEND_CONTROLLER_AND_VMU_ALL_INFO,
+    SEND_MOUSE_INFO,            // Device info in mouse mode
+    SEND_MOUSE_ALL_INFO,        // Extended device info in mouse mode
+    SEND_MOUSE_STATUS,          // Mouse condition
+    SEND_MOUSE_ACK,
 } ESendState;
 
 static volatile ESendState NextPacketSend = SEND_NOTHING;
@@ -552,6 +592,56 @@ static void BuildControllerPacket(void)
     ControllerPacket.CRC = CalcCRC((uint32_t *)&ControllerPacket.Header, sizeof(ControllerPacket) / sizeof(uint32_t) - 2);
 }
 
+static void BuildMousePackets(void)
+{
+    MouseInfoPacket.BitPairsMinus1 = (sizeof(MouseInfoPacket) - 7) * 4 - 1;
+    MouseInfoPacket.Header.Command = CMD_RESPOND_DEVICE_STATUS;
+    MouseInfoPacket.Header.Destination = ADDRESS_DREAMCAST;
+    MouseInfoPacket.Header.Origin = ADDRESS_CONTROLLER;
+    MouseInfoPacket.Header.NumWords = sizeof(MouseInfoPacket.Info) / sizeof(uint32_t);
+
+    MouseInfoPacket.Info.Func = __builtin_bswap32(FUNC_MOUSE);
+    MouseInfoPacket.Info.FuncData[0] = __builtin_bswap32(0x000e0700);  // 3 buttons, X/Y/wheel
+    MouseInfoPacket.Info.FuncData[1] = 0;
+    MouseInfoPacket.Info.FuncData[2] = 0;
+    MouseInfoPacket.Info.AreaCode = -1;
+    MouseInfoPacket.Info.ConnectorDirection = 0;
+    strncpy(MouseInfoPacket.Info.ProductName, "Dreamcast Mouse               ", sizeof(MouseInfoPacket.Info.ProductName));
+    strncpy(MouseInfoPacket.Info.ProductLicense,
+            "Produced By or Under License From SEGA ENTERPRISES,LTD.     ",
+            sizeof(MouseInfoPacket.Info.ProductLicense));
+    MouseInfoPacket.Info.StandbyPower = 400;
+    MouseInfoPacket.Info.MaxPower = 500;
+    MouseInfoPacket.CRC = CalcCRC((uint32_t *)&MouseInfoPacket.Header, sizeof(MouseInfoPacket) / sizeof(uint32_t) - 2);
+
+    MouseAllInfoPacket.BitPairsMinus1 = (sizeof(MouseAllInfoPacket) - 7) * 4 - 1;
+    MouseAllInfoPacket.Header.Command = CMD_RESPOND_ALL_DEVICE_STATUS;
+    MouseAllInfoPacket.Header.Destination = ADDRESS_DREAMCAST;
+    MouseAllInfoPacket.Header.Origin = ADDRESS_CONTROLLER;
+    MouseAllInfoPacket.Header.NumWords = sizeof(MouseAllInfoPacket.Info) / sizeof(uint32_t);
+    memcpy(&MouseAllInfoPacket.Info, &MouseInfoPacket.Info, sizeof(MouseInfoPacket.Info));
+    memset(MouseAllInfoPacket.Info.FreeDeviceStatus, ' ', sizeof(MouseAllInfoPacket.Info.FreeDeviceStatus));
+    memcpy(MouseAllInfoPacket.Info.FreeDeviceStatus, "Version 1.000", 13);
+    MouseAllInfoPacket.CRC = CalcCRC((uint32_t *)&MouseAllInfoPacket.Header, sizeof(MouseAllInfoPacket) / sizeof(uint32_t) - 2);
+
+    MousePacket.BitPairsMinus1 = (sizeof(MousePacket) - 7) * 4 - 1;
+    MousePacket.Header.Command = CMD_RESPOND_DATA_TRANSFER;
+    MousePacket.Header.Destination = ADDRESS_DREAMCAST;
+    MousePacket.Header.Origin = ADDRESS_CONTROLLER;
+    MousePacket.Header.NumWords = sizeof(MousePacket.Mouse) / sizeof(uint32_t);
+    MousePacket.Mouse.Condition = __builtin_bswap32(FUNC_MOUSE);
+    MousePacket.Mouse.Buttons = 0xFFFFFFFF;  // All released
+    for (int i = 0; i < 8; i++) MousePacket.Mouse.Axis[i] = DC_MOUSE_AXIS_CENTER;
+    MousePacket.CRC = CalcCRC((uint32_t *)&MousePacket.Header, sizeof(MousePacket) / sizeof(uint32_t) - 2);
+
+    MouseACKPacket.BitPairsMinus1 = (sizeof(MouseACKPacket) - 7) * 4 - 1;
+    MouseACKPacket.Header.Command = CMD_RESPOND_COMMAND_ACK;
+    MouseACKPacket.Header.Destination = ADDRESS_DREAMCAST;
+    MouseACKPacket.Header.Origin = ADDRESS_CONTROLLER;
+    MouseACKPacket.Header.NumWords = 0;
+    MouseACKPacket.CRC = CalcCRC((uint32_t *)&MouseACKPacket.Header, sizeof(MouseACKPacket) / sizeof(uint32_t) - 2);
+}
+
 static void BuildACKPacket(void)
 {
     ACKPacket.BitPairsMinus1 = (sizeof(ACKPacket) - 7) * 4 - 1;
@@ -628,6 +718,26 @@ static void __not_in_flash_func(SendControllerStatus)(void)
     SendPacket((uint32_t *)pControllerPacket, sizeof(ControllerPacket) / sizeof(uint32_t));
 }
 
+// One condition request = one read of the mouse: take whole counts up to the
+// 10-bit axis range, leaving the rest for the next request
+static void __not_in_flash_func(SendMouseStatus)(void)
+{
+    MousePacket.Mouse.Buttons = dc_mouse_buttons;
+    if (dc_mouse_acc) {
+        MousePacket.Mouse.Axis[0] = (uint16_t)(DC_MOUSE_AXIS_CENTER +
+            mouse_motion_take(dc_mouse_acc, MOUSE_MOTION_X, DC_MOUSE_AXIS_LIMIT));
+        MousePacket.Mouse.Axis[1] = (uint16_t)(DC_MOUSE_AXIS_CENTER +
+            mouse_motion_take(dc_mouse_acc, MOUSE_MOTION_Y, DC_MOUSE_AXIS_LIMIT));
+        // Wheel: HID up is positive, Dreamcast up is negative
+        MousePacket.Mouse.Axis[2] = (uint16_t)(DC_MOUSE_AXIS_CENTER -
+            mouse_motion_take(dc_mouse_acc, MOUSE_MOTION_WHEEL, DC_MOUSE_AXIS_LIMIT));
+    }
+
+    MousePacket.CRC = CalcCRC((uint32_t *)&MousePacket.Header, sizeof(MousePacket) / sizeof(uint32_t) - 2);
+
+    SendPacket((uint32_t *)&MousePacket, sizeof(MousePacket) / sizeof(uint32_t));
+}
+
 // ============================================================================
 // PACKET PROCESSING
 // ============================================================================
@@ -658,9 +768,51 @@ static bool __not_in_flash_func(ConsumePacket)(uint32_t Size)
         return false;
     }
 
+    // Mouse/controller switch in progress: stay silent so the console sees
+    // the port empty and asks for device info again
+    if (dc_detached) {
+        if ((int32_t)(timer_hw->timerawl - dc_detach_until_us) < 0) {
+            return false;
+        }
+        dc_detached = false;
+    }
+
     // Mask off port number
     uint8_t DestPeripheral = Header->Destination & ADDRESS_PERIPHERAL_MASK;
 
+    // Mouse mode: the main peripheral is a mouse with nothing behind it
+    if (dc_mouse_mode) {
+        if (DestPeripheral != ADDRESS_CONTROLLER) {
+            return false;
+        }
+        switch (Header->Command) {
+        case CMD_RESET_DEVICE:
+            NextPacketSend = SEND_MOUSE_ACK;
+            return true;
+
+        case CMD_DEVICE_REQUEST:
+            cmd_device_req++;
+            NextPacketSend = SEND_MOUSE_INFO;
+            return true;
+
+        case CMD_ALL_STATUS_REQUEST:
+            NextPacketSend = SEND_MOUSE_ALL_INFO;
+            return true;
+
+        case CMD_GET_CONDITION:
+            cmd_get_cond++;
+            if (Header->NumWords >= 1 && __builtin_bswap32(PacketData[0]) == FUNC_MOUSE) {
+                NextPacketSend = SEND_MOUSE_STATUS;
+                return true;
+            }
+            break;
+
+        default:
+            break;
+        }
+        return false;
+    }
+
     // Handle main controller requests (address 0x20)
     if (DestPeripheral == ADDRESS_CONTROLLER) {
         switch (Header->Command) {
@@ -883,10 +1035,33 @@ static uint16_t map_buttons_to_dc(uint32_t jp_buttons)
     return ~dc_buttons;
 }
 
+// hid_mouse maps left=B1, right=B2, middle=S2; the Dreamcast mouse reports
+// them where the controller has A, B and Start
+static uint32_t map_mouse_buttons_to_dc(uint32_t jp_buttons)
+{
+    uint32_t dc_buttons = 0;
+    if (jp_buttons & JP_BUTTON_B1) dc_buttons |= DC_BTN_A;
+    if (jp_buttons & JP_BUTTON_B2) dc_buttons |= DC_BTN_B;
+    if (jp_buttons & JP_BUTTON_S2) dc_buttons |= DC_BTN_START;
+    return ~dc_buttons;
+}
+
 // ============================================================================
 // OUTPUT UPDATE
 // ============================================================================
 
+// Port 0 changes between mouse and controller. Drop off the bus first, so
+// Core 1 is quiet before the mode flips and the console re-enumerates.
+static void dc_set_mouse_mode(bool mouse)
+{
+    dc_detach_until_us = time_us_32() + DC_REENUMERATE_US;
+    dc_detached = true;
+    if (dc_mouse_acc) mouse_motion_discard(dc_mouse_acc);
+    dc_mouse_buttons = 0xFFFFFFFF;
+    dc_mouse_mode = mouse;
+    printf("[DC] Port A now a %s\n", mouse ? "mouse" : "controller");
+}
+
 void __not_in_flash_func(dreamcast_update_output)(void)
 {
     // Only update state if there's new input - router clears updated flag after read
@@ -898,6 +1073,16 @@ void __not_in_flash_func(dreamcast_update_output)(void)
             continue;
         }
 
+        // Only port 0 is on the bus; a mouse there becomes a Dreamcast mouse
+        if (port == 0) {
+            bool mouse = (event->type == INPUT_TYPE_MOUSE);
+            if (mouse != dc_mouse_mode) dc_set_mouse_mode(mouse);
+            if (mouse) {
+                dc_mouse_buttons = map_mouse_buttons_to_dc(event->buttons);
+                continue;
+            }
+        }
+
         // New input available - update state
         dc_state[port].buttons = map_buttons_to_dc(event->buttons);
         dc_state[port].joy_x = event->analog[ANALOG_LX];
@@ -1060,6 +1245,18 @@ static void __no_inline_not_in_flash_func(core1_rx_task)(void)
                         case SEND_ACK:
                             SendPacket((uint32_t *)pACKPacket, sizeof(ACKPacket) / sizeof(uint32_t));
                             break;
+                        case SEND_MOUSE_INFO:
+                            SendPacket((uint32_t *)&MouseInfoPacket, sizeof(MouseInfoPacket) / sizeof(uint32_t));
+                            break;
+                        case SEND_MOUSE_ALL_INFO:
+                            SendPacket((uint32_t *)&MouseAllInfoPacket, sizeof(MouseAllInfoPacket) / sizeof(uint32_t));
+                            break;
+                        case SEND_MOUSE_STATUS:
+                            SendMouseStatus();
+                            break;
+                        case SEND_MOUSE_ACK:
+                            SendPacket((uint32_t *)&MouseACKPacket, sizeof(MouseACKPacket) / sizeof(uint32_t));
+                            break;
 #ifdef CONFIG_VMU
                         case SEND_VMU_WRITE_COMPLETE_ACK: {
                             // WR_COMPLETE ACK — must use VMU ACK (origin=0x01), not controller ACK
@@ -1256,6 +1453,16 @@ void dreamcast_init(void)
     BuildPuruPuruInfoPacket();
     BuildPuruPuruConditionPacket();
     BuildPuruPuruBlockReadPacket();
+    BuildMousePackets();
+
+    const mouse_motion_config_t mouse_cfg = {
+        .sens_min = DC_MOUSE_SENS,
+        .sens_max = DC_MOUSE_SENS_MAX,
+        .accel_cps = DC_MOUSE_ACCEL_CPS,
+    };
+    if (router_mouse_motion_enable(OUTPUT_TARGET_DREAMCAST, &mouse_cfg)) {
+        dc_mouse_acc = router_mouse_motion_get(OUTPUT_TARGET_DREAMCAST, 0);
+    }
 
 #ifdef CONFIG_VMU
     // Initialize VMU RAM and packets, but defer advertisement until dreamcast_task()
@@ -66,6 +66,7 @@
 #define MAPLE_FT_KEYBOARD    0x00000040  // FT6: Keyboard
 #define MAPLE_FT_GUN         0x00000080  // FT7: Light gun
 #define MAPLE_FT_VIBRATION   0x00000100  // FT8: Puru Puru (rumble)
+#define MAPLE_FT_MOUSE       0x00000200  // FT9: Mouse
 
 // Addressing
 #define MAPLE_PORT_MASK       0xC0  // Bits 7-6: Port number (0-3)
@@ -77,6 +78,27 @@
 // Timing (microseconds)
 #define MAPLE_RESPONSE_DELAY_US  50   // Min delay before response
 
+// ============================================================================
+// MOUSE
+// ============================================================================
+// A USB mouse on port 0 is presented as a Dreamcast mouse (FT9). Switching
+// between mouse and controller drops the port off the bus for
+// DC_REENUMERATE_US so the console asks what is plugged in again.
+
+// Gain in 1/256 (256 = 1.0x). Raise DC_MOUSE_SENS_MAX above it for
+// acceleration, reached at DC_MOUSE_ACCEL_CPS counts per second.
+#ifndef DC_MOUSE_SENS
+#define DC_MOUSE_SENS       256
+#endif
+#ifndef DC_MOUSE_SENS_MAX
+#define DC_MOUSE_SENS_MAX   DC_MOUSE_SENS
+#endif
+#ifndef DC_MOUSE_ACCEL_CPS
+#define DC_MOUSE_ACCEL_CPS  0
+#endif
+
+#define DC_REENUMERATE_US   200000
+
 // ============================================================================
 // DREAMCAST BUTTON DEFINITIONS
 // ============================================================================
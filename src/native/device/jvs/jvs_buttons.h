@@ -0,0 +1,43 @@
+// jvs_buttons.h - JVS I/O Board Button Aliases
+//
+// Aliases for JP_BUTTON_* constants that map to JVS switch names.
+// These are purely for readability in profile definitions.
+//
+// Example usage in a profile:
+//   { .input = JP_BUTTON_B1, .output = JVS_BUTTON_PUSH1 }
+//   This reads: "JP B1 maps to JVS push button 1"
+//
+// The assignment mirrors native/host/jvs, so a JVS stick read by jvs2usb and
+// played back through usb2jvs comes out on the same switches.
+
+#ifndef JVS_BUTTONS_H
+#define JVS_BUTTONS_H
+
+#include "core/buttons.h"
+
+// ============================================================================
+// JVS BUTTON ALIASES
+// ============================================================================
+// Standard 2L12B cabinet panel, per player:
+//   START, joystick, PUSH1-PUSH10
+// Plus the cabinet-wide TEST and per-player SERVICE switches and coin slots.
+
+// Push buttons
+#define JVS_BUTTON_PUSH1    JP_BUTTON_B3  // Byte 0 bit 1
+#define JVS_BUTTON_PUSH2    JP_BUTTON_B4  // Byte 0 bit 0
+#define JVS_BUTTON_PUSH3    JP_BUTTON_R1  // Byte 1 bit 7
+#define JVS_BUTTON_PUSH4    JP_BUTTON_B1  // Byte 1 bit 6
+#define JVS_BUTTON_PUSH5    JP_BUTTON_B2  // Byte 1 bit 5
+#define JVS_BUTTON_PUSH6    JP_BUTTON_R2  // Byte 1 bit 4
+#define JVS_BUTTON_PUSH7    JP_BUTTON_L1  // Byte 1 bit 3
+#define JVS_BUTTON_PUSH8    JP_BUTTON_L2  // Byte 1 bit 2
+#define JVS_BUTTON_PUSH9    JP_BUTTON_L3  // Byte 1 bit 1
+#define JVS_BUTTON_PUSH10   JP_BUTTON_R3  // Byte 1 bit 0
+
+// System
+#define JVS_BUTTON_START    JP_BUTTON_S2  // Player START
+#define JVS_BUTTON_COIN     JP_BUTTON_S1  // Each press adds one coin to the player's slot
+#define JVS_BUTTON_TEST     JP_BUTTON_A1  // Cabinet TEST (player 1 only)
+#define JVS_BUTTON_SERVICE  JP_BUTTON_A2  // Player SERVICE
+
+#endif // JVS_BUTTONS_H
@@ -0,0 +1,351 @@
+// jvs_device.c - JVS I/O board output for JoypadOS
+//
+// Core 0 turns router players into JVS inputs (profile mapping, coin presses,
+// rotary counts) and publishes a snapshot. Core 1 owns the RS-485 bus: it
+// feeds received bytes to jvs_node, starts the reply on the UART TX DMA the
+// moment the checksum byte is in, and uses the gaps between packets to take
+// the newest snapshot and rebuild the precomputed poll reply.
+//
+// Analog channels (10-bit, as the 837-13551):
+//   0: P1 LX (steering)   1: P1 R2 (gas)   2: P1 L2 (brake)   3: P1 LY
+//   4: P1 RX              5: P1 RY         6: P2 LX           7: P2 LY
+// Rotary channels: mouse / spinner X of players 1 and 2.
+
+#include "jvs_device.h"
+#include "jvs_buttons.h"
+#include "jvs_node.h"
+#include "core/router/router.h"
+#include "core/input_event.h"
+#include "core/services/profiles/profile.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "hardware/uart.h"
+#include "pico/stdlib.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// INTERNAL STATE
+// ============================================================================
+
+// Protocol state, touched only by core 1 after init
+static jvs_node_t node;
+
+// Core 0 -> core 1 input snapshot. Core 0 fills the buffer core 1 is not
+// reading and then bumps the sequence; core 1 retries if it moved mid-copy.
+static jvs_node_inputs_t snapshot[2];
+static volatile uint32_t snapshot_seq = 0;
+
+static volatile bool addressed = false;
+static int tx_dma = -1;
+
+// Core 0 input state
+static jvs_node_inputs_t inputs;
+static uint32_t player_buttons[JVS_NODE_PLAYERS];
+static profile_output_t mapped[JVS_NODE_PLAYERS];
+static int32_t rotary_counts[JVS_NODE_PLAYERS];
+
+// ============================================================================
+// BUS HELPERS
+// ============================================================================
+
+static inline void __not_in_flash_func(bus_drive)(void) {
+    gpio_put(PIN_JVS_RE, 1);    // Receiver off: no echo of our own reply
+    gpio_put(PIN_JVS_DE, 1);
+}
+
+static inline void __not_in_flash_func(bus_release)(void) {
+    gpio_put(PIN_JVS_DE, 0);
+    gpio_put(PIN_JVS_RE, 0);
+}
+
+// Open-drain: low once addressed, released otherwise
+static inline void __not_in_flash_func(sense_set)(bool low) {
+    gpio_set_dir(PIN_JVS_SENSE_OUT, low ? GPIO_OUT : GPIO_IN);
+}
+
+static inline bool __not_in_flash_func(tx_done)(void) {
+    return !dma_channel_is_busy(tx_dma) &&
+           !(uart_get_hw(JVS_UART)->fr & UART_UARTFR_BUSY_BITS);
+}
+
+// ============================================================================
+// SNAPSHOT
+// ============================================================================
+
+static void publish(const jvs_node_inputs_t* in) {
+    uint32_t seq = snapshot_seq + 1;
+    snapshot[seq & 1] = *in;
+    __dmb();
+    snapshot_seq = seq;
+}
+
+static uint32_t __not_in_flash_func(take)(jvs_node_inputs_t* out, uint32_t seen) {
+    uint32_t seq;
+    do {
+        seq = snapshot_seq;
+        if (seq == seen) return seen;
+        __dmb();
+        *out = snapshot[seq & 1];
+        __dmb();
+    } while (snapshot_seq != seq);
+    return seq;
+}
+
+// ============================================================================
+// CORE 1 TASK
+// ============================================================================
+
+void __not_in_flash_func(jvs_device_core1_task)(void) {
+    jvs_node_inputs_t in;
+    uint32_t seen = 0;
+    bool sending = false;
+
+    while (true) {
+        if (sending) {
+            if (!tx_done()) continue;
+            bus_release();
+            sending = false;
+        }
+
+        if (uart_is_readable(JVS_UART)) {
+            const uint8_t* reply;
+            uint16_t len = jvs_node_rx(&node, (uint8_t)uart_getc(JVS_UART), &reply);
+            if (len) {
+                busy_wait_us_32(JVS_TURNAROUND_US);
+                bus_drive();
+                dma_channel_transfer_from_buffer_now(tx_dma, reply, len);
+                sending = true;
+            }
+            continue;
+        }
+
+        // Line idle (between packets or between bytes of one): newest inputs,
+        // then rebuild the poll reply if they changed
+        uint32_t seq = take(&in, seen);
+        if (seq != seen) {
+            seen = seq;
+            jvs_node_set_inputs(&node, &in);
+        }
+        jvs_node_prepare(&node);
+
+        bool now_addressed = jvs_node_addressed(&node);
+        if (now_addressed != addressed) {
+            addressed = now_addressed;
+            sense_set(now_addressed);
+        }
+    }
+}
+
+// ============================================================================
+// INPUT EVENT TAP
+// ============================================================================
+
+// Mouse deltas arrive once per event, so they are counted here rather than
+// from the polled router state
+static void jvs_tap_callback(output_target_t output, uint8_t player_index,
+                             const input_event_t* event)
+{
+    (void)output;
+    if (player_index >= JVS_NODE_PLAYERS) return;
+
+    if (event->type == INPUT_TYPE_MOUSE) {
+        rotary_counts[player_index] += event->delta_x;
+    }
+}
+
+// ============================================================================
+// DEVICE TASK
+// ============================================================================
+
+static inline uint16_t analog16(uint8_t v) {
+    return (uint16_t)((v << 8) | v);
+}
+
+static void build_switches(uint8_t player, uint32_t b) {
+    uint8_t sw0 = 0;
+    uint8_t sw1 = 0;
+
+    if (b & JVS_BUTTON_START)   sw0 |= JVS_SW0_START;
+    if (b & JVS_BUTTON_SERVICE) sw0 |= JVS_SW0_SERVICE;
+    if (b & JP_BUTTON_DU)       sw0 |= JVS_SW0_UP;
+    if (b & JP_BUTTON_DD)       sw0 |= JVS_SW0_DOWN;
+    if (b & JP_BUTTON_DL)       sw0 |= JVS_SW0_LEFT;
+    if (b & JP_BUTTON_DR)       sw0 |= JVS_SW0_RIGHT;
+    if (b & JVS_BUTTON_PUSH1)   sw0 |= JVS_SW0_PUSH1;
+    if (b & JVS_BUTTON_PUSH2)   sw0 |= JVS_SW0_PUSH2;
+
+    if (b & JVS_BUTTON_PUSH3)   sw1 |= 0x80;
+    if (b & JVS_BUTTON_PUSH4)   sw1 |= 0x40;
+    if (b & JVS_BUTTON_PUSH5)   sw1 |= 0x20;
+    if (b & JVS_BUTTON_PUSH6)   sw1 |= 0x10;
+    if (b & JVS_BUTTON_PUSH7)   sw1 |= 0x08;
+    if (b & JVS_BUTTON_PUSH8)   sw1 |= 0x04;
+    if (b & JVS_BUTTON_PUSH9)   sw1 |= 0x02;
+    if (b & JVS_BUTTON_PUSH10)  sw1 |= 0x01;
+
+    inputs.sw[player][0] = sw0;
+    inputs.sw[player][1] = sw1;
+}
+
+static void build_analog(void) {
+    inputs.analog[0] = analog16(mapped[0].left_x);
+    inputs.analog[1] = analog16(mapped[0].r2_analog);
+    inputs.analog[2] = analog16(mapped[0].l2_analog);
+    inputs.analog[3] = analog16(mapped[0].left_y);
+    inputs.analog[4] = analog16(mapped[0].right_x);
+    inputs.analog[5] = analog16(mapped[0].right_y);
+    inputs.analog[6] = analog16(mapped[1].left_x);
+    inputs.analog[7] = analog16(mapped[1].left_y);
+}
+
+void jvs_device_task(void) {
+    const profile_t* profile = profile_get_active(OUTPUT_TARGET_JVS);
+    bool changed = false;
+
+    for (uint8_t i = 0; i < JVS_NODE_PLAYERS; i++) {
+        const input_event_t* event = router_get_output(OUTPUT_TARGET_JVS, i);
+        if (!event) continue;
+        changed = true;
+
+        if (event->type == INPUT_TYPE_NONE) {
+            // Disconnected: release everything, keep coin and rotary counts
+            memset(&mapped[i], 0, sizeof(mapped[i]));
+            mapped[i].left_x = mapped[i].left_y = 128;
+            mapped[i].right_x = mapped[i].right_y = 128;
+        } else {
+            profile_apply(profile, event->buttons,
+                          event->analog[ANALOG_LX], event->analog[ANALOG_LY],
+                          event->analog[ANALOG_RX], event->analog[ANALOG_RY],
+                          event->analog[ANALOG_L2], event->analog[ANALOG_R2],
+                          event->analog[ANALOG_RZ], &mapped[i]);
+        }
+
+        uint32_t b = mapped[i].buttons;
+        if ((b & JVS_BUTTON_COIN) && !(player_buttons[i] & JVS_BUTTON_COIN)) {
+            inputs.coin_presses[i]++;
+        }
+        player_buttons[i] = b;
+        build_switches(i, b);
+    }
+
+    for (uint8_t i = 0; i < JVS_NODE_PLAYERS; i++) {
+        uint16_t pos = (uint16_t)(rotary_counts[i] / JVS_ROTARY_DIVIDER);
+        if (pos != inputs.rotary[i]) {
+            inputs.rotary[i] = pos;
+            changed = true;
+        }
+    }
+
+#if JVS_DEBUG
+    static uint32_t last_log = 0;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (now - last_log >= 5000) {
+        last_log = now;
+        printf("[jvs] addr=%d polls fast=%lu slow=%lu\n", node.addr,
+               (unsigned long)node.polls_fast, (unsigned long)node.polls_slow);
+    }
+#endif
+
+    if (!changed) return;
+
+    inputs.system = (player_buttons[0] & JVS_BUTTON_TEST) ? JVS_SYS_TEST : 0;
+    build_analog();
+    publish(&inputs);
+}
+
+// ============================================================================
+// DEVICE INIT
+// ============================================================================
+
+void jvs_device_init(void) {
+    jvs_node_init(&node);
+
+    // Neutral sticks and pedals until a controller reports
+    for (uint8_t i = 0; i < JVS_NODE_PLAYERS; i++) {
+        mapped[i].left_x = mapped[i].left_y = 128;
+        mapped[i].right_x = mapped[i].right_y = 128;
+    }
+    inputs = node.in;
+    build_analog();
+    publish(&inputs);
+
+    uart_init(JVS_UART, JVS_BAUD);
+    uart_set_translate_crlf(JVS_UART, false);
+    uart_set_fifo_enabled(JVS_UART, true);
+    gpio_set_function(PIN_JVS_TX, GPIO_FUNC_UART);
+    gpio_set_function(PIN_JVS_RX, GPIO_FUNC_UART);
+
+    gpio_init(PIN_JVS_DE);
+    gpio_set_dir(PIN_JVS_DE, GPIO_OUT);
+    gpio_init(PIN_JVS_RE);
+    gpio_set_dir(PIN_JVS_RE, GPIO_OUT);
+    bus_release();
+
+    // Released until SETADDR; driven low from then on
+    gpio_init(PIN_JVS_SENSE_OUT);
+    gpio_put(PIN_JVS_SENSE_OUT, 0);
+    gpio_set_dir(PIN_JVS_SENSE_OUT, GPIO_IN);
+
+    tx_dma = dma_claim_unused_channel(true);
+    dma_channel_config cfg = dma_channel_get_default_config(tx_dma);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_dreq(&cfg, uart_get_dreq(JVS_UART, true));
+    dma_channel_configure(
+        tx_dma,
+        &cfg,
+        &uart_get_hw(JVS_UART)->dr,
+        NULL,
+        0,
+        false
+    );
+
+    router_set_tap(OUTPUT_TARGET_JVS, jvs_tap_callback);
+
+    printf("[jvs] Init complete — UART1 %d baud, TX=%d RX=%d RE=%d DE=%d SENSE=%d\n",
+           JVS_BAUD, PIN_JVS_TX, PIN_JVS_RX, PIN_JVS_RE, PIN_JVS_DE, PIN_JVS_SENSE_OUT);
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+bool jvs_device_is_addressed(void) { return addressed; }
+
+// ============================================================================
+// OUTPUT INTERFACE
+// ============================================================================
+
+static uint8_t jvs_get_profile_count(void) {
+    return profile_get_count(OUTPUT_TARGET_JVS);
+}
+
+static uint8_t jvs_get_active_profile(void) {
+    return profile_get_active_index(OUTPUT_TARGET_JVS);
+}
+
+static void jvs_set_active_profile(uint8_t index) {
+    profile_set_active(OUTPUT_TARGET_JVS, index);
+}
+
+static const char* jvs_get_profile_name(uint8_t index) {
+    return profile_get_name(OUTPUT_TARGET_JVS, index);
+}
+
+const OutputInterface jvs_output_interface = {
+    .name = "JVS",
+    .target = OUTPUT_TARGET_JVS,
+    .init = jvs_device_init,
+    .task = jvs_device_task,
+    .core1_task = jvs_device_core1_task,
+    .get_rumble = NULL,
+    .get_player_led = NULL,
+    .get_profile_count = jvs_get_profile_count,
+    .get_active_profile = jvs_get_active_profile,
+    .set_active_profile = jvs_set_active_profile,
+    .get_profile_name = jvs_get_profile_name,
+    .get_trigger_threshold = NULL,
+};
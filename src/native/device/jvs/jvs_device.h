@@ -0,0 +1,70 @@
+// jvs_device.h - JVS I/O board output for JoypadOS
+//
+// Presents router players to an arcade mainboard (Naomi, Triforce, Chihiro,
+// Lindbergh, ...) as a two-player JVS I/O board on RS-485. The protocol lives
+// in jvs_node.c; this file owns the pins, the UART and the core split.
+//
+// Wiring matches native/host/jvs (UART1 into a MAX485-style transceiver with
+// separate RE/DE), plus one open-drain sense output toward the mainboard.
+// The board is always the last node on the chain: nothing is read from a
+// downstream sense line.
+
+#ifndef JVS_DEVICE_H
+#define JVS_DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "core/output_interface.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define JVS_UART              uart1
+#define JVS_BAUD              115200
+#ifndef PIN_JVS_TX
+#define PIN_JVS_TX            8
+#endif
+#ifndef PIN_JVS_RX
+#define PIN_JVS_RX            9
+#endif
+#ifndef PIN_JVS_RE
+#define PIN_JVS_RE            6
+#endif
+#ifndef PIN_JVS_DE
+#define PIN_JVS_DE            7
+#endif
+#ifndef PIN_JVS_SENSE_OUT
+#define PIN_JVS_SENSE_OUT     12    // Pulled low once the mainboard assigns our address
+#endif
+
+// Quiet time after the mainboard's checksum byte before we drive the bus,
+// so its transceiver has released the line
+#ifndef JVS_TURNAROUND_US
+#define JVS_TURNAROUND_US     20
+#endif
+
+// Mouse / spinner counts per rotary step
+#ifndef JVS_ROTARY_DIVIDER
+#define JVS_ROTARY_DIVIDER    1
+#endif
+
+#ifndef JVS_DEBUG
+#define JVS_DEBUG 0
+#endif
+
+// ============================================================================
+// API
+// ============================================================================
+
+void jvs_device_init(void);
+void jvs_device_task(void);
+void jvs_device_core1_task(void);
+
+// True once the mainboard has addressed this board
+bool jvs_device_is_addressed(void);
+
+extern const OutputInterface jvs_output_interface;
+
+#endif // JVS_DEVICE_H
@@ -0,0 +1,467 @@
+// jvs_node.c - JVS I/O board protocol (device side)
+
+#include "jvs_node.h"
+#include <string.h>
+
+enum {
+    RX_IDLE,                // Waiting for SYNC
+    RX_ADDR,
+    RX_LEN,
+    RX_DATA,
+};
+
+// Command, revision and comms versions (BCD)
+#define JVS_CMDREV_VALUE    0x13    // Command format rev 1.3
+#define JVS_JVSREV_VALUE    0x30    // JVS rev 3.0
+#define JVS_COMMVER_VALUE   0x10    // Communications version 1.0
+
+static const uint8_t features[] = {
+    0x01, JVS_NODE_PLAYERS, JVS_NODE_SWITCHES, 0x00,            // Switch input
+    0x02, JVS_NODE_COIN_SLOTS, 0x00, 0x00,                      // Coin input
+    0x03, JVS_NODE_ANALOG_CHANNELS, JVS_NODE_ANALOG_BITS, 0x00, // Analog input
+    0x04, JVS_NODE_ROTARY_CHANNELS, 0x00, 0x00,                 // Rotary input
+    0x12, JVS_NODE_GPO_OUTPUTS, 0x00, 0x00,                     // General-purpose output
+    0x00,                                                       // End
+};
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+static uint16_t put_escaped(uint8_t* out, uint16_t o, uint8_t b)
+{
+    if (b == JVS_SYNC || b == JVS_MARK) {
+        out[o++] = JVS_MARK;
+        out[o++] = (uint8_t)(b - 1);
+    } else {
+        out[o++] = b;
+    }
+    return o;
+}
+
+// Reply frame to the master: SYNC, address, length, status, payload, checksum
+static uint16_t encode(uint8_t* out, uint8_t status, const uint8_t* payload, uint16_t len)
+{
+    uint8_t n = (uint8_t)(len + 2);
+    uint8_t sum = (uint8_t)(JVS_ADDR_MASTER + n + status);
+    uint16_t o = 0;
+
+    out[o++] = JVS_SYNC;
+    o = put_escaped(out, o, JVS_ADDR_MASTER);
+    o = put_escaped(out, o, n);
+    o = put_escaped(out, o, status);
+    for (uint16_t i = 0; i < len; i++) {
+        sum = (uint8_t)(sum + payload[i]);
+        o = put_escaped(out, o, payload[i]);
+    }
+    return put_escaped(out, o, sum);
+}
+
+// ============================================================================
+// COMMANDS
+// ============================================================================
+
+// Bytes a command takes, arguments included; 0 if unknown to this board
+static uint16_t cmd_size(const uint8_t* d, uint16_t avail)
+{
+    switch (d[0]) {
+        case JVS_CMD_IOIDENT:
+        case JVS_CMD_CMDREV:
+        case JVS_CMD_JVSREV:
+        case JVS_CMD_COMMVER:
+        case JVS_CMD_FEATCHK:
+            return 1;
+        case JVS_CMD_COININP:
+        case JVS_CMD_ANLINP:
+        case JVS_CMD_ROTINP:
+            return 2;
+        case JVS_CMD_SWINP:
+        case JVS_CMD_OUTPUT2:
+            return 3;
+        case JVS_CMD_COINDEC:
+        case JVS_CMD_COININC:
+            return 4;
+        case JVS_CMD_OUTPUT1:
+            return avail >= 2 ? (uint16_t)(2 + d[1]) : 2;
+        case JVS_CMD_MAINID:
+            for (uint16_t k = 1; k < avail; k++) {
+                if (d[k] == 0) return (uint16_t)(k + 1);
+            }
+            return (uint16_t)(avail + 1);   // Unterminated: reported short
+        default:
+            return 0;
+    }
+}
+
+// Polls made of these are answered from a precomputed frame. Reads don't
+// change anything, and repeating the same output write changes nothing more.
+static bool cmd_repeatable(uint8_t cmd)
+{
+    switch (cmd) {
+        case JVS_CMD_IOIDENT:
+        case JVS_CMD_CMDREV:
+        case JVS_CMD_JVSREV:
+        case JVS_CMD_COMMVER:
+        case JVS_CMD_FEATCHK:
+        case JVS_CMD_SWINP:
+        case JVS_CMD_COININP:
+        case JVS_CMD_ANLINP:
+        case JVS_CMD_ROTINP:
+        case JVS_CMD_OUTPUT1:
+        case JVS_CMD_OUTPUT2:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool poll_repeatable(const uint8_t* d, uint16_t len)
+{
+    uint16_t i = 0;
+    while (i < len) {
+        if (!cmd_repeatable(d[i])) return false;
+        i = (uint16_t)(i + cmd_size(&d[i], (uint16_t)(len - i)));
+    }
+    return true;
+}
+
+// Run a packet's commands, reply payload into n->reply. Output and coin
+// writes only happen when `writes` is set. Returns the packet status.
+static uint8_t process(jvs_node_t* n, const uint8_t* d, uint16_t len, bool writes, uint16_t* out_len)
+{
+    uint8_t* r = n->reply;
+    uint16_t o = 0;
+    uint16_t i = 0;
+
+#define ROOM(k) do { if (o + (k) > JVS_NODE_MAX_REPLY) { *out_len = 0; return JVS_STATUS_OVERFLOW; } } while (0)
+
+    *out_len = 0;
+    while (i < len) {
+        const uint8_t* c = &d[i];
+        uint16_t size = cmd_size(c, (uint16_t)(len - i));
+        if (size == 0) return JVS_STATUS_UNKNOWN_CMD;
+        if (size > len - i) {
+            // Arguments cut off: say so and stop here
+            ROOM(1);
+            r[o++] = JVS_REPORT_PARAM_COUNT;
+            break;
+        }
+        i = (uint16_t)(i + size);
+
+        switch (c[0]) {
+            case JVS_CMD_IOIDENT: {
+                uint16_t id_len = (uint16_t)sizeof(JVS_NODE_IDENT);    // With the NUL
+                ROOM(1 + id_len);
+                r[o++] = JVS_REPORT_NORMAL;
+                memcpy(&r[o], JVS_NODE_IDENT, id_len);
+                o = (uint16_t)(o + id_len);
+                break;
+            }
+            case JVS_CMD_CMDREV:
+            case JVS_CMD_JVSREV:
+            case JVS_CMD_COMMVER:
+                ROOM(2);
+                r[o++] = JVS_REPORT_NORMAL;
+                r[o++] = c[0] == JVS_CMD_CMDREV ? JVS_CMDREV_VALUE :
+                         c[0] == JVS_CMD_JVSREV ? JVS_JVSREV_VALUE : JVS_COMMVER_VALUE;
+                break;
+
+            case JVS_CMD_FEATCHK:
+                ROOM(1 + sizeof(features));
+                r[o++] = JVS_REPORT_NORMAL;
+                memcpy(&r[o], features, sizeof(features));
+                o = (uint16_t)(o + sizeof(features));
+                break;
+
+            case JVS_CMD_MAINID:
+                ROOM(1);
+                r[o++] = JVS_REPORT_NORMAL;
+                break;
+
+            case JVS_CMD_SWINP: {
+                // Players or bytes beyond ours read as released
+                uint8_t players = c[1], bytes = c[2];
+                ROOM(2 + players * bytes);
+                r[o++] = JVS_REPORT_NORMAL;
+                r[o++] = n->in.system;
+                for (uint8_t p = 0; p < players; p++) {
+                    for (uint8_t b = 0; b < bytes; b++) {
+                        r[o++] = (p < JVS_NODE_PLAYERS && b < JVS_NODE_SWITCH_BYTES) ? n->in.sw[p][b] : 0;
+                    }
+                }
+                break;
+            }
+
+            case JVS_CMD_COININP: {
+                // Per slot: status (top 2 bits, 0 = normal) and 14-bit count
+                uint8_t slots = c[1];
+                ROOM(1 + 2 * slots);
+                r[o++] = JVS_REPORT_NORMAL;
+                for (uint8_t s = 0; s < slots; s++) {
+                    uint16_t v = s < JVS_NODE_COIN_SLOTS ? n->coins[s] : 0;
+                    r[o++] = (uint8_t)((v >> 8) & 0x3F);
+                    r[o++] = (uint8_t)(v & 0xFF);
+                }
+                break;
+            }
+
+            case JVS_CMD_ANLINP:
+            case JVS_CMD_ROTINP: {
+                bool analog = c[0] == JVS_CMD_ANLINP;
+                uint8_t count = c[1];
+                ROOM(1 + 2 * count);
+                r[o++] = JVS_REPORT_NORMAL;
+                for (uint8_t ch = 0; ch < count; ch++) {
+                    uint16_t v;
+                    if (analog) {
+                        v = ch < JVS_NODE_ANALOG_CHANNELS ? n->in.analog[ch] : 0x8000;
+                    } else {
+                        v = ch < JVS_NODE_ROTARY_CHANNELS ? n->in.rotary[ch] : 0;
+                    }
+                    r[o++] = (uint8_t)(v >> 8);
+                    r[o++] = (uint8_t)(v & 0xFF);
+                }
+                break;
+            }
+
+            case JVS_CMD_COINDEC:
+            case JVS_CMD_COININC: {
+                uint8_t slot = c[1];
+                uint16_t amount = (uint16_t)((c[2] << 8) | c[3]);
+                ROOM(1);
+                if (slot < 1 || slot > JVS_NODE_COIN_SLOTS) {
+                    r[o++] = JVS_REPORT_PARAM_DATA;
+                    break;
+                }
+                r[o++] = JVS_REPORT_NORMAL;
+                if (writes) {
+                    uint16_t* coins = &n->coins[slot - 1];
+                    if (c[0] == JVS_CMD_COINDEC) {
+                        *coins = amount > *coins ? 0 : (uint16_t)(*coins - amount);
+                    } else {
+                        uint32_t v = (uint32_t)*coins + amount;
+                        *coins = v > JVS_NODE_COIN_MAX ? JVS_NODE_COIN_MAX : (uint16_t)v;
+                    }
+                    n->poll_stale = true;
+                }
+                break;
+            }
+
+            case JVS_CMD_OUTPUT1:
+                ROOM(1);
+                r[o++] = JVS_REPORT_NORMAL;
+                if (writes) {
+                    for (uint8_t b = 0; b < c[1] && b < JVS_NODE_GPO_BYTES; b++) {
+                        n->gpo[b] = c[2 + b];
+                    }
+                }
+                break;
+
+            case JVS_CMD_OUTPUT2:
+                ROOM(1);
+                if (c[1] >= JVS_NODE_GPO_BYTES) {
+                    r[o++] = JVS_REPORT_PARAM_DATA;
+                    break;
+                }
+                r[o++] = JVS_REPORT_NORMAL;
+                if (writes) n->gpo[c[1]] = c[2];
+                break;
+        }
+    }
+#undef ROOM
+
+    *out_len = o;
+    return JVS_STATUS_NORMAL;
+}
+
+// ============================================================================
+// PACKETS
+// ============================================================================
+
+static void reset(jvs_node_t* n)
+{
+    n->addr = 0;
+    memset(n->coins, 0, sizeof(n->coins));
+    memset(n->gpo, 0, sizeof(n->gpo));
+    n->tx_len = 0;
+    n->poll_len = 0;
+    n->poll_tx_len = 0;
+    n->poll_stale = false;
+    n->poll_replayed = false;
+}
+
+// A poll answered from poll_tx: it becomes the last reply, and its output
+// writes are applied now
+static void finish_replay(jvs_node_t* n)
+{
+    uint16_t unused;
+    memcpy(n->tx, n->poll_tx, n->poll_tx_len);
+    n->tx_len = n->poll_tx_len;
+    process(n, n->poll, n->poll_len, true, &unused);
+    n->poll_replayed = false;
+}
+
+static uint16_t broadcast(jvs_node_t* n, const uint8_t** reply)
+{
+    const uint8_t* d = n->rx_data;
+    if (n->rx_count < 2) return 0;
+
+    if (d[0] == JVS_CMD_RESET && d[1] == JVS_RESET_ARG) {
+        reset(n);
+        return 0;
+    }
+    if (d[0] == JVS_CMD_SETADDR && n->addr == 0 && d[1] != JVS_ADDR_MASTER && d[1] != JVS_ADDR_BROADCAST) {
+        // Only the last unaddressed board in the chain sees its sense line
+        // free; with none after us, that's always this one
+        static const uint8_t ok = JVS_REPORT_NORMAL;
+        n->addr = d[1];
+        n->tx_len = encode(n->tx, JVS_STATUS_NORMAL, &ok, 1);
+        *reply = n->tx;
+        return n->tx_len;
+    }
+    // COMMCHG: only the standard 115200 baud is offered, so nothing to do
+    return 0;
+}
+
+static uint16_t packet(jvs_node_t* n, bool sum_ok, const uint8_t** reply)
+{
+    if (n->rx_addr == JVS_ADDR_BROADCAST) {
+        return sum_ok ? broadcast(n, reply) : 0;
+    }
+    if (n->addr == 0 || n->rx_addr != n->addr) return 0;
+
+    if (!sum_ok) {
+        n->tx_len = encode(n->tx, JVS_STATUS_SUM_ERROR, NULL, 0);
+        *reply = n->tx;
+        return n->tx_len;
+    }
+
+    const uint8_t* d = n->rx_data;
+    uint8_t len = n->rx_count;
+    if (len == 0) return 0;
+
+    if (d[0] == JVS_CMD_RETRANSMIT) {
+        if (n->tx_len == 0) return 0;
+        *reply = n->tx;
+        return n->tx_len;
+    }
+
+    // The repeating poll, answered with the frame built ahead of time
+    if (len == n->poll_len && n->poll_tx_len && !n->poll_stale &&
+        memcmp(d, n->poll, len) == 0) {
+        n->poll_replayed = true;
+        n->polls_fast++;
+        *reply = n->poll_tx;
+        return n->poll_tx_len;
+    }
+
+    uint16_t r_len;
+    uint8_t status = process(n, d, len, true, &r_len);
+    n->tx_len = encode(n->tx, status, n->reply, r_len);
+    n->polls_slow++;
+
+    // Anything that can be answered the same way next time becomes the
+    // poll to precompute (built in jvs_node_prepare, off this path)
+    if (status == JVS_STATUS_NORMAL && poll_repeatable(d, len)) {
+        if (len != n->poll_len || memcmp(d, n->poll, len) != 0) {
+            memcpy(n->poll, d, len);
+            n->poll_len = len;
+        }
+        n->poll_stale = true;
+    }
+
+    *reply = n->tx;
+    return n->tx_len;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+void jvs_node_init(jvs_node_t* n)
+{
+    memset(n, 0, sizeof(*n));
+    for (int ch = 0; ch < JVS_NODE_ANALOG_CHANNELS; ch++) {
+        n->in.analog[ch] = 0x8000;
+    }
+    n->rx_state = RX_IDLE;
+}
+
+uint16_t jvs_node_rx(jvs_node_t* n, uint8_t b, const uint8_t** reply)
+{
+    // SYNC is never escaped: it always starts a packet
+    if (b == JVS_SYNC) {
+        if (n->poll_replayed) finish_replay(n);
+        n->rx_state = RX_ADDR;
+        n->rx_mark = false;
+        return 0;
+    }
+    if (n->rx_state == RX_IDLE) return 0;
+
+    if (b == JVS_MARK) {
+        n->rx_mark = true;
+        return 0;
+    }
+    if (n->rx_mark) {
+        b = (uint8_t)(b + 1);
+        n->rx_mark = false;
+    }
+
+    switch (n->rx_state) {
+        case RX_ADDR:
+            n->rx_addr = b;
+            n->rx_sum = b;
+            n->rx_state = RX_LEN;
+            return 0;
+
+        case RX_LEN:
+            if (b == 0) {
+                n->rx_state = RX_IDLE;
+                return 0;
+            }
+            n->rx_len = b;
+            n->rx_count = 0;
+            n->rx_sum = (uint8_t)(n->rx_sum + b);
+            n->rx_state = RX_DATA;
+            return 0;
+
+        case RX_DATA:
+            if (n->rx_count + 1 < n->rx_len) {
+                n->rx_data[n->rx_count++] = b;
+                n->rx_sum = (uint8_t)(n->rx_sum + b);
+                return 0;
+            }
+            n->rx_state = RX_IDLE;
+            return packet(n, b == n->rx_sum, reply);
+    }
+    return 0;
+}
+
+void jvs_node_set_inputs(jvs_node_t* n, const jvs_node_inputs_t* in)
+{
+    bool changed = memcmp(&n->in, in, sizeof(*in)) != 0;
+    n->in = *in;
+
+    // Credit new coin presses (the counter wraps, the difference doesn't)
+    for (int s = 0; s < JVS_NODE_COIN_SLOTS; s++) {
+        uint16_t added = (uint16_t)(in->coin_presses[s] - n->coin_seen[s]);
+        n->coin_seen[s] = in->coin_presses[s];
+        if (added) {
+            uint32_t v = (uint32_t)n->coins[s] + added;
+            n->coins[s] = v > JVS_NODE_COIN_MAX ? JVS_NODE_COIN_MAX : (uint16_t)v;
+        }
+    }
+    if (changed) n->poll_stale = true;
+}
+
+void jvs_node_prepare(jvs_node_t* n)
+{
+    if (n->poll_replayed) finish_replay(n);
+
+    if (n->poll_len && n->poll_stale) {
+        uint16_t r_len;
+        uint8_t status = process(n, n->poll, n->poll_len, false, &r_len);
+        n->poll_tx_len = encode(n->poll_tx, status, n->reply, r_len);
+        n->poll_stale = false;
+    }
+}
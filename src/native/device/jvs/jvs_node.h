@@ -0,0 +1,173 @@
+// jvs_node.h - JVS I/O board protocol (device side)
+//
+// Everything between the RS-485 bytes and the input state, with no pico-sdk
+// dependency: frame decoding (sync, escapes, checksum), address assignment,
+// identification and feature reporting, switch / coin / analog / rotary
+// reads, coin and general-purpose output writes, and the reply frames.
+//
+// Mainboards send the same poll packet every frame. Once a poll made only of
+// reads (and repeatable output writes) has been answered, its reply frame is
+// rebuilt ahead of time whenever the inputs change, so the next identical
+// poll is answered the moment its checksum byte arrives.
+//
+// jvs_device.c drives this from the UART; tools/jvs-device-conformance drives
+// it from captured mainboard traffic on the host.
+
+#ifndef JVS_NODE_H
+#define JVS_NODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// PROTOCOL
+// ============================================================================
+
+#define JVS_SYNC                0xE0
+#define JVS_MARK                0xD0    // Escape: next byte is sent minus one
+#define JVS_ADDR_MASTER         0x00
+#define JVS_ADDR_BROADCAST      0xFF
+
+// Packet status (first byte of every reply)
+#define JVS_STATUS_NORMAL       0x01
+#define JVS_STATUS_UNKNOWN_CMD  0x02
+#define JVS_STATUS_SUM_ERROR    0x03
+#define JVS_STATUS_OVERFLOW     0x04    // Reply would not fit in one packet
+
+// Per-command report
+#define JVS_REPORT_NORMAL       0x01
+#define JVS_REPORT_PARAM_COUNT  0x02
+#define JVS_REPORT_PARAM_DATA   0x03
+
+// Commands
+#define JVS_CMD_RESET           0xF0    // Broadcast, argument 0xD9
+#define JVS_CMD_SETADDR         0xF1    // Broadcast, argument the new address
+#define JVS_CMD_COMMCHG         0xF2    // Broadcast, baud rate change
+#define JVS_CMD_IOIDENT         0x10
+#define JVS_CMD_CMDREV          0x11
+#define JVS_CMD_JVSREV          0x12
+#define JVS_CMD_COMMVER         0x13
+#define JVS_CMD_FEATCHK         0x14
+#define JVS_CMD_MAINID          0x15
+#define JVS_CMD_SWINP           0x20
+#define JVS_CMD_COININP         0x21
+#define JVS_CMD_ANLINP          0x22
+#define JVS_CMD_ROTINP          0x23
+#define JVS_CMD_RETRANSMIT      0x2F
+#define JVS_CMD_COINDEC         0x30
+#define JVS_CMD_OUTPUT1         0x32
+#define JVS_CMD_COININC         0x35
+#define JVS_CMD_OUTPUT2         0x37
+
+#define JVS_RESET_ARG           0xD9
+
+// ============================================================================
+// WHAT THIS BOARD REPORTS
+// ============================================================================
+
+#ifndef JVS_NODE_IDENT
+#define JVS_NODE_IDENT  "SEGA ENTERPRISES,LTD.;I/O BD JVS;837-13551 ;Ver1.00;98/10"
+#endif
+
+#define JVS_NODE_PLAYERS            2
+#define JVS_NODE_SWITCHES           13  // START, 4 directions, PUSH1-8 (as the 837-13551)
+#define JVS_NODE_SWITCH_BYTES       2   // Per player
+#define JVS_NODE_COIN_SLOTS         2
+#define JVS_NODE_ANALOG_CHANNELS    8
+#define JVS_NODE_ANALOG_BITS        10
+#define JVS_NODE_ROTARY_CHANNELS    2
+#define JVS_NODE_GPO_BYTES          2
+#define JVS_NODE_GPO_OUTPUTS        (JVS_NODE_GPO_BYTES * 8)
+
+#define JVS_NODE_COIN_MAX           0x3FFF  // 14-bit counter
+
+// Sizes: a packet carries at most 254 data bytes after its length byte
+#define JVS_NODE_MAX_DATA       254
+#define JVS_NODE_MAX_REPLY      253     // Status byte + this + checksum
+#define JVS_NODE_MAX_FRAME      (1 + 2 * (JVS_NODE_MAX_DATA + 3))
+
+// Switch bits, byte 0
+#define JVS_SW0_START           0x80
+#define JVS_SW0_SERVICE         0x40
+#define JVS_SW0_UP              0x20
+#define JVS_SW0_DOWN            0x10
+#define JVS_SW0_LEFT            0x08
+#define JVS_SW0_RIGHT           0x04
+#define JVS_SW0_PUSH1           0x02
+#define JVS_SW0_PUSH2           0x01
+// Byte 1: PUSH3 (0x80) down to PUSH10 (0x01)
+
+// System switch byte
+#define JVS_SYS_TEST            0x80
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+// What the controllers are doing, as JVS sees it
+typedef struct {
+    uint8_t system;                                         // JVS_SYS_*
+    uint8_t sw[JVS_NODE_PLAYERS][JVS_NODE_SWITCH_BYTES];
+    uint16_t analog[JVS_NODE_ANALOG_CHANNELS];              // Full 16-bit scale
+    uint16_t rotary[JVS_NODE_ROTARY_CHANNELS];              // Running position (wraps)
+    uint16_t coin_presses[JVS_NODE_COIN_SLOTS];             // Running count (wraps)
+} jvs_node_inputs_t;
+
+typedef struct {
+    uint8_t addr;                       // From SETADDR, 0 = not assigned
+
+    // Packet being received, unescaped
+    uint8_t rx_state;
+    bool rx_mark;
+    uint8_t rx_addr;
+    uint8_t rx_len;                     // Bytes after the length byte, checksum included
+    uint8_t rx_count;
+    uint8_t rx_sum;
+    uint8_t rx_data[JVS_NODE_MAX_DATA];
+
+    // Inputs, and the state the mainboard changes
+    jvs_node_inputs_t in;
+    uint16_t coin_seen[JVS_NODE_COIN_SLOTS];    // coin_presses already credited
+    uint16_t coins[JVS_NODE_COIN_SLOTS];
+    uint8_t gpo[JVS_NODE_GPO_BYTES];
+
+    // Last reply sent (for RETRANSMIT), and reply scratch
+    uint8_t tx[JVS_NODE_MAX_FRAME];
+    uint16_t tx_len;
+    uint8_t reply[JVS_NODE_MAX_REPLY];
+
+    // The mainboard's repeating poll and its precomputed reply
+    uint8_t poll[JVS_NODE_MAX_DATA];
+    uint8_t poll_len;                   // 0 = nothing cached
+    uint8_t poll_tx[JVS_NODE_MAX_FRAME];
+    uint16_t poll_tx_len;
+    bool poll_stale;                    // Inputs changed since poll_tx was built
+    bool poll_replayed;                 // Answered from poll_tx, writes not yet applied
+
+    uint32_t polls_fast;                // Answered from poll_tx
+    uint32_t polls_slow;                // Built on arrival
+} jvs_node_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+void jvs_node_init(jvs_node_t* n);
+
+// Feed one received byte. Returns the length of a reply frame to transmit
+// right away (*reply points at it, ready for the wire), or 0. The frame stays
+// valid until the next jvs_node_rx() or jvs_node_prepare() call.
+uint16_t jvs_node_rx(jvs_node_t* n, uint8_t byte, const uint8_t** reply);
+
+// New input state. Cheap: only marks the precomputed reply stale.
+void jvs_node_set_inputs(jvs_node_t* n, const jvs_node_inputs_t* in);
+
+// Idle-time work: applies the writes of a poll answered from the precomputed
+// reply and rebuilds that reply if the inputs changed. Call between packets,
+// never while a reply is still being transmitted.
+void jvs_node_prepare(jvs_node_t* n);
+
+// The sense line is pulled low once the mainboard has given us an address
+static inline bool jvs_node_addressed(const jvs_node_t* n) { return n->addr != 0; }
+
+#endif // JVS_NODE_H
@@ -36,6 +36,13 @@ volatile bool n64_console_active = false;
 volatile bool n64_router_has_data = false;  // router_get_output returned non-NULL at least once
 volatile bool n64_player_assigned = false;  // playersCount > 0 seen in update_output
 
+// Mouse mode. Core 0 switches it and keeps the buttons; Core 1 builds each
+// report from the router's accumulator right after the previous one is sent.
+static volatile bool n64_mouse_mode = false;
+static volatile uint32_t n64_mouse_buttons = 0;
+static mouse_motion_accum_t* n64_mouse_acc = NULL;
+static uint16_t n64_controller_device_id;
+
 static uint8_t n64_get_rumble(void) { return n64_rumble_state; }
 
 // ============================================================================
@@ -133,12 +140,33 @@ void n64_late_init()
     if (profile) {
         printf("[n64] Active profile: %s\n", profile->name);
     }
+
+    const mouse_motion_config_t mouse_cfg = {
+        .sens_min = N64_MOUSE_SENS,
+        .sens_max = N64_MOUSE_SENS_MAX,
+        .accel_cps = N64_MOUSE_ACCEL_CPS,
+    };
+    n64_controller_device_id = default_n64_status.device;
+    if (router_mouse_motion_enable(OUTPUT_TARGET_N64, &mouse_cfg)) {
+        n64_mouse_acc = router_mouse_motion_get(OUTPUT_TARGET_N64, 0);
+    }
 }
 
 // ============================================================================
 // CORE 1 TASK (Timing-Critical)
 // ============================================================================
 
+// Next mouse report: whole counts up to the stick's range, the rest stays
+// pending for the next poll. Y flips (HID down, N64 up).
+static inline void __not_in_flash_func(n64_mouse_latch)(void)
+{
+    uint32_t buttons = n64_mouse_buttons;
+    n64_report.a = (buttons & JP_BUTTON_B1) ? 1 : 0;
+    n64_report.b = (buttons & JP_BUTTON_B2) ? 1 : 0;
+    n64_report.stick_x = (int8_t)mouse_motion_take(n64_mouse_acc, MOUSE_MOTION_X, 127);
+    n64_report.stick_y = (int8_t)-mouse_motion_take(n64_mouse_acc, MOUSE_MOTION_Y, 127);
+}
+
 // Core 1: timing-critical joybus protocol only.
 // WaitForPoll handles PROBE/RESET/READ/WRITE internally, returns on POLL.
 // No SM cleanup between sends/receives — PIO transitions write→read via jmp.
@@ -158,6 +186,8 @@ void __not_in_flash_func(core1_task)(void)
     // only inline PIO functions (pio_sm_set_config, pio_sm_restart, etc.).
     while (1) {
         N64Console_WaitForPoll(&n64);
+        // The poll has been answered; one poll = one read of the mouse
+        if (n64_mouse_mode) n64_mouse_latch();
     }
 }
 
@@ -242,6 +272,24 @@ static void map_usbr_to_n64_report(const profile_output_t* output, n64_report_t*
 // OUTPUT UPDATE
 // ============================================================================
 
+// The console learns the device type from PROBE, which N64Console answers
+// from default_n64_status, so the mouse has to be plugged in by the time the
+// game checks the port (usually at boot or on its controller screen).
+static void n64_set_mouse_mode(bool mouse)
+{
+    if (mouse) {
+        if (!n64_mouse_acc) return;
+        mouse_motion_discard(n64_mouse_acc);
+        n64_mouse_buttons = 0;
+        n64_report = default_n64_report;
+        default_n64_status.device = N64_DEVICE_ID_MOUSE;
+    } else {
+        default_n64_status.device = n64_controller_device_id;
+    }
+    n64_mouse_mode = mouse;
+    printf("[n64] Now a %s\n", mouse ? "mouse" : "controller");
+}
+
 void __not_in_flash_func(update_output)(void)
 {
     static uint32_t last_buttons = 0;
@@ -261,6 +309,14 @@ void __not_in_flash_func(update_output)(void)
 
     if (!event || playersCount == 0) return;
 
+    bool mouse = (event->type == INPUT_TYPE_MOUSE) && n64_mouse_acc;
+    if (mouse != n64_mouse_mode) n64_set_mouse_mode(mouse);
+    if (mouse) {
+        // Core 1 owns n64_report in mouse mode
+        n64_mouse_buttons = event->buttons;
+        return;
+    }
+
     // Build new report
     n64_report_t new_report = default_n64_report;
 
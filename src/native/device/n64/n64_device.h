@@ -40,6 +40,21 @@
 #define N64_3V3_PIN 6    // N64 3.3V detection pin
 #endif
 
+// Mouse mode: a USB mouse is presented as the N64 mouse. Joybus sends the
+// device id bytes in memory order, so 0x0002 goes out as 02 00.
+#define N64_DEVICE_ID_MOUSE 0x0002
+
+// Mouse gain in 1/256 (128 = 0.5x); the N64 mouse has coarse counts
+#ifndef N64_MOUSE_SENS
+#define N64_MOUSE_SENS 128
+#endif
+#ifndef N64_MOUSE_SENS_MAX
+#define N64_MOUSE_SENS_MAX N64_MOUSE_SENS
+#endif
+#ifndef N64_MOUSE_ACCEL_CPS
+#define N64_MOUSE_ACCEL_CPS 0
+#endif
+
 // Global variables
 extern PIO pio;
 
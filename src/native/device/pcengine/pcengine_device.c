@@ -37,10 +37,6 @@ static const uint32_t turbo_periods[TURBO_SPEED_COUNT] = { 50, 33, 25 }; // ms:
 PIO pio;
 uint sm1, sm2, sm3;
 
-// When PCE reads, set interlock to ensure atomic update
-//
-volatile bool  output_exclude = false;
-
 // output_word -> is the word sent to the state machine for output
 //
 // Structure of the word sent to the FIFO from the ARM:
@@ -68,25 +64,20 @@ volatile uint32_t output_word_1 = 0;
 
 volatile int state = 0; // countdown sequence for shift-register position (shared between cores)
 
-// Timing for scan boundary detection (needed for mouse - like PCEMouse)
-static volatile absolute_time_t init_time;
-static const int64_t reset_period = 600; // at 600us of no CLK edges, scan is complete
-
 // Console-local state (not input data)
 #include "core/router/router.h"
 #include "core/input_event.h"
 #include "core/services/players/manager.h"
 #include "core/services/codes/codes.h"
+#include "core/router/mouse_motion.h"
 
 static struct {
     volatile int button_mode[MAX_PLAYERS];  // Button mode per player (6-button, 2-button, etc.)
     volatile uint8_t normal_byte[MAX_PLAYERS];  // Cached normal output byte (d-pad + buttons)
     volatile uint8_t ext_byte[MAX_PLAYERS];     // Cached 6-button extended byte
     volatile bool is_mouse[MAX_PLAYERS];
-    volatile int16_t mouse_global_x[MAX_PLAYERS];  // Accumulated X deltas (like PCEMouse global_x)
-    volatile int16_t mouse_global_y[MAX_PLAYERS];  // Accumulated Y deltas (like PCEMouse global_y)
-    volatile int16_t mouse_output_x[MAX_PLAYERS];  // Output X being sent (like PCEMouse output_x)
-    volatile int16_t mouse_output_y[MAX_PLAYERS];  // Output Y being sent (like PCEMouse output_y)
+    int8_t mouse_x[MAX_PLAYERS];        // Movement sent in this scan (core1 only)
+    int8_t mouse_y[MAX_PLAYERS];
     uint32_t turbo_b3_start[MAX_PLAYERS];
     bool     turbo_b3_held[MAX_PLAYERS];
     uint32_t turbo_b4_start[MAX_PLAYERS];
@@ -100,12 +91,13 @@ static struct {
     .normal_byte = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
     .ext_byte = {0xF0, 0xF0, 0xF0, 0xF0, 0xF0},
     .is_mouse = {false},
-    .mouse_global_x = {0},
-    .mouse_global_y = {0},
-    .mouse_output_x = {0},
-    .mouse_output_y = {0}
 };
 
+// Mouse motion, added by the router as events arrive and taken once per
+// four-read mouse scan (see latch_mouse)
+static mouse_motion_accum_t* mouse_acc[MAX_PLAYERS];
+static bool mouse_latched = false;
+
 // No timers needed - state cycles event-driven on CLK edges
 
 // Forward declarations
@@ -161,39 +153,60 @@ void pce_init()
 
   state = 3;
 
+  const mouse_motion_config_t mouse_cfg = {
+    .sens_min = PCE_MOUSE_SENS,
+    .sens_max = PCE_MOUSE_SENS_MAX,
+    .accel_cps = PCE_MOUSE_ACCEL_CPS,
+  };
+  if (router_mouse_motion_enable(OUTPUT_TARGET_PCENGINE, &mouse_cfg)) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+      mouse_acc[i] = router_mouse_motion_get(OUTPUT_TARGET_PCENGINE, i);
+    }
+  }
+
   output_word_0 = 0xFFFFFFFF;  // no buttons pushed
   output_word_1 = 0x000000FF;  // no buttons pushed
   
   // Prime the PIO FIFO - plex program starts at pull block waiting for data
   pio_sm_put(pio, sm1, output_word_1);
   pio_sm_put(pio, sm1, output_word_0);
-  
-  // Initialize timing (like PCEMouse)
-  init_time = get_absolute_time();
 }
 
 // task process - runs on core0, keeps cached button values fresh
 void pce_task()
 {
-  // Check for scan boundary timeout (like PCEMouse process_signals)
-  // After 600us of no CLK edges, the scan is complete - unlock for updates
-  // Note: don't reset state here - let core1 handle state transitions
-  absolute_time_t current_time = get_absolute_time();
-  if (absolute_time_diff_us(init_time, current_time) > reset_period) {
-    output_exclude = false;  // Allow core0 to update output values
-    init_time = current_time;
-  }
-  
   // Continuously read input and cache it - core1 will use cached values
   read_inputs();
 }
 
+//
+// latch_mouse - takes each mouse's movement for the scan about to start.
+//               The four reads of one scan carry a single 8-bit X and Y, so
+//               take at most that; the rest waits for the next scan.
+//
+static void __not_in_flash_func(latch_mouse)(void)
+{
+  for (int i = 0; i < MAX_PLAYERS; i++) {
+    mouse_motion_accum_t* acc = mouse_acc[i];
+    if (!acc) continue;
+    if (pce_state.is_mouse[i]) {
+      // Negated to match PCE direction convention (left/up positive)
+      pce_state.mouse_x[i] = (int8_t)-mouse_motion_take(acc, MOUSE_MOTION_X, 127);
+      pce_state.mouse_y[i] = (int8_t)-mouse_motion_take(acc, MOUSE_MOTION_Y, 127);
+    } else {
+      mouse_motion_discard(acc);
+      pce_state.mouse_x[i] = 0;
+      pce_state.mouse_y[i] = 0;
+    }
+  }
+}
+
 //
 
 //
 // core1_task - inner-loop for the second core
-//             - when the "CLR" line is de-asserted, set lock flag
-//               protecting the output state machine from inconsistent data
+//             - on each CLK edge, assemble the word for the current read;
+//               mouse movement is taken once at the start of each scan
 //
 void __not_in_flash_func(core1_task)(void)
 {
@@ -204,8 +217,11 @@ void __not_in_flash_func(core1_task)(void)
     // wait for CLK rising edge (from clock.pio via sm2)
     rx_bit = pio_sm_get_blocking(pio, sm2);
 
-    // Lock output values during scan (like PCEMouse)
-    output_exclude = true;
+    // First read of a scan: take the mouse movement it will carry
+    if (state == 3 && !mouse_latched) {
+      latch_mouse();
+      mouse_latched = true;
+    }
 
     // Assemble output for CURRENT state using cached button values
     assemble_output();
@@ -219,22 +235,11 @@ void __not_in_flash_func(core1_task)(void)
       // Advance state: 3 → 2 → 1 → 0 → 3 → ...
       if (state != 0) {
         state--;
-        // Renew countdown timeframe (like PCEMouse)
-        init_time = get_absolute_time();
       } else {
-        // State 0: reset mouse outputs (matching PCEMouse exactly)
-        for (int i = 0; i < MAX_PLAYERS; i++) {
-          if (pce_state.is_mouse[i]) {
-            pce_state.mouse_global_x[i] -= pce_state.mouse_output_x[i];
-            pce_state.mouse_global_y[i] -= pce_state.mouse_output_y[i];
-            pce_state.mouse_output_x[i] = 0;
-            pce_state.mouse_output_y[i] = 0;
-          }
-        }
+        // State 0: scan complete, the next one takes fresh mouse movement
+        mouse_latched = false;
         // Reset to state 3 for next cycle
         state = 3;
-        // Keep output_exclude = true for mouse - pce_task timeout will clear it
-        output_exclude = true;
       }
     }
   }
@@ -251,15 +256,11 @@ void __not_in_flash_func(read_inputs)(void)
   {
     const input_event_t* event = router_get_output(OUTPUT_TARGET_PCENGINE, i);
 
-    // Player slot out of range - reset to neutral (including mouse state)
+    // Player slot out of range - reset to neutral (core1 drops mouse motion)
     if (i >= playersCount) {
       pce_state.normal_byte[i] = 0xFF;
       pce_state.ext_byte[i] = 0xF0;
       pce_state.is_mouse[i] = false;
-      pce_state.mouse_global_x[i] = 0;
-      pce_state.mouse_global_y[i] = 0;
-      pce_state.mouse_output_x[i] = 0;
-      pce_state.mouse_output_y[i] = 0;
       continue;
     }
     
@@ -378,40 +379,9 @@ void __not_in_flash_func(read_inputs)(void)
     if (event->buttons & JP_BUTTON_L1) ext &= ~(1 << 6);  // V
     if (event->buttons & JP_BUTTON_R1) ext &= ~(1 << 7);  // VI
 
-    // Mouse handling - accumulate deltas exactly like PCEMouse post_globals
-    bool was_mouse = pce_state.is_mouse[i];
+    // Mouse: movement comes from the router's mouse motion accumulator, taken
+    // by core1 per scan; a slot that stops being a mouse has it dropped there
     pce_state.is_mouse[i] = (event->type == INPUT_TYPE_MOUSE);
-    
-    // Clear mouse state when device type changes (prevents drift on disconnect)
-    if (was_mouse && !pce_state.is_mouse[i]) {
-      pce_state.mouse_global_x[i] = 0;
-      pce_state.mouse_global_y[i] = 0;
-      pce_state.mouse_output_x[i] = 0;
-      pce_state.mouse_output_y[i] = 0;
-    }
-    
-    if (pce_state.is_mouse[i]) {
-      // Negate deltas to match PCE direction convention
-      uint8_t delta_x = (uint8_t)(-(int8_t)event->delta_x);
-      uint8_t delta_y = (uint8_t)(-(int8_t)event->delta_y);
-      
-      // Accumulate into signed 16-bit (same logic as PCEMouse post_globals)
-      if (delta_x >= 128)
-        pce_state.mouse_global_x[i] -= (256 - delta_x);
-      else
-        pce_state.mouse_global_x[i] += delta_x;
-      
-      if (delta_y >= 128)
-        pce_state.mouse_global_y[i] -= (256 - delta_y);
-      else
-        pce_state.mouse_global_y[i] += delta_y;
-      
-      // Only copy global to output when not in a scan (like PCEMouse)
-      if (!output_exclude) {
-        pce_state.mouse_output_x[i] = pce_state.mouse_global_x[i];
-        pce_state.mouse_output_y[i] = pce_state.mouse_global_y[i];
-      }
-    }
 
     pce_state.normal_byte[i] = normal;
     pce_state.ext_byte[i] = ext;
@@ -433,15 +403,15 @@ void __not_in_flash_func(assemble_output)(void)
     if (pce_state.is_mouse[i]) {
       // Mouse: buttons in upper nibble, position data in lower nibble
       byte = pce_state.normal_byte[i] & 0xF0;
-      
-      // Scale down for modern high-DPI mice (total >>2 = divide by 4)
-      int16_t ox = pce_state.mouse_output_x[i] >> 1;
-      int16_t oy = pce_state.mouse_output_y[i] >> 1;
+
+      // Scaling (PCE_MOUSE_SENS) is applied as motion is accumulated
+      uint8_t ox = (uint8_t)pce_state.mouse_x[i];
+      uint8_t oy = (uint8_t)pce_state.mouse_y[i];
       switch (state) {
-        case 3: byte |= (((ox >> 1) & 0xf0) >> 4); break;  // X MSN
-        case 2: byte |= (((ox >> 1) & 0x0f));      break;  // X LSN
-        case 1: byte |= (((oy >> 1) & 0xf0) >> 4); break;  // Y MSN
-        case 0: byte |= (((oy >> 1) & 0x0f));      break;  // Y LSN
+        case 3: byte |= ox >> 4;   break;  // X MSN
+        case 2: byte |= ox & 0x0f; break;  // X LSN
+        case 1: byte |= oy >> 4;   break;  // Y MSN
+        case 0: byte |= oy & 0x0f; break;  // Y LSN
       }
     } else if (pce_state.button_mode[i] == BUTTON_MODE_6 && (state == 2 || state == 0)) {
       // 6-button mode, states 2 and 0: output extended byte (with signature)
@@ -34,6 +34,19 @@
   #define OUTD3_PIN   29
 #endif
 
+// Mouse gain in 1/256 (64 = 0.25x, which keeps a modern USB mouse near the
+// feel of the original PCE mouse). Raise PCE_MOUSE_SENS_MAX above it for
+// acceleration, reached at PCE_MOUSE_ACCEL_CPS counts per second.
+#ifndef PCE_MOUSE_SENS
+#define PCE_MOUSE_SENS      64
+#endif
+#ifndef PCE_MOUSE_SENS_MAX
+#define PCE_MOUSE_SENS_MAX  PCE_MOUSE_SENS
+#endif
+#ifndef PCE_MOUSE_ACCEL_CPS
+#define PCE_MOUSE_ACCEL_CPS 0
+#endif
+
 // PCE button modes
 #define BUTTON_MODE_2 0x00
 #define BUTTON_MODE_6 0x01
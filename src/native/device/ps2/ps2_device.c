@@ -0,0 +1,103 @@
+// ps2_device.c - PS/2 keyboard output for JoypadOS
+//
+// Runs on core 0 as an output task. The PIO clocks every frame and answers
+// the host's request-to-send on its own, so the task only has to keep one
+// byte in the TX FIFO and read back what happened to it: sent, aborted by
+// a host inhibit (sent again), or overtaken by a host command.
+
+#include "ps2_device.h"
+#include "ps2_kbd.h"
+#include "ps2_device.pio.h"
+#include "core/router/router.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/pio.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+// RX FIFO status words (ps2_device.pio)
+#define PIO_SENT                0xFFFFFFFFu
+#define PIO_ABORTED_MAX         10u
+
+// ============================================================================
+// INTERNAL STATE
+// ============================================================================
+
+static ps2_kbd_t kb;
+static uint sm;
+
+// ============================================================================
+// DEVICE TASK
+// ============================================================================
+
+void ps2_device_task(void) {
+    // Transitions a full queue held back
+    router_key_events_pump(OUTPUT_TARGET_PS2);
+
+    uint32_t now = time_us_32();
+
+    while (!pio_sm_is_rx_fifo_empty(PS2_DEVICE_PIO, sm)) {
+        uint32_t word = pio_sm_get(PS2_DEVICE_PIO, sm);
+
+        if (word == PIO_SENT || word <= PIO_ABORTED_MAX) {
+            ps2_kbd_sent(&kb, word == PIO_SENT, now);
+            continue;
+        }
+
+        uint8_t byte;
+        if (ps2_kbd_rx_frame(word, &byte)) {
+#if PS2_DEBUG
+            printf("[ps2] host %02X\n", byte);
+#endif
+            ps2_kbd_host_byte(&kb, byte);
+        } else {
+            ps2_kbd_host_error(&kb);
+        }
+    }
+
+    uint8_t byte;
+    if (ps2_kbd_next(&kb, now, &byte)) {
+        pio_sm_put(PS2_DEVICE_PIO, sm, ps2_kbd_tx_word(byte));
+    }
+}
+
+// ============================================================================
+// DEVICE INIT
+// ============================================================================
+
+void ps2_device_init(void) {
+    // Claimed before router_init(), which leaves these slots alone
+    router_key_events_enable(OUTPUT_TARGET_PS2);
+    ps2_kbd_init(&kb, router_key_events_get(OUTPUT_TARGET_PS2, 0));
+
+    sm = pio_claim_unused_sm(PS2_DEVICE_PIO, true);
+    uint offset = pio_add_program(PS2_DEVICE_PIO, &ps2_device_program);
+    ps2_device_program_init(PS2_DEVICE_PIO, sm, offset, PS2_PIN_DATA, PS2_PIN_CLK);
+
+    printf("[ps2] Init complete — DATA=%d CLK=%d\n", PS2_PIN_DATA, PS2_PIN_CLK);
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+uint8_t ps2_device_get_leds(void) { return kb.leds; }
+
+// ============================================================================
+// OUTPUT INTERFACE
+// ============================================================================
+
+const OutputInterface ps2_output_interface = {
+    .name = "PS/2 Keyboard",
+    .target = OUTPUT_TARGET_PS2,
+    .init = ps2_device_init,
+    .task = ps2_device_task,
+    .core1_task = NULL,
+    .get_rumble = NULL,
+    .get_player_led = NULL,
+    .get_profile_count = NULL,
+    .get_active_profile = NULL,
+    .set_active_profile = NULL,
+    .get_profile_name = NULL,
+    .get_trigger_threshold = NULL,
+};
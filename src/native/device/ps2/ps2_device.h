@@ -0,0 +1,54 @@
+// ps2_device.h - PS/2 keyboard output for JoypadOS
+//
+// The adapter is a PS/2 keyboard toward a PC, a KVM or any machine with a
+// PS/2 port. The protocol lives in ps2_kbd.c; this file owns the pins and
+// the PIO, which does all of the bit timing (ps2_device.pio).
+//
+// Key presses come from the router's key event queue (player 0), so every
+// transition a USB or Bluetooth keyboard reports goes out in order, at the
+// wire's pace, however fast it was typed.
+//
+// DATA and CLK are open-collector lines pulled up to 5 V by the host: use a
+// level shifter (or at least series resistors) on the GPIOs.
+
+#ifndef PS2_DEVICE_H
+#define PS2_DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "core/output_interface.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#ifndef PS2_PIN_DATA
+#define PS2_PIN_DATA          2
+#endif
+#ifndef PS2_PIN_CLK
+#define PS2_PIN_CLK           3
+#endif
+
+// The program takes 30 of a PIO's 32 instructions; PIO0 keeps the NeoPixel
+#ifndef PS2_DEVICE_PIO
+#define PS2_DEVICE_PIO        pio1
+#endif
+
+#ifndef PS2_DEBUG
+#define PS2_DEBUG 0
+#endif
+
+// ============================================================================
+// API
+// ============================================================================
+
+void ps2_device_init(void);
+void ps2_device_task(void);
+
+// Keyboard LEDs last set by the host (bit 0 Scroll, 1 Num, 2 Caps)
+uint8_t ps2_device_get_leds(void);
+
+extern const OutputInterface ps2_output_interface;
+
+#endif // PS2_DEVICE_H
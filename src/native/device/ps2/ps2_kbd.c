@@ -0,0 +1,251 @@
+// ps2_kbd.c - PS/2 keyboard (device side) protocol for JoypadOS
+
+#include "ps2_kbd.h"
+
+// Host commands
+#define CMD_SET_LEDS            0xED
+#define CMD_ECHO                0xEE
+#define CMD_SCAN_CODE_SET       0xF0
+#define CMD_IDENTIFY            0xF2
+#define CMD_SET_TYPEMATIC       0xF3
+#define CMD_ENABLE              0xF4
+#define CMD_DISABLE             0xF5
+#define CMD_SET_DEFAULTS        0xF6
+#define CMD_RESEND              0xFE
+#define CMD_RESET               0xFF
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static void reply(ps2_kbd_t* kb, const uint8_t* bytes, uint8_t len)
+{
+    if (kb->in_flight && kb->in_flight_reply) kb->in_flight_stale = true;
+    for (uint8_t i = 0; i < len; i++) kb->reply[i] = bytes[i];
+    kb->reply_len = len;
+    kb->reply_pos = 0;
+}
+
+static void reply1(ps2_kbd_t* kb, uint8_t byte)
+{
+    reply(kb, &byte, 1);
+}
+
+static void set_defaults(ps2_kbd_t* kb)
+{
+    kb->typematic = PS2_KBD_TYPEMATIC_DEFAULT;
+    kb->repeat_usage = 0;
+}
+
+// Typematic delay and period from the F3 argument (IBM formulas)
+static uint32_t typematic_delay_us(const ps2_kbd_t* kb)
+{
+    return (uint32_t)(((kb->typematic >> 5) & 3) + 1) * 250000;
+}
+
+static uint32_t typematic_period_us(const ps2_kbd_t* kb)
+{
+    uint32_t a = kb->typematic & 7;
+    uint32_t b = (kb->typematic >> 3) & 3;
+    return (8 + a) * (1u << b) * 4167;
+}
+
+static bool is_repeatable(uint8_t usage)
+{
+    return usage != PS2_SET2_PAUSE && usage != PS2_SET2_PRINT_SCREEN;
+}
+
+// Encode the next mapped key event into scan[]
+static bool load_event(ps2_kbd_t* kb)
+{
+    key_event_t ev;
+    while (key_events_pop(kb->events, &ev)) {
+        uint8_t len = ps2_set2_encode(ev.usage, ev.pressed, kb->scan);
+        if (len == 0) continue;
+        kb->scan_len = len;
+        kb->scan_pos = 0;
+
+        // Real keyboards repeat the last key pressed until it's released
+        if (ev.pressed) {
+            kb->repeat_usage = is_repeatable(ev.usage) ? ev.usage : 0;
+            kb->repeat_at_us = 0;       // Armed once the make code is out
+        } else if (ev.usage == kb->repeat_usage) {
+            kb->repeat_usage = 0;
+        }
+        return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+void ps2_kbd_init(ps2_kbd_t* kb, key_events_t* events)
+{
+    kb->events = events;
+    kb->reply_len = kb->reply_pos = 0;
+    kb->scan_len = kb->scan_pos = 0;
+    kb->in_flight = false;
+    kb->in_flight_reply = false;
+    kb->in_flight_stale = false;
+    kb->last_sent = 0;
+    kb->command = 0;
+    kb->enabled = true;
+    kb->leds = 0;
+    set_defaults(kb);
+    reply1(kb, PS2_KBD_BAT_OK);
+}
+
+bool ps2_kbd_next(ps2_kbd_t* kb, uint32_t now_us, uint8_t* byte)
+{
+    if (kb->in_flight) return false;
+
+    if (kb->reply_pos < kb->reply_len) {
+        *byte = kb->reply[kb->reply_pos];
+        kb->in_flight_reply = true;
+    } else {
+        // Scan codes wait while disabled or while a command's argument is due
+        if (!kb->enabled || kb->command) return false;
+
+        if (kb->scan_pos >= kb->scan_len && !(kb->events && load_event(kb))) {
+            // Nothing new: typematic repeat of the held key
+            if (!kb->repeat_usage || !kb->repeat_at_us ||
+                (int32_t)(now_us - kb->repeat_at_us) < 0) {
+                return false;
+            }
+            kb->scan_len = ps2_set2_encode(kb->repeat_usage, true, kb->scan);
+            kb->scan_pos = 0;
+            kb->repeat_at_us = now_us + typematic_period_us(kb);
+            if (!kb->repeat_at_us) kb->repeat_at_us = 1;
+        }
+        *byte = kb->scan[kb->scan_pos];
+        kb->in_flight_reply = false;
+    }
+
+    kb->in_flight = true;
+    kb->in_flight_stale = false;
+    kb->in_flight_byte = *byte;
+    return true;
+}
+
+void ps2_kbd_sent(ps2_kbd_t* kb, bool ok, uint32_t now_us)
+{
+    if (!kb->in_flight) return;
+    kb->in_flight = false;
+    if (!ok) return;            // Inhibited mid-frame: same byte next time
+
+    // A Resend from the host after our own FE gets the byte before it
+    if (kb->in_flight_byte != PS2_KBD_RESEND) kb->last_sent = kb->in_flight_byte;
+    if (kb->in_flight_stale) return;
+    if (kb->in_flight_reply) {
+        kb->reply_pos++;
+        return;
+    }
+
+    kb->scan_pos++;
+    if (kb->scan_pos >= kb->scan_len && kb->repeat_usage && !kb->repeat_at_us) {
+        // Make code of a fresh press is out: start the typematic delay
+        kb->repeat_at_us = now_us + typematic_delay_us(kb);
+        if (!kb->repeat_at_us) kb->repeat_at_us = 1;
+    }
+}
+
+void ps2_kbd_host_byte(ps2_kbd_t* kb, uint8_t byte)
+{
+    // Resend doesn't cancel a command still waiting for its argument
+    if (byte == CMD_RESEND) {
+        reply1(kb, kb->last_sent);
+        return;
+    }
+
+    // Arguments are all below 0x80; anything else is a new command
+    if (kb->command && byte < 0x80) {
+        uint8_t command = kb->command;
+        kb->command = 0;
+
+        switch (command) {
+            case CMD_SET_LEDS:
+                kb->leds = byte & 0x07;
+                reply1(kb, PS2_KBD_ACK);
+                break;
+
+            case CMD_SET_TYPEMATIC:
+                kb->typematic = byte;
+                reply1(kb, PS2_KBD_ACK);
+                break;
+
+            case CMD_SCAN_CODE_SET:
+                if (byte == 0) {
+                    static const uint8_t current_set[] = { PS2_KBD_ACK, 0x02 };
+                    reply(kb, current_set, sizeof(current_set));
+                } else {
+                    reply1(kb, PS2_KBD_ACK);    // Stays on Set 2
+                }
+                break;
+        }
+        return;
+    }
+    kb->command = 0;
+
+    switch (byte) {
+        case CMD_RESET: {
+            static const uint8_t reset_reply[] = { PS2_KBD_ACK, PS2_KBD_BAT_OK };
+            // The host forgets every key; drop the sequence in progress too
+            if (kb->in_flight && !kb->in_flight_reply) kb->in_flight_stale = true;
+            kb->scan_len = kb->scan_pos = 0;
+            kb->enabled = true;
+            kb->leds = 0;
+            set_defaults(kb);
+            reply(kb, reset_reply, sizeof(reset_reply));
+            break;
+        }
+
+        case CMD_SET_DEFAULTS:
+            set_defaults(kb);
+            reply1(kb, PS2_KBD_ACK);
+            break;
+
+        case CMD_DISABLE:
+            set_defaults(kb);
+            kb->enabled = false;
+            reply1(kb, PS2_KBD_ACK);
+            break;
+
+        case CMD_ENABLE:
+            kb->enabled = true;
+            reply1(kb, PS2_KBD_ACK);
+            break;
+
+        case CMD_IDENTIFY: {
+            static const uint8_t id[] = { PS2_KBD_ACK, 0xAB, 0x83 };
+            reply(kb, id, sizeof(id));
+            break;
+        }
+
+        case CMD_ECHO:
+            reply1(kb, PS2_KBD_ECHO);
+            break;
+
+        case CMD_SET_LEDS:
+        case CMD_SET_TYPEMATIC:
+        case CMD_SCAN_CODE_SET:
+            kb->command = byte;
+            reply1(kb, PS2_KBD_ACK);
+            break;
+
+        default:
+            if (byte >= 0xF7) {
+                // Set 3 key type commands: acknowledged, no effect on Set 2
+                reply1(kb, PS2_KBD_ACK);
+            } else {
+                reply1(kb, PS2_KBD_RESEND);
+            }
+            break;
+    }
+}
+
+void ps2_kbd_host_error(ps2_kbd_t* kb)
+{
+    reply1(kb, PS2_KBD_RESEND);
+}
@@ -0,0 +1,118 @@
+// ps2_kbd.h - PS/2 keyboard (device side) protocol for JoypadOS
+//
+// What a PS/2 keyboard says and answers, with no pico-sdk dependency:
+// Set 2 scan codes from the router's key event queue, typematic repeat,
+// and the host commands a PC BIOS, DOS or Linux atkbd sends (reset,
+// identify, LEDs, typematic rate, scan code set, enable/disable, echo,
+// resend). ps2_device.c moves the bytes over the wire with ps2_device.pio.
+//
+// One byte is on the wire at a time. The caller takes it with
+// ps2_kbd_next() and reports back with ps2_kbd_sent(): a byte the host
+// inhibited mid-frame goes again. Command replies go out ahead of scan
+// codes; nothing is dropped from the key event queue, so a host that
+// disables scanning (F5) or is slow to read just gets the keys later.
+//
+// Only Set 2 is spoken: requests for Set 1 or 3 are acknowledged and the
+// keyboard stays on Set 2 (F0 00 reports 2), which is what PC keyboard
+// controllers translate from anyway.
+
+#ifndef PS2_KBD_H
+#define PS2_KBD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/router/key_events.h"
+#include "core/services/keymap/ps2_set2.h"
+
+// ============================================================================
+// PROTOCOL CONSTANTS
+// ============================================================================
+
+#define PS2_KBD_ACK             0xFA
+#define PS2_KBD_BAT_OK          0xAA    // Self-test passed (power-up, reset)
+#define PS2_KBD_ECHO            0xEE
+#define PS2_KBD_RESEND          0xFE
+
+#define PS2_KBD_TYPEMATIC_DEFAULT   0x2B    // 10.9 cps after 500 ms
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+typedef struct {
+    key_events_t* events;       // Router queue the scan codes come from
+
+    // Reply to the last host command, sent ahead of scan codes
+    uint8_t reply[4];
+    uint8_t reply_len;
+    uint8_t reply_pos;
+
+    // Scan code bytes of the key event being sent
+    uint8_t scan[PS2_SET2_MAX_BYTES];
+    uint8_t scan_len;
+    uint8_t scan_pos;
+
+    // Byte handed out by ps2_kbd_next() and not yet reported back
+    bool in_flight;
+    bool in_flight_reply;
+    bool in_flight_stale;       // Its reply or sequence was replaced meanwhile
+    uint8_t in_flight_byte;
+    uint8_t last_sent;          // For the host's Resend
+
+    uint8_t command;            // Command waiting for its argument, 0 = none
+    bool enabled;               // Scanning (F4 / F5)
+    uint8_t leds;               // Bit 0 Scroll, 1 Num, 2 Caps
+    uint8_t typematic;          // F3 argument
+
+    // Typematic repeat of the last key pressed
+    uint8_t repeat_usage;       // 0 = none
+    uint32_t repeat_at_us;
+} ps2_kbd_t;
+
+// Power-up state: scanning enabled, defaults, BAT OK (0xAA) queued
+void ps2_kbd_init(ps2_kbd_t* kb, key_events_t* events);
+
+// ============================================================================
+// WIRE SIDE
+// ============================================================================
+
+// Next byte to put on the wire, false if there's nothing to send (or a
+// byte is still in flight). now_us paces typematic repeat.
+bool ps2_kbd_next(ps2_kbd_t* kb, uint32_t now_us, uint8_t* byte);
+
+// Outcome of the byte from ps2_kbd_next(): sent, or aborted because the
+// host inhibited the clock before the last bit (sent again next time)
+void ps2_kbd_sent(ps2_kbd_t* kb, bool ok, uint32_t now_us);
+
+// Byte received from the host, framing already checked
+void ps2_kbd_host_byte(ps2_kbd_t* kb, uint8_t byte);
+
+// Host frame with bad parity or stop bit: ask for it again
+void ps2_kbd_host_error(ps2_kbd_t* kb);
+
+// ============================================================================
+// FRAMING (shared with ps2_device.pio)
+// ============================================================================
+
+// Device-to-host word: start, 8 data bits LSB first, odd parity, stop.
+// Each bit inverted, because the PIO drives pin directions (1 = pull low).
+static inline uint32_t ps2_kbd_tx_word(uint8_t byte)
+{
+    uint32_t parity = 1;
+    for (uint8_t b = byte; b; b >>= 1) parity ^= b & 1;
+    uint32_t frame = ((uint32_t)byte << 1) | (parity << 9) | (1u << 10);
+    return ~frame & 0x7FF;
+}
+
+// Host-to-device frame as the PIO pushes it: start bit in bit 21, data in
+// bits 22-29, parity in 30, stop in 31. False on a framing error.
+static inline bool ps2_kbd_rx_frame(uint32_t word, uint8_t* byte)
+{
+    uint8_t data = (uint8_t)(word >> 22);
+    uint32_t ones = (word >> 30) & 1;
+    for (uint8_t b = data; b; b >>= 1) ones += b & 1;
+    *byte = data;
+    return (word & (1u << 21)) == 0 && (word & (1u << 31)) && (ones & 1);
+}
+
+#endif // PS2_KBD_H
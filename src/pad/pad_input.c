@@ -10,6 +10,7 @@
 #include "core/buttons.h"
 #include "core/input_event.h"
 #include "core/router/router.h"
+#include "core/power.h"
 #include "platform/platform.h"
 #include "platform/platform_gpio.h"
 #include <stdio.h>
@@ -78,6 +79,14 @@ void pad_set_tilt_steer(int on, int range_deg, int dead_deg, int sign)
 static uint32_t pad_last_activity_ms = 0;
 uint32_t pad_input_last_activity_ms(void) { return pad_last_activity_ms; }
 
+// Scan period on event-driven ports (platform_loop_wake_in): every
+// millisecond while the pad is in use, PAD_IDLE_SCAN_MS once it has been
+// still for PAD_IDLE_AFTER_MS, so a resting controller doesn't hold the loop
+// at 1 kHz. Polling ports scan every pass regardless.
+#define PAD_SCAN_MS         1
+#define PAD_IDLE_SCAN_MS    10
+#define PAD_IDLE_AFTER_MS   2000
+
 // S1+S2 combo state
 static bool prev_s1s2_held = false;
 static bool combo_used = false;
@@ -265,6 +274,9 @@ static void pad_init_button_pin(int16_t pin, bool active_high) {
 
     // Pull opposite to active state
     platform_gpio_init_input(pin, !active_high);
+
+    // A press ends an idle power wait at once instead of on the next tick
+    power_wake_on_gpio((uint8_t)pin);
 }
 
 // Read a button pin and return true if pressed
@@ -678,7 +690,10 @@ static void pad_poll_device(uint8_t device_index) {
         int gmag = abs((int)gyro[0]) + abs((int)gyro[1]) + abs((int)gyro[2]);
         if (gmag > 1000) activity = true;   // pad being handled/rotated
     }
-    if (activity) pad_last_activity_ms = platform_time_ms();
+    if (activity) {
+        pad_last_activity_ms = platform_time_ms();
+        power_note_activity();
+    }
 
     // ---- Tilt steering: roll → a stick X axis ----
     // The gyro takes whichever stick the D-pad ISN'T using, so it never fights the
@@ -723,6 +738,10 @@ int pad_input_add_device(const pad_device_config_t* config) {
 
     pad_prev_buttons[index] = 0;
 
+    // Pad controllers are the battery builds: let the main loop idle between
+    // presses (activity and wake pins come from this module)
+    power_enable();
+
     pad_device_count++;
 
     return index;
@@ -800,6 +819,11 @@ static void pad_input_task(void) {
         // Submit to router (combo hotkeys applied there for all input sources)
         router_submit_input(&pad_events[i]);
     }
+
+    if (pad_device_count > 0) {
+        bool in_use = platform_time_ms() - pad_last_activity_ms < PAD_IDLE_AFTER_MS;
+        platform_loop_wake_in(in_use ? PAD_SCAN_MS : PAD_IDLE_SCAN_MS);
+    }
 }
 
 static bool pad_input_is_connected(void) {
@@ -53,6 +53,14 @@ void platform_sleep_ms(uint32_t ms) {
   while ((uint32_t)(platform_time_ms() - start) < ms) { /* busy-wait */ }
 }
 
+void platform_loop_wake(void) {
+  // Polling main loop - nothing to wake
+}
+
+void platform_loop_wake_in(uint32_t ms) {
+  (void)ms;  // Polling main loop - every pass runs anyway
+}
+
 // ============================================================================
 // IDENTITY — on-chip 96-bit unique ID
 // ============================================================================
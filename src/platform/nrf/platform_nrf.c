@@ -35,6 +35,9 @@ void platform_sleep_us(uint32_t us)
     k_busy_wait(us);
 }
 
+// platform_loop_wake() and platform_loop_wake_in() live in nrf/src/loop_nrf.c
+// with the I/O loop
+
 void platform_sleep_ms(uint32_t ms)
 {
     k_msleep(ms);
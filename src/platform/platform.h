@@ -30,6 +30,18 @@ void platform_sleep_ms(uint32_t ms);
 // Busy-wait for specified microseconds (does not yield to scheduler)
 void platform_sleep_us(uint32_t us);
 
+// Wake the main loop early. Event-driven ports (ESP32-S3, nRF52840) block between
+// loop passes until an event arrives; input, USB and interrupt paths call
+// this to end the wait. Polling ports implement it as a no-op. ISR-safe.
+void platform_loop_wake(void);
+
+// Ask for a main loop pass within `ms` even if no event arrives, for work due
+// at a time rather than on an event (animations, debounced writes, report
+// cadences, polled sensors). One-shot: the soonest request since the last
+// wait wins, so work that stays due asks again each pass. Main loop only.
+// Polling ports run a pass every iteration anyway and implement it as a no-op.
+void platform_loop_wake_in(uint32_t ms);
+
 // Get unique board serial string (hex)
 void platform_get_serial(char* buf, size_t len);
 
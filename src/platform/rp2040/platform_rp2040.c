@@ -7,6 +7,12 @@
 #include "pico/unique_id.h"
 #include "pico/bootrom.h"
 #include "hardware/watchdog.h"
+#include "hardware/clocks.h"
+#include "hardware/pll.h"
+#include "hardware/xosc.h"
+#include "hardware/structs/resets.h"
+#include "hardware/structs/usb.h"
+#include <stdio.h>
 #include <string.h>
 
 uint32_t platform_time_ms(void)
@@ -14,7 +20,8 @@ uint32_t platform_time_ms(void)
     return to_ms_since_boot(get_absolute_time());
 }
 
-uint32_t platform_time_us(void)
+// In RAM: router_get_output() reads it from core 1 while flash may be busy
+uint32_t __not_in_flash_func(platform_time_us)(void)
 {
     return time_us_32();
 }
@@ -29,6 +36,16 @@ void platform_sleep_us(uint32_t us)
     busy_wait_us(us);
 }
 
+void platform_loop_wake(void)
+{
+    // Polling main loop - nothing to wake
+}
+
+void platform_loop_wake_in(uint32_t ms)
+{
+    (void)ms;  // Polling main loop - every pass runs anyway
+}
+
 void platform_get_serial(char* buf, size_t len)
 {
     pico_get_unique_board_id_string(buf, len);
@@ -61,14 +78,47 @@ void platform_reboot_ota(void)
 
 bool platform_usb_powered(void)
 {
-    // VBUS detect not wired on most RP2040 boards — assume powered.
-    return true;
+    // No VBUS sense GPIO on most RP2040 boards, but the USB controller sees
+    // VBUS once it's running as a device. Otherwise assume powered.
+    if (resets_hw->reset & RESETS_RESET_USBCTRL_BITS) return true;
+    if (usb_hw->main_ctrl & USB_MAIN_CTRL_HOST_NDEVICE_BITS) return true;
+    return (usb_hw->sie_status & USB_SIE_STATUS_VBUS_DETECTED_BITS) != 0;
 }
 
 bool platform_deep_sleep(uint8_t wake_gpio, bool wake_active_high)
 {
-    (void)wake_gpio; (void)wake_active_high;
-    return false;
+    if (platform_usb_powered()) return false;
+
+    printf("[platform] Dormant, wake on GPIO %u %s\n", wake_gpio,
+           wake_active_high ? "high" : "low");
+    stdio_flush();
+
+    // Every other pad keeps its configuration (pulls, levels) through
+    // dormant; only the wake pin is set to idle away from its press level.
+    gpio_init(wake_gpio);
+    gpio_set_dir(wake_gpio, GPIO_IN);
+    gpio_set_pulls(wake_gpio, !wake_active_high, wake_active_high);
+    busy_wait_us(100);  // let the pull settle before arming the edge
+
+    // Everything on the crystal, then stop the PLLs. USB, PIO and the radio
+    // stop with them; wake is a full reboot, as on the other ports.
+    clock_configure(clk_ref, CLOCKS_CLK_REF_CTRL_SRC_VALUE_XOSC_CLKSRC, 0,
+                    XOSC_HZ, XOSC_HZ);
+    clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLK_REF, 0,
+                    XOSC_HZ, XOSC_HZ);
+    clock_stop(clk_usb);
+    clock_stop(clk_adc);
+    clock_stop(clk_peri);
+    pll_deinit(pll_sys);
+    pll_deinit(pll_usb);
+
+    gpio_set_dormant_irq_enabled(wake_gpio,
+        wake_active_high ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL, true);
+    xosc_dormant();  // returns on the edge
+
+    gpio_acknowledge_irq(wake_gpio, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+    platform_reboot();
+    return true;
 }
 
 uint32_t platform_last_reset_reason(void)
@@ -393,21 +393,24 @@ int mem_write32(uint32_t addr, uint32_t value) {
  * @return int 
  */
 static int mem_write_block_aligned(uint32_t addr, uint32_t count, const uint32_t *src) {
-    // Set auto-increment and the starting address...
+    // Set auto-increment...
     CHECK_OK(ap_mem_set_csw(AP_MEM_CSW_INC | AP_MEM_CSW_32));
-    CHECK_OK(ap_write(0, AP_MEM_TAR, addr));
 
     // We count in 32bit words...
     count >>= 2;
 
-    while(count--) {
-        CHECK_OK(ap_write(0, AP_MEM_DRW, *src++));
+    while(count) {
+        // Auto-increment only works within a 1k block, so each run stops at
+        // the next boundary and gets a fresh TAR
+        uint32_t run = MIN(count, (0x400 - (addr & 0x3ff)) >> 2);
 
-        // We need to track the address to deal with the 1k wrap limit
-        addr += 4;
-        if ((addr & 0x3ff) == 0) {
-            CHECK_OK(ap_write(0, AP_MEM_TAR, addr));
-        }
+        CHECK_OK(ap_write(0, AP_MEM_TAR, addr));
+        CHECK_OK(ap_select_with_bank(0, AP_MEM_DRW & 0xf0));
+        CHECK_OK(swd_write_block(1, AP_MEM_DRW & 0xc, src, run));
+
+        src += run;
+        addr += run << 2;
+        count -= run;
     }
     return SWD_OK;
 }
@@ -942,7 +945,20 @@ uint32_t rp2040_find_rom_func(char ch1, char ch2) {
 }
 
 
-int rp2040_call_function(uint32_t addr, uint32_t args[], int argc) {
+/**
+ * @brief Start a function on the (halted) target and return straight away
+ * 
+ * The core runs with interrupts masked until the function returns into the
+ * trampoline end and halts. Memory writes through the AP are fine while it
+ * runs, so the caller can stage the next lot of data in the meantime, then
+ * pick up the result with rp2040_call_wait().
+ * 
+ * @param addr 
+ * @param args 
+ * @param argc 
+ * @return int 
+ */
+int rp2040_call_start(uint32_t addr, uint32_t args[], int argc) {
     static uint32_t trampoline_addr = 0;
     static uint32_t trampoline_end;
     int rc;
@@ -992,30 +1008,31 @@ int rp2040_call_function(uint32_t addr, uint32_t args[], int argc) {
 
     // Now can we continue and just wait for a halt?
 //    core_unhalt();
-    core_unhalt_with_masked_ints();
+    return core_unhalt_with_masked_ints();
+}
+
+/**
+ * @brief Wait for a function started with rp2040_call_start() to finish
+ * 
+ * @param result r0 on return (can be NULL)
+ * @return int 
+ */
+int rp2040_call_wait(uint32_t *result) {
+    int rc;
+
     while(1) {
-        busy_wait_ms(2);
         rc = core_is_halted();
         if (rc == -1) panic("here");
         if (rc) break;
+        busy_wait_ms(2);
     }
+    if (result) return reg_read(0, result);
+    return SWD_OK;
+}
 
-
-/*
-    // Bloody hell if we get here!
-    uint32_t regs[5];
-
-    for (int i=0; i < 5; i++) {
-        rc = reg_read(i, &regs[i]);
-        if (rc != SWD_OK) return rc;
-    }
-
-    // What is our pc
-    uint32_t pc;
-    rc = reg_read(15, &pc);
-    if (rc != SWD_OK) return rc;
-    */
-   return SWD_OK;
+int rp2040_call_function(uint32_t addr, uint32_t args[], int argc) {
+    CHECK_OK(rp2040_call_start(addr, args, argc));
+    return rp2040_call_wait(NULL);
 }
 
 
@@ -58,6 +58,8 @@ int core_get_reason(int num);
 
 uint32_t rp2040_find_rom_func(char ch1, char ch2);
 int rp2040_call_function(uint32_t addr, uint32_t args[], int argc);
+int rp2040_call_start(uint32_t addr, uint32_t args[], int argc);
+int rp2040_call_wait(uint32_t *result);
 
 int reg_read(int reg, uint32_t *res);
 int reg_write(int reg, uint32_t value);
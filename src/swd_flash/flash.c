@@ -9,19 +9,22 @@
  * 
  * Routines that support flash programming on RP2040 based devices.
  * 
- * This includes an algorithm that should optmise the flash programming times
- * by balancing erase and programming block sizes with actual deltas in the
- * code.
+ * The image comes pre-split into 4k sectors by tools/bin2flashimage.py,
+ * each with a CRC32 and stored compressed (or raw, or not at all if blank).
  * 
  * Basic approach:
  * 
- * 1. Copy over stuff in up to 64k chunks
- * 2. Go throug the 64k chunk and compare it in 4k blocks with existing image
- * 3. If more than 2 x 4k blocks need programming then do the whole thing
- * 4. Otherwise do the 4k block individually
+ * 1. Have the target CRC every sector it already holds, and skip the ones
+ *    that match
+ * 2. Pack the changed sectors (still compressed) into 32k batches, and
+ *    alternate between two batch buffers on the target: while it decodes,
+ *    erases and programs one batch, the next is streamed into the other
+ * 3. Where a whole 64k (or 32k) block changes, erase it in one go
+ * 4. CRC everything again at the end, so a bad transfer shows up as an
+ *    error (and a retry) rather than a bricked B side
  * 
- * But this algorithm really needs to run on the remote device so we need
- * to produce some relocatable code to do it.
+ * The target side of this runs from RAM so it lives in its own section and
+ * is copied over before we start.
  * 
  */
 
@@ -34,126 +37,267 @@
 
 #include "adi.h"
 
-#define FOR_TARGET          __attribute__((noinline, section("for_target")))
-#define DATA_BUFFER         0x20000000
+// Target code must be position independent: no globals, no const tables and
+// no library calls (so stop gcc turning copy loops into memcpy).
+#define FOR_TARGET          __attribute__((noinline, section("for_target"), \
+                                           optimize("no-tree-loop-distribute-patterns")))
+
+#define BATCH_BUFFER_0      0x20000000
+#define BATCH_BUFFER_1      0x20008000
+#define BATCH_BUFFER_SIZE   32768
 #define CODE_START          0x20010000
 #define BOOT2_START         0x20020000
+#define DECODE_BUFFER       0x20021000
+#define CRC_TABLE           0x20022000
+#define CRC_RESULTS         0x20023000
 #define STACK_ADDDR         0x20040800
 #define FLASH_BASE          0x10000000
 
-static int flash_code_copied = 0;
+#define FLASH_BATCH_MAX     32
+
+// Batch entry flags (on top of FLASH_SECTOR_*)
+#define BATCH_ERASE_64K     (1 << 8)        // erase the whole 64k block first
+#define BATCH_ERASE_32K     (1 << 9)        // erase the whole 32k block first
+#define BATCH_NO_ERASE      (1 << 10)       // already erased by a block erase
+
+/**
+ * @brief A batch as laid out at the start of a target batch buffer, the
+ *        sector data follows it (each one word aligned)
+ */
+typedef struct {
+    uint32_t    offset;         // flash offset of the sector
+    uint16_t    length;         // stored length
+    uint16_t    flags;          // FLASH_SECTOR_* | BATCH_*
+} flash_batch_entry_t;
+
+typedef struct {
+    uint32_t            count;
+    flash_batch_entry_t entry[FLASH_BATCH_MAX];
+} flash_batch_t;
+
+// What we plan to do with each sector
+enum {
+    PLAN_SKIP = 0,
+    PLAN_ERASE_4K,
+    PLAN_ERASE_32K,
+    PLAN_ERASE_64K,
+    PLAN_NO_ERASE,
+};
+
+FOR_TARGET int crc_sectors(uint32_t offset, uint32_t count, uint32_t *out);
+FOR_TARGET int program_batch(flash_batch_t *batch);
+
+static const uint32_t batch_buffer[2] = { BATCH_BUFFER_0, BATCH_BUFFER_1 };
+
+/**
+ * @brief Where a target function ends up once the section is copied over
+ * 
+ * @param fn 
+ * @return uint32_t 
+ */
+static uint32_t target_addr(void *fn) {
+    extern char __start_for_target[];
+
+    return CODE_START + (uint32_t)((uintptr_t)fn - (uintptr_t)__start_for_target);
+}
 
 /**
- * @brief Called once the block is already on the target
+ * @brief Copy the target code and the image's boot2 over
  * 
- * This will copy over the code (if needed) and execute the remote function
+ * The boot2 copy is what the target uses to get the flash back into fast
+ * XIP mode for reading (CRCs) after erasing and programming.
  * 
- * @param offset 
- * @param length 
+ * @param image 
  * @return int 
  */
-static int rp2040_program_flash_chunk(int offset, int length) {
+static int rp2040_copy_flash_code(const flash_image_t *image) {
     extern char __start_for_target[];
     extern char __stop_for_target[];
-    int rc;
+    int code_len = (__stop_for_target - __start_for_target);
+
+    printf("FLASH: Copying custom flash code to 0x%08x (%d bytes)\r\n", CODE_START, code_len);
+    CHECK_OK(mem_write_block(CODE_START, code_len, (uint8_t *)__start_for_target));
+    return mem_write_block(BOOT2_START, 256, image->boot2);
+}
 
-    printf("FLASH: Request to flash 0x%08x (len=%d)\r\n", offset, length);
+/**
+ * @brief Have the target CRC count sectors of its flash, from sector first
+ * 
+ * @param first 
+ * @param count 
+ * @param crcs 
+ * @return int 
+ */
+static int rp2040_read_crcs(uint32_t first, uint32_t count, uint32_t *crcs) {
+    uint32_t args[] = { first * FLASH_SECTOR_SIZE, count, CRC_RESULTS };
+    uint32_t r0;
+
+    CHECK_OK(rp2040_call_start(target_addr(crc_sectors), args, 3));
+    CHECK_OK(rp2040_call_wait(&r0));
+    if (r0 != count) return SWD_ERROR;
+    return mem_read_block(CRC_RESULTS, count * 4, (uint8_t *)crcs);
+}
+
+/**
+ * @brief Work out which sectors need programming and how to erase them
+ * 
+ * @param image 
+ * @param crcs 
+ * @param plan 
+ * @return uint32_t number of sectors to program
+ */
+static uint32_t rp2040_plan_sectors(const flash_image_t *image, const uint32_t *crcs, uint8_t *plan) {
+    uint32_t changed = 0;
 
-    // Copy the code over ... only needed once per flashing cycle...
+    for (uint32_t i = 0; i < image->sector_count; i++) {
+        plan[i] = (crcs[i] == image->sectors[i].crc) ? PLAN_SKIP : PLAN_ERASE_4K;
+        if (plan[i] != PLAN_SKIP) changed++;
+    }
 
-    if (!flash_code_copied) {
-        int code_len = (__stop_for_target - __start_for_target);
-        printf("FLASH: Copying custom flash code to 0x%08x (%d bytes)\r\n", CODE_START, code_len);
-        rc = mem_write_block(CODE_START, code_len, (uint8_t *)__start_for_target);
-        if (rc != SWD_OK) return rc;
-        flash_code_copied = 1;
+    // If every sector of a 64k (or failing that 32k) block changes then one
+    // block erase is much quicker than individual sector erases
+    for (uint32_t block = 0; block + 8 <= image->sector_count; block += 8) {
+        uint32_t size = ((block & 15) == 0 && block + 16 <= image->sector_count) ? 16 : 8;
+        int all = 1;
+        for (uint32_t i = 0; i < size; i++) {
+            if (plan[block + i] != PLAN_ERASE_4K) all = 0;
+        }
+        if (!all && size == 16) {
+            size = 8;
+            all = 1;
+            for (uint32_t i = 0; i < size; i++) {
+                if (plan[block + i] != PLAN_ERASE_4K) all = 0;
+            }
+        }
+        if (!all) continue;
+        plan[block] = (size == 16) ? PLAN_ERASE_64K : PLAN_ERASE_32K;
+        for (uint32_t i = 1; i < size; i++) plan[block + i] = PLAN_NO_ERASE;
+        block += size - 8;
     }
+    return changed;
+}
 
-    uint32_t t = time_us_32();
+/**
+ * @brief Fill a target batch buffer with the next changed sectors
+ * 
+ * @param image 
+ * @param plan 
+ * @param next      first sector to consider, updated to where we stopped
+ * @param buffer    target address of the batch buffer
+ * @param batch     host copy of the batch header
+ * @return int 
+ */
+static int rp2040_stage_batch(const flash_image_t *image, const uint8_t *plan, uint32_t *next,
+                              uint32_t buffer, flash_batch_t *batch) {
+    uint32_t pos = sizeof(flash_batch_t);
+    uint32_t i;
 
-    uint32_t args[] = { offset, DATA_BUFFER, length };
-    rc = rp2040_call_function(CODE_START, args, sizeof(args)/sizeof(uint32_t));
-    if (rc != SWD_OK) return rc;
+    batch->count = 0;
+    for (i = *next; i < image->sector_count && batch->count < FLASH_BATCH_MAX; i++) {
+        if (plan[i] == PLAN_SKIP) continue;
 
-    uint32_t r0, erased, programmed;
-    rc = reg_read(0, &r0);
+        const flash_sector_t *sector = &image->sectors[i];
+        uint32_t stored = (sector->length + 3) & ~3;
+        if (pos + stored > BATCH_BUFFER_SIZE) break;
 
-    erased = (r0 >> 24) * 4;
-    programmed = r0 & 0x00ffffff;
+        if (stored) {
+            CHECK_OK(mem_write_block(buffer + pos, stored, image->data + sector->offset));
+        }
 
-    printf("FLASH: Erased %luk and programmed %lu bytes in %lums\r\n", erased, programmed, (time_us_32() - t)/1000);
+        flash_batch_entry_t *entry = &batch->entry[batch->count++];
+        entry->offset = i * FLASH_SECTOR_SIZE;
+        entry->length = sector->length;
+        entry->flags = sector->flags;
+        if (plan[i] == PLAN_ERASE_64K) entry->flags |= BATCH_ERASE_64K;
+        if (plan[i] == PLAN_ERASE_32K) entry->flags |= BATCH_ERASE_32K;
+        if (plan[i] == PLAN_NO_ERASE) entry->flags |= BATCH_NO_ERASE;
+        pos += stored;
+    }
+    *next = i;
 
-    return 0;
+    if (!batch->count) return SWD_OK;
+    return mem_write_block(buffer, 4 + batch->count * sizeof(flash_batch_entry_t), (uint8_t *)batch);
 }
 
 /**
- * @brief Add some data to the existing flash chunk
+ * @brief Wait for the batch running on the target and check it all went in
  * 
- * This will add data (and copy it to the target) up to 64k, then it will
- * call rp2040_program_flash_chunk() to actually do the programming.
+ * @param count 
+ * @return int 
+ */
+static int rp2040_finish_batch(uint32_t count) {
+    uint32_t r0;
+
+    CHECK_OK(rp2040_call_wait(&r0));
+    if (r0 != count) {
+        printf("FLASH: batch failed (r0=0x%08lx, expected %lu)\r\n", r0, count);
+        return SWD_ERROR;
+    }
+    return SWD_OK;
+}
+
+/**
+ * @brief Bring the target flash in line with the image
  * 
- * If we call this with a high offset and zero size then it will cause
- * any residual chunk to be written out.
+ * Returns zero once every sector's CRC matches the image, so the caller can
+ * retry the whole thing (possibly at a slower SWD clock) otherwise.
  * 
- * @param offset 
- * @param src 
- * @param size 
+ * @param image 
  * @return int 
  */
-static uint32_t     chunk_start = 0;        // flash address of the start
-static uint32_t     chunk_size = 0;         // how much is already done
+int rp2040_flash_image(const flash_image_t *image) {
+    static uint32_t     crcs[FLASH_MAX_SECTORS];
+    static uint8_t      plan[FLASH_MAX_SECTORS];
+    static flash_batch_t batch;
+    uint32_t            count = image->sector_count;
 
-int rp2040_add_flash_bit(uint32_t offset, const uint8_t *src, int size) {
-    int rc;
+    if (count > FLASH_MAX_SECTORS) return SWD_ERROR;
 
-    printf("FLASH: writing %d bytes to flash at 0x%08lx\r\n", size, offset);
+    uint32_t t = time_us_32();
 
+    CHECK_OK(rp2040_copy_flash_code(image));
+    CHECK_OK(rp2040_read_crcs(0, count, crcs));
+    uint32_t changed = rp2040_plan_sectors(image, crcs, plan);
 
-    // If we are starting outside the range of an existing block...
-    if (chunk_size && (offset >= (chunk_start + 65536))) {
-        rp2040_program_flash_chunk(chunk_start, chunk_size);
-        chunk_size = 0;
-    }
+    printf("FLASH: %lu of %lu sectors changed (%lums)\r\n", changed, count, (time_us_32() - t)/1000);
 
-    // If size is zero here then we are the last bit...
-    if (size == 0) {
-        flash_code_copied = 0;
-        return 0;
-    }
+    // Stage the next batch while the target programs the previous one...
+    uint32_t next = 0;
+    uint32_t in_flight = 0;
+    int buf = 0;
+
+    while (1) {
+        CHECK_OK(rp2040_stage_batch(image, plan, &next, batch_buffer[buf], &batch));
 
-    while (size) {
-        // If we are a new chunk...
-        if (chunk_size == 0) {
-            chunk_start = offset;
+        if (in_flight) {
+            CHECK_OK(rp2040_finish_batch(in_flight));
+            in_flight = 0;
         }
-        // Now how much can we fit in...
-        int space = 65536 - chunk_size;
-        int count = MIN(space, size);
+        if (!batch.count) break;
 
-        // Let's copy it over...
-        uint32_t t = time_us_32();
+        uint32_t args[] = { batch_buffer[buf] };
+        CHECK_OK(rp2040_call_start(target_addr(program_batch), args, 1));
+        in_flight = batch.count;
+        buf ^= 1;
+    }
 
-        rc = mem_write_block(DATA_BUFFER + (offset - chunk_start), count, src);
-        if (rc != SWD_OK) {
-            printf("COPY FAILED: %d\r\n", rc);
-            return 1;;
-        }
-        printf("FLASH: Copied %d bytes to location 0x%08lx (%lu ms)\r\n", count, DATA_BUFFER+(offset-chunk_start),
-                                                                            (time_us_32() - t)/1000);
-        chunk_size += count;
-
-        // If we have a full one...
-        if (chunk_size == 65536) {
-            rp2040_program_flash_chunk(chunk_start, chunk_size);
-            chunk_size = 0;
+    // Now make sure it all went in (only the range we touched needs a look)...
+    uint32_t first = 0, last = 0, bad = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (plan[i] == PLAN_SKIP) continue;
+        if (!last) first = i;
+        last = i + 1;
+    }
+    if (last) {
+        CHECK_OK(rp2040_read_crcs(first, last - first, crcs + first));
+        for (uint32_t i = first; i < last; i++) {
+            if (crcs[i] != image->sectors[i].crc) bad++;
         }
-
-        // Now process the remainder...
-        offset += count;
-        size -= count;
-        src += count;
     }
-    return 0;
+
+    printf("FLASH: Programmed %lu sectors in %lums, %lu failed verify\r\n", changed,
+                                                    (time_us_32() - t)/1000, bad);
+    return bad ? SWD_ERROR : SWD_OK;
 }
 
 // -----------------------------------------------------------------------------------
@@ -163,14 +307,25 @@ int rp2040_add_flash_bit(uint32_t offset, const uint8_t *src, int size) {
 //
 // Memory Map on target for programming:
 //
-// 0x2000 0000      64K incoming data buffer
+// 0x2000 0000      32K batch buffer 0
+// 0x2000 8000      32K batch buffer 1
 // 0x2001 0000      start of code
 // 0x2002 0000      stage2 bootloader copy
+// 0x2002 1000      4K sector decode buffer
+// 0x2002 2000      CRC32 table
+// 0x2002 3000      CRC results (one word per sector)
 // 0x2004 0800      top of stack 
 //
 
 
+// Both can be overridden to run the target side against a model of the
+// ROM and boot2 (tools/swd-flash-sim)
+#ifndef rom_hword_as_ptr
 #define rom_hword_as_ptr(rom_address) (void *)(uintptr_t)(*(uint16_t *)rom_address)
+#endif
+#ifndef BOOT2_ENTRY
+#define BOOT2_ENTRY         (BOOT2_START + 1)       // thumb bit set
+#endif
 #define fn(a, b)        (uint32_t)((b << 8) | a)
 typedef void *(*rom_table_lookup_fn)(uint16_t *table, uint32_t code);
 
@@ -178,119 +333,138 @@ typedef void *(*rom_void_fn)(void);
 typedef void *(*rom_flash_erase_fn)(uint32_t addr, size_t count, uint32_t block_size, uint8_t block_cmd);
 typedef void *(*rom_flash_prog_fn)(uint32_t addr, const uint8_t *data, size_t count);
 
-FOR_TARGET int flash_block(uint32_t offset, uint8_t *src, int length) {
-    // Fill in the rom functions...
+typedef struct {
+    rom_void_fn         connect_internal_flash;
+    rom_void_fn         flash_exit_xip;
+    rom_flash_erase_fn  flash_range_erase;
+    rom_flash_prog_fn   flash_range_program;
+    rom_void_fn         flash_flush_cache;
+} target_rom_t;
+
+FOR_TARGET static void target_rom_lookup(target_rom_t *rom) {
     rom_table_lookup_fn rom_table_lookup = (rom_table_lookup_fn)rom_hword_as_ptr(0x18);
     uint16_t            *function_table = (uint16_t *)rom_hword_as_ptr(0x14);
 
-    rom_void_fn         _connect_internal_flash = rom_table_lookup(function_table, fn('I', 'F'));
-    rom_void_fn         _flash_exit_xip = rom_table_lookup(function_table, fn('E', 'X'));
-    rom_flash_erase_fn  _flash_range_erase = rom_table_lookup(function_table, fn('R', 'E'));
-    rom_flash_prog_fn   flash_range_program = rom_table_lookup(function_table, fn('R', 'P'));
-    rom_void_fn         _flash_flush_cache = rom_table_lookup(function_table, fn('F', 'C'));
-    rom_void_fn         _flash_enter_cmd_xip = rom_table_lookup(function_table, fn('C', 'X'));
-
-    // We want to make sure the flash is connected so that we can compare
-    // with it's current contents...
-
-    _connect_internal_flash();
-//    _flash_flush_cache();
-//    _flash_enter_cmd_xip();     // would be better to call the boot stage2 to speed things up
-    _flash_exit_xip();
-
-    // If we are being called with a zero offset, then the block will include the bootloader
-    // so we can just copy it to use later...
-    if (offset == 0) {
-        uint32_t *s = (uint32_t *)src;
-        uint32_t *d = (uint32_t *)BOOT2_START;
-        for (int i=0; i < 64; i++) {
-            *d++ = *s++;
-        }
-    }
-    // Call the second stage bootloader... reconnect XIP
-    ((void (*)(void))BOOT2_START+1)();
-
-    // Now lets get started...
-    uint8_t     *changed[3];
-    int         change_count = 0;
-
-    // Go through in 4k chunks seeing if we have deltas...
-    uint8_t     *src_block = src;
-    uint8_t     *dst_block = (uint8_t *)(FLASH_BASE + offset);
-    int         left = length;
-
-
-    while(left > 0) {
-        // Look at this block...
-        uint8_t *s = src_block;
-        uint8_t *d = dst_block;
-        int size = MIN(4096, left);
-        for (int i=0; i < size; i++) {
-            if (*s++ != *d++) {
-                changed[change_count++] = src_block;
-                break;
-            }
-        }
-        if (change_count > 2) break;
-        src_block += 4096;
-        dst_block += 4096;
-        left -= 4096;
-    }
-    if (!change_count) return 0;        // nothing to do
-
-    // turn off xip so we can do stuff...
-    //_connect_internal_flash();      // do we need this?
-    _flash_exit_xip();
-
-    // We will return the number of 4k blocks erased, and the size flashed in this...
-    uint32_t rc = 0;
-
-    if (change_count <= 2) {
-
-        // Program the individual blocks...
-        for (int i = 0; i < change_count; i++) {
-            uint8_t *block = changed[i];
-            uint32_t faddr = offset + (block - src);
-            uint32_t size = MIN(4096, length-offset);
-    
-            // erase 4k
-            // program 4k
-            _flash_range_erase(faddr, 4096, 4096, 0x20);      // sector erase (4K)
-            flash_range_program(faddr, block, size);
-            rc += size;
-        }
-        // reconnect xip
-        _flash_flush_cache();
-//        _flash_enter_cmd_xip();
-        // Call the second stage bootloader... reconnect XIP
-        ((void (*)(void))BOOT2_START+1)();
-        return (change_count << 24) | rc;
-    }
-    
-    // Otherwise we program the whole thing... either 32K (if less than that) or all 64k
-    if (length <= 32768) {
-        _flash_range_erase(offset, 32768, 32768, 0x52); // 32K erase
-        rc = 0x08000000 | length;
-    } else {
-        _flash_range_erase(offset, 65536, 65536, 0xD8); // 64K erase
-        rc = 0x10000000 | length;
-    }
-    // program everything...
-    flash_range_program(offset, src, length);
-    // reconnect xip
-    _flash_flush_cache();
-//    _flash_enter_cmd_xip();
-    // Call the second stage bootloader... reconnect XIP
-    ((void (*)(void))BOOT2_START+1)();
+    rom->connect_internal_flash = rom_table_lookup(function_table, fn('I', 'F'));
+    rom->flash_exit_xip = rom_table_lookup(function_table, fn('E', 'X'));
+    rom->flash_range_erase = rom_table_lookup(function_table, fn('R', 'E'));
+    rom->flash_range_program = rom_table_lookup(function_table, fn('R', 'P'));
+    rom->flash_flush_cache = rom_table_lookup(function_table, fn('F', 'C'));
+}
 
-    return rc;
+/**
+ * @brief Flush the XIP cache and call the copy of the second stage
+ *        bootloader to get fast XIP reads back
+ */
+FOR_TARGET static void target_xip_enable(target_rom_t *rom) {
+    rom->flash_flush_cache();
+    ((void (*)(void))(BOOT2_ENTRY))();
 }
 
+/**
+ * @brief CRC32 (zlib polynomial) each of count sectors starting at offset
+ * 
+ * The table is built in RAM each time since we can't carry const data.
+ */
+FOR_TARGET int crc_sectors(uint32_t offset, uint32_t count, uint32_t *out) {
+    target_rom_t    rom;
+    uint32_t        *table = (uint32_t *)CRC_TABLE;
 
+    target_rom_lookup(&rom);
 
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : (c >> 1);
+        }
+        table[i] = c;
+    }
 
+    rom.connect_internal_flash();
+    rom.flash_exit_xip();
+    target_xip_enable(&rom);
 
+    const uint8_t *p = (const uint8_t *)(uintptr_t)(FLASH_BASE + offset);
+    for (uint32_t s = 0; s < count; s++) {
+        uint32_t crc = 0xffffffff;
+        for (int i = 0; i < FLASH_SECTOR_SIZE; i++) {
+            crc = table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+        }
+        out[s] = ~crc;
+    }
+    return count;
+}
 
+/**
+ * @brief Decode one sector's LZ stream (format in tools/bin2flashimage.py)
+ * 
+ * @return int bytes decoded, or -1 if the stream is bad
+ */
+FOR_TARGET static int lz_decode(const uint8_t *src, uint32_t length, uint8_t *dst) {
+    const uint8_t   *end = src + length;
+    uint8_t         *out = dst;
+    uint8_t         *out_end = dst + FLASH_SECTOR_SIZE;
+
+    while (src < end) {
+        uint32_t t = *src++;
+
+        if (t < 0x80) {
+            uint32_t n = t + 1;
+            if (src + n > end || out + n > out_end) return -1;
+            while (n--) *out++ = *src++;
+        } else {
+            uint32_t n = (t & 0x7f) + 3;
+            if (src + 2 > end) return -1;
+            uint32_t dist = src[0] | (src[1] << 8);
+            src += 2;
+            if (dist == 0 || dist > (uint32_t)(out - dst) || out + n > out_end) return -1;
+            const uint8_t *from = out - dist;
+            while (n--) *out++ = *from++;
+        }
+    }
+    return out - dst;
+}
 
+/**
+ * @brief Decode, erase and program every sector in a batch
+ * 
+ * @return int the number of sectors done, or 0x80000000 | index of a
+ *         sector that wouldn't decode
+ */
+FOR_TARGET int program_batch(flash_batch_t *batch) {
+    target_rom_t    rom;
+    const uint8_t   *payload = (const uint8_t *)(batch + 1);
+
+    target_rom_lookup(&rom);
+    rom.connect_internal_flash();
+    rom.flash_exit_xip();
+
+    for (uint32_t i = 0; i < batch->count; i++) {
+        flash_batch_entry_t *entry = &batch->entry[i];
+        const uint8_t       *data = payload;
+
+        if (!(entry->flags & (FLASH_SECTOR_RAW | FLASH_SECTOR_BLANK))) {
+            if (lz_decode(payload, entry->length, (uint8_t *)DECODE_BUFFER) != FLASH_SECTOR_SIZE) {
+                target_xip_enable(&rom);
+                return 0x80000000 | i;
+            }
+            data = (const uint8_t *)DECODE_BUFFER;
+        }
 
+        if (entry->flags & BATCH_ERASE_64K) {
+            rom.flash_range_erase(entry->offset, 65536, 65536, 0xD8);     // block erase (64K)
+        } else if (entry->flags & BATCH_ERASE_32K) {
+            rom.flash_range_erase(entry->offset, 32768, 32768, 0x52);     // block erase (32K)
+        } else if (!(entry->flags & BATCH_NO_ERASE)) {
+            rom.flash_range_erase(entry->offset, 4096, 4096, 0x20);       // sector erase (4K)
+        }
+        if (!(entry->flags & FLASH_SECTOR_BLANK)) {
+            rom.flash_range_program(entry->offset, data, FLASH_SECTOR_SIZE);
+        }
+        payload += (entry->length + 3) & ~3;
+    }
 
+    // reconnect xip
+    target_xip_enable(&rom);
+    return batch->count;
+}
@@ -1,9 +1,29 @@
-
 #ifndef __FLASH_H
 #define __FLASH_H
 
 #include <stdint.h>
 
-int rp2040_add_flash_bit(uint32_t offset, const uint8_t *src, int size);
+#define FLASH_SECTOR_SIZE       4096
+#define FLASH_MAX_SECTORS       512             // 2MB of flash
+
+// Sector flags (as emitted by tools/bin2flashimage.py)
+#define FLASH_SECTOR_RAW        (1 << 0)        // stored uncompressed
+#define FLASH_SECTOR_BLANK      (1 << 1)        // all 0xff, nothing stored
+
+typedef struct {
+    uint32_t    crc;            // CRC32 of the (0xff padded) sector
+    uint32_t    offset;         // start of the stored data in the image data
+    uint16_t    length;         // stored length (0 for blank, 4096 for raw)
+    uint16_t    flags;
+} flash_sector_t;
+
+typedef struct {
+    const uint8_t           *data;
+    const flash_sector_t    *sectors;
+    uint32_t                sector_count;
+    const uint8_t           *boot2;         // raw first 256 bytes of the image
+} flash_image_t;
+
+int rp2040_flash_image(const flash_image_t *image);
 
 #endif
@@ -18,7 +18,7 @@
 #include <hardware/sync.h>
 #include <hardware/watchdog.h>
 
-#include "dual_b_binary.h"
+#include "dual_b_image.h"
 #include "adi.h"
 #include "flash.h"
 #include "swd.h"
@@ -47,17 +47,28 @@ int main(void) {
     core_reset_halt();
     core_select(0);
 
-    // Write B's flash from the embedded image, retrying the whole sequence if
-    // the SWD transfer errors (marginal links can fail mid-bulk-transfer).
+    // Bring B's flash in line with the embedded image. Only sectors whose CRC
+    // differs are sent, and everything is CRC-checked afterwards, so a bulk
+    // transfer corrupted by the faster SWD clock shows up as a failure: retry
+    // the whole sequence at the safe clock (marginal links can also fail
+    // mid-bulk-transfer).
+    const flash_image_t image = {
+        .data = dual_b_data,
+        .sectors = dual_b_sectors,
+        .sector_count = dual_b_sector_count,
+        .boot2 = dual_b_boot2,
+    };
+
     for (int tries = 0; tries < 4; tries++) {
-        int wrc = rp2040_add_flash_bit(0, dual_b_binary, dual_b_binary_length);
-        rp2040_add_flash_bit(0xffffffff, NULL, 0);
-        if (wrc == 0) break;
+        swd_set_clkdiv(tries == 0 ? SWD_CLKDIV_FAST : SWD_CLKDIV_SAFE);
+        if (rp2040_flash_image(&image) == 0) break;
         // Re-establish the debug connection before retrying.
+        swd_set_clkdiv(SWD_CLKDIV_SAFE);
         dp_init();
         core_select(0);
         core_reset_halt();
     }
+    swd_set_clkdiv(SWD_CLKDIV_SAFE);
 
     // Reboot B (the freshly-flashed target), then reboot ourselves (A) so the
     // bootloader hands control to A's flash image.
@@ -85,17 +85,29 @@ int swd_init() {
     // And initialise
     pio_sm_init(pio, swd_sm, 0, &c);    // 0=offset
 
-    // SWD clock divider. The flash relay runs once at install time, so we trade
-    // speed for reliability: divider 16 => ~4 MHz at 125 MHz sys clock. The
-    // upstream value of 3 (~20 MHz) was marginal on this board (bulk transfers
-    // corrupted), so go conservative.
+    // SWD clock divider. We always start at the safe rate: divider 16 => ~4 MHz
+    // at 125 MHz sys clock. The upstream value of 3 (~20 MHz) was marginal on
+    // this board (bulk transfers corrupted). Callers that verify what they
+    // wrote can step up with swd_set_clkdiv(SWD_CLKDIV_FAST).
     //pio_sm_set_clkdiv_int_frac(pio, swd_sm, 3, 0);   // ~20 MHz (upstream, marginal)
-    pio_sm_set_clkdiv_int_frac(pio, swd_sm, 16, 0);    // ~4 MHz (safe)
+    pio_sm_set_clkdiv_int_frac(pio, swd_sm, SWD_CLKDIV_SAFE, 0);
 
     pio_sm_set_enabled(swd_pio, swd_sm, true);
     return SWD_OK;
 }
 
+/**
+ * @brief Change the SWD clock divider
+ * 
+ * The state machine is idle between transactions (stalled on its FIFO) so
+ * this is safe to call between any two operations.
+ * 
+ * @param div 
+ */
+void swd_set_clkdiv(int div) {
+    pio_sm_set_clkdiv_int_frac(swd_pio, swd_sm, div, 0);
+}
+
 /**
  * @brief Sends up to 21 bits of data using a single control word
  * 
@@ -292,6 +304,70 @@ int swd_write(int APnDP, int addr, uint32_t value) {
     return rc;
 }
 
+/**
+ * @brief Write a run of values to the same register (i.e. AP DRW streaming)
+ * 
+ * The request header and conditional control word are the same for every
+ * value, so they are built once. The ACK comes back before the data phase,
+ * so the parity of the next value is worked out while the PIO is still
+ * clocking out the current one. Each ACK is checked before the next
+ * request is queued, so a WAIT or FAULT still gets its turnaround.
+ * 
+ * @param APnDP 
+ * @param addr 
+ * @param values 
+ * @param count 
+ * @return int 
+ */
+int swd_write_block(int APnDP, int addr, const uint32_t *values, int count) {
+    uint32_t ack;
+
+    uint32_t packpar = parity4((addr & 0xc) | 0 | APnDP);
+    uint32_t header =   (1 << 7)                // park
+                    |   (0 << 6)                // stop bit
+                    |   (packpar << 5)          // parity
+                    |   ((addr & 0xc) << 1)     // A3/A2
+                    |   (0 << 2)                // Write
+                    |   (APnDP << 1)
+                    |   (1);                    // start bit
+    uint32_t header_word = (header << 10) | ((8-1) << 5) | swd_offset_short_output;
+    uint32_t cond_word = swd_offset_cond_write_fail << (5+8+5)
+                            | swd_offset_cond_write_ok << (5+8)
+                            | (33-1) << 5
+                            | swd_offset_conditional;
+
+    if (count <= 0) return SWD_OK;
+
+    uint32_t value = *values;
+    uint32_t parity = parity32(value);
+
+    while (1) {
+        pio_sm_put_blocking(swd_pio, swd_sm, header_word);
+        pio_sm_put_blocking(swd_pio, swd_sm, cond_word);
+        pio_sm_put_blocking(swd_pio, swd_sm, value);
+        pio_sm_put_blocking(swd_pio, swd_sm, parity);
+
+        // Get the next one ready while this one is on the wire...
+        uint32_t next = (count > 1) ? values[1] : 0;
+        uint32_t next_parity = parity32(next);
+
+        ack = pio_sm_get_blocking(swd_pio, swd_sm) >> 1;
+        if (ack != 1) {
+            // We need a trn if we fail...
+            swd_short_output(1, 0);
+            if (ack == 2) continue;             // WAIT: same value again
+            if (ack == 4) return SWD_FAULT;
+            return SWD_ERROR;
+        }
+
+        if (--count == 0) break;
+        values++;
+        value = next;
+        parity = next_parity;
+    }
+    return SWD_OK;
+}
+
 /**
  * @brief This sends an arbitary number of bits to the target
  * 
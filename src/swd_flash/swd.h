@@ -26,6 +26,10 @@
 #define SWD_ERROR           3
 #define SWD_PARITY          4
 
+// PIO clock dividers (125 MHz sys clock, two PIO cycles per SWD bit)
+#define SWD_CLKDIV_SAFE     16      // ~4 MHz, reliable on every board so far
+#define SWD_CLKDIV_FAST     8       // ~8 MHz, only with verified transfers
+
 #define CHECK_OK(func)      { int rc = func; if (rc != SWD_OK) return rc; }
 
 int swd_init();
@@ -33,6 +37,8 @@ void swd_pio_poll();
 void swd_targetsel(uint32_t target);
 int swd_read(int APnDP, int addr, uint32_t *result);
 int swd_write(int APnDP, int addr, uint32_t value);
+int swd_write_block(int APnDP, int addr, const uint32_t *values, int count);
+void swd_set_clkdiv(int div);
 void swd_send_bits(uint32_t *data, int bitcount);
 
 void swd_line_reset();
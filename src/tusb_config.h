@@ -184,6 +184,7 @@
   // Xbox Original (XID) mode support
   #define CFG_TUD_XID               1   // Enable XID class driver
   #define CFG_TUD_XID_EP_BUFSIZE    32  // XID endpoint buffer size
+  #define CFG_TUD_XID_PORTS         4   // Four-port XID mode (4 IN + 4 OUT endpoints)
 
   // Xbox 360 (XInput) mode support
   #define CFG_TUD_XINPUT            1   // Enable XInput class driver
@@ -39,20 +39,24 @@ static bool binary_mode = false;  // Switch to binary after receiving 0xAA
 // ----------------------------------------------------------------------------
 // Optional relay demux hooks (registered by mp_bridge when a NUS-relay-capable
 // BLE app is built). Keeps cdc.c decoupled from BT/MouthPad code: an RX filter
-// gets first look at each incoming byte and returns true if it consumed it as
-// part of a relay frame (e.g. MouthPad 0xAA 0x55 frames); a periodic hook drains
-// relay TX to CDC. Bytes the filter doesn't claim fall through to the normal
-// JoypadOS command parser, so when no relay device is connected CDC behaves
-// exactly as before.
-typedef bool (*cdc_rx_filter_fn)(uint8_t byte);
+// gets first look at each received chunk and returns how many leading bytes it
+// consumed as part of a relay frame (e.g. MouthPad 0xAA 0x55 frames); a
+// periodic hook drains relay TX to CDC, and an optional hold hook pauses RX
+// while the relay can't take more (USB NAKs the host meanwhile). Bytes the
+// filter doesn't claim fall through to the normal JoypadOS command parser, so
+// when no relay device is connected CDC behaves exactly as before.
+typedef size_t (*cdc_rx_filter_fn)(const uint8_t* data, size_t len);
 typedef void (*cdc_task_hook_fn)(void);
+typedef bool (*cdc_rx_hold_fn)(void);
 static cdc_rx_filter_fn cdc_rx_filter = NULL;
 static cdc_task_hook_fn cdc_task_hook = NULL;
+static cdc_rx_hold_fn   cdc_rx_hold = NULL;
 
-void cdc_register_relay(cdc_rx_filter_fn filter, cdc_task_hook_fn hook)
+void cdc_register_relay(cdc_rx_filter_fn filter, cdc_task_hook_fn hook, cdc_rx_hold_fn hold)
 {
     cdc_rx_filter = filter;
     cdc_task_hook = hook;
+    cdc_rx_hold = hold;
 }
 
 // Weak hook called once from cdc_init(). A relay module (mp_bridge, linked only
@@ -101,6 +105,9 @@ static void cdc_process_command(const char* cmd)
         else if (strcasecmp(value, "HID") == 0 || strcasecmp(value, "DINPUT") == 0) {
             mode_num = USB_OUTPUT_MODE_HID;
         }
+        else if (strcasecmp(value, "XOG4") == 0 || strcasecmp(value, "XBOX_OG_4P") == 0) {
+            mode_num = USB_OUTPUT_MODE_XBOX_ORIGINAL_4P;
+        }
         else if (strcasecmp(value, "XOG") == 0 || strcasecmp(value, "XBOX_OG") == 0 ||
                  strcasecmp(value, "XBOX") == 0) {
             mode_num = USB_OUTPUT_MODE_XBOX_ORIGINAL;
@@ -599,15 +606,23 @@ void cdc_task(void)
     for (int pump = 0; pump < 32; pump++) {
         bool progress = false;
         while (cdc_data_available() > 0) {
-            int32_t ch = cdc_data_read_byte();
-            if (ch < 0) break;
-            progress = true;
+            // Leave bytes in the FIFO while the relay is backed up
+            if (cdc_rx_hold && cdc_rx_hold()) break;
 
-            // Give the relay demux first look. If it claims the byte (part of a
-            // relay frame), don't pass it to the command parser.
-            if (cdc_rx_filter && cdc_rx_filter((uint8_t)ch)) continue;
+            uint8_t buf[64];
+            uint32_t n = cdc_data_read(buf, sizeof(buf));
+            if (n == 0) break;
+            progress = true;
 
-            cdc_feed_command_byte((uint8_t)ch);
+            // Give the relay demux first look. Whatever it claims (relay frame
+            // bytes) skips the command parser.
+            for (uint32_t i = 0; i < n; ) {
+                if (cdc_rx_filter) {
+                    size_t used = cdc_rx_filter(buf + i, n - i);
+                    if (used) { i += (uint32_t)used; continue; }
+                }
+                cdc_feed_command_byte(buf[i++]);
+            }
         }
         if (!progress) break;
         tud_task_ext(0, false);  // move the next endpoint transaction in
@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 // CDC port index
 #define CDC_PORT_DATA   0
@@ -24,10 +25,13 @@ void cdc_task(void);
 void cdc_feed_command_byte(uint8_t ch);
 
 // Register an optional relay demux. `filter` gets first look at each received
-// byte and returns true if it consumed it (part of a relay frame); `hook` is
-// called every cdc_task() to drain relay TX to CDC. Pass NULL,NULL to disable.
-// Keeps the CDC layer decoupled from BT/MouthPad code.
-void cdc_register_relay(bool (*filter)(uint8_t byte), void (*hook)(void));
+// chunk and returns how many leading bytes it consumed (part of a relay frame,
+// 0 = none); `hook` is called every cdc_task() to drain relay TX to CDC; `hold`
+// (may be NULL) returns true to leave RX unread while the relay is backed up.
+// Pass NULL,NULL,NULL to disable. Keeps the CDC layer decoupled from
+// BT/MouthPad code.
+void cdc_register_relay(size_t (*filter)(const uint8_t* data, size_t len),
+                        void (*hook)(void), bool (*hold)(void));
 
 // Weak hook called once from cdc_init(); a linked relay module (mp_bridge)
 // overrides it to attach itself. Default is a no-op.
@@ -7,6 +7,9 @@
 #include "../usbd.h"
 #include "app.h"
 #include "core/app_registry.h"
+#include "core/loop_stats.h"
+#include "core/sched.h"
+#include "core/power.h"
 #include "core/router/router.h"
 #include "core/services/storage/flash.h"
 #include "core/services/leds/neopixel/ws2812.h"
@@ -550,6 +553,141 @@ static void cmd_mode_get(const char* json)
     send_json(response_buf);
 }
 
+// Main loop wake-to-service latency histogram (see core/loop_stats.h)
+static void cmd_loop_stats(const char* json)
+{
+    bool reset = false;
+    json_get_bool(json, "reset", &reset);
+
+    loop_stats_t st;
+    loop_stats_get(&st);
+
+    int n = snprintf(response_buf, sizeof(response_buf), "{\"bounds_us\":[");
+    for (uint8_t i = 0; i < LOOP_STATS_BUCKETS - 1 && n < (int)sizeof(response_buf); i++) {
+        n += snprintf(response_buf + n, sizeof(response_buf) - n, "%s%u",
+                      i ? "," : "", loop_stats_bounds_us[i]);
+    }
+    n += snprintf(response_buf + n, sizeof(response_buf) - n, "],\"bins\":[");
+    for (uint8_t i = 0; i < LOOP_STATS_BUCKETS && n < (int)sizeof(response_buf); i++) {
+        n += snprintf(response_buf + n, sizeof(response_buf) - n, "%s%lu",
+                      i ? "," : "", (unsigned long)st.bins[i]);
+    }
+    snprintf(response_buf + n, sizeof(response_buf) - n,
+             "],\"count\":%lu,\"avg_us\":%lu,\"max_us\":%lu}",
+             (unsigned long)st.count,
+             (unsigned long)(st.count ? st.total_us / st.count : 0),
+             (unsigned long)st.max_us);
+    send_json(response_buf);
+
+    if (reset) loop_stats_reset();
+}
+
+// Core 0 scheduler stats. Weak defaults so ports without the RP2040
+// scheduler (ESP32, nRF, CH32) link; the strong versions live in core/sched.c.
+__attribute__((weak)) uint8_t sched_task_count(void) { return 0; }
+__attribute__((weak)) const sched_task_t* sched_get_task(uint8_t index) { (void)index; return NULL; }
+__attribute__((weak)) void sched_get_stats(sched_stats_t* out) { memset(out, 0, sizeof(*out)); }
+__attribute__((weak)) void sched_reset_stats(void) {}
+
+static void cmd_sched_stats(const char* json)
+{
+    bool reset = false;
+    json_get_bool(json, "reset", &reset);
+
+    sched_stats_t st;
+    sched_get_stats(&st);
+
+    uint32_t gaps = st.passes > 1 ? st.passes - 1 : 0;
+    int n = snprintf(response_buf, sizeof(response_buf),
+                     "{\"passes\":%lu,\"pass_budget_us\":%u,"
+                     "\"hot_gap_avg_us\":%lu,\"hot_gap_max_us\":%lu,\"tasks\":[",
+                     (unsigned long)st.passes, (unsigned)SCHED_PASS_BUDGET_US,
+                     (unsigned long)(gaps ? st.hot_gap_total_us / gaps : 0),
+                     (unsigned long)st.hot_gap_max_us);
+
+    // Compact per-task entries: class, priority, period, budget, runs,
+    // avg/max run time, overruns, deferrals
+    for (uint8_t i = 0; i < sched_task_count() && n < (int)sizeof(response_buf) - 128; i++) {
+        const sched_task_t* t = sched_get_task(i);
+        n += snprintf(response_buf + n, sizeof(response_buf) - n,
+                      "%s{\"name\":\"%s\",\"cls\":%d,\"pri\":%u,\"period\":%lu,\"budget\":%lu,"
+                      "\"runs\":%lu,\"avg\":%lu,\"max\":%lu,\"over\":%lu,\"defer\":%lu}",
+                      i ? "," : "", t->name, (int)t->cls, t->priority,
+                      (unsigned long)t->period_us, (unsigned long)t->budget_us,
+                      (unsigned long)t->stats.runs,
+                      (unsigned long)(t->stats.runs ? t->stats.total_us / t->stats.runs : 0),
+                      (unsigned long)t->stats.max_us,
+                      (unsigned long)t->stats.overruns,
+                      (unsigned long)t->stats.deferrals);
+    }
+    snprintf(response_buf + n, sizeof(response_buf) - n, "]}");
+    send_json(response_buf);
+
+    if (reset) sched_reset_stats();
+}
+
+// Idle power tiers. Weak defaults for ports without the RP2040 power
+// manager; the strong versions live in core/power.c.
+__attribute__((weak)) power_tier_t power_get_tier(void) { return POWER_ACTIVE; }
+__attribute__((weak)) void power_get_stats(power_stats_t* out) { memset(out, 0, sizeof(*out)); }
+__attribute__((weak)) void power_reset_stats(void) {}
+
+static void cmd_power_stats(const char* json)
+{
+    bool reset = false;
+    json_get_bool(json, "reset", &reset);
+
+    power_stats_t st;
+    power_get_stats(&st);
+
+    // first_input: wake pin edge to the input being delivered, after an
+    // idle wait. Inputs without a wake pin are bounded by the tier tick.
+    snprintf(response_buf, sizeof(response_buf),
+             "{\"tier\":%d,\"sys_khz\":%lu,\"idle_khz\":%lu,"
+             "\"ms\":[%lu,%lu,%lu],\"entries\":[%lu,%lu,%lu],"
+             "\"waits\":%lu,\"edge_wakes\":%lu,\"downclocks\":%lu,"
+             "\"tick_us\":[%u,%u],\"first_input\":{\"count\":%lu,"
+             "\"last_us\":%lu,\"avg_us\":%lu,\"max_us\":%lu}}",
+             (int)power_get_tier(),
+             (unsigned long)st.sys_khz_full, (unsigned long)st.sys_khz_idle,
+             (unsigned long)(st.tier_us[POWER_ACTIVE] / 1000),
+             (unsigned long)(st.tier_us[POWER_IDLE] / 1000),
+             (unsigned long)(st.tier_us[POWER_GATED] / 1000),
+             (unsigned long)st.entries[POWER_ACTIVE],
+             (unsigned long)st.entries[POWER_IDLE],
+             (unsigned long)st.entries[POWER_GATED],
+             (unsigned long)st.waits, (unsigned long)st.edge_wakes,
+             (unsigned long)st.downclocks,
+             (unsigned)POWER_IDLE_TICK_US, (unsigned)POWER_GATED_TICK_US,
+             (unsigned long)st.first_input_count,
+             (unsigned long)st.first_input_last_us,
+             (unsigned long)(st.first_input_count ?
+                             st.first_input_total_us / st.first_input_count : 0),
+             (unsigned long)st.first_input_max_us);
+    send_json(response_buf);
+
+    if (reset) power_reset_stats();
+}
+
+// Diagnostic getter from switch_pro_mode.c (fwd-declared like
+// sinput_get_feature_count above).
+extern uint32_t switch_pro_mode_get_imu_dropped(void);
+
+// Input report counters for modes with a repeat policy (since enumeration),
+// plus the IMU samples the Switch Pro stream could not fit in its reports
+static void cmd_usb_stats(const char* json)
+{
+    (void)json;
+    uint32_t sent = 0, suppressed = 0, repeated = 0;
+    usbd_get_report_stats(&sent, &suppressed, &repeated);
+    snprintf(response_buf, sizeof(response_buf),
+             "{\"reports\":{\"sent\":%lu,\"suppressed\":%lu,\"idle_repeats\":%lu},"
+             "\"switch_pro\":{\"imu_dropped\":%lu}}",
+             (unsigned long)sent, (unsigned long)suppressed, (unsigned long)repeated,
+             (unsigned long)switch_pro_mode_get_imu_dropped());
+    send_json(response_buf);
+}
+
 static void cmd_mode_set(const char* json)
 {
     int mode;
@@ -907,9 +1045,15 @@ static void cmd_profile_get(const char* json)
         snprintf(response_buf, sizeof(response_buf),
                  "{\"ok\":true,\"index\":%d,\"name\":\"%.11s\",\"builtin\":false,\"editable\":true,"
                  "\"button_map\":[%s],"
-                 "\"left_stick_sens\":%d,\"right_stick_sens\":%d,\"flags\":%d,\"socd_mode\":%d}",
+                 "\"left_stick_sens\":%d,\"right_stick_sens\":%d,\"flags\":%d,\"socd_mode\":%d,"
+                 "\"gyro_mode\":%d,\"gyro_activation\":%d,\"gyro_button\":%d,"
+                 "\"gyro_sens_min\":%d,\"gyro_sens_max\":%d,\"gyro_accel_dps\":%d,"
+                 "\"gyro_deadzone\":%d,\"gyro_stick_min\":%d,\"gyro_flags\":%d}",
                  index, p->name, map_str,
-                 p->left_stick_sens, p->right_stick_sens, p->flags, p->socd_mode);
+                 p->left_stick_sens, p->right_stick_sens, p->flags, p->socd_mode,
+                 p->gyro_mode, p->gyro_activation, p->gyro_button,
+                 p->gyro_sens_min, p->gyro_sens_max, p->gyro_accel_dps,
+                 p->gyro_deadzone, p->gyro_stick_min, p->gyro_flags);
     }
     send_json(response_buf);
 }
@@ -1019,6 +1163,31 @@ static int json_get_int_array(const char* json, const char* key,
     return count;
 }
 
+// Gyro aim fields shared by PROFILE.SAVE and PROFILE.APPLY. Only keys present
+// in the body are written.
+static void profile_parse_gyro(const char* json, custom_profile_t* p)
+{
+    int v;
+    if (json_get_int(json, "gyro_mode", &v))
+        p->gyro_mode = (uint8_t)(v > 2 ? 0 : (v < 0 ? 0 : v));
+    if (json_get_int(json, "gyro_activation", &v))
+        p->gyro_activation = (uint8_t)(v > 3 ? 0 : (v < 0 ? 0 : v));
+    if (json_get_int(json, "gyro_button", &v))
+        p->gyro_button = (uint8_t)(v > BUTTON_MAP_MAX_TARGET ? 0 : (v < 0 ? 0 : v));
+    if (json_get_int(json, "gyro_sens_min", &v))
+        p->gyro_sens_min = (uint8_t)(v > 255 ? 255 : (v < 0 ? 0 : v));
+    if (json_get_int(json, "gyro_sens_max", &v))
+        p->gyro_sens_max = (uint8_t)(v > 255 ? 255 : (v < 0 ? 0 : v));
+    if (json_get_int(json, "gyro_accel_dps", &v))
+        p->gyro_accel_dps = (uint8_t)(v > 255 ? 255 : (v < 0 ? 0 : v));
+    if (json_get_int(json, "gyro_deadzone", &v))
+        p->gyro_deadzone = (uint8_t)(v > 255 ? 255 : (v < 0 ? 0 : v));
+    if (json_get_int(json, "gyro_stick_min", &v))
+        p->gyro_stick_min = (uint8_t)(v > 127 ? 127 : (v < 0 ? 0 : v));
+    if (json_get_int(json, "gyro_flags", &v))
+        p->gyro_flags = (uint8_t)v;
+}
+
 // PROFILE.SAVE - Create or update custom profile (unified index)
 // index=255 creates a new profile
 static void cmd_profile_save(const char* json)
@@ -1114,6 +1283,14 @@ static void cmd_profile_save(const char* json)
         p->socd_mode = 0;  // Default to passthrough
     }
 
+    // Gyro aim (new profiles start with it off; 0 sens = 1.0x)
+    if (is_new) {
+        p->gyro_mode = p->gyro_activation = p->gyro_button = 0;
+        p->gyro_sens_min = p->gyro_sens_max = p->gyro_accel_dps = 0;
+        p->gyro_deadzone = p->gyro_stick_min = p->gyro_flags = 0;
+    }
+    profile_parse_gyro(json, p);
+
     // Save to flash (runtime settings are already updated)
     flash_save(settings);
 
@@ -1285,6 +1462,15 @@ static void cmd_profile_clone(const char* json)
             new_profile->socd_mode        = src->socd_mode;
             new_profile->l2_threshold     = src->l2_threshold;
             new_profile->r2_threshold     = src->r2_threshold;
+            new_profile->gyro_mode        = src->gyro_mode;
+            new_profile->gyro_activation  = src->gyro_activation;
+            new_profile->gyro_button      = src->gyro_button;
+            new_profile->gyro_sens_min    = src->gyro_sens_min;
+            new_profile->gyro_sens_max    = src->gyro_sens_max;
+            new_profile->gyro_accel_dps   = src->gyro_accel_dps;
+            new_profile->gyro_deadzone    = src->gyro_deadzone;
+            new_profile->gyro_stick_min   = src->gyro_stick_min;
+            new_profile->gyro_flags       = src->gyro_flags;
         }
     }
 
@@ -1350,7 +1536,7 @@ static void cmd_profile_select(const char* json)
 // selection (PROFILE.SET, on-device SELECT+D-pad cycling) drops the override.
 //
 // Body: { "button_map":[18 ints], "name":"...", optional left/right_stick_sens,
-//         flags, socd_mode, l2_threshold, r2_threshold }
+//         flags, socd_mode, l2_threshold, r2_threshold, gyro_* }
 // Missing fields default to passthrough / 100% sens / no SOCD / no thresholds.
 static void cmd_profile_apply(const char* json)
 {
@@ -1393,6 +1579,7 @@ static void cmd_profile_apply(const char* json)
         cp.l2_threshold = (uint8_t)(v > 255 ? 255 : (v < 0 ? 0 : v));
     if (json_get_int(json, "r2_threshold", &v))
         cp.r2_threshold = (uint8_t)(v > 255 ? 255 : (v < 0 ? 0 : v));
+    profile_parse_gyro(json, &cp);
 
     flash_apply_ephemeral_profile(&cp);
 
@@ -1994,10 +2181,30 @@ static void cmd_ps4auth_status(const char *json)
         for (int i = 0; i < 16; i++) {
             snprintf(serial_hex + i * 2, 3, "%02X", auth.serial[i]);
         }
+#ifdef ENABLE_PS4_LOCAL_AUTH
+        // Sign timing: last/max in ms, engine and the core that signed
+        ps4_local_auth_stats_t stats;
+        ps4_local_auth_get_stats(&stats);
+        snprintf(response_buf, sizeof(response_buf),
+                 "{\"installed\":true,\"active\":%s,\"serial\":\"%s\","
+                 "\"engine\":\"%s\",\"hw_sha\":%s,\"signs\":%lu,\"sign_failures\":%lu,"
+                 "\"crt_retries\":%lu,\"sign_ms\":%lu,\"sign_max_ms\":%lu,\"sign_core\":%u}",
+                 active ? "true" : "false",
+                 serial_hex,
+                 stats.crt ? "crt" : "mbedtls",
+                 stats.hw_sha ? "true" : "false",
+                 (unsigned long)stats.count,
+                 (unsigned long)stats.failures,
+                 (unsigned long)stats.crt_retries,
+                 (unsigned long)(stats.last_us / 1000),
+                 (unsigned long)(stats.max_us / 1000),
+                 stats.core);
+#else
         snprintf(response_buf, sizeof(response_buf),
                  "{\"installed\":true,\"active\":%s,\"serial\":\"%s\"}",
                  active ? "true" : "false",
                  serial_hex);
+#endif
     } else {
         snprintf(response_buf, sizeof(response_buf),
                  "{\"installed\":false,\"active\":false}");
@@ -2415,6 +2622,35 @@ static void cmd_bt_status(const char* json)
     send_json(response_buf);
 }
 
+// USB dongle HCI transport ACL ring counters. Weak default so onboard-radio
+// builds (CYW43, nRF, ESP32) link; the strong versions live in
+// usb/usbh/btd/hci_transport_h2_tinyusb.c.
+__attribute__((weak)) void hci_transport_h2_tinyusb_get_stats(
+    uint32_t* ip, uint32_t* is, uint32_t* ih, uint32_t* op, uint32_t* os, uint32_t* oh) {
+    if (ip) *ip = 0; if (is) *is = 0; if (ih) *ih = 0;
+    if (op) *op = 0; if (os) *os = 0; if (oh) *oh = 0;
+}
+__attribute__((weak)) void hci_transport_h2_tinyusb_reset_stats(void) {}
+
+static void cmd_bt_hci_stats(const char* json)
+{
+    bool reset = false;
+    json_get_bool(json, "reset", &reset);
+
+    uint32_t in_packets = 0, in_starved = 0, in_high = 0;
+    uint32_t out_packets = 0, out_stalls = 0, out_high = 0;
+    hci_transport_h2_tinyusb_get_stats(&in_packets, &in_starved, &in_high,
+                                       &out_packets, &out_stalls, &out_high);
+    snprintf(response_buf, sizeof(response_buf),
+             "{\"acl_in\":{\"packets\":%lu,\"starved\":%lu,\"high_water\":%lu},"
+             "\"acl_out\":{\"packets\":%lu,\"stalls\":%lu,\"high_water\":%lu}}",
+             (unsigned long)in_packets, (unsigned long)in_starved, (unsigned long)in_high,
+             (unsigned long)out_packets, (unsigned long)out_stalls, (unsigned long)out_high);
+    send_json(response_buf);
+
+    if (reset) hci_transport_h2_tinyusb_reset_stats();
+}
+
 static void cmd_bt_bonds_clear(const char* json)
 {
     (void)json;
@@ -3521,6 +3757,10 @@ static const cmd_entry_t commands[] = {
     {"MODE.GET", cmd_mode_get},
     {"MODE.SET", cmd_mode_set},
     {"MODE.LIST", cmd_mode_list},
+    {"USB.STATS", cmd_usb_stats},
+    {"LOOP.STATS", cmd_loop_stats},
+    {"SCHED.STATS", cmd_sched_stats},
+    {"POWER.STATS", cmd_power_stats},
     {"IMU.MAP", cmd_imu_map},
     {"TILT.STEER", cmd_tilt_steer},
     // Unified profile commands
@@ -3578,6 +3818,7 @@ static const cmd_entry_t commands[] = {
     {"VOICE.STATE", cmd_voice_state},
 #endif
     {"BT.STATUS", cmd_bt_status},
+    {"BT.HCI.STATS", cmd_bt_hci_stats},
     {"BT.BONDS.CLEAR", cmd_bt_bonds_clear},
     {"BT.FORGET", cmd_bt_forget},
     {"WIIMOTE.ORIENT.GET", cmd_wiimote_orient_get},
@@ -3672,6 +3913,7 @@ void cdc_commands_init(void)
 
 void cdc_commands_process(const cdc_packet_t* packet)
 {
+    power_note_activity();  // a config session keeps the loop at full speed
     packet_handler(packet);
 }
 
@@ -153,6 +153,50 @@ static const uint8_t kbmouse_report_descriptor[] = {
     0xC0,              // End Collection (Mouse)
 };
 
+// ============================================================================
+// COMPOSITE: NKRO KEYBOARD REPORT DESCRIPTOR (no report ID)
+// ============================================================================
+// KB/Mouse mode's keyboard interface on the SInput composite. SInput keeps
+// its own 6KRO + consumer descriptor; this one is only served in KB/Mouse
+// mode. Modifiers plus one bit per usage 0x00-0x6F (up to F20): 15 bytes,
+// inside the 16-byte keyboard endpoint. The interface is also a boot
+// keyboard; in boot protocol the mode sends the standard 8-byte report.
+
+static const uint8_t kbmouse_keyboard_report_descriptor[] = {
+    0x05, 0x01,        // Usage Page (Generic Desktop)
+    0x09, 0x06,        // Usage (Keyboard)
+    0xA1, 0x01,        // Collection (Application)
+
+    // Modifier keys (8 bits)
+    0x05, 0x07,        //   Usage Page (Key Codes)
+    0x19, 0xE0,        //   Usage Minimum (224 - Left Control)
+    0x29, 0xE7,        //   Usage Maximum (231 - Right GUI)
+    0x15, 0x00,        //   Logical Minimum (0)
+    0x25, 0x01,        //   Logical Maximum (1)
+    0x75, 0x01,        //   Report Size (1)
+    0x95, 0x08,        //   Report Count (8)
+    0x81, 0x02,        //   Input (Data, Variable, Absolute)
+
+    // Key bitmap (112 bits)
+    0x19, 0x00,        //   Usage Minimum (0)
+    0x29, 0x6F,        //   Usage Maximum (111 - F20)
+    0x95, 0x70,        //   Report Count (112)
+    0x81, 0x02,        //   Input (Data, Variable, Absolute)
+
+    // LED output report (for Caps/Num/Scroll Lock feedback)
+    0x95, 0x05,        //   Report Count (5)
+    0x75, 0x01,        //   Report Size (1)
+    0x05, 0x08,        //   Usage Page (LEDs)
+    0x19, 0x01,        //   Usage Minimum (1 - Num Lock)
+    0x29, 0x05,        //   Usage Maximum (5 - Kana)
+    0x91, 0x02,        //   Output (Data, Variable, Absolute)
+    0x95, 0x01,        //   Report Count (1)
+    0x75, 0x03,        //   Report Size (3)
+    0x91, 0x01,        //   Output (Constant) - padding
+
+    0xC0,              // End Collection (Keyboard)
+};
+
 // ============================================================================
 // CONFIGURATION DESCRIPTOR
 // ============================================================================
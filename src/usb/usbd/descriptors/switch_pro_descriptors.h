@@ -0,0 +1,296 @@
+// switch_pro_descriptors.h - Nintendo Switch Pro Controller USB descriptors
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// Genuine Pro Controller (057E:2009) identity. Unlike the HORI-style Switch
+// mode, the console drives this device through the Nintendo subcommand
+// protocol (0x80 USB commands + 0x01 subcommands) and then streams 0x30
+// full reports carrying three buffered IMU samples each.
+//
+// Reference: dekuNukem/Nintendo_Switch_Reverse_Engineering, SDL hidapi_switch
+
+#ifndef SWITCH_PRO_DESCRIPTORS_H
+#define SWITCH_PRO_DESCRIPTORS_H
+
+#include <stdint.h>
+#include "tusb.h"
+
+// ============================================================================
+// USB IDENTIFIERS
+// ============================================================================
+
+#define SWITCH_PRO_VID              0x057E  // Nintendo
+#define SWITCH_PRO_PID              0x2009  // Pro Controller
+#define SWITCH_PRO_BCD_DEVICE       0x0210  // v2.10
+#define SWITCH_PRO_MANUFACTURER     "Nintendo Co., Ltd."
+#define SWITCH_PRO_PRODUCT          "Pro Controller"
+
+#define SWITCH_PRO_ENDPOINT_SIZE    64
+#define SWITCH_PRO_REPORT_SIZE      64      // Report ID + 63 payload bytes
+
+// ============================================================================
+// PROTOCOL CONSTANTS
+// ============================================================================
+
+// Report IDs (host -> device)
+#define SWITCH_PRO_OUT_RUMBLE_SUBCMD   0x01  // Rumble + subcommand
+#define SWITCH_PRO_OUT_RUMBLE_ONLY     0x10  // Rumble only
+#define SWITCH_PRO_OUT_USB_CMD         0x80  // USB-only commands
+
+// Report IDs (device -> host)
+#define SWITCH_PRO_IN_SUBCMD_REPLY     0x21  // Standard report + subcommand reply
+#define SWITCH_PRO_IN_FULL             0x30  // Standard full report with IMU
+#define SWITCH_PRO_IN_USB_REPLY        0x81  // Reply to a 0x80 USB command
+
+// USB commands (0x80 xx)
+#define SWITCH_PRO_USB_STATUS          0x01  // Request MAC / controller type
+#define SWITCH_PRO_USB_HANDSHAKE       0x02  // UART handshake with the BT chip
+#define SWITCH_PRO_USB_BAUDRATE        0x03  // Switch baudrate to 3 Mbit
+#define SWITCH_PRO_USB_HID_ONLY        0x04  // Force USB HID only (no timeout)
+#define SWITCH_PRO_USB_BT_RESTORE      0x05  // Allow Bluetooth again
+
+// Subcommands (0x01 .. xx)
+#define SWITCH_PRO_SUBCMD_BT_PAIR      0x01
+#define SWITCH_PRO_SUBCMD_DEVICE_INFO  0x02
+#define SWITCH_PRO_SUBCMD_REPORT_MODE  0x03
+#define SWITCH_PRO_SUBCMD_TRIGGER_TIME 0x04
+#define SWITCH_PRO_SUBCMD_SHIPMENT     0x08
+#define SWITCH_PRO_SUBCMD_SPI_READ     0x10
+#define SWITCH_PRO_SUBCMD_MCU_CONFIG   0x21
+#define SWITCH_PRO_SUBCMD_MCU_STATE    0x22
+#define SWITCH_PRO_SUBCMD_PLAYER_LEDS  0x30
+#define SWITCH_PRO_SUBCMD_HOME_LED     0x38
+#define SWITCH_PRO_SUBCMD_IMU_ENABLE   0x40
+#define SWITCH_PRO_SUBCMD_IMU_SENS     0x41
+#define SWITCH_PRO_SUBCMD_VIBRATION    0x48
+
+// SPI flash layout (subset the console reads at connect)
+#define SWITCH_PRO_SPI_SERIAL          0x6000  // 16 bytes, 0xFF = no serial
+#define SWITCH_PRO_SPI_IMU_FACTORY     0x6020  // 24 bytes IMU calibration
+#define SWITCH_PRO_SPI_STICK_FACTORY   0x603D  // 18 bytes L+R stick calibration
+#define SWITCH_PRO_SPI_COLORS          0x6050  // 12 bytes body/button/grip colors
+#define SWITCH_PRO_SPI_IMU_HORIZONTAL  0x6080  // 6 bytes IMU horizontal offsets
+#define SWITCH_PRO_SPI_STICK_PARAMS_L  0x6086  // 18 bytes left stick parameters
+#define SWITCH_PRO_SPI_STICK_PARAMS_R  0x6098  // 18 bytes right stick parameters
+#define SWITCH_PRO_SPI_STICK_USER      0x8010  // 22 bytes user stick cal (0xFF = none)
+#define SWITCH_PRO_SPI_IMU_USER        0x8026  // 26 bytes user IMU cal (0xFF = none)
+
+// Input report modes (SWITCH_PRO_SUBCMD_REPORT_MODE argument)
+#define SWITCH_PRO_MODE_FULL           0x30  // Standard full report @ native rate
+#define SWITCH_PRO_MODE_SIMPLE_HID     0x3F  // Simple HID, sent on change
+
+// Native USB cadence of the 0x30 report: the Pro Controller streams one
+// report every 8 ms over USB, each carrying three IMU frames.
+#define SWITCH_PRO_REPORT_INTERVAL_US  8000
+#define SWITCH_PRO_IMU_SAMPLES         3
+
+// 12-bit stick range
+#define SWITCH_PRO_STICK_CENTER        0x800
+#define SWITCH_PRO_STICK_RANGE         0x700  // Calibrated travel each side
+
+// Standard-report button bits
+// Byte 0 (right)
+#define SWITCH_PRO_BTN_Y               0x01
+#define SWITCH_PRO_BTN_X               0x02
+#define SWITCH_PRO_BTN_B               0x04
+#define SWITCH_PRO_BTN_A               0x08
+#define SWITCH_PRO_BTN_R               0x40
+#define SWITCH_PRO_BTN_ZR              0x80
+// Byte 1 (shared)
+#define SWITCH_PRO_BTN_MINUS           0x01
+#define SWITCH_PRO_BTN_PLUS            0x02
+#define SWITCH_PRO_BTN_RSTICK          0x04
+#define SWITCH_PRO_BTN_LSTICK          0x08
+#define SWITCH_PRO_BTN_HOME            0x10
+#define SWITCH_PRO_BTN_CAPTURE         0x20
+#define SWITCH_PRO_BTN_GRIP            0x80
+// Byte 2 (left)
+#define SWITCH_PRO_BTN_DOWN            0x01
+#define SWITCH_PRO_BTN_UP              0x02
+#define SWITCH_PRO_BTN_RIGHT           0x04
+#define SWITCH_PRO_BTN_LEFT            0x08
+#define SWITCH_PRO_BTN_L               0x40
+#define SWITCH_PRO_BTN_ZL              0x80
+
+// ============================================================================
+// REPORT STRUCTURES
+// ============================================================================
+
+// One IMU frame as it appears in the 0x30 report
+typedef struct __attribute__((packed)) {
+    int16_t accel[3];
+    int16_t gyro[3];
+} switch_pro_imu_frame_t;
+
+_Static_assert(sizeof(switch_pro_imu_frame_t) == 12, "switch_pro_imu_frame_t must be 12 bytes");
+
+// Standard input report body (after the report ID)
+typedef struct __attribute__((packed)) {
+    uint8_t timer;              // Increments per report
+    uint8_t battery_conn;       // High nibble battery, low nibble connection
+    uint8_t buttons[3];         // Right, shared, left
+    uint8_t left_stick[3];      // 12-bit X | 12-bit Y
+    uint8_t right_stick[3];
+    uint8_t vibrator;           // Vibrator input report
+} switch_pro_std_t;
+
+_Static_assert(sizeof(switch_pro_std_t) == 12, "switch_pro_std_t must be 12 bytes");
+
+// 0x30 full report body (63 bytes after the report ID)
+typedef struct __attribute__((packed)) {
+    switch_pro_std_t std;
+    switch_pro_imu_frame_t imu[SWITCH_PRO_IMU_SAMPLES];  // [0] = newest
+    uint8_t padding[15];
+} switch_pro_full_report_t;
+
+_Static_assert(sizeof(switch_pro_full_report_t) == 63, "switch_pro_full_report_t must be 63 bytes");
+
+// 0x21 subcommand reply body (63 bytes after the report ID)
+typedef struct __attribute__((packed)) {
+    switch_pro_std_t std;
+    uint8_t ack;                // 0x80 | reply type, 0x00 = NACK
+    uint8_t subcmd;             // Echo of the subcommand ID
+    uint8_t data[49];
+} switch_pro_subcmd_reply_t;
+
+_Static_assert(sizeof(switch_pro_subcmd_reply_t) == 63, "switch_pro_subcmd_reply_t must be 63 bytes");
+
+// ============================================================================
+// USB DESCRIPTORS
+// ============================================================================
+
+// HID report descriptor (203 bytes, byte-identical to a genuine Pro Controller)
+static const uint8_t switch_pro_report_descriptor[] = {
+    0x05, 0x01,                    // Usage Page (Generic Desktop Ctrls)
+    0x15, 0x00,                    // Logical Minimum (0)
+    0x09, 0x04,                    // Usage (Joystick)
+    0xA1, 0x01,                    // Collection (Application)
+    0x85, 0x30,                    //   Report ID (0x30)
+    0x05, 0x01,                    //   Usage Page (Generic Desktop Ctrls)
+    0x05, 0x09,                    //   Usage Page (Button)
+    0x19, 0x01,                    //   Usage Minimum (0x01)
+    0x29, 0x0A,                    //   Usage Maximum (0x0A)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0x01,                    //   Logical Maximum (1)
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x0A,                    //   Report Count (10)
+    0x55, 0x00,                    //   Unit Exponent (0)
+    0x65, 0x00,                    //   Unit (None)
+    0x81, 0x02,                    //   Input (Data,Var,Abs)
+    0x05, 0x09,                    //   Usage Page (Button)
+    0x19, 0x0B,                    //   Usage Minimum (0x0B)
+    0x29, 0x0E,                    //   Usage Maximum (0x0E)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0x01,                    //   Logical Maximum (1)
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x04,                    //   Report Count (4)
+    0x81, 0x02,                    //   Input (Data,Var,Abs)
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x02,                    //   Report Count (2)
+    0x81, 0x03,                    //   Input (Const,Var,Abs)
+    0x0B, 0x01, 0x00, 0x01, 0x00,  //   Usage (0x010001)
+    0xA1, 0x00,                    //   Collection (Physical)
+    0x0B, 0x30, 0x00, 0x01, 0x00,  //     Usage (0x010030)
+    0x0B, 0x31, 0x00, 0x01, 0x00,  //     Usage (0x010031)
+    0x0B, 0x32, 0x00, 0x01, 0x00,  //     Usage (0x010032)
+    0x0B, 0x35, 0x00, 0x01, 0x00,  //     Usage (0x010035)
+    0x15, 0x00,                    //     Logical Minimum (0)
+    0x27, 0xFF, 0xFF, 0x00, 0x00,  //     Logical Maximum (65535)
+    0x75, 0x10,                    //     Report Size (16)
+    0x95, 0x04,                    //     Report Count (4)
+    0x81, 0x02,                    //     Input (Data,Var,Abs)
+    0xC0,                          //   End Collection
+    0x0B, 0x39, 0x00, 0x01, 0x00,  //   Usage (0x010039)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0x07,                    //   Logical Maximum (7)
+    0x35, 0x00,                    //   Physical Minimum (0)
+    0x46, 0x3B, 0x01,              //   Physical Maximum (315)
+    0x65, 0x14,                    //   Unit (Eng Rot:Angular Pos)
+    0x75, 0x04,                    //   Report Size (4)
+    0x95, 0x01,                    //   Report Count (1)
+    0x81, 0x02,                    //   Input (Data,Var,Abs)
+    0x05, 0x09,                    //   Usage Page (Button)
+    0x19, 0x0F,                    //   Usage Minimum (0x0F)
+    0x29, 0x12,                    //   Usage Maximum (0x12)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0x01,                    //   Logical Maximum (1)
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x04,                    //   Report Count (4)
+    0x81, 0x02,                    //   Input (Data,Var,Abs)
+    0x75, 0x08,                    //   Report Size (8)
+    0x95, 0x34,                    //   Report Count (52)
+    0x81, 0x03,                    //   Input (Const,Var,Abs)
+    0x06, 0x00, 0xFF,              //   Usage Page (Vendor Defined 0xFF00)
+    0x85, 0x21,                    //   Report ID (0x21)
+    0x09, 0x01,                    //   Usage (0x01)
+    0x75, 0x08,                    //   Report Size (8)
+    0x95, 0x3F,                    //   Report Count (63)
+    0x81, 0x03,                    //   Input (Const,Var,Abs)
+    0x85, 0x81,                    //   Report ID (0x81)
+    0x09, 0x02,                    //   Usage (0x02)
+    0x75, 0x08,                    //   Report Size (8)
+    0x95, 0x3F,                    //   Report Count (63)
+    0x81, 0x03,                    //   Input (Const,Var,Abs)
+    0x85, 0x01,                    //   Report ID (0x01)
+    0x09, 0x03,                    //   Usage (0x03)
+    0x75, 0x08,                    //   Report Size (8)
+    0x95, 0x3F,                    //   Report Count (63)
+    0x91, 0x83,                    //   Output (Const,Var,Abs,Volatile)
+    0x85, 0x10,                    //   Report ID (0x10)
+    0x09, 0x04,                    //   Usage (0x04)
+    0x75, 0x08,                    //   Report Size (8)
+    0x95, 0x3F,                    //   Report Count (63)
+    0x91, 0x83,                    //   Output (Const,Var,Abs,Volatile)
+    0x85, 0x80,                    //   Report ID (0x80)
+    0x09, 0x05,                    //   Usage (0x05)
+    0x75, 0x08,                    //   Report Size (8)
+    0x95, 0x3F,                    //   Report Count (63)
+    0x91, 0x83,                    //   Output (Const,Var,Abs,Volatile)
+    0x85, 0x82,                    //   Report ID (0x82)
+    0x09, 0x06,                    //   Usage (0x06)
+    0x75, 0x08,                    //   Report Size (8)
+    0x95, 0x3F,                    //   Report Count (63)
+    0x91, 0x83,                    //   Output (Const,Var,Abs,Volatile)
+    0xC0,                          // End Collection
+};
+
+// Device descriptor
+static const tusb_desc_device_t switch_pro_device_descriptor = {
+    .bLength            = sizeof(tusb_desc_device_t),
+    .bDescriptorType    = TUSB_DESC_DEVICE,
+    .bcdUSB             = 0x0200,  // USB 2.0
+    .bDeviceClass       = 0x00,    // Use class from interface
+    .bDeviceSubClass    = 0x00,
+    .bDeviceProtocol    = 0x00,
+    .bMaxPacketSize0    = 64,
+    .idVendor           = SWITCH_PRO_VID,
+    .idProduct          = SWITCH_PRO_PID,
+    .bcdDevice          = SWITCH_PRO_BCD_DEVICE,
+    .iManufacturer      = 0x01,
+    .iProduct           = 0x02,
+    .iSerialNumber      = 0x03,
+    .bNumConfigurations = 0x01
+};
+
+// Configuration descriptor (41 bytes total)
+// 9 (config) + 9 (interface) + 9 (HID) + 7 (EP IN) + 7 (EP OUT) = 41
+#define SWITCH_PRO_CONFIG_TOTAL_LEN  (TUD_CONFIG_DESC_LEN + TUD_HID_INOUT_DESC_LEN)
+
+static const uint8_t switch_pro_config_descriptor[] = {
+    // Config descriptor: bus powered + remote wakeup, 500mA
+    TUD_CONFIG_DESCRIPTOR(1, 1, 0, SWITCH_PRO_CONFIG_TOTAL_LEN, 0xA0, 500),
+
+    // Interface
+    9, TUSB_DESC_INTERFACE, 0, 0, 2, TUSB_CLASS_HID, 0, 0, 0,
+
+    // HID descriptor
+    9, HID_DESC_TYPE_HID, U16_TO_U8S_LE(0x0111), 0, 1, HID_DESC_TYPE_REPORT, U16_TO_U8S_LE(sizeof(switch_pro_report_descriptor)),
+
+    // Endpoint IN (reports, 8 ms like the genuine controller)
+    7, TUSB_DESC_ENDPOINT, 0x81, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(SWITCH_PRO_ENDPOINT_SIZE), 8,
+
+    // Endpoint OUT (rumble + subcommands)
+    7, TUSB_DESC_ENDPOINT, 0x01, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(SWITCH_PRO_ENDPOINT_SIZE), 8,
+};
+
+#endif // SWITCH_PRO_DESCRIPTORS_H
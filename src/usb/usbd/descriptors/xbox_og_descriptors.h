@@ -141,6 +141,22 @@ static const uint8_t xbox_og_config_descriptor[] = {
     TUD_XID_DESCRIPTOR(0, 0x01, 0x81),
 };
 
+// Four-port configuration: one XID interface per controller port, each with
+// its own IN/OUT endpoint pair, so every port has an independent report and
+// rumble pipe. Interface N is port N.
+#define XBOX_OG_4P_PORTS            4
+#define XBOX_OG_4P_CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + XBOX_OG_4P_PORTS * TUD_XID_DESC_LEN)
+
+static const uint8_t xbox_og_4p_config_descriptor[] = {
+    // Config descriptor
+    TUD_CONFIG_DESCRIPTOR(1, XBOX_OG_4P_PORTS, 0, XBOX_OG_4P_CONFIG_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 500),
+    // XID Interfaces (ports 1-4)
+    TUD_XID_DESCRIPTOR(0, 0x01, 0x81),
+    TUD_XID_DESCRIPTOR(1, 0x02, 0x82),
+    TUD_XID_DESCRIPTOR(2, 0x03, 0x83),
+    TUD_XID_DESCRIPTOR(3, 0x04, 0x84),
+};
+
 // XID Device Descriptor (returned via GET_DESC request)
 static const uint8_t xbox_og_xid_descriptor[] = {
     0x10,                       // bLength
@@ -3,6 +3,7 @@
 // Based on GP2040-CE implementation (gp2040-ce.info)
 
 #include "tud_xbone.h"
+#include "xgip_pipe.h"
 #include "platform/platform.h"
 #include <string.h>
 #include <stdio.h>
@@ -11,6 +12,10 @@
 // Forward declaration for auth passthrough check (weak - returns false if not linked)
 __attribute__((weak)) bool xbone_auth_is_available(void) { return false; }
 
+// Console auth message complete - lets the host side forward it straight
+// from this callback (weak - no-op if xbone_auth isn't linked)
+__attribute__((weak)) void xbone_auth_console_message(void) {}
+
 // ============================================================================
 // CONFIGURATION
 // ============================================================================
@@ -78,6 +83,16 @@ static uint8_t queue_count = 0;
 // Auth passthrough
 static xbone_auth_t auth_data = { 0 };
 
+// Auth responses to the console stream through a windowed pipe, pumped on
+// every IN completion and console ACK rather than once per update pass
+static xgip_pipe_t auth_pipe;
+static uint32_t auth_pipe_logged = 0;
+
+// ACK to the console waiting for the IN endpoint; goes ahead of the paced
+// queue (buffer must outlive the transfer)
+static uint8_t ack_buf[XBONE_ENDPOINT_SIZE];
+static uint8_t ack_len = 0;
+
 // Auth ready marker
 static const uint8_t auth_ready[] = { 0x01, 0x00 };
 
@@ -120,6 +135,14 @@ static void queue_report(uint8_t* report, uint16_t len)
     queue_count++;
 }
 
+// Generate first: the length is only valid afterwards, and argument
+// evaluation order is unspecified
+static void queue_packet(xgip_t* xgip)
+{
+    uint8_t* packet = xgip_generate_packet(xgip);
+    queue_report(packet, xgip_get_packet_length(xgip));
+}
+
 static bool dequeue_report(uint8_t* report, uint16_t* len)
 {
     if (queue_count == 0) {
@@ -165,12 +188,66 @@ static bool send_report_internal(uint8_t* report, uint16_t len)
     return false;
 }
 
+static void flush_ack(void)
+{
+    if (ack_len && send_report_internal(ack_buf, ack_len)) {
+        ack_len = 0;
+    }
+}
+
+// ACK a received packet right away (the console holds its next chunk until
+// it arrives). A newer ACK supersedes one still waiting for the endpoint.
+static void send_ack(xgip_t* xgip)
+{
+    uint8_t* report = xgip_generate_ack(xgip);
+    ack_len = xgip_get_packet_length(xgip);
+    memcpy(ack_buf, report, ack_len);
+    flush_ack();
+}
+
+static bool auth_pipe_send(const uint8_t* packet, uint16_t len)
+{
+    return send_report_internal((uint8_t*)packet, len);
+}
+
+// Start a pending dongle->console auth message and push what the window allows
+static void auth_pump(void)
+{
+    if (driver_state != XBONE_STATE_SETUP_AUTH) {
+        return;
+    }
+
+    uint32_t now = platform_time_ms();
+
+    if (auth_data.state == XBONE_AUTH_SEND_DONGLE_TO_CONSOLE) {
+        bool is_chunked = (auth_data.length > GIP_MAX_CHUNK_SIZE);
+        xgip_pipe_start(&auth_pipe, auth_data.auth_type, auth_data.sequence,
+                        is_chunked, 1, auth_data.buffer, auth_data.length, now);
+        auth_data.state = XBONE_AUTH_WAIT_DONGLE_TO_CONSOLE;
+    }
+
+    xgip_pipe_pump(&auth_pipe, auth_pipe_send, now);
+
+    if (auth_data.state == XBONE_AUTH_WAIT_DONGLE_TO_CONSOLE && xgip_pipe_sent(&auth_pipe)) {
+        auth_data.state = XBONE_AUTH_IDLE;
+    }
+    if (!xgip_pipe_busy(&auth_pipe) && auth_pipe_logged != auth_pipe.messages) {
+        auth_pipe_logged = auth_pipe.messages;
+        printf("[tud_xbone] Auth 0x%02x sent to console in %lu ms (%lu ACK timeouts)\n",
+               auth_pipe.command, (unsigned long)auth_pipe.last_ms,
+               (unsigned long)auth_pipe.ack_timeouts);
+    }
+}
+
 // ============================================================================
 // TINYUSB CLASS DRIVER CALLBACKS
 // ============================================================================
 
 static void xbone_init(void)
 {
+    // Free any message buffers from before a bus reset (statics start NULL)
+    xgip_reset(&outgoing_xgip);
+    xgip_reset(&incoming_xgip);
     xgip_init(&outgoing_xgip);
     xgip_init(&incoming_xgip);
 
@@ -184,6 +261,9 @@ static void xbone_init(void)
 
     // Reset auth + sequence state so a re-enumeration starts clean
     memset(&auth_data, 0, sizeof(auth_data));
+    xgip_pipe_init(&auth_pipe);
+    auth_pipe_logged = 0;
+    ack_len = 0;
     input_report_sequence = 1;
     keepalive_sequence = 1;
     last_idle_report_ms = 0;
@@ -280,13 +360,18 @@ static bool xbone_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result,
 
         // Send ACK if required
         if (xgip_ack_required(&incoming_xgip)) {
-            queue_report(xgip_generate_ack(&incoming_xgip), xgip_get_packet_length(&incoming_xgip));
+            send_ack(&incoming_xgip);
         }
 
         uint8_t cmd = xgip_get_command(&incoming_xgip);
 
         if (cmd == GIP_ACK_RESPONSE) {
             waiting_ack = false;
+            // Opens the window for the next auth chunks
+            if (xgip_pipe_ack(&auth_pipe, p_xbone->epout_buf, (uint16_t)xferred_bytes,
+                              platform_time_ms())) {
+                auth_pump();
+            }
         } else if (cmd == GIP_DEVICE_DESCRIPTOR) {
             // Console requested descriptor
             xgip_reset(&outgoing_xgip);
@@ -313,12 +398,18 @@ static bool xbone_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result,
                                    xgip_get_command(&incoming_xgip),
                                    XBONE_AUTH_SEND_CONSOLE_TO_DONGLE);
                 xgip_reset(&incoming_xgip);
+                xbone_auth_console_message();
             }
         }
 
         // Ready for next packet
         TU_ASSERT(usbd_edpt_xfer(rhport, p_xbone->ep_out, p_xbone->epout_buf,
                                   sizeof(p_xbone->epout_buf)));
+    } else if (ep_addr == p_xbone->ep_in) {
+        // IN free again - pending ACK and next auth chunk go out without
+        // waiting for update()
+        flush_ack();
+        auth_pump();
     }
 
     return true;
@@ -417,6 +508,18 @@ void tud_xbone_update(void)
 {
     uint32_t now = platform_time_ms();
 
+    flush_ack();
+
+    // Announce, descriptor and auth run on short timers, and so does the
+    // report queue: keep the loop coming back until they're done. After auth
+    // only the 15 s keepalive is timed, and the loop's idle wake covers it.
+    if (driver_state == XBONE_STATE_READY_ANNOUNCE ||
+        driver_state == XBONE_STATE_SEND_DESCRIPTOR ||
+        (driver_state == XBONE_STATE_SETUP_AUTH && !auth_data.auth_completed) ||
+        queue_count > 0) {
+        platform_loop_wake_in(1);
+    }
+
     // Keep the console from disconnecting (runs every iteration, independent of
     // ACK wait state — GP2040-CE process() does these unconditionally):
     //  - while auth is pending, push idle GIP_INPUT_REPORTs continuously
@@ -464,10 +567,11 @@ void tud_xbone_update(void)
             if (send_report_internal(report, len)) {
                 last_report_queue_sent = now;
             } else {
-                // Failed - re-queue at front (by adjusting head back)
+                // Failed - re-queue at front (by adjusting head back) and
+                // retry after the interval (endpoint is often busy with auth chunks)
                 queue_head = (queue_head + REPORT_QUEUE_SIZE - 1) % REPORT_QUEUE_SIZE;
                 queue_count++;
-                platform_sleep_ms(REPORT_QUEUE_INTERVAL);
+                last_report_queue_sent = now;
             }
         }
     }
@@ -506,16 +610,14 @@ void tud_xbone_update(void)
                 memcpy(&announce[3], &now, 3);  // Insert timestamp
 
                 xgip_set_data(&outgoing_xgip, announce, sizeof(announce));
-                queue_report(xgip_generate_packet(&outgoing_xgip),
-                            xgip_get_packet_length(&outgoing_xgip));
+                queue_packet(&outgoing_xgip);
 
                 driver_state = XBONE_STATE_WAIT_DESCRIPTOR_REQUEST;
             }
             break;
 
         case XBONE_STATE_SEND_DESCRIPTOR:
-            queue_report(xgip_generate_packet(&outgoing_xgip),
-                        xgip_get_packet_length(&outgoing_xgip));
+            queue_packet(&outgoing_xgip);
 
             if (xgip_end_of_chunk(&outgoing_xgip)) {
                 driver_state = XBONE_STATE_SETUP_AUTH;
@@ -527,26 +629,10 @@ void tud_xbone_update(void)
             break;
 
         case XBONE_STATE_SETUP_AUTH:
-            // Handle auth passthrough from dongle to console
-            if (auth_data.state == XBONE_AUTH_SEND_DONGLE_TO_CONSOLE) {
-                bool is_chunked = (auth_data.length > GIP_MAX_CHUNK_SIZE);
-                xgip_reset(&outgoing_xgip);
-                xgip_set_attributes(&outgoing_xgip, auth_data.auth_type,
-                                   auth_data.sequence, 1, is_chunked, 1);
-                xgip_set_data(&outgoing_xgip, auth_data.buffer, auth_data.length);
-                auth_data.state = XBONE_AUTH_WAIT_DONGLE_TO_CONSOLE;
-            } else if (auth_data.state == XBONE_AUTH_WAIT_DONGLE_TO_CONSOLE) {
-                queue_report(xgip_generate_packet(&outgoing_xgip),
-                            xgip_get_packet_length(&outgoing_xgip));
-
-                if (!xgip_is_chunked(&outgoing_xgip) || xgip_end_of_chunk(&outgoing_xgip)) {
-                    auth_data.state = XBONE_AUTH_IDLE;
-                }
-
-                if (xgip_get_packet_ack(&outgoing_xgip)) {
-                    set_ack_wait();
-                }
-            }
+            // Auth passthrough from dongle to console. Normally already
+            // started from the host callback via tud_xbone_auth_kick(); this
+            // covers a busy endpoint and the ACK timeout.
+            auth_pump();
             break;
 
         case XBONE_STATE_IDLE:
@@ -591,6 +677,11 @@ bool tud_xbone_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage,
 // AUTH PASSTHROUGH API
 // ============================================================================
 
+void tud_xbone_auth_kick(void)
+{
+    auth_pump();
+}
+
 xbone_auth_state_t xbone_auth_get_state(void)
 {
     return auth_data.state;
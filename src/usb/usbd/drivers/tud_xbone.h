@@ -73,6 +73,10 @@ xbone_auth_state_t xbone_auth_get_state(void);
 void xbone_auth_set_data(uint8_t* data, uint16_t len, uint8_t seq,
                          uint8_t type, xbone_auth_state_t new_state);
 
+// Start sending a SEND_DONGLE_TO_CONSOLE message now instead of on the next
+// tud_xbone_update() pass (call right after xbone_auth_set_data)
+void tud_xbone_auth_kick(void);
+
 // Get auth buffer
 uint8_t* xbone_auth_get_buffer(void);
 
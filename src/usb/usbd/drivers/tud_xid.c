@@ -36,7 +36,26 @@ typedef struct {
     bool rumble_available;
 } xid_interface_t;
 
-static xid_interface_t _xid_itf;
+static xid_interface_t _xid_itf[CFG_TUD_XID_PORTS];
+
+// Find the port that owns an interface number / endpoint
+static xid_interface_t* find_itf(uint8_t itf_num)
+{
+    for (uint8_t i = 0; i < CFG_TUD_XID_PORTS; i++) {
+        if (_xid_itf[i].itf_num == itf_num) return &_xid_itf[i];
+    }
+    return NULL;
+}
+
+static xid_interface_t* find_ep(uint8_t ep_addr)
+{
+    for (uint8_t i = 0; i < CFG_TUD_XID_PORTS; i++) {
+        if (_xid_itf[i].ep_in == ep_addr || _xid_itf[i].ep_out == ep_addr) {
+            return &_xid_itf[i];
+        }
+    }
+    return NULL;
+}
 
 // ============================================================================
 // CONTROL REQUEST HANDLING
@@ -96,14 +115,16 @@ static xid_request_type_t identify_request(tusb_control_request_t const* request
 
 static void xid_init(void)
 {
-    memset(&_xid_itf, 0, sizeof(_xid_itf));
-    _xid_itf.itf_num = 0xFF;
-    _xid_itf.ep_in = 0xFF;
-    _xid_itf.ep_out = 0xFF;
-
-    // Initialize input report to neutral state
-    _xid_itf.in_report.reserved1 = 0x00;
-    _xid_itf.in_report.report_len = sizeof(xbox_og_in_report_t);
+    memset(_xid_itf, 0, sizeof(_xid_itf));
+    for (uint8_t i = 0; i < CFG_TUD_XID_PORTS; i++) {
+        _xid_itf[i].itf_num = 0xFF;
+        _xid_itf[i].ep_in = 0xFF;
+        _xid_itf[i].ep_out = 0xFF;
+
+        // Initialize input report to neutral state
+        _xid_itf[i].in_report.reserved1 = 0x00;
+        _xid_itf[i].in_report.report_len = sizeof(xbox_og_in_report_t);
+    }
 }
 
 static bool xid_deinit(void)
@@ -127,7 +148,10 @@ static uint16_t xid_open(uint8_t rhport, tusb_desc_interface_t const* itf_desc,
                                          itf_desc->bNumEndpoints * sizeof(tusb_desc_endpoint_t));
     TU_VERIFY(max_len >= drv_len, 0);
 
-    _xid_itf.itf_num = itf_desc->bInterfaceNumber;
+    // Claim the next free port
+    xid_interface_t* xid = find_itf(0xFF);
+    TU_VERIFY(xid != NULL, 0);
+    xid->itf_num = itf_desc->bInterfaceNumber;
 
     // Parse and open endpoints
     uint8_t const* p_desc = (uint8_t const*)itf_desc;
@@ -139,21 +163,21 @@ static uint16_t xid_open(uint8_t rhport, tusb_desc_interface_t const* itf_desc,
         TU_VERIFY(usbd_edpt_open(rhport, ep_desc), 0);
 
         if (tu_edpt_dir(ep_desc->bEndpointAddress) == TUSB_DIR_IN) {
-            _xid_itf.ep_in = ep_desc->bEndpointAddress;
+            xid->ep_in = ep_desc->bEndpointAddress;
         } else {
-            _xid_itf.ep_out = ep_desc->bEndpointAddress;
+            xid->ep_out = ep_desc->bEndpointAddress;
         }
 
         p_desc = tu_desc_next(p_desc);
     }
 
     // Start receiving on OUT endpoint
-    if (_xid_itf.ep_out != 0xFF) {
-        usbd_edpt_xfer(rhport, _xid_itf.ep_out, _xid_itf.ep_out_buf, sizeof(_xid_itf.ep_out_buf));
+    if (xid->ep_out != 0xFF) {
+        usbd_edpt_xfer(rhport, xid->ep_out, xid->ep_out_buf, sizeof(xid->ep_out_buf));
     }
 
-    TU_LOG1("[XID] Opened interface %u, EP IN=0x%02X, EP OUT=0x%02X\r\n",
-            _xid_itf.itf_num, _xid_itf.ep_in, _xid_itf.ep_out);
+    TU_LOG1("[XID] Opened port %u: interface %u, EP IN=0x%02X, EP OUT=0x%02X\r\n",
+            (unsigned)(xid - _xid_itf), xid->itf_num, xid->ep_in, xid->ep_out);
 
     return drv_len;
 }
@@ -165,8 +189,9 @@ static bool xid_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_requ
         return false;
     }
 
-    // Verify interface number
-    if (request->wIndex != _xid_itf.itf_num) {
+    // Route to the port that owns this interface
+    xid_interface_t* xid = find_itf((uint8_t)request->wIndex);
+    if (xid == NULL) {
         return false;
     }
 
@@ -178,7 +203,7 @@ static bool xid_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_requ
             if (stage == CONTROL_STAGE_SETUP) {
                 TU_LOG2("[XID] GET_REPORT\r\n");
                 uint16_t len = TU_MIN(request->wLength, sizeof(xbox_og_in_report_t));
-                tud_control_xfer(rhport, request, &_xid_itf.in_report, len);
+                tud_control_xfer(rhport, request, &xid->in_report, len);
             }
             return true;
 
@@ -187,10 +212,10 @@ static bool xid_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_requ
             if (stage == CONTROL_STAGE_SETUP) {
                 TU_LOG2("[XID] SET_REPORT (rumble)\r\n");
                 uint16_t len = TU_MIN(request->wLength, sizeof(xbox_og_out_report_t));
-                tud_control_xfer(rhport, request, &_xid_itf.out_report, len);
+                tud_control_xfer(rhport, request, &xid->out_report, len);
             } else if (stage == CONTROL_STAGE_ACK) {
                 // Data received, mark rumble available
-                _xid_itf.rumble_available = true;
+                xid->rumble_available = true;
             }
             return true;
 
@@ -236,15 +261,16 @@ static bool xid_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, u
 {
     (void)result;
 
-    if (ep_addr == _xid_itf.ep_out) {
+    xid_interface_t* xid = find_ep(ep_addr);
+    if (xid != NULL && ep_addr == xid->ep_out) {
         // Received rumble data on OUT endpoint
         if (xferred_bytes >= sizeof(xbox_og_out_report_t)) {
-            memcpy(&_xid_itf.out_report, _xid_itf.ep_out_buf, sizeof(xbox_og_out_report_t));
-            _xid_itf.rumble_available = true;
+            memcpy(&xid->out_report, xid->ep_out_buf, sizeof(xbox_og_out_report_t));
+            xid->rumble_available = true;
         }
 
         // Queue next receive
-        usbd_edpt_xfer(rhport, _xid_itf.ep_out, _xid_itf.ep_out_buf, sizeof(_xid_itf.ep_out_buf));
+        usbd_edpt_xfer(rhport, xid->ep_out, xid->ep_out_buf, sizeof(xid->ep_out_buf));
     }
 
     return true;
@@ -278,39 +304,44 @@ const usbd_class_driver_t* tud_xid_class_driver(void)
 // PUBLIC API
 // ============================================================================
 
-bool tud_xid_ready(void)
+bool tud_xid_n_ready(uint8_t port)
 {
+    TU_VERIFY(port < CFG_TUD_XID_PORTS);
+    xid_interface_t* xid = &_xid_itf[port];
     return tud_ready() &&
-           (_xid_itf.ep_in != 0xFF) &&
-           !usbd_edpt_busy(0, _xid_itf.ep_in);
+           (xid->ep_in != 0xFF) &&
+           !usbd_edpt_busy(0, xid->ep_in);
 }
 
-bool tud_xid_send_report(const xbox_og_in_report_t* report)
+bool tud_xid_n_send_report(uint8_t port, const xbox_og_in_report_t* report)
 {
     TU_VERIFY(report != NULL);
-    TU_VERIFY(tud_xid_ready());
+    TU_VERIFY(tud_xid_n_ready(port));
+    xid_interface_t* xid = &_xid_itf[port];
 
     // Update internal report state
-    memcpy(&_xid_itf.in_report, report, sizeof(xbox_og_in_report_t));
+    memcpy(&xid->in_report, report, sizeof(xbox_og_in_report_t));
 
     // Copy to endpoint buffer
-    memcpy(_xid_itf.ep_in_buf, report, sizeof(xbox_og_in_report_t));
+    memcpy(xid->ep_in_buf, report, sizeof(xbox_og_in_report_t));
 
     // Wake host if suspended
     if (tud_suspended()) {
         tud_remote_wakeup();
     }
 
-    return usbd_edpt_xfer(0, _xid_itf.ep_in, _xid_itf.ep_in_buf, sizeof(xbox_og_in_report_t));
+    return usbd_edpt_xfer(0, xid->ep_in, xid->ep_in_buf, sizeof(xbox_og_in_report_t));
 }
 
-bool tud_xid_get_rumble(xbox_og_out_report_t* rumble)
+bool tud_xid_n_get_rumble(uint8_t port, xbox_og_out_report_t* rumble)
 {
     TU_VERIFY(rumble != NULL);
+    TU_VERIFY(port < CFG_TUD_XID_PORTS);
+    xid_interface_t* xid = &_xid_itf[port];
 
-    if (_xid_itf.rumble_available) {
-        memcpy(rumble, &_xid_itf.out_report, sizeof(xbox_og_out_report_t));
-        _xid_itf.rumble_available = false;
+    if (xid->rumble_available) {
+        memcpy(rumble, &xid->out_report, sizeof(xbox_og_out_report_t));
+        xid->rumble_available = false;
         return true;
     }
 
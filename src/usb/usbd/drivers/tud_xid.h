@@ -26,6 +26,13 @@
 #define CFG_TUD_XID_EP_BUFSIZE 32
 #endif
 
+// Number of XID interfaces the driver can open (one per controller port).
+// The four-port mode needs 4 IN + 4 OUT endpoints, so it's only enabled on
+// controllers with enough of them.
+#ifndef CFG_TUD_XID_PORTS
+#define CFG_TUD_XID_PORTS 1
+#endif
+
 // ============================================================================
 // XID TYPES
 // ============================================================================
@@ -39,17 +46,35 @@ typedef enum {
 // XID API
 // ============================================================================
 
-// Check if XID device is ready to send a report
-bool tud_xid_ready(void);
+// Per-port API. Ports are numbered in interface order (the first XID
+// interface opened is port 0).
+
+// Check if a port is open and its IN endpoint is free
+bool tud_xid_n_ready(uint8_t port);
 
-// Send gamepad input report (20 bytes)
+// Send gamepad input report (20 bytes) on a port
 // Returns true if transfer was queued successfully
-bool tud_xid_send_report(const xbox_og_in_report_t* report);
+bool tud_xid_n_send_report(uint8_t port, const xbox_og_in_report_t* report);
+
+// Get rumble output report (6 bytes) for a port
+// Returns true if new rumble data arrived since the last call
+bool tud_xid_n_get_rumble(uint8_t port, xbox_og_out_report_t* rumble);
+
+// Single-port wrappers (port 0)
+static inline bool tud_xid_ready(void)
+{
+    return tud_xid_n_ready(0);
+}
+
+static inline bool tud_xid_send_report(const xbox_og_in_report_t* report)
+{
+    return tud_xid_n_send_report(0, report);
+}
 
-// Get rumble output report (6 bytes)
-// Call this to retrieve the latest rumble values from host
-// Returns true if rumble data is available
-bool tud_xid_get_rumble(xbox_og_out_report_t* rumble);
+static inline bool tud_xid_get_rumble(xbox_og_out_report_t* rumble)
+{
+    return tud_xid_n_get_rumble(0, rumble);
+}
 
 // ============================================================================
 // CLASS DRIVER (internal)
@@ -0,0 +1,132 @@
+// xgip_pipe.c - Windowed GIP message sender
+
+#include "xgip_pipe.h"
+#include <string.h>
+
+_Static_assert(XGIP_PIPE_WINDOW >= 5, "XGIP_PIPE_WINDOW must cover one ACK interval");
+
+void xgip_pipe_init(xgip_pipe_t* pipe)
+{
+    memset(pipe, 0, sizeof(*pipe));
+}
+
+void xgip_pipe_abort(xgip_pipe_t* pipe)
+{
+    pipe->active = false;
+    pipe->count = 0;
+    pipe->next = 0;
+    pipe->acked = 0;
+}
+
+bool xgip_pipe_start(xgip_pipe_t* pipe, uint8_t cmd, uint8_t seq,
+                     bool chunked, bool needs_ack,
+                     const uint8_t* data, uint16_t len, uint32_t now_ms)
+{
+    xgip_pipe_abort(pipe);
+    if (len > XGIP_MAX_DATA_SIZE) {
+        return false;
+    }
+
+    // Let the existing encoder produce every packet (chunk offsets, the
+    // 0x80 length encoding, ACK flags, end marker) so the bytes on the wire
+    // match the one-packet-per-pass path exactly
+    xgip_t xgip;
+    xgip_init(&xgip);
+    xgip_set_attributes(&xgip, cmd, seq, 1, chunked, needs_ack);
+    if (len && !xgip_set_data(&xgip, data, len)) {
+        return false;
+    }
+
+    do {
+        uint8_t* packet = xgip_generate_packet(&xgip);
+        uint8_t n = xgip_get_packet_length(&xgip);
+        memcpy(pipe->packets[pipe->count], packet, n);
+        pipe->lengths[pipe->count] = n;
+        pipe->ack_flag[pipe->count] = xgip_get_packet_ack(&xgip);
+        pipe->count++;
+    } while (xgip_is_chunked(&xgip) && !xgip_end_of_chunk(&xgip) &&
+             pipe->count < XGIP_PIPE_MAX_PACKETS);
+
+    xgip_reset(&xgip);
+
+    pipe->command = cmd;
+    pipe->sequence = seq;
+    pipe->active = true;
+    pipe->start_ms = now_ms;
+    pipe->progress_ms = now_ms;
+    pipe->messages++;
+    return true;
+}
+
+// Oldest sent chunk still waiting for its ACK, or -1
+static int oldest_unacked(const xgip_pipe_t* pipe)
+{
+    for (uint8_t i = pipe->acked; i < pipe->next; i++) {
+        if (pipe->ack_flag[i]) return i;
+    }
+    return -1;
+}
+
+static void check_done(xgip_pipe_t* pipe, uint32_t now_ms)
+{
+    if (!xgip_pipe_sent(pipe)) {
+        return;
+    }
+    if (oldest_unacked(pipe) >= 0) {
+        return;
+    }
+    pipe->acked = pipe->count;
+    pipe->active = false;
+    pipe->last_ms = now_ms - pipe->start_ms;
+}
+
+bool xgip_pipe_ack(xgip_pipe_t* pipe, const uint8_t* packet, uint16_t len, uint32_t now_ms)
+{
+    // ACK payload byte 1 (packet[5]) names the command being acknowledged.
+    // Receivers ACK flagged chunks in order, so each one retires the oldest.
+    if (!pipe->active || len < 6 || packet[0] != GIP_ACK_RESPONSE ||
+        packet[5] != pipe->command) {
+        return false;
+    }
+
+    int i = oldest_unacked(pipe);
+    if (i < 0) {
+        return false;
+    }
+
+    pipe->acked = (uint8_t)(i + 1);
+    pipe->acks++;
+    pipe->progress_ms = now_ms;
+    check_done(pipe, now_ms);
+    return true;
+}
+
+uint8_t xgip_pipe_pump(xgip_pipe_t* pipe, xgip_pipe_send_fn send, uint32_t now_ms)
+{
+    if (!pipe->active) {
+        return 0;
+    }
+
+    // Lost ACK: treat the oldest flagged chunk as delivered and move on
+    int stuck = oldest_unacked(pipe);
+    if (stuck >= 0 && (now_ms - pipe->progress_ms) >= XGIP_PIPE_ACK_TIMEOUT_MS) {
+        pipe->acked = (uint8_t)(stuck + 1);
+        pipe->ack_timeouts++;
+        pipe->progress_ms = now_ms;
+    }
+
+    uint8_t sent = 0;
+    while (pipe->next < pipe->count &&
+           (uint8_t)(pipe->next - pipe->acked) < XGIP_PIPE_WINDOW) {
+        if (!send(pipe->packets[pipe->next], pipe->lengths[pipe->next])) {
+            break;
+        }
+        pipe->next++;
+        pipe->packets_sent++;
+        pipe->progress_ms = now_ms;
+        sent++;
+    }
+
+    check_done(pipe, now_ms);
+    return sent;
+}
@@ -0,0 +1,79 @@
+// xgip_pipe.h - Windowed GIP message sender
+//
+// Segments one GIP message into its chunk packets up front (using the
+// xgip_protocol encoder) and streams them as fast as the endpoint accepts,
+// keeping up to XGIP_PIPE_WINDOW chunks in flight past the receiver's last
+// ACK instead of stopping at every ACK-flagged chunk. Shared by the console
+// side (tud_xbone) and the controller side (xbone_auth) of auth passthrough.
+
+#ifndef XGIP_PIPE_H
+#define XGIP_PIPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "xgip_protocol.h"
+
+// Largest message (XGIP_MAX_DATA_SIZE) in GIP_MAX_CHUNK_SIZE chunks, plus
+// the end-of-chunk marker
+#define XGIP_PIPE_MAX_PACKETS  ((XGIP_MAX_DATA_SIZE + GIP_MAX_CHUNK_SIZE - 1) / GIP_MAX_CHUNK_SIZE + 1)
+
+// Chunks allowed past the last acknowledged one. The encoder flags every
+// 5th chunk for ACK, so anything below 5 would stall between ACK points.
+#ifndef XGIP_PIPE_WINDOW
+#define XGIP_PIPE_WINDOW        8
+#endif
+
+// Slide past an ACK that never comes (same policy as the old stop-and-wait)
+#define XGIP_PIPE_ACK_TIMEOUT_MS 2000
+
+// Endpoint send hook: false means busy, try again later
+typedef bool (*xgip_pipe_send_fn)(const uint8_t* packet, uint16_t len);
+
+typedef struct {
+    uint8_t  packets[XGIP_PIPE_MAX_PACKETS][64];
+    uint8_t  lengths[XGIP_PIPE_MAX_PACKETS];
+    bool     ack_flag[XGIP_PIPE_MAX_PACKETS];  // Receiver will ACK this chunk
+    uint8_t  count;             // Packets in this message
+    uint8_t  next;              // Next packet to send
+    uint8_t  acked;             // Packets covered by the receiver's ACKs
+    uint8_t  command;
+    uint8_t  sequence;
+    bool     active;
+    uint32_t start_ms;
+    uint32_t progress_ms;       // Last send or ACK, for the ACK timeout
+
+    // Counters since init
+    uint32_t messages;
+    uint32_t packets_sent;
+    uint32_t acks;
+    uint32_t ack_timeouts;
+    uint32_t last_ms;           // Start to fully acknowledged, last message
+} xgip_pipe_t;
+
+// Clear state and counters
+void xgip_pipe_init(xgip_pipe_t* pipe);
+
+// Drop the message in flight (counters are kept)
+void xgip_pipe_abort(xgip_pipe_t* pipe);
+
+// Segment a message. Replaces any message still in flight.
+// Returns false if the data is too large.
+bool xgip_pipe_start(xgip_pipe_t* pipe, uint8_t cmd, uint8_t seq,
+                     bool chunked, bool needs_ack,
+                     const uint8_t* data, uint16_t len, uint32_t now_ms);
+
+// Feed a GIP_ACK_RESPONSE packet from the receiver. Returns true if it
+// acknowledged a chunk of this message.
+bool xgip_pipe_ack(xgip_pipe_t* pipe, const uint8_t* packet, uint16_t len, uint32_t now_ms);
+
+// Send as many packets as the window and endpoint allow. Returns the
+// number sent. Call again on endpoint completion, ACK, or from the task.
+uint8_t xgip_pipe_pump(xgip_pipe_t* pipe, xgip_pipe_send_fn send, uint32_t now_ms);
+
+// Message still sending or waiting for ACKs
+static inline bool xgip_pipe_busy(const xgip_pipe_t* pipe) { return pipe->active; }
+
+// Every packet of the message has been handed to the endpoint
+static inline bool xgip_pipe_sent(const xgip_pipe_t* pipe) { return pipe->next >= pipe->count; }
+
+#endif // XGIP_PIPE_H
@@ -65,36 +65,97 @@ static const kbmouse_button_map_t default_button_map[] = {
 
 #define DEFAULT_MAP_COUNT (sizeof(default_button_map) / sizeof(default_button_map[0]))
 
+// ============================================================================
+// MOTION ACCUMULATOR
+// ============================================================================
+
+#define SUBPIXEL_ONE        (1 << KBMOUSE_SUBPIXEL_SHIFT)
+
+// Keep pending motion well inside int32 even for a long stall
+#define ACCUM_LIMIT         (1L << 30)
+
+static int32_t accum_add_sat(int32_t acc, int32_t add)
+{
+    int64_t sum = (int64_t)acc + add;
+    if (sum > ACCUM_LIMIT) return ACCUM_LIMIT;
+    if (sum < -ACCUM_LIMIT) return -ACCUM_LIMIT;
+    return (int32_t)sum;
+}
+
+// Take the whole counts (truncated toward zero, clamped to limit) out of
+// *acc, leaving the fraction and anything beyond limit for the next report
+static int32_t accum_take(int32_t* acc, int32_t limit)
+{
+    int32_t whole = *acc / SUBPIXEL_ONE;
+    if (whole > limit) whole = limit;
+    if (whole < -limit) whole = -limit;
+    *acc -= whole * SUBPIXEL_ONE;
+    return whole;
+}
+
+void kbmouse_accum_reset(kbmouse_accum_t* accum)
+{
+    memset(accum, 0, sizeof(*accum));
+}
+
+void kbmouse_accum_add(kbmouse_accum_t* accum, int32_t dx, int32_t dy,
+                       int32_t wheel, int32_t pan)
+{
+    accum->x = accum_add_sat(accum->x, dx * SUBPIXEL_ONE);
+    accum->y = accum_add_sat(accum->y, dy * SUBPIXEL_ONE);
+    accum->wheel = accum_add_sat(accum->wheel, wheel * SUBPIXEL_ONE);
+    accum->pan = accum_add_sat(accum->pan, pan * SUBPIXEL_ONE);
+}
+
+bool kbmouse_accum_pending(const kbmouse_accum_t* accum)
+{
+    return accum->x / SUBPIXEL_ONE != 0 || accum->y / SUBPIXEL_ONE != 0 ||
+           accum->wheel / SUBPIXEL_ONE != 0 || accum->pan / SUBPIXEL_ONE != 0;
+}
+
+bool kbmouse_accum_drain(kbmouse_accum_t* accum, kbmouse_mouse_report_t* report)
+{
+    report->x = (int16_t)accum_take(&accum->x, 32767);
+    report->y = (int16_t)accum_take(&accum->y, 32767);
+    report->wheel = (int8_t)accum_take(&accum->wheel, 127);
+    report->pan = (int8_t)accum_take(&accum->pan, 127);
+    return report->x || report->y || report->wheel || report->pan;
+}
+
 // ============================================================================
 // ANALOG PROCESSING
 // ============================================================================
 
-// Max mouse pixels per USB poll at default sensitivity (5).
-// At ~125Hz polling: 15 * 125 = 1875 px/sec max (crosses 1080p in ~1s).
-#define MOUSE_MAX_SPEED 15.0f
+// Max mouse speed at default sensitivity (5), in pixels per second.
+// Same feel as the old 15 px per report at ~125Hz polling: crosses 1080p in
+// ~1s. Expressed per second so 1ms polling doesn't make the cursor 8x faster.
+#define MOUSE_MAX_SPEED_PPS 1875.0f
+
+// Longest gap integrated in one tick. Covers main-loop stalls without
+// launching the cursor after the mode has been idle for a while.
+#define MOUSE_MAX_TICK_US   100000
 
-// Sub-pixel accumulators for smooth low-speed movement
-static float mouse_accum_x = 0.0f;
-static float mouse_accum_y = 0.0f;
-static float scroll_accum = 0.0f;
+// Right stick position latched by kbmouse_convert(), integrated over time by
+// kbmouse_motion_tick()
+static uint8_t stick_x = 128;
+static uint8_t stick_y = 128;
+static uint32_t last_tick_us = 0;
+static bool tick_started = false;
 
 // Previous Rz value for delta-based scroll
 static uint8_t prev_rz = 128;
 
-// Apply deadzone, cubic curve, and sub-pixel accumulation.
+// Apply deadzone and cubic curve; returns pointer speed in pixels/second.
 // Cubic (x³) gives a large precision zone: 50% deflection = 12.5% of max speed,
-// while full deflection still reaches max. Sub-pixel accumulation ensures smooth
-// low-speed movement by carrying fractional pixels between polls.
-static int8_t process_analog_to_mouse(uint8_t analog, uint8_t deadzone,
-                                       uint8_t sensitivity, float* accumulator)
+// while full deflection still reaches max.
+static float analog_to_mouse_speed(uint8_t analog, uint8_t deadzone,
+                                   uint8_t sensitivity)
 {
     // Center analog value to signed
     int16_t centered = (int16_t)analog - 128;
 
-    // Apply deadzone — reset accumulator to prevent drift
     if (abs(centered) < deadzone) {
-        *accumulator = 0.0f;
-        return 0;
+        return 0.0f;
     }
 
     // Calculate sign and magnitude
@@ -111,16 +172,51 @@ static int8_t process_analog_to_mouse(uint8_t analog, uint8_t deadzone,
     // Scale by sensitivity (1-10 maps to 0.2-2.0)
     float sens_factor = (float)sensitivity / 5.0f;
 
-    // Accumulate sub-pixel movement
-    *accumulator += curved * MOUSE_MAX_SPEED * sens_factor * sign;
+    return curved * MOUSE_MAX_SPEED_PPS * sens_factor * sign;
+}
+
+// Add one axis of stick motion. A centered stick drops the leftover
+// fraction so the cursor doesn't creep after release.
+static void integrate_axis(int32_t* acc, float speed, uint32_t dt_us)
+{
+    if (speed == 0.0f) {
+        *acc -= *acc % SUBPIXEL_ONE;
+        return;
+    }
+    float counts = speed * (float)dt_us * ((float)SUBPIXEL_ONE / 1000000.0f);
+    *acc = accum_add_sat(*acc, (int32_t)counts);
+}
+
+void kbmouse_motion_tick(kbmouse_accum_t* accum, uint32_t now_us)
+{
+    if (!tick_started) {
+        tick_started = true;
+        last_tick_us = now_us;
+        return;
+    }
+
+    uint32_t dt_us = now_us - last_tick_us;
+    last_tick_us = now_us;
+    if (dt_us > MOUSE_MAX_TICK_US) dt_us = MOUSE_MAX_TICK_US;
 
-    // Extract integer pixels, keep fractional remainder
-    int8_t delta = (int8_t)*accumulator;
-    *accumulator -= (float)delta;
+    integrate_axis(&accum->x, analog_to_mouse_speed(stick_x,
+                   analog_config.deadzone, analog_config.sensitivity), dt_us);
+    integrate_axis(&accum->y, analog_to_mouse_speed(stick_y,
+                   analog_config.deadzone, analog_config.sensitivity), dt_us);
+}
 
-    return delta;
+void kbmouse_motion_release(void)
+{
+    stick_x = 128;
+    stick_y = 128;
 }
 
+static inline void nkro_set(kbmouse_nkro_report_t* kb, uint8_t usage)
+{
+    if (usage <= KBMOUSE_NKRO_MAX_USAGE) {
+        kb->bitmap[usage >> 3] |= (uint8_t)(1u << (usage & 7));
+    }
+}
 
 // ============================================================================
 // CONVERSION API
@@ -133,23 +229,22 @@ void kbmouse_init(void)
     analog_config.sensitivity = KBMOUSE_DEFAULT_SENSITIVITY;
     analog_config.scroll_deadzone = KBMOUSE_DEFAULT_SCROLL_DEADZONE;
     analog_config.scroll_speed = KBMOUSE_DEFAULT_SCROLL_SPEED;
-    mouse_accum_x = 0.0f;
-    mouse_accum_y = 0.0f;
-    scroll_accum = 0.0f;
+    stick_x = 128;
+    stick_y = 128;
+    tick_started = false;
     prev_rz = 128;
     keyboard_led_state = 0;
 }
 
 void kbmouse_convert(uint32_t buttons,
                      const profile_output_t* profile_out,
-                     kbmouse_keyboard_report_t* kb_report,
-                     kbmouse_mouse_report_t* mouse_report)
+                     kbmouse_nkro_report_t* kb_report,
+                     uint8_t* mouse_buttons,
+                     kbmouse_accum_t* accum)
 {
-    // Clear reports
-    memset(kb_report, 0, sizeof(kbmouse_keyboard_report_t));
-    memset(mouse_report, 0, sizeof(kbmouse_mouse_report_t));
-
-    uint8_t keycode_index = 0;
+    // Clear state
+    memset(kb_report, 0, sizeof(kbmouse_nkro_report_t));
+    *mouse_buttons = 0;
 
     // Process button mappings
     for (size_t i = 0; i < DEFAULT_MAP_COUNT; i++) {
@@ -159,10 +254,8 @@ void kbmouse_convert(uint32_t buttons,
         if (buttons & map->gamepad_button) {
             switch (map->type) {
                 case KBMOUSE_ACTION_KEY:
-                    // Add keycode if we have room (6 key rollover)
-                    if (keycode_index < 6) {
-                        kb_report->keycode[keycode_index++] = map->value;
-                    }
+                    // NKRO: every mapped key can be held at once
+                    nkro_set(kb_report, map->value);
                     break;
 
                 case KBMOUSE_ACTION_MODIFIER:
@@ -172,7 +265,7 @@ void kbmouse_convert(uint32_t buttons,
 
                 case KBMOUSE_ACTION_MOUSE_BTN:
                     // Add mouse button
-                    mouse_report->buttons |= map->value;
+                    *mouse_buttons |= map->value;
                     break;
 
                 default:
@@ -194,27 +287,16 @@ void kbmouse_convert(uint32_t buttons,
         int16_t rz_delta = (int16_t)profile_out->rz_analog - (int16_t)prev_rz;
         prev_rz = profile_out->rz_analog;
         if (rz_delta != 0) {
-            // scroll_speed 1-10 maps to 0.1-1.0 scaling
-            float scale = (float)analog_config.scroll_speed / 10.0f;
-            scroll_accum += (float)rz_delta * scale;
-            int8_t scroll_ticks = (int8_t)scroll_accum;
-            scroll_accum -= (float)scroll_ticks;
-            mouse_report->wheel = -scroll_ticks;
+            // scroll_speed 1-10 maps to 0.1-1.0 scaling; fraction carries
+            int32_t scroll = -(int32_t)rz_delta * analog_config.scroll_speed *
+                             SUBPIXEL_ONE / 10;
+            accum->wheel = accum_add_sat(accum->wheel, scroll);
         }
+        kbmouse_motion_release();
     } else {
         // Right stick -> Mouse movement (standard controllers)
-        mouse_report->x = process_analog_to_mouse(
-            profile_out->right_x,
-            analog_config.deadzone,
-            analog_config.sensitivity,
-            &mouse_accum_x
-        );
-        mouse_report->y = process_analog_to_mouse(
-            profile_out->right_y,
-            analog_config.deadzone,
-            analog_config.sensitivity,
-            &mouse_accum_y
-        );
+        stick_x = profile_out->right_x;
+        stick_y = profile_out->right_y;
     }
 
     // Left stick -> WASD keys (movement)
@@ -222,20 +304,39 @@ void kbmouse_convert(uint32_t buttons,
     const uint8_t wasd_deadzone = 40;
 
     // W - stick up (Y < center - deadzone)
-    if (profile_out->left_y < (128 - wasd_deadzone) && keycode_index < 6) {
-        kb_report->keycode[keycode_index++] = HID_KEY_W;
+    if (profile_out->left_y < (128 - wasd_deadzone)) {
+        nkro_set(kb_report, HID_KEY_W);
     }
     // S - stick down (Y > center + deadzone)
-    if (profile_out->left_y > (128 + wasd_deadzone) && keycode_index < 6) {
-        kb_report->keycode[keycode_index++] = HID_KEY_S;
+    if (profile_out->left_y > (128 + wasd_deadzone)) {
+        nkro_set(kb_report, HID_KEY_S);
     }
     // A - stick left (X < center - deadzone)
-    if (profile_out->left_x < (128 - wasd_deadzone) && keycode_index < 6) {
-        kb_report->keycode[keycode_index++] = HID_KEY_A;
+    if (profile_out->left_x < (128 - wasd_deadzone)) {
+        nkro_set(kb_report, HID_KEY_A);
     }
     // D - stick right (X > center + deadzone)
-    if (profile_out->left_x > (128 + wasd_deadzone) && keycode_index < 6) {
-        kb_report->keycode[keycode_index++] = HID_KEY_D;
+    if (profile_out->left_x > (128 + wasd_deadzone)) {
+        nkro_set(kb_report, HID_KEY_D);
+    }
+}
+
+void kbmouse_nkro_to_boot(const kbmouse_nkro_report_t* nkro,
+                          kbmouse_keyboard_report_t* boot)
+{
+    memset(boot, 0, sizeof(kbmouse_keyboard_report_t));
+    boot->modifier = nkro->modifier;
+
+    uint8_t count = 0;
+    // Usages 0-3 are reserved/error codes, never real keys
+    for (uint16_t usage = HID_KEY_A; usage <= KBMOUSE_NKRO_MAX_USAGE; usage++) {
+        if (!(nkro->bitmap[usage >> 3] & (1u << (usage & 7)))) continue;
+        if (count == 6) {
+            // Phantom state: ErrorRollOver in every slot
+            memset(boot->keycode, 0x01, sizeof(boot->keycode));
+            return;
+        }
+        boot->keycode[count++] = (uint8_t)usage;
     }
 }
 
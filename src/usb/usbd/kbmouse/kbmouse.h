@@ -17,22 +17,52 @@
 // REPORT STRUCTURES
 // ============================================================================
 
-// Keyboard report (matches HID descriptor with report ID 1)
+// Boot-protocol keyboard report (6KRO), sent instead of the NKRO report
+// while the host has the keyboard interface in boot protocol
 typedef struct __attribute__((packed)) {
     uint8_t modifier;       // Modifier keys (Ctrl, Shift, Alt, GUI)
     uint8_t reserved;       // Reserved byte
     uint8_t keycode[6];     // Up to 6 simultaneous keycodes
 } kbmouse_keyboard_report_t;
 
-// Mouse report (matches HID descriptor with report ID 2)
+// NKRO keyboard report (kbmouse_keyboard_report_descriptor, no report ID):
+// one bit per usage 0x00..KBMOUSE_NKRO_MAX_USAGE. 14 bitmap bytes keep
+// modifier + bitmap inside the 16-byte keyboard endpoint; the range covers
+// every key up to F20.
+#define KBMOUSE_NKRO_BYTES      14
+#define KBMOUSE_NKRO_MAX_USAGE  (KBMOUSE_NKRO_BYTES * 8 - 1)
+
+typedef struct __attribute__((packed)) {
+    uint8_t modifier;                   // Modifier keys (Ctrl, Shift, Alt, GUI)
+    uint8_t bitmap[KBMOUSE_NKRO_BYTES]; // bit (usage % 8) of byte (usage / 8)
+} kbmouse_nkro_report_t;
+
+// Mouse report (same layout as sinput_mouse_report_t, no report ID)
 typedef struct __attribute__((packed)) {
     uint8_t buttons;        // Button states (5 buttons)
-    int8_t x;               // X movement (-127 to 127)
-    int8_t y;               // Y movement (-127 to 127)
+    int16_t x;              // X movement (-32767 to 32767)
+    int16_t y;              // Y movement (-32767 to 32767)
     int8_t wheel;           // Vertical scroll (-127 to 127)
     int8_t pan;             // Horizontal scroll (-127 to 127)
 } kbmouse_mouse_report_t;
 
+// ============================================================================
+// MOTION ACCUMULATOR
+// ============================================================================
+
+// Pending relative motion in 24.8 fixed point. Stick conversion adds
+// fractional counts, real mice add whole counts; draining takes the whole
+// part (clamped to the report range) and carries the rest, so nothing is
+// dropped when reports are missed or the host polls slower than input.
+#define KBMOUSE_SUBPIXEL_SHIFT  8
+
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t wheel;
+    int32_t pan;
+} kbmouse_accum_t;
+
 // ============================================================================
 // KEYBOARD MODIFIERS
 // ============================================================================
@@ -101,15 +131,39 @@ typedef struct {
 // Initialize keyboard/mouse converter
 void kbmouse_init(void);
 
-// Convert gamepad buttons and analog values to keyboard/mouse reports
+// Convert gamepad buttons and analog values to keyboard/mouse state
 // buttons: remapped button state from profile_output_t
 // profile_out: contains analog values after profile processing
-// kb_report: output keyboard report
-// mouse_report: output mouse report
+// kb_report: output NKRO keyboard state
+// mouse_buttons: output mouse button mask
+// accum: receives twist-scroll; right stick is latched for kbmouse_motion_tick()
 void kbmouse_convert(uint32_t buttons,
                      const profile_output_t* profile_out,
-                     kbmouse_keyboard_report_t* kb_report,
-                     kbmouse_mouse_report_t* mouse_report);
+                     kbmouse_nkro_report_t* kb_report,
+                     uint8_t* mouse_buttons,
+                     kbmouse_accum_t* accum);
+
+// Integrate right-stick pointer motion since the previous tick into accum.
+// Speed is per second, not per report, so the cursor moves the same
+// distance whatever the poll rate.
+void kbmouse_motion_tick(kbmouse_accum_t* accum, uint32_t now_us);
+
+// Stop stick motion (e.g. a plain mouse took over the pointer)
+void kbmouse_motion_release(void);
+
+// Derive a boot-protocol 6KRO report from NKRO state. More than six keys
+// reports ErrorRollOver in every slot, as the HID spec requires.
+void kbmouse_nkro_to_boot(const kbmouse_nkro_report_t* nkro,
+                          kbmouse_keyboard_report_t* boot);
+
+// Motion accumulator
+void kbmouse_accum_reset(kbmouse_accum_t* accum);
+void kbmouse_accum_add(kbmouse_accum_t* accum, int32_t dx, int32_t dy,
+                       int32_t wheel, int32_t pan);
+bool kbmouse_accum_pending(const kbmouse_accum_t* accum);
+// Move whole counts into report (x/y/wheel/pan only); returns true if any
+// were non-zero
+bool kbmouse_accum_drain(kbmouse_accum_t* accum, kbmouse_mouse_report_t* report);
 
 // Get/set analog configuration
 const kbmouse_analog_config_t* kbmouse_get_config(void);
@@ -125,7 +125,7 @@ static bool hid_mode_send_report(uint8_t player_index,
     hid_report.pressure_l2         = profile_out->l2_analog;
     hid_report.pressure_r2         = profile_out->r2_analog;
 
-    return tud_hid_report(0, &hid_report, sizeof(hid_report));
+    return usbd_report_send(0, 0, &hid_report, sizeof(hid_report));
 }
 
 static const uint8_t* hid_mode_get_report_descriptor(void)
@@ -152,6 +152,7 @@ const usbd_mode_t hid_mode = {
     .init = hid_mode_init,
     .send_report = hid_mode_send_report,
     .is_ready = hid_mode_is_ready,
+    .repeat_policy = USBD_REPEAT_HID_IDLE,
 
     // No feedback support for generic HID
     .handle_output = NULL,
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2024 Robert Dale Smith
 
+#include "platform/platform.h"
 #include "tusb.h"
 #include "../usbd_mode.h"
 #include "../usbd.h"
@@ -15,8 +16,137 @@
 // STATE
 // ============================================================================
 
-static kbmouse_keyboard_report_t kbmouse_kb_report;
-static kbmouse_mouse_report_t kbmouse_mouse_report;
+// Current keyboard/mouse state and what the host last received. Reports go
+// out only on change (or pending motion), so the 1ms endpoints aren't kept
+// busy with repeats.
+static kbmouse_nkro_report_t kbmouse_kb_state;
+static kbmouse_nkro_report_t kbmouse_kb_sent;
+static kbmouse_keyboard_report_t kbmouse_boot_sent;
+static uint8_t kbmouse_kb_protocol;     // Keyboard protocol kbmouse_kb_sent was sent in
+static uint8_t kbmouse_mouse_buttons;
+static uint8_t kbmouse_mouse_buttons_sent;
+
+// Pending relative motion: real-mouse deltas from every input event plus
+// stick motion, drained into as many reports as it takes
+static kbmouse_accum_t kbmouse_accum;
+
+// Button edges seen by on_input since the last frame. usbd coalesces events
+// to the newest one, so without these a tap shorter than one frame (or a
+// release + re-press) would never reach the host.
+static uint32_t kbmouse_raw_buttons;
+static uint32_t kbmouse_press_latch;
+static uint32_t kbmouse_release_latch;
+static uint32_t kbmouse_frame_buttons;
+
+// ============================================================================
+// FRAME MERGING
+// ============================================================================
+
+static void kbmouse_mode_on_input(uint8_t player_index, const input_event_t* event)
+{
+    // Deltas from any player add up: two mice both move the one cursor. An
+    // IR pointer (Wiimote) moves it too while it is on screen.
+    if (event->type == INPUT_TYPE_MOUSE || event->has_pointer) {
+        kbmouse_accum_add(&kbmouse_accum, event->delta_x, event->delta_y,
+                          event->delta_wheel, 0);
+    }
+
+    // Only player 0 drives keys and buttons (see usbd_task)
+    if (player_index != 0) return;
+
+    uint32_t cur = event->buttons;
+    kbmouse_press_latch |= cur & ~kbmouse_raw_buttons;
+    kbmouse_release_latch |= kbmouse_raw_buttons & ~cur;
+    kbmouse_raw_buttons = cur;
+}
+
+uint32_t kbmouse_mode_merge_buttons(uint32_t buttons)
+{
+    // Taps that came and went since the last frame are held for this one
+    uint32_t out = buttons | kbmouse_press_latch;
+
+    // Released and pressed again since the last frame: report the release
+    // now and the new press next frame
+    uint32_t bounce = kbmouse_release_latch & kbmouse_frame_buttons & buttons;
+    out &= ~bounce;
+
+    kbmouse_press_latch &= bounce;
+    kbmouse_release_latch = 0;
+    kbmouse_frame_buttons = out;
+    return out;
+}
+
+bool kbmouse_mode_has_latched_buttons(void)
+{
+    // A press still to report, or a frame that showed a tap or a bounce and
+    // must catch up with the live buttons. Without the second, a tap from a
+    // controller that only reports on change stays held until its next event.
+    return kbmouse_press_latch != 0 || kbmouse_frame_buttons != kbmouse_raw_buttons;
+}
+
+// The last frame's keys or buttons haven't all reached the host (a report
+// was refused). usbd holds new input until they have, so a tap can't be
+// replaced before it was ever sent.
+bool kbmouse_mode_frame_unsent(void)
+{
+    return memcmp(&kbmouse_kb_state, &kbmouse_kb_sent, sizeof(kbmouse_kb_state)) != 0 ||
+           kbmouse_mouse_buttons != kbmouse_mouse_buttons_sent;
+}
+
+// Push whatever differs from what the host has: at most one keyboard and
+// one mouse report per call
+static bool kbmouse_mode_flush(void)
+{
+    bool sent = false;
+
+    // A BIOS or KVM that selects boot protocol ignores the report descriptor
+    // and reads the standard 8-byte report. After a switch either way the
+    // host holds no keys, so everything held goes out again.
+    uint8_t protocol = tud_hid_n_get_protocol(ITF_NUM_HID_KEYBOARD);
+    if (protocol != kbmouse_kb_protocol) {
+        kbmouse_kb_protocol = protocol;
+        memset(&kbmouse_kb_sent, 0, sizeof(kbmouse_kb_sent));
+        memset(&kbmouse_boot_sent, 0, sizeof(kbmouse_boot_sent));
+    }
+
+    if (tud_hid_n_ready(ITF_NUM_HID_KEYBOARD) &&
+        memcmp(&kbmouse_kb_state, &kbmouse_kb_sent, sizeof(kbmouse_kb_state)) != 0) {
+        if (protocol == HID_PROTOCOL_BOOT) {
+            kbmouse_keyboard_report_t boot;
+            kbmouse_nkro_to_boot(&kbmouse_kb_state, &boot);
+            if (memcmp(&boot, &kbmouse_boot_sent, sizeof(boot)) == 0) {
+                // Past six keys the boot report stays at ErrorRollOver
+                kbmouse_kb_sent = kbmouse_kb_state;
+            } else if (tud_hid_n_report(ITF_NUM_HID_KEYBOARD, 0, &boot, sizeof(boot))) {
+                kbmouse_boot_sent = boot;
+                kbmouse_kb_sent = kbmouse_kb_state;
+                sent = true;
+            }
+        } else if (tud_hid_n_report(ITF_NUM_HID_KEYBOARD, 0,
+                                    &kbmouse_kb_state, sizeof(kbmouse_kb_state))) {
+            kbmouse_kb_sent = kbmouse_kb_state;
+            sent = true;
+        }
+    }
+
+    kbmouse_motion_tick(&kbmouse_accum, platform_time_us());
+
+    if (tud_hid_n_ready(ITF_NUM_HID_MOUSE) &&
+        (kbmouse_mouse_buttons != kbmouse_mouse_buttons_sent ||
+         kbmouse_accum_pending(&kbmouse_accum))) {
+        kbmouse_accum_t before = kbmouse_accum;
+        kbmouse_mouse_report_t report = { .buttons = kbmouse_mouse_buttons };
+        kbmouse_accum_drain(&kbmouse_accum, &report);
+        if (tud_hid_n_report(ITF_NUM_HID_MOUSE, 0, &report, sizeof(report))) {
+            kbmouse_mouse_buttons_sent = kbmouse_mouse_buttons;
+            sent = true;
+        } else {
+            kbmouse_accum = before;  // not sent: keep the motion
+        }
+    }
+
+    return sent;
+}
 
 // ============================================================================
 // MODE INTERFACE IMPLEMENTATION
@@ -25,8 +155,17 @@ static kbmouse_mouse_report_t kbmouse_mouse_report;
 static void kbmouse_mode_init(void)
 {
     kbmouse_init();
-    memset(&kbmouse_kb_report, 0, sizeof(kbmouse_kb_report));
-    memset(&kbmouse_mouse_report, 0, sizeof(kbmouse_mouse_report));
+    memset(&kbmouse_kb_state, 0, sizeof(kbmouse_kb_state));
+    memset(&kbmouse_kb_sent, 0, sizeof(kbmouse_kb_sent));
+    memset(&kbmouse_boot_sent, 0, sizeof(kbmouse_boot_sent));
+    kbmouse_kb_protocol = HID_PROTOCOL_REPORT;
+    kbmouse_mouse_buttons = 0;
+    kbmouse_mouse_buttons_sent = 0;
+    kbmouse_accum_reset(&kbmouse_accum);
+    kbmouse_raw_buttons = 0;
+    kbmouse_press_latch = 0;
+    kbmouse_release_latch = 0;
+    kbmouse_frame_buttons = 0;
 }
 
 static bool kbmouse_mode_is_ready(void)
@@ -42,43 +181,36 @@ static bool kbmouse_mode_send_report(uint8_t player_index,
                                       uint32_t buttons)
 {
     (void)player_index;
-    (void)event;
-
-    // Convert gamepad to keyboard/mouse reports
-    kbmouse_convert(buttons, profile_out, &kbmouse_kb_report, &kbmouse_mouse_report);
-
-    // Send keyboard and mouse on separate interfaces (no report IDs needed)
-    bool kb_ok = tud_hid_n_keyboard_report(ITF_NUM_HID_KEYBOARD, 0,
-                                            kbmouse_kb_report.modifier,
-                                            kbmouse_kb_report.keycode);
-    bool mouse_ok = tud_hid_n_mouse_report(ITF_NUM_HID_MOUSE, 0,
-                                            kbmouse_mouse_report.buttons,
-                                            kbmouse_mouse_report.x,
-                                            kbmouse_mouse_report.y,
-                                            kbmouse_mouse_report.wheel,
-                                            kbmouse_mouse_report.pan);
-
-    return kb_ok || mouse_ok;
+
+    if (event->type == INPUT_TYPE_MOUSE && !event->as_gamepad) {
+        // Plain mouse: buttons pass straight through (motion was already
+        // accumulated in on_input); keys keep their current state
+        uint8_t mb = 0;
+        if (buttons & JP_BUTTON_B1) mb |= KBMOUSE_BTN_LEFT;
+        if (buttons & JP_BUTTON_B2) mb |= KBMOUSE_BTN_RIGHT;
+        if (buttons & JP_BUTTON_B3) mb |= KBMOUSE_BTN_MIDDLE;
+        kbmouse_mouse_buttons = mb;
+        kbmouse_motion_release();
+    } else {
+        // Convert gamepad to keyboard/mouse state
+        kbmouse_convert(buttons, profile_out, &kbmouse_kb_state,
+                        &kbmouse_mouse_buttons, &kbmouse_accum);
+    }
+
+    return kbmouse_mode_flush();
 }
 
-// Special handling for when no new input - still need to send mouse for continuous movement
+// No new input: keep stick motion flowing and flush anything still pending
 bool kbmouse_mode_send_idle_mouse(void)
 {
-    if (!tud_hid_n_ready(ITF_NUM_HID_MOUSE)) return false;
-
-    return tud_hid_n_mouse_report(ITF_NUM_HID_MOUSE, 0,
-                                   kbmouse_mouse_report.buttons,
-                                   kbmouse_mouse_report.x,
-                                   kbmouse_mouse_report.y,
-                                   kbmouse_mouse_report.wheel,
-                                   kbmouse_mouse_report.pan);
+    return kbmouse_mode_flush();
 }
 
 static void kbmouse_mode_handle_output(uint8_t report_id, const uint8_t* data, uint16_t len)
 {
     // Keyboard LED output report (1 byte)
     // bit 0 = NumLock, bit 1 = CapsLock, bit 2 = ScrollLock
-    // In composite mode, report_id is 0 (no report IDs in standalone descriptors)
+    // No report IDs on the KB/Mouse keyboard interface (report_id is 0)
     (void)report_id;
     if (len >= 1) {
         kbmouse_set_led_state(data[0]);
@@ -93,7 +225,7 @@ static const uint8_t* kbmouse_mode_get_device_descriptor(void)
 
 static const uint8_t* kbmouse_mode_get_config_descriptor(void)
 {
-    // Composite config descriptor is built in usbd.c (desc_configuration_sinput)
+    // Composite config descriptor is built in usbd.c (runtime_desc_kbmouse)
     return NULL;
 }
 
@@ -126,4 +258,5 @@ const usbd_mode_t kbmouse_mode = {
 
     .get_class_driver = NULL,  // Uses built-in HID class driver
     .task = NULL,
+    .on_input = kbmouse_mode_on_input,
 };
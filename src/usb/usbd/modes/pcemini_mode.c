@@ -126,7 +126,7 @@ static bool pcemini_build_and_send(uint32_t buttons, uint8_t lx, uint8_t ly)
     else if (right)         pcemini_report.hat = PCEMINI_HAT_RIGHT;
     else                    pcemini_report.hat = PCEMINI_HAT_NOTHING;
 
-    return tud_hid_report(0, &pcemini_report, sizeof(pcemini_report));
+    return usbd_report_send(0, 0, &pcemini_report, sizeof(pcemini_report));
 }
 
 static bool pcemini_mode_send_report(uint8_t player_index,
@@ -149,6 +149,12 @@ static void pcemini_mode_task(void)
     if ((turbo_b3_held || turbo_b4_held) && tud_hid_ready()) {
         pcemini_build_and_send(last_buttons, last_lx, last_ly);
     }
+
+    // Come back at the next turbo phase flip
+    uint32_t now = platform_time_ms();
+    uint32_t period = turbo_periods[turbo_speed_index];
+    if (turbo_b3_held) platform_loop_wake_in(period - (now - turbo_b3_start) % period);
+    if (turbo_b4_held) platform_loop_wake_in(period - (now - turbo_b4_start) % period);
 }
 
 static const uint8_t* pcemini_mode_get_device_descriptor(void)
@@ -181,6 +187,8 @@ const usbd_mode_t pcemini_mode = {
     .init = pcemini_mode_init,
     .send_report = pcemini_mode_send_report,
     .is_ready = pcemini_mode_is_ready,
+    // Turbo resends from the task only go out when the phase flips
+    .repeat_policy = USBD_REPEAT_ON_CHANGE,
 
     // No feedback support for PC Engine Mini
     .handle_output = NULL,
@@ -1,14 +1,15 @@
 // ps4_local_auth.c - Local RSA-PSS signing for PS4 authentication
 //
-// Uses mbedTLS RSA-2048 with PSS padding (SHA-256) to sign the PS4's
-// 280-byte nonce challenge. Key material is loaded from a dedicated flash
-// sector at startup via ps4_auth_flash.h.
+// Signs the PS4's 280-byte nonce challenge with RSA-2048 PSS (SHA-256).
+// Key material is loaded from a dedicated flash sector at startup via
+// ps4_auth_flash.h; mbedTLS parses and checks it, then ps4_rsa_crt.c caches
+// the CRT parameters for a fast, time-sliced private-key operation.
 //
-// Signing is offloaded to Core 1 via core1_idle_hook() to avoid blocking
-// Core 0's USB/CYW43 polling for the ~3.4 seconds the RSA operation takes.
-// Core 0's ps4_local_auth_task() sets s_core1_signing and calls __sev()
-// to wake Core 1, then returns immediately.  Core 1 signs, sets
-// s_signature_ready, and idles until the next nonce arrives.
+// Signing runs on Core 1 via core1_idle_hook() when Core 1 is idle, or in
+// 1 ms slices from ps4_local_auth_task() on Core 0 otherwise — either way
+// Core 0's USB/CYW43 polling keeps running while the console polls 0xF2.
+// Core 0 always dispatches: it snapshots the nonce, PSS-encodes it, then
+// hands off (s_core1_signing + __sev()) or keeps the steps itself.
 //
 // Flash writes (event log) are only performed by Core 0 — never Core 1 —
 // because flash_safe_execute() requires Core 0 to be the initiator.
@@ -17,6 +18,7 @@
 // Copyright 2024 Robert Dale Smith
 
 #include "ps4_local_auth.h"
+#include "ps4_rsa_crt.h"
 #include "core/services/storage/ps4_auth_flash.h"
 
 #include "platform/platform.h"
@@ -28,6 +30,11 @@
 #include "hardware/clocks.h"
 #include "hardware/sync.h"
 #include "hardware/watchdog.h"
+#if PS4_HW_SHA256
+#include "pico/sha256.h"
+#else
+#define PS4_HW_SHA256 0
+#endif
 #if !PICO_RP2350
 // RP2040-only: chip_reset boot-source register lives in the VREG_AND_CHIP_RESET
 // block, which does not exist on RP2350 (moved into POWMAN). Used only for reset
@@ -175,9 +182,117 @@ static int rng_fn(void *ctx, unsigned char *output, size_t len)
 }
 
 // ============================================================================
-// CORE 1 SIGNING
+// SHA-256
+//
+// RP2350 has a SHA-256 accelerator (pico_sha256). It is a single shared
+// block, so fall back to mbedTLS if another user holds it. RP2040 always
+// uses mbedTLS.
+// ============================================================================
+
+static void ps4_sha256(const uint8_t *const parts[], const size_t lens[], int count,
+                       uint8_t out[32])
+{
+#if PS4_HW_SHA256
+    pico_sha256_state_t hw;
+    if (pico_sha256_try_start(&hw, SHA256_BIG_ENDIAN, false) == PICO_OK) {
+        for (int i = 0; i < count; i++) {
+            pico_sha256_update_blocking(&hw, parts[i], lens[i]);
+        }
+        sha256_result_t result;
+        pico_sha256_finish(&hw, &result);
+        memcpy(out, result.bytes, 32);
+        return;
+    }
+#endif
+    mbedtls_sha256_context sw;
+    mbedtls_sha256_init(&sw);
+    mbedtls_sha256_starts(&sw, 0);
+    for (int i = 0; i < count; i++) {
+        mbedtls_sha256_update(&sw, parts[i], lens[i]);
+    }
+    mbedtls_sha256_finish(&sw, out);
+    mbedtls_sha256_free(&sw);
+}
+
+// ============================================================================
+// EMSA-PSS ENCODING (RFC 8017 §9.1.1)
 //
-// ps4_do_sign() runs on Core 1 via core1_idle_hook().  It must NOT:
+// Same parameters as mbedtls_rsa_rsassa_pss_sign(): SHA-256, MGF1-SHA-256,
+// salt length = hash length.
+// ============================================================================
+
+#define PSS_HASH_LEN  32
+#define PSS_SALT_LEN  32
+
+static void pss_encode(const uint8_t mhash[PSS_HASH_LEN], uint8_t *em, size_t em_size,
+                       size_t mod_bits)
+{
+    size_t em_bits = mod_bits - 1;
+    size_t em_len = (em_bits + 7) / 8;
+    memset(em, 0, em_size);
+    uint8_t *out = em + (em_size - em_len);   // Leading zero byte when em_bits % 8 == 0
+
+    uint8_t salt[PSS_SALT_LEN];
+    rng_fn(NULL, salt, sizeof(salt));
+
+    // H = Hash(0x00 × 8 || mHash || salt)
+    static const uint8_t zeros[8] = {0};
+    uint8_t h[PSS_HASH_LEN];
+    {
+        const uint8_t *parts[] = { zeros, mhash, salt };
+        const size_t lens[] = { sizeof(zeros), PSS_HASH_LEN, sizeof(salt) };
+        ps4_sha256(parts, lens, 3, h);
+    }
+
+    // DB = PS || 0x01 || salt, masked with MGF1(H)
+    size_t db_len = em_len - PSS_HASH_LEN - 1;
+    out[db_len - PSS_SALT_LEN - 1] = 0x01;
+    memcpy(out + db_len - PSS_SALT_LEN, salt, PSS_SALT_LEN);
+
+    uint8_t counter[4] = {0};
+    for (size_t off = 0; off < db_len; off += PSS_HASH_LEN) {
+        uint8_t mask[PSS_HASH_LEN];
+        const uint8_t *parts[] = { h, counter };
+        const size_t lens[] = { PSS_HASH_LEN, sizeof(counter) };
+        ps4_sha256(parts, lens, 2, mask);
+        size_t n = (db_len - off < PSS_HASH_LEN) ? (db_len - off) : PSS_HASH_LEN;
+        for (size_t i = 0; i < n; i++) {
+            out[off + i] ^= mask[i];
+        }
+        counter[3]++;
+    }
+    out[0] &= 0xFF >> (8 * em_len - em_bits);
+
+    memcpy(out + db_len, h, PSS_HASH_LEN);
+    out[em_len - 1] = 0xBC;
+    memset(salt, 0, sizeof(salt));
+}
+
+// ============================================================================
+// SIGNING
+//
+// A signature is a small state machine that can be advanced from either
+// core in bounded slices:
+//
+//   ps4_sign_begin()  — hash the nonce, PSS-encode, arm the CRT engine
+//                       (Core 0, at dispatch; cheap)
+//   ps4_sign_step()   — run the private-key operation for ~budget_us;
+//                       on completion verify, assemble s_response and
+//                       publish s_signature_ready
+//
+// If Core 1 is parked in its idle loop (no core1 task for this app), the
+// steps run there via core1_idle_hook(). Otherwise Core 0 runs one
+// SIGN_SLICE_CORE0_US slice per ps4_local_auth_task() call, so USB and the
+// rest of the main loop keep running while the console polls 0xF2.
+//
+// Every CRT result is checked with the public key (s^e mod N == EM) before
+// it is sent. On mismatch the operation is recomputed through the same
+// sliced engine, up to SIGN_CRT_ATTEMPTS times; if it still fails the step
+// reports an error (zeroed response, the console retries with a new nonce)
+// rather than stalling Core 0 in a blocking mbedTLS call. Keys whose shape
+// ps4_rsa_crt_load() does not support use the mbedTLS path throughout.
+//
+// Code running on Core 1 must NOT:
 //   - Call ps4_log() or any flash API (flash_safe_execute must
 //     be initiated by Core 0 while Core 1 handles the lockout interrupt).
 //   - Access s_nonce directly (use s_sign_nonce, the snapshot made by Core 0).
@@ -202,38 +317,86 @@ static crash_detect_t s_crash_detect
 // Kept for reference; SRAM breadcrumbs above are more reliable.
 #define SIGN_SCRATCH watchdog_hw->scratch[6]
 
-static void ps4_do_sign(void)
+// Slice lengths. Core 0 shares its loop with USB/BT polling; Core 1 has
+// nothing else to do and only slices so it notices an 0xF3 reset.
+#define SIGN_SLICE_CORE0_US    1000
+#define SIGN_SLICE_CORE1_US   20000
+
+// CRT runs per signature before a failed public-key check fails the step
+#define SIGN_CRT_ATTEMPTS     2
+
+// Engine state (set at key load)
+static bool     s_crt_ready = false;
+static size_t   s_mod_bits  = 0;
+
+// In-flight signature
+static uint8_t  s_hash[PSS_HASH_LEN];
+static uint8_t  s_em[256];
+static volatile bool     s_core0_signing = false;  // Core 0 owns the steps
+static volatile bool     s_core1_busy    = false;  // Core 1 is inside a step loop
+static volatile bool     s_core1_idle    = false;  // Core 1 runs the idle loop (hook is live)
+static volatile uint32_t s_sign_gen      = 0;      // Bumped by Core 0 on dispatch/reset
+static volatile uint32_t s_sign_start_us = 0;
+static volatile uint32_t s_sign_end_us   = 0;
+static volatile uint8_t  s_sign_core     = 0;
+static volatile bool     s_sign_used_crt = false;
+static volatile uint8_t  s_sign_attempts = 0;      // CRT runs for the in-flight signature
+
+// Sign-time statistics (Core 0 only, reported over CDC)
+static ps4_local_auth_stats_t s_stats;
+
+// mbedTLS reference path: PSS-sign s_hash in one blocking call
+static int ps4_sign_mbedtls(uint8_t *rsa_sig)
 {
-    // Step 1: SHA-256 of the first 256 bytes of the nonce snapshot
-    printf("[ps4_sign C1] step1 SHA256 start\n");
-    uint8_t hash[32];
-    SIGN_SCRATCH = 1;
-    s_crash_detect.step = 1;
-    mbedtls_sha256(s_sign_nonce, 256, hash, 0);
-    printf("[ps4_sign C1] step1 SHA256 done\n");
-
-    // Step 2: RSA-PSS sign (result 256 bytes)
-    printf("[ps4_sign C1] step2 RSA-PSS start\n");
-    uint8_t rsa_sig[256];
-    SIGN_SCRATCH = 2;
-    s_crash_detect.step = 2;
-    int ret = mbedtls_rsa_rsassa_pss_sign(
+    return mbedtls_rsa_rsassa_pss_sign(
         &s_rsa,
         rng_fn,
         NULL,
         MBEDTLS_MD_SHA256,
-        sizeof(hash),
-        hash,
+        sizeof(s_hash),
+        s_hash,
         rsa_sig
     );
+}
+
+// Fault check for the CRT engine: recover EM with the public key
+static int ps4_sign_verify(const uint8_t *rsa_sig)
+{
+    uint8_t check[sizeof(s_em)];
+    int ret = mbedtls_rsa_public(&s_rsa, rsa_sig, check);
+    if (ret == 0 && memcmp(check, s_em, sizeof(check)) != 0) {
+        ret = MBEDTLS_ERR_RSA_VERIFY_FAILED;
+    }
+    return ret;
+}
+
+static void ps4_sign_begin(void)
+{
+    // Step 1: SHA-256 of the first 256 bytes of the nonce snapshot
+    SIGN_SCRATCH = 1;
+    s_crash_detect.step = 1;
+    {
+        const uint8_t *parts[] = { s_sign_nonce };
+        const size_t lens[] = { 256 };
+        ps4_sha256(parts, lens, 1, s_hash);
+    }
 
-    printf("[ps4_sign C1] step2 RSA-PSS ret=%d\n", ret);
+    s_sign_used_crt = s_crt_ready;
+    s_sign_attempts = 1;
+    if (s_crt_ready) {
+        pss_encode(s_hash, s_em, sizeof(s_em), s_mod_bits);
+        ps4_rsa_crt_start(s_em, sizeof(s_em));
+    }
+}
+
+// Assemble the 1064-byte response and publish it. gen guards against a
+// reset/new nonce that arrived while Core 1 was finishing.
+static void ps4_sign_finish(int ret, const uint8_t *rsa_sig, uint32_t gen)
+{
     SIGN_SCRATCH = 3;
     s_crash_detect.step = 3;
 
     if (ret == 0) {
-        // Step 3: Assemble the 1064-byte response buffer
-        printf("[ps4_sign C1] step3 assemble response\n");
         memset(s_response, 0, sizeof(s_response));
         memcpy(s_response + RSP_RSA_SIG_OFFSET,    rsa_sig,    256);
         memcpy(s_response + RSP_SERIAL_OFFSET,     s_serial,    16);
@@ -242,30 +405,70 @@ static void ps4_do_sign(void)
             NULL, 0, NULL, 0, NULL, 0,
             s_response + RSP_E_OFFSET, 256);
         memcpy(s_response + RSP_DEVICE_SIG_OFFSET, s_device_sig, 256);
-        printf("[ps4_sign C1] step3 done\n");
     } else {
         // On failure, return a zeroed buffer — PS4 will reject but won't hang
-        printf("[ps4_sign C1] FAIL ret=%d\n", ret);
         memset(s_response, 0, sizeof(s_response));
     }
 
-    s_sign_ret    = ret;
-    s_page_cursor = 0;
     SIGN_SCRATCH  = 0;             // Clear watchdog scratch breadcrumb
     s_crash_detect.step = 0;       // Clear SRAM breadcrumb — signing completed normally
+    if (gen != s_sign_gen) return; // Session was reset underneath us
+
+    s_sign_ret    = ret;
+    s_sign_end_us = platform_time_us();
+    s_page_cursor = 0;
     __dmb();                       // Ensure response + sign_ret visible before flag
     s_signature_ready = true;      // Signal Core 0 (atomic store, Cortex-M0+ is TSO)
-    printf("[ps4_sign C1] signature_ready=true\n");
+}
+
+// Advance the in-flight signature by ~budget_us. Returns true once
+// s_signature_ready has been published (or the session was abandoned).
+static bool ps4_sign_step(uint32_t budget_us, uint32_t gen)
+{
+    // Step 2: private-key operation
+    SIGN_SCRATCH = 2;
+    s_crash_detect.step = 2;
+
+    uint8_t rsa_sig[256];
+    int ret;
+    if (s_sign_used_crt) {
+        if (!ps4_rsa_crt_step(budget_us)) return false;
+        ps4_rsa_crt_result(rsa_sig, sizeof(rsa_sig));
+        ret = ps4_sign_verify(rsa_sig);
+        if (ret != 0 && s_sign_attempts < SIGN_CRT_ATTEMPTS) {
+            // Recompute in slices; never fall back to a blocking sign here
+            printf("[ps4_sign] CRT result failed verify (%d), recomputing\n", ret);
+            memset(rsa_sig, 0, sizeof(rsa_sig));
+            s_sign_attempts++;
+            ps4_rsa_crt_start(s_em, sizeof(s_em));
+            return false;
+        }
+    } else {
+        ret = ps4_sign_mbedtls(rsa_sig);
+    }
+
+    ps4_sign_finish(ret, rsa_sig, gen);
+    memset(rsa_sig, 0, sizeof(rsa_sig));
+    return true;
 }
 
 // Override of the weak core1_idle_hook() in main.c.
-// Called from Core 1's idle loop after waking from __wfe().
-// When PS4 auth is not in use (no s_core1_signing), returns immediately.
+// Called from Core 1's idle loop after waking from __wfe(). Its first call
+// also tells Core 0 that Core 1 is available for signing — apps that give
+// Core 1 a real task never reach the idle loop, and sign on Core 0 instead.
 void core1_idle_hook(void)
 {
+    s_core1_idle = true;
+
     // Only run when Core 0 has queued a signing request and it's not done yet
     if (!s_core1_signing || s_signature_ready || !s_rsa_valid) return;
-    ps4_do_sign();
+
+    s_core1_busy = true;
+    uint32_t gen = s_sign_gen;
+    while (s_core1_signing && gen == s_sign_gen) {
+        if (ps4_sign_step(SIGN_SLICE_CORE1_US, gen)) break;
+    }
+    s_core1_busy = false;
 }
 
 // ============================================================================
@@ -330,12 +533,22 @@ bool ps4_local_auth_init(void)
         SIGN_SCRATCH = 0;
     }
 
+    // Abandon any in-flight signature and let Core 1 leave its slice
+    // before the key it is using goes away (PS4AUTH.SET / CLEAR reload).
+    s_sign_gen++;
+    s_core1_signing     = false;
+    s_core0_signing     = false;
+    while (s_core1_busy) {
+        tight_loop_contents();
+    }
+
     // Free any previous RSA context from a prior init cycle.
     mbedtls_rsa_free(&s_rsa);
+    ps4_rsa_crt_clear();
 
     s_rsa_valid = false;
+    s_crt_ready = false;
     s_signing_requested = false;
-    s_core1_signing     = false;
     s_signature_ready   = false;
     s_sign_ret          = 0;
     s_nonce_pages_received = 0;
@@ -430,6 +643,15 @@ bool ps4_local_auth_init(void)
     printf("[ps4_local_auth] RSA key loaded, local auth available\n");
     ps4_log("INIT ok RSA2048");
 
+    // Cache CRT parameters + Montgomery constants for the fast signer.
+    // On an unsupported key shape signing stays on mbedTLS.
+    if (mbedtls_rsa_export(&s_rsa, &N, NULL, NULL, NULL, NULL) == 0) {
+        s_mod_bits = mbedtls_mpi_bitlen(&N);
+    }
+    s_crt_ready = s_mod_bits > 0 && mbedtls_rsa_get_len(&s_rsa) == sizeof(s_em) &&
+                  ps4_rsa_crt_load(&s_rsa);
+    ps4_log(s_crt_ready ? "INIT engine crt" : "INIT engine mbedtls");
+
 cleanup:
     mbedtls_mpi_free(&N);
     mbedtls_mpi_free(&P);
@@ -505,21 +727,46 @@ void ps4_local_auth_send_nonce_page(const uint8_t *data, uint16_t len)
 // SIGNING TASK
 // ============================================================================
 
+// Record a completed signature (Core 0)
+static void ps4_sign_report(void)
+{
+    uint32_t us = s_sign_end_us - s_sign_start_us;
+    s_stats.last_us = us;
+    if (us > s_stats.max_us) s_stats.max_us = us;
+    s_stats.count++;
+    s_stats.core = s_sign_core;
+    s_stats.crt = s_sign_used_crt;
+    if (s_sign_ret != 0) s_stats.failures++;
+    if (s_sign_used_crt && s_sign_attempts > 1) s_stats.crt_retries += s_sign_attempts - 1;
+
+    char logmsg[48];
+    if (s_sign_ret != 0) {
+        printf("[ps4_local_auth] Sign failed ret=%d (%lums, core %u)\n",
+               s_sign_ret, (unsigned long)(us / 1000), s_sign_core);
+        snprintf(logmsg, sizeof(logmsg), "SIGN FAIL ret=%d %lums", s_sign_ret, (unsigned long)(us / 1000));
+    } else {
+        printf("[ps4_local_auth] Sign OK (%lums, core %u, %s)\n",
+               (unsigned long)(us / 1000), s_sign_core, s_sign_used_crt ? "crt" : "mbedtls");
+        snprintf(logmsg, sizeof(logmsg), "SIGN done %lums C%u", (unsigned long)(us / 1000), s_sign_core);
+    }
+    ps4_log(logmsg);
+}
+
 void ps4_local_auth_task(void)
 {
-    // ---- Check if Core 1 just finished signing ----
-    if (s_core1_signing && s_signature_ready) {
+    // ---- Signature finished on either core ----
+    if ((s_core0_signing || s_core1_signing) && s_signature_ready) {
+        s_core0_signing = false;
         s_core1_signing = false;
         s_sign_start_ms = 0;  // Reset timeout tracker
-        if (s_sign_ret != 0) {
-            printf("[ps4_local_auth] RSA sign failed on Core 1 (%d)\n", s_sign_ret);
-            char logmsg[32];
-            snprintf(logmsg, sizeof(logmsg), "SIGN FAIL ret=%d", s_sign_ret);
-            ps4_log(logmsg);
-        } else {
-            printf("[ps4_local_auth] Core 1 signing complete\n");
-            ps4_log("SIGN done");
-        }
+        ps4_sign_report();
+        return;
+    }
+
+    // ---- Core 0 owns the signature: run one bounded slice ----
+    if (s_core0_signing) {
+        ps4_sign_step(SIGN_SLICE_CORE0_US, s_sign_gen);
+        platform_loop_wake_in(0);
         return;
     }
 
@@ -537,40 +784,47 @@ void ps4_local_auth_task(void)
         return;
     }
 
-    // ---- Dispatch signing (Core 0 blocking for debug) ----
+    // ---- Dispatch signing ----
     if (!s_signing_requested || !s_rsa_valid) return;
 
+    // Core 1 is still unwinding a signature that was reset; it exits at
+    // the end of its current slice.
+    if (s_core1_busy) return;
+
     s_signing_requested = false;
     s_signature_ready   = false;
     s_sign_ret          = 0;
     s_page_cursor       = 0;
+    s_sign_gen++;
 
     // Snapshot the nonce
     memcpy(s_sign_nonce, s_nonce, NONCE_SIZE);
 
-    printf("[ps4_local_auth] Signing on Core 0 (blocking, nonce_id=%d)...\n", s_nonce_id);
-    ps4_log("SIGN start C0");
-    s_sign_start_ms = platform_time_ms();
+    s_sign_start_us = platform_time_us();
+    ps4_sign_begin();
 
-    // Sign directly on Core 0 — blocks the main loop but eliminates all
-    // multicore timing issues for debugging.
-    ps4_do_sign();
-
-    uint32_t duration = platform_time_ms() - s_sign_start_ms;
-    s_sign_start_ms = 0;
-
-    if (s_sign_ret != 0) {
-        printf("[ps4_local_auth] Sign failed ret=%d (%lums)\n", s_sign_ret, (unsigned long)duration);
-        char logmsg[40];
-        snprintf(logmsg, sizeof(logmsg), "SIGN FAIL ret=%d %lums", s_sign_ret, (unsigned long)duration);
-        ps4_log(logmsg);
+    if (s_core1_idle) {
+        printf("[ps4_local_auth] Signing on Core 1 (nonce_id=%d)\n", s_nonce_id);
+        ps4_log("SIGN start C1");
+        s_sign_core = 1;
+        __dmb();               // Publish nonce/EM before handing off
+        s_core1_signing = true;
+        __sev();               // Wake Core 1 from __wfe()
     } else {
-        printf("[ps4_local_auth] Sign OK (%lums)\n", (unsigned long)duration);
-        char logmsg[32];
-        snprintf(logmsg, sizeof(logmsg), "SIGN done %lums", (unsigned long)duration);
-        ps4_log(logmsg);
+        printf("[ps4_local_auth] Signing on Core 0 in %uus slices (nonce_id=%d)\n",
+               SIGN_SLICE_CORE0_US, s_nonce_id);
+        ps4_log("SIGN start C0");
+        s_sign_core = 0;
+        s_core0_signing = true;
     }
-    s_signature_ready = true;
+}
+
+void ps4_local_auth_get_stats(ps4_local_auth_stats_t *out)
+{
+    if (!out) return;
+    *out = s_stats;
+    out->crt = s_crt_ready;
+    out->hw_sha = PS4_HW_SHA256;
 }
 
 // ============================================================================
@@ -652,8 +906,10 @@ uint16_t ps4_local_auth_get_next_page(uint8_t *buffer, uint16_t maxlen)
 
 void ps4_local_auth_reset(void)
 {
+    s_sign_gen++;                  // Core 1 drops its result at the next slice
     s_signing_requested    = false;
     s_core1_signing        = false;
+    s_core0_signing        = false;
     s_signature_ready      = false;
     s_sign_ret             = 0;
     s_nonce_pages_received = 0;
@@ -62,11 +62,28 @@ void ps4_local_auth_send_nonce_page(const uint8_t *data, uint16_t len);
 // Signing task (call from main loop / ps4_mode task)
 // ============================================================================
 
-// Performs RSA-PSS signing when a nonce is ready.
-// Blocks for ~50ms on RP2040 @ 125 MHz while signing.
+// Dispatches RSA-PSS signing when a nonce is ready, and when signing on
+// Core 0 runs one bounded (~1 ms) slice of it per call.
 // Returns immediately if no signing is needed.
 void ps4_local_auth_task(void);
 
+// ============================================================================
+// Statistics (CDC PS4AUTH.STATUS)
+// ============================================================================
+
+typedef struct {
+    uint32_t last_us;       // Duration of the most recent signature (dispatch → ready)
+    uint32_t max_us;        // Slowest signature since boot
+    uint32_t count;         // Signatures completed since boot
+    uint32_t failures;      // Signatures that returned an error
+    uint32_t crt_retries;   // CRT results recomputed after failing the public-key check
+    uint8_t  core;          // Core that computed the most recent signature
+    bool     crt;           // Fast CRT engine loaded (false = mbedTLS only)
+    bool     hw_sha;        // RP2350 SHA-256 accelerator in use
+} ps4_local_auth_stats_t;
+
+void ps4_local_auth_get_stats(ps4_local_auth_stats_t *out);
+
 // ============================================================================
 // Status and signature retrieval (for PS4 console)
 // ============================================================================
@@ -0,0 +1,502 @@
+// ps4_rsa_crt.c - Time-sliced RSA-CRT private-key operation for PS4 auth
+//
+// mbedtls_rsa_private() spends most of its time in generic bignum code:
+// heap-allocated MPIs, 2048-bit blinding, and a Montgomery multiply written
+// for arbitrary limb sizes. For a fixed RSA-2048 key we can do much better:
+//
+//   - CRT with both 1024-bit exponentiations in fixed 32-word buffers
+//   - Montgomery constants (-p^-1 mod 2^32, R^3 mod p, R mod p) computed
+//     once at key load with mbedTLS, then cached in RAM
+//   - CIOS Montgomery multiply, RAM-resident (no XIP cache misses), with
+//     a 16x16-bit partial-product multiply on the M0+ (which has no
+//     32x32->64 instruction and would otherwise call __aeabi_lmul)
+//   - 4-bit fixed window exponentiation, one window per work unit
+//
+// The message is brought into Montgomery form mod p in one REDC pass plus
+// a multiply by R^3 mod p, so no separate 2048-by-1024-bit division is
+// needed. Every window multiplies (by R mod p for a zero window), so the
+// multiply count depends only on the exponent length.
+//
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+
+#include "ps4_rsa_crt.h"
+#include "platform/platform.h"
+#include "mbedtls/bignum.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define CRT_MAX_WORDS   32      // 1024-bit primes
+#define CRT_WINDOW_BITS 4
+#define CRT_WINDOW_SIZE (1 << CRT_WINDOW_BITS)
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+// Per-prime Montgomery context, cached at key load
+typedef struct {
+    uint32_t mod[CRT_MAX_WORDS];    // p (or q)
+    uint32_t exp[CRT_MAX_WORDS];    // dp (or dq)
+    uint32_t rr3[CRT_MAX_WORDS];    // R^3 mod p: REDC output → Montgomery form
+    uint32_t one[CRT_MAX_WORDS];    // R mod p: Montgomery form of 1
+    uint32_t minv;                  // -p^-1 mod 2^32
+    uint16_t exp_windows;           // Number of 4-bit windows in exp
+} crt_prime_t;
+
+static crt_prime_t s_p;
+static crt_prime_t s_q;
+static uint32_t    s_qinv[CRT_MAX_WORDS];   // q^-1 mod p (plain)
+static uint8_t     s_words = 0;             // Words per prime
+static bool        s_loaded = false;
+
+typedef enum {
+    CRT_PHASE_IDLE = 0,
+    CRT_PHASE_Q_ENTER,      // m → Montgomery form mod q, build window table
+    CRT_PHASE_Q_EXP,        // One window per unit
+    CRT_PHASE_Q_EXIT,       // sq = m^dq mod q (plain)
+    CRT_PHASE_P_ENTER,
+    CRT_PHASE_P_EXP,
+    CRT_PHASE_GARNER,       // s = sq + q * (qinv * (sp - sq) mod p)
+    CRT_PHASE_DONE,
+} crt_phase_t;
+
+static crt_phase_t s_phase = CRT_PHASE_IDLE;
+static uint16_t    s_window = 0;                            // Next window index (MSB first)
+static uint32_t    s_input[2 * CRT_MAX_WORDS];              // m, little-endian words
+static uint32_t    s_table[CRT_WINDOW_SIZE][CRT_MAX_WORDS]; // x^k·R mod prime
+static uint32_t    s_acc[CRT_MAX_WORDS];                    // Exponentiation accumulator
+static uint32_t    s_sq[CRT_MAX_WORDS];                     // m^dq mod q
+static uint32_t    s_result[2 * CRT_MAX_WORDS];             // Signature, little-endian words
+
+// ============================================================================
+// WORD ARITHMETIC
+// ============================================================================
+
+// 32x32 → 64-bit multiply. Cortex-M33 has UMULL; Cortex-M0+ only has a
+// 32x32 → 32 MULS, so build the product from four 16-bit partials inline
+// rather than calling the generic 64x64 __aeabi_lmul.
+static inline uint64_t mul32(uint32_t a, uint32_t b)
+{
+#if defined(__ARM_ARCH_6M__)
+    uint32_t al = a & 0xFFFF, ah = a >> 16;
+    uint32_t bl = b & 0xFFFF, bh = b >> 16;
+    uint32_t ll = al * bl;
+    uint32_t lh = al * bh;
+    uint32_t hl = ah * bl;
+    uint32_t hh = ah * bh;
+    uint32_t mid = lh + hl;
+    uint32_t mid_carry = (mid < lh) ? 0x10000u : 0;
+    uint32_t lo = ll + (mid << 16);
+    uint32_t hi = hh + (mid >> 16) + mid_carry + (lo < ll);
+    return ((uint64_t)hi << 32) | lo;
+#else
+    return (uint64_t)a * b;
+#endif
+}
+
+// r = a - b over n words, returns borrow
+static uint32_t sub_words(uint32_t *r, const uint32_t *a, const uint32_t *b, uint8_t n)
+{
+    uint32_t borrow = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        uint32_t ai = a[i];
+        uint32_t d = ai - b[i];
+        uint32_t b1 = d > ai;
+        uint32_t d2 = d - borrow;
+        uint32_t b2 = d2 > d;
+        r[i] = d2;
+        borrow = b1 | b2;
+    }
+    return borrow;
+}
+
+// r = a + b over n words, returns carry
+static uint32_t add_words(uint32_t *r, const uint32_t *a, const uint32_t *b, uint8_t n)
+{
+    uint64_t carry = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        carry += (uint64_t)a[i] + b[i];
+        r[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    return (uint32_t)carry;
+}
+
+// a >= b over n words
+static bool geq_words(const uint32_t *a, const uint32_t *b, uint8_t n)
+{
+    for (int i = n - 1; i >= 0; i--) {
+        if (a[i] != b[i]) return a[i] > b[i];
+    }
+    return true;
+}
+
+// ============================================================================
+// MONTGOMERY ARITHMETIC
+// ============================================================================
+
+// r = a·b·R^-1 mod m (CIOS). r may alias a or b. Inputs < m, output < m.
+static void __not_in_flash_func(mont_mul)(uint32_t *r, const uint32_t *a, const uint32_t *b,
+                                          const crt_prime_t *ctx, uint8_t n)
+{
+    uint32_t t[CRT_MAX_WORDS + 2];
+    memset(t, 0, (size_t)(n + 2) * sizeof(uint32_t));
+    const uint32_t *m = ctx->mod;
+
+    for (uint8_t i = 0; i < n; i++) {
+        // t += a · b[i]
+        uint32_t bi = b[i];
+        uint64_t c = 0;
+        for (uint8_t j = 0; j < n; j++) {
+            c += mul32(a[j], bi) + t[j];
+            t[j] = (uint32_t)c;
+            c >>= 32;
+        }
+        c += t[n];
+        t[n] = (uint32_t)c;
+        t[n + 1] = (uint32_t)(c >> 32);
+
+        // t = (t + u·m) / 2^32, u chosen so the low word cancels
+        uint32_t u = t[0] * ctx->minv;
+        c = mul32(u, m[0]) + t[0];
+        c >>= 32;
+        for (uint8_t j = 1; j < n; j++) {
+            c += mul32(u, m[j]) + t[j];
+            t[j - 1] = (uint32_t)c;
+            c >>= 32;
+        }
+        c += t[n];
+        t[n - 1] = (uint32_t)c;
+        t[n] = t[n + 1] + (uint32_t)(c >> 32);
+    }
+
+    if (t[n] || geq_words(t, m, n)) {
+        sub_words(r, t, m, n);
+    } else {
+        memcpy(r, t, (size_t)n * sizeof(uint32_t));
+    }
+}
+
+// r = T·R^-1 mod m for a 2n-word T < m·R (Montgomery reduction)
+static void __not_in_flash_func(mont_redc)(uint32_t *r, const uint32_t *in,
+                                           const crt_prime_t *ctx, uint8_t n)
+{
+    uint32_t t[2 * CRT_MAX_WORDS + 1];
+    memcpy(t, in, (size_t)(2 * n) * sizeof(uint32_t));
+    t[2 * n] = 0;
+    const uint32_t *m = ctx->mod;
+
+    for (uint8_t i = 0; i < n; i++) {
+        uint32_t u = t[i] * ctx->minv;
+        uint64_t c = 0;
+        for (uint8_t j = 0; j < n; j++) {
+            c += mul32(u, m[j]) + t[i + j];
+            t[i + j] = (uint32_t)c;
+            c >>= 32;
+        }
+        for (uint16_t k = i + n; c && k <= 2 * n; k++) {
+            c += t[k];
+            t[k] = (uint32_t)c;
+            c >>= 32;
+        }
+    }
+
+    if (t[2 * n] || geq_words(&t[n], m, n)) {
+        sub_words(r, &t[n], m, n);
+    } else {
+        memcpy(r, &t[n], (size_t)n * sizeof(uint32_t));
+    }
+}
+
+// Bring a 2n-word value (< m·R) into Montgomery form: REDC gives T·R^-1,
+// multiplying by R^3 gives T·R.
+static void to_mont(uint32_t *r, const uint32_t *in2n, const crt_prime_t *ctx, uint8_t n)
+{
+    uint32_t tmp[CRT_MAX_WORDS];
+    mont_redc(tmp, in2n, ctx, n);
+    mont_mul(r, tmp, ctx->rr3, ctx, n);
+}
+
+// ============================================================================
+// EXPONENTIATION UNITS
+// ============================================================================
+
+static void exp_enter(const crt_prime_t *ctx)
+{
+    uint8_t n = s_words;
+    memcpy(s_table[0], ctx->one, (size_t)n * sizeof(uint32_t));
+    to_mont(s_table[1], s_input, ctx, n);
+    for (int k = 2; k < CRT_WINDOW_SIZE; k++) {
+        mont_mul(s_table[k], s_table[k - 1], s_table[1], ctx, n);
+    }
+    memcpy(s_acc, ctx->one, (size_t)n * sizeof(uint32_t));
+    s_window = 0;
+}
+
+static inline uint8_t exp_window(const crt_prime_t *ctx, uint16_t w)
+{
+    // Window w counts from the most significant
+    uint16_t idx = ctx->exp_windows - 1 - w;
+    return (ctx->exp[idx / 8] >> ((idx % 8) * 4)) & 0x0F;
+}
+
+// One window: 4 squarings + 1 table multiply. Returns true when finished.
+static bool exp_window_step(const crt_prime_t *ctx)
+{
+    uint8_t n = s_words;
+    if (s_window > 0) {
+        for (int i = 0; i < CRT_WINDOW_BITS; i++) {
+            mont_mul(s_acc, s_acc, s_acc, ctx, n);
+        }
+    }
+    mont_mul(s_acc, s_acc, s_table[exp_window(ctx, s_window)], ctx, n);
+    s_window++;
+    return s_window >= ctx->exp_windows;
+}
+
+static void garner(void)
+{
+    uint8_t n = s_words;
+    uint32_t wide[2 * CRT_MAX_WORDS];
+    uint32_t sq_mont[CRT_MAX_WORDS];
+    uint32_t h[CRT_MAX_WORDS];
+
+    // sq mod p, in Montgomery form (sq < q < R, so sq < p·R)
+    memset(wide, 0, sizeof(wide));
+    memcpy(wide, s_sq, (size_t)n * sizeof(uint32_t));
+    to_mont(sq_mont, wide, &s_p, n);
+
+    // h = qinv · (sp - sq) mod p. s_acc holds sp·R; the Montgomery product
+    // with plain qinv cancels the R.
+    if (sub_words(h, s_acc, sq_mont, n)) {
+        add_words(h, h, s_p.mod, n);
+    }
+    mont_mul(h, h, s_qinv, &s_p, n);
+
+    // s = sq + h·q
+    memset(s_result, 0, sizeof(s_result));
+    for (uint8_t i = 0; i < n; i++) {
+        uint64_t c = 0;
+        for (uint8_t j = 0; j < n; j++) {
+            c += mul32(h[i], s_q.mod[j]) + s_result[i + j];
+            s_result[i + j] = (uint32_t)c;
+            c >>= 32;
+        }
+        s_result[i + n] = (uint32_t)c;
+    }
+    uint64_t c = 0;
+    for (uint16_t i = 0; i < 2 * n; i++) {
+        c += (uint64_t)s_result[i] + (i < n ? s_sq[i] : 0);
+        s_result[i] = (uint32_t)c;
+        c >>= 32;
+    }
+
+    memset(wide, 0, sizeof(wide));
+    memset(sq_mont, 0, sizeof(sq_mont));
+    memset(h, 0, sizeof(h));
+}
+
+// ============================================================================
+// KEY LOAD
+// ============================================================================
+
+// Big-endian MPI → little-endian words
+static bool mpi_to_words(uint32_t *out, const mbedtls_mpi *x, uint8_t n)
+{
+    uint8_t buf[CRT_MAX_WORDS * 4];
+    size_t len = (size_t)n * 4;
+    if (mbedtls_mpi_write_binary(x, buf, len) != 0) return false;
+    for (uint8_t i = 0; i < n; i++) {
+        const uint8_t *w = &buf[len - 4 * (i + 1)];
+        out[i] = ((uint32_t)w[0] << 24) | ((uint32_t)w[1] << 16) |
+                 ((uint32_t)w[2] << 8) | w[3];
+    }
+    memset(buf, 0, sizeof(buf));
+    return true;
+}
+
+static bool load_prime(crt_prime_t *ctx, const mbedtls_mpi *mod, const mbedtls_mpi *exp, uint8_t n)
+{
+    mbedtls_mpi t;
+    mbedtls_mpi_init(&t);
+    bool ok = mpi_to_words(ctx->mod, mod, n) && mpi_to_words(ctx->exp, exp, n);
+
+    // R mod p and R^3 mod p, R = 2^(32n)
+    ok = ok && mbedtls_mpi_lset(&t, 1) == 0 &&
+         mbedtls_mpi_shift_l(&t, 32 * n) == 0 &&
+         mbedtls_mpi_mod_mpi(&t, &t, mod) == 0 &&
+         mpi_to_words(ctx->one, &t, n);
+    ok = ok && mbedtls_mpi_lset(&t, 1) == 0 &&
+         mbedtls_mpi_shift_l(&t, 96 * n) == 0 &&
+         mbedtls_mpi_mod_mpi(&t, &t, mod) == 0 &&
+         mpi_to_words(ctx->rr3, &t, n);
+    mbedtls_mpi_free(&t);
+    if (!ok) return false;
+
+    // -p^-1 mod 2^32 by Newton iteration (each step doubles correct bits)
+    uint32_t p0 = ctx->mod[0];
+    uint32_t x = p0;            // Correct to 3 bits for odd p0
+    for (int i = 0; i < 4; i++) {
+        x *= 2 - p0 * x;
+    }
+    ctx->minv = 0 - x;
+
+    size_t bits = mbedtls_mpi_bitlen(exp);
+    ctx->exp_windows = (uint16_t)((bits + CRT_WINDOW_BITS - 1) / CRT_WINDOW_BITS);
+    if (ctx->exp_windows == 0) ctx->exp_windows = 1;
+    return true;
+}
+
+bool ps4_rsa_crt_load(const mbedtls_rsa_context *rsa)
+{
+    ps4_rsa_crt_clear();
+
+    mbedtls_mpi P, Q, DP, DQ, QP;
+    mbedtls_mpi_init(&P);
+    mbedtls_mpi_init(&Q);
+    mbedtls_mpi_init(&DP);
+    mbedtls_mpi_init(&DQ);
+    mbedtls_mpi_init(&QP);
+
+    bool ok = false;
+    if (mbedtls_rsa_export(rsa, NULL, &P, &Q, NULL, NULL) != 0 ||
+        mbedtls_rsa_export_crt(rsa, &DP, &DQ, &QP) != 0) {
+        printf("[ps4_rsa_crt] CRT export failed\n");
+        goto cleanup;
+    }
+
+    size_t pbits = mbedtls_mpi_bitlen(&P);
+    size_t qbits = mbedtls_mpi_bitlen(&Q);
+    uint8_t pw = (uint8_t)((pbits + 31) / 32);
+    uint8_t qw = (uint8_t)((qbits + 31) / 32);
+    if (pbits == 0 || pw != qw || pw > CRT_MAX_WORDS ||
+        mbedtls_rsa_get_len(rsa) > (size_t)pw * 8) {
+        printf("[ps4_rsa_crt] Unsupported key shape (P %u bits, Q %u bits)\n",
+               (unsigned)pbits, (unsigned)qbits);
+        goto cleanup;
+    }
+    s_words = pw;
+
+    ok = load_prime(&s_p, &P, &DP, pw) &&
+         load_prime(&s_q, &Q, &DQ, pw) &&
+         mpi_to_words(s_qinv, &QP, pw);
+
+cleanup:
+    mbedtls_mpi_free(&P);
+    mbedtls_mpi_free(&Q);
+    mbedtls_mpi_free(&DP);
+    mbedtls_mpi_free(&DQ);
+    mbedtls_mpi_free(&QP);
+
+    if (!ok) {
+        ps4_rsa_crt_clear();
+        return false;
+    }
+    s_loaded = true;
+    printf("[ps4_rsa_crt] CRT key cached (%u-bit primes)\n", (unsigned)(pw * 32));
+    return true;
+}
+
+void ps4_rsa_crt_clear(void)
+{
+    memset(&s_p, 0, sizeof(s_p));
+    memset(&s_q, 0, sizeof(s_q));
+    memset(s_qinv, 0, sizeof(s_qinv));
+    memset(s_table, 0, sizeof(s_table));
+    memset(s_acc, 0, sizeof(s_acc));
+    memset(s_sq, 0, sizeof(s_sq));
+    memset(s_input, 0, sizeof(s_input));
+    s_words = 0;
+    s_loaded = false;
+    s_phase = CRT_PHASE_IDLE;
+}
+
+bool ps4_rsa_crt_is_loaded(void)
+{
+    return s_loaded;
+}
+
+// ============================================================================
+// OPERATION
+// ============================================================================
+
+void ps4_rsa_crt_start(const uint8_t *input, size_t len)
+{
+    memset(s_input, 0, sizeof(s_input));
+    size_t max = (size_t)s_words * 8;
+    if (len > max) len = max;
+    for (size_t i = 0; i < len; i++) {
+        size_t bit = (len - 1 - i) * 8;
+        s_input[bit / 32] |= (uint32_t)input[i] << (bit % 32);
+    }
+    s_phase = s_loaded ? CRT_PHASE_Q_ENTER : CRT_PHASE_IDLE;
+}
+
+bool ps4_rsa_crt_step(uint32_t budget_us)
+{
+    uint32_t start = platform_time_us();
+
+    do {
+        switch (s_phase) {
+            case CRT_PHASE_Q_ENTER:
+                exp_enter(&s_q);
+                s_phase = CRT_PHASE_Q_EXP;
+                break;
+
+            case CRT_PHASE_Q_EXP:
+                if (exp_window_step(&s_q)) s_phase = CRT_PHASE_Q_EXIT;
+                break;
+
+            case CRT_PHASE_Q_EXIT: {
+                // Out of Montgomery form: acc·1·R^-1
+                uint32_t plain_one[CRT_MAX_WORDS] = { 1 };
+                mont_mul(s_sq, s_acc, plain_one, &s_q, s_words);
+                s_phase = CRT_PHASE_P_ENTER;
+                break;
+            }
+
+            case CRT_PHASE_P_ENTER:
+                exp_enter(&s_p);
+                s_phase = CRT_PHASE_P_EXP;
+                break;
+
+            case CRT_PHASE_P_EXP:
+                // sp stays in Montgomery form for Garner
+                if (exp_window_step(&s_p)) s_phase = CRT_PHASE_GARNER;
+                break;
+
+            case CRT_PHASE_GARNER:
+                garner();
+                memset(s_table, 0, sizeof(s_table));
+                memset(s_acc, 0, sizeof(s_acc));
+                memset(s_sq, 0, sizeof(s_sq));
+                s_phase = CRT_PHASE_DONE;
+                return true;
+
+            case CRT_PHASE_DONE:
+                return true;
+
+            case CRT_PHASE_IDLE:
+            default:
+                return false;
+        }
+    } while ((uint32_t)(platform_time_us() - start) < budget_us);
+
+    return s_phase == CRT_PHASE_DONE;
+}
+
+void ps4_rsa_crt_result(uint8_t *out, size_t len)
+{
+    memset(out, 0, len);
+    size_t max = (size_t)s_words * 8;
+    size_t n = len < max ? len : max;
+    for (size_t i = 0; i < n; i++) {
+        size_t bit = i * 8;
+        out[len - 1 - i] = (uint8_t)(s_result[bit / 32] >> (bit % 32));
+    }
+}
@@ -0,0 +1,57 @@
+// ps4_rsa_crt.h - Time-sliced RSA-CRT private-key operation for PS4 auth
+//
+// Replaces mbedtls_rsa_private() on the PS4 signing path. At key load the
+// CRT components (P, Q, DP, DQ, QP) are exported from the mbedTLS context
+// and the per-prime Montgomery constants are cached in RAM, so a signature
+// is two 1024-bit modular exponentiations plus a Garner recombination with
+// no bignum allocation.
+//
+// The operation is a state machine advanced by ps4_rsa_crt_step() in
+// bounded slices, so it can run on either core: in one go on an idle
+// Core 1, or a millisecond at a time from the Core 0 main loop.
+//
+// Only one operation can be in flight; callers serialize access.
+//
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+
+#ifndef PS4_RSA_CRT_H
+#define PS4_RSA_CRT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "mbedtls/rsa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Export CRT parameters from a completed private-key context and precompute
+// Montgomery constants. Returns false if the key shape is unsupported
+// (primes larger than 1024 bits or of unequal word length); the caller then
+// keeps using mbedTLS.
+bool ps4_rsa_crt_load(const mbedtls_rsa_context *rsa);
+
+// Wipe cached key material.
+void ps4_rsa_crt_clear(void);
+
+// True after a successful ps4_rsa_crt_load().
+bool ps4_rsa_crt_is_loaded(void);
+
+// Begin computing input^d mod N. input is big-endian, len == modulus bytes,
+// and must be < N (an EMSA-PSS encoded message always is).
+void ps4_rsa_crt_start(const uint8_t *input, size_t len);
+
+// Advance the operation for roughly budget_us microseconds (at least one
+// unit of work per call). Returns true once the result is ready.
+bool ps4_rsa_crt_step(uint32_t budget_us);
+
+// Copy the finished result, big-endian, left-padded to len bytes.
+void ps4_rsa_crt_result(uint8_t *out, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PS4_RSA_CRT_H
@@ -69,7 +69,7 @@ static bool psclassic_mode_send_report(uint8_t player_index,
         | (buttons & JP_BUTTON_S1 ? PSCLASSIC_MASK_SELECT   : 0)
         | (buttons & JP_BUTTON_S2 ? PSCLASSIC_MASK_START    : 0);
 
-    return tud_hid_report(0, &psclassic_report, sizeof(psclassic_report));
+    return usbd_report_send(0, 0, &psclassic_report, sizeof(psclassic_report));
 }
 
 static const uint8_t* psclassic_mode_get_device_descriptor(void)
@@ -102,6 +102,7 @@ const usbd_mode_t psclassic_mode = {
     .init = psclassic_mode_init,
     .send_report = psclassic_mode_send_report,
     .is_ready = psclassic_mode_is_ready,
+    .repeat_policy = USBD_REPEAT_HID_IDLE,
 
     // No feedback support for PS Classic
     .handle_output = NULL,
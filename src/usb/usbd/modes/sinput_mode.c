@@ -415,8 +415,12 @@ static bool sinput_mode_send_report(uint8_t player_index,
     sinput_report.lt = convert_trigger_to_s16(profile_out->l2_analog);
     sinput_report.rt = convert_trigger_to_s16(profile_out->r2_analog);
 
-    // IMU timestamp (microseconds since boot)
-    sinput_report.imu_timestamp = platform_time_us();
+    // IMU timestamp (microseconds since boot). Only advances with motion
+    // data, so a pad without an IMU produces identical reports when idle
+    // and the change gate can drop them.
+    if (event->has_motion) {
+        sinput_report.imu_timestamp = platform_time_us();
+    }
 
     // IMU data - passthrough from input controller if available
     if (event->has_motion) {
@@ -480,7 +484,7 @@ static bool sinput_mode_send_report(uint8_t player_index,
     sinput_send_kbd_consumer(event);
 
     // Send report on gamepad interface (skip report_id byte since TinyUSB handles it)
-    return tud_hid_n_report(ITF_NUM_HID_GAMEPAD, SINPUT_REPORT_ID_INPUT,
+    return usbd_report_send(ITF_NUM_HID_GAMEPAD, SINPUT_REPORT_ID_INPUT,
                             ((uint8_t*)&sinput_report) + 1,
                             sizeof(sinput_report) - 1);
 }
@@ -854,6 +858,7 @@ const usbd_mode_t sinput_mode = {
     .init = sinput_mode_init,
     .send_report = sinput_mode_send_report,
     .is_ready = sinput_mode_is_ready,
+    .repeat_policy = USBD_REPEAT_HID_IDLE,
 
     .handle_output = sinput_mode_handle_output,
     .get_rumble = sinput_mode_get_rumble,
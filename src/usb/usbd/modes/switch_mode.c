@@ -94,7 +94,7 @@ static bool switch_mode_send_report(uint8_t player_index,
 
     switch_report.vendor = 0;
 
-    return tud_hid_report(0, &switch_report, sizeof(switch_report));
+    return usbd_report_send(0, 0, &switch_report, sizeof(switch_report));
 }
 
 static const uint8_t* switch_mode_get_device_descriptor(void)
@@ -127,6 +127,8 @@ const usbd_mode_t switch_mode = {
     .init = switch_mode_init,
     .send_report = switch_mode_send_report,
     .is_ready = switch_mode_is_ready,
+    // Switch firmware expects a steady report stream from wired pads
+    .repeat_policy = USBD_REPEAT_EVERY_EVENT,
 
     // No feedback support for Switch mode (basic HID)
     .handle_output = NULL,
@@ -0,0 +1,665 @@
+// switch_pro_mode.c - Nintendo Switch Pro Controller USB device mode
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// Genuine Pro Controller emulation (057E:2009). The console runs the USB
+// handshake (0x80 01..04), then configures the controller with subcommands
+// (device info, SPI calibration reads, input mode 0x30, IMU enable). After
+// that the controller streams 0x30 full reports every 8 ms, each carrying
+// the three most recent IMU frames so motion runs at the sensor's rate
+// rather than one sample per report.
+//
+// IMU frames are captured per routed event through the on_input hook (not
+// from the coalesced pending event), so samples that arrive between two
+// reports are kept instead of overwritten.
+
+#include "platform/platform.h"
+#include "tusb.h"
+#include "../usbd_mode.h"
+#include "../usbd.h"
+#include "descriptors/switch_pro_descriptors.h"
+#include "core/buttons.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+// Latest standard report state (buttons + sticks), rebuilt per input event
+static switch_pro_std_t pro_std;
+
+// Protocol state set by the host
+static bool pro_usb_hid_only = false;       // 0x80 0x04 received → stream reports
+static uint8_t pro_report_mode = 0;         // 0x30 or 0x3F once the host picks one
+static bool pro_imu_enabled = false;
+static bool pro_vibration_enabled = false;
+static uint8_t pro_player_leds = 0;
+static uint8_t pro_timer = 0;
+static uint32_t pro_last_report_us = 0;
+static bool pro_state_dirty = false;        // Simple-HID mode: send on change only
+
+// Pending reply to the host. Replies take priority over 0x30 streaming so
+// the handshake never waits behind a full report.
+static uint8_t pro_reply_id = 0;
+static uint8_t pro_reply[SWITCH_PRO_REPORT_SIZE - 1];
+static bool pro_reply_pending = false;
+
+// IMU sample ring. Written per event (on_input), drained per report. Sized
+// to hold well over one report interval at the fastest supported source
+// rate (DS4/DS5 USB at 1 kHz delivers ~8 samples per 8 ms report).
+#define PRO_IMU_RING_SIZE 16
+static switch_pro_imu_frame_t pro_imu_ring[PRO_IMU_RING_SIZE];
+static volatile uint8_t pro_imu_head = 0;   // Next write slot
+static uint8_t pro_imu_count = 0;           // Valid samples in ring (saturates)
+static switch_pro_imu_frame_t pro_imu_last; // Held when no new sample arrived
+static uint32_t pro_imu_dropped = 0;        // Samples overwritten before a report drained them
+
+// Feedback from host
+static uint8_t pro_rumble_left = 0;
+static uint8_t pro_rumble_right = 0;
+static bool pro_feedback_dirty = false;
+
+// Controller MAC (derived from the board unique ID, stable across boots)
+static uint8_t pro_mac[6];
+
+// ============================================================================
+// SPI FLASH IMAGE
+// ============================================================================
+
+// Factory IMU calibration: accel origin, accel sensitivity, gyro origin,
+// gyro sensitivity (int16 LE each axis). Origin 0 + the nominal sensitivity
+// values make the console's scaling the identity for our raw frames.
+static const uint8_t pro_spi_imu_factory[24] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,     // Accel origin X/Y/Z
+    0x00, 0x40, 0x00, 0x40, 0x00, 0x40,     // Accel sensitivity 16384
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,     // Gyro origin X/Y/Z
+    0x3B, 0x34, 0x3B, 0x34, 0x3B, 0x34,     // Gyro sensitivity 13371
+};
+
+// 12-bit pair packer for stick calibration: (a, b) → 3 bytes
+#define PRO_PACK12(a, b) \
+    (uint8_t)((a) & 0xFF), (uint8_t)((((a) >> 8) & 0x0F) | (((b) & 0x0F) << 4)), (uint8_t)(((b) >> 4) & 0xFF)
+
+// Factory stick calibration. Left stick order is max-above, center,
+// min-below; right stick order is center, min-below, max-above.
+static const uint8_t pro_spi_stick_factory[18] = {
+    PRO_PACK12(SWITCH_PRO_STICK_RANGE, SWITCH_PRO_STICK_RANGE),
+    PRO_PACK12(SWITCH_PRO_STICK_CENTER, SWITCH_PRO_STICK_CENTER),
+    PRO_PACK12(SWITCH_PRO_STICK_RANGE, SWITCH_PRO_STICK_RANGE),
+    PRO_PACK12(SWITCH_PRO_STICK_CENTER, SWITCH_PRO_STICK_CENTER),
+    PRO_PACK12(SWITCH_PRO_STICK_RANGE, SWITCH_PRO_STICK_RANGE),
+    PRO_PACK12(SWITCH_PRO_STICK_RANGE, SWITCH_PRO_STICK_RANGE),
+};
+
+// Body / buttons / left grip / right grip colors (RGB)
+static const uint8_t pro_spi_colors[12] = {
+    0x32, 0x32, 0x32,   // Body: dark grey
+    0xFF, 0xFF, 0xFF,   // Buttons: white
+    0x32, 0x32, 0x32,   // Left grip
+    0x32, 0x32, 0x32,   // Right grip
+};
+
+// IMU horizontal offsets (Pro Controller defaults)
+static const uint8_t pro_spi_imu_horizontal[6] = {
+    0x50, 0xFD, 0x00, 0x00, 0xC6, 0x0F,
+};
+
+// Stick parameters (dead zone 0xAE, range ratio 0xE14) — same for both sticks
+static const uint8_t pro_spi_stick_params[18] = {
+    0x0F, 0x30, 0x61, 0x96, 0x30, 0xF3, 0xD4, 0x14, 0x54,
+    0x41, 0x15, 0x54, 0xC7, 0x79, 0x9C, 0x33, 0x36, 0x63,
+};
+
+typedef struct {
+    uint16_t addr;
+    uint8_t len;
+    const uint8_t* data;
+} pro_spi_region_t;
+
+static const pro_spi_region_t pro_spi_regions[] = {
+    { SWITCH_PRO_SPI_IMU_FACTORY,    sizeof(pro_spi_imu_factory),    pro_spi_imu_factory },
+    { SWITCH_PRO_SPI_STICK_FACTORY,  sizeof(pro_spi_stick_factory),  pro_spi_stick_factory },
+    { SWITCH_PRO_SPI_COLORS,         sizeof(pro_spi_colors),         pro_spi_colors },
+    { SWITCH_PRO_SPI_IMU_HORIZONTAL, sizeof(pro_spi_imu_horizontal), pro_spi_imu_horizontal },
+    { SWITCH_PRO_SPI_STICK_PARAMS_L, sizeof(pro_spi_stick_params),   pro_spi_stick_params },
+    { SWITCH_PRO_SPI_STICK_PARAMS_R, sizeof(pro_spi_stick_params),   pro_spi_stick_params },
+};
+
+// Read emulated SPI flash. Unmapped bytes read as erased (0xFF), which the
+// console treats as "no serial" / "no user calibration".
+static void pro_spi_read(uint32_t addr, uint8_t* out, uint8_t len)
+{
+    memset(out, 0xFF, len);
+    for (size_t r = 0; r < sizeof(pro_spi_regions) / sizeof(pro_spi_regions[0]); r++) {
+        const pro_spi_region_t* reg = &pro_spi_regions[r];
+        uint32_t start = reg->addr > addr ? reg->addr : addr;
+        uint32_t end_req = addr + len;
+        uint32_t end_reg = reg->addr + reg->len;
+        uint32_t end = end_req < end_reg ? end_req : end_reg;
+        if (start < end) {
+            memcpy(out + (start - addr), reg->data + (start - reg->addr), end - start);
+        }
+    }
+}
+
+// ============================================================================
+// CONVERSION HELPERS
+// ============================================================================
+
+// 8-bit axis → 12-bit (replicate the high nibble so 0xFF maps to 0xFFF)
+static inline uint16_t scale_axis_12(uint8_t v)
+{
+    return ((uint16_t)v << 4) | (v >> 4);
+}
+
+static void pack_stick(uint8_t out[3], uint8_t x, uint8_t y)
+{
+    // Joypad is HID convention (0 = up); Switch sticks are 0 = down
+    uint16_t x12 = scale_axis_12(x);
+    uint16_t y12 = 0xFFF - scale_axis_12(y);
+    out[0] = x12 & 0xFF;
+    out[1] = (uint8_t)((x12 >> 8) | ((y12 & 0x0F) << 4));
+    out[2] = (uint8_t)(y12 >> 4);
+}
+
+static inline int16_t clamp_s16(int32_t v)
+{
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)v;
+}
+
+// Convert one event's motion to a Pro Controller IMU frame. Input accel is
+// int16 over ±accel_range milli-g, gyro int16 over ±gyro_range dps. The
+// Pro Controller's LSM6DS3 runs at ±8 g / ±2000 dps, and the factory
+// calibration we serve makes its raw counts map 1:1 onto those ranges.
+static void convert_motion(const input_event_t* event, switch_pro_imu_frame_t* out)
+{
+    for (int i = 0; i < 3; i++) {
+        out->accel[i] = clamp_s16(((int32_t)event->accel[i] * event->accel_range) / 8000);
+        out->gyro[i] = clamp_s16(((int32_t)event->gyro[i] * event->gyro_range) / 2000);
+    }
+}
+
+// Fill the three report frames from the ring: [0] newest, [2] oldest.
+// With more samples than frames, each frame carries the average of a run of
+// consecutive samples (newest run in [0]), so the host still integrates all
+// of the rotation since the last report. With fewer, the missing older
+// frames repeat the oldest new sample, the nearest in time, so the host
+// integrates a held rate instead of a zero spike.
+static void drain_imu_frames(switch_pro_imu_frame_t frames[SWITCH_PRO_IMU_SAMPLES])
+{
+    uint8_t head = pro_imu_head;
+    uint8_t avail = pro_imu_count;
+
+    if (avail >= SWITCH_PRO_IMU_SAMPLES) {
+        for (uint8_t i = 0; i < SWITCH_PRO_IMU_SAMPLES; i++) {
+            // Samples aged [first, end) since the last write, 0 = newest
+            uint8_t first = (uint8_t)(i * avail / SWITCH_PRO_IMU_SAMPLES);
+            uint8_t end = (uint8_t)((i + 1) * avail / SWITCH_PRO_IMU_SAMPLES);
+            int32_t accel[3] = { 0 }, gyro[3] = { 0 };
+            for (uint8_t age = first; age < end; age++) {
+                const switch_pro_imu_frame_t* f = &pro_imu_ring[(uint8_t)(head - 1 - age) % PRO_IMU_RING_SIZE];
+                for (int k = 0; k < 3; k++) {
+                    accel[k] += f->accel[k];
+                    gyro[k] += f->gyro[k];
+                }
+            }
+            int32_t n = end - first;
+            for (int k = 0; k < 3; k++) {
+                frames[i].accel[k] = (int16_t)(accel[k] / n);
+                frames[i].gyro[k] = (int16_t)(gyro[k] / n);
+            }
+        }
+    } else {
+        for (uint8_t i = 0; i < SWITCH_PRO_IMU_SAMPLES; i++) {
+            if (i < avail) {
+                frames[i] = pro_imu_ring[(uint8_t)(head - 1 - i) % PRO_IMU_RING_SIZE];
+            } else if (avail > 0) {
+                frames[i] = frames[avail - 1];
+            } else {
+                frames[i] = pro_imu_last;
+            }
+        }
+    }
+    if (avail > 0) {
+        pro_imu_last = frames[0];
+    }
+    pro_imu_count = 0;
+}
+
+// Decode HD rumble amplitude for one motor (4 bytes). The amplitude fields
+// are logarithmic on real hardware; a linear read of the encoded amplitude
+// is close enough to drive an ERM motor on the input controller.
+static uint8_t decode_rumble_amp(const uint8_t* m)
+{
+    uint8_t hf_amp = m[1] >> 1;                     // 0x00-0x64
+    uint8_t lf_amp = (uint8_t)((m[3] - 0x40) & 0x7F); // 0x00-0x32
+    uint32_t hf = (uint32_t)hf_amp * 255 / 0x64;
+    uint32_t lf = (uint32_t)lf_amp * 255 / 0x32;
+    uint32_t amp = hf > lf ? hf : lf;
+    return amp > 255 ? 255 : (uint8_t)amp;
+}
+
+static void handle_rumble(const uint8_t* rumble)
+{
+    uint8_t left = pro_vibration_enabled ? decode_rumble_amp(&rumble[0]) : 0;
+    uint8_t right = pro_vibration_enabled ? decode_rumble_amp(&rumble[4]) : 0;
+    if (left != pro_rumble_left || right != pro_rumble_right) {
+        pro_rumble_left = left;
+        pro_rumble_right = right;
+        pro_feedback_dirty = true;
+    }
+}
+
+// ============================================================================
+// PROTOCOL HANDLERS
+// ============================================================================
+
+static void queue_usb_reply(uint8_t cmd, const uint8_t* data, uint8_t len)
+{
+    memset(pro_reply, 0, sizeof(pro_reply));
+    pro_reply[0] = cmd;
+    if (data && len) {
+        memcpy(&pro_reply[1], data, len);
+    }
+    pro_reply_id = SWITCH_PRO_IN_USB_REPLY;
+    pro_reply_pending = true;
+}
+
+static void queue_subcmd_reply(uint8_t ack, uint8_t subcmd, const uint8_t* data, uint8_t len)
+{
+    switch_pro_subcmd_reply_t* r = (switch_pro_subcmd_reply_t*)pro_reply;
+    memset(pro_reply, 0, sizeof(pro_reply));
+    r->std = pro_std;
+    r->std.timer = pro_timer++;
+    r->ack = ack;
+    r->subcmd = subcmd;
+    if (data && len) {
+        if (len > sizeof(r->data)) len = sizeof(r->data);
+        memcpy(r->data, data, len);
+    }
+    pro_reply_id = SWITCH_PRO_IN_SUBCMD_REPLY;
+    pro_reply_pending = true;
+}
+
+static void handle_usb_command(uint8_t cmd)
+{
+    switch (cmd) {
+        case SWITCH_PRO_USB_STATUS: {
+            // 0x00, controller type 0x03 (Pro), MAC big-endian
+            uint8_t data[8] = { 0x00, 0x03 };
+            for (int i = 0; i < 6; i++) data[2 + i] = pro_mac[5 - i];
+            queue_usb_reply(cmd, data, sizeof(data));
+            break;
+        }
+        case SWITCH_PRO_USB_HANDSHAKE:
+        case SWITCH_PRO_USB_BAUDRATE:
+            queue_usb_reply(cmd, NULL, 0);
+            break;
+        case SWITCH_PRO_USB_HID_ONLY:
+            pro_usb_hid_only = true;
+            printf("[switch_pro] USB HID-only, streaming enabled\n");
+            break;
+        case SWITCH_PRO_USB_BT_RESTORE:
+            pro_usb_hid_only = false;
+            break;
+        default:
+            break;
+    }
+}
+
+static void handle_subcommand(uint8_t subcmd, const uint8_t* args, uint16_t args_len)
+{
+    switch (subcmd) {
+        case SWITCH_PRO_SUBCMD_DEVICE_INFO: {
+            // FW 3.72, Pro Controller, MAC, SPI colors in use
+            uint8_t data[12] = { 0x03, 0x48, 0x03, 0x02 };
+            for (int i = 0; i < 6; i++) data[4 + i] = pro_mac[5 - i];
+            data[10] = 0x01;
+            data[11] = 0x01;
+            queue_subcmd_reply(0x82, subcmd, data, sizeof(data));
+            break;
+        }
+
+        case SWITCH_PRO_SUBCMD_REPORT_MODE:
+            if (args_len >= 1) {
+                pro_report_mode = args[0];
+                printf("[switch_pro] Input report mode 0x%02X\n", pro_report_mode);
+            }
+            queue_subcmd_reply(0x80, subcmd, NULL, 0);
+            break;
+
+        case SWITCH_PRO_SUBCMD_TRIGGER_TIME: {
+            uint8_t data[14] = {0};
+            queue_subcmd_reply(0x83, subcmd, data, sizeof(data));
+            break;
+        }
+
+        case SWITCH_PRO_SUBCMD_SPI_READ: {
+            if (args_len < 5) {
+                queue_subcmd_reply(0x00, subcmd, NULL, 0);
+                break;
+            }
+            uint32_t addr = (uint32_t)args[0] | ((uint32_t)args[1] << 8) |
+                            ((uint32_t)args[2] << 16) | ((uint32_t)args[3] << 24);
+            uint8_t len = args[4];
+            if (len > 0x1D) len = 0x1D;  // Max SPI read per reply
+            uint8_t data[5 + 0x1D];
+            memcpy(data, args, 5);
+            data[4] = len;
+            pro_spi_read(addr, &data[5], len);
+            queue_subcmd_reply(0x90, subcmd, data, (uint8_t)(5 + len));
+            break;
+        }
+
+        case SWITCH_PRO_SUBCMD_MCU_CONFIG: {
+            // NFC/IR MCU "standby" status with its trailing CRC8
+            uint8_t data[34] = { 0x01, 0x00, 0xFF, 0x00, 0x08, 0x00, 0x1B, 0x01 };
+            data[33] = 0xC8;
+            queue_subcmd_reply(0xA0, subcmd, data, sizeof(data));
+            break;
+        }
+
+        case SWITCH_PRO_SUBCMD_PLAYER_LEDS:
+            if (args_len >= 1 && pro_player_leds != args[0]) {
+                pro_player_leds = args[0];
+                pro_feedback_dirty = true;
+            }
+            queue_subcmd_reply(0x80, subcmd, NULL, 0);
+            break;
+
+        case SWITCH_PRO_SUBCMD_IMU_ENABLE:
+            if (args_len >= 1) {
+                pro_imu_enabled = args[0] != 0;
+                pro_imu_count = 0;
+                printf("[switch_pro] IMU %s\n", pro_imu_enabled ? "enabled" : "disabled");
+            }
+            queue_subcmd_reply(0x80, subcmd, NULL, 0);
+            break;
+
+        case SWITCH_PRO_SUBCMD_VIBRATION:
+            if (args_len >= 1) {
+                pro_vibration_enabled = args[0] != 0;
+            }
+            queue_subcmd_reply(0x80, subcmd, NULL, 0);
+            break;
+
+        case SWITCH_PRO_SUBCMD_BT_PAIR:
+            // Pairing over USB: acknowledge, nothing to store
+            queue_subcmd_reply(0x81, subcmd, (const uint8_t[]){ 0x03 }, 1);
+            break;
+
+        case SWITCH_PRO_SUBCMD_SHIPMENT:
+        case SWITCH_PRO_SUBCMD_MCU_STATE:
+        case SWITCH_PRO_SUBCMD_HOME_LED:
+        case SWITCH_PRO_SUBCMD_IMU_SENS:
+        default:
+            queue_subcmd_reply(0x80, subcmd, NULL, 0);
+            break;
+    }
+}
+
+// ============================================================================
+// REPORT TRANSMISSION
+// ============================================================================
+
+static bool send_pending_reply(void)
+{
+    if (!pro_reply_pending) return false;
+    if (!tud_hid_report(pro_reply_id, pro_reply, sizeof(pro_reply))) return false;
+    pro_reply_pending = false;
+    return true;
+}
+
+static bool send_full_report(void)
+{
+    switch_pro_full_report_t report;
+    memset(&report, 0, sizeof(report));
+    report.std = pro_std;
+    report.std.timer = pro_timer++;
+
+    if (pro_imu_enabled) {
+        drain_imu_frames(report.imu);
+    }
+
+    return tud_hid_report(SWITCH_PRO_IN_FULL, &report, sizeof(report));
+}
+
+// ============================================================================
+// MODE INTERFACE IMPLEMENTATION
+// ============================================================================
+
+static void switch_pro_mode_init(void)
+{
+    memset(&pro_std, 0, sizeof(pro_std));
+    pro_std.battery_conn = 0x91;  // Full battery, charging, Pro + USB powered
+    pro_std.vibrator = 0x80;
+    pack_stick(pro_std.left_stick, 0x80, 0x80);
+    pack_stick(pro_std.right_stick, 0x80, 0x80);
+
+    pro_usb_hid_only = false;
+    pro_report_mode = 0;
+    pro_imu_enabled = false;
+    pro_vibration_enabled = false;
+    pro_player_leds = 0;
+    pro_timer = 0;
+    pro_last_report_us = 0;
+    pro_state_dirty = false;
+    pro_reply_pending = false;
+
+    pro_imu_head = 0;
+    pro_imu_count = 0;
+    pro_imu_dropped = 0;
+    memset(&pro_imu_last, 0, sizeof(pro_imu_last));
+
+    pro_rumble_left = 0;
+    pro_rumble_right = 0;
+    pro_feedback_dirty = false;
+
+    // Locally administered MAC from the board ID so consoles remember us
+    platform_get_unique_id(pro_mac, sizeof(pro_mac));
+    pro_mac[5] = (pro_mac[5] & 0xFC) | 0x02;
+}
+
+static bool switch_pro_mode_is_ready(void)
+{
+    // State caching never waits on the endpoint — transmission is paced by
+    // switch_pro_mode_task() at the controller's native cadence.
+    return true;
+}
+
+// Per-event hook: capture every IMU sample, not just the one that survives
+// until the next report.
+static void switch_pro_mode_on_input(uint8_t player_index, const input_event_t* event)
+{
+    if (player_index != 0 || !event->has_motion || !pro_imu_enabled) return;
+
+    uint8_t head = pro_imu_head;
+    convert_motion(event, &pro_imu_ring[head % PRO_IMU_RING_SIZE]);
+    pro_imu_head = (uint8_t)(head + 1);
+    if (pro_imu_count < PRO_IMU_RING_SIZE) {
+        pro_imu_count++;
+    } else {
+        pro_imu_dropped++;  // Overwrote the oldest unsent sample
+    }
+}
+
+static bool switch_pro_mode_send_report(uint8_t player_index,
+                                         const input_event_t* event,
+                                         const profile_output_t* profile_out,
+                                         uint32_t buttons)
+{
+    (void)player_index;
+    (void)event;
+
+    // Buttons - position-based mapping (matches switch_mode.c)
+    uint8_t right = 0, shared = 0, left = 0;
+    if (buttons & JP_BUTTON_B1) right |= SWITCH_PRO_BTN_B;
+    if (buttons & JP_BUTTON_B2) right |= SWITCH_PRO_BTN_A;
+    if (buttons & JP_BUTTON_B3) right |= SWITCH_PRO_BTN_Y;
+    if (buttons & JP_BUTTON_B4) right |= SWITCH_PRO_BTN_X;
+    if (buttons & JP_BUTTON_R1) right |= SWITCH_PRO_BTN_R;
+    if (buttons & JP_BUTTON_R2) right |= SWITCH_PRO_BTN_ZR;
+    if (buttons & JP_BUTTON_S1) shared |= SWITCH_PRO_BTN_MINUS;
+    if (buttons & JP_BUTTON_S2) shared |= SWITCH_PRO_BTN_PLUS;
+    if (buttons & JP_BUTTON_R3) shared |= SWITCH_PRO_BTN_RSTICK;
+    if (buttons & JP_BUTTON_L3) shared |= SWITCH_PRO_BTN_LSTICK;
+    if (buttons & JP_BUTTON_A1) shared |= SWITCH_PRO_BTN_HOME;
+    if (buttons & JP_BUTTON_A2) shared |= SWITCH_PRO_BTN_CAPTURE;
+    if (buttons & JP_BUTTON_DD) left |= SWITCH_PRO_BTN_DOWN;
+    if (buttons & JP_BUTTON_DU) left |= SWITCH_PRO_BTN_UP;
+    if (buttons & JP_BUTTON_DR) left |= SWITCH_PRO_BTN_RIGHT;
+    if (buttons & JP_BUTTON_DL) left |= SWITCH_PRO_BTN_LEFT;
+    if (buttons & JP_BUTTON_L1) left |= SWITCH_PRO_BTN_L;
+    if (buttons & JP_BUTTON_L2) left |= SWITCH_PRO_BTN_ZL;
+
+    switch_pro_std_t next = pro_std;
+    next.buttons[0] = right;
+    next.buttons[1] = shared;
+    next.buttons[2] = left;
+    pack_stick(next.left_stick, profile_out->left_x, profile_out->left_y);
+    pack_stick(next.right_stick, profile_out->right_x, profile_out->right_y);
+
+    if (memcmp(&next, &pro_std, sizeof(next)) != 0) {
+        pro_std = next;
+        pro_state_dirty = true;
+    }
+    return true;
+}
+
+static void switch_pro_mode_task(void)
+{
+    if (!tud_hid_ready()) return;
+
+    // Handshake / subcommand replies first
+    if (send_pending_reply()) return;
+
+    // Nothing streams until the host forces USB HID and picks a mode
+    if (!pro_usb_hid_only) return;
+
+    uint32_t now = platform_time_us();
+    if (pro_report_mode == SWITCH_PRO_MODE_FULL) {
+        uint32_t since = now - pro_last_report_us;
+        if (since >= SWITCH_PRO_REPORT_INTERVAL_US) {
+            if (send_full_report()) {
+                pro_last_report_us = now;
+                pro_state_dirty = false;
+                since = 0;
+            }
+        }
+        // Come back for the next frame (a busy endpoint wakes us on completion)
+        if (since < SWITCH_PRO_REPORT_INTERVAL_US) {
+            platform_loop_wake_in((SWITCH_PRO_REPORT_INTERVAL_US - since + 999) / 1000);
+        }
+    } else if (pro_state_dirty) {
+        // Simple-HID / unset mode: the genuine controller only sends on change.
+        // Reuse the full layout (report 0x30) with IMU zeroed.
+        if (send_full_report()) {
+            pro_last_report_us = now;
+            pro_state_dirty = false;
+        }
+    }
+}
+
+static void switch_pro_mode_handle_output(uint8_t report_id, const uint8_t* data, uint16_t len)
+{
+    // Interrupt OUT delivers report_id=0 with the real ID in data[0];
+    // control SET_REPORT delivers the ID separately. Normalize to the latter.
+    if (report_id == 0) {
+        if (len == 0) return;
+        report_id = data[0];
+        data++;
+        len--;
+    }
+
+    switch (report_id) {
+        case SWITCH_PRO_OUT_USB_CMD:
+            if (len >= 1) handle_usb_command(data[0]);
+            break;
+
+        case SWITCH_PRO_OUT_RUMBLE_SUBCMD:
+            // [0]=counter [1..8]=rumble [9]=subcmd [10..]=args
+            if (len >= 9) handle_rumble(&data[1]);
+            if (len >= 10) handle_subcommand(data[9], &data[10], (uint16_t)(len - 10));
+            break;
+
+        case SWITCH_PRO_OUT_RUMBLE_ONLY:
+            if (len >= 9) handle_rumble(&data[1]);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static uint8_t switch_pro_mode_get_rumble(void)
+{
+    return pro_rumble_left > pro_rumble_right ? pro_rumble_left : pro_rumble_right;
+}
+
+static bool switch_pro_mode_get_feedback(output_feedback_t* fb)
+{
+    fb->rumble_left = pro_rumble_left;
+    fb->rumble_right = pro_rumble_right;
+
+    // Player lights: low nibble = solid LEDs. Count them like the console
+    // does (1 LED = P1, 2 = P2, ...); 0 = not set.
+    uint8_t leds = pro_player_leds & 0x0F;
+    uint8_t player = 0;
+    while (leds) {
+        player += leds & 1;
+        leds >>= 1;
+    }
+    fb->led_player = player;
+    fb->dirty = pro_feedback_dirty;
+    pro_feedback_dirty = false;
+    return true;
+}
+
+static const uint8_t* switch_pro_mode_get_device_descriptor(void)
+{
+    return (const uint8_t*)&switch_pro_device_descriptor;
+}
+
+static const uint8_t* switch_pro_mode_get_config_descriptor(void)
+{
+    return switch_pro_config_descriptor;
+}
+
+static const uint8_t* switch_pro_mode_get_report_descriptor(void)
+{
+    return switch_pro_report_descriptor;
+}
+
+// IMU samples that never made it into a report since the last init
+uint32_t switch_pro_mode_get_imu_dropped(void)
+{
+    return pro_imu_dropped;
+}
+
+// ============================================================================
+// MODE EXPORT
+// ============================================================================
+
+const usbd_mode_t switch_pro_mode = {
+    .name = "Switch Pro",
+    .mode = USB_OUTPUT_MODE_SWITCH_PRO,
+
+    .get_device_descriptor = switch_pro_mode_get_device_descriptor,
+    .get_config_descriptor = switch_pro_mode_get_config_descriptor,
+    .get_report_descriptor = switch_pro_mode_get_report_descriptor,
+
+    .init = switch_pro_mode_init,
+    .send_report = switch_pro_mode_send_report,
+    .is_ready = switch_pro_mode_is_ready,
+
+    .handle_output = switch_pro_mode_handle_output,
+    .get_rumble = switch_pro_mode_get_rumble,
+    .get_feedback = switch_pro_mode_get_feedback,
+    .get_report = NULL,
+    .get_class_driver = NULL,  // Uses built-in HID class driver
+    .task = switch_pro_mode_task,
+    .on_input = switch_pro_mode_on_input,
+};
@@ -88,7 +88,7 @@ static bool xac_mode_send_report(uint8_t player_index,
     xac_report.buttons_lo = xac_buttons & 0x0F;
     xac_report.buttons_hi = (xac_buttons >> 4) & 0xFF;
 
-    return tud_hid_report(0, &xac_report, sizeof(xac_report));
+    return usbd_report_send(0, 0, &xac_report, sizeof(xac_report));
 }
 
 static const uint8_t* xac_mode_get_device_descriptor(void)
@@ -121,6 +121,7 @@ const usbd_mode_t xac_mode = {
     .init = xac_mode_init,
     .send_report = xac_mode_send_report,
     .is_ready = xac_mode_is_ready,
+    .repeat_policy = USBD_REPEAT_HID_IDLE,
 
     // XAC mode has no rumble or feedback
     .handle_output = NULL,
@@ -14,9 +14,18 @@
 // STATE
 // ============================================================================
 
-static xbox_og_in_report_t xid_report;
-static xbox_og_out_report_t xid_rumble;
-static bool xid_rumble_available = false;
+// Per-port state. The single-port mode only uses port 0; the four-port mode
+// maps router player N to XID interface N. Each port keeps its own prebuilt
+// 20-byte report and the last rumble the console sent it.
+#if CFG_TUD_XID_PORTS >= XBOX_OG_4P_PORTS
+#define XID_MODE_PORTS  XBOX_OG_4P_PORTS
+#else
+#define XID_MODE_PORTS  1
+#endif
+
+static xbox_og_in_report_t xid_report[XID_MODE_PORTS];
+static xbox_og_out_report_t xid_rumble[XID_MODE_PORTS];
+static uint8_t xid_port_count = 1;
 
 // ============================================================================
 // CONVERSION HELPERS
@@ -63,14 +72,22 @@ static int16_t convert_axis_to_s16_inv(uint8_t value)
 // MODE INTERFACE IMPLEMENTATION
 // ============================================================================
 
+static void xid_mode_reset_ports(uint8_t count)
+{
+    xid_port_count = count;
+
+    // Initialize XID reports to neutral state
+    memset(xid_report, 0, sizeof(xid_report));
+    for (uint8_t i = 0; i < XID_MODE_PORTS; i++) {
+        xid_report[i].reserved1 = 0x00;
+        xid_report[i].report_len = sizeof(xbox_og_in_report_t);
+    }
+    memset(xid_rumble, 0, sizeof(xid_rumble));
+}
+
 static void xid_mode_init(void)
 {
-    // Initialize XID report to neutral state
-    memset(&xid_report, 0, sizeof(xbox_og_in_report_t));
-    xid_report.reserved1 = 0x00;
-    xid_report.report_len = sizeof(xbox_og_in_report_t);
-    memset(&xid_rumble, 0, sizeof(xbox_og_out_report_t));
-    xid_rumble_available = false;
+    xid_mode_reset_ports(1);
 }
 
 static bool xid_mode_is_ready(void)
@@ -83,11 +100,13 @@ static bool xid_mode_send_report(uint8_t player_index,
                                   const profile_output_t* profile_out,
                                   uint32_t buttons)
 {
-    (void)player_index;
     (void)event;
 
+    if (player_index >= xid_port_count) return false;
+    xbox_og_in_report_t* report = &xid_report[player_index];
+
     // Digital buttons (DPAD, Start, Back, L3, R3)
-    xid_report.buttons = convert_xid_digital_buttons(buttons);
+    report->buttons = convert_xid_digital_buttons(buttons);
 
     // Analog face + black/white buttons (0 = released, 255 = fully pressed).
     // The Duke reports all six as 8-bit pressure; the console derives the
@@ -97,62 +116,70 @@ static bool xid_mode_send_report(uint8_t player_index,
     // up,right,down,left,L2,R2,L1,R1,triangle,circle,cross,square.
     // White=L1, Black=R1 matches the codebase convention in xinput.c.
     if (profile_out->has_pressure) {
-        xid_report.a     = profile_out->pressure[10];  // cross   (B1)
-        xid_report.b     = profile_out->pressure[9];   // circle  (B2)
-        xid_report.x     = profile_out->pressure[11];  // square  (B3)
-        xid_report.y     = profile_out->pressure[8];   // triangle(B4)
-        xid_report.white = profile_out->pressure[6];   // L1
-        xid_report.black = profile_out->pressure[7];   // R1
+        report->a     = profile_out->pressure[10];  // cross   (B1)
+        report->b     = profile_out->pressure[9];   // circle  (B2)
+        report->x     = profile_out->pressure[11];  // square  (B3)
+        report->y     = profile_out->pressure[8];   // triangle(B4)
+        report->white = profile_out->pressure[6];   // L1
+        report->black = profile_out->pressure[7];   // R1
     } else {
-        xid_report.a     = (buttons & JP_BUTTON_B1) ? 0xFF : 0x00;
-        xid_report.b     = (buttons & JP_BUTTON_B2) ? 0xFF : 0x00;
-        xid_report.x     = (buttons & JP_BUTTON_B3) ? 0xFF : 0x00;
-        xid_report.y     = (buttons & JP_BUTTON_B4) ? 0xFF : 0x00;
-        xid_report.white = (buttons & JP_BUTTON_L1) ? 0xFF : 0x00;  // L1 -> White
-        xid_report.black = (buttons & JP_BUTTON_R1) ? 0xFF : 0x00;  // R1 -> Black
+        report->a     = (buttons & JP_BUTTON_B1) ? 0xFF : 0x00;
+        report->b     = (buttons & JP_BUTTON_B2) ? 0xFF : 0x00;
+        report->x     = (buttons & JP_BUTTON_B3) ? 0xFF : 0x00;
+        report->y     = (buttons & JP_BUTTON_B4) ? 0xFF : 0x00;
+        report->white = (buttons & JP_BUTTON_L1) ? 0xFF : 0x00;  // L1 -> White
+        report->black = (buttons & JP_BUTTON_R1) ? 0xFF : 0x00;  // R1 -> Black
     }
 
     // Analog triggers (0-255)
     // Use profile analog values, fall back to digital if analog is 0 but button pressed
-    xid_report.trigger_l = profile_out->l2_analog;
-    xid_report.trigger_r = profile_out->r2_analog;
-    if (xid_report.trigger_l == 0 && (buttons & JP_BUTTON_L2)) xid_report.trigger_l = 0xFF;
-    if (xid_report.trigger_r == 0 && (buttons & JP_BUTTON_R2)) xid_report.trigger_r = 0xFF;
+    report->trigger_l = profile_out->l2_analog;
+    report->trigger_r = profile_out->r2_analog;
+    if (report->trigger_l == 0 && (buttons & JP_BUTTON_L2)) report->trigger_l = 0xFF;
+    if (report->trigger_r == 0 && (buttons & JP_BUTTON_R2)) report->trigger_r = 0xFF;
 
     // Analog sticks (signed 16-bit, -32768 to +32767)
-    xid_report.stick_lx = convert_axis_to_s16(profile_out->left_x);
-    xid_report.stick_ly = convert_axis_to_s16_inv(profile_out->left_y);
-    xid_report.stick_rx = convert_axis_to_s16(profile_out->right_x);
-    xid_report.stick_ry = convert_axis_to_s16_inv(profile_out->right_y);
+    report->stick_lx = convert_axis_to_s16(profile_out->left_x);
+    report->stick_ly = convert_axis_to_s16_inv(profile_out->left_y);
+    report->stick_rx = convert_axis_to_s16(profile_out->right_x);
+    report->stick_ry = convert_axis_to_s16_inv(profile_out->right_y);
 
-    return tud_xid_send_report(&xid_report);
+    return tud_xid_n_send_report(player_index, report);
 }
 
 static void xid_mode_task(void)
 {
-    // Check for rumble updates
-    if (tud_xid_get_rumble(&xid_rumble)) {
-        xid_rumble_available = true;
+    // Latch rumble updates per port (arrive on the OUT endpoint or via
+    // SET_REPORT on the control pipe)
+    for (uint8_t port = 0; port < xid_port_count; port++) {
+        tud_xid_n_get_rumble(port, &xid_rumble[port]);
     }
 }
 
 static uint8_t xid_mode_get_rumble(void)
 {
     // Xbox OG has two 16-bit motors - combine to single 8-bit value
-    uint16_t max_rumble = (xid_rumble.rumble_l > xid_rumble.rumble_r)
-                          ? xid_rumble.rumble_l : xid_rumble.rumble_r;
+    uint16_t max_rumble = (xid_rumble[0].rumble_l > xid_rumble[0].rumble_r)
+                          ? xid_rumble[0].rumble_l : xid_rumble[0].rumble_r;
     return (uint8_t)(max_rumble >> 8);  // Scale 0-65535 to 0-255
 }
 
-static bool xid_mode_get_feedback(output_feedback_t* fb)
+bool xid_mode_get_port_feedback(uint8_t port, output_feedback_t* fb)
 {
+    if (port >= xid_port_count) return false;
+
     // Xbox OG has two 16-bit motors
-    fb->rumble_left = (uint8_t)(xid_rumble.rumble_l >> 8);
-    fb->rumble_right = (uint8_t)(xid_rumble.rumble_r >> 8);
+    fb->rumble_left = (uint8_t)(xid_rumble[port].rumble_l >> 8);
+    fb->rumble_right = (uint8_t)(xid_rumble[port].rumble_r >> 8);
     fb->dirty = true;
     return true;
 }
 
+static bool xid_mode_get_feedback(output_feedback_t* fb)
+{
+    return xid_mode_get_port_feedback(0, fb);
+}
+
 static const usbd_class_driver_t* xid_mode_get_class_driver(void)
 {
     return tud_xid_class_driver();
@@ -168,6 +195,27 @@ static const uint8_t* xid_mode_get_config_descriptor(void)
     return xbox_og_config_descriptor;
 }
 
+#if XID_MODE_PORTS > 1
+static void xid_4p_mode_init(void)
+{
+    xid_mode_reset_ports(XBOX_OG_4P_PORTS);
+}
+
+static bool xid_4p_mode_is_ready(void)
+{
+    // usbd_task checks each port's own endpoint before sending to it
+    for (uint8_t port = 0; port < xid_port_count; port++) {
+        if (tud_xid_n_ready(port)) return true;
+    }
+    return false;
+}
+
+static const uint8_t* xid_4p_mode_get_config_descriptor(void)
+{
+    return xbox_og_4p_config_descriptor;
+}
+#endif
+
 // ============================================================================
 // MODE EXPORT
 // ============================================================================
@@ -193,3 +241,28 @@ const usbd_mode_t xid_mode = {
     .get_class_driver = xid_mode_get_class_driver,
     .task = xid_mode_task,
 };
+
+#if XID_MODE_PORTS > 1
+// Four controller ports on one device (one XID interface each)
+const usbd_mode_t xid_4p_mode = {
+    .name = "Xbox OG 4-Port",
+    .mode = USB_OUTPUT_MODE_XBOX_ORIGINAL_4P,
+
+    .get_device_descriptor = xid_mode_get_device_descriptor,
+    .get_config_descriptor = xid_4p_mode_get_config_descriptor,
+    .get_report_descriptor = NULL,  // XID is not HID-based
+
+    .init = xid_4p_mode_init,
+    .send_report = xid_mode_send_report,
+    .is_ready = xid_4p_mode_is_ready,
+
+    // Feedback support (port 0 here; other ports via xid_mode_get_port_feedback)
+    .handle_output = NULL,
+    .get_rumble = xid_mode_get_rumble,
+    .get_feedback = xid_mode_get_feedback,
+    .get_report = NULL,
+
+    .get_class_driver = xid_mode_get_class_driver,
+    .task = xid_mode_task,
+};
+#endif
@@ -167,6 +167,8 @@ const usbd_mode_t xinput_mode = {
     .init = xinput_mode_init,
     .send_report = xinput_mode_send_report,
     .is_ready = xinput_mode_is_ready,
+    // Xbox 360 and XInput hosts expect continuous reports
+    .repeat_policy = USBD_REPEAT_EVERY_EVENT,
 
     .handle_output = NULL,  // Output handled via tud_xinput_get_output
     .get_rumble = xinput_mode_get_rumble,
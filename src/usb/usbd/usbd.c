@@ -23,6 +23,7 @@
 #include "descriptors/xbox_og_descriptors.h"
 #include "descriptors/xinput_descriptors.h"
 #include "descriptors/switch_descriptors.h"
+#include "descriptors/switch_pro_descriptors.h"
 #include "descriptors/ps3_descriptors.h"
 #include "descriptors/psclassic_descriptors.h"
 #include "descriptors/ps4_descriptors.h"
@@ -124,6 +125,8 @@ static const char* mode_names[] = {
     [USB_OUTPUT_MODE_PCEMINI] = "PCE Mini",
     [USB_OUTPUT_MODE_CDC] = "CDC Config",
     [USB_OUTPUT_MODE_GBA_LINK] = "GBA Link (Dolphin)",
+    [USB_OUTPUT_MODE_SWITCH_PRO] = "Switch Pro",
+    [USB_OUTPUT_MODE_XBOX_ORIGINAL_4P] = "Xbox OG 4-Port",
 };
 
 // ============================================================================
@@ -145,10 +148,14 @@ void usbd_register_modes(void)
     usbd_modes[USB_OUTPUT_MODE_XINPUT] = &xinput_mode;
 #endif
     usbd_modes[USB_OUTPUT_MODE_SWITCH] = &switch_mode;
+    usbd_modes[USB_OUTPUT_MODE_SWITCH_PRO] = &switch_pro_mode;
     usbd_modes[USB_OUTPUT_MODE_PS3] = &ps3_mode;
     usbd_modes[USB_OUTPUT_MODE_PSCLASSIC] = &psclassic_mode;
     usbd_modes[USB_OUTPUT_MODE_PS4] = &ps4_mode;
     usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL] = &xid_mode;
+#if CFG_TUD_XID_PORTS >= XBOX_OG_4P_PORTS
+    usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL_4P] = &xid_4p_mode;
+#endif
     usbd_modes[USB_OUTPUT_MODE_XBONE] = &xbone_mode;
     usbd_modes[USB_OUTPUT_MODE_XAC] = &xac_mode;
     usbd_modes[USB_OUTPUT_MODE_KEYBOARD_MOUSE] = &kbmouse_mode;
@@ -166,6 +173,136 @@ const usbd_mode_t* usbd_get_current_mode(void)
     return current_mode;
 }
 
+// ============================================================================
+// REPORT REPEAT POLICY
+// ============================================================================
+
+// One change-detection gate per (interface, report ID) a mode sends on.
+// Gates are claimed on first use and released on enumeration/mode switch.
+#define USBD_REPORT_GATES   4
+#define USBD_REPORT_ITFS    4
+
+typedef struct {
+    bool used;
+    uint8_t itf;
+    uint8_t report_id;
+    usbd_report_gate_t gate;
+} usbd_report_slot_t;
+
+static usbd_report_slot_t report_slots[USBD_REPORT_GATES];
+static uint8_t hid_idle_rate[USBD_REPORT_ITFS];  // Last SET_IDLE per interface
+
+static usbd_repeat_policy_t usbd_repeat_policy(void)
+{
+    return current_mode ? current_mode->repeat_policy : USBD_REPEAT_EVERY_EVENT;
+}
+
+static void usbd_report_slots_reset(void)
+{
+    memset(report_slots, 0, sizeof(report_slots));
+}
+
+static usbd_report_gate_t* usbd_report_gate_for(uint8_t itf, uint8_t report_id)
+{
+    usbd_report_slot_t* free_slot = NULL;
+    for (uint8_t i = 0; i < USBD_REPORT_GATES; i++) {
+        usbd_report_slot_t* slot = &report_slots[i];
+        if (slot->used && slot->itf == itf && slot->report_id == report_id) {
+            return &slot->gate;
+        }
+        if (!slot->used && !free_slot) free_slot = slot;
+    }
+    if (!free_slot) return NULL;  // Out of gates: send ungated
+
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->used = true;
+    free_slot->itf = itf;
+    free_slot->report_id = report_id;
+    free_slot->gate.idle_rate = (itf < USBD_REPORT_ITFS) ? hid_idle_rate[itf] : 0;
+    return &free_slot->gate;
+}
+
+bool usbd_report_send(uint8_t itf, uint8_t report_id, const void* report, uint16_t len)
+{
+    usbd_repeat_policy_t policy = usbd_repeat_policy();
+    if (policy == USBD_REPEAT_EVERY_EVENT) {
+        return tud_hid_n_report(itf, report_id, report, len);
+    }
+
+    usbd_report_gate_t* gate = usbd_report_gate_for(itf, report_id);
+    uint32_t now = platform_time_ms();
+    if (gate && !usbd_report_gate_check(gate, policy, report, len, now)) {
+        return false;
+    }
+    if (!tud_hid_n_report(itf, report_id, report, len)) {
+        return false;
+    }
+    if (gate) usbd_report_gate_commit(gate, report, len, now);
+    return true;
+}
+
+// Repeat the last report on any interface whose SET_IDLE period expired
+// without a change. Runs every usbd_task pass; a no-op unless the current
+// mode uses USBD_REPEAT_HID_IDLE and the host set a non-zero idle rate.
+// Asks the loop back for the next repeat; one that is due but waiting on a
+// busy endpoint is retried when the endpoint's completion wakes the loop.
+static void usbd_report_idle_task(void)
+{
+    usbd_repeat_policy_t policy = usbd_repeat_policy();
+    if (policy != USBD_REPEAT_HID_IDLE) return;
+
+    uint32_t now = platform_time_ms();
+    for (uint8_t i = 0; i < USBD_REPORT_GATES; i++) {
+        usbd_report_slot_t* slot = &report_slots[i];
+        if (!slot->used) continue;
+        if (usbd_report_gate_idle_due(&slot->gate, policy, now) &&
+            tud_hid_n_ready(slot->itf) &&
+            tud_hid_n_report(slot->itf, slot->report_id, slot->gate.last, slot->gate.len)) {
+            usbd_report_gate_repeated(&slot->gate, now);
+        }
+        uint32_t in_ms = usbd_report_gate_idle_in_ms(&slot->gate, policy, now);
+        if (in_ms != 0 && in_ms != UINT32_MAX) platform_loop_wake_in(in_ms);
+    }
+}
+
+void usbd_get_report_stats(uint32_t* sent, uint32_t* suppressed, uint32_t* repeated)
+{
+    uint32_t s = 0, x = 0, r = 0;
+    for (uint8_t i = 0; i < USBD_REPORT_GATES; i++) {
+        if (!report_slots[i].used) continue;
+        s += report_slots[i].gate.sent;
+        x += report_slots[i].gate.suppressed;
+        r += report_slots[i].gate.repeated;
+    }
+    if (sent) *sent = s;
+    if (suppressed) *suppressed = x;
+    if (repeated) *repeated = r;
+}
+
+// HID SET_IDLE (TinyUSB stores the rate per interface and answers GET_IDLE
+// itself). Report ID 0 in the request means "all reports", which is what
+// hosts send in practice, so the rate applies to every gate on the interface.
+bool tud_hid_set_idle_cb(uint8_t instance, uint8_t idle_rate)
+{
+    if (instance < USBD_REPORT_ITFS) {
+        hid_idle_rate[instance] = idle_rate;
+    }
+    for (uint8_t i = 0; i < USBD_REPORT_GATES; i++) {
+        if (report_slots[i].used && report_slots[i].itf == instance) {
+            report_slots[i].gate.idle_rate = idle_rate;
+        }
+    }
+    return true;
+}
+
+// New enumeration: the host has no report state yet, and the bus reset
+// cleared its idle rates back to 0 (indefinite)
+void tud_mount_cb(void)
+{
+    memset(hid_idle_rate, 0, sizeof(hid_idle_rate));
+    usbd_report_slots_reset();
+}
+
 // ============================================================================
 // PROFILE PROCESSING
 // ============================================================================
@@ -356,10 +493,14 @@ bool usbd_set_mode(usb_output_mode_t mode)
     if (mode != USB_OUTPUT_MODE_SINPUT &&
         mode != USB_OUTPUT_MODE_HID &&
         mode != USB_OUTPUT_MODE_XBOX_ORIGINAL &&
+#if CFG_TUD_XID_PORTS >= XBOX_OG_4P_PORTS
+        mode != USB_OUTPUT_MODE_XBOX_ORIGINAL_4P &&
+#endif
         mode != USB_OUTPUT_MODE_XINPUT &&
         mode != USB_OUTPUT_MODE_PS3 &&
         mode != USB_OUTPUT_MODE_PS4 &&
         mode != USB_OUTPUT_MODE_SWITCH &&
+        mode != USB_OUTPUT_MODE_SWITCH_PRO &&
         mode != USB_OUTPUT_MODE_PSCLASSIC &&
         mode != USB_OUTPUT_MODE_XBONE &&
         mode != USB_OUTPUT_MODE_XAC &&
@@ -405,6 +546,7 @@ bool usbd_set_mode(usb_output_mode_t mode)
             new_mode->init();
         }
         current_mode = new_mode;
+        usbd_report_slots_reset();
 
         printf("[usbd] Fast switch complete: %s\n", mode_names[mode]);
         return true;
@@ -447,6 +589,7 @@ void usbd_get_mode_color(usb_output_mode_t mode, uint8_t *r, uint8_t *g, uint8_t
     switch (mode) {
         case USB_OUTPUT_MODE_XINPUT:
         case USB_OUTPUT_MODE_XBOX_ORIGINAL:
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL_4P:
         case USB_OUTPUT_MODE_XBONE:
         case USB_OUTPUT_MODE_XAC:
             *r = 0; *g = 64; *b = 0; break;     // green
@@ -456,6 +599,7 @@ void usbd_get_mode_color(usb_output_mode_t mode, uint8_t *r, uint8_t *g, uint8_t
         case USB_OUTPUT_MODE_PS4:
             *r = 0; *g = 0; *b = 80; break;      // bright blue
         case USB_OUTPUT_MODE_SWITCH:
+        case USB_OUTPUT_MODE_SWITCH_PRO:
             *r = 64; *g = 0; *b = 0; break;      // red
         case USB_OUTPUT_MODE_KEYBOARD_MOUSE:
             *r = 64; *g = 64; *b = 0; break;     // yellow
@@ -532,11 +676,26 @@ static void usbd_on_input(output_target_t output, uint8_t player_index, const in
         profile_check_switch_combo(event->buttons);
     }
 
+    // Per-event mode hook (sees every sample before coalescing)
+    if (current_mode && current_mode->on_input) {
+        current_mode->on_input(player_index, event);
+    }
+
     // Queue the event for sending when USB is ready
     pending_events[player_index] = *event;
     pending_flags[player_index] = true;
 }
 
+// Consume a player's queued event for the report being built. Gyro aim drains
+// here, at report time, so rotation that arrived across several coalesced
+// events all reaches the host.
+static const input_event_t* usbd_take_pending(uint8_t player_index)
+{
+    pending_flags[player_index] = false;
+    router_gyro_aim_apply(OUTPUT_TARGET_USB_DEVICE, player_index, &pending_events[player_index]);
+    return &pending_events[player_index];
+}
+
 // ============================================================================
 // PUBLIC API
 // ============================================================================
@@ -586,10 +745,14 @@ void usbd_init(void)
             // Only accept supported modes
             if (settings->usb_output_mode == USB_OUTPUT_MODE_SINPUT ||
                 settings->usb_output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL ||
+#if CFG_TUD_XID_PORTS >= XBOX_OG_4P_PORTS
+                settings->usb_output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL_4P ||
+#endif
                 settings->usb_output_mode == USB_OUTPUT_MODE_XINPUT ||
                 settings->usb_output_mode == USB_OUTPUT_MODE_PS3 ||
                 settings->usb_output_mode == USB_OUTPUT_MODE_PS4 ||
                 settings->usb_output_mode == USB_OUTPUT_MODE_SWITCH ||
+                settings->usb_output_mode == USB_OUTPUT_MODE_SWITCH_PRO ||
                 settings->usb_output_mode == USB_OUTPUT_MODE_PSCLASSIC ||
                 settings->usb_output_mode == USB_OUTPUT_MODE_XBONE ||
                 settings->usb_output_mode == USB_OUTPUT_MODE_XAC ||
@@ -634,7 +797,8 @@ void usbd_init(void)
     // Initialize TinyUSB device stack
     tusb_rhport_init_t dev_init = {
         .role = TUSB_ROLE_DEVICE,
-        .speed = (output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL)
+        .speed = (output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL ||
+                  output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL_4P)
                  ? TUSB_SPEED_FULL  // Xbox OG is USB 1.1
                  : TUSB_SPEED_AUTO
     };
@@ -649,6 +813,13 @@ void usbd_init(void)
             }
             break;
 
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL_4P:
+            // XID 4-Port mode: delegate to mode interface
+            if (usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL_4P] && usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL_4P]->init) {
+                usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL_4P]->init();
+            }
+            break;
+
         case USB_OUTPUT_MODE_XINPUT:
             // XInput mode: delegate to mode interface
             if (usbd_modes[USB_OUTPUT_MODE_XINPUT] && usbd_modes[USB_OUTPUT_MODE_XINPUT]->init) {
@@ -663,6 +834,13 @@ void usbd_init(void)
             }
             break;
 
+        case USB_OUTPUT_MODE_SWITCH_PRO:
+            // Switch Pro mode: delegate to mode interface
+            if (usbd_modes[USB_OUTPUT_MODE_SWITCH_PRO] && usbd_modes[USB_OUTPUT_MODE_SWITCH_PRO]->init) {
+                usbd_modes[USB_OUTPUT_MODE_SWITCH_PRO]->init();
+            }
+            break;
+
         case USB_OUTPUT_MODE_PS3:
             // PS3 mode: delegate to mode interface
             if (usbd_modes[USB_OUTPUT_MODE_PS3] && usbd_modes[USB_OUTPUT_MODE_PS3]->init) {
@@ -771,9 +949,10 @@ void usbd_task(void)
 {
     // TinyUSB device task - runs from core0 main loop
     // On ESP32 (FreeRTOS), tud_task() blocks forever (UINT32_MAX timeout).
-    // Use tud_task_ext with short timeout so the main loop keeps running.
+    // Don't block at all: the I/O task already sleeps on its own event
+    // notification, which tud_event_hook_cb() signals for every USB event.
 #ifdef PLATFORM_ESP32
-    tud_task_ext(1, false);
+    tud_task_ext(0, false);
 #else
     tud_task();
 #endif
@@ -791,6 +970,22 @@ void usbd_task(void)
             break;
         }
 
+#if CFG_TUD_XID_PORTS >= XBOX_OG_4P_PORTS
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL_4P: {
+            // XID 4-Port mode: one router player per XID interface. Each port
+            // sends as soon as its own IN endpoint completes, so a port the
+            // console polls slowly never holds up the others.
+            const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL_4P];
+            if (mode) {
+                if (mode->task) mode->task();
+                for (uint8_t port = 0; port < XBOX_OG_4P_PORTS; port++) {
+                    usbd_send_report(port);
+                }
+            }
+            break;
+        }
+#endif
+
 #if CFG_TUD_XINPUT
         case USB_OUTPUT_MODE_XINPUT: {
             // XInput mode: delegate to mode interface
@@ -815,6 +1010,18 @@ void usbd_task(void)
             break;
         }
 
+        case USB_OUTPUT_MODE_SWITCH_PRO: {
+            // Switch Pro mode: cache latest state, then let the mode task
+            // stream 0x30 reports at the native 8 ms cadence (no CDC —
+            // authentic Pro Controller)
+            const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_SWITCH_PRO];
+            if (mode) {
+                usbd_send_report(0);
+                if (mode->task) mode->task();
+            }
+            break;
+        }
+
         case USB_OUTPUT_MODE_PS3: {
             // PS3 mode: delegate to mode interface (no CDC — authentic DS3)
             const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_PS3];
@@ -941,6 +1148,8 @@ void usbd_task(void)
             break;
         }
     }
+
+    usbd_report_idle_task();
 }
 
 // Send XID report - delegates to mode interface
@@ -955,8 +1164,29 @@ static bool usbd_send_xid_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;
+    const input_event_t* event = usbd_take_pending(player_index);
+
+    // Apply profile
+    profile_output_t profile_out;
+    uint32_t processed_buttons = apply_usbd_profile_player(event, &profile_out, player_index);
+
+    return mode->send_report(player_index, event, &profile_out, processed_buttons);
+}
+
+#if CFG_TUD_XID_PORTS >= XBOX_OG_4P_PORTS
+// Send XID 4-Port report - readiness is per port, not per device
+static bool usbd_send_xid_4p_report(uint8_t player_index)
+{
+    const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL_4P];
+    if (!mode || !mode->send_report) return false;
+
+    // Leave the event pending until this port's endpoint is free
+    if (player_index >= USB_MAX_PLAYERS || !pending_flags[player_index] ||
+        !tud_xid_n_ready(player_index)) {
+        return false;
+    }
+
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile
     profile_output_t profile_out;
@@ -964,6 +1194,7 @@ static bool usbd_send_xid_report(uint8_t player_index)
 
     return mode->send_report(player_index, event, &profile_out, processed_buttons);
 }
+#endif
 
 // Send HID report (DInput mode) - uses mode interface
 static bool usbd_send_hid_report(uint8_t player_index)
@@ -984,8 +1215,7 @@ static bool usbd_send_hid_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;  // Clear after consumption
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
@@ -1014,8 +1244,7 @@ static bool usbd_send_sinput_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;  // Clear after consumption
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
@@ -1045,8 +1274,7 @@ static bool usbd_send_xinput_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;  // Clear after consumption
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
@@ -1076,8 +1304,7 @@ static bool usbd_send_switch_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;  // Clear after consumption
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
@@ -1087,6 +1314,29 @@ static bool usbd_send_switch_report(uint8_t player_index)
     return mode->send_report(player_index, event, &profile_out, processed_buttons);
 }
 
+// Send Switch Pro report - uses mode interface. Only caches state; the mode
+// task owns transmission timing.
+static bool usbd_send_switch_pro_report(uint8_t player_index)
+{
+    const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_SWITCH_PRO];
+    if (!mode || !mode->send_report) {
+        return false;
+    }
+
+    // Check for pending event (event-driven from tap callback)
+    if (player_index >= USB_MAX_PLAYERS || !pending_flags[player_index]) {
+        return false;
+    }
+
+    const input_event_t* event = usbd_take_pending(player_index);
+
+    // Apply profile (combos, button remaps)
+    profile_output_t profile_out;
+    uint32_t processed_buttons = apply_usbd_profile_player(event, &profile_out, player_index);
+
+    return mode->send_report(player_index, event, &profile_out, processed_buttons);
+}
+
 // Send PS3 report (PlayStation 3 DualShock 3 mode) - uses mode interface
 static bool usbd_send_ps3_report(uint8_t player_index)
 {
@@ -1106,8 +1356,7 @@ static bool usbd_send_ps3_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;  // Clear after consumption
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
@@ -1136,8 +1385,7 @@ static bool usbd_send_psclassic_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;  // Clear after consumption
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
@@ -1159,8 +1407,7 @@ static bool usbd_send_pcemini_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile
     profile_output_t profile_out;
@@ -1181,8 +1428,7 @@ static bool usbd_send_ps4_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile
     profile_output_t profile_out;
@@ -1203,8 +1449,7 @@ static bool usbd_send_xbone_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile
     profile_output_t profile_out;
@@ -1225,8 +1470,7 @@ static bool usbd_send_xac_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile
     profile_output_t profile_out;
@@ -1242,20 +1486,25 @@ static bool usbd_send_kbmouse_report(uint8_t player_index)
     if (!mode || !mode->send_report) return false;
     if (mode->is_ready && !mode->is_ready()) return false;
 
-    // Check for pending event
-    if (player_index >= USB_MAX_PLAYERS || !pending_flags[player_index]) {
+    if (player_index >= USB_MAX_PLAYERS) return false;
+
+    // Check for pending event (or a latched button edge still to report).
+    // A frame the host hasn't fully received goes out again first.
+    if ((!pending_flags[player_index] && !kbmouse_mode_has_latched_buttons()) ||
+        kbmouse_mode_frame_unsent()) {
         // No new input, but still send mouse report for continuous movement
         return kbmouse_mode_send_idle_mouse();
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;
+    // Fold in button edges that event coalescing dropped since the last frame
+    input_event_t event = *usbd_take_pending(player_index);
+    event.buttons = kbmouse_mode_merge_buttons(event.buttons);
 
     // Apply profile
     profile_output_t profile_out;
-    uint32_t processed_buttons = apply_usbd_profile_player(event, &profile_out, player_index);
+    uint32_t processed_buttons = apply_usbd_profile_player(&event, &profile_out, player_index);
 
-    return mode->send_report(player_index, event, &profile_out, processed_buttons);
+    return mode->send_report(player_index, &event, &profile_out, processed_buttons);
 }
 
 #if CFG_TUD_GC_ADAPTER
@@ -1271,8 +1520,7 @@ static bool usbd_send_gc_adapter_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;
+    const input_event_t* event = usbd_take_pending(player_index);
 
     // Apply profile
     profile_output_t profile_out;
@@ -1289,12 +1537,18 @@ bool usbd_send_report(uint8_t player_index)
             return false;  // CDC-only mode: no HID reports to send
         case USB_OUTPUT_MODE_XBOX_ORIGINAL:
             return usbd_send_xid_report(player_index);
+#if CFG_TUD_XID_PORTS >= XBOX_OG_4P_PORTS
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL_4P:
+            return usbd_send_xid_4p_report(player_index);
+#endif
 #if CFG_TUD_XINPUT
         case USB_OUTPUT_MODE_XINPUT:
             return usbd_send_xinput_report(player_index);
 #endif
         case USB_OUTPUT_MODE_SWITCH:
             return usbd_send_switch_report(player_index);
+        case USB_OUTPUT_MODE_SWITCH_PRO:
+            return usbd_send_switch_pro_report(player_index);
         case USB_OUTPUT_MODE_PS3:
             return usbd_send_ps3_report(player_index);
         case USB_OUTPUT_MODE_PSCLASSIC:
@@ -1326,9 +1580,10 @@ bool usbd_send_report(uint8_t player_index)
 static uint8_t usbd_get_rumble(void)
 {
     switch (output_mode) {
-        case USB_OUTPUT_MODE_XBOX_ORIGINAL: {
-            // XID: delegate to mode interface
-            const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL];
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL:
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL_4P: {
+            // XID: delegate to mode interface (port 0 for 4-Port)
+            const usbd_mode_t* mode = usbd_modes[output_mode];
             if (mode && mode->get_rumble) {
                 return mode->get_rumble();
             }
@@ -1360,6 +1615,14 @@ static uint8_t usbd_get_rumble(void)
             }
             return 0;
         }
+        case USB_OUTPUT_MODE_SWITCH_PRO: {
+            // Switch Pro: delegate to mode interface (HD rumble amplitude)
+            const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_SWITCH_PRO];
+            if (mode && mode->get_rumble) {
+                return mode->get_rumble();
+            }
+            return 0;
+        }
 #if CFG_TUD_GC_ADAPTER
         case USB_OUTPUT_MODE_GC_ADAPTER: {
             // GC Adapter: delegate to mode interface
@@ -1400,9 +1663,10 @@ static bool usbd_get_feedback(output_feedback_t* fb)
     fb->dirty = false;
 
     switch (output_mode) {
-        case USB_OUTPUT_MODE_XBOX_ORIGINAL: {
-            // XID: delegate to mode interface
-            const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL];
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL:
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL_4P: {
+            // XID: delegate to mode interface (port 0 for 4-Port)
+            const usbd_mode_t* mode = usbd_modes[output_mode];
             if (mode && mode->get_feedback) {
                 return mode->get_feedback(fb);
             }
@@ -1438,6 +1702,15 @@ static bool usbd_get_feedback(output_feedback_t* fb)
             return false;
         }
 
+        case USB_OUTPUT_MODE_SWITCH_PRO: {
+            // Switch Pro: delegate to mode interface
+            const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_SWITCH_PRO];
+            if (mode && mode->get_feedback) {
+                return mode->get_feedback(fb);
+            }
+            return false;
+        }
+
 #if CFG_TUD_GC_ADAPTER
         case USB_OUTPUT_MODE_GC_ADAPTER: {
             // GC Adapter: delegate to mode interface
@@ -1463,6 +1736,29 @@ static bool usbd_get_feedback(output_feedback_t* fb)
     }
 }
 
+uint8_t usbd_get_port_count(void)
+{
+#if CFG_TUD_XID_PORTS >= XBOX_OG_4P_PORTS
+    if (output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL_4P) {
+        return XBOX_OG_4P_PORTS;
+    }
+#endif
+    return 1;
+}
+
+bool usbd_get_port_feedback(uint8_t port, output_feedback_t* fb)
+{
+    if (!fb) return false;
+#if CFG_TUD_XID_PORTS >= XBOX_OG_4P_PORTS
+    if (output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL_4P) {
+        fb->led_player = 0;
+        fb->led_r = fb->led_g = fb->led_b = 0;
+        return xid_mode_get_port_feedback(port, fb);
+    }
+#endif
+    return (port == 0) ? usbd_get_feedback(fb) : false;
+}
+
 const OutputInterface usbd_output_interface = {
     .name = "USB",
     .target = OUTPUT_TARGET_USB_DEVICE,
@@ -1604,11 +1900,14 @@ uint8_t const *tud_descriptor_device_cb(void)
         case USB_OUTPUT_MODE_SINPUT:
             return (uint8_t const *)&sinput_device_descriptor;
         case USB_OUTPUT_MODE_XBOX_ORIGINAL:
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL_4P:
             return (uint8_t const *)&xbox_og_device_descriptor;
         case USB_OUTPUT_MODE_XINPUT:
             return (uint8_t const *)&xinput_device_descriptor;
         case USB_OUTPUT_MODE_SWITCH:
             return (uint8_t const *)&switch_device_descriptor;
+        case USB_OUTPUT_MODE_SWITCH_PRO:
+            return (uint8_t const *)&switch_pro_device_descriptor;
         case USB_OUTPUT_MODE_PS3:
             return (uint8_t const *)&ps3_device_descriptor;
         case USB_OUTPUT_MODE_PSCLASSIC:
@@ -1658,6 +1957,11 @@ static const uint8_t desc_frag_sinput_keyboard[] = {
 static const uint8_t desc_frag_sinput_mouse[] = {
     TUD_HID_DESCRIPTOR(ITF_NUM_HID_MOUSE, 0, HID_ITF_PROTOCOL_NONE, sizeof(sinput_mouse_report_descriptor), EPNUM_HID_MOUSE, 8, 1),
 };
+// KB/Mouse mode: same interface and endpoint, NKRO report descriptor, and a
+// boot keyboard so BIOS/UEFI setup screens can use it
+static const uint8_t desc_frag_kbmouse_keyboard[] = {
+    TUD_HID_DESCRIPTOR(ITF_NUM_HID_KEYBOARD, 0, HID_ITF_PROTOCOL_KEYBOARD, sizeof(kbmouse_keyboard_report_descriptor), EPNUM_HID_KEYBOARD, 16, 1),
+};
 #endif
 
 // CDC 0 fragment (data port - always present)
@@ -1689,6 +1993,9 @@ static const uint8_t desc_frag_cdc_only[] = {
 // Runtime-built config descriptor buffers
 static uint8_t runtime_desc_hid[MAX_CONFIG_LEN_HID];
 static uint8_t runtime_desc_sinput[MAX_CONFIG_LEN_SINPUT];
+#ifndef USBD_LEAN_HID_COMPOSITE
+static uint8_t runtime_desc_kbmouse[MAX_CONFIG_LEN_SINPUT];
+#endif
 static uint8_t runtime_desc_cdc[MAX_CONFIG_LEN_CDC];
 
 // Helper: append fragment to buffer, return new offset
@@ -1740,6 +2047,18 @@ static void build_config_descriptors(void)
     };
     memcpy(runtime_desc_sinput, sinput_header, TUD_CONFIG_DESC_LEN);
 
+#ifndef USBD_LEAN_HID_COMPOSITE
+    // --- KB/Mouse mode descriptor ---
+    // SInput's layout with the NKRO keyboard; only the keyboard's report
+    // descriptor length differs
+    off = TUD_CONFIG_DESC_LEN;
+    off = append_fragment(runtime_desc_kbmouse, off, desc_frag_sinput_gamepad, sizeof(desc_frag_sinput_gamepad));
+    off = append_fragment(runtime_desc_kbmouse, off, desc_frag_kbmouse_keyboard, sizeof(desc_frag_kbmouse_keyboard));
+    off = append_fragment(runtime_desc_kbmouse, off, desc_frag_sinput_mouse, sizeof(desc_frag_sinput_mouse));
+    off = append_fragment(runtime_desc_kbmouse, off, desc_frag_cdc0, sizeof(desc_frag_cdc0));
+    memcpy(runtime_desc_kbmouse, sinput_header, TUD_CONFIG_DESC_LEN);
+#endif
+
     // --- CDC-only mode descriptor ---
     // Interfaces: CDC control + CDC data (no HID)
     uint8_t cdc_itf_count = 2;
@@ -1763,10 +2082,14 @@ uint8_t const *tud_descriptor_configuration_cb(uint8_t index)
             return runtime_desc_sinput;
         case USB_OUTPUT_MODE_XBOX_ORIGINAL:
             return xbox_og_config_descriptor;
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL_4P:
+            return xbox_og_4p_config_descriptor;
         case USB_OUTPUT_MODE_XINPUT:
             return xinput_config_descriptor;
         case USB_OUTPUT_MODE_SWITCH:
             return switch_config_descriptor;
+        case USB_OUTPUT_MODE_SWITCH_PRO:
+            return switch_pro_config_descriptor;
         case USB_OUTPUT_MODE_PS3:
             return ps3_config_descriptor;
         case USB_OUTPUT_MODE_PSCLASSIC:
@@ -1780,8 +2103,13 @@ uint8_t const *tud_descriptor_configuration_cb(uint8_t index)
         case USB_OUTPUT_MODE_XAC:
             return xac_config_descriptor;
         case USB_OUTPUT_MODE_KEYBOARD_MOUSE:
-            // Share SInput composite descriptor (same USB device)
+#ifdef USBD_LEAN_HID_COMPOSITE
+            // Lean builds have no keyboard/mouse interfaces to differ
             return runtime_desc_sinput;
+#else
+            // SInput composite layout with the NKRO keyboard interface
+            return runtime_desc_kbmouse;
+#endif
         case USB_OUTPUT_MODE_GC_ADAPTER:
             return gc_adapter_config_descriptor;
 #if CFG_TUD_VENDOR && defined(CONFIG_JOYBUS_BRIDGE)
@@ -1855,7 +2183,8 @@ uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
     (void)langid;
 
     // Xbox OG has no string descriptors
-    if (output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL) {
+    if (output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL ||
+        output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL_4P) {
         return NULL;
     }
 
@@ -1952,6 +2281,8 @@ uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
                 str = XINPUT_MANUFACTURER;
             } else if (output_mode == USB_OUTPUT_MODE_SWITCH) {
                 str = SWITCH_MANUFACTURER;
+            } else if (output_mode == USB_OUTPUT_MODE_SWITCH_PRO) {
+                str = SWITCH_PRO_MANUFACTURER;
             } else if (output_mode == USB_OUTPUT_MODE_PS3) {
                 str = PS3_MANUFACTURER;
             } else if (output_mode == USB_OUTPUT_MODE_PSCLASSIC) {
@@ -1983,6 +2314,8 @@ uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
                 str = XINPUT_PRODUCT;
             } else if (output_mode == USB_OUTPUT_MODE_SWITCH) {
                 str = SWITCH_PRODUCT;
+            } else if (output_mode == USB_OUTPUT_MODE_SWITCH_PRO) {
+                str = SWITCH_PRO_PRODUCT;
             } else if (output_mode == USB_OUTPUT_MODE_PS3) {
                 str = PS3_PRODUCT;
             } else if (output_mode == USB_OUTPUT_MODE_PSCLASSIC) {
@@ -2038,7 +2371,9 @@ uint8_t const *tud_hid_descriptor_report_cb(uint8_t itf)
         output_mode == USB_OUTPUT_MODE_KEYBOARD_MOUSE) {
         switch (itf) {
             case ITF_NUM_HID_GAMEPAD:  return sinput_report_descriptor;
-            case ITF_NUM_HID_KEYBOARD: return sinput_keyboard_report_descriptor;
+            case ITF_NUM_HID_KEYBOARD:
+                return output_mode == USB_OUTPUT_MODE_KEYBOARD_MOUSE ?
+                       kbmouse_keyboard_report_descriptor : sinput_keyboard_report_descriptor;
             case ITF_NUM_HID_MOUSE:    return sinput_mouse_report_descriptor;
             default:                   return sinput_report_descriptor;
         }
@@ -2048,6 +2383,9 @@ uint8_t const *tud_hid_descriptor_report_cb(uint8_t itf)
     if (output_mode == USB_OUTPUT_MODE_SWITCH) {
         return switch_report_descriptor;
     }
+    if (output_mode == USB_OUTPUT_MODE_SWITCH_PRO) {
+        return switch_pro_report_descriptor;
+    }
     if (output_mode == USB_OUTPUT_MODE_PS3) {
         return ps3_report_descriptor;
     }
@@ -2123,6 +2461,16 @@ __attribute__((weak)) void app_on_console_shutdown(void)
 
 void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize)
 {
+    // Switch Pro: rumble/subcommand reports arrive every few ms — route
+    // before the debug log so the console's rumble stream doesn't flood UART
+    if (output_mode == USB_OUTPUT_MODE_SWITCH_PRO) {
+        const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_SWITCH_PRO];
+        if (mode && mode->handle_output) {
+            mode->handle_output(report_id, buffer, bufsize);
+        }
+        return;
+    }
+
     printf("[usbd] set_report_cb: itf=%d report_id=0x%02x type=%d len=%d mode=%d\n",
            itf, report_id, report_type, bufsize, output_mode);
 
@@ -2199,8 +2547,9 @@ void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t rep
 usbd_class_driver_t const* usbd_app_driver_get_cb(uint8_t* driver_count)
 {
     switch (output_mode) {
-        case USB_OUTPUT_MODE_XBOX_ORIGINAL: {
-            const usbd_mode_t* mode = usbd_modes[USB_OUTPUT_MODE_XBOX_ORIGINAL];
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL:
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL_4P: {
+            const usbd_mode_t* mode = usbd_modes[output_mode];
             if (mode && mode->get_class_driver) {
                 *driver_count = 1;
                 return mode->get_class_driver();
@@ -2255,7 +2604,8 @@ bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage,
         return tud_xinput_vendor_control_xfer_cb(rhport, stage, request);
     }
 #if CFG_TUD_XID
-    if (output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL) {
+    if (output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL ||
+        output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL_4P) {
         // TinyUSB short-circuits ALL vendor-type control requests to this
         // callback (device/usbd.c process_control_request), bypassing the class
         // driver. The XID protocol's GET_DESC (0xC1/0x06/wValue=0x4200) and
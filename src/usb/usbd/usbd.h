@@ -33,6 +33,8 @@ typedef enum {
     USB_OUTPUT_MODE_PCEMINI,            // PC Engine Mini (TurboGrafx-16 Mini)
     USB_OUTPUT_MODE_CDC,                // CDC-only (serial config, no HID)
     USB_OUTPUT_MODE_GBA_LINK,           // GBA Link Cable bridge for Dolphin (USB vendor)
+    USB_OUTPUT_MODE_SWITCH_PRO,         // Nintendo Switch Pro Controller (full-rate IMU)
+    USB_OUTPUT_MODE_XBOX_ORIGINAL_4P,   // Original Xbox, four XID ports on one device
     USB_OUTPUT_MODE_COUNT
 } usb_output_mode_t;
 
@@ -155,6 +157,17 @@ void usbd_get_mode_color(usb_output_mode_t mode, uint8_t *r, uint8_t *g, uint8_t
 // Call usbd_set_mode() with result to apply
 usb_output_mode_t usbd_get_next_mode(void);
 
+// Number of controller ports the current mode exposes (4 for Xbox OG
+// 4-Port, 1 otherwise). Apps use it to size router players for the output.
+uint8_t usbd_get_port_count(void);
+
+// Get host feedback (rumble) for one port. Port 0 matches get_feedback().
+bool usbd_get_port_feedback(uint8_t port, output_feedback_t* fb);
+
+// Input report counters since enumeration for modes that use a repeat
+// policy: reports sent, unchanged reports suppressed, SET_IDLE repeats
+void usbd_get_report_stats(uint32_t* sent, uint32_t* suppressed, uint32_t* repeated);
+
 // Reset to default HID mode (for button handlers)
 // Returns true if mode was changed
 bool usbd_reset_to_hid(void);
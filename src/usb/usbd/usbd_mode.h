@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "usbd.h"
+#include "usbd_report.h"
 #include "core/input_event.h"
 #include "core/output_interface.h"
 #include "core/services/profiles/profile.h"
@@ -37,6 +38,10 @@ typedef struct {
     // Ready check - returns true if USB is ready to send
     bool (*is_ready)(void);
 
+    // How input reports repeat (see usbd_report.h). Only applies to reports
+    // sent through usbd_report_send(); default is every event.
+    usbd_repeat_policy_t repeat_policy;
+
     // === Feedback (optional - NULL if not supported) ===
     // Handle output report from host (rumble, LEDs)
     void (*handle_output)(uint8_t report_id, const uint8_t* data, uint16_t len);
@@ -59,6 +64,12 @@ typedef struct {
     // Called periodically from usbd_task()
     void (*task)(void);
 
+    // === Per-event input hook (optional - NULL if not needed) ===
+    // Called from the router tap for every input event, before it is
+    // coalesced into the pending slot. Lets modes keep samples (IMU) that
+    // arrive faster than their report cadence.
+    void (*on_input)(uint8_t player_index, const input_event_t* event);
+
 } usbd_mode_t;
 
 // Mode registry - populated by usbd_register_modes()
@@ -70,6 +81,11 @@ const usbd_mode_t* usbd_get_current_mode(void);
 // Register all modes (called from usbd_init)
 void usbd_register_modes(void);
 
+// Send a HID input report through the current mode's repeat policy.
+// Returns true if the report went on the wire, false if it was unchanged
+// (suppressed) or the endpoint was busy.
+bool usbd_report_send(uint8_t itf, uint8_t report_id, const void* report, uint16_t len);
+
 // ============================================================================
 // MODE DECLARATIONS
 // ============================================================================
@@ -80,6 +96,9 @@ extern const usbd_mode_t sinput_mode;
 extern const usbd_mode_t xinput_mode;
 #endif
 extern const usbd_mode_t switch_mode;
+extern const usbd_mode_t switch_pro_mode;
+// Switch Pro IMU samples dropped since the mode was initialized
+uint32_t switch_pro_mode_get_imu_dropped(void);
 extern const usbd_mode_t ps3_mode;
 // PS3 auth feature report handler (called from tud_hid_set_report_cb)
 void ps3_mode_set_feature_report(uint8_t report_id, const uint8_t* buffer, uint16_t bufsize);
@@ -88,11 +107,22 @@ extern const usbd_mode_t ps4_mode;
 // PS4 auth feature report handler (called from tud_hid_set_report_cb)
 void ps4_mode_set_feature_report(uint8_t report_id, const uint8_t* buffer, uint16_t bufsize);
 extern const usbd_mode_t xid_mode;
+#if CFG_TUD_XID_PORTS >= 4
+// Four-port Xbox OG mode (one XID interface per router player)
+extern const usbd_mode_t xid_4p_mode;
+#endif
+// Per-port XID rumble (port 0 only in single-port mode)
+bool xid_mode_get_port_feedback(uint8_t port, output_feedback_t* fb);
 extern const usbd_mode_t xbone_mode;
 extern const usbd_mode_t xac_mode;
 extern const usbd_mode_t kbmouse_mode;
 // KB/Mouse mode helper for idle mouse reports
 bool kbmouse_mode_send_idle_mouse(void);
+// KB/Mouse per-frame button merging: returns buttons with any press/release
+// edges since the last frame folded in, and consumes them
+uint32_t kbmouse_mode_merge_buttons(uint32_t buttons);
+bool kbmouse_mode_has_latched_buttons(void);
+bool kbmouse_mode_frame_unsent(void);
 extern const usbd_mode_t pcemini_mode;
 #if CFG_TUD_GC_ADAPTER
 extern const usbd_mode_t gc_adapter_mode;
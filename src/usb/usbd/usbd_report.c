@@ -0,0 +1,93 @@
+// usbd_report.c - Report change detection and HID idle policy
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+
+#include "usbd_report.h"
+#include <string.h>
+
+void usbd_report_gate_reset(usbd_report_gate_t* gate)
+{
+    uint8_t idle_rate = gate->idle_rate;
+    memset(gate, 0, sizeof(*gate));
+    gate->idle_rate = idle_rate;
+}
+
+bool usbd_report_gate_same(const usbd_report_gate_t* gate, const void* report, uint16_t len)
+{
+    if (gate->len == 0 || gate->len != len) return false;
+
+    // Packed report structs are usually word aligned in practice; compare a
+    // word at a time and finish the tail bytewise.
+    if (((uintptr_t)report & 3) == 0) {
+        const uint32_t* w = (const uint32_t*)report;
+        uint16_t words = len / 4;
+        for (uint16_t i = 0; i < words; i++) {
+            if (w[i] != gate->last[i]) return false;
+        }
+        uint16_t tail = len & 3;
+        return tail == 0 ||
+               memcmp((const uint8_t*)report + words * 4,
+                      (const uint8_t*)gate->last + words * 4, tail) == 0;
+    }
+    return memcmp(report, gate->last, len) == 0;
+}
+
+static bool idle_elapsed(const usbd_report_gate_t* gate, uint32_t now_ms)
+{
+    return gate->idle_rate != 0 &&
+           (now_ms - gate->last_sent_ms) >= (uint32_t)gate->idle_rate * 4;
+}
+
+bool usbd_report_gate_check(usbd_report_gate_t* gate, usbd_repeat_policy_t policy,
+                            const void* report, uint16_t len, uint32_t now_ms)
+{
+    if (policy == USBD_REPEAT_EVERY_EVENT || len > USBD_REPORT_MAX_LEN) {
+        return true;
+    }
+
+    if (!usbd_report_gate_same(gate, report, len)) {
+        return true;
+    }
+
+    // Unchanged: only an expired idle period lets it through
+    if (policy == USBD_REPEAT_HID_IDLE && idle_elapsed(gate, now_ms)) {
+        return true;
+    }
+
+    gate->suppressed++;
+    return false;
+}
+
+void usbd_report_gate_commit(usbd_report_gate_t* gate, const void* report,
+                             uint16_t len, uint32_t now_ms)
+{
+    if (len <= USBD_REPORT_MAX_LEN) {
+        memcpy(gate->last, report, len);
+        gate->len = len;
+    }
+    gate->last_sent_ms = now_ms;
+    gate->sent++;
+}
+
+bool usbd_report_gate_idle_due(const usbd_report_gate_t* gate,
+                               usbd_repeat_policy_t policy, uint32_t now_ms)
+{
+    return policy == USBD_REPEAT_HID_IDLE && gate->len != 0 && idle_elapsed(gate, now_ms);
+}
+
+void usbd_report_gate_repeated(usbd_report_gate_t* gate, uint32_t now_ms)
+{
+    gate->last_sent_ms = now_ms;
+    gate->repeated++;
+}
+
+uint32_t usbd_report_gate_idle_in_ms(const usbd_report_gate_t* gate,
+                                     usbd_repeat_policy_t policy, uint32_t now_ms)
+{
+    if (policy != USBD_REPEAT_HID_IDLE || gate->len == 0 || gate->idle_rate == 0) {
+        return UINT32_MAX;
+    }
+    uint32_t period = (uint32_t)gate->idle_rate * 4;
+    uint32_t since = now_ms - gate->last_sent_ms;
+    return since < period ? period - since : 0;
+}
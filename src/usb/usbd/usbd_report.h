@@ -0,0 +1,75 @@
+// usbd_report.h - Report change detection and HID idle policy
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// Each USB output mode declares how its input report repeats. Modes that
+// opt in build the full report and hand it to usbd_report_send(), which
+// compares it word-wise against the last report sent on that interface and
+// report ID and only puts it on the wire when the policy says so:
+//
+//   USBD_REPEAT_EVERY_EVENT - send on every pending input event (default,
+//                             for consoles that expect a steady stream)
+//   USBD_REPEAT_ON_CHANGE   - send only when the report bytes differ
+//   USBD_REPEAT_HID_IDLE    - send on change, and repeat the last report
+//                             once per SET_IDLE period (HID 1.11 7.2.4);
+//                             an idle rate of 0 means "on change only"
+//
+// The gate itself has no USB dependencies; usbd.c owns the gates, sends
+// the reports and handles SET_IDLE.
+
+#ifndef USBD_REPORT_H
+#define USBD_REPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    USBD_REPEAT_EVERY_EVENT = 0,
+    USBD_REPEAT_ON_CHANGE,
+    USBD_REPEAT_HID_IDLE,
+} usbd_repeat_policy_t;
+
+// Largest report the gate caches (full-speed interrupt packet). Longer
+// reports bypass the gate and are always sent.
+#define USBD_REPORT_MAX_LEN     64
+
+typedef struct {
+    uint32_t last[USBD_REPORT_MAX_LEN / 4];  // Last report sent (word aligned)
+    uint32_t last_sent_ms;                   // When it was sent
+    uint16_t len;                            // Its length, 0 = nothing sent yet
+    uint8_t  idle_rate;                      // SET_IDLE duration, 4 ms units (0 = indefinite)
+
+    // Counters since enumeration
+    uint32_t sent;                           // Reports sent by the mode
+    uint32_t suppressed;                     // Unchanged reports not sent
+    uint32_t repeated;                       // Idle repeats sent by the gate
+} usbd_report_gate_t;
+
+// Forget the last report (next report is always sent) and zero counters.
+// The idle rate is kept.
+void usbd_report_gate_reset(usbd_report_gate_t* gate);
+
+// True if report matches the cached report byte for byte.
+bool usbd_report_gate_same(const usbd_report_gate_t* gate, const void* report, uint16_t len);
+
+// Decide whether a freshly built report should be sent. Counts a
+// suppressed report when it returns false.
+bool usbd_report_gate_check(usbd_report_gate_t* gate, usbd_repeat_policy_t policy,
+                            const void* report, uint16_t len, uint32_t now_ms);
+
+// Record a report that was accepted by the endpoint.
+void usbd_report_gate_commit(usbd_report_gate_t* gate, const void* report,
+                             uint16_t len, uint32_t now_ms);
+
+// True when the idle period has elapsed and the cached report should be
+// repeated. Call usbd_report_gate_repeated() once it has been sent.
+bool usbd_report_gate_idle_due(const usbd_report_gate_t* gate,
+                               usbd_repeat_policy_t policy, uint32_t now_ms);
+void usbd_report_gate_repeated(usbd_report_gate_t* gate, uint32_t now_ms);
+
+// Milliseconds until the next idle repeat is due: 0 if it is due now,
+// UINT32_MAX if the gate has nothing to repeat.
+uint32_t usbd_report_gate_idle_in_ms(const usbd_report_gate_t* gate,
+                                     usbd_repeat_policy_t policy, uint32_t now_ms);
+
+#endif // USBD_REPORT_H
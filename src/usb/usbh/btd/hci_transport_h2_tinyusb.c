@@ -34,6 +34,14 @@
 // TRANSPORT STATE
 // ============================================================================
 
+// BTstack may write headers in front of a received packet, so each ACL IN
+// slot reserves room ahead of the data (rounded up to keep the data aligned)
+#ifndef HCI_INCOMING_PRE_BUFFER_SIZE
+#define HCI_INCOMING_PRE_BUFFER_SIZE 0
+#endif
+#define ACL_IN_PRE_SIZE     ((HCI_INCOMING_PRE_BUFFER_SIZE + 3) & ~3)
+#define ACL_IN_DATA(slot)   (&usb_state.acl_in_buf[slot][ACL_IN_PRE_SIZE])
+
 typedef struct {
     // USB device info
     uint8_t  dev_addr;          // TinyUSB device address
@@ -45,8 +53,8 @@ typedef struct {
     // Buffers
     uint8_t  cmd_buf[HCI_USB_CMD_BUF_SIZE];
     uint8_t  evt_buf[HCI_USB_EVT_BUF_SIZE];
-    uint8_t  acl_in_buf[HCI_USB_ACL_BUF_SIZE];
-    uint8_t  acl_out_buf[HCI_USB_ACL_BUF_SIZE];
+    uint8_t  acl_in_buf[HCI_USB_ACL_IN_BUFFERS][ACL_IN_PRE_SIZE + HCI_USB_ACL_BUF_SIZE] __attribute__((aligned(4)));
+    uint8_t  acl_out_buf[HCI_USB_ACL_OUT_BUFFERS][HCI_USB_ACL_BUF_SIZE];
 
     // State flags
     bool     connected;         // Dongle connected and configured
@@ -54,13 +62,25 @@ typedef struct {
     bool     evt_pending;       // Event endpoint transfer pending
     bool     acl_in_pending;    // ACL IN transfer pending
     bool     cmd_pending;       // Command transfer pending
-    bool     acl_out_pending;   // ACL OUT transfer pending
+    bool     acl_out_pending;   // ACL OUT transfer pending (queue head on the wire)
 
     // Received packet info (for deferred processing)
     bool     evt_ready;         // Event packet ready for processing
     uint16_t evt_len;           // Event packet length
-    bool     acl_ready;         // ACL packet ready for processing
-    uint16_t acl_len;           // ACL packet length
+
+    // ACL IN ring: filled slots wait for delivery, the bulk IN targets the
+    // slot after the last filled one
+    uint16_t acl_in_len[HCI_USB_ACL_IN_BUFFERS];
+    uint8_t  acl_in_head;       // Oldest filled slot
+    uint8_t  acl_in_count;      // Filled slots awaiting delivery
+
+    // ACL OUT queue: BTstack's packet is copied in and released straight
+    // away; the head slot is the one on the wire
+    uint16_t acl_out_len[HCI_USB_ACL_OUT_BUFFERS];
+    uint8_t  acl_out_head;      // Oldest queued slot
+    uint8_t  acl_out_count;     // Queued slots (including the one on the wire)
+    uint8_t  acl_out_sent;      // PACKET_SENT events owed to BTstack
+    bool     acl_out_blocked;   // BTstack saw a full queue, wake it when a slot frees
 
     // BTstack packet handler
     void (*packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
@@ -69,6 +89,18 @@ typedef struct {
 
 static hci_usb_state_t usb_state;
 
+// Kept outside usb_state so BTstack power cycles don't clear them
+static struct {
+    uint32_t in_packets;
+    uint32_t in_starved;
+    uint32_t in_high_water;
+    uint32_t out_packets;
+    uint32_t out_stalls;
+    uint32_t out_high_water;
+} acl_stats;
+
+static const uint8_t packet_sent_event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0 };
+
 #if USE_BTSTACK
 // Data source for BTstack run loop integration
 static btstack_data_source_t transport_data_source;
@@ -92,6 +124,8 @@ static void hci_transport_h2_process_data_source(btstack_data_source_t *ds, btst
 
 static void usb_submit_event_transfer(void);
 static void usb_submit_acl_in_transfer(void);
+static bool usb_start_acl_out_transfer(void);
+static void acl_reset_rings(void);
 
 // ============================================================================
 // BTSTACK TRANSPORT INTERFACE
@@ -194,6 +228,7 @@ static int hci_transport_h2_close(void)
 #endif
 
     usb_state.opened = false;
+    acl_reset_rings();
     printf("[HCI_USB] Transport closed\n");
 
     return 0;
@@ -216,7 +251,15 @@ static int hci_transport_h2_can_send_packet_now(uint8_t packet_type)
         case HCI_COMMAND_DATA_PACKET:
             return !usb_state.cmd_pending;
         case HCI_ACL_DATA_PACKET:
-            return !usb_state.acl_out_pending;
+            if (usb_state.acl_out_count < HCI_USB_ACL_OUT_BUFFERS) {
+                return 1;
+            }
+            // Count each stall once; the next freed slot wakes BTstack
+            if (!usb_state.acl_out_blocked) {
+                usb_state.acl_out_blocked = true;
+                acl_stats.out_stalls++;
+            }
+            return 0;
         default:
             return 0;
     }
@@ -234,7 +277,6 @@ static void hci_cmd_complete_cb(tuh_xfer_t* xfer)
 #if USE_BTSTACK
     // Emit packet sent event so BTstack releases buffer and can send next
     if (usb_state.packet_handler) {
-        static const uint8_t packet_sent_event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0 };
         usb_state.packet_handler(HCI_EVENT_PACKET, (uint8_t*)packet_sent_event, sizeof(packet_sent_event));
     }
 #endif
@@ -301,7 +343,7 @@ static int hci_transport_h2_send_packet(uint8_t packet_type, uint8_t *packet, in
         }
 
         case HCI_ACL_DATA_PACKET: {
-            if (usb_state.acl_out_pending) {
+            if (usb_state.acl_out_count == HCI_USB_ACL_OUT_BUFFERS) {
                 printf("[HCI_USB] ACL send failed - busy\n");
                 return -1;
             }
@@ -310,19 +352,31 @@ static int hci_transport_h2_send_packet(uint8_t packet_type, uint8_t *packet, in
                 return -1;
             }
 
-            // Copy to buffer
-            memcpy(usb_state.acl_out_buf, packet, size);
-
-            // Send via bulk OUT endpoint
-            usb_state.acl_out_pending = true;
+            // Copy into the next queue slot (must persist until transfer completes)
+            uint8_t slot = (usb_state.acl_out_head + usb_state.acl_out_count) % HCI_USB_ACL_OUT_BUFFERS;
+            memcpy(usb_state.acl_out_buf[slot], packet, size);
+            usb_state.acl_out_len[slot] = (uint16_t)size;
+            usb_state.acl_out_count++;
 
-            if (!usbh_edpt_xfer(usb_state.dev_addr, usb_state.ep_acl_out,
-                                usb_state.acl_out_buf, (uint16_t)size)) {
+            // Send via bulk OUT endpoint if nothing is ahead of it
+            if (!usb_start_acl_out_transfer()) {
                 printf("[HCI_USB] Failed to send ACL data\n");
-                usb_state.acl_out_pending = false;
+                usb_state.acl_out_count--;
                 return -1;
             }
 
+            acl_stats.out_packets++;
+            if (usb_state.acl_out_count > acl_stats.out_high_water) {
+                acl_stats.out_high_water = usb_state.acl_out_count;
+            }
+
+            // BTstack's packet buffer is free again now that it's copied.
+            // Report that from process() rather than from in here: hci.c is
+            // still inside its fragment loop and wouldn't release the buffer.
+            usb_state.acl_out_sent++;
+#if USE_BTSTACK
+            btstack_run_loop_poll_data_sources_from_irq();
+#endif
             return 0;
         }
 
@@ -350,6 +404,13 @@ static void hci_transport_h2_process_data_source(btstack_data_source_t *ds,
 
 void hci_transport_h2_tinyusb_process(void)
 {
+    // Release BTstack's packet buffer for each queued ACL packet
+    while (usb_state.acl_out_sent && usb_state.packet_handler) {
+        usb_state.acl_out_sent--;
+        usb_state.packet_handler(HCI_EVENT_PACKET, (uint8_t*)packet_sent_event,
+                                 sizeof(packet_sent_event));
+    }
+
     // Deliver any received event packets
     if (usb_state.evt_ready && usb_state.packet_handler) {
         usb_state.evt_ready = false;
@@ -369,24 +430,30 @@ void hci_transport_h2_tinyusb_process(void)
 #endif
     }
 
-    // Deliver any received ACL packets
-    if (usb_state.acl_ready && usb_state.packet_handler) {
-        usb_state.acl_ready = false;
+    // Deliver received ACL packets straight from their ring slots, oldest first
+    while (usb_state.acl_in_count && usb_state.packet_handler) {
+        uint8_t slot = usb_state.acl_in_head;
+        uint8_t* acl = ACL_IN_DATA(slot);
+        uint16_t acl_len = usb_state.acl_in_len[slot];
 
         // Debug: Show ACL packet with L2CAP/ATT header
-        if (usb_state.acl_len >= 9) {
+        if (acl_len >= 9) {
             // Debug disabled - too much output causes buffer issues
-            // uint16_t handle = usb_state.acl_in_buf[0] | ((usb_state.acl_in_buf[1] & 0x0F) << 8);
-            // uint16_t l2cap_len = usb_state.acl_in_buf[4] | (usb_state.acl_in_buf[5] << 8);
-            // uint16_t l2cap_cid = usb_state.acl_in_buf[6] | (usb_state.acl_in_buf[7] << 8);
-            // uint8_t att_opcode = usb_state.acl_in_buf[8];
+            // uint16_t handle = acl[0] | ((acl[1] & 0x0F) << 8);
+            // uint16_t l2cap_len = acl[4] | (acl[5] << 8);
+            // uint16_t l2cap_cid = acl[6] | (acl[7] << 8);
+            // uint8_t att_opcode = acl[8];
             // printf("[HCI_USB] ACL h=0x%04X L2CAP len=%d cid=0x%04X ATT=0x%02X\n",
             //        handle, l2cap_len, l2cap_cid, att_opcode);
         }
 
-        usb_state.packet_handler(HCI_ACL_DATA_PACKET, usb_state.acl_in_buf, usb_state.acl_len);
+        usb_state.packet_handler(HCI_ACL_DATA_PACKET, acl, acl_len);
+
+        // Slot is free once the handler returns
+        usb_state.acl_in_head = (slot + 1) % HCI_USB_ACL_IN_BUFFERS;
+        usb_state.acl_in_count--;
 
-        // Submit next ACL transfer
+        // Re-arm if the ring was full (no-op while a transfer is in flight)
         usb_submit_acl_in_transfer();
 
 #if USE_BTSTACK
@@ -411,6 +478,23 @@ bool hci_transport_h2_tinyusb_is_connected(void)
     return usb_state.connected;
 }
 
+void hci_transport_h2_tinyusb_get_stats(uint32_t* in_packets, uint32_t* in_starved,
+                                        uint32_t* in_high_water, uint32_t* out_packets,
+                                        uint32_t* out_stalls, uint32_t* out_high_water)
+{
+    if (in_packets) *in_packets = acl_stats.in_packets;
+    if (in_starved) *in_starved = acl_stats.in_starved;
+    if (in_high_water) *in_high_water = acl_stats.in_high_water;
+    if (out_packets) *out_packets = acl_stats.out_packets;
+    if (out_stalls) *out_stalls = acl_stats.out_stalls;
+    if (out_high_water) *out_high_water = acl_stats.out_high_water;
+}
+
+void hci_transport_h2_tinyusb_reset_stats(void)
+{
+    memset(&acl_stats, 0, sizeof(acl_stats));
+}
+
 // ============================================================================
 // STANDALONE TEST MODE
 // ============================================================================
@@ -735,20 +819,74 @@ static void usb_submit_event_transfer(void)
 
 static void usb_submit_acl_in_transfer(void)
 {
-    if (!usb_state.connected || usb_state.acl_in_pending) {
+    // Ring full: the endpoint stays idle until process() frees a slot
+    if (!usb_state.connected || usb_state.acl_in_pending ||
+        usb_state.acl_in_count == HCI_USB_ACL_IN_BUFFERS) {
         return;
     }
 
+    uint8_t slot = (usb_state.acl_in_head + usb_state.acl_in_count) % HCI_USB_ACL_IN_BUFFERS;
     usb_state.acl_in_pending = true;
-    memset(usb_state.acl_in_buf, 0, sizeof(usb_state.acl_in_buf));
 
     if (!usbh_edpt_xfer(usb_state.dev_addr, usb_state.ep_acl_in,
-                        usb_state.acl_in_buf, sizeof(usb_state.acl_in_buf))) {
+                        ACL_IN_DATA(slot), HCI_USB_ACL_BUF_SIZE)) {
         usb_state.acl_in_pending = false;
         printf("[HCI_USB] Failed to submit ACL IN transfer\n");
     }
 }
 
+// Put the head of the OUT queue on the wire if the endpoint is idle
+static bool usb_start_acl_out_transfer(void)
+{
+    if (usb_state.acl_out_pending || !usb_state.acl_out_count) {
+        return true;
+    }
+
+    uint8_t slot = usb_state.acl_out_head;
+    usb_state.acl_out_pending = true;
+
+    if (!usbh_edpt_xfer(usb_state.dev_addr, usb_state.ep_acl_out,
+                        usb_state.acl_out_buf[slot], usb_state.acl_out_len[slot])) {
+        usb_state.acl_out_pending = false;
+        return false;
+    }
+    return true;
+}
+
+// Drop everything queued or received (transport closed or dongle gone)
+static void acl_reset_rings(void)
+{
+    usb_state.acl_in_head = 0;
+    usb_state.acl_in_count = 0;
+    usb_state.acl_out_head = 0;
+    usb_state.acl_out_count = 0;
+    usb_state.acl_out_sent = 0;
+    usb_state.acl_out_blocked = false;
+}
+
+// The head OUT slot finished (sent or failed): free it, start the next one,
+// and wake BTstack if it was waiting on a full queue
+static void acl_out_complete(void)
+{
+    usb_state.acl_out_pending = false;
+    if (usb_state.acl_out_count) {
+        usb_state.acl_out_head = (usb_state.acl_out_head + 1) % HCI_USB_ACL_OUT_BUFFERS;
+        usb_state.acl_out_count--;
+    }
+
+    while (usb_state.acl_out_count && !usb_start_acl_out_transfer()) {
+        printf("[HCI_USB] Failed to send queued ACL data\n");
+        usb_state.acl_out_head = (usb_state.acl_out_head + 1) % HCI_USB_ACL_OUT_BUFFERS;
+        usb_state.acl_out_count--;
+    }
+
+    if (usb_state.acl_out_blocked && usb_state.packet_handler) {
+        usb_state.acl_out_blocked = false;
+        usb_state.packet_handler(HCI_EVENT_PACKET, (uint8_t*)packet_sent_event,
+                                 sizeof(packet_sent_event));
+    }
+}
+
 // ============================================================================
 // TINYUSB CLASS DRIVER IMPLEMENTATION
 // ============================================================================
@@ -920,7 +1058,8 @@ bool btstack_driver_xfer_cb(uint8_t dev_addr, uint8_t ep_addr,
         } else if (ep_addr == usb_state.ep_acl_in) {
             usb_state.acl_in_pending = false;
         } else if (ep_addr == usb_state.ep_acl_out) {
-            usb_state.acl_out_pending = false;
+            // Packet is lost either way; keep the rest of the queue moving
+            acl_out_complete();
         }
 
         return true;
@@ -939,10 +1078,23 @@ bool btstack_driver_xfer_cb(uint8_t dev_addr, uint8_t ep_addr,
 #endif
     }
     else if (ep_addr == usb_state.ep_acl_in) {
-        // ACL Data received
+        // ACL Data received into the slot after the last filled one
+        uint8_t slot = (usb_state.acl_in_head + usb_state.acl_in_count) % HCI_USB_ACL_IN_BUFFERS;
         usb_state.acl_in_pending = false;
-        usb_state.acl_len = (uint16_t)xferred_bytes;
-        usb_state.acl_ready = true;
+        usb_state.acl_in_len[slot] = (uint16_t)xferred_bytes;
+        usb_state.acl_in_count++;
+
+        acl_stats.in_packets++;
+        if (usb_state.acl_in_count > acl_stats.in_high_water) {
+            acl_stats.in_high_water = usb_state.acl_in_count;
+        }
+
+        // Re-arm now so the dongle can hand over the next queued packet
+        // while this one waits for the run loop
+        usb_submit_acl_in_transfer();
+        if (usb_state.acl_in_count == HCI_USB_ACL_IN_BUFFERS) {
+            acl_stats.in_starved++;
+        }
 
 #if USE_BTSTACK
         // Trigger BTstack run loop
@@ -950,18 +1102,8 @@ bool btstack_driver_xfer_cb(uint8_t dev_addr, uint8_t ep_addr,
 #endif
     }
     else if (ep_addr == usb_state.ep_acl_out) {
-        // ACL Data sent
-        usb_state.acl_out_pending = false;
-
-        // Notify BTstack that we can send again
-        if (usb_state.packet_handler) {
-            // Send HCI_EVENT_TRANSPORT_PACKET_SENT
-            static uint8_t packet_sent_event[] = {
-                HCI_EVENT_TRANSPORT_PACKET_SENT, 0
-            };
-            usb_state.packet_handler(HCI_EVENT_PACKET, packet_sent_event,
-                                     sizeof(packet_sent_event));
-        }
+        // ACL Data sent (BTstack was already told when it was queued)
+        acl_out_complete();
     }
     else if (ep_addr == 0) {
         // Control transfer complete (command sent)
@@ -969,10 +1111,7 @@ bool btstack_driver_xfer_cb(uint8_t dev_addr, uint8_t ep_addr,
 
         // Notify BTstack that we can send again
         if (usb_state.packet_handler) {
-            static uint8_t packet_sent_event[] = {
-                HCI_EVENT_TRANSPORT_PACKET_SENT, 0
-            };
-            usb_state.packet_handler(HCI_EVENT_PACKET, packet_sent_event,
+            usb_state.packet_handler(HCI_EVENT_PACKET, (uint8_t*)packet_sent_event,
                                      sizeof(packet_sent_event));
         }
     }
@@ -991,9 +1130,18 @@ void btstack_driver_close(uint8_t dev_addr)
     usb_state.connected = false;
     usb_state.opened = false;
     usb_state.evt_pending = false;
+    usb_state.evt_ready = false;
     usb_state.acl_in_pending = false;
     usb_state.cmd_pending = false;
     usb_state.acl_out_pending = false;
+    acl_reset_rings();
+
+    // A replugged dongle usually comes back at the same address; forget the
+    // endpoints so the double-open guard doesn't skip opening them again
+    usb_state.dev_addr = 0;
+    usb_state.ep_evt_in = 0;
+    usb_state.ep_acl_in = 0;
+    usb_state.ep_acl_out = 0;
 }
 
 // ============================================================================
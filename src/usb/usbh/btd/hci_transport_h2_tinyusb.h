@@ -118,6 +118,16 @@ const hci_transport_t* hci_transport_h2_tinyusb_instance(void);
 #define HCI_USB_EVT_BUF_SIZE        264     // HCI event buffer
 #define HCI_USB_ACL_BUF_SIZE        1024    // ACL data buffer (larger for GATT)
 
+// ACL ring depths. With several controllers connected the dongle holds HID
+// reports for more than one link; extra IN slots let the bulk IN be re-armed
+// as soon as one completes instead of after the next main loop pass.
+#ifndef HCI_USB_ACL_IN_BUFFERS
+#define HCI_USB_ACL_IN_BUFFERS      4
+#endif
+#ifndef HCI_USB_ACL_OUT_BUFFERS
+#define HCI_USB_ACL_OUT_BUFFERS     4
+#endif
+
 // TinyUSB class driver interface - register with usbh_app_driver_get_cb()
 #include "tusb.h"
 #include "host/usbh_pvt.h"
@@ -140,6 +150,15 @@ void hci_transport_h2_tinyusb_process(void);
 // Check if a Bluetooth dongle is connected
 bool hci_transport_h2_tinyusb_is_connected(void);
 
+// ACL counters since boot (or the last reset). in_starved counts bulk IN
+// completions that found every ring slot still awaiting delivery, so the
+// endpoint sat idle until the main loop drained one. out_stalls counts the
+// times BTstack found the OUT queue full. High-water marks are slots in use.
+void hci_transport_h2_tinyusb_get_stats(uint32_t* in_packets, uint32_t* in_starved,
+                                        uint32_t* in_high_water, uint32_t* out_packets,
+                                        uint32_t* out_stalls, uint32_t* out_high_water);
+void hci_transport_h2_tinyusb_reset_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,234 @@
+// switch_cal.c - Switch Pro / Joy-Con stick and IMU calibration
+
+#include "switch_cal.h"
+#include <string.h>
+
+// ============================================================================
+// SPI REGIONS
+// ============================================================================
+
+typedef struct {
+    uint16_t addr;
+    uint8_t len;
+} switch_cal_region_t;
+
+static const switch_cal_region_t cal_regions[SWITCH_CAL_REGION_COUNT] = {
+    { SWITCH_CAL_SPI_IMU_FACTORY,   24 },
+    { SWITCH_CAL_SPI_STICK_FACTORY, 18 },
+    { SWITCH_CAL_SPI_STICK_USER,    22 },
+    { SWITCH_CAL_SPI_IMU_USER,      26 },
+};
+
+// User calibration blocks start with this magic; erased flash reads 0xFF
+#define USER_CAL_MAGIC0     0xB2
+#define USER_CAL_MAGIC1     0xA1
+
+// Nominal sensitivities (LSM6DS3 at ±8 g / ±2000 dps as configured by the
+// controller firmware). Used when the SPI values are missing or degenerate.
+#define ACCEL_SENS_NOMINAL  16384
+#define GYRO_SENS_NOMINAL   13371
+
+// 0x21 reply layout: [13] ack, [14] subcommand, [15..18] address LE32,
+// [19] length, [20..] data
+#define REPLY_SUBCMD        14
+#define REPLY_ADDR          15
+#define REPLY_LEN           19
+#define REPLY_DATA          20
+
+// ============================================================================
+// DECODE
+// ============================================================================
+
+static inline int16_t rd_s16(const uint8_t* p)
+{
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+static inline int16_t clamp_s16(int32_t v)
+{
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)v;
+}
+
+static bool all_erased(const uint8_t* data, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++) {
+        if (data[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+void switch_cal_unpack_stick(const uint8_t* data, uint16_t* x, uint16_t* y)
+{
+    *x = data[0] | ((data[1] & 0x0F) << 8);
+    *y = ((data[1] & 0xF0) >> 4) | (data[2] << 4);
+}
+
+// Decode one stick's 9 bytes. The left stick stores max-above, center,
+// min-below; the right stick stores center, min-below, max-above.
+static void decode_stick(switch_stick_cal_t* out, const uint8_t* data, bool right)
+{
+    if (all_erased(data, 9)) return;
+
+    const uint8_t* above  = right ? &data[6] : &data[0];
+    const uint8_t* center = right ? &data[0] : &data[3];
+    const uint8_t* below  = right ? &data[3] : &data[6];
+
+    switch_stick_cal_t cal = { 0 };
+    switch_cal_unpack_stick(above, &cal.above[0], &cal.above[1]);
+    switch_cal_unpack_stick(center, &cal.center[0], &cal.center[1]);
+    switch_cal_unpack_stick(below, &cal.below[0], &cal.below[1]);
+
+    // Reject degenerate ranges rather than divide by zero later
+    for (int i = 0; i < 2; i++) {
+        if (cal.center[i] == 0 || cal.center[i] == 0xFFF) return;
+        if (cal.above[i] == 0 || cal.below[i] == 0) return;
+    }
+
+    cal.valid = 1;
+    *out = cal;
+}
+
+static void decode_imu(switch_imu_cal_t* out, const uint8_t* data)
+{
+    if (all_erased(data, 24)) return;
+
+    switch_imu_cal_t cal;
+    for (int i = 0; i < 3; i++) {
+        cal.accel_origin[i] = rd_s16(&data[0 + i * 2]);
+        cal.accel_sens[i]   = rd_s16(&data[6 + i * 2]);
+        cal.gyro_origin[i]  = rd_s16(&data[12 + i * 2]);
+        cal.gyro_sens[i]    = rd_s16(&data[18 + i * 2]);
+
+        if (cal.accel_sens[i] == cal.accel_origin[i]) return;
+        if (cal.gyro_sens[i] == cal.gyro_origin[i]) return;
+    }
+    *out = cal;
+}
+
+static void apply_region(switch_cal_t* cal, uint16_t addr, const uint8_t* data)
+{
+    switch (addr) {
+        case SWITCH_CAL_SPI_IMU_FACTORY:
+            decode_imu(&cal->imu, data);
+            break;
+
+        case SWITCH_CAL_SPI_STICK_FACTORY:
+            decode_stick(&cal->stick[0], &data[0], false);
+            decode_stick(&cal->stick[1], &data[9], true);
+            break;
+
+        case SWITCH_CAL_SPI_STICK_USER:
+            if (data[0] == USER_CAL_MAGIC0 && data[1] == USER_CAL_MAGIC1) {
+                decode_stick(&cal->stick[0], &data[2], false);
+            }
+            if (data[11] == USER_CAL_MAGIC0 && data[12] == USER_CAL_MAGIC1) {
+                decode_stick(&cal->stick[1], &data[13], true);
+            }
+            break;
+
+        case SWITCH_CAL_SPI_IMU_USER:
+            if (data[0] == USER_CAL_MAGIC0 && data[1] == USER_CAL_MAGIC1) {
+                decode_imu(&cal->imu, &data[2]);
+            }
+            break;
+    }
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+void switch_cal_init(switch_cal_t* cal)
+{
+    memset(cal, 0, sizeof(*cal));
+    for (int i = 0; i < 3; i++) {
+        cal->imu.accel_sens[i] = ACCEL_SENS_NOMINAL;
+        cal->imu.gyro_sens[i] = GYRO_SENS_NOMINAL;
+    }
+}
+
+void switch_cal_spi_args(uint8_t region, uint8_t args[5])
+{
+    const switch_cal_region_t* r = &cal_regions[region % SWITCH_CAL_REGION_COUNT];
+    args[0] = r->addr & 0xFF;
+    args[1] = r->addr >> 8;
+    args[2] = 0;
+    args[3] = 0;
+    args[4] = r->len;
+}
+
+bool switch_cal_spi_reply(switch_cal_t* cal, uint8_t region, const uint8_t* report, uint16_t len)
+{
+    if (region >= SWITCH_CAL_REGION_COUNT) return false;
+    const switch_cal_region_t* r = &cal_regions[region];
+
+    if (len < REPLY_DATA + r->len) return false;
+    if (report[0] != 0x21 || report[REPLY_SUBCMD] != SWITCH_SUBCMD_SPI_READ) return false;
+
+    uint32_t addr = report[REPLY_ADDR] | (report[REPLY_ADDR + 1] << 8) |
+                    ((uint32_t)report[REPLY_ADDR + 2] << 16) | ((uint32_t)report[REPLY_ADDR + 3] << 24);
+    if (addr != r->addr || report[REPLY_LEN] != r->len) return false;
+
+    apply_region(cal, r->addr, &report[REPLY_DATA]);
+    return true;
+}
+
+uint8_t switch_cal_stick_axis(const switch_stick_cal_t* cal, uint8_t axis, uint16_t raw)
+{
+    int32_t d = (int32_t)raw - cal->center[axis];
+    int32_t v = (d < 0) ? 128 + (d * 128) / cal->below[axis]
+                        : 128 + (d * 127) / cal->above[axis];
+    if (v < 0) v = 0;
+    if (v > 255) v = 255;
+    return (uint8_t)v;
+}
+
+void switch_cal_imu_frame(const switch_imu_cal_t* cal, const uint8_t* frame,
+                          int16_t accel[3], int16_t gyro[3])
+{
+    // Accel origin is the resting tilt, not a zero offset — scale only.
+    // Gyro origin is the zero-rate bias.
+    for (int i = 0; i < 3; i++) {
+        int32_t a = rd_s16(&frame[i * 2]);
+        int32_t g = rd_s16(&frame[6 + i * 2]);
+        accel[i] = clamp_s16((a * ACCEL_SENS_NOMINAL) / (cal->accel_sens[i] - cal->accel_origin[i]));
+        gyro[i] = clamp_s16(((g - cal->gyro_origin[i]) * GYRO_SENS_NOMINAL) / (cal->gyro_sens[i] - cal->gyro_origin[i]));
+    }
+}
+
+uint8_t switch_cal_new_imu_frames(const uint8_t* imu, uint8_t last[SWITCH_IMU_FRAME_SIZE])
+{
+    uint8_t fresh = SWITCH_IMU_SAMPLES;
+    for (uint8_t i = 0; i < SWITCH_IMU_SAMPLES; i++) {
+        if (memcmp(&imu[i * SWITCH_IMU_FRAME_SIZE], last, SWITCH_IMU_FRAME_SIZE) == 0) {
+            fresh = i;
+            break;
+        }
+    }
+    memcpy(last, imu, SWITCH_IMU_FRAME_SIZE);
+    return fresh;
+}
+
+// ============================================================================
+// CACHE FALLBACK
+// ============================================================================
+
+// Platforms without a cache sector re-read SPI on every connect
+__attribute__((weak)) bool switch_cal_cache_load(const uint8_t mac[6], switch_cal_t* cal)
+{
+    (void)mac;
+    (void)cal;
+    return false;
+}
+
+__attribute__((weak)) void switch_cal_cache_store(const uint8_t mac[6], const switch_cal_t* cal)
+{
+    (void)mac;
+    (void)cal;
+}
+
+__attribute__((weak)) void switch_cal_cache_task(void)
+{
+}
@@ -0,0 +1,113 @@
+// switch_cal.h - Switch Pro / Joy-Con stick and IMU calibration
+//
+// Shared by the USB (switch_pro.c) and Bluetooth (switch_pro_bt.c) host
+// drivers. The controller keeps its calibration in SPI flash; the drivers
+// read it with subcommand 0x10 at connect, decode it here, and cache the
+// result per controller MAC so a reconnect is calibrated on the first report.
+//
+// No TinyUSB or BTstack dependency, so tools/switch-cal-decode builds it on
+// the host.
+//
+// Reference: dekuNukem/Nintendo_Switch_Reverse_Engineering (spi_flash_notes.md,
+//            imu_sensor_notes.md), SDL hidapi_switch
+
+#ifndef SWITCH_CAL_H
+#define SWITCH_CAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// PROTOCOL
+// ============================================================================
+
+#define SWITCH_SUBCMD_SPI_READ          0x10
+
+// SPI flash regions read at connect, in read order. User calibration comes
+// after factory so it overrides it when present (magic 0xB2 0xA1).
+#define SWITCH_CAL_SPI_IMU_FACTORY      0x6020  // 24 bytes
+#define SWITCH_CAL_SPI_STICK_FACTORY    0x603D  // 18 bytes, L then R
+#define SWITCH_CAL_SPI_STICK_USER       0x8010  // 22 bytes, magic + L, magic + R
+#define SWITCH_CAL_SPI_IMU_USER         0x8026  // 26 bytes, magic + 24 bytes
+#define SWITCH_CAL_REGION_COUNT         4
+
+// 0x30 report layout: three 12-byte IMU frames (accel XYZ, gyro XYZ, int16
+// LE) starting at byte 13, [0] newest. Sensor samples every 5 ms.
+#define SWITCH_IMU_OFFSET               13
+#define SWITCH_IMU_FRAME_SIZE           12
+#define SWITCH_IMU_SAMPLES              3
+#define SWITCH_IMU_REPORT_MIN_LEN       (SWITCH_IMU_OFFSET + SWITCH_IMU_SAMPLES * SWITCH_IMU_FRAME_SIZE)
+#define SWITCH_IMU_SAMPLE_US            5000
+
+// Ranges of the calibrated motion we put on input_event_t. Accel is
+// normalised to 4096 counts/g (±8 g), gyro to the nominal 13371-sensitivity
+// scale of 0.07 dps/count, so a factory-default controller passes through
+// unchanged.
+#define SWITCH_IMU_ACCEL_RANGE          8000    // milli-g
+#define SWITCH_IMU_GYRO_RANGE           2294    // dps
+
+// ============================================================================
+// CALIBRATION
+// ============================================================================
+
+typedef struct {
+    uint16_t center[2];     // X, Y
+    uint16_t below[2];      // Travel from center down to min
+    uint16_t above[2];      // Travel from center up to max
+    uint8_t valid;
+    uint8_t reserved;
+} switch_stick_cal_t;
+
+typedef struct {
+    int16_t accel_origin[3];
+    int16_t accel_sens[3];
+    int16_t gyro_origin[3];
+    int16_t gyro_sens[3];
+} switch_imu_cal_t;
+
+typedef struct {
+    switch_stick_cal_t stick[2];    // [0] left, [1] right
+    switch_imu_cal_t imu;
+} switch_cal_t;
+
+// Reset to "no stick calibration" and the nominal IMU calibration
+void switch_cal_init(switch_cal_t* cal);
+
+// Fill the five subcommand 0x10 argument bytes (address LE32, length) for
+// region `region` (0..SWITCH_CAL_REGION_COUNT-1)
+void switch_cal_spi_args(uint8_t region, uint8_t args[5]);
+
+// Feed a 0x21 subcommand reply report (report ID at [0]). Returns true if it
+// is the SPI read reply for `region`, after applying its data to `cal`.
+bool switch_cal_spi_reply(switch_cal_t* cal, uint8_t region, const uint8_t* report, uint16_t len);
+
+// Unpack a 3-byte packed 12-bit stick field into X and Y
+void switch_cal_unpack_stick(const uint8_t* data, uint16_t* x, uint16_t* y);
+
+// Scale a raw 12-bit axis (axis 0 = X, 1 = Y) to 0-255, 128 = center, high =
+// right/up as the controller reports it. Caller inverts Y for HID.
+uint8_t switch_cal_stick_axis(const switch_stick_cal_t* cal, uint8_t axis, uint16_t raw);
+
+// Apply IMU calibration to one raw 12-byte frame
+void switch_cal_imu_frame(const switch_imu_cal_t* cal, const uint8_t* frame,
+                          int16_t accel[3], int16_t gyro[3]);
+
+// Count the frames in a 0x30 report that were not in the previous one. USB
+// reports arrive faster than the sensor, so consecutive reports share frames.
+// `last` holds the newest raw frame seen (zeroed = none yet) and is updated.
+uint8_t switch_cal_new_imu_frames(const uint8_t* imu, uint8_t last[SWITCH_IMU_FRAME_SIZE]);
+
+// ============================================================================
+// CACHE
+// ============================================================================
+
+// Look up / store decoded calibration by controller MAC. Backed by a flash
+// sector on RP2040 (core/services/storage/switch_cal_flash.c); other
+// platforms link weak no-ops and re-read SPI on every connect.
+// Stores are queued; switch_cal_cache_task() (run by storage_task) writes
+// them, so callers never wait on a flash erase.
+bool switch_cal_cache_load(const uint8_t mac[6], switch_cal_t* cal);
+void switch_cal_cache_store(const uint8_t mac[6], const switch_cal_t* cal);
+void switch_cal_cache_task(void);
+
+#endif // SWITCH_CAL_H
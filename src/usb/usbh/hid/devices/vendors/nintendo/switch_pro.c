@@ -1,5 +1,6 @@
 // switch_pro.c
 #include "switch_pro.h"
+#include "switch_cal.h"
 #include "core/buttons.h"
 #include "core/services/players/manager.h"
 #include "core/router/router.h"
@@ -11,9 +12,18 @@ typedef struct {
   uint16_t center;      // Calibrated center value
 } stick_cal_t;
 
+// SPI calibration read: per-read reply timeout and retries before giving up
+// (some third-party controllers never answer subcommand 0x10)
+#define CAL_READ_TIMEOUT_MS 100
+#define CAL_READ_RETRIES    2
+// How long to wait for the 0x80 0x01 status reply (carries the MAC)
+#define STATUS_TIMEOUT_MS   100
+
 // Switch instance state
-typedef struct TU_ATTR_PACKED
+typedef struct
 {
+  bool status_requested;
+  uint32_t status_ms;
   bool conn_ack;
   bool baud;
   bool baud_ack;
@@ -28,7 +38,21 @@ typedef struct TU_ATTR_PACKED
   uint8_t rumble_left;
   uint8_t rumble_right;
   uint8_t player_led_set;
-  // Stick calibration (captured on first reports assuming sticks at rest)
+  // Controller MAC from the 0x80 0x01 status reply (calibration cache key)
+  uint8_t mac[6];
+  bool has_mac;
+  // SPI flash calibration, read at init or loaded from the cache by MAC.
+  // Input is held until it is ready so the first report is calibrated.
+  switch_cal_t cal;
+  bool cal_ready;
+  bool cal_pending;
+  uint8_t cal_region;
+  uint8_t cal_retries;
+  uint32_t cal_sent_ms;
+  // Newest raw IMU frame already forwarded
+  uint8_t imu_last[SWITCH_IMU_FRAME_SIZE];
+  // Fallback stick calibration when SPI has none (captured on first
+  // reports assuming sticks at rest)
   stick_cal_t cal_lx, cal_ly, cal_rx, cal_ry;
   uint8_t cal_samples;
 } switch_instance_t;
@@ -141,6 +165,7 @@ static uint8_t scale_analog_calibrated(uint16_t val, uint16_t center) {
 void unmount_switch_pro(uint8_t dev_addr, uint8_t instance)
 {
   TU_LOG1("SWITCH[%d|%d]: Unmount Reset\r\n", dev_addr, instance);
+  switch_devices[dev_addr].instances[instance].status_requested = false;
   switch_devices[dev_addr].instances[instance].conn_ack = false;
   switch_devices[dev_addr].instances[instance].baud = false;
   switch_devices[dev_addr].instances[instance].baud_ack = false;
@@ -155,6 +180,14 @@ void unmount_switch_pro(uint8_t dev_addr, uint8_t instance)
   switch_devices[dev_addr].instances[instance].rumble_left = 0;
   switch_devices[dev_addr].instances[instance].rumble_right = 0;
   switch_devices[dev_addr].instances[instance].player_led_set = 0xff;
+  switch_devices[dev_addr].instances[instance].has_mac = false;
+  switch_devices[dev_addr].instances[instance].cal_ready = false;
+  switch_devices[dev_addr].instances[instance].cal_pending = false;
+  switch_devices[dev_addr].instances[instance].cal_region = 0;
+  switch_devices[dev_addr].instances[instance].cal_retries = 0;
+  switch_devices[dev_addr].instances[instance].cal_samples = 0;
+  switch_cal_init(&switch_devices[dev_addr].instances[instance].cal);
+  memset(switch_devices[dev_addr].instances[instance].imu_last, 0, SWITCH_IMU_FRAME_SIZE);
   switch_devices[dev_addr].is_pro = false;
 
   if (switch_devices[dev_addr].instance_count > 1) {
@@ -199,16 +232,35 @@ void input_report_switch_pro(uint8_t dev_addr, uint8_t instance, uint8_t const*
   // (e.g. player LED), the controller switches to 0x21 and we'd ignore it.
   if (update_report.report_id == 0x30 || update_report.report_id == 0x21)
   {
-    switch_devices[dev_addr].instances[instance].usb_enable_ack = true;
+    switch_instance_t* inst = &switch_devices[dev_addr].instances[instance];
+    inst->usb_enable_ack = true;
+
+    // SPI calibration reply
+    if (update_report.report_id == 0x21 && inst->cal_pending &&
+        switch_cal_spi_reply(&inst->cal, inst->cal_region, report, len)) {
+      inst->cal_pending = false;
+      inst->cal_retries = 0;
+      inst->cal_region++;
+    }
 
     update_report.left_x = (update_report.left_stick[0] & 0xFF) | ((update_report.left_stick[1] & 0x0F) << 8);
     update_report.left_y = ((update_report.left_stick[1] & 0xF0) >> 4) | ((update_report.left_stick[2] & 0xFF) << 4);
     update_report.right_x = (update_report.right_stick[0] & 0xFF) | ((update_report.right_stick[1] & 0x0F) << 8);
     update_report.right_y = ((update_report.right_stick[1] & 0xF0) >> 4) | ((update_report.right_stick[2] & 0xFF) << 4);
 
-    // Auto-calibrate center on first reports (Pro controllers only, assumes sticks at rest)
-    switch_instance_t* inst = &switch_devices[dev_addr].instances[instance];
-    if (switch_devices[dev_addr].is_pro && inst->cal_samples < CAL_SAMPLES_NEEDED) {
+    // Hold input until calibration is read (or loaded from the cache)
+    if (!inst->cal_ready) {
+      prev_report[dev_addr-1][instance] = update_report;
+      return;
+    }
+
+    const switch_stick_cal_t* lcal = &inst->cal.stick[0];
+    const switch_stick_cal_t* rcal = &inst->cal.stick[1];
+
+    // No SPI stick calibration: auto-calibrate center on first reports
+    // (Pro controllers only, assumes sticks at rest)
+    if (switch_devices[dev_addr].is_pro && !(lcal->valid && rcal->valid) &&
+        inst->cal_samples < CAL_SAMPLES_NEEDED) {
       if (inst->cal_samples == 0) {
         inst->cal_lx.center = update_report.left_x;
         inst->cal_ly.center = update_report.left_y;
@@ -285,10 +337,17 @@ void input_report_switch_pro(uint8_t dev_addr, uint8_t instance, uint8_t const*
 
       if (switch_devices[dev_addr].is_pro) {
         // Use calibrated scaling for Pro controllers
-        leftX = scale_analog_calibrated(update_report.left_x, inst->cal_lx.center);
-        leftY = 255 - scale_analog_calibrated(update_report.left_y, inst->cal_ly.center);   // Invert Y
-        rightX = scale_analog_calibrated(update_report.right_x, inst->cal_rx.center);
-        rightY = 255 - scale_analog_calibrated(update_report.right_y, inst->cal_ry.center); // Invert Y
+        if (lcal->valid && rcal->valid) {
+          leftX = switch_cal_stick_axis(lcal, 0, update_report.left_x);
+          leftY = 255 - switch_cal_stick_axis(lcal, 1, update_report.left_y);     // Invert Y
+          rightX = switch_cal_stick_axis(rcal, 0, update_report.right_x);
+          rightY = 255 - switch_cal_stick_axis(rcal, 1, update_report.right_y);   // Invert Y
+        } else {
+          leftX = scale_analog_calibrated(update_report.left_x, inst->cal_lx.center);
+          leftY = 255 - scale_analog_calibrated(update_report.left_y, inst->cal_ly.center);   // Invert Y
+          rightX = scale_analog_calibrated(update_report.right_x, inst->cal_rx.center);
+          rightY = 255 - scale_analog_calibrated(update_report.right_y, inst->cal_ry.center); // Invert Y
+        }
       } else {
         bool is_left_joycon = (!update_report.right_x && !update_report.right_y);
         bool is_right_joycon = (!update_report.left_x && !update_report.left_y);
@@ -300,8 +359,13 @@ void input_report_switch_pro(uint8_t dev_addr, uint8_t instance, uint8_t const*
           bttn_l1 = update_report.l;
           bttn_s2 = false;
 
-          leftX = scale_analog_joycon(update_report.left_x + 127);
-          leftY = 255 - scale_analog_joycon(update_report.left_y - 127);  // Invert Y
+          if (lcal->valid) {
+            leftX = switch_cal_stick_axis(lcal, 0, update_report.left_x);
+            leftY = 255 - switch_cal_stick_axis(lcal, 1, update_report.left_y);  // Invert Y
+          } else {
+            leftX = scale_analog_joycon(update_report.left_x + 127);
+            leftY = 255 - scale_analog_joycon(update_report.left_y - 127);  // Invert Y
+          }
         }
         else if (is_right_joycon)
         {
@@ -311,8 +375,13 @@ void input_report_switch_pro(uint8_t dev_addr, uint8_t instance, uint8_t const*
           dpad_left  = false; // (right_stick_x < (2048 - threshold));
           bttn_a1 = false;
 
-          rightX = scale_analog_joycon(update_report.right_x);
-          rightY = 255 - scale_analog_joycon(update_report.right_y + 127);  // Invert Y
+          if (rcal->valid) {
+            rightX = switch_cal_stick_axis(rcal, 0, update_report.right_x);
+            rightY = 255 - switch_cal_stick_axis(rcal, 1, update_report.right_y);  // Invert Y
+          } else {
+            rightX = scale_analog_joycon(update_report.right_x);
+            rightY = 255 - scale_analog_joycon(update_report.right_y + 127);  // Invert Y
+          }
         }
       }
 
@@ -387,7 +456,27 @@ void input_report_switch_pro(uint8_t dev_addr, uint8_t instance, uint8_t const*
         .battery_level = bat_level,
         .battery_charging = bat_charging,
       };
-      router_submit_input(&event);
+
+      // IMU: submit one event per new sample, oldest first, so per-event
+      // consumers (router taps) see motion at the sensor's 5 ms rate rather
+      // than one sample per report. A report with no new frame resends the
+      // newest sample so motion state never drops out.
+      if (inst->imu_enabled && update_report.report_id == 0x30 && len >= SWITCH_IMU_REPORT_MIN_LEN) {
+        const uint8_t* imu = &report[SWITCH_IMU_OFFSET];
+        uint8_t fresh = switch_cal_new_imu_frames(imu, inst->imu_last);
+
+        event.has_motion = true;
+        event.accel_range = SWITCH_IMU_ACCEL_RANGE;
+        event.gyro_range = SWITCH_IMU_GYRO_RANGE;
+        event.motion_dt_us = fresh ? SWITCH_IMU_SAMPLE_US : MOTION_DT_REPEAT;
+        if (fresh == 0) fresh = 1;
+        for (int i = fresh - 1; i >= 0; i--) {
+          switch_cal_imu_frame(&inst->cal.imu, &imu[i * SWITCH_IMU_FRAME_SIZE], event.accel, event.gyro);
+          router_submit_input(&event);
+        }
+      } else {
+        router_submit_input(&event);
+      }
 
       prev_report[dev_addr-1][instance] = update_report;
 
@@ -407,7 +496,18 @@ void input_report_switch_pro(uint8_t dev_addr, uint8_t instance, uint8_t const*
     // removal still arrives via TinyUSB's tuh_hid_umount_cb.
     if (state_report.buf[0] == 0x81 && state_report.buf[1] == 0x01) { // JC_USB_CMD_CONN_STATUS
       if (state_report.buf[2] == 0x00) { // connect
-        switch_devices[dev_addr].instances[instance].conn_ack = true;
+        switch_instance_t* inst = &switch_devices[dev_addr].instances[instance];
+        inst->conn_ack = true;
+
+        // 81 01 00 <type> <MAC, little endian>
+        if (!inst->has_mac && len >= 10) {
+          for (int i = 0; i < 6; i++) inst->mac[i] = state_report.buf[9 - i];
+          inst->has_mac = true;
+          if (switch_cal_cache_load(inst->mac, &inst->cal)) {
+            inst->cal_ready = true;
+            TU_LOG1("SWITCH[%d|%d]: Calibration from cache\r\n", dev_addr, instance);
+          }
+        }
       }
     }
     else if (state_report.buf[0] == 0x81 && state_report.buf[1] == 0x02) { // JC_USB_CMD_HANDSHAKE
@@ -447,6 +547,8 @@ void output_switch_pro(uint8_t dev_addr, uint8_t instance, device_output_config_
 
   if (true/*switch_devices[dev_addr].instances[instance].conn_ack*/) // bug fix for 3rd-party ctrls?
   {
+    switch_instance_t* inst = &switch_devices[dev_addr].instances[instance];
+
     // Stagger init when multiple HID interfaces belong to the same device
     // (Joy-Con Charging Grip exposes one per Joy-Con). Without this gate,
     // both instances race their handshake/disable_timeout/full_report_mode
@@ -470,7 +572,25 @@ void output_switch_pro(uint8_t dev_addr, uint8_t instance, device_output_config_
 
     // // wait for baud ask and then send init handshake
     // } else if (!switch_devices[dev_addr].instances[instance].handshake && switch_devices[dev_addr].instances[instance].baud_ack) {
-    if (!switch_devices[dev_addr].instances[instance].handshake) {
+
+    // Ask for status first: the reply carries the MAC, which keys the
+    // calibration cache. Controllers that never answer get the handshake
+    // after a short wait.
+    if (!inst->status_requested) {
+      TU_LOG1("SWITCH[%d|%d]: CMD_HID, STATUS\r\n", dev_addr, instance);
+
+      uint8_t status_command[2] = {CMD_HID, SUBCMD_STATUS};
+
+      inst->status_requested =
+        tuh_hid_send_report(dev_addr, instance, 0, status_command, sizeof(status_command));
+      inst->status_ms = platform_time_ms();
+
+      tuh_hid_receive_report(dev_addr, instance);
+
+    } else if (!switch_devices[dev_addr].instances[instance].handshake) {
+      if (!inst->has_mac && platform_time_ms() - inst->status_ms < STATUS_TIMEOUT_MS) {
+        return;
+      }
       TU_LOG1("SWITCH[%d|%d]: CMD_HID, HANDSHAKE\r\n", dev_addr, instance);
 
       uint8_t handshake_command[2] = {CMD_HID, SUBCMD_HANDSHAKE};
@@ -495,7 +615,7 @@ void output_switch_pro(uint8_t dev_addr, uint8_t instance, device_output_config_
     // wait for usb enabled acknowledgment
     } else if (switch_devices[dev_addr].instances[instance].usb_enable) {
 
-      uint8_t report[14] = { 0 };
+      uint8_t report[16] = { 0 };
       uint8_t report_size = 10;
 
       report[0x00] = CMD_RUMBLE_ONLY; // COMMAND
@@ -523,6 +643,42 @@ void output_switch_pro(uint8_t dev_addr, uint8_t instance, device_output_config_
           platform_sleep_ms(100);
         }
 
+      } else if (!inst->cal_ready) {
+        // Read stick/IMU calibration from SPI flash one region at a time
+        // before streaming starts. Replies are matched in the input path.
+        uint32_t now = platform_time_ms();
+        if (inst->cal_pending) {
+          if (now - inst->cal_sent_ms < CAL_READ_TIMEOUT_MS) return;
+          inst->cal_pending = false;
+          if (++inst->cal_retries > CAL_READ_RETRIES) {
+            TU_LOG1("SWITCH[%d|%d]: No SPI calibration reply, using defaults\r\n", dev_addr, instance);
+            inst->cal_ready = true;
+            return;
+          }
+        }
+
+        if (inst->cal_region >= SWITCH_CAL_REGION_COUNT) {
+          TU_LOG1("SWITCH[%d|%d]: Calibration read (sticks L=%d R=%d)\r\n", dev_addr, instance,
+                  inst->cal.stick[0].valid, inst->cal.stick[1].valid);
+          if (inst->has_mac) {
+            switch_cal_cache_store(inst->mac, &inst->cal);
+          }
+          inst->cal_ready = true;
+          return;
+        }
+
+        report_size = 16;
+
+        report[0x01] = output_sequence_counter++;
+        report[0x00] = CMD_AND_RUMBLE;              // COMMAND
+        report[0x0A + 0] = CMD_SPI_READ;            // SUB_COMMAND
+        switch_cal_spi_args(inst->cal_region, &report[0x0A + 1]);  // SUB_COMMAND ARGS
+
+        if (tuh_hid_send_report(dev_addr, instance, 0, report, report_size)) {
+          inst->cal_pending = true;
+          inst->cal_sent_ms = now;
+        }
+
       } else if (!switch_devices[dev_addr].instances[instance].full_report_enabled) {
         TU_LOG1("SWITCH[%d|%d]: CMD_AND_RUMBLE, CMD_MODE, FULL_REPORT_MODE \r\n", dev_addr, instance);
 
@@ -538,21 +694,22 @@ void output_switch_pro(uint8_t dev_addr, uint8_t instance, device_output_config_
           platform_sleep_ms(100);
         }
 
-      // } else if (!switch_devices[dev_addr].instances[instance].imu_enabled) {
-      //   TU_LOG1("SWITCH[%d|%d]: CMD_AND_RUMBLE, CMD_GYRO, 1 \r\n", dev_addr, instance);
+      } else if (!switch_devices[dev_addr].instances[instance].imu_enabled) {
+        TU_LOG1("SWITCH[%d|%d]: CMD_AND_RUMBLE, CMD_GYRO, 1 \r\n", dev_addr, instance);
 
-      //   report_size = 12;
+        report_size = 12;
 
-      //   report[0x00] = CMD_AND_RUMBLE; // COMMAND
-      //   report[0x0A + 0] = CMD_GYRO;   // SUB_COMMAND
-      //   report[0x0A + 1] = 1 ? 1 : 0;  // SUB_COMMAND ARGS
+        report[0x01] = output_sequence_counter++;
+        report[0x00] = CMD_AND_RUMBLE; // COMMAND
+        report[0x0A + 0] = CMD_GYRO;   // SUB_COMMAND
+        report[0x0A + 1] = 1;          // SUB_COMMAND ARGS
 
-      //   switch_devices[dev_addr].instances[instance].imu_enabled = true;
-      //   tuh_hid_send_report(dev_addr, instance, 0, report, report_size);
-      //   platform_sleep_ms(100);
+        if (tuh_hid_send_report(dev_addr, instance, 0, report, report_size)) {
+          switch_devices[dev_addr].instances[instance].imu_enabled = true;
+          platform_sleep_ms(100);
+        }
 
-      // } else if (switch_devices[dev_addr].instances[instance].imu_enabled) {
-      } else if (switch_devices[dev_addr].instances[instance].full_report_enabled) {
+      } else {
         // Use player_index from USB output interface config. Joy-Con
         // Charging Grip exposes both Joy-Cons as separate HID interfaces
         // but they share a single player slot at the root instance — so
@@ -656,6 +813,7 @@ static inline bool init_switch_pro(uint8_t dev_addr, uint8_t instance)
   switch_devices[dev_addr].instances[instance].rumble_left = 0xFF;
   switch_devices[dev_addr].instances[instance].rumble_right = 0xFF;
   switch_devices[dev_addr].instances[instance].player_led_set = 0xFF;
+  switch_cal_init(&switch_devices[dev_addr].instances[instance].cal);
   switch_devices[dev_addr].grip_side[instance] = -1;  // Unknown until first report
 
   if ((++switch_devices[dev_addr].instance_count) == 1) {
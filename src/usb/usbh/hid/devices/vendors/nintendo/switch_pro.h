@@ -8,6 +8,7 @@
 
 // commands
 #define CMD_HID 0x80
+#define SUBCMD_STATUS 0x01
 #define SUBCMD_HANDSHAKE 0x02
 #define SUBCMD_USB_BAUD 0x03
 #define SUBCMD_DISABLE_TIMEOUT 0x04
@@ -21,6 +22,7 @@
 #define CMD_LED_HOME 0x38
 #define CMD_GYRO 0x40
 #define CMD_MODE 0x03
+#define CMD_SPI_READ 0x10
 #define SUBCMD_FULL_REPORT_MODE 0x30
 
 extern DeviceInterface switch_pro_interface;
@@ -4,6 +4,7 @@
 
 #include "xbone_auth.h"
 #include "usb/usbd/drivers/xgip_protocol.h"
+#include "usb/usbd/drivers/xgip_pipe.h"
 #include "usb/usbd/drivers/tud_xbone.h"
 #include "platform/platform.h"
 #include "tusb.h"
@@ -17,6 +18,19 @@
 #define REPORT_QUEUE_SIZE      16
 #define REPORT_QUEUE_INTERVAL  15  // ms
 
+// Controller auth replies remembered per console request. Every exchange
+// is tracked by hash; once the same request has drawn the same reply
+// CONFIRM times, the reply bytes go into a shared pool and are served from
+// there. Replies carrying fresh randomness never qualify.
+#ifndef XBONE_AUTH_CACHE_ENTRIES
+#define XBONE_AUTH_CACHE_ENTRIES 16
+#endif
+#ifndef XBONE_AUTH_CACHE_BYTES
+#define XBONE_AUTH_CACHE_BYTES   2048
+#endif
+#define XBONE_AUTH_CACHE_CONFIRM 2
+#define SHADOW_TIMEOUT_MS        3000
+
 // Power-on and rumble commands for dongle initialization
 static const uint8_t xb1_power_on[] = {
     0x06, 0x62, 0x45, 0xb8, 0x77, 0x26, 0x2c, 0x55,
@@ -50,6 +64,55 @@ static uint8_t queue_tail = 0;
 static uint8_t queue_count = 0;
 static uint32_t last_report_queue_sent = 0;
 
+// Console auth messages stream to the controller through a windowed pipe,
+// pumped on every controller ACK instead of one packet per task pass
+static xgip_pipe_t host_pipe;
+static uint32_t host_pipe_logged = 0;
+
+// ACK waiting for the OUT endpoint
+static uint8_t pending_ack[64];
+static uint8_t pending_ack_len = 0;
+
+// Auth reply cache
+typedef struct {
+    bool     valid;
+    bool     dynamic;           // Same request drew a different reply: never serve
+    bool     stored;            // Reply bytes are in auth_cache_pool
+    uint8_t  seen;              // Identical replies observed
+    uint8_t  req_type;
+    uint16_t req_len;
+    uint32_t req_hash;
+    uint8_t  rsp_type;
+    uint16_t rsp_len;
+    uint32_t rsp_hash;
+    uint16_t rsp_offset;        // Into auth_cache_pool
+} auth_cache_entry_t;
+
+static auth_cache_entry_t auth_cache[XBONE_AUTH_CACHE_ENTRIES];
+static uint8_t auth_cache_pool[XBONE_AUTH_CACHE_BYTES];
+static uint16_t auth_cache_pool_used = 0;
+static uint8_t auth_cache_next = 0;
+static uint8_t controller_id[6];        // Address from the controller's ANNOUNCE
+static bool controller_id_valid = false;
+static uint8_t controller_auth_seq = 0; // Sequence of the controller's last auth reply
+
+// Last request forwarded to the controller, so its reply can be cached
+static struct {
+    bool     valid;
+    uint8_t  type;
+    uint16_t len;
+    uint32_t hash;
+} last_request;
+
+// A cached reply went to the console while the controller answers the same
+// request anyway (keeping its auth state in step). That reply is checked
+// against the cache and dropped; the console's next request waits for it.
+static struct {
+    bool     active;
+    uint8_t  entry;
+    uint32_t start_ms;
+} shadow;
+
 // ============================================================================
 // HELPER FUNCTIONS
 // ============================================================================
@@ -71,6 +134,46 @@ static void queue_host_report(uint8_t* report, uint16_t len)
 extern bool tuh_xinput_send_report(uint8_t dev_addr, uint8_t instance,
                                    uint8_t const* report, uint16_t len);
 
+static bool host_pipe_send(const uint8_t* packet, uint16_t len)
+{
+    return xbone_dev_addr != 0 &&
+           tuh_xinput_send_report(xbone_dev_addr, xbone_instance, packet, len);
+}
+
+// Generate first: the length is only valid afterwards, and argument
+// evaluation order is unspecified
+static void queue_host_packet(xgip_t* xgip)
+{
+    uint8_t* packet = xgip_generate_packet(xgip);
+    queue_host_report(packet, xgip_get_packet_length(xgip));
+}
+
+static void flush_ack(void)
+{
+    if (pending_ack_len && host_pipe_send(pending_ack, pending_ack_len)) {
+        pending_ack_len = 0;
+    }
+}
+
+// ACKs go out from the receive callback, ahead of the paced queue; the
+// controller holds its next chunk until it sees one
+static void send_ack(xgip_t* xgip)
+{
+    uint8_t* report = xgip_generate_ack(xgip);
+    uint16_t len = xgip_get_packet_length(xgip);
+
+    if (!dongle_ready) {
+        // Nothing reaches the controller before power-on; the queue holds it
+        queue_host_report(report, len);
+        return;
+    }
+
+    // A newer ACK supersedes one still waiting for the endpoint
+    memcpy(pending_ack, report, len);
+    pending_ack_len = (uint8_t)len;
+    flush_ack();
+}
+
 static bool send_to_dongle(uint8_t* report, uint16_t len)
 {
     if (xbone_dev_addr == 0) {
@@ -83,6 +186,173 @@ static bool send_to_dongle(uint8_t* report, uint16_t len)
     return result;
 }
 
+// ============================================================================
+// AUTH REPLY CACHE
+// ============================================================================
+
+static uint32_t auth_hash(uint8_t type, const uint8_t* data, uint16_t len)
+{
+    uint32_t h = 2166136261u ^ type;
+    for (uint16_t i = 0; i < len; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void auth_cache_clear(void)
+{
+    memset(auth_cache, 0, sizeof(auth_cache));
+    auth_cache_pool_used = 0;
+    auth_cache_next = 0;
+}
+
+static int auth_cache_find(uint8_t type, uint16_t len, uint32_t hash)
+{
+    for (int i = 0; i < XBONE_AUTH_CACHE_ENTRIES; i++) {
+        auth_cache_entry_t* e = &auth_cache[i];
+        if (e->valid && e->req_type == type && e->req_len == len && e->req_hash == hash) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Record the controller's reply to last_request
+static void auth_cache_store(uint8_t type, const uint8_t* data, uint16_t len)
+{
+    if (!last_request.valid) {
+        return;
+    }
+    last_request.valid = false;
+
+    uint32_t rsp_hash = auth_hash(type, data, len);
+    int i = auth_cache_find(last_request.type, last_request.len, last_request.hash);
+    if (i >= 0) {
+        auth_cache_entry_t* e = &auth_cache[i];
+        if (e->rsp_type != type || e->rsp_len != len || e->rsp_hash != rsp_hash) {
+            e->dynamic = true;
+            return;
+        }
+        if (e->seen < 255) {
+            e->seen++;
+        }
+        if (!e->stored && !e->dynamic && e->seen >= XBONE_AUTH_CACHE_CONFIRM &&
+            auth_cache_pool_used + len <= XBONE_AUTH_CACHE_BYTES) {
+            memcpy(&auth_cache_pool[auth_cache_pool_used], data, len);
+            e->rsp_offset = auth_cache_pool_used;
+            auth_cache_pool_used += len;
+            e->stored = true;
+        }
+        return;
+    }
+
+    // New exchange: take the next slot not holding a stored reply
+    for (int k = 0; k < XBONE_AUTH_CACHE_ENTRIES; k++) {
+        uint8_t slot = (auth_cache_next + k) % XBONE_AUTH_CACHE_ENTRIES;
+        auth_cache_entry_t* e = &auth_cache[slot];
+        if (e->stored) {
+            continue;
+        }
+        auth_cache_next = (slot + 1) % XBONE_AUTH_CACHE_ENTRIES;
+        memset(e, 0, sizeof(*e));
+        e->valid = true;
+        e->seen = 1;
+        e->req_type = last_request.type;
+        e->req_len = last_request.len;
+        e->req_hash = last_request.hash;
+        e->rsp_type = type;
+        e->rsp_len = len;
+        e->rsp_hash = rsp_hash;
+        return;
+    }
+}
+
+// Controller answered a request the console already got from the cache
+static void shadow_finish(uint8_t type, const uint8_t* data, uint16_t len)
+{
+    auth_cache_entry_t* e = &auth_cache[shadow.entry];
+    shadow.active = false;
+    if (e->rsp_type != type || e->rsp_len != len || e->rsp_hash != auth_hash(type, data, len)) {
+        printf("[xbone_auth] Cached auth reply 0x%02x no longer matches controller, dropping it\n",
+               e->rsp_type);
+        e->dynamic = true;
+    }
+}
+
+// ============================================================================
+// AUTH FORWARDING
+// ============================================================================
+
+// Console message fully handed to the endpoint -> IDLE (as the per-pass path did)
+static void host_check_sent(void)
+{
+    if (xbone_auth_get_state() == XBONE_AUTH_WAIT_CONSOLE_TO_DONGLE && xgip_pipe_sent(&host_pipe)) {
+        printf("[xbone_auth] Auth challenge sent, waiting for controller response\n");
+        xbone_auth_set_data(xbone_auth_get_buffer(), xbone_auth_get_length(),
+                           xbone_auth_get_sequence(), xbone_auth_get_type(),
+                           XBONE_AUTH_IDLE);
+    }
+    if (!xgip_pipe_busy(&host_pipe) && host_pipe_logged != host_pipe.messages) {
+        host_pipe_logged = host_pipe.messages;
+        printf("[xbone_auth] Auth 0x%02x sent to controller in %lu ms (%lu ACK timeouts)\n",
+               host_pipe.command, (unsigned long)host_pipe.last_ms,
+               (unsigned long)host_pipe.ack_timeouts);
+    }
+}
+
+static void host_pump(void)
+{
+    flush_ack();
+    xgip_pipe_pump(&host_pipe, host_pipe_send, platform_time_ms());
+    host_check_sent();
+}
+
+// Start forwarding a console auth message, answering from the cache when the
+// controller's reply to it is known to be static
+static void forward_console_message(void)
+{
+    if (!dongle_ready || xbone_dev_addr == 0 || shadow.active ||
+        xbone_auth_get_state() != XBONE_AUTH_SEND_CONSOLE_TO_DONGLE) {
+        return;
+    }
+
+    uint8_t type = xbone_auth_get_type();
+    uint8_t seq = xbone_auth_get_sequence();
+    uint16_t len = xbone_auth_get_length();
+    uint8_t* buf = xbone_auth_get_buffer();
+    uint32_t now = platform_time_ms();
+
+    printf("[xbone_auth] Forwarding auth challenge to controller: type=0x%02x len=%d seq=%d\n",
+           type, len, seq);
+
+    // The pipe keeps its own copy, so auth_data is free for the reply
+    xgip_pipe_start(&host_pipe, type, seq, len > GIP_MAX_CHUNK_SIZE, len > 2, buf, len, now);
+
+    uint32_t hash = auth_hash(type, buf, len);
+    int hit = auth_cache_find(type, len, hash);
+    if (hit >= 0 && auth_cache[hit].stored && !auth_cache[hit].dynamic) {
+        auth_cache_entry_t* e = &auth_cache[hit];
+        shadow.active = true;
+        shadow.entry = (uint8_t)hit;
+        shadow.start_ms = now;
+        last_request.valid = false;
+
+        if (++controller_auth_seq == 0) controller_auth_seq = 1;
+        printf("[xbone_auth] Auth 0x%02x answered from cache (%d bytes)\n", type, e->rsp_len);
+        xbone_auth_set_data(&auth_cache_pool[e->rsp_offset], e->rsp_len, controller_auth_seq,
+                           e->rsp_type, XBONE_AUTH_SEND_DONGLE_TO_CONSOLE);
+        tud_xbone_auth_kick();
+    } else {
+        last_request.valid = true;
+        last_request.type = type;
+        last_request.len = len;
+        last_request.hash = hash;
+        xbone_auth_set_data(buf, len, seq, type, XBONE_AUTH_WAIT_CONSOLE_TO_DONGLE);
+    }
+
+    host_pump();
+}
+
 // ============================================================================
 // PUBLIC API
 // ============================================================================
@@ -99,6 +369,20 @@ void xbone_auth_init(void)
     queue_head = 0;
     queue_tail = 0;
     queue_count = 0;
+
+    xgip_pipe_init(&host_pipe);
+    host_pipe_logged = 0;
+    pending_ack_len = 0;
+    auth_cache_clear();
+    controller_id_valid = false;
+    last_request.valid = false;
+    shadow.active = false;
+}
+
+// Console auth message complete (called from the device OUT callback)
+void xbone_auth_console_message(void)
+{
+    forward_console_message();
 }
 
 bool xbone_auth_is_available(void)
@@ -134,39 +418,21 @@ void xbone_auth_task(void)
         return;
     }
 
-    if (state == XBONE_AUTH_SEND_CONSOLE_TO_DONGLE) {
-        printf("[xbone_auth] Forwarding auth challenge to controller: type=0x%02x len=%d seq=%d\n",
-               xbone_auth_get_type(), xbone_auth_get_length(), xbone_auth_get_sequence());
-
-        uint8_t is_chunked = (xbone_auth_get_length() > GIP_MAX_CHUNK_SIZE);
-        uint8_t needs_ack = (xbone_auth_get_length() > 2);
-
-        xgip_reset(&outgoing_xgip);
-        xgip_set_attributes(&outgoing_xgip, xbone_auth_get_type(),
-                           xbone_auth_get_sequence(), 1, is_chunked, needs_ack);
-        xgip_set_data(&outgoing_xgip, xbone_auth_get_buffer(), xbone_auth_get_length());
+    uint32_t now = platform_time_ms();
 
-        // Update state to waiting
-        xbone_auth_set_data(xbone_auth_get_buffer(), xbone_auth_get_length(),
-                           xbone_auth_get_sequence(), xbone_auth_get_type(),
-                           XBONE_AUTH_WAIT_CONSOLE_TO_DONGLE);
-
-    } else if (state == XBONE_AUTH_WAIT_CONSOLE_TO_DONGLE) {
-        uint8_t* packet = xgip_generate_packet(&outgoing_xgip);
-        uint8_t packet_len = xgip_get_packet_length(&outgoing_xgip);
-        printf("[xbone_auth] Sending auth packet to controller: len=%d\n", packet_len);
-        queue_host_report(packet, packet_len);
-
-        if (!xgip_is_chunked(&outgoing_xgip) || xgip_end_of_chunk(&outgoing_xgip)) {
-            printf("[xbone_auth] Auth challenge sent, waiting for controller response\n");
-            xbone_auth_set_data(xbone_auth_get_buffer(), xbone_auth_get_length(),
-                               xbone_auth_get_sequence(), xbone_auth_get_type(),
-                               XBONE_AUTH_IDLE);
-        }
+    // Controller never answered a shadowed request: stop waiting for it
+    if (shadow.active && (now - shadow.start_ms) > SHADOW_TIMEOUT_MS) {
+        printf("[xbone_auth] No controller reply to cached auth request\n");
+        shadow.active = false;
     }
 
+    // Normally forwarded straight from the device callback; this picks up a
+    // message that arrived before the source was ready or during a shadow,
+    // and keeps the pipe moving past a busy endpoint or lost ACK
+    forward_console_message();
+    host_pump();
+
     // Process report queue - send to controller
-    uint32_t now = platform_time_ms();
     if (queue_count > 0 && (now - last_report_queue_sent) > REPORT_QUEUE_INTERVAL) {
         uint8_t report[64];
         uint16_t len = report_queue[queue_head].len;
@@ -178,8 +444,9 @@ void xbone_auth_task(void)
             queue_count--;
             last_report_queue_sent = now;
         } else {
+            // Endpoint busy (often with auth chunks) - retry after the interval
             printf("[xbone_auth] Failed to send report to controller\n");
-            platform_sleep_ms(REPORT_QUEUE_INTERVAL);
+            last_report_queue_sent = now;
         }
     }
 }
@@ -192,6 +459,10 @@ void xbone_auth_register(uint8_t dev_addr, uint8_t instance)
 
     xgip_reset(&incoming_xgip);
     xgip_reset(&outgoing_xgip);
+    xgip_pipe_abort(&host_pipe);
+    pending_ack_len = 0;
+    last_request.valid = false;
+    shadow.active = false;
 
     // Ready only after the real announce → descriptor → POWER_ON handshake
     // completes (matches GP2040-CE). The source drives this at its own pace.
@@ -206,6 +477,9 @@ void xbone_auth_unregister(uint8_t dev_addr)
         // Don't reset dongle_ready - Magic-X may remount but still be ready
         xbone_dev_addr = 0;
         xbone_instance = 0;
+        xgip_pipe_abort(&host_pipe);
+        pending_ack_len = 0;
+        shadow.active = false;
     }
 }
 
@@ -236,6 +510,14 @@ void xbone_auth_report_received(uint8_t dev_addr, uint8_t instance,
         return;
     }
 
+    // Trailing end-of-chunk marker for a message that already completed on
+    // its byte count: nothing left to do (and not worth the invalid-packet
+    // wait below, which would stall the relay on every chunked reply)
+    if (len >= 4 && (report[1] & 0x80) && report[3] == 0 &&
+        xgip_get_data_length(&incoming_xgip) == 0) {
+        return;
+    }
+
     xgip_parse(&incoming_xgip, report, len);
 
     if (!xgip_validate(&incoming_xgip)) {
@@ -255,19 +537,29 @@ void xbone_auth_report_received(uint8_t dev_addr, uint8_t instance,
                      (cmd == GIP_AUTH || cmd == GIP_FINAL_AUTH);
     if (xgip_ack_required(&incoming_xgip) || force_ack) {
         printf("[xbone_auth] Sending ACK to controller (forced=%d)\n", force_ack && !xgip_ack_required(&incoming_xgip));
-        queue_host_report(xgip_generate_ack(&incoming_xgip),
-                         xgip_get_packet_length(&incoming_xgip));
+        send_ack(&incoming_xgip);
     }
 
     printf("[xbone_auth] Parsed command: 0x%02x\n", cmd);
 
     switch (cmd) {
         case GIP_ANNOUNCE:
+            // Cached auth replies belong to one controller; its announce
+            // starts with its address
+            if (xgip_get_data_length(&incoming_xgip) >= sizeof(controller_id) &&
+                xgip_get_data(&incoming_xgip)) {
+                const uint8_t* id = xgip_get_data(&incoming_xgip);
+                if (!controller_id_valid || memcmp(id, controller_id, sizeof(controller_id)) != 0) {
+                    auth_cache_clear();
+                    memcpy(controller_id, id, sizeof(controller_id));
+                    controller_id_valid = true;
+                }
+            }
+
             // Dongle announced - request descriptor
             xgip_reset(&outgoing_xgip);
             xgip_set_attributes(&outgoing_xgip, GIP_DEVICE_DESCRIPTOR, 1, 1, false, 0);
-            queue_host_report(xgip_generate_packet(&outgoing_xgip),
-                             xgip_get_packet_length(&outgoing_xgip));
+            queue_host_packet(&outgoing_xgip);
             break;
 
         case GIP_DEVICE_DESCRIPTOR:
@@ -277,24 +569,24 @@ void xbone_auth_report_received(uint8_t dev_addr, uint8_t instance,
                 xgip_reset(&outgoing_xgip);
                 xgip_set_attributes(&outgoing_xgip, GIP_POWER_MODE_DEVICE_CONFIG, 2, 1, false, 0);
                 xgip_set_data(&outgoing_xgip, xb1_power_on, sizeof(xb1_power_on));
-                queue_host_report(xgip_generate_packet(&outgoing_xgip),
-                                 xgip_get_packet_length(&outgoing_xgip));
+                queue_host_packet(&outgoing_xgip);
 
                 xgip_reset(&outgoing_xgip);
                 xgip_set_attributes(&outgoing_xgip, GIP_POWER_MODE_DEVICE_CONFIG, 3, 1, false, 0);
                 xgip_set_data(&outgoing_xgip, xb1_power_on_single, sizeof(xb1_power_on_single));
-                queue_host_report(xgip_generate_packet(&outgoing_xgip),
-                                 xgip_get_packet_length(&outgoing_xgip));
+                queue_host_packet(&outgoing_xgip);
 
                 // Send rumble command to enable dongle
                 xgip_reset(&outgoing_xgip);
                 xgip_set_attributes(&outgoing_xgip, GIP_CMD_RUMBLE, 1, 0, false, 0);
                 xgip_set_data(&outgoing_xgip, xb1_rumble_on, sizeof(xb1_rumble_on));
-                queue_host_report(xgip_generate_packet(&outgoing_xgip),
-                                 xgip_get_packet_length(&outgoing_xgip));
+                queue_host_packet(&outgoing_xgip);
 
                 dongle_ready = true;
                 printf("[xbone_auth] Dongle ready!\n");
+
+                // Console may already be waiting on its first challenge
+                forward_console_message();
             }
             break;
 
@@ -312,18 +604,40 @@ void xbone_auth_report_received(uint8_t dev_addr, uint8_t instance,
             if (!xgip_is_chunked(&incoming_xgip) ||
                 (xgip_is_chunked(&incoming_xgip) && xgip_end_of_chunk(&incoming_xgip))) {
 
+                controller_auth_seq = xgip_get_sequence(&incoming_xgip);
+
+                if (shadow.active) {
+                    // Console already has this reply from the cache
+                    shadow_finish(cmd, xgip_get_data(&incoming_xgip),
+                                  xgip_get_data_length(&incoming_xgip));
+                    xgip_reset(&incoming_xgip);
+                    forward_console_message();
+                    break;
+                }
+
                 printf("[xbone_auth] Forwarding auth response to console: len=%d seq=%d\n",
                        xgip_get_data_length(&incoming_xgip), xgip_get_sequence(&incoming_xgip));
+                auth_cache_store(cmd, xgip_get_data(&incoming_xgip),
+                                 xgip_get_data_length(&incoming_xgip));
                 xbone_auth_set_data(xgip_get_data(&incoming_xgip),
                                    xgip_get_data_length(&incoming_xgip),
                                    xgip_get_sequence(&incoming_xgip),
                                    xgip_get_command(&incoming_xgip),
                                    XBONE_AUTH_SEND_DONGLE_TO_CONSOLE);
                 xgip_reset(&incoming_xgip);
+
+                // Straight on to the console from this callback
+                tud_xbone_auth_kick();
             }
             break;
 
         case GIP_ACK_RESPONSE:
+            // Opens the window for the next chunks of a console message
+            if (xgip_pipe_ack(&host_pipe, report, len, platform_time_ms())) {
+                host_pump();
+            }
+            break;
+
         default:
             break;
     }
@@ -38,6 +38,10 @@ void xbone_auth_unregister(uint8_t dev_addr);
 void xbone_auth_report_received(uint8_t dev_addr, uint8_t instance,
                                 uint8_t const* report, uint16_t len);
 
+// Called by the device driver when a console auth message is complete, so it
+// can be forwarded without waiting for the next task pass
+void xbone_auth_console_message(void);
+
 // Called on xinput mount to check for Xbox One dongle
 void xbone_auth_xmount(uint8_t dev_addr, uint8_t instance,
                        uint8_t controller_type, uint8_t subtype);
@@ -221,6 +221,11 @@ typedef struct __attribute__((packed)) {
     uint8_t b;                  // Blue (0-255)
 } jocp_rgb_led_cmd_t;
 
+// Poll rate command payload
+typedef struct __attribute__((packed)) {
+    uint16_t rate_hz;           // Max INPUT packets per second (0 = no limit)
+} jocp_poll_rate_cmd_t;
+
 // ============================================================================
 // JOCP API
 // ============================================================================
@@ -5,6 +5,7 @@
 // Parses JOCP INPUT packets and converts them to Joypad OS input events.
 
 #include "jocp.h"
+#include "jocp_packet.h"
 #include "wifi_transport.h"
 #include "core/router/router.h"
 #include "core/buttons.h"
@@ -314,56 +315,23 @@ void jocp_send_feedback(uint8_t controller_id, const output_feedback_t* fb)
         return;
     }
 
-    // Build OUTPUT_CMD packet for rumble
-    // Always send when feedback is dirty (includes rumble=0 to stop)
-    {
-        uint8_t packet[32];
-        jocp_header_t* header = (jocp_header_t*)packet;
-
-        header->magic = JOCP_MAGIC;
-        header->version = JOCP_VERSION;
-        header->msg_type = JOCP_MSG_OUTPUT_CMD;
-        header->seq = 0;  // Not used for output
-        header->flags = 0;
-        header->timestamp_us = time_us_32();
-
-        // Rumble command
-        uint8_t* cmd = packet + sizeof(jocp_header_t);
-        cmd[0] = JOCP_CMD_RUMBLE;
-        jocp_rumble_cmd_t* rumble = (jocp_rumble_cmd_t*)(cmd + 1);
-        rumble->left_amplitude = fb->rumble_left;
-        rumble->left_brake = 0;
-        rumble->right_amplitude = fb->rumble_right;
-        rumble->right_brake = 0;
-        rumble->duration_ms = 0;  // Until changed
-
-        uint16_t len = sizeof(jocp_header_t) + 1 + sizeof(jocp_rumble_cmd_t);
-
-        printf("[jocp] Sending rumble via TCP: L=%d R=%d\n", fb->rumble_left, fb->rumble_right);
+    // Rumble: always sent when feedback is dirty (includes rumble=0 to stop)
+    uint8_t packet[JOCP_OUTPUT_CMD_MAX];
+    jocp_rumble_cmd_t rumble = {
+        .left_amplitude = fb->rumble_left,
+        .right_amplitude = fb->rumble_right,
+        .duration_ms = 0,  // Until changed
+    };
+    uint16_t len = jocp_packet_build_output_cmd(packet, JOCP_CMD_RUMBLE, &rumble, time_us_32());
 
-        wifi_transport_send_tcp(tcp_client, packet, len);
-    }
+    printf("[jocp] Sending rumble via TCP: L=%d R=%d\n", fb->rumble_left, fb->rumble_right);
+
+    wifi_transport_send_tcp(tcp_client, packet, len);
 
     // Send RGB LED command if any color is set
     if (fb->led_r > 0 || fb->led_g > 0 || fb->led_b > 0) {
-        uint8_t packet[32];
-        jocp_header_t* header = (jocp_header_t*)packet;
-
-        header->magic = JOCP_MAGIC;
-        header->version = JOCP_VERSION;
-        header->msg_type = JOCP_MSG_OUTPUT_CMD;
-        header->seq = 0;
-        header->flags = 0;
-        header->timestamp_us = time_us_32();
-
-        uint8_t* cmd = packet + sizeof(jocp_header_t);
-        cmd[0] = JOCP_CMD_RGB_LED;
-        jocp_rgb_led_cmd_t* rgb = (jocp_rgb_led_cmd_t*)(cmd + 1);
-        rgb->r = fb->led_r;
-        rgb->g = fb->led_g;
-        rgb->b = fb->led_b;
-
-        uint16_t len = sizeof(jocp_header_t) + 1 + sizeof(jocp_rgb_led_cmd_t);
+        jocp_rgb_led_cmd_t rgb = { .r = fb->led_r, .g = fb->led_g, .b = fb->led_b };
+        len = jocp_packet_build_output_cmd(packet, JOCP_CMD_RGB_LED, &rgb, time_us_32());
 
         printf("[jocp] Sending RGB LED via TCP: R=%d G=%d B=%d\n", fb->led_r, fb->led_g, fb->led_b);
 
@@ -0,0 +1,397 @@
+// jocp_output.c - JOCP Output (WiFi controller)
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// The reverse of wifi2usb: the CYW43 joins a dongle's AP as a station,
+// router output goes to it as UDP INPUT packets, and OUTPUT_CMD feedback
+// (rumble, LEDs, poll rate) comes back on the TCP control channel.
+// jocp_sender.c decides what goes out and when; this file moves bytes.
+//
+// Latency over battery: CYW43 power-save is off while associated, since
+// a sleeping radio holds each packet until its next wake.
+
+#include "jocp_output.h"
+#include "jocp_sender.h"
+#include "core/router/router.h"
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "cyw43.h"
+
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/tcp.h"
+#include "lwip/netif.h"
+#include "lwip/ip4_addr.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+#define SSID_PREFIX         "JOYPAD-"
+#define JOIN_TIMEOUT_MS     15000
+#define RETRY_MS            2000    // Before joining again, or reopening TCP
+
+typedef enum {
+    LINK_OFF,                   // CYW43 not brought up yet
+    LINK_SCAN,                  // Looking for a dongle
+    LINK_JOIN,                  // Associating, then DHCP
+    LINK_UP,                    // Sending
+    LINK_WAIT,                  // Backing off before the next try
+    LINK_FAILED,                // No radio or no lwIP memory: gave up
+} link_state_t;
+
+static link_state_t link_state = LINK_OFF;
+static uint32_t link_state_ms;
+
+static char ssid[33];
+static char password[64];
+static char found_ssid[33];     // Best dongle of the running scan
+static int16_t found_rssi;
+
+static jocp_sender_t sender;
+
+static ip_addr_t dongle_addr;
+static struct udp_pcb* udp_pcb;
+static struct tcp_pcb* tcp_pcb;
+static uint32_t tcp_opened_ms;
+
+// One INPUT pbuf for the whole session, rewritten in place for every
+// packet instead of a pbuf_alloc() per send
+static struct pbuf* tx_pbuf;
+static uint8_t* tx_data;
+
+static void tcp_open(void);
+static void tcp_drop(void);
+
+static void set_link_state(link_state_t state)
+{
+    link_state = state;
+    link_state_ms = to_ms_since_boot(get_absolute_time());
+}
+
+// ============================================================================
+// ROUTER TAP
+// ============================================================================
+
+// Only records the state: the task sends once per pass, so several router
+// updates between two passes go out as one packet
+static void jocp_output_tap(output_target_t output, uint8_t player_index,
+                            const input_event_t* event)
+{
+    (void)output;
+    if (player_index != 0) return;
+    jocp_sender_set_state(&sender, event);
+}
+
+// ============================================================================
+// ASSOCIATION
+// ============================================================================
+
+// Password wifi2usb derives from its SSID suffix (JOYPAD-A7B3 -> A7B3A7B3)
+static void derive_password(void)
+{
+    const char* suffix = ssid + strlen(SSID_PREFIX);
+    snprintf(password, sizeof(password), "%s%s", suffix, suffix);
+}
+
+static int scan_result(void* env, const cyw43_ev_scan_result_t* result)
+{
+    (void)env;
+    const size_t prefix_len = strlen(SSID_PREFIX);
+
+    if (!result || result->ssid_len <= prefix_len || result->ssid_len >= sizeof(found_ssid)) return 0;
+    if (memcmp(result->ssid, SSID_PREFIX, prefix_len) != 0) return 0;
+    if (found_ssid[0] && result->rssi <= found_rssi) return 0;
+
+    memcpy(found_ssid, result->ssid, result->ssid_len);
+    found_ssid[result->ssid_len] = '\0';
+    found_rssi = result->rssi;
+    return 0;
+}
+
+static void start_scan(void)
+{
+    found_ssid[0] = '\0';
+    cyw43_wifi_scan_options_t opts = {0};
+    if (cyw43_wifi_scan(&cyw43_state, &opts, NULL, scan_result) != 0) {
+        printf("[jocp_out] Scan failed to start\n");
+        set_link_state(LINK_WAIT);
+        return;
+    }
+    set_link_state(LINK_SCAN);
+}
+
+static void start_join(void)
+{
+    printf("[jocp_out] Joining %s\n", ssid);
+    if (cyw43_arch_wifi_connect_async(ssid, password, CYW43_AUTH_WPA2_AES_PSK) != 0) {
+        printf("[jocp_out] Join failed to start\n");
+        set_link_state(LINK_WAIT);
+        return;
+    }
+    set_link_state(LINK_JOIN);
+}
+
+static void link_up(void)
+{
+    // The dongle's DHCP server hands out its own address as the gateway
+    const ip4_addr_t* gw = netif_ip4_gw(&cyw43_state.netif[CYW43_ITF_STA]);
+    if (gw && !ip4_addr_isany(gw)) {
+        ip_addr_copy_from_ip4(dongle_addr, *gw);
+    } else {
+        IP_ADDR4(&dongle_addr, 192, 168, 4, 1);
+    }
+
+    cyw43_wifi_pm(&cyw43_state, CYW43_NONE_PM);
+
+    jocp_sender_restart(&sender);
+    tcp_open();
+    set_link_state(LINK_UP);
+
+    printf("[jocp_out] Connected to %s, dongle %s\n", ssid, ipaddr_ntoa(&dongle_addr));
+}
+
+static void link_down(void)
+{
+    printf("[jocp_out] Link to %s lost\n", ssid);
+    tcp_drop();
+    cyw43_wifi_pm(&cyw43_state, CYW43_DEFAULT_PM);
+    cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+    set_link_state(LINK_WAIT);
+}
+
+static bool bring_up(void)
+{
+    printf("[jocp_out] Initializing CYW43...\n");
+    if (cyw43_arch_init_with_country(CYW43_COUNTRY_USA)) {
+        printf("[jocp_out] ERROR: Failed to initialize CYW43\n");
+        return false;
+    }
+    cyw43_arch_enable_sta_mode();
+
+    udp_pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+    tx_pbuf = pbuf_alloc(PBUF_TRANSPORT, sizeof(jocp_input_packet_t), PBUF_RAM);
+    if (!udp_pcb || !tx_pbuf) {
+        printf("[jocp_out] ERROR: Out of lwIP memory\n");
+        return false;
+    }
+    tx_data = (uint8_t*)tx_pbuf->payload;
+
+    if (JOCP_OUTPUT_SSID[0]) {
+        snprintf(ssid, sizeof(ssid), "%s", JOCP_OUTPUT_SSID);
+        snprintf(password, sizeof(password), "%s", JOCP_OUTPUT_PASSWORD);
+        start_join();
+    } else {
+        printf("[jocp_out] Scanning for %sXXXX\n", SSID_PREFIX);
+        start_scan();
+    }
+    return true;
+}
+
+static void link_task(uint32_t now_ms)
+{
+    switch (link_state) {
+        case LINK_SCAN:
+            if (cyw43_wifi_scan_active(&cyw43_state)) break;
+            if (found_ssid[0]) {
+                memcpy(ssid, found_ssid, sizeof(ssid));
+                derive_password();
+            }
+            if (ssid[0]) {
+                start_join();
+            } else {
+                set_link_state(LINK_WAIT);
+            }
+            break;
+
+        case LINK_JOIN: {
+            int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+            if (status == CYW43_LINK_UP) {
+                link_up();
+            } else if (status < 0 || now_ms - link_state_ms >= JOIN_TIMEOUT_MS) {
+                printf("[jocp_out] Join %s failed (%d)\n", ssid, status);
+                cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+                set_link_state(LINK_WAIT);
+            }
+            break;
+        }
+
+        case LINK_UP:
+            if (cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA) != CYW43_LINK_UP) {
+                link_down();
+            } else if (!tcp_pcb && now_ms - tcp_opened_ms >= RETRY_MS) {
+                tcp_open();
+            }
+            break;
+
+        case LINK_WAIT:
+            if (now_ms - link_state_ms < RETRY_MS) break;
+            // Scan again unless the SSID is fixed; a hidden dongle that
+            // was joined before is still tried by name
+            if (JOCP_OUTPUT_SSID[0]) {
+                start_join();
+            } else {
+                start_scan();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// ============================================================================
+// INPUT (UDP)
+// ============================================================================
+
+static void send_input(uint32_t now_us)
+{
+    // Still queued behind an ARP request from the last send: the state
+    // stays pending and goes on a later pass
+    if (tx_pbuf->ref != 1) return;
+
+    // lwIP leaves the headers it prepended in front of the payload
+    if ((uint8_t*)tx_pbuf->payload != tx_data) {
+        pbuf_remove_header(tx_pbuf, (size_t)(tx_data - (uint8_t*)tx_pbuf->payload));
+    }
+
+    jocp_sender_build(&sender, (jocp_input_packet_t*)tx_data, now_us);
+    if (udp_sendto(udp_pcb, tx_pbuf, &dongle_addr, JOCP_DEFAULT_UDP_PORT) != ERR_OK) {
+        sender.dirty = true;    // Try again next pass
+    }
+}
+
+// ============================================================================
+// CONTROL CHANNEL (TCP)
+// ============================================================================
+
+static err_t tcp_recv_callback(void* arg, struct tcp_pcb* tpcb, struct pbuf* p, err_t err)
+{
+    (void)arg;
+
+    if (!p || err != ERR_OK) {
+        // Closed by the dongle; reopened after RETRY_MS
+        if (p) pbuf_free(p);
+        printf("[jocp_out] Control channel closed\n");
+        tcp_drop();
+        return ERR_ABRT;
+    }
+
+    uint32_t now_us = time_us_32();
+    for (struct pbuf* q = p; q; q = q->next) {
+        jocp_sender_receive(&sender, (const uint8_t*)q->payload, q->len, now_us);
+    }
+
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static void tcp_err_callback(void* arg, err_t err)
+{
+    (void)arg;
+    // lwIP has already freed the pcb
+    printf("[jocp_out] Control channel error %d\n", err);
+    tcp_pcb = NULL;
+}
+
+static err_t tcp_connected_callback(void* arg, struct tcp_pcb* tpcb, err_t err)
+{
+    (void)arg;
+    (void)tpcb;
+    if (err != ERR_OK) return err;
+
+    printf("[jocp_out] Control channel open\n");
+    jocp_cmd_parser_init(&sender.parser);
+    return ERR_OK;
+}
+
+static void tcp_open(void)
+{
+    tcp_opened_ms = to_ms_since_boot(get_absolute_time());
+
+    tcp_pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+    if (!tcp_pcb) return;
+
+    tcp_recv(tcp_pcb, tcp_recv_callback);
+    tcp_err(tcp_pcb, tcp_err_callback);
+    if (tcp_connect(tcp_pcb, &dongle_addr, JOCP_DEFAULT_TCP_PORT, tcp_connected_callback) != ERR_OK) {
+        tcp_abort(tcp_pcb);
+        tcp_pcb = NULL;
+    }
+}
+
+static void tcp_drop(void)
+{
+    if (!tcp_pcb) return;
+
+    tcp_recv(tcp_pcb, NULL);
+    tcp_err(tcp_pcb, NULL);
+    tcp_abort(tcp_pcb);
+    tcp_pcb = NULL;
+    tcp_opened_ms = to_ms_since_boot(get_absolute_time());
+}
+
+// ============================================================================
+// OUTPUT INTERFACE
+// ============================================================================
+
+static void jocp_output_init(void)
+{
+    // CYW43 comes up on the first task pass: its firmware load is slow,
+    // and outputs are initialized before stdio and the app
+    jocp_sender_init(&sender, JOCP_OUTPUT_HEARTBEAT_MS);
+    router_set_tap(OUTPUT_TARGET_JOCP, jocp_output_tap);
+}
+
+static void jocp_output_task(void)
+{
+    if (link_state == LINK_FAILED) return;
+    if (link_state == LINK_OFF && !bring_up()) {
+        link_state = LINK_FAILED;
+        return;
+    }
+
+    cyw43_arch_poll();
+
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    link_task(now_ms);
+
+    if (link_state == LINK_UP) {
+        uint32_t now_us = time_us_32();
+        if (jocp_sender_due(&sender, now_us)) {
+            send_input(now_us);
+        }
+    }
+}
+
+static bool jocp_output_get_feedback(output_feedback_t* fb)
+{
+    if (!fb) return false;
+    return jocp_sender_get_feedback(&sender, fb, time_us_32());
+}
+
+bool jocp_output_is_connected(void)
+{
+    return link_state == LINK_UP;
+}
+
+const OutputInterface jocp_output_interface = {
+    .name = "JOCP WiFi",
+    .target = OUTPUT_TARGET_JOCP,
+    .init = jocp_output_init,
+    .task = jocp_output_task,
+    .core1_task = NULL,
+    .get_feedback = jocp_output_get_feedback,
+    .get_rumble = NULL,
+    .get_player_led = NULL,
+    .get_profile_count = NULL,
+    .get_active_profile = NULL,
+    .set_active_profile = NULL,
+    .get_profile_name = NULL,
+    .get_trigger_threshold = NULL,
+};
@@ -0,0 +1,46 @@
+// jocp_output.h - JOCP Output (WiFi controller)
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// Sends router output to a Joypad dongle (wifi2usb) over JOCP, so a Pico W
+// build acts as a WiFi controller. Route inputs to OUTPUT_TARGET_JOCP.
+
+#ifndef JOCP_OUTPUT_H
+#define JOCP_OUTPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/output_interface.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+// Dongle to join. Left empty, the strongest JOYPAD-XXXX in range is taken
+// (wifi2usb broadcasts it while pairing) with the password wifi2usb
+// derives from the suffix. Once joined, the SSID is kept, so the dongle
+// is found again after it hides the SSID.
+#ifndef JOCP_OUTPUT_SSID
+#define JOCP_OUTPUT_SSID        ""
+#endif
+#ifndef JOCP_OUTPUT_PASSWORD
+#define JOCP_OUTPUT_PASSWORD    ""
+#endif
+
+// Unchanged state is resent this often. The dongle drops a controller
+// after 5 s of silence; this also bounds how long a lost packet holds a
+// stale state.
+#ifndef JOCP_OUTPUT_HEARTBEAT_MS
+#define JOCP_OUTPUT_HEARTBEAT_MS 250
+#endif
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+extern const OutputInterface jocp_output_interface;
+
+// True while associated with a dongle and sending
+bool jocp_output_is_connected(void);
+
+#endif // JOCP_OUTPUT_H
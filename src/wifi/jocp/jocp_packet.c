@@ -0,0 +1,220 @@
+// jocp_packet.c - JOCP packet building and parsing
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+
+#include "jocp_packet.h"
+#include "core/buttons.h"
+
+#include <string.h>
+
+// ============================================================================
+// BUTTON AND AXIS CONVERSION
+// ============================================================================
+
+// JP button -> JOCP button, the inverse of jocp_input.c's convert_buttons()
+static const struct {
+    uint32_t jp;
+    uint32_t jocp;
+} button_map[] = {
+    { JP_BUTTON_B1, JOCP_BTN_SOUTH },
+    { JP_BUTTON_B2, JOCP_BTN_EAST },
+    { JP_BUTTON_B3, JOCP_BTN_WEST },
+    { JP_BUTTON_B4, JOCP_BTN_NORTH },
+    { JP_BUTTON_DU, JOCP_BTN_DU },
+    { JP_BUTTON_DD, JOCP_BTN_DD },
+    { JP_BUTTON_DL, JOCP_BTN_DL },
+    { JP_BUTTON_DR, JOCP_BTN_DR },
+    { JP_BUTTON_L1, JOCP_BTN_L1 },
+    { JP_BUTTON_R1, JOCP_BTN_R1 },
+    { JP_BUTTON_L2, JOCP_BTN_L2 },
+    { JP_BUTTON_R2, JOCP_BTN_R2 },
+    { JP_BUTTON_L3, JOCP_BTN_L3 },
+    { JP_BUTTON_R3, JOCP_BTN_R3 },
+    { JP_BUTTON_S2, JOCP_BTN_START },
+    { JP_BUTTON_S1, JOCP_BTN_BACK },
+    { JP_BUTTON_A1, JOCP_BTN_GUIDE },
+    { JP_BUTTON_A2, JOCP_BTN_CAPTURE },
+    { JP_BUTTON_L4, JOCP_BTN_L_PADDLE1 },
+    { JP_BUTTON_R4, JOCP_BTN_R_PADDLE1 },
+};
+
+static uint32_t convert_buttons(uint32_t jp_buttons)
+{
+    uint32_t jocp_buttons = 0;
+    for (unsigned i = 0; i < sizeof(button_map) / sizeof(button_map[0]); i++) {
+        if (jp_buttons & button_map[i].jp) jocp_buttons |= button_map[i].jocp;
+    }
+    return jocp_buttons;
+}
+
+// 0-255 (128 = center) -> -32768..32767. Below center each step is 256;
+// above it the steps stretch slightly so 255 reaches 32767. Either way
+// (v + 32768) >> 8 on the dongle lands back on v.
+static int16_t convert_axis_u8_to_s16(uint8_t value)
+{
+    if (value >= 128) {
+        return (int16_t)(((int32_t)(value - 128) * 32767) / 127);
+    }
+    return (int16_t)(((int32_t)value - 128) * 256);
+}
+
+// 0-255 -> 0-65535, so 255 is a full pull and >> 8 gives the value back
+static uint16_t convert_trigger_u8_to_u16(uint8_t value)
+{
+    return (uint16_t)(value * 257);
+}
+
+// ============================================================================
+// BUILDING
+// ============================================================================
+
+void jocp_packet_header(jocp_header_t* header, uint8_t msg_type, uint16_t seq,
+                        uint16_t flags, uint32_t timestamp_us)
+{
+    header->magic = JOCP_MAGIC;
+    header->version = JOCP_VERSION;
+    header->msg_type = msg_type;
+    header->seq = seq;
+    header->flags = flags;
+    header->timestamp_us = timestamp_us;
+}
+
+uint16_t jocp_packet_encode_input(jocp_input_t* payload, const input_event_t* event)
+{
+    uint16_t flags = JOCP_FLAG_KEYFRAME;
+
+    memset(payload, 0, sizeof(*payload));
+
+    payload->buttons = convert_buttons(event->buttons);
+
+    payload->lx = convert_axis_u8_to_s16(event->analog[ANALOG_LX]);
+    payload->ly = convert_axis_u8_to_s16(event->analog[ANALOG_LY]);
+    payload->rx = convert_axis_u8_to_s16(event->analog[ANALOG_RX]);
+    payload->ry = convert_axis_u8_to_s16(event->analog[ANALOG_RY]);
+    payload->lt = convert_trigger_u8_to_u16(event->analog[ANALOG_L2]);
+    payload->rt = convert_trigger_u8_to_u16(event->analog[ANALOG_R2]);
+
+    if (event->has_motion) {
+        payload->accel_x = event->accel[0];
+        payload->accel_y = event->accel[1];
+        payload->accel_z = event->accel[2];
+        payload->gyro_x = event->gyro[0];
+        payload->gyro_y = event->gyro[1];
+        payload->gyro_z = event->gyro[2];
+        flags |= JOCP_FLAG_HAS_IMU;
+    }
+
+    if (event->has_touch) {
+        for (int i = 0; i < 2; i++) {
+            payload->touch[i].x = event->touch[i].x;
+            payload->touch[i].y = event->touch[i].y;
+            payload->touch[i].id_active = (uint8_t)i | (event->touch[i].active ? 0x80 : 0);
+        }
+        flags |= JOCP_FLAG_HAS_TOUCH;
+    }
+
+    payload->battery_level = event->battery_level;
+    payload->plug_status = event->battery_charging ? 0x01 : 0x00;
+    payload->controller_id = 0;   // The dongle tells controllers apart by IP
+
+    return flags;
+}
+
+int jocp_packet_cmd_len(uint8_t cmd)
+{
+    switch (cmd) {
+        case JOCP_CMD_RUMBLE:     return sizeof(jocp_rumble_cmd_t);
+        case JOCP_CMD_PLAYER_LED: return sizeof(jocp_player_led_cmd_t);
+        case JOCP_CMD_RGB_LED:    return sizeof(jocp_rgb_led_cmd_t);
+        case JOCP_CMD_POLL_RATE:  return sizeof(jocp_poll_rate_cmd_t);
+        default:                  return -1;
+    }
+}
+
+uint16_t jocp_packet_build_output_cmd(uint8_t* buf, uint8_t cmd, const void* payload,
+                                      uint32_t timestamp_us)
+{
+    int len = jocp_packet_cmd_len(cmd);
+    if (len < 0) return 0;
+
+    jocp_header_t header;
+    jocp_packet_header(&header, JOCP_MSG_OUTPUT_CMD, 0, 0, timestamp_us);  // seq unused for output
+    memcpy(buf, &header, sizeof(header));
+    buf[sizeof(header)] = cmd;
+    memcpy(buf + sizeof(header) + 1, payload, (size_t)len);
+
+    return (uint16_t)(sizeof(header) + 1 + len);
+}
+
+// ============================================================================
+// PARSING
+// ============================================================================
+
+void jocp_cmd_parser_init(jocp_cmd_parser_t* parser)
+{
+    parser->len = 0;
+    parser->dropped = 0;
+}
+
+static void consume(jocp_cmd_parser_t* parser, uint8_t count, bool dropped)
+{
+    memmove(parser->buf, parser->buf + count, parser->len - count);
+    parser->len -= count;
+    if (dropped) parser->dropped += count;
+}
+
+// One framing step on the buffered bytes. Returns false when it needs
+// more bytes to go further.
+static bool parse_step(jocp_cmd_parser_t* parser, jocp_cmd_callback_t callback, void* ctx)
+{
+    const uint8_t hdr = sizeof(jocp_header_t);
+
+    // Resync as early as the magic allows
+    if (parser->len >= 1 && parser->buf[0] != (JOCP_MAGIC & 0xFF)) {
+        consume(parser, 1, true);
+        return true;
+    }
+    if (parser->len >= 2 && parser->buf[1] != (JOCP_MAGIC >> 8)) {
+        consume(parser, 1, true);
+        return true;
+    }
+    if (parser->len < hdr) return false;
+
+    jocp_header_t header;
+    memcpy(&header, parser->buf, sizeof(header));
+    if (header.version != JOCP_VERSION) {
+        consume(parser, 1, true);
+        return true;
+    }
+
+    if (header.msg_type != JOCP_MSG_OUTPUT_CMD) {
+        // CAPS_REQ is a bare header; for anything else the length is
+        // unknown, so skip its header and resync on the next magic
+        consume(parser, hdr, header.msg_type != JOCP_MSG_CAPS_REQ);
+        return true;
+    }
+
+    if (parser->len < hdr + 1) return false;
+    uint8_t cmd = parser->buf[hdr];
+    int payload_len = jocp_packet_cmd_len(cmd);
+    if (payload_len < 0) {
+        consume(parser, hdr + 1, true);
+        return true;
+    }
+    if (parser->len < hdr + 1 + payload_len) return false;
+
+    callback(ctx, cmd, parser->buf + hdr + 1, (uint8_t)payload_len);
+    consume(parser, (uint8_t)(hdr + 1 + payload_len), false);
+    return true;
+}
+
+void jocp_cmd_parser_feed(jocp_cmd_parser_t* parser, const uint8_t* data, uint16_t len,
+                          jocp_cmd_callback_t callback, void* ctx)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        parser->buf[parser->len++] = data[i];
+        while (parser->len > 0) {
+            if (!parse_step(parser, callback, ctx)) break;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+// jocp_packet.h - JOCP packet building and parsing
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// The wire format for both ends of JOCP, with no pico-sdk or lwIP
+// dependency. The dongle (jocp_input.c) builds OUTPUT_CMDs with it; a
+// WiFi controller (jocp_output.c) builds INPUT packets and parses the
+// OUTPUT_CMD stream. tools/jocp-sender-loopback builds it for Linux.
+
+#ifndef JOCP_PACKET_H
+#define JOCP_PACKET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "jocp.h"
+#include "core/input_event.h"
+
+// Largest OUTPUT_CMD: header, command byte and the rumble payload
+#define JOCP_OUTPUT_CMD_MAX     (sizeof(jocp_header_t) + 1 + sizeof(jocp_rumble_cmd_t))
+
+// ============================================================================
+// BUILDING
+// ============================================================================
+
+void jocp_packet_header(jocp_header_t* header, uint8_t msg_type, uint16_t seq,
+                        uint16_t flags, uint32_t timestamp_us);
+
+// INPUT payload for a router output event. Returns the header flags it
+// needs (KEYFRAME, plus HAS_IMU / HAS_TOUCH). JP buttons with no JOCP bit
+// (A3, A4, F1, F2) are dropped. Axes are widened so that the dongle's
+// narrowing gives back the same 8-bit values.
+uint16_t jocp_packet_encode_input(jocp_input_t* payload, const input_event_t* event);
+
+// Payload length of an OUTPUT_CMD command, -1 if unknown
+int jocp_packet_cmd_len(uint8_t cmd);
+
+// OUTPUT_CMD packet into buf (JOCP_OUTPUT_CMD_MAX bytes). Returns its
+// length, 0 for an unknown command.
+uint16_t jocp_packet_build_output_cmd(uint8_t* buf, uint8_t cmd, const void* payload,
+                                      uint32_t timestamp_us);
+
+// ============================================================================
+// PARSING (TCP control channel)
+// ============================================================================
+
+// The control channel is a byte stream: packets arrive split and joined
+// at any point. OUTPUT_CMDs are framed by their command's payload length.
+// Bytes that don't start a valid header are skipped one at a time, and so
+// is the header of any message whose length isn't known, until the next
+// magic.
+
+typedef void (*jocp_cmd_callback_t)(void* ctx, uint8_t cmd, const uint8_t* payload, uint8_t len);
+
+typedef struct {
+    uint8_t buf[JOCP_OUTPUT_CMD_MAX];
+    uint8_t len;
+    uint32_t dropped;           // Bytes skipped to find a header
+} jocp_cmd_parser_t;
+
+void jocp_cmd_parser_init(jocp_cmd_parser_t* parser);
+
+// Feed received bytes; callback runs once per complete OUTPUT_CMD
+void jocp_cmd_parser_feed(jocp_cmd_parser_t* parser, const uint8_t* data, uint16_t len,
+                          jocp_cmd_callback_t callback, void* ctx);
+
+#endif // JOCP_PACKET_H
@@ -0,0 +1,145 @@
+// jocp_sender.c - JOCP controller-side state
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+
+#include "jocp_sender.h"
+
+#include <string.h>
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+void jocp_sender_init(jocp_sender_t* sender, uint32_t heartbeat_ms)
+{
+    memset(sender, 0, sizeof(*sender));
+    sender->heartbeat_us = heartbeat_ms * 1000;
+    jocp_cmd_parser_init(&sender->parser);
+}
+
+void jocp_sender_restart(jocp_sender_t* sender)
+{
+    sender->sent_any = false;
+    sender->min_interval_us = 0;
+    jocp_cmd_parser_init(&sender->parser);
+}
+
+// ============================================================================
+// INPUT
+// ============================================================================
+
+void jocp_sender_set_state(jocp_sender_t* sender, const input_event_t* event)
+{
+    jocp_input_t payload;
+    uint16_t flags = jocp_packet_encode_input(&payload, event);
+
+    if (sender->have_state && flags == sender->flags &&
+        memcmp(&payload, &sender->payload, sizeof(payload)) == 0) {
+        return;
+    }
+
+    sender->payload = payload;
+    sender->flags = flags;
+    sender->have_state = true;
+    sender->dirty = true;
+}
+
+bool jocp_sender_due(const jocp_sender_t* sender, uint32_t now_us)
+{
+    if (!sender->have_state) return false;
+    if (!sender->sent_any) return true;
+
+    uint32_t since = now_us - sender->last_send_us;
+    if (sender->dirty) return since >= sender->min_interval_us;
+    return since >= sender->heartbeat_us;
+}
+
+void jocp_sender_build(jocp_sender_t* sender, jocp_input_packet_t* packet, uint32_t now_us)
+{
+    jocp_packet_header(&packet->header, JOCP_MSG_INPUT, sender->seq++, sender->flags, now_us);
+    packet->payload = sender->payload;
+    packet->payload.imu_timestamp = now_us;
+
+    sender->dirty = false;
+    sender->sent_any = true;
+    sender->last_send_us = now_us;
+}
+
+// ============================================================================
+// FEEDBACK
+// ============================================================================
+
+static void set_feedback(jocp_sender_t* sender, uint8_t* field, uint8_t value)
+{
+    if (*field != value) {
+        *field = value;
+        sender->feedback_dirty = true;
+    }
+}
+
+static void on_output_cmd(void* ctx, uint8_t cmd, const uint8_t* payload, uint8_t len)
+{
+    jocp_sender_t* sender = (jocp_sender_t*)ctx;
+    (void)len;  // Always the command's own length
+
+    switch (cmd) {
+        case JOCP_CMD_RUMBLE: {
+            jocp_rumble_cmd_t rumble;
+            memcpy(&rumble, payload, sizeof(rumble));
+            set_feedback(sender, &sender->feedback.rumble_left, rumble.left_amplitude);
+            set_feedback(sender, &sender->feedback.rumble_right, rumble.right_amplitude);
+            sender->rumble_timed = rumble.duration_ms != 0 &&
+                                   (rumble.left_amplitude || rumble.right_amplitude);
+            sender->rumble_end_us = sender->rx_now_us + (uint32_t)rumble.duration_ms * 1000;
+            break;
+        }
+
+        case JOCP_CMD_PLAYER_LED: {
+            jocp_player_led_cmd_t led;
+            memcpy(&led, payload, sizeof(led));
+            set_feedback(sender, &sender->feedback.led_player, led.player_index);
+            break;
+        }
+
+        case JOCP_CMD_RGB_LED: {
+            jocp_rgb_led_cmd_t rgb;
+            memcpy(&rgb, payload, sizeof(rgb));
+            set_feedback(sender, &sender->feedback.led_r, rgb.r);
+            set_feedback(sender, &sender->feedback.led_g, rgb.g);
+            set_feedback(sender, &sender->feedback.led_b, rgb.b);
+            break;
+        }
+
+        case JOCP_CMD_POLL_RATE: {
+            jocp_poll_rate_cmd_t rate;
+            memcpy(&rate, payload, sizeof(rate));
+            sender->min_interval_us = rate.rate_hz ? 1000000u / rate.rate_hz : 0;
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void jocp_sender_receive(jocp_sender_t* sender, const uint8_t* data, uint16_t len,
+                         uint32_t now_us)
+{
+    sender->rx_now_us = now_us;
+    jocp_cmd_parser_feed(&sender->parser, data, len, on_output_cmd, sender);
+}
+
+bool jocp_sender_get_feedback(jocp_sender_t* sender, output_feedback_t* fb, uint32_t now_us)
+{
+    if (sender->rumble_timed && (int32_t)(now_us - sender->rumble_end_us) >= 0) {
+        sender->rumble_timed = false;
+        set_feedback(sender, &sender->feedback.rumble_left, 0);
+        set_feedback(sender, &sender->feedback.rumble_right, 0);
+    }
+
+    bool changed = sender->feedback_dirty;
+    *fb = sender->feedback;
+    fb->dirty = changed;
+    sender->feedback_dirty = false;
+    return changed;
+}
@@ -0,0 +1,76 @@
+// jocp_sender.h - JOCP controller-side state
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// What a WiFi controller sends and when, with no pico-sdk or lwIP
+// dependency; jocp_output.c moves the bytes. The router tap hands over
+// each output state. A state that differs on the wire goes out on the
+// next pass, so the taps between two passes collapse into one packet.
+// An unchanged state is repeated every heartbeat, which keeps the dongle
+// from timing the controller out (5 s) and repairs a lost release. A
+// POLL_RATE command from the dongle caps the packet rate.
+//
+// OUTPUT_CMDs from the TCP channel become the output_feedback_t that
+// get_feedback() hands the app. A rumble with a duration stops by itself.
+
+#ifndef JOCP_SENDER_H
+#define JOCP_SENDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "jocp_packet.h"
+#include "core/output_interface.h"
+
+typedef struct {
+    // INPUT side
+    jocp_input_t payload;       // Latest state, as it goes on the wire
+    uint16_t flags;
+    bool have_state;
+    bool dirty;                 // payload changed since the last packet
+    bool sent_any;              // Since the last restart
+    uint16_t seq;
+    uint32_t last_send_us;
+    uint32_t heartbeat_us;
+    uint32_t min_interval_us;   // From POLL_RATE, 0 = no cap
+
+    // OUTPUT_CMD side
+    jocp_cmd_parser_t parser;
+    output_feedback_t feedback;
+    bool feedback_dirty;
+    bool rumble_timed;          // rumble_end_us is set
+    uint32_t rumble_end_us;
+    uint32_t rx_now_us;         // Time of the bytes being parsed
+} jocp_sender_t;
+
+void jocp_sender_init(jocp_sender_t* sender, uint32_t heartbeat_ms);
+
+// New association: send the current state at once, and parse the
+// control channel from a clean slate
+void jocp_sender_restart(jocp_sender_t* sender);
+
+// ============================================================================
+// INPUT
+// ============================================================================
+
+// Router output state (from the tap)
+void jocp_sender_set_state(jocp_sender_t* sender, const input_event_t* event);
+
+// True when a packet should go out now
+bool jocp_sender_due(const jocp_sender_t* sender, uint32_t now_us);
+
+// Build the next INPUT packet and count it as sent
+void jocp_sender_build(jocp_sender_t* sender, jocp_input_packet_t* packet, uint32_t now_us);
+
+// ============================================================================
+// FEEDBACK
+// ============================================================================
+
+// Bytes from the TCP control channel
+void jocp_sender_receive(jocp_sender_t* sender, const uint8_t* data, uint16_t len,
+                         uint32_t now_us);
+
+// Current feedback; returns true (and fb->dirty) when it changed since
+// the last call
+bool jocp_sender_get_feedback(jocp_sender_t* sender, output_feedback_t* fb, uint32_t now_us);
+
+#endif // JOCP_SENDER_H
@@ -0,0 +1,388 @@
+// check.c - host check of the AMOLED face's damage-rect blits
+//
+// Builds rm67162_amoled.c and the face engine (face_anim.c) from the tree
+// against stub ESP-IDF headers (stub/), and includes eyes_esp32.c directly
+// so its static eyes_flush() and damage state can be driven frame by frame.
+// The panel IO calls land in a model of the RM67162: column/row address set
+// a window, RAMWR / memory-write-continue fill it in row order, and colour
+// transfers stay in flight (as DMA would) until the driver waits on the
+// completion semaphore or sends a parameter.
+//
+// A scripted session renders real face frames: gaze moving every frame,
+// blinks, every emotion, speech, style changes, face shifts and a settled
+// idle stretch. After each flush the same canvas is blitted in full onto a
+// second panel RAM for reference.
+//
+// Checks:
+//   - after every flush the panel matches a full blit of the canvas;
+//   - canvas tiles outside this frame's damage are black, so clearing only
+//     last frame's tiles leaves nothing behind;
+//   - a band buffer is never rewritten while its transfer is in flight, a
+//     wait never blocks with nothing in flight, windows stay on the panel and
+//     are filled exactly, and nothing is in flight when a flush returns;
+//   - a changed palette or shift sends a full frame, an unchanged frame sends
+//     nothing, and pupils-only frames send well under half a frame.
+//
+// Usage: amoled-damage-check [-v]
+// Exit status 1 if any check fails.
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "eyes_esp32.c"
+#include "esp_lcd_panel_io.h"
+#include "freertos/semphr.h"
+
+#define PANEL_PIXELS    (AMOLED_W * AMOLED_H)
+#define MAX_INFLIGHT    16
+#define FRAME_MS        20
+
+static bool verbose;
+static int failures;
+static uint32_t now_ms;
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+// -----------------------------------------------------------------------------
+// Platform bits the eyes task references
+// -----------------------------------------------------------------------------
+
+uint32_t platform_time_ms(void) { return now_ms; }
+void btstack_host_suppress_scan(bool suppress) { (void)suppress; }
+bool pmu_init(void) { return true; }
+
+// -----------------------------------------------------------------------------
+// RM67162 model
+// -----------------------------------------------------------------------------
+
+struct sim_semaphore {
+    uint32_t count, max;
+};
+
+struct sim_panel_io {
+    esp_lcd_panel_io_color_trans_done_cb_t done;
+    void* ctx;
+    size_t depth;
+};
+
+typedef struct {
+    int cmd;
+    const uint8_t* buf;
+    uint8_t* copy;          // the bytes as queued
+    size_t len;
+} transfer_t;
+
+static struct sim_panel_io io_model;
+static uint16_t panel[PANEL_PIXELS], shadow[PANEL_PIXELS];
+static uint16_t* ram = panel;           // panel RAM being written
+static int col0, col1, row0, row1;      // address window
+static uint32_t wp;                     // pixels written into the window
+static bool window_open;
+static int page;                        // 0xFE command page; 0 is the user set
+static transfer_t inflight[MAX_INFLIGHT];
+static int inflight_n;
+static uint32_t pixels_sent;            // into `panel` since last reset
+static bool rewrite_reported;
+
+static void window_done(void)
+{
+    uint32_t area = (uint32_t)(col1 - col0 + 1) * (row1 - row0 + 1);
+    if (window_open && wp != area)
+        fail("window (%d,%d)-(%d,%d) got %u of %u pixels", col0, row0, col1, row1, wp, area);
+    window_open = false;
+}
+
+static void complete_one(void)
+{
+    transfer_t t = inflight[0];
+    memmove(inflight, inflight + 1, --inflight_n * sizeof inflight[0]);
+
+    if (memcmp(t.buf, t.copy, t.len) != 0 && !rewrite_reported) {
+        fail("band buffer rewritten while its transfer was in flight");
+        rewrite_reported = true;
+    }
+    if (t.cmd == 0x2C) wp = 0;
+    window_open = true;
+    uint32_t area = (uint32_t)(col1 - col0 + 1) * (row1 - row0 + 1);
+    uint32_t n = (uint32_t)(t.len / 2);
+    const uint16_t* px = (const uint16_t*)t.copy;
+    for (uint32_t i = 0; i < n; i++, wp++) {
+        if (wp >= area) {
+            fail("transfer runs past window (%d,%d)-(%d,%d)", col0, row0, col1, row1);
+            break;
+        }
+        int x = col0 + (int)(wp % (uint32_t)(col1 - col0 + 1));
+        int y = row0 + (int)(wp / (uint32_t)(col1 - col0 + 1));
+        ram[y * AMOLED_W + x] = px[i];
+    }
+    if (ram == panel) pixels_sent += n;
+    free(t.copy);
+    if (io_model.done) io_model.done(&io_model, NULL, io_model.ctx);
+}
+
+esp_err_t esp_lcd_new_panel_io_spi(spi_host_device_t bus, const esp_lcd_panel_io_spi_config_t* cfg,
+                                   esp_lcd_panel_io_handle_t* io)
+{
+    io_model.done = cfg->on_color_trans_done;
+    io_model.ctx = cfg->user_ctx;
+    io_model.depth = cfg->trans_queue_depth < MAX_INFLIGHT ? cfg->trans_queue_depth : MAX_INFLIGHT;
+    *io = &io_model;
+    return ESP_OK;
+}
+
+// Parameters are sent by polling, after every queued colour transfer
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int cmd, const void* param, size_t size)
+{
+    const uint8_t* p = param;
+
+    while (inflight_n) complete_one();
+    if (cmd == 0xFE && size == 1) page = p[0];
+    if (page != 0 || (cmd != 0x2A && cmd != 0x2B)) return ESP_OK;
+    if (size != 4) {
+        fail("address set 0x%02X with %zu bytes", cmd, size);
+        return ESP_FAIL;
+    }
+    window_done();
+    int a = (p[0] << 8) | p[1], b = (p[2] << 8) | p[3];
+    int limit = cmd == 0x2A ? AMOLED_W : AMOLED_H;
+    if (a > b || b >= limit) fail("address set 0x%02X %d..%d outside the panel", cmd, a, b);
+    if (b >= limit) b = limit - 1;
+    if (a > b) a = b;
+    if (cmd == 0x2A) { col0 = a; col1 = b; }
+    else { row0 = a; row1 = b; }
+    wp = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int cmd, const void* color, size_t size)
+{
+    if (cmd != 0x2C && cmd != 0x3C) fail("colour data with command 0x%02X", cmd);
+    while ((size_t)inflight_n >= io_model.depth) complete_one();
+    transfer_t* t = &inflight[inflight_n++];
+    t->cmd = cmd;
+    t->buf = color;
+    t->len = size;
+    t->copy = malloc(size);
+    memcpy(t->copy, color, size);
+    return ESP_OK;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(uint32_t max, uint32_t initial)
+{
+    SemaphoreHandle_t s = calloc(1, sizeof *s);
+    s->max = max;
+    s->count = initial;
+    return s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait)
+{
+    while (!sem->count) {
+        if (!inflight_n) {
+            fail("semaphore wait with nothing in flight would block forever");
+            return pdFALSE;
+        }
+        complete_one();
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken)
+{
+    if (sem->count >= sem->max) fail("completion semaphore overflowed");
+    else sem->count++;
+    return pdTRUE;
+}
+
+// -----------------------------------------------------------------------------
+// Frames
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    const char* name;
+    int frames, full, damaged;
+    double pixels;
+} phase_t;
+
+static phase_t phases[8];
+static int phase_n;
+static phase_t* phase;
+
+static void begin_phase(const char* name)
+{
+    phase = &phases[phase_n++];
+    phase->name = name;
+}
+
+// Nothing may be left outside the tiles drawn this frame
+static void check_canvas(void)
+{
+    for (int ty = 0; ty < DMG_ROWS; ty++) {
+        for (int tx = 0; tx < DMG_COLS; tx++) {
+            if (s_drawn[ty] & (1u << tx)) continue;
+            int y0 = ty * DMG_TILE, y1 = y0 + DMG_TILE < EYES_H ? y0 + DMG_TILE : EYES_H;
+            int x1 = (tx + 1) * DMG_TILE < EYES_W ? (tx + 1) * DMG_TILE : EYES_W;
+            for (int x = tx * DMG_TILE; x < x1; x++) {
+                for (int y = y0; y < y1; y++) {
+                    if (s_fb[(size_t)x * EYES_H + y]) {
+                        fail("canvas (%d,%d) still lit outside this frame's tiles", x, y);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Render, flush and compare with a full blit; returns pixels sent
+static uint32_t frame(bool tick)
+{
+    uint16_t main565 = style_color(face_get_style());
+    uint16_t accent565 = style_accent(face_get_style());
+
+    if (tick) {
+        now_ms += FRAME_MS;
+        face_tick(now_ms);
+    }
+    face_render();
+    check_canvas();
+
+    pixels_sent = 0;
+    eyes_flush(main565, accent565);
+    if (inflight_n) fail("flush returned with %d transfers in flight", inflight_n);
+    window_done();
+    uint32_t sent = pixels_sent;
+
+    ram = shadow;
+    amoled_blit_idx8(s_fb, EYES_W, EYES_H, main565, accent565);
+    window_done();
+    ram = panel;
+    for (int i = 0; i < PANEL_PIXELS; i++) {
+        if (panel[i] != shadow[i]) {
+            fail("%s frame %d: panel (%d,%d) is %04x, a full blit gives %04x", phase->name,
+                 phase->frames, i % AMOLED_W, i / AMOLED_W, panel[i], shadow[i]);
+            break;
+        }
+    }
+
+    phase->frames++;
+    phase->pixels += sent;
+    if (sent == PANEL_PIXELS) phase->full++;
+    else if (sent) phase->damaged++;
+    return sent;
+}
+
+static void session(void)
+{
+    s_fb = heap_caps_malloc((size_t)EYES_W * EYES_H, MALLOC_CAP_SPIRAM);
+    memset(s_fb, 0, (size_t)EYES_W * EYES_H);
+    amoled_init();
+    amoled_set_shift(-15);
+    face_init(EYES_W, EYES_H);
+    face_set_style(FACE_STYLE_TABY);
+
+    begin_phase("first");
+    if (frame(true) != PANEL_PIXELS) fail("first frame wasn't a full blit");
+    for (int i = 0; i < 40; i++) frame(true);       // let the face settle in
+
+    begin_phase("gaze");
+    for (int i = 0; i < 60; i++) {
+        face_look(0.6f * cosf(i * 0.35f), 0.4f * sinf(i * 0.5f));
+        frame(true);
+    }
+    if (phase->pixels > 0.5 * phase->frames * PANEL_PIXELS)
+        fail("gaze frames sent %.0f%% of a full frame on average",
+             100.0 * phase->pixels / ((double)phase->frames * PANEL_PIXELS));
+
+    begin_phase("unchanged");
+    uint32_t sent = frame(false);
+    if (sent) fail("re-rendering the same pose sent %u pixels", sent);
+
+    begin_phase("blink");
+    for (int i = 0; i < 45; i++) {
+        if (i % 15 == 0) face_blink();
+        frame(true);
+    }
+
+    begin_phase("emotions");
+    for (int e = 0; e < FACE_EMO_COUNT; e++) {
+        face_set_emotion((face_emotion)e);
+        for (int i = 0; i < 12; i++) frame(true);
+    }
+    face_set_emotion(FACE_EMO_NEUTRAL);
+
+    begin_phase("speaking");
+    for (int i = 0; i < 40; i++) {
+        face_set_speaking(0.5f + 0.5f * sinf(i * 0.9f));
+        frame(true);
+    }
+    face_set_speaking(0.0f);
+
+    begin_phase("style+shift");
+    static const face_style_id styles[] = { FACE_STYLE_CLASSIC, FACE_STYLE_ASTRO, FACE_STYLE_TABY };
+    for (size_t s = 0; s < sizeof styles / sizeof styles[0]; s++) {
+        face_set_style(styles[s]);
+        if (frame(true) != PANEL_PIXELS) fail("style change didn't send a full frame");
+        for (int i = 0; i < 8; i++) {
+            face_look(0.3f * (i & 1 ? 1 : -1), 0.0f);
+            frame(true);
+        }
+    }
+    static const int shifts[] = { 0, 7, -15 };
+    for (size_t s = 0; s < sizeof shifts / sizeof shifts[0]; s++) {
+        amoled_set_shift(shifts[s]);
+        if (frame(true) != PANEL_PIXELS) fail("shift to %d didn't send a full frame", shifts[s]);
+        for (int i = 0; i < 4; i++) frame(true);
+    }
+
+    begin_phase("idle");
+    face_look(0.0f, 0.0f);
+    for (int i = 0; i < 120; i++) frame(true);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    printf("amoled-damage-check: %dx%d canvas, %dx%d panel\n", EYES_W, EYES_H, AMOLED_W, AMOLED_H);
+    session();
+
+    int frames = 0;
+    double pixels = 0;
+    for (int i = 0; i < phase_n; i++) {
+        frames += phases[i].frames;
+        pixels += phases[i].pixels;
+        if (verbose)
+            printf("  %-12s %4d frames: %3d full, %3d damage rects, %5.1f%% of a full frame each\n",
+                   phases[i].name, phases[i].frames, phases[i].full, phases[i].damaged,
+                   100.0 * phases[i].pixels / ((double)phases[i].frames * PANEL_PIXELS));
+    }
+    printf("  %d frames, %.1f%% of a full frame's pixels each on average\n", frames,
+           100.0 * pixels / ((double)frames * PANEL_PIXELS));
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
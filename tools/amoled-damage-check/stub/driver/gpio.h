@@ -0,0 +1,21 @@
+// Minimal driver/gpio.h: GPIO writes go nowhere.
+#ifndef DRIVER_GPIO_H
+#define DRIVER_GPIO_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum { GPIO_MODE_INPUT = 1, GPIO_MODE_OUTPUT = 2 } gpio_mode_t;
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    int pull_up_en;
+    int pull_down_en;
+    int intr_type;
+} gpio_config_t;
+
+static inline esp_err_t gpio_config(const gpio_config_t* cfg) { (void)cfg; return ESP_OK; }
+static inline esp_err_t gpio_set_level(int pin, uint32_t level) { (void)pin; (void)level; return ESP_OK; }
+
+#endif
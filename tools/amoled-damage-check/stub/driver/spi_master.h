@@ -0,0 +1,25 @@
+// Minimal driver/spi_master.h: the bus always comes up.
+#ifndef DRIVER_SPI_MASTER_H
+#define DRIVER_SPI_MASTER_H
+
+#include "esp_err.h"
+
+typedef enum { SPI1_HOST, SPI2_HOST, SPI3_HOST } spi_host_device_t;
+#define SPI_DMA_CH_AUTO 3
+
+typedef struct {
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+} spi_bus_config_t;
+
+static inline esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* cfg, int dma)
+{
+    (void)host; (void)cfg; (void)dma;
+    return ESP_OK;
+}
+
+#endif
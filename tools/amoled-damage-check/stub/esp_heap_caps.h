@@ -0,0 +1,15 @@
+// Minimal esp_heap_caps.h: every capability is plain malloc on the host.
+#ifndef ESP_HEAP_CAPS_H
+#define ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA       (1 << 3)
+#define MALLOC_CAP_8BIT      (1 << 2)
+#define MALLOC_CAP_SPIRAM    (1 << 10)
+#define MALLOC_CAP_INTERNAL  (1 << 11)
+
+static inline void* heap_caps_malloc(size_t size, unsigned caps) { (void)caps; return malloc(size); }
+static inline void heap_caps_free(void* p) { free(p); }
+
+#endif
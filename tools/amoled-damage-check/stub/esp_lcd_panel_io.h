@@ -0,0 +1,34 @@
+// esp_lcd_panel_io.h for the host check: the panel IO calls are implemented
+// by the RM67162 model in check.c.
+#ifndef ESP_LCD_PANEL_IO_H
+#define ESP_LCD_PANEL_IO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/spi_master.h"
+
+typedef struct sim_panel_io* esp_lcd_panel_io_handle_t;
+typedef struct { int unused; } esp_lcd_panel_io_event_data_t;
+typedef bool (*esp_lcd_panel_io_color_trans_done_cb_t)(esp_lcd_panel_io_handle_t io,
+                                                       esp_lcd_panel_io_event_data_t* edata,
+                                                       void* user_ctx);
+
+typedef struct {
+    int cs_gpio_num;
+    int dc_gpio_num;
+    int spi_mode;
+    unsigned int pclk_hz;
+    size_t trans_queue_depth;
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+    void* user_ctx;
+    int lcd_cmd_bits;
+    int lcd_param_bits;
+} esp_lcd_panel_io_spi_config_t;
+
+esp_err_t esp_lcd_new_panel_io_spi(spi_host_device_t bus, const esp_lcd_panel_io_spi_config_t* cfg,
+                                   esp_lcd_panel_io_handle_t* io);
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int cmd, const void* param, size_t size);
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int cmd, const void* color, size_t size);
+
+#endif
@@ -0,0 +1,19 @@
+// Minimal FreeRTOS.h for the host build of the AMOLED driver and eyes task.
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE             0
+#define pdTRUE              1
+#define portMAX_DELAY       0xffffffffu
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+// From esp_attr.h, which the real FreeRTOS.h pulls in
+#define IRAM_ATTR
+
+#endif
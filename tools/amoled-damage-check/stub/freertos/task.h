@@ -0,0 +1,19 @@
+// Minimal freertos/task.h: delays are no-ops, tasks are never started.
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+static inline void vTaskDelay(TickType_t ticks) { (void)ticks; }
+static inline void vTaskDelete(TaskHandle_t task) { (void)task; }
+static inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                                 void* arg, int prio, TaskHandle_t* handle, int core)
+{
+    (void)fn; (void)name; (void)stack; (void)arg; (void)prio; (void)handle; (void)core;
+    return pdTRUE;
+}
+
+#endif
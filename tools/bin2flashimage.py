@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+# Convert a raw .bin into a sector-packed C image for the SWD flasher.
+# Usage: bin2flashimage.py <input.bin> <output.c> <output.h> <symbol>
+#
+# The image is split into 4K flash sectors (the last one padded with 0xff).
+# Each sector gets the CRC32 of its padded contents, so the flasher can skip
+# sectors the target already holds, and is stored as one of:
+#   blank       all 0xff, nothing stored (erase only)
+#   compressed  independent LZ stream, decoded on the target
+#   raw         4096 bytes, when compression doesn't help
+#
+# LZ stream format (see lz_decode() in src/swd_flash/flash.c):
+#   0x00-0x7f  literal run: (t + 1) bytes follow
+#   0x80-0xff  match: length (t & 0x7f) + 3, then a 16-bit little-endian
+#              distance (1..4096) back into the sector's output
+#
+# Emits:  const unsigned char  <symbol>_data[];         sector streams, word aligned
+#         const flash_sector_t <symbol>_sectors[];      crc/offset/length/flags
+#         const unsigned int   <symbol>_sector_count;
+#         const unsigned char  <symbol>_boot2[256];     raw boot2 (first 256 bytes)
+#         const unsigned int   <symbol>_length;         original image length
+import sys
+import zlib
+
+SECTOR_SIZE = 4096
+SECTOR_RAW = 1 << 0
+SECTOR_BLANK = 1 << 1
+
+MIN_MATCH = 3
+MAX_MATCH = 0x7f + MIN_MATCH
+MAX_LITERAL = 0x80
+MAX_DISTANCE = SECTOR_SIZE
+MAX_CHAIN = 64
+
+
+def lz_compress(data):
+    out = bytearray()
+    literals = bytearray()
+    chains = {}
+
+    def flush_literals():
+        while literals:
+            run = literals[:MAX_LITERAL]
+            out.append(len(run) - 1)
+            out.extend(run)
+            del literals[:MAX_LITERAL]
+
+    def insert(pos):
+        if pos + MIN_MATCH <= len(data):
+            chains.setdefault(data[pos:pos + MIN_MATCH], []).append(pos)
+
+    i = 0
+    while i < len(data):
+        best_len, best_dist = 0, 0
+        if i + MIN_MATCH <= len(data):
+            candidates = chains.get(data[i:i + MIN_MATCH], [])
+            for cand in reversed(candidates[-MAX_CHAIN:]):
+                dist = i - cand
+                if dist > MAX_DISTANCE:
+                    break
+                length = MIN_MATCH
+                limit = min(MAX_MATCH, len(data) - i)
+                while length < limit and data[cand + length] == data[i + length]:
+                    length += 1
+                if length > best_len:
+                    best_len, best_dist = length, dist
+                    if length == limit:
+                        break
+
+        if best_len >= MIN_MATCH:
+            flush_literals()
+            out.append(0x80 | (best_len - MIN_MATCH))
+            out.append(best_dist & 0xff)
+            out.append(best_dist >> 8)
+            for p in range(i, i + best_len):
+                insert(p)
+            i += best_len
+        else:
+            literals.append(data[i])
+            insert(i)
+            i += 1
+
+    flush_literals()
+    return bytes(out)
+
+
+def lz_decompress(stream):
+    out = bytearray()
+    i = 0
+    while i < len(stream):
+        t = stream[i]
+        i += 1
+        if t < 0x80:
+            out.extend(stream[i:i + t + 1])
+            i += t + 1
+        else:
+            length = (t & 0x7f) + MIN_MATCH
+            dist = stream[i] | (stream[i + 1] << 8)
+            i += 2
+            for _ in range(length):
+                out.append(out[-dist])
+    return bytes(out)
+
+
+def main():
+    if len(sys.argv) != 5:
+        sys.stderr.write("usage: bin2flashimage.py <in.bin> <out.c> <out.h> <symbol>\n")
+        sys.exit(2)
+
+    inp, out_c, out_h, sym = sys.argv[1:5]
+
+    with open(inp, "rb") as f:
+        image = f.read()
+
+    padded = image + b"\xff" * (-len(image) % SECTOR_SIZE)
+    data = bytearray()
+    sectors = []
+
+    for base in range(0, len(padded), SECTOR_SIZE):
+        sector = padded[base:base + SECTOR_SIZE]
+        crc = zlib.crc32(sector) & 0xffffffff
+
+        if sector == b"\xff" * SECTOR_SIZE:
+            payload, flags = b"", SECTOR_BLANK
+        else:
+            payload, flags = lz_compress(sector), 0
+            if len(payload) >= SECTOR_SIZE:
+                payload, flags = sector, SECTOR_RAW
+            elif lz_decompress(payload) != sector:
+                sys.stderr.write("bin2flashimage: round trip failed at 0x%x\n" % base)
+                sys.exit(1)
+
+        sectors.append((crc, len(data), len(payload), flags))
+        data.extend(payload)
+        data.extend(b"\x00" * (-len(data) % 4))
+
+    boot2 = padded[:256]
+
+    with open(out_c, "w") as f:
+        f.write('#include "%s"\n\n' % out_h.split("/")[-1])
+        f.write("const unsigned char %s_data[] __attribute__((aligned(4))) = {\n" % sym)
+        for i in range(0, len(data), 16):
+            f.write("    %s,\n" % ", ".join("0x%02x" % b for b in data[i:i + 16]))
+        f.write("};\n\n")
+        f.write("const flash_sector_t %s_sectors[] = {\n" % sym)
+        for crc, offset, length, flags in sectors:
+            f.write("    { 0x%08x, 0x%06x, %4d, 0x%x },\n" % (crc, offset, length, flags))
+        f.write("};\n")
+        f.write("const unsigned int %s_sector_count = %d;\n\n" % (sym, len(sectors)))
+        f.write("const unsigned char %s_boot2[256] __attribute__((aligned(4))) = {\n" % sym)
+        for i in range(0, len(boot2), 16):
+            f.write("    %s,\n" % ", ".join("0x%02x" % b for b in boot2[i:i + 16]))
+        f.write("};\n")
+        f.write("const unsigned int %s_length = %d;\n" % (sym, len(image)))
+
+    with open(out_h, "w") as f:
+        guard = sym.upper() + "_H"
+        f.write("#ifndef %s\n#define %s\n" % (guard, guard))
+        f.write('#include "flash.h"\n')
+        f.write("extern const unsigned char %s_data[];\n" % sym)
+        f.write("extern const flash_sector_t %s_sectors[];\n" % sym)
+        f.write("extern const unsigned int %s_sector_count;\n" % sym)
+        f.write("extern const unsigned char %s_boot2[256];\n" % sym)
+        f.write("extern const unsigned int %s_length;\n" % sym)
+        f.write("#endif\n")
+
+    stored = sum(s[2] for s in sectors)
+    sys.stdout.write("bin2flashimage: %d bytes, %d sectors, %d stored (%d%%)\n" %
+                     (len(image), len(sectors), stored,
+                      100 * stored // max(1, len(image))))
+
+
+if __name__ == "__main__":
+    main()
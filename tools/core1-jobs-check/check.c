@@ -0,0 +1,499 @@
+// check.c - host check of the Core 1 job ring and the display flush handoff
+//
+// Builds core1_jobs.c and display.c from src/ against stub pico headers and
+// runs the two cores as pthreads: the main thread is Core 0, a second thread
+// runs core1_wrapper()'s idle loop (attach, then drain the ring and __wfe()).
+// The display transport is a fake SSD1306 that records what reaches the
+// panel, page by page.
+//
+// Checks:
+//   - before Core 1 attaches, jobs run inline on the caller and
+//     CORE1_JOB_NO_INLINE jobs are refused;
+//   - queued jobs run on Core 1, in submission order, none lost or repeated,
+//     with the ring never deeper than CORE1_JOB_QUEUE_SIZE;
+//   - with the ring full, a job runs inline on Core 0 and a NO_INLINE job is
+//     refused, and the queued ones still run in order;
+//   - a late CORE1_JOB_DROP_LATE job is skipped, a late plain job still
+//     runs, and both are counted;
+//   - a job submitted from Core 1 runs inline before the submit returns;
+//   - while Core 0 clears and redraws the framebuffer as fast as it can,
+//     every frame that reaches the panel is one Core 0 finished (never torn
+//     or half cleared), frames never go backwards, every flush runs on
+//     Core 1, and the last frame drawn is on the panel once Core 1 is idle.
+//
+// Usage: core1-jobs-check [-v] [-s seed] [-n jobs] [-f frames] [-d page_us]
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "core/core1_jobs.h"
+#include "display.h"
+#include "display_transport.h"
+#include "platform/platform.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+static bool verbose;
+static int failures;
+static uint32_t seed = 1;
+static unsigned job_count = 200000;
+static unsigned frame_count = 3000;
+static unsigned page_us = 20;       // Fake panel time per page write
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+// Core 0 only
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+// ============================================================================
+// TWO CORES
+// ============================================================================
+
+static _Thread_local unsigned core_num;
+
+static pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t event_cond = PTHREAD_COND_INITIALIZER;
+static bool event_flag;
+
+unsigned get_core_num(void)
+{
+    return core_num;
+}
+
+// ARM event register: __sev() latches it, __wfe() waits for it and clears it
+void __sev(void)
+{
+    pthread_mutex_lock(&event_lock);
+    event_flag = true;
+    pthread_cond_broadcast(&event_cond);
+    pthread_mutex_unlock(&event_lock);
+}
+
+void __wfe(void)
+{
+    pthread_mutex_lock(&event_lock);
+    while (!event_flag) pthread_cond_wait(&event_cond, &event_lock);
+    event_flag = false;
+    pthread_mutex_unlock(&event_lock);
+}
+
+uint32_t time_us_32(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+}
+
+uint32_t platform_time_us(void) { return time_us_32(); }
+uint32_t platform_time_ms(void) { return time_us_32() / 1000; }
+
+void platform_sleep_us(uint32_t us)
+{
+    uint32_t start = time_us_32();
+    while (time_us_32() - start < us) { }
+}
+
+void platform_sleep_ms(uint32_t ms)
+{
+    (void)ms;   // Panel power-up delays: nothing to wait for here
+}
+
+static bool core1_stop;
+static pthread_t core1_thread;
+
+// core1_wrapper() with no protocol task
+static void* core1_main(void* arg)
+{
+    (void)arg;
+    core_num = 1;
+    core1_jobs_attach();
+    while (!__atomic_load_n(&core1_stop, __ATOMIC_ACQUIRE)) {
+        core1_jobs_run();
+        __wfe();
+    }
+    return NULL;
+}
+
+static void core1_start(void)
+{
+    pthread_create(&core1_thread, NULL, core1_main, NULL);
+    while (!core1_jobs_available()) sched_yield();
+}
+
+static void core1_halt(void)
+{
+    __atomic_store_n(&core1_stop, true, __ATOMIC_RELEASE);
+    __sev();
+    pthread_join(core1_thread, NULL);
+}
+
+static void core1_drain(void)
+{
+    while (core1_jobs_busy()) sched_yield();
+}
+
+// ============================================================================
+// JOBS
+// ============================================================================
+
+// Log of jobs run, written by whichever core runs them
+typedef struct {
+    uint32_t id;
+    uint8_t  core;
+} run_t;
+
+static run_t* run_log;
+static uint32_t run_count;
+static uint32_t spin_mask;          // Job cost: spin id & spin_mask iterations
+
+static void log_job(void* ctx)
+{
+    uint32_t id = (uint32_t)(uintptr_t)ctx;
+    run_log[run_count].id = id;
+    run_log[run_count].core = (uint8_t)get_core_num();
+    run_count++;
+    for (volatile uint32_t i = 0; i < ((id * 2654435761u) >> 20 & spin_mask); i++) { }
+}
+
+// Holds Core 1 inside a job until released
+static bool gate_entered;
+static bool gate_open;
+
+static void gate_job(void* ctx)
+{
+    (void)ctx;
+    __atomic_store_n(&gate_entered, true, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&gate_open, __ATOMIC_ACQUIRE)) sched_yield();
+}
+
+static void gate_close(void)
+{
+    gate_entered = false;
+    gate_open = false;
+    core1_job_submit(gate_job, NULL, CORE1_JOB_NO_INLINE);
+    while (!__atomic_load_n(&gate_entered, __ATOMIC_ACQUIRE)) sched_yield();
+}
+
+static void gate_release(void)
+{
+    __atomic_store_n(&gate_open, true, __ATOMIC_RELEASE);
+    __sev();
+}
+
+static void check_detached(void)
+{
+    run_count = 0;
+    if (core1_jobs_available()) fail("jobs available before Core 1 attached");
+    if (!core1_job_submit(log_job, (void*)1, CORE1_JOB_DEFAULT))
+        fail("detached: default job refused");
+    if (run_count != 1 || run_log[0].core != 0)
+        fail("detached: default job did not run inline on Core 0");
+    if (core1_job_submit(log_job, (void*)2, CORE1_JOB_NO_INLINE))
+        fail("detached: NO_INLINE job accepted");
+    if (run_count != 1) fail("detached: refused job ran");
+
+    core1_job_stats_t st;
+    core1_jobs_get_stats(&st);
+    if (st.ran_inline != 1 || st.rejected != 1 || st.ran_core1 != 0)
+        fail("detached: stats inline %u rejected %u core1 %u",
+             st.ran_inline, st.rejected, st.ran_core1);
+}
+
+static void check_order(void)
+{
+    core1_job_stats_t before, after;
+    core1_jobs_get_stats(&before);
+    run_count = 0;
+    spin_mask = 0x3ff;
+
+    uint32_t refused = 0;
+    for (uint32_t i = 0; i < job_count; i++) {
+        while (!core1_job_submit(log_job, (void*)(uintptr_t)i, CORE1_JOB_NO_INLINE)) {
+            refused++;
+            sched_yield();
+        }
+        if ((rnd() & 0xff) == 0) usleep(rnd() & 0x7f);
+    }
+    core1_drain();
+    spin_mask = 0;
+
+    if (run_count != job_count)
+        fail("order: %u jobs run, %u submitted", run_count, job_count);
+    uint32_t n = run_count < job_count ? run_count : job_count;
+    for (uint32_t i = 0; i < n; i++) {
+        if (run_log[i].id != i) {
+            fail("order: job %u ran as #%u", run_log[i].id, i);
+            break;
+        }
+        if (run_log[i].core != 1) {
+            fail("order: job %u ran on core %u", i, run_log[i].core);
+            break;
+        }
+    }
+
+    core1_jobs_get_stats(&after);
+    if (after.ran_core1 - before.ran_core1 != job_count)
+        fail("order: stats ran_core1 +%u, expected +%u",
+             after.ran_core1 - before.ran_core1, job_count);
+    if (after.high_water > CORE1_JOB_QUEUE_SIZE)
+        fail("order: ring reached depth %u of %u", after.high_water, CORE1_JOB_QUEUE_SIZE);
+    if (verbose)
+        printf("  order: %u jobs, %u refused while full, high water %u\n",
+               job_count, refused, after.high_water);
+}
+
+static void check_full_ring(void)
+{
+    run_count = 0;
+    gate_close();
+
+    for (uint32_t i = 0; i < CORE1_JOB_QUEUE_SIZE; i++) {
+        if (!core1_job_submit(log_job, (void*)(uintptr_t)i, CORE1_JOB_NO_INLINE))
+            fail("full: job %u refused with %u queued", i, i);
+    }
+    if (run_count != 0) fail("full: %u jobs ran while Core 1 was held", run_count);
+
+    if (core1_job_submit(log_job, (void*)100, CORE1_JOB_NO_INLINE))
+        fail("full: NO_INLINE job accepted by a full ring");
+    if (!core1_job_submit(log_job, (void*)200, CORE1_JOB_DEFAULT))
+        fail("full: default job refused by a full ring");
+    if (run_count != 1 || run_log[0].id != 200 || run_log[0].core != 0)
+        fail("full: default job did not run inline on Core 0");
+    if (!core1_jobs_busy()) fail("full: ring not busy with jobs queued");
+
+    gate_release();
+    core1_drain();
+
+    if (run_count != CORE1_JOB_QUEUE_SIZE + 1)
+        fail("full: %u jobs run, expected %u", run_count, CORE1_JOB_QUEUE_SIZE + 1);
+    for (uint32_t i = 1; i < run_count; i++) {
+        if (run_log[i].id != i - 1 || run_log[i].core != 1) {
+            fail("full: queued job %u ran as #%u on core %u",
+                 run_log[i].id, i, run_log[i].core);
+            break;
+        }
+    }
+}
+
+static void check_deadline(void)
+{
+    core1_job_stats_t before, after;
+    core1_jobs_get_stats(&before);
+    run_count = 0;
+    gate_close();
+
+    core1_job_submit_within(log_job, (void*)1, CORE1_JOB_DROP_LATE, 1000);
+    core1_job_submit_within(log_job, (void*)2, CORE1_JOB_DEFAULT, 1000);
+    core1_job_submit_within(log_job, (void*)3, CORE1_JOB_DROP_LATE, 10000000);
+    core1_job_submit_within(log_job, (void*)4, CORE1_JOB_DROP_LATE, 0);
+    usleep(3000);
+
+    gate_release();
+    core1_drain();
+
+    if (run_count != 3 || run_log[0].id != 2 || run_log[1].id != 3 || run_log[2].id != 4)
+        fail("deadline: expected jobs 2, 3, 4 to run, got %u jobs", run_count);
+
+    core1_jobs_get_stats(&after);
+    if (after.late - before.late != 2)
+        fail("deadline: %u late jobs counted, expected 2", after.late - before.late);
+    if (after.dropped - before.dropped != 1)
+        fail("deadline: %u dropped jobs counted, expected 1",
+             after.dropped - before.dropped);
+}
+
+static bool nested_ran;
+
+static void nested_inner(void* ctx)
+{
+    (void)ctx;
+    nested_ran = true;
+}
+
+static void nested_outer(void* ctx)
+{
+    bool* ok = ctx;
+    nested_ran = false;
+    core1_job_submit(nested_inner, NULL, CORE1_JOB_DEFAULT);
+    *ok = nested_ran && get_core_num() == 1;
+}
+
+static void check_from_core1(void)
+{
+    bool ok = false;
+    core1_job_submit(nested_outer, &ok, CORE1_JOB_NO_INLINE);
+    core1_drain();
+    if (!ok) fail("nested: job submitted on Core 1 did not run inline");
+}
+
+// ============================================================================
+// FAKE PANEL (SSD1306, page addressing)
+// ============================================================================
+
+static uint8_t panel[DISPLAY_HEIGHT / 8][DISPLAY_WIDTH];
+static uint8_t panel_page;
+static int panel_core = -1;         // Core of the flush in progress
+static uint32_t panel_flushes;
+static uint32_t panel_last_frame;
+static bool panel_ok = true;        // Cleared by the first bad frame
+
+static void panel_cmd(uint8_t cmd)
+{
+    if ((cmd & 0xF8) == 0xB0) panel_page = cmd & 0x07;
+}
+
+static uint8_t frame_byte(uint32_t frame, unsigned page, unsigned x)
+{
+    if (page == 0 && x < 2) return (uint8_t)(frame >> (8 * x));
+    return (uint8_t)(frame * 131u + page * 29u + x * 7u + 1u);
+}
+
+static void panel_fail(const char* fmt, ...)
+{
+    if (!panel_ok) return;
+    panel_ok = false;
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: display: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+static void panel_data(const uint8_t* data, size_t len)
+{
+    if (panel_page == 0) panel_core = (int)get_core_num();
+    else if (panel_core != (int)get_core_num())
+        panel_fail("page %u written from core %u mid-flush", panel_page, get_core_num());
+    if (len > DISPLAY_WIDTH) len = DISPLAY_WIDTH;
+    memcpy(panel[panel_page], data, len);
+    if (page_us) platform_sleep_us(page_us);
+
+    if (panel_page != DISPLAY_HEIGHT / 8 - 1) return;
+
+    // Whole frame sent: it must be exactly one frame Core 0 finished
+    uint32_t frame = panel[0][0] | (uint32_t)panel[0][1] << 8;
+    for (unsigned p = 0; p < DISPLAY_HEIGHT / 8; p++) {
+        for (unsigned x = 0; x < DISPLAY_WIDTH; x++) {
+            if (panel[p][x] != frame_byte(frame, p, x)) {
+                panel_fail("flush %u is torn: frame %u, page %u col %u is %02X",
+                           panel_flushes, frame, p, x, panel[p][x]);
+                p = DISPLAY_HEIGHT / 8;
+                break;
+            }
+        }
+    }
+    if (panel_flushes && frame < panel_last_frame)
+        panel_fail("frame %u sent after frame %u", frame, panel_last_frame);
+    if (panel_core != 1 && core1_jobs_available())
+        panel_fail("frame %u flushed on core %d", frame, panel_core);
+    panel_last_frame = frame;
+    panel_flushes++;
+}
+
+bool display_i2c_init(const display_i2c_config_t* config)
+{
+    (void)config;
+    display_set_transport(panel_cmd, panel_data);
+    return true;
+}
+
+static void draw_frame(uint32_t frame)
+{
+    display_clear();
+    for (unsigned p = 0; p < DISPLAY_HEIGHT / 8; p++) {
+        for (unsigned x = 0; x < DISPLAY_WIDTH; x++) {
+            uint8_t b = frame_byte(frame, p, x);
+            for (unsigned bit = 0; bit < 8; bit++) {
+                if (b & (1u << bit)) display_pixel((int16_t)x, (int16_t)(p * 8 + bit), true);
+            }
+        }
+    }
+}
+
+static void check_display(void)
+{
+    display_i2c_config_t cfg = { .addr = 0x3C };
+    display_init_ssd1306_i2c(&cfg);
+    if (!display_is_initialized()) {
+        fail("display: not initialized");
+        return;
+    }
+
+    uint32_t start = time_us_32();
+    for (uint32_t frame = 1; frame <= frame_count; frame++) {
+        draw_frame(frame);
+        display_update();
+        // Mostly back to back; now and then idle long enough for the flush
+        if ((rnd() & 7) == 0) platform_sleep_us(rnd() % (page_us * 16 + 1));
+    }
+    uint32_t draw_us = time_us_32() - start;
+    core1_drain();
+
+    if (panel_flushes == 0) fail("display: nothing reached the panel");
+    else if (panel_last_frame != frame_count)
+        fail("display: panel shows frame %u, last drawn %u", panel_last_frame, frame_count);
+    if (verbose)
+        printf("  display: %u frames drawn in %u us, %u flushes\n",
+               frame_count, draw_us, panel_flushes);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "vs:n:f:d:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': job_count = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'f': frame_count = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'd': page_us = (unsigned)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-s seed] [-n jobs] [-f frames] [-d page_us]\n",
+                        argv[0]);
+                return 2;
+        }
+    }
+    if (frame_count == 0 || frame_count > 0xFFFF) frame_count = 3000;
+    printf("core1-jobs-check seed %u\n", seed);
+
+    run_log = calloc(job_count + CORE1_JOB_QUEUE_SIZE + 8, sizeof(*run_log));
+    if (!run_log) return 2;
+
+    check_detached();
+    core1_start();
+    check_order();
+    check_full_ring();
+    check_deadline();
+    check_from_core1();
+    check_display();
+    core1_halt();
+
+    free(run_log);
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
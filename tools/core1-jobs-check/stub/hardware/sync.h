@@ -0,0 +1,11 @@
+// Minimal hardware/sync.h for the host build of core1_jobs.c. check.c runs
+// each core as a pthread: get_core_num() is per thread and __sev()/__wfe()
+// model the event register with a condition variable.
+#ifndef HARDWARE_SYNC_H
+#define HARDWARE_SYNC_H
+
+unsigned get_core_num(void);
+void __sev(void);
+void __wfe(void);
+
+#endif
@@ -0,0 +1,11 @@
+// Minimal pico/stdlib.h for the host build of core1_jobs.c. The clock is
+// provided by check.c.
+#ifndef PICO_STDLIB_H
+#define PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+uint32_t time_us_32(void);
+
+#endif
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+# Fixture check of tools/footprint.py.
+# Usage: check.py [-v] [--update]
+#
+# Runs footprint.py against a saved linker map and objdump output for a small
+# RP2040 image (fixtures/rp2040, with stub/objdump standing in for the
+# toolchain's) and compares its stdout, stderr, JSON report and exit status
+# with expected/<case>.{out,err,json}. The image has a library archive
+# member, pico-sdk and TinyUSB objects, split input-section lines, fill,
+# RAM-resident code with a flash load image, NOLOAD .bss, a veneer and an
+# indirect call.
+#
+# --update rewrites expected/ from the current output (check the diff before
+# committing it). Exit status 1 if any case differs.
+import argparse
+import difflib
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FOOTPRINT = os.path.join(HERE, "..", "footprint.py")
+COMMON = ["--elf", "fixtures/rp2040/fw.elf", "--objdump", "stub/objdump"]
+
+# name, extra arguments, expected exit status
+CASES = [
+    # everything within budget
+    ("report", ["--config", "fixtures/budgets-ok.json", "--check"], 0),
+    # size and hot-path budgets exceeded, per platform and per target
+    ("over-budget", ["--config", "fixtures/budgets-tight.json", "--check"], 1),
+    # without --check an over-budget build is reported but doesn't fail
+    ("over-budget-report", ["--config", "fixtures/budgets-tight.json"], 0),
+    # module rows folded into "(N more)", shallower module paths
+    ("top", ["--config", "fixtures/budgets-ok.json", "--top", "3", "--depth", "1"], 0),
+    # no map: hot-path report only
+    ("no-map", ["--config", "fixtures/budgets-ok.json", "--map", "fixtures/rp2040/missing.map",
+                "--check"], 0),
+]
+
+
+def run_case(args, json_path):
+    cmd = [sys.executable, FOOTPRINT] + COMMON + args + ["--json", json_path]
+    r = subprocess.run(cmd, cwd=HERE, capture_output=True, text=True)
+    with open(json_path) as f:
+        report = json.dumps(json.load(f), indent=1, sort_keys=True) + "\n"
+    return r.returncode, r.stdout, r.stderr, report
+
+
+def compare(name, what, got, want, verbose):
+    if got == want:
+        return True
+    print("  FAIL: %s: %s differs" % (name, what))
+    if verbose:
+        sys.stdout.writelines(difflib.unified_diff(want.splitlines(True), got.splitlines(True),
+                                                   "expected", "got"))
+    return False
+
+
+def main():
+    p = argparse.ArgumentParser(prog="check")
+    p.add_argument("-v", action="store_true", help="show diffs")
+    p.add_argument("--update", action="store_true", help="rewrite expected/ from the output")
+    args = p.parse_args()
+
+    failures = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        for name, extra, status in CASES:
+            rc, out, err, report = run_case(extra, os.path.join(tmp, name + ".json"))
+            base = os.path.join(HERE, "expected", name)
+
+            if args.update:
+                for ext, text in (("out", out), ("err", err), ("json", report)):
+                    with open(base + "." + ext, "w") as f:
+                        f.write(text)
+
+            ok = True
+            if rc != status:
+                print("  FAIL: %s: exit status %d, expected %d" % (name, rc, status))
+                ok = False
+            for ext, what, got in (("out", "report", out), ("err", "stderr", err),
+                                   ("json", "JSON", report)):
+                with open(base + "." + ext) as f:
+                    ok &= compare(name, what, got, f.read(), args.v)
+            if args.v or not ok:
+                print("%-20s %s" % (name, "ok" if ok else "FAILED"))
+            failures += not ok
+
+    print("footprint-check: %d cases, %s" % (len(CASES), "FAILED" if failures else "ok"))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
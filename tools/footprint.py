@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+# RAM/flash footprint and hot-path placement report for a linked firmware ELF.
+# Usage: footprint.py --elf <fw.elf> [--map <fw.elf.map>] [--target <name>]
+#                     [--platform rp2040|rp2350|nrf52840|esp32s3]
+#                     [--config tools/footprint.json] [--check] [--json <out>]
+#
+# Three parts:
+#   modules   RAM and flash bytes per source module, from the linker map.
+#             Initialised RAM (.data, RAM-resident code) counts twice: once
+#             in RAM and once in flash for its load image.
+#   hot path  Walks the static call graph (objdump -d) from the hot roots in
+#             the config and lists every reachable function that executes
+#             from XIP flash, with the call chain that reaches it. Indirect
+#             calls (function pointers) can't be followed and are counted.
+#             Linker veneers are resolved to the function they jump to.
+#   budgets   With --check, exits non-zero when total RAM/flash or the number
+#             of flash-resident hot functions per root group exceeds the
+#             budget for the target (or platform default) in the config.
+#
+# Runs on the build host; needs only the toolchain's objdump. Wired into the
+# build as the <target>_footprint CMake target (see src/CMakeLists.txt).
+# tools/footprint-check runs it against saved fixtures.
+import argparse
+import fnmatch
+import json
+import os
+import re
+import subprocess
+import sys
+from collections import defaultdict, deque
+
+# (start, end) address ranges; end exclusive
+PLATFORMS = {
+    "rp2040":   {"flash": [(0x10000000, 0x20000000)], "ram": [(0x20000000, 0x20042000)]},
+    "rp2350":   {"flash": [(0x10000000, 0x20000000)], "ram": [(0x20000000, 0x20082000)]},
+    "nrf52840": {"flash": [(0x00000000, 0x00100000)], "ram": [(0x20000000, 0x20040000)]},
+    "esp32s3":  {"flash": [(0x3c000000, 0x3e000000), (0x42000000, 0x44000000)],
+                 "ram":   [(0x3fc88000, 0x3fd00000), (0x40370000, 0x403e0000)]},
+}
+
+# Output sections with no load image (RAM only)
+NOLOAD_SECTIONS = re.compile(r"^\.(bss|heap|stack|uninitialized|noinit|scratch_[xy]_bss)")
+
+CALL_MNEMONICS = re.compile(r"^(bl|blx|b|b\.w|b\.n|b(eq|ne|cs|cc|mi|pl|vs|vc|hi|ls|ge|lt|gt|le)(\.w|\.n)?|"
+                            r"call(0|4|8|12)|j)$")
+INDIRECT_CALL = re.compile(r"^\s*[0-9a-f]+:\s+(?:[0-9a-f]{4}(?: [0-9a-f]{4})?\s+)?(blx\s+r\d+|callx\d+)")
+FUNC_HEADER = re.compile(r"^([0-9a-f]+) <([^>]+)>:$")
+INSN = re.compile(r"^\s*([0-9a-f]+):\s+(?:[0-9a-f]{4}(?: [0-9a-f]{4})?\s+)?(\S+)\s+([0-9a-f]+) <([^>+]+)(\+0x[0-9a-f]+)?>")
+WORD = re.compile(r"^\s*[0-9a-f]+:\s+(?:[0-9a-f]{8}\s+)?\.word\s+0x([0-9a-f]+)")
+SYMBOL = re.compile(r"^([0-9a-f]+)\s+(.{7})\s+(\S+)\s+([0-9a-f]+)\s+(?:\.hidden\s+)?(\S+)$")
+
+
+def in_ranges(addr, ranges):
+    return any(lo <= addr < hi for lo, hi in ranges)
+
+
+def run(tool, *args):
+    try:
+        return subprocess.run([tool] + list(args), check=True, capture_output=True,
+                              text=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.stderr.write("footprint: %s failed: %s\n" % (tool, e))
+        sys.exit(2)
+
+
+# ============================================================================
+# MODULES (linker map)
+# ============================================================================
+
+def module_of(obj, depth):
+    obj = obj.strip()
+    m = re.match(r"^(?:.*/)?lib([^/]+?)\.a\((.+)\)$", obj)
+    if m:
+        return "lib" + m.group(1)
+    if ".dir/" in obj:
+        obj = obj.split(".dir/", 1)[1]
+    obj = re.sub(r"\.(c|cpp|cc|S|s)\.obj$|\.obj$|\.o$", "", obj)
+    while obj.startswith("__/"):
+        obj = obj[3:]
+    for marker, name in (("pico-sdk/src/", "pico-sdk"), ("lib/tinyusb/src/", "tinyusb"),
+                         ("lib/btstack/", "btstack"), ("lib/Pico-PIO-USB/", "pico-pio-usb")):
+        if marker in obj:
+            rest = obj.split(marker, 1)[1].split("/")
+            # pico-sdk/src/<rp2_common|common|rp2040>/<component>/...
+            if name == "pico-sdk" and len(rest) > 2:
+                return "pico-sdk/" + rest[1]
+            return name + ("/" + rest[0] if len(rest) > 1 and name != "btstack" else "")
+    if "/src/" in obj:
+        obj = obj.rsplit("/src/", 1)[1]
+    parts = obj.split("/")[:-1]
+    return "/".join(parts[:depth]) if parts else "(top)"
+
+
+def parse_map(path, platform, depth):
+    ranges = PLATFORMS[platform]
+    usage = defaultdict(lambda: [0, 0])   # module -> [flash, ram]
+    out_sec, out_loads = None, False
+    pending = None
+
+    with open(path, errors="replace") as f:
+        lines = f.read().split("\n")
+
+    start = next((i for i, l in enumerate(lines) if l.startswith("Linker script and memory map")), 0)
+    for line in lines[start:]:
+        if line.startswith("/DISCARD/"):
+            out_sec = None
+            continue
+        m = re.match(r"^(\.\S+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)(?:\s+load address 0x([0-9a-f]+))?)?\s*$", line)
+        if m:
+            out_sec = m.group(1)
+            vma = int(m.group(2), 16) if m.group(2) else None
+            lma = int(m.group(4), 16) if m.group(4) else None
+            out_loads = (lma is not None and lma != vma) and not NOLOAD_SECTIONS.match(out_sec)
+            continue
+        m = re.match(r"^\s+load address 0x([0-9a-f]+)", line)
+        if m and out_sec:
+            out_loads = not NOLOAD_SECTIONS.match(out_sec)
+            continue
+        if out_sec is None or out_sec.startswith((".debug", ".comment", ".ARM.attributes")):
+            continue
+
+        # Input section, on one line or with the name alone on the first
+        m = re.match(r"^ (\S+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$", line)
+        if not m and pending:
+            m2 = re.match(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$", line)
+            if m2:
+                m = (pending, m2.group(1), m2.group(2), m2.group(3))
+            pending = None
+        elif m:
+            m = m.groups()
+            pending = None
+        else:
+            n = re.match(r"^ (\.\S+|COMMON)$", line)
+            pending = n.group(1) if n else None
+            continue
+        if not m:
+            continue
+
+        name, addr, size, obj = m[0], int(m[1], 16), int(m[2], 16), m[3]
+        if name.startswith("*") or size == 0 or obj.startswith("0x"):
+            continue
+        mod = module_of(obj, depth)
+        if in_ranges(addr, ranges["flash"]):
+            usage[mod][0] += size
+        elif in_ranges(addr, ranges["ram"]):
+            usage[mod][1] += size
+            if out_loads:
+                usage[mod][0] += size
+    return usage
+
+
+# ============================================================================
+# CALL GRAPH (objdump)
+# ============================================================================
+
+def load_symbols(text):
+    funcs = {}      # name -> (addr, size)
+    by_addr = {}
+    for line in text.split("\n"):
+        m = SYMBOL.match(line)
+        if not m or "F" not in m.group(2):
+            continue
+        addr, size, name = int(m.group(1), 16) & ~1, int(m.group(4), 16), m.group(5)
+        funcs[name] = (addr, size)
+        by_addr.setdefault(addr, name)
+    return funcs, by_addr
+
+
+def load_calls(text, funcs, by_addr):
+    calls = defaultdict(set)
+    indirect = defaultdict(int)
+    veneer_words = defaultdict(list)
+    cur = None
+    for line in text.split("\n"):
+        m = FUNC_HEADER.match(line)
+        if m:
+            cur = m.group(2) if m.group(2) in funcs else None
+            continue
+        if cur is None:
+            continue
+        m = INSN.match(line)
+        if m and CALL_MNEMONICS.match(m.group(2)):
+            target = m.group(4)
+            if target != cur or not m.group(5):
+                if target != cur:
+                    calls[cur].add(target)
+            continue
+        if INDIRECT_CALL.match(line):
+            indirect[cur] += 1
+            continue
+        if cur.endswith("_veneer"):
+            w = WORD.match(line)
+            if w:
+                veneer_words[cur].append(int(w.group(1), 16) & ~1)
+
+    # A veneer stands in for the function it jumps to
+    for v in [f for f in funcs if f.endswith("_veneer")]:
+        target = next((by_addr[a] for a in veneer_words.get(v, []) if a in by_addr), None)
+        if target is None:
+            base = re.sub(r"^__", "", re.sub(r"_veneer$", "", v))
+            base = re.sub(r"^(?:thumb_)?", "", base)
+            target = base if base in funcs else None
+        if target:
+            calls[v] = {target}
+    return calls, indirect
+
+
+def walk(roots, calls):
+    parent = {r: None for r in roots}
+    queue = deque(roots)
+    while queue:
+        f = queue.popleft()
+        for c in sorted(calls.get(f, ())):
+            if c not in parent:
+                parent[c] = f
+                queue.append(c)
+    return parent
+
+
+def chain(parent, f):
+    if f is None:
+        return "(root)"
+    out = []
+    while f is not None:
+        if not f.endswith("_veneer"):
+            out.append(f)
+        f = parent[f]
+    return " <- ".join(out)
+
+
+# ============================================================================
+# MAIN
+# ============================================================================
+
+def main():
+    p = argparse.ArgumentParser(prog="footprint")
+    p.add_argument("--elf", required=True)
+    p.add_argument("--map", help="linker map (default: <elf>.map if present)")
+    p.add_argument("--target", help="budget key (default: ELF basename)")
+    p.add_argument("--platform", default="rp2040", choices=sorted(PLATFORMS))
+    p.add_argument("--config", default=os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                   "footprint.json"))
+    p.add_argument("--objdump", default="arm-none-eabi-objdump")
+    p.add_argument("--depth", type=int, default=3, help="module path depth")
+    p.add_argument("--top", type=int, default=25, help="modules listed (0 = all)")
+    p.add_argument("--check", action="store_true", help="fail when a budget is exceeded")
+    p.add_argument("--json", help="also write the report as JSON")
+    args = p.parse_args()
+
+    target = args.target or os.path.splitext(os.path.basename(args.elf))[0]
+    with open(args.config) as f:
+        config = json.load(f)
+    budget = dict(config.get("platforms", {}).get(args.platform, {}))
+    budget.update(config.get("targets", {}).get(target, {}))
+    hot_budget = dict(config.get("hot_flash", {}))
+    hot_budget.update(budget.get("hot_flash", {}))
+    allow = config.get("hot_allow", [])
+    ranges = PLATFORMS[args.platform]
+
+    report = {"target": target, "platform": args.platform}
+    failures = []
+
+    # ---- Modules ----
+    map_path = args.map or (args.elf + ".map")
+    if os.path.exists(map_path):
+        usage = parse_map(map_path, args.platform, args.depth)
+        flash = sum(u[0] for u in usage.values())
+        ram = sum(u[1] for u in usage.values())
+        print("[footprint] %s (%s): flash %d bytes, RAM %d bytes" % (target, args.platform, flash, ram))
+        rows = sorted(usage.items(), key=lambda kv: -(kv[1][0] + kv[1][1]))
+        shown = rows if args.top == 0 else rows[:args.top]
+        print("  %-40s %10s %10s" % ("module", "flash", "ram"))
+        for mod, (fl, rm) in shown:
+            print("  %-40s %10d %10d" % (mod, fl, rm))
+        if len(shown) < len(rows):
+            rest = rows[len(shown):]
+            print("  %-40s %10d %10d" % ("(%d more)" % len(rest),
+                                         sum(r[1][0] for r in rest), sum(r[1][1] for r in rest)))
+        report.update(flash=flash, ram=ram, modules={k: {"flash": v[0], "ram": v[1]} for k, v in rows})
+
+        for key, used in (("flash_kb", flash), ("ram_kb", ram)):
+            limit = budget.get(key)
+            if limit is not None and used > limit * 1024:
+                failures.append("%s %d bytes > budget %d KB" % (key[:-3], used, limit))
+    else:
+        print("[footprint] %s: no map file (%s), module report skipped" % (target, map_path))
+
+    # ---- Hot path ----
+    funcs, by_addr = load_symbols(run(args.objdump, "-t", args.elf))
+    calls, indirect = load_calls(run(args.objdump, "-d", "--no-show-raw-insn", args.elf), funcs, by_addr)
+    report["hot"] = {}
+
+    for group, patterns in config.get("hot_roots", {}).items():
+        roots = sorted(f for f in funcs if any(fnmatch.fnmatchcase(f, pat) for pat in patterns))
+        if not roots:
+            continue
+        parent = walk(roots, calls)
+        reached = [f for f in parent if not f.endswith("_veneer")]
+        in_flash = sorted(f for f in reached
+                          if in_ranges(funcs.get(f, (0, 0))[0], ranges["flash"])
+                          and not any(fnmatch.fnmatchcase(f, pat) for pat in allow))
+        blind = sorted(f for f in reached if indirect.get(f))
+
+        print("[footprint] hot/%s: %d roots, %d functions reached, %d in flash, "
+              "%d with indirect calls" % (group, len(roots), len(reached), len(in_flash), len(blind)))
+        for f in in_flash:
+            print("  FLASH %-32s %5d  %s" % (f, funcs[f][1], chain(parent, parent[f])))
+        report["hot"][group] = {
+            "roots": roots,
+            "reached": len(reached),
+            "flash": [{"function": f, "size": funcs[f][1], "via": chain(parent, parent[f])}
+                      for f in in_flash],
+            "indirect": {f: indirect[f] for f in blind},
+        }
+
+        limit = hot_budget.get(group)
+        if limit is not None and len(in_flash) > limit:
+            failures.append("hot/%s: %d flash-resident functions > budget %d"
+                            % (group, len(in_flash), limit))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=1)
+
+    for msg in failures:
+        sys.stderr.write("footprint: %s: %s\n" % (target, msg))
+    if args.check and failures:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Generate the synthetic gyro traces in traces/.
+
+Each trace is raw int16 gyro samples the way a controller driver hands them
+to the router (DS4 / SDL axes: pitch, yaw, roll). `expect total` is worked
+out here with the same integer rate conversion gyro_aim.c uses, so the
+replay checks the integration itself and not only the accounting.
+
+Deterministic: running it again rewrites identical files.
+"""
+
+import math
+import os
+
+RANGE = 2000
+OUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "traces")
+
+
+def raw(dps):
+    return max(-32768, min(32767, int(round(dps * 32768 / RANGE))))
+
+
+def rate_mdps(r):
+    # C integer division truncates toward zero
+    n = r * RANGE * 1000
+    return int(n / 32768) if n >= 0 else -int(-n / 32768)
+
+
+class Lcg:
+    def __init__(self, seed):
+        self.s = seed
+
+    def next(self, lo, hi):
+        self.s = (self.s * 1103515245 + 12345) & 0xFFFFFFFF
+        return lo + (self.s >> 8) % (hi - lo + 1)
+
+
+def write(name, header, samples, total=None, skip_first_dt=False):
+    """samples: list of (dt_us, pitch, yaw, roll) raw"""
+    lines = [f"# {name} - generated by gen_traces.py, do not edit"]
+    lines += header
+    if total is not None:
+        x = y = 0
+        for i, (dt, p, yw, _r) in enumerate(samples):
+            if skip_first_dt and i == 0:
+                continue
+            x += -rate_mdps(yw) * dt
+            y += -rate_mdps(p) * dt
+        # mdps x us -> micro-degrees
+        lines.append(f"expect total {int(x / 1000)} {int(y / 1000)} {total}")
+    lines += [f"{dt} {p} {yw} {r}" for dt, p, yw, r in samples]
+    with open(os.path.join(OUT, name), "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def still(n, dt):
+    return [(dt, 0, 0, 0)] * n
+
+
+def ds4_sweep():
+    # 250 Hz: settle, sweep both axes, one hard flick, settle
+    dt = 4000
+    s = still(125, dt)
+    for i in range(500):
+        t = i * dt / 1e6
+        s.append((dt, raw(60 * math.sin(2 * math.pi * 1.3 * t)),
+                  raw(180 * math.sin(2 * math.pi * 0.7 * t)), 0))
+    for i in range(40):
+        # 160 ms flick peaking at 900 dps
+        s.append((dt, 0, raw(-900 * math.sin(math.pi * i / 40)), 0))
+    s += still(125, dt)
+    write("ds4_sweep.txt", [f"range {RANGE}"], s, total=1000)
+
+
+def switch_fine_aim():
+    # Switch IMU at 5 ms per frame, slow corrections well under one mouse
+    # count or stick unit per report
+    dt = 5000
+    s = still(100, dt)
+    for i in range(1200):
+        t = i * dt / 1e6
+        s.append((dt, raw(1.5 * math.sin(2 * math.pi * 0.4 * t) + 2.0),
+                  raw(-2.5 * math.cos(2 * math.pi * 0.25 * t) - 1.0), 0))
+    s += still(100, dt)
+    write("switch_fine_aim.txt", [f"range {RANGE}"], s, total=1000)
+
+
+def bt_jitter():
+    # Bluetooth arrival with jitter, timed by arrival; first sample has no dt
+    rng = Lcg(7)
+    s = [(4000, 0, 0, 0)] * 100
+    for i in range(900):
+        dt = rng.next(2000, 9000)
+        phase = i / 900
+        s.append((dt, raw(40 * math.sin(2 * math.pi * 3 * phase)),
+                  raw(120 * math.sin(2 * math.pi * 2 * phase)
+                      + 20 * math.sin(2 * math.pi * 11 * phase)), 0))
+    s += [(4000, 0, 0, 0)] * 100
+    write("bt_jitter.txt", [f"range {RANGE}", "timing arrival"], s, total=1000,
+          skip_first_dt=True)
+
+
+def biased_still():
+    # Controller on a desk: constant zero-rate offset plus sensor noise for
+    # 10 s. Uncorrected this would drift over 13 degrees of yaw.
+    rng = Lcg(99)
+    dt = 4000
+    s = []
+    for _ in range(2500):
+        s.append((dt, 15 + rng.next(-3, 3), -22 + rng.next(-3, 3), 8 + rng.next(-3, 3)))
+    write("biased_still.txt", [f"range {RANGE}", "expect drift 400 150000"], s)
+
+
+if __name__ == "__main__":
+    os.makedirs(OUT, exist_ok=True)
+    ds4_sweep()
+    switch_fine_aim()
+    bt_jitter()
+    biased_still()
@@ -0,0 +1,408 @@
+// replay.c - replays recorded gyro traces through the firmware's gyro_aim.c
+// and checks that no rotation is lost between samples and output reports
+//
+// Each trace is played against several output report schedules (1 ms, 8 ms,
+// 16.67 ms and a jittered one) in both stick and mouse mode. Samples are
+// integrated into a gyro_aim_accum_t the way router.c does on the input
+// side; reports drain it the way router_gyro_aim_apply does. For every run:
+//   - aim emitted in reports + aim still pending == aim integrated, exactly
+//     (less anything refused at the backlog cap, which is reported)
+//   - after a flush, every schedule has emitted the same rotation to within
+//     one output step
+// A naive per-report conversion (latest sample x report interval) is run
+// beside it for comparison.
+//
+// Usage: gyro-aim-replay [-v] trace.txt...
+//   -v  print every run, not just the per-trace summary
+// Exit status 1 if any check fails.
+//
+// Trace format, one item per line, '#' starts a comment:
+//   range <dps>                        full scale of the raw samples (default 2000)
+//   timing arrival                     pass dt 0 and let the engine time samples
+//                                      by arrival (default: sample dt is sent)
+//   <dt_us> <pitch> <yaw> <roll>       one raw int16 gyro sample
+//   expect total <x> <y> <tol>         integrated aim at 1.0x, micro-degrees
+//   expect drift <from> <max>          aim integrated from sample <from> on stays
+//                                      within <max> micro-degrees per axis
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "core/router/gyro_aim.h"
+
+#define MAX_SAMPLES     100000
+#define MAX_LINE        256
+#define FLUSH_US        3000000     // Reports after the trace to drain what's left
+#define JITTER_MIN_US   2000
+#define JITTER_MAX_US   20000
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+typedef struct {
+    uint32_t dt_us;
+    int16_t gyro[3];
+} sample_t;
+
+typedef struct {
+    char name[64];
+    uint16_t range;
+    bool arrival;
+    int count;
+    sample_t samples[MAX_SAMPLES];
+    bool has_total;
+    int64_t total[2];
+    int64_t total_tol;
+    bool has_drift;
+    int drift_from;
+    int64_t drift_max;
+} trace_t;
+
+typedef struct {
+    const char* name;
+    uint32_t interval_us;       // 0 = jittered
+} schedule_t;
+
+typedef struct {
+    const char* name;
+    gyro_aim_config_t cfg;
+} config_t;
+
+typedef struct {
+    int64_t integrated[2];      // Sum of gyro_aim_sample output
+    int64_t emitted[2];         // Read back from the report values
+    int64_t pending[2];         // Left in the accumulator
+    int64_t clipped[2];         // Refused at GYRO_AIM_PENDING_MAX_UDEG
+    int64_t naive[2];           // Per-report baseline
+    int64_t drift[2];           // Integrated from drift_from on
+    int reports;
+} result_t;
+
+static const schedule_t schedules[] = {
+    { "1ms",     1000  },
+    { "8ms",     8000  },
+    { "16.67ms", 16667 },
+    { "jitter",  0     },
+};
+#define SCHEDULE_COUNT  (int)(sizeof(schedules) / sizeof(schedules[0]))
+
+static const config_t configs[] = {
+    { "linear", { .sens_min = 10, .sens_max = 10 } },
+    { "curve",  { .sens_min = 8, .sens_max = 25, .accel_dps = 120, .deadzone = 10 } },
+};
+#define CONFIG_COUNT    (int)(sizeof(configs) / sizeof(configs[0]))
+
+static trace_t trace;
+static bool verbose = false;
+static int failures = 0;
+static int checks = 0;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+__attribute__((format(printf, 1, 2)))
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%s: ", trace.name);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    failures++;
+}
+
+static int64_t abs64(int64_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+// Deterministic jitter: report gaps between JITTER_MIN_US and JITTER_MAX_US
+static uint32_t next_jitter(uint32_t* seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return JITTER_MIN_US + (*seed >> 8) % (JITTER_MAX_US - JITTER_MIN_US);
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+static void report(gyro_aim_accum_t* acc, const config_t* c, gyro_aim_source_t* src,
+                   const int16_t* last_gyro, uint32_t now_us, uint32_t interval_us,
+                   result_t* r)
+{
+    if (c->cfg.mode == GYRO_AIM_STICK) {
+        uint32_t prev = acc->last_us;
+        bool primed = acc->primed;
+        uint8_t rx = 128, ry = 128;            // Physical stick centred
+        gyro_aim_drain_stick(acc, &c->cfg, now_us, &rx, &ry);
+        if (primed) {
+            int64_t unit = (int64_t)(now_us - prev) * GYRO_AIM_STICK_UDEG_PER_UNIT_US;
+            r->emitted[0] += ((int)rx - 128) * unit;
+            r->emitted[1] += ((int)ry - 128) * unit;
+        }
+    } else {
+        int16_t dx = 0, dy = 0;
+        gyro_aim_drain_mouse(acc, &dx, &dy);
+        r->emitted[0] += (int64_t)dx * GYRO_AIM_MOUSE_UDEG_PER_COUNT;
+        r->emitted[1] += (int64_t)dy * GYRO_AIM_MOUSE_UDEG_PER_COUNT;
+    }
+
+    // Baseline: the latest sample's rate held for the whole report interval
+    if (last_gyro) {
+        int32_t rate[3];
+        for (int i = 0; i < 3; i++) {
+            rate[i] = (int32_t)(((int64_t)last_gyro[i] * trace.range * 1000) / 32768)
+                      - src->bias[i] / GYRO_AIM_BIAS_SCALE;
+        }
+        r->naive[0] += -(int64_t)rate[1] * interval_us / 1000;
+        r->naive[1] += -(int64_t)rate[0] * interval_us / 1000;
+    }
+    r->reports++;
+}
+
+static void replay(const config_t* c, const schedule_t* sch, result_t* r)
+{
+    gyro_aim_source_t src;
+    gyro_aim_accum_t acc;
+    gyro_aim_source_init(&src);
+    gyro_aim_accum_init(&acc);
+    memset(r, 0, sizeof(*r));
+
+    uint32_t seed = 0x1234;
+    uint32_t interval = sch->interval_us ? sch->interval_us : next_jitter(&seed);
+    uint64_t t_sample = 0;
+    uint64_t t_report = interval;
+    const int16_t* last_gyro = NULL;
+
+    int i = 0;
+    while (i < trace.count) {
+        const sample_t* s = &trace.samples[i];
+        if (t_sample + s->dt_us <= t_report) {
+            t_sample += s->dt_us;
+            int32_t aim[2];
+            uint32_t dt = trace.arrival ? 0 : s->dt_us;
+            if (gyro_aim_sample(&src, &c->cfg, s->gyro, trace.range, dt,
+                                (uint32_t)t_sample, true, aim)) {
+                int32_t before[2] = { gyro_aim_accum_pending(&acc, 0),
+                                      gyro_aim_accum_pending(&acc, 1) };
+                gyro_aim_accum_add(&acc, aim);
+                for (int a = 0; a < 2; a++) {
+                    r->integrated[a] += aim[a];
+                    r->clipped[a] += aim[a] - (gyro_aim_accum_pending(&acc, a) - before[a]);
+                    if (i >= trace.drift_from) r->drift[a] += aim[a];
+                }
+            }
+            last_gyro = s->gyro;
+            i++;
+        } else {
+            report(&acc, c, &src, last_gyro, (uint32_t)t_report, interval, r);
+            interval = sch->interval_us ? sch->interval_us : next_jitter(&seed);
+            t_report += interval;
+        }
+    }
+
+    // Flush: keep reporting with the controller gone quiet
+    uint64_t end = t_report + FLUSH_US;
+    while (t_report < end) {
+        report(&acc, c, &src, NULL, (uint32_t)t_report, interval, r);
+        interval = sch->interval_us ? sch->interval_us : next_jitter(&seed);
+        t_report += interval;
+    }
+
+    for (int a = 0; a < 2; a++) r->pending[a] = gyro_aim_accum_pending(&acc, a);
+}
+
+static void run_trace(void)
+{
+    for (int ci = 0; ci < CONFIG_COUNT; ci++) {
+        for (int mode = GYRO_AIM_STICK; mode <= GYRO_AIM_MOUSE; mode++) {
+            config_t c = configs[ci];
+            c.cfg.mode = (uint8_t)mode;
+            const char* mode_name = mode == GYRO_AIM_STICK ? "stick" : "mouse";
+
+            result_t first = { 0 };
+            for (int si = 0; si < SCHEDULE_COUNT; si++) {
+                result_t r;
+                replay(&c, &schedules[si], &r);
+
+                // Nothing lost: what went out plus what's left is what came in.
+                // The only exception is the backlog cap, when a saturated stick
+                // falls more than GYRO_AIM_PENDING_MAX_UDEG behind.
+                for (int a = 0; a < 2; a++) {
+                    checks++;
+                    int64_t lost = r.integrated[a] - r.clipped[a] - r.emitted[a] - r.pending[a];
+                    if (lost != 0) {
+                        fail("%s/%s/%s axis %d: %lld udeg lost", c.name, mode_name,
+                             schedules[si].name, a, (long long)lost);
+                    }
+                }
+
+                // Every schedule ends up in the same place. Whatever is still
+                // pending must be less than one output step (one stick unit
+                // over the longest report gap).
+                int64_t step = mode == GYRO_AIM_MOUSE ? GYRO_AIM_MOUSE_UDEG_PER_COUNT
+                                                      : JITTER_MAX_US * GYRO_AIM_STICK_UDEG_PER_UNIT_US;
+                for (int a = 0; a < 2; a++) {
+                    checks++;
+                    if (abs64(r.pending[a]) >= step) {
+                        fail("%s/%s/%s axis %d: %lld udeg never emitted", c.name, mode_name,
+                             schedules[si].name, a, (long long)r.pending[a]);
+                    }
+                }
+                if (si == 0) {
+                    first = r;
+                } else {
+                    for (int a = 0; a < 2; a++) {
+                        checks++;
+                        if (r.integrated[a] != first.integrated[a]) {
+                            fail("%s/%s/%s axis %d: integrated %lld, %s integrated %lld",
+                                 c.name, mode_name, schedules[si].name, a,
+                                 (long long)r.integrated[a], schedules[0].name,
+                                 (long long)first.integrated[a]);
+                        }
+                    }
+                }
+
+                if (verbose) {
+                    printf("%-18s %-6s %-5s %-7s in %10lld %10lld  out %10lld %10lld"
+                           "  left %6lld %6lld  capped %lld %lld\n",
+                           trace.name, c.name, mode_name, schedules[si].name,
+                           (long long)r.integrated[0], (long long)r.integrated[1],
+                           (long long)r.emitted[0], (long long)r.emitted[1],
+                           (long long)r.pending[0], (long long)r.pending[1],
+                           (long long)r.clipped[0], (long long)r.clipped[1]);
+                }
+
+                // The baseline only means something at linear 1.0x
+                if (ci == 0 && mode == GYRO_AIM_MOUSE) {
+                    printf("%-18s %-7s %5d reports, naive per-report error %7.2f%% x %7.2f%% y\n",
+                           trace.name, schedules[si].name, r.reports,
+                           r.integrated[0] ? 100.0 * (r.naive[0] - r.integrated[0]) / r.integrated[0] : 0.0,
+                           r.integrated[1] ? 100.0 * (r.naive[1] - r.integrated[1]) / r.integrated[1] : 0.0);
+                }
+
+                if (ci != 0 || si != 0) continue;
+
+                // Trace expectations apply to the linear 1.0x config
+                if (trace.has_total) {
+                    for (int a = 0; a < 2; a++) {
+                        checks++;
+                        if (abs64(r.integrated[a] - trace.total[a]) > trace.total_tol) {
+                            fail("axis %d integrated %lld udeg, expected %lld +/- %lld", a,
+                                 (long long)r.integrated[a], (long long)trace.total[a],
+                                 (long long)trace.total_tol);
+                        }
+                    }
+                }
+                if (trace.has_drift) {
+                    for (int a = 0; a < 2; a++) {
+                        checks++;
+                        if (abs64(r.drift[a]) > trace.drift_max) {
+                            fail("axis %d drifted %lld udeg after sample %d, max %lld", a,
+                                 (long long)r.drift[a], trace.drift_from,
+                                 (long long)trace.drift_max);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ============================================================================
+// FILES
+// ============================================================================
+
+static bool load_trace(const char* file)
+{
+    FILE* f = fopen(file, "r");
+    if (!f) {
+        perror(file);
+        failures++;
+        return false;
+    }
+
+    memset(&trace, 0, sizeof(trace));
+    const char* base = strrchr(file, '/');
+    snprintf(trace.name, sizeof(trace.name), "%s", base ? base + 1 : file);
+    trace.range = 2000;
+    trace.drift_from = MAX_SAMPLES;
+
+    char buf[MAX_LINE];
+    int line = 0;
+    bool ok = true;
+    while (fgets(buf, sizeof(buf), f)) {
+        line++;
+        char* s = buf;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#' || *s == '\n' || *s == '\0') continue;
+
+        long long a, b, c;
+        unsigned v;
+        int dt, g0, g1, g2;
+        if (sscanf(s, "range %u", &v) == 1) {
+            trace.range = (uint16_t)v;
+        } else if (strncmp(s, "timing arrival", 14) == 0) {
+            trace.arrival = true;
+        } else if (sscanf(s, "expect total %lld %lld %lld", &a, &b, &c) == 3) {
+            trace.has_total = true;
+            trace.total[0] = a;
+            trace.total[1] = b;
+            trace.total_tol = c;
+        } else if (sscanf(s, "expect drift %lld %lld", &a, &b) == 2) {
+            trace.has_drift = true;
+            trace.drift_from = (int)a;
+            trace.drift_max = b;
+        } else if (sscanf(s, "%d %d %d %d", &dt, &g0, &g1, &g2) == 4 && dt > 0) {
+            if (trace.count >= MAX_SAMPLES) {
+                fprintf(stderr, "%s:%d: more than %d samples\n", file, line, MAX_SAMPLES);
+                ok = false;
+                break;
+            }
+            sample_t* smp = &trace.samples[trace.count++];
+            smp->dt_us = (uint32_t)dt;
+            smp->gyro[0] = (int16_t)g0;
+            smp->gyro[1] = (int16_t)g1;
+            smp->gyro[2] = (int16_t)g2;
+        } else {
+            fprintf(stderr, "%s:%d: unrecognised line\n", file, line);
+            ok = false;
+        }
+    }
+    fclose(f);
+    if (!ok) failures++;
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        if (opt == 'v') verbose = true;
+        else {
+            fprintf(stderr, "usage: %s [-v] trace.txt...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-v] trace.txt...\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        if (load_trace(argv[i])) run_trace();
+    }
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
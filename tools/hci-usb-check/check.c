@@ -0,0 +1,811 @@
+// check.c - host check of the TinyUSB HCI transport's ACL rings
+//
+// Includes hci_transport_h2_tinyusb.c from the tree (so its ring state can be
+// inspected between calls) and builds it against stub TinyUSB and BTstack
+// headers (stub/). check.c plays the other three parties:
+//   - the host controller: usbh_edpt_xfer() and tuh_control_xfer() arm an
+//     endpoint, and a dongle model completes armed transfers through the
+//     class driver's callbacks, as tuh_task() would;
+//   - BTstack: hci.c's one outgoing packet buffer, reserved by each send and
+//     released by HCI_EVENT_TRANSPORT_PACKET_SENT, and a packet handler that
+//     checks every packet it is handed;
+//   - the main loop: each pass calls hci_transport_h2_tinyusb_process() and
+//     the embedded run loop, which polls the transport's data source again.
+//
+// Checks:
+//   - ACL IN, events and ACL OUT arrive complete and in order; ACL IN is
+//     handed over in place, with HCI_INCOMING_PRE_BUFFER_SIZE writable bytes
+//     in front of it;
+//   - the bulk IN is re-armed as soon as a transfer completes while a ring
+//     slot is free, and never submitted twice;
+//   - PACKET_SENT never comes from inside send_packet(), the packet handler
+//     is never re-entered, and BTstack is always woken after it saw a full
+//     OUT queue;
+//   - a failed OUT transfer or submit loses only that packet;
+//   - a dongle removed mid-traffic delivers nothing stale after it returns;
+//   - the ACL counters match what the dongle and BTstack saw.
+//
+// Usage: hci-usb-check [-v] [-s seed] scenario
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static bool verbose;
+static int failures;
+static uint32_t seed = 1;
+
+// Firmware log, shown with -v
+static int fw_log(const char* fmt, ...)
+{
+    if (!verbose) return 0;
+    va_list ap;
+    va_start(ap, fmt);
+    printf("    | ");
+    int n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+#define printf fw_log
+#include "hci_transport_h2_tinyusb.c"
+#undef printf
+
+#define DEV         1
+#define EP_EVT      0x81
+#define EP_IN       0x82
+#define EP_OUT      0x02
+#define MAX_PKTS    4096
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static bool chance(int percent)
+{
+    return (int)(rnd() % 100) < percent;
+}
+
+// -----------------------------------------------------------------------------
+// Packet contents: every packet carries its sequence number and a pattern
+// derived from it, so order and integrity can be checked at the far end
+// -----------------------------------------------------------------------------
+
+static void fill_acl(uint8_t* p, uint32_t seq, uint16_t len)
+{
+    uint16_t handle = 0x0040 + seq % 3;
+    p[0] = handle & 0xFF;
+    p[1] = (handle >> 8) | 0x20;
+    p[2] = (len - 4) & 0xFF;
+    p[3] = (len - 4) >> 8;
+    memcpy(&p[4], &seq, 4);
+    for (int i = 8; i < len; i++) p[i] = (uint8_t)(seq * 31 + i * 7);
+}
+
+// Returns the packet's sequence number, or -1 if it isn't intact
+static int64_t check_acl(const uint8_t* p, uint16_t len)
+{
+    static uint8_t want[HCI_USB_ACL_BUF_SIZE];
+    uint32_t seq;
+
+    if (len < 8 || len > HCI_USB_ACL_BUF_SIZE) return -1;
+    memcpy(&seq, &p[4], 4);
+    fill_acl(want, seq, len);
+    return memcmp(p, want, len) ? -1 : (int64_t)seq;
+}
+
+static void fill_event(uint8_t* p, uint32_t seq, uint16_t len)
+{
+    p[0] = 0xFF;                        // vendor event
+    p[1] = (uint8_t)(len - 2);
+    memcpy(&p[2], &seq, 4);
+    for (int i = 6; i < len; i++) p[i] = (uint8_t)(seq * 13 + i);
+}
+
+static void fill_cmd(uint8_t* p, uint32_t seq, uint16_t len)
+{
+    p[0] = 0x01;                        // vendor opcode 0xFC01
+    p[1] = 0xFC;
+    p[2] = (uint8_t)(len - 3);
+    memcpy(&p[3], &seq, 4);
+    for (int i = 7; i < len; i++) p[i] = (uint8_t)(seq * 5 + i);
+}
+
+// -----------------------------------------------------------------------------
+// Host controller and dongle
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint8_t addr;
+    const char* name;
+    bool open, armed;
+    uint8_t* buf;
+    uint16_t len;
+    int fail_submits;           // fail this many of the next submits
+} ep_t;
+
+static ep_t eps[] = {
+    { EP_EVT, "event IN" },
+    { EP_IN,  "ACL IN" },
+    { EP_OUT, "ACL OUT" },
+};
+#define EP_COUNT (sizeof eps / sizeof eps[0])
+
+static struct {
+    // ACL IN: packets [in_sent, in_queued) are waiting in the dongle
+    uint32_t in_queued, in_sent;
+    uint16_t in_len[MAX_PKTS];
+    const uint8_t* in_where[MAX_PKTS];  // buffer each packet was written into
+    uint32_t in_done;                   // completed IN transfers
+    uint32_t in_starved;                // completions that filled the ring
+    // Events
+    uint32_t evt_queued, evt_sent;
+    uint16_t evt_len[MAX_PKTS];
+    // ACL OUT on the wire
+    int64_t out_last;                   // last sequence number on the wire
+    uint32_t out_wire, out_failed, out_unplugged;
+    int fail_out_xfers;                 // fail this many of the next OUT transfers
+    // Commands on the control endpoint
+    uint32_t cmds;
+    bool ctrl_armed;
+    tuh_xfer_t ctrl;
+    tusb_control_request_t ctrl_setup;
+    // Scripted pace, percent chance per tuh_task() pass
+    int in_rate, out_rate, evt_rate, ctrl_rate;
+} dongle;
+
+static uint32_t submit_failures[EP_COUNT];
+static bool in_fail_injected;           // the last IN submit was made to fail
+
+// Every ACL IN slot needs HCI_INCOMING_PRE_BUFFER_SIZE bytes in front of it
+// that no other slot's data uses
+static void check_in_slot(const uint8_t* buf)
+{
+    static const uint8_t* slots[2 * HCI_USB_ACL_IN_BUFFERS];
+    static int n;
+
+    for (int i = 0; i < n; i++) {
+        if (slots[i] == buf) return;
+        ptrdiff_t d = buf > slots[i] ? buf - slots[i] : slots[i] - buf;
+        if (d < HCI_USB_ACL_BUF_SIZE + HCI_INCOMING_PRE_BUFFER_SIZE)
+            fail("ACL IN slots %td bytes apart, need %d", d,
+                 HCI_USB_ACL_BUF_SIZE + HCI_INCOMING_PRE_BUFFER_SIZE);
+    }
+    if (n < (int)(sizeof slots / sizeof slots[0])) slots[n++] = buf;
+    else fail("ACL IN armed into more than %d buffers", n);
+}
+
+static ep_t* find_ep(uint8_t addr)
+{
+    for (size_t i = 0; i < EP_COUNT; i++)
+        if (eps[i].addr == addr) return &eps[i];
+    return NULL;
+}
+
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t* vid, uint16_t* pid)
+{
+    *vid = 0x0A12;
+    *pid = 0x0001;
+    return true;
+}
+
+bool tuh_edpt_open(uint8_t daddr, tusb_desc_endpoint_t const* desc_ep)
+{
+    ep_t* ep = find_ep(desc_ep->bEndpointAddress);
+    if (!ep) {
+        fail("opened unknown endpoint 0x%02X", desc_ep->bEndpointAddress);
+        return false;
+    }
+    ep->open = true;
+    return true;
+}
+
+bool usbh_edpt_xfer(uint8_t dev_addr, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes)
+{
+    ep_t* ep = find_ep(ep_addr);
+
+    if (dev_addr != DEV || !ep || !ep->open) {
+        fail("transfer on device %u endpoint 0x%02X, which isn't open", dev_addr, ep_addr);
+        return false;
+    }
+    if (ep->armed) {
+        fail("%s submitted while a transfer is pending", ep->name);
+        return false;
+    }
+    if (ep->fail_submits) {
+        ep->fail_submits--;
+        submit_failures[ep - eps]++;
+        if (ep_addr == EP_IN) in_fail_injected = true;
+        return false;
+    }
+    if (ep_addr == EP_IN) {
+        if (total_bytes < HCI_USB_ACL_BUF_SIZE) fail("ACL IN armed for %u bytes", total_bytes);
+        check_in_slot(buffer);
+    }
+    ep->armed = true;
+    ep->buf = buffer;
+    ep->len = total_bytes;
+    return true;
+}
+
+bool tuh_control_xfer(tuh_xfer_t* xfer)
+{
+    if (dongle.ctrl_armed) {
+        fail("control transfer started while one is pending");
+        return false;
+    }
+    const tusb_control_request_t* s = xfer->setup;
+    // Class request to the device (0x20, as the spec has it) or interface (0x21)
+    if ((s->bmRequestType & ~1) != 0x20 || s->bRequest != 0 || s->wIndex != usb_state.itf_num)
+        fail("HCI command with setup %02X %02X index %u", s->bmRequestType, s->bRequest, s->wIndex);
+    // TinyUSB copies the request; the caller's is on its stack
+    dongle.ctrl = *xfer;
+    dongle.ctrl_setup = *s;
+    dongle.ctrl.setup = &dongle.ctrl_setup;
+    dongle.ctrl_armed = true;
+    return true;
+}
+
+void usbh_set_bt_available(bool available) { (void)available; }
+
+// -----------------------------------------------------------------------------
+// BTstack
+// -----------------------------------------------------------------------------
+
+static struct {
+    const hci_transport_t* t;
+    bool buf_busy;              // hci.c's outgoing packet buffer is reserved
+    bool in_handler, in_send;
+    // ACL OUT: packets [acl_next, acl_total) wait in L2CAP
+    uint32_t acl_next, acl_total, acl_accepted, acl_rejected;
+    uint16_t acl_len[MAX_PKTS];
+    uint8_t acl_sent_ok[MAX_PKTS];      // accepted by send_packet
+    // HCI commands waiting
+    uint32_t cmd_next, cmd_total;
+    // What is expected next from the transport
+    uint32_t in_expect, evt_expect, cmd_expect;
+    uint32_t in_delivered, packet_sent;
+} bt;
+
+static uint8_t pkt[HCI_USB_ACL_BUF_SIZE];
+
+// hci_run(): send while the packet buffer is free and the transport takes it
+static void bt_run(void)
+{
+    while (!bt.buf_busy) {
+        uint8_t type;
+        int len;
+
+        if (bt.cmd_next < bt.cmd_total && bt.t->can_send_packet_now(HCI_COMMAND_DATA_PACKET)) {
+            type = HCI_COMMAND_DATA_PACKET;
+            len = 7 + (int)(bt.cmd_next % 40);
+            fill_cmd(pkt, bt.cmd_next, (uint16_t)len);
+        } else if (bt.acl_next < bt.acl_total && bt.t->can_send_packet_now(HCI_ACL_DATA_PACKET)) {
+            type = HCI_ACL_DATA_PACKET;
+            len = bt.acl_len[bt.acl_next];
+            fill_acl(pkt, bt.acl_next, (uint16_t)len);
+        } else {
+            return;                     // wait for PACKET_SENT
+        }
+
+        bt.buf_busy = true;
+        bt.in_send = true;
+        int r = bt.t->send_packet(type, pkt, len);
+        bt.in_send = false;
+        // The transport copies what it keeps: scribble over the buffer
+        memset(pkt, 0xA5, (size_t)len);
+
+        if (type == HCI_COMMAND_DATA_PACKET) {
+            if (r) fail("HCI command %u refused", bt.cmd_next);
+            bt.cmd_next++;
+        } else {
+            if (r) {
+                bt.acl_rejected++;
+            } else {
+                bt.acl_sent_ok[bt.acl_next] = 1;
+                bt.acl_accepted++;
+            }
+            bt.acl_next++;
+        }
+        if (r) bt.buf_busy = false;     // hci.c drops the packet
+    }
+}
+
+static void bt_packet_handler(uint8_t type, uint8_t* packet, uint16_t size)
+{
+    if (bt.in_send) fail("packet handler called from inside send_packet()");
+    if (bt.in_handler) fail("packet handler re-entered");
+    bt.in_handler = true;
+
+    if (type == HCI_EVENT_PACKET && size == 2 && packet[0] == HCI_EVENT_TRANSPORT_PACKET_SENT) {
+        bt.packet_sent++;
+        bt.buf_busy = false;
+        bt_run();
+    } else if (type == HCI_EVENT_PACKET) {
+        uint32_t seq;
+        uint8_t want[HCI_USB_EVT_BUF_SIZE];
+        memcpy(&seq, &packet[2], 4);
+        fill_event(want, bt.evt_expect, dongle.evt_len[bt.evt_expect % MAX_PKTS]);
+        if (size != dongle.evt_len[bt.evt_expect % MAX_PKTS] || memcmp(packet, want, size))
+            fail("event %u delivered as %u bytes of event %u", bt.evt_expect, size, seq);
+        bt.evt_expect = seq + 1;
+    } else if (type == HCI_ACL_DATA_PACKET) {
+        int64_t seq = check_acl(packet, size);
+        if (seq < 0) {
+            fail("ACL IN packet %u corrupted (%u bytes)", bt.in_expect, size);
+        } else {
+            if (seq != bt.in_expect)
+                fail("ACL IN packet %lld delivered, expected %u", (long long)seq, bt.in_expect);
+            if (packet != dongle.in_where[seq % MAX_PKTS])
+                fail("ACL IN packet %lld copied before delivery", (long long)seq);
+            bt.in_expect = (uint32_t)seq + 1;
+        }
+        // hci.c may build headers in front of what it was handed
+        memset(packet - HCI_INCOMING_PRE_BUFFER_SIZE, 0xEE, HCI_INCOMING_PRE_BUFFER_SIZE);
+        bt.in_delivered++;
+    } else {
+        fail("packet handler got type %u", type);
+    }
+
+    bt.in_handler = false;
+}
+
+// What hci_power_control(HCI_POWER_ON) does with the transport
+void btstack_host_power_on(void)
+{
+    bt.t->init(NULL);
+    if (bt.t->open()) fail("transport didn't open");
+}
+
+// -----------------------------------------------------------------------------
+// Run loop
+// -----------------------------------------------------------------------------
+
+static btstack_data_source_t* rl_ds;
+static int rl_depth, rl_max_depth;
+
+void btstack_run_loop_set_data_source_handler(btstack_data_source_t* ds,
+    void (*process)(btstack_data_source_t* ds, btstack_data_source_callback_type_t callback_type))
+{
+    ds->process = process;
+}
+
+void btstack_run_loop_enable_data_source_callbacks(btstack_data_source_t* ds, uint16_t callbacks)
+{
+    ds->flags |= callbacks;
+}
+
+// Like BTstack's linked list, adding a source that's already there is a no-op
+void btstack_run_loop_add_data_source(btstack_data_source_t* ds)
+{
+    if (rl_ds && rl_ds != ds) fail("a second data source was added");
+    rl_ds = ds;
+}
+
+int btstack_run_loop_remove_data_source(btstack_data_source_t* ds)
+{
+    if (rl_ds != ds) fail("removed a data source that wasn't added");
+    rl_ds = NULL;
+    return 0;
+}
+
+void btstack_run_loop_poll_data_sources_from_irq(void) {}
+
+// The embedded run loop polls every data source on each pass
+void btstack_run_loop_embedded_execute_once(void)
+{
+    if (!rl_ds || !(rl_ds->flags & DATA_SOURCE_CALLBACK_POLL)) return;
+    if (++rl_depth > rl_max_depth) rl_max_depth = rl_depth;
+    if (rl_depth > 2 * HCI_USB_ACL_IN_BUFFERS + 4) fail("run loop nested %d deep", rl_depth);
+    else rl_ds->process(rl_ds, DATA_SOURCE_CALLBACK_POLL);
+    rl_depth--;
+}
+
+// btstack_host_process()
+static void main_loop_pass(void)
+{
+    hci_transport_h2_tinyusb_process();
+    for (int i = 0; i < 5; i++) btstack_run_loop_embedded_execute_once();
+
+    if (usb_state.opened && !eps[1].armed && !in_fail_injected &&
+        usb_state.acl_in_count < HCI_USB_ACL_IN_BUFFERS)
+        fail("ACL IN idle after a main loop pass with %u of %u slots free",
+             HCI_USB_ACL_IN_BUFFERS - usb_state.acl_in_count, HCI_USB_ACL_IN_BUFFERS);
+    if (usb_state.opened && eps[1].armed) in_fail_injected = false;
+}
+
+// -----------------------------------------------------------------------------
+// tuh_task(): complete what the dongle is ready for
+// -----------------------------------------------------------------------------
+
+static void complete_in(void)
+{
+    ep_t* ep = &eps[1];
+    uint32_t seq = dongle.in_sent++;
+    uint16_t len = dongle.in_len[seq % MAX_PKTS];
+
+    ep->armed = false;
+    fill_acl(ep->buf, seq, len);
+    dongle.in_where[seq % MAX_PKTS] = ep->buf;
+    dongle.in_done++;
+    btstack_driver_xfer_cb(DEV, EP_IN, XFER_RESULT_SUCCESS, len);
+
+    if (usb_state.acl_in_count == HCI_USB_ACL_IN_BUFFERS) dongle.in_starved++;
+    else if (!ep->armed && !in_fail_injected)
+        fail("ACL IN not re-armed after packet %u with %u of %u slots free", seq,
+             HCI_USB_ACL_IN_BUFFERS - usb_state.acl_in_count, HCI_USB_ACL_IN_BUFFERS);
+}
+
+static void complete_out(void)
+{
+    ep_t* ep = &eps[2];
+    int64_t seq = check_acl(ep->buf, ep->len);
+
+    ep->armed = false;
+    if (dongle.fail_out_xfers) {
+        dongle.fail_out_xfers--;
+        dongle.out_failed++;
+        btstack_driver_xfer_cb(DEV, EP_OUT, XFER_RESULT_FAILED, 0);
+        return;
+    }
+    if (seq < 0) {
+        fail("ACL OUT packet after %lld corrupted (%u bytes)", (long long)dongle.out_last, ep->len);
+    } else {
+        if (seq <= dongle.out_last) fail("ACL OUT packet %lld after %lld", (long long)seq,
+                                         (long long)dongle.out_last);
+        else if (!bt.acl_sent_ok[seq]) fail("ACL OUT packet %lld was refused, but sent", (long long)seq);
+        else if (ep->len != bt.acl_len[seq]) fail("ACL OUT packet %lld is %u bytes", (long long)seq, ep->len);
+        dongle.out_last = seq;
+    }
+    dongle.out_wire++;
+    btstack_driver_xfer_cb(DEV, EP_OUT, XFER_RESULT_SUCCESS, ep->len);
+}
+
+static void complete_evt(void)
+{
+    ep_t* ep = &eps[0];
+    uint32_t seq = dongle.evt_sent++;
+    uint16_t len = dongle.evt_len[seq % MAX_PKTS];
+
+    ep->armed = false;
+    if (len > ep->len) fail("event %u doesn't fit the %u byte buffer", seq, ep->len);
+    fill_event(ep->buf, seq, len);
+    btstack_driver_xfer_cb(DEV, EP_EVT, XFER_RESULT_SUCCESS, len);
+}
+
+static void complete_ctrl(void)
+{
+    uint8_t want[HCI_USB_CMD_BUF_SIZE];
+    uint32_t seq;
+    tuh_xfer_t x = dongle.ctrl;
+
+    dongle.ctrl_armed = false;
+    memcpy(&seq, &x.buffer[3], 4);
+    fill_cmd(want, dongle.cmds, dongle.ctrl_setup.wLength);
+    if (seq != dongle.cmds || memcmp(x.buffer, want, dongle.ctrl_setup.wLength))
+        fail("HCI command %u arrived as %u", dongle.cmds, seq);
+    dongle.cmds++;
+    x.result = XFER_RESULT_SUCCESS;
+    x.actual_len = dongle.ctrl_setup.wLength;
+    x.complete_cb(&x);
+}
+
+static void usb_task(void)
+{
+    if (dongle.ctrl_armed && chance(dongle.ctrl_rate)) complete_ctrl();
+    if (eps[0].armed && dongle.evt_sent < dongle.evt_queued && chance(dongle.evt_rate)) complete_evt();
+    if (eps[1].armed && dongle.in_sent < dongle.in_queued && chance(dongle.in_rate)) complete_in();
+    if (eps[2].armed && chance(dongle.out_rate)) complete_out();
+}
+
+// -----------------------------------------------------------------------------
+// Traffic
+// -----------------------------------------------------------------------------
+
+static uint16_t acl_len(void)
+{
+    // Mostly HID-report sized, some GATT-sized, a few full buffers
+    uint32_t r = rnd() % 100;
+    if (r < 70) return (uint16_t)(8 + rnd() % 40);
+    if (r < 95) return (uint16_t)(8 + rnd() % 512);
+    return HCI_USB_ACL_BUF_SIZE - (uint16_t)(rnd() % 2);
+}
+
+static void queue_in(int n)
+{
+    for (int i = 0; i < n && dongle.in_queued < MAX_PKTS; i++)
+        dongle.in_len[dongle.in_queued++ % MAX_PKTS] = acl_len();
+}
+
+static void queue_evt(int n)
+{
+    for (int i = 0; i < n && dongle.evt_queued < MAX_PKTS; i++)
+        dongle.evt_len[dongle.evt_queued++ % MAX_PKTS] =
+            (uint16_t)(6 + rnd() % (HCI_USB_EVT_BUF_SIZE - 8));
+}
+
+static void queue_out(int n)
+{
+    for (int i = 0; i < n && bt.acl_total < MAX_PKTS; i++) bt.acl_len[bt.acl_total++] = acl_len();
+    bt_run();
+}
+
+static void queue_cmd(int n)
+{
+    bt.cmd_total += (uint32_t)n;
+    bt_run();
+}
+
+static void connect(void)
+{
+    static const uint8_t desc[] = {
+        9, TUSB_DESC_INTERFACE, 0, 0, 3, USB_CLASS_WIRELESS_CTRL, USB_SUBCLASS_RF,
+        USB_PROTOCOL_BLUETOOTH, 0,
+        7, TUSB_DESC_ENDPOINT, EP_EVT, TUSB_XFER_INTERRUPT, 16, 0, 1,
+        7, TUSB_DESC_ENDPOINT, EP_IN, TUSB_XFER_BULK, 64, 0, 0,
+        7, TUSB_DESC_ENDPOINT, EP_OUT, TUSB_XFER_BULK, 64, 0, 0,
+    };
+
+    if (!btstack_driver_open(0, DEV, (const tusb_desc_interface_t*)desc, sizeof desc))
+        fail("driver didn't claim the dongle");
+    if (!btstack_driver_set_config(DEV, 0)) fail("set_config refused");
+    if (!eps[0].armed || !eps[1].armed) fail("opening the transport didn't arm event and ACL IN");
+}
+
+// Dongle pulled: TinyUSB drops the pending transfers, the dongle forgets its
+// queues, and BTstack restarts from scratch when it's back
+static void disconnect(void)
+{
+    dongle.out_unplugged += usb_state.acl_out_count;
+    btstack_driver_close(DEV);
+    for (size_t i = 0; i < EP_COUNT; i++) eps[i].armed = eps[i].open = false;
+    dongle.ctrl_armed = false;
+    dongle.in_sent = dongle.in_queued;
+    dongle.evt_sent = dongle.evt_queued;
+    bt.in_expect = dongle.in_queued;
+    bt.evt_expect = dongle.evt_queued;
+    bt.acl_next = bt.acl_total;
+    bt.cmd_next = bt.cmd_total;
+    dongle.cmds = bt.cmd_total;
+    bt.buf_busy = false;
+}
+
+// Pump until every queue is empty, with the dongle at full pace
+static void drain(void)
+{
+    dongle.in_rate = dongle.out_rate = dongle.evt_rate = dongle.ctrl_rate = 100;
+    for (int i = 0; i < 1000; i++) {
+        usb_task();
+        main_loop_pass();
+    }
+
+    if (bt.acl_next != bt.acl_total)
+        fail("BTstack still holds %u ACL packets: it was never woken", bt.acl_total - bt.acl_next);
+    if (bt.cmd_next != bt.cmd_total) fail("BTstack still holds %u HCI commands", bt.cmd_total - bt.cmd_next);
+    if (bt.buf_busy) fail("BTstack's packet buffer was never released");
+    if (bt.in_expect != dongle.in_queued)
+        fail("%u of %u ACL IN packets delivered", bt.in_expect, dongle.in_queued);
+    if (bt.evt_expect != dongle.evt_queued) fail("%u of %u events delivered", bt.evt_expect, dongle.evt_queued);
+    if (!eps[1].armed) fail("ACL IN never re-armed");
+    if (usb_state.acl_out_count || eps[2].armed) fail("ACL OUT queue didn't drain");
+
+    uint32_t out_dropped = submit_failures[2] - bt.acl_rejected;
+    if (dongle.out_wire + dongle.out_failed + out_dropped + dongle.out_unplugged != bt.acl_accepted)
+        fail("%u ACL OUT packets accepted, %u sent, %u failed, %u dropped, %u unplugged",
+             bt.acl_accepted, dongle.out_wire, dongle.out_failed, out_dropped, dongle.out_unplugged);
+}
+
+static void check_stats(void)
+{
+    uint32_t in_packets, in_starved, in_hw, out_packets, out_stalls, out_hw;
+    hci_transport_h2_tinyusb_get_stats(&in_packets, &in_starved, &in_hw, &out_packets,
+                                       &out_stalls, &out_hw);
+
+    if (in_packets != dongle.in_done) fail("in_packets %u, dongle sent %u", in_packets, dongle.in_done);
+    if (in_starved != dongle.in_starved) fail("in_starved %u, ring filled %u times", in_starved,
+                                              dongle.in_starved);
+    if (in_hw > HCI_USB_ACL_IN_BUFFERS || out_hw > HCI_USB_ACL_OUT_BUFFERS)
+        fail("high-water marks %u/%u past the ring sizes", in_hw, out_hw);
+    if (out_packets != bt.acl_accepted) fail("out_packets %u, BTstack had %u accepted", out_packets,
+                                             bt.acl_accepted);
+    if (verbose)
+        printf("  stats: in %u starved %u hw %u, out %u stalls %u hw %u, %u PACKET_SENT, "
+               "run loop nested %d deep\n", in_packets, in_starved, in_hw, out_packets, out_stalls,
+               out_hw, bt.packet_sent, rl_max_depth);
+}
+
+// -----------------------------------------------------------------------------
+// Scenarios
+// -----------------------------------------------------------------------------
+
+// Run for `steps` tuh_task() passes, a main loop pass every 1..loop_every
+static void run(int steps, int loop_every, void (*traffic)(int step))
+{
+    int next_loop = 1;
+    for (int s = 0; s < steps; s++) {
+        if (traffic) traffic(s);
+        usb_task();
+        if (--next_loop == 0) {
+            main_loop_pass();
+            next_loop = 1 + (int)(rnd() % (uint32_t)loop_every);
+        }
+    }
+}
+
+static void traffic_burst_in(int step)
+{
+    if (step % 50 == 0) queue_in(1 + (int)(rnd() % 12));
+}
+
+static void burst_in(void)
+{
+    dongle.in_rate = 90;
+    run(4000, 8, traffic_burst_in);
+    drain();
+    uint32_t starved;
+    hci_transport_h2_tinyusb_get_stats(NULL, &starved, NULL, NULL, NULL, NULL);
+    if (!starved) fail("a slow main loop never filled the ring");
+}
+
+static void traffic_out(int step)
+{
+    if (step % 40 == 0) queue_out(1 + (int)(rnd() % 10));
+}
+
+static void out_queue(void)
+{
+    dongle.out_rate = 15;
+    run(4000, 3, traffic_out);
+    drain();
+    uint32_t stalls, hw;
+    hci_transport_h2_tinyusb_get_stats(NULL, NULL, NULL, NULL, &stalls, &hw);
+    if (!stalls || hw != HCI_USB_ACL_OUT_BUFFERS) fail("a slow OUT endpoint never filled the queue");
+}
+
+static void traffic_out_fail(int step)
+{
+    traffic_out(step);
+    if (step % 300 == 150) dongle.fail_out_xfers = 1 + (int)(rnd() % 2);
+}
+
+static void out_fail(void)
+{
+    dongle.out_rate = 20;
+    run(4000, 3, traffic_out_fail);
+    drain();
+    if (!dongle.out_failed) fail("no OUT transfer failed");
+}
+
+static void traffic_submit_fail(int step)
+{
+    traffic_out(step);
+    traffic_burst_in(step);
+    // OUT: whichever submit comes next, from send_packet() or the queue
+    if (step % 250 == 100) eps[2].fail_submits = 1;
+    // IN: only while a transfer is pending, so it's the re-arm that fails
+    if (step % 400 == 200 && eps[1].armed) eps[1].fail_submits = 1;
+}
+
+static void submit_fail(void)
+{
+    dongle.in_rate = 70;
+    dongle.out_rate = 25;
+    run(5000, 5, traffic_submit_fail);
+    drain();
+    if (!submit_failures[1] || !submit_failures[2]) fail("submit failures weren't injected");
+}
+
+static void traffic_mixed(int step)
+{
+    uint32_t r = rnd() % 1000;
+    if (r < 20) queue_in(1 + (int)(rnd() % 8));
+    else if (r < 35) queue_out(1 + (int)(rnd() % 6));
+    else if (r < 45) queue_evt(1 + (int)(rnd() % 3));
+    else if (r < 50) queue_cmd(1);
+}
+
+static void mixed(void)
+{
+    dongle.in_rate = 60;
+    dongle.out_rate = 40;
+    dongle.evt_rate = 50;
+    dongle.ctrl_rate = 30;
+    run(20000, 6, traffic_mixed);
+    drain();
+}
+
+static void reconnect(void)
+{
+    dongle.in_rate = 60;
+    dongle.out_rate = 20;
+    dongle.evt_rate = 50;
+    dongle.ctrl_rate = 30;
+    for (int round = 0; round < 4; round++) {
+        run(1500, 6, traffic_mixed);
+        // Pulled with packets received but not yet handed to BTstack
+        queue_in(HCI_USB_ACL_IN_BUFFERS + 2);
+        queue_evt(2);
+        for (int i = 0; i < 20; i++) usb_task();
+        disconnect();
+        run(50, 3, NULL);
+        connect();
+    }
+    run(1500, 6, traffic_mixed);
+    drain();
+}
+
+static const struct {
+    const char* name;
+    void (*fn)(void);
+    const char* what;
+} scenarios[] = {
+    { "burst-in",    burst_in,    "bursts of ACL IN against a slow main loop" },
+    { "out-queue",   out_queue,   "ACL OUT faster than the endpoint drains it" },
+    { "out-fail",    out_fail,    "OUT transfers failing mid-queue" },
+    { "submit-fail", submit_fail, "usbh_edpt_xfer() refusing IN re-arms and OUT starts" },
+    { "mixed",       mixed,       "events, commands and ACL both ways at random" },
+    { "reconnect",   reconnect,   "the dongle pulled and replugged mid-traffic" },
+};
+#define SCENARIO_COUNT (sizeof scenarios / sizeof scenarios[0])
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "vs:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-s seed] scenario\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-v] [-s seed] scenario\n\nscenarios:\n", argv[0]);
+        for (size_t i = 0; i < SCENARIO_COUNT; i++)
+            fprintf(stderr, "  %-12s %s\n", scenarios[i].name, scenarios[i].what);
+        return 2;
+    }
+    size_t sc = 0;
+    while (sc < SCENARIO_COUNT && strcmp(scenarios[sc].name, argv[optind]) != 0) sc++;
+    if (sc == SCENARIO_COUNT) {
+        fprintf(stderr, "unknown scenario '%s'\n", argv[optind]);
+        return 2;
+    }
+
+    printf("hci-usb-check seed %u %s: %d IN / %d OUT slots\n", seed, scenarios[sc].name,
+           HCI_USB_ACL_IN_BUFFERS, HCI_USB_ACL_OUT_BUFFERS);
+    dongle.out_last = -1;
+    btstack_driver_init();
+    bt.t = hci_transport_h2_tinyusb_instance();
+    bt.t->register_packet_handler(bt_packet_handler);
+    connect();
+    scenarios[sc].fn();
+    check_stats();
+
+    printf("  %u ACL IN, %u ACL OUT (%u failed, %u refused), %u events, %u commands\n",
+           bt.in_delivered, dongle.out_wire, dongle.out_failed, bt.acl_rejected, bt.evt_expect,
+           dongle.cmds);
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,4 @@
+// bluetooth.h - nothing from it is needed by the transport
+#ifndef HCI_USB_CHECK_BLUETOOTH_H
+#define HCI_USB_CHECK_BLUETOOTH_H
+#endif
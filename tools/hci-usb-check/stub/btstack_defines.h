@@ -0,0 +1,12 @@
+// btstack_defines.h - the packet types and the one event the transport uses
+#ifndef HCI_USB_CHECK_BTSTACK_DEFINES_H
+#define HCI_USB_CHECK_BTSTACK_DEFINES_H
+
+#define HCI_COMMAND_DATA_PACKET         0x01
+#define HCI_ACL_DATA_PACKET             0x02
+#define HCI_SCO_DATA_PACKET             0x03
+#define HCI_EVENT_PACKET                0x04
+
+#define HCI_EVENT_TRANSPORT_PACKET_SENT 0x6E
+
+#endif
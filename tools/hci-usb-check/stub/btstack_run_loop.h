@@ -0,0 +1,25 @@
+// btstack_run_loop.h - data sources, backed by the run loop model in check.c
+#ifndef HCI_USB_CHECK_BTSTACK_RUN_LOOP_H
+#define HCI_USB_CHECK_BTSTACK_RUN_LOOP_H
+
+#include <stdint.h>
+
+typedef enum {
+    DATA_SOURCE_CALLBACK_POLL  = 1 << 0,
+    DATA_SOURCE_CALLBACK_READ  = 1 << 1,
+    DATA_SOURCE_CALLBACK_WRITE = 1 << 2,
+} btstack_data_source_callback_type_t;
+
+typedef struct btstack_data_source {
+    void (*process)(struct btstack_data_source* ds, btstack_data_source_callback_type_t callback_type);
+    uint16_t flags;
+} btstack_data_source_t;
+
+void btstack_run_loop_set_data_source_handler(btstack_data_source_t* ds,
+    void (*process)(btstack_data_source_t* ds, btstack_data_source_callback_type_t callback_type));
+void btstack_run_loop_enable_data_source_callbacks(btstack_data_source_t* ds, uint16_t callbacks);
+void btstack_run_loop_add_data_source(btstack_data_source_t* ds);
+int  btstack_run_loop_remove_data_source(btstack_data_source_t* ds);
+void btstack_run_loop_poll_data_sources_from_irq(void);
+
+#endif
@@ -0,0 +1,7 @@
+// btstack_run_loop_embedded.h - one pass of the run loop model in check.c
+#ifndef HCI_USB_CHECK_BTSTACK_RUN_LOOP_EMBEDDED_H
+#define HCI_USB_CHECK_BTSTACK_RUN_LOOP_EMBEDDED_H
+
+void btstack_run_loop_embedded_execute_once(void);
+
+#endif
@@ -0,0 +1,20 @@
+// hci_transport.h - BTstack's transport interface
+#ifndef HCI_USB_CHECK_HCI_TRANSPORT_H
+#define HCI_USB_CHECK_HCI_TRANSPORT_H
+
+#include <stdint.h>
+
+typedef struct {
+    const char* name;
+    void (*init)(const void* transport_config);
+    int  (*open)(void);
+    int  (*close)(void);
+    void (*register_packet_handler)(void (*handler)(uint8_t packet_type, uint8_t* packet, uint16_t size));
+    int  (*can_send_packet_now)(uint8_t packet_type);
+    int  (*send_packet)(uint8_t packet_type, uint8_t* packet, int size);
+    int  (*set_baudrate)(uint32_t baudrate);
+    void (*reset_link)(void);
+    void (*set_sco_config)(uint16_t voice_setting, int num_connections);
+} hci_transport_t;
+
+#endif
@@ -0,0 +1,23 @@
+// host/usbh_pvt.h - class driver interface and endpoint transfers for the
+// host check; usbh_edpt_xfer() is the fake host controller in check.c.
+
+#ifndef HCI_USB_CHECK_USBH_PVT_H
+#define HCI_USB_CHECK_USBH_PVT_H
+
+#include "tusb.h"
+
+typedef struct {
+    char const* name;
+    bool (* const init)(void);
+    bool (* const deinit)(void);
+    bool (* const open)(uint8_t rhport, uint8_t dev_addr, tusb_desc_interface_t const* desc_itf,
+                        uint16_t max_len);
+    bool (* const set_config)(uint8_t dev_addr, uint8_t itf_num);
+    bool (* const xfer_cb)(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result,
+                           uint32_t xferred_bytes);
+    void (* const close)(uint8_t dev_addr);
+} usbh_class_driver_t;
+
+bool usbh_edpt_xfer(uint8_t dev_addr, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes);
+
+#endif // HCI_USB_CHECK_USBH_PVT_H
@@ -0,0 +1,131 @@
+// tusb.h - minimal TinyUSB host surface for building
+// hci_transport_h2_tinyusb.c on the host. Only what that file touches; the
+// transfer calls are implemented by the fake host controller in check.c.
+
+#ifndef HCI_USB_CHECK_TUSB_H
+#define HCI_USB_CHECK_TUSB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define TU_ATTR_PACKED        __attribute__((packed))
+
+typedef enum {
+    TUSB_DESC_INTERFACE     = 0x04,
+    TUSB_DESC_ENDPOINT      = 0x05,
+} tusb_desc_type_t;
+
+typedef enum {
+    TUSB_XFER_CONTROL = 0,
+    TUSB_XFER_ISOCHRONOUS,
+    TUSB_XFER_BULK,
+    TUSB_XFER_INTERRUPT,
+} tusb_xfer_type_t;
+
+typedef enum {
+    TUSB_DIR_OUT = 0,
+    TUSB_DIR_IN  = 1,
+    TUSB_DIR_IN_MASK = 0x80,
+} tusb_dir_t;
+
+typedef enum {
+    TUSB_REQ_TYPE_STANDARD = 0,
+    TUSB_REQ_TYPE_CLASS,
+    TUSB_REQ_TYPE_VENDOR,
+} tusb_request_type_t;
+
+typedef enum {
+    TUSB_REQ_RCPT_DEVICE = 0,
+    TUSB_REQ_RCPT_INTERFACE,
+    TUSB_REQ_RCPT_ENDPOINT,
+} tusb_request_recipient_t;
+
+typedef enum {
+    XFER_RESULT_SUCCESS = 0,
+    XFER_RESULT_FAILED,
+    XFER_RESULT_STALLED,
+    XFER_RESULT_TIMEOUT,
+    XFER_RESULT_INVALID,
+} xfer_result_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bEndpointAddress;
+    struct TU_ATTR_PACKED {
+        uint8_t xfer  : 2;
+        uint8_t sync  : 2;
+        uint8_t usage : 2;
+        uint8_t       : 2;
+    } bmAttributes;
+    uint16_t wMaxPacketSize;
+    uint8_t  bInterval;
+} tusb_desc_endpoint_t;
+
+typedef struct TU_ATTR_PACKED {
+    union {
+        struct TU_ATTR_PACKED {
+            uint8_t recipient :  5;
+            uint8_t type      :  2;
+            uint8_t direction :  1;
+        } bmRequestType_bit;
+        uint8_t bmRequestType;
+    };
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+typedef struct tuh_xfer_s tuh_xfer_t;
+typedef void (*tuh_xfer_cb_t)(tuh_xfer_t* xfer);
+
+struct tuh_xfer_s {
+    uint8_t daddr;
+    uint8_t ep_addr;
+    xfer_result_t result;
+    uint32_t actual_len;
+    union {
+        tusb_control_request_t const* setup;
+        uint32_t buflen;
+    };
+    uint8_t* buffer;
+    tuh_xfer_cb_t complete_cb;
+    uintptr_t user_data;
+};
+
+static inline uint8_t const* tu_desc_next(void const* desc)
+{
+    uint8_t const* d = (uint8_t const*)desc;
+    return d + d[0];
+}
+
+static inline uint8_t tu_desc_type(void const* desc)
+{
+    return ((uint8_t const*)desc)[1];
+}
+
+static inline tusb_dir_t tu_edpt_dir(uint8_t addr)
+{
+    return (addr & TUSB_DIR_IN_MASK) ? TUSB_DIR_IN : TUSB_DIR_OUT;
+}
+
+// Host controller calls, implemented by check.c
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t* vid, uint16_t* pid);
+bool tuh_edpt_open(uint8_t daddr, tusb_desc_endpoint_t const* desc_ep);
+bool tuh_control_xfer(tuh_xfer_t* xfer);
+
+#endif // HCI_USB_CHECK_TUSB_H
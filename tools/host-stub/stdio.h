@@ -0,0 +1,14 @@
+// stdio.h - host shim for the host checks (host-test.mk): firmware log
+// printf()s go to host_fw_log(), which the check defines (timestamped,
+// shown with -v). The check's own sources define HOST_CHECK_MAIN before
+// any include and keep the real printf().
+
+#include_next <stdio.h>
+
+#if !defined(HOST_CHECK_MAIN) && !defined(HOST_STUB_STDIO_H)
+#define HOST_STUB_STDIO_H
+
+int host_fw_log(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+#define printf host_fw_log
+
+#endif
@@ -0,0 +1,84 @@
+# host-test.mk — what the host checks in tools/*/ share.
+#
+# A host check builds firmware sources straight from the tree, against stub
+# headers where it needs them (its own stub/, and ../host-stub/ for what
+# several share), and runs them from a harness on the host. No pico-sdk, no CMake. Each check's
+# Makefile sets the variables below, then ends with
+#
+#   include ../host-test.mk
+#
+# followed by any rules of its own. That gives:
+#
+#   make          — build ./$(BIN)
+#   make run      — build and do every run (alias: make test)
+#   make clean
+#
+# and `make $(GEN_DIR)` for checks with generated inputs. ARGS is passed to
+# every run; make run fails if any run did. `make -C tools test` runs every
+# check.
+#
+# Variables:
+#   BIN        the binary, named after the directory
+#   SRC        the check's own sources
+#   FW_SRC     firmware sources, compiled as they are
+#   FW_HDR     firmware headers (and .c files the check includes) to rebuild on
+#   INC, DEFS  include paths and defines for SRC and FW_SRC alike
+#   WARN       warnings to add or drop, e.g. -Wno-unused-parameter for stubs
+#   LDLIBS     libraries
+#   RUNS       one word per run, its arguments joined with ':'
+#              ($(call host_runs,-r -b,0:1 200:1) gives -r:0:-b:1 -r:200:-b:1);
+#              unset means one run with no arguments
+#   INPUTS     files every run is given after its arguments
+#   RUN_CMD    what runs the check (default ./$(BIN))
+#   GEN        Python script (and arguments) that writes the inputs to
+#              GEN_DIR. make run runs it on first use; GEN_DIR is not checked in
+#   OWN_BUILD  set when the check writes its own $(BIN) rule
+#   CLEAN      anything else make clean removes
+
+CC       ?= cc
+PYTHON   ?= python3
+ARGS     ?=
+CFLAGS   := -std=c11 -Wall -Wextra -O2 -g $(WARN)
+STUB_HDR := $(wildcard stub/*.h stub/*/*.h)
+RUN_CMD  ?= ./$(BIN)
+
+empty :=
+space := $(empty) $(empty)
+# $(call host_runs,<flags>,<values>): pair each ':'-separated value with the
+# flags in order, one run per value
+host_runs = $(foreach v,$(2),$(subst $(space),:,$(join $(addsuffix :,$(1)),$(subst :, ,$(v)))))
+
+.DEFAULT_GOAL := all
+.PHONY: all run test clean
+all: $(BIN)
+
+ifndef OWN_BUILD
+$(BIN): $(SRC) $(FW_SRC) $(FW_HDR) $(STUB_HDR)
+	$(CC) $(CFLAGS) $(DEFS) $(INC) $(SRC) $(FW_SRC) -o $@ $(LDLIBS)
+endif
+
+ifdef GEN
+GEN_STAMP := $(GEN_DIR)/.generated
+
+$(GEN_STAMP): $(firstword $(GEN))
+	$(PYTHON) $(GEN)
+	touch $@
+
+.PHONY: $(GEN_DIR)
+$(GEN_DIR):
+	$(PYTHON) $(GEN)
+	touch $(GEN_STAMP)
+endif
+
+run: $(BIN) $(GEN_STAMP)
+ifdef RUNS
+	@status=0; $(foreach r,$(RUNS),$(RUN_CMD) $(ARGS) $(subst :, ,$(r)) $(INPUTS) || status=1;) \
+	exit $$status
+else
+	$(RUN_CMD) $(ARGS) $(INPUTS)
+endif
+
+test: run
+
+clean:
+	rm -rf $(BIN) $(GEN_DIR) $(CLEAN)
@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+"""Generate the synthetic JOCP sender traces in traces/.
+
+Each trace is what the router tap hands jocp_output.c (`in`: router output
+state at a time) and what the dongle sends back over TCP (`cmd`). The
+`fb` lines are the feedback the app should read, worked out here from the
+commands alone: rumble, player LED and RGB as they change, and a rumble
+with a duration going back to 0 when it runs out.
+
+Times are milliseconds from the TCP connect. Commands are kept well apart
+from each other and from rumble expiries, so network jitter on loopback
+can't reorder them.
+
+Deterministic: running it again rewrites identical files.
+"""
+
+import os
+
+OUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "traces")
+
+# JP_BUTTON_* bits that have a JOCP button (core/buttons.h)
+B1, B2, B3, B4 = 1 << 0, 1 << 1, 1 << 2, 1 << 3
+L1, R1, L2, R2 = 1 << 4, 1 << 5, 1 << 6, 1 << 7
+S1, S2, L3, R3 = 1 << 8, 1 << 9, 1 << 10, 1 << 11
+DU, DD, DL, DR = 1 << 12, 1 << 13, 1 << 14, 1 << 15
+A1, A2, L4, R4 = 1 << 16, 1 << 17, 1 << 20, 1 << 21
+BUTTONS = [B1, B2, B3, B4, L1, R1, L2, R2, S1, S2, L3, R3, DU, DD, DL, DR, A1, A2, L4, R4]
+
+CENTER = [128, 128, 128, 128, 0, 0]
+
+
+class Lcg:
+    def __init__(self, seed):
+        self.s = seed
+
+    def next(self, lo, hi):
+        self.s = (self.s * 1103515245 + 12345) & 0xFFFFFFFF
+        return lo + (self.s >> 8) % (hi - lo + 1)
+
+    def pick(self, items):
+        return items[self.next(0, len(items) - 1)]
+
+
+class Trace:
+    def __init__(self, heartbeat_ms=250):
+        self.heartbeat_ms = heartbeat_ms
+        self.lines = []
+        self.cmds = []
+        self.end_ms = 0
+
+    def input(self, t, buttons, analog, battery=None):
+        line = f"in {t} {buttons:06X} " + " ".join(str(a) for a in analog)
+        if battery is not None:
+            line += f" bat {battery}"
+        self.lines.append((t, 0, line))
+
+    def cmd(self, t, text):
+        self.cmds.append((t, text))
+
+    def write(self, name, comment):
+        lines = [f"# {c}" for c in comment.strip().splitlines()]
+        lines.append(f"hb {self.heartbeat_ms}")
+        lines.append(f"end {self.end_ms}")
+        items = list(self.lines)
+        items += [(t, 1, f"cmd {t} {text}") for t, text in self.cmds]
+        items += [(t, 2, line) for t, line in expected_feedback(self.cmds)]
+        items.sort(key=lambda item: (item[0], item[1]))
+        lines += [line for _, _, line in items]
+        with open(os.path.join(OUT, name), "w") as f:
+            f.write("\n".join(lines) + "\n")
+
+
+def expected_feedback(cmds):
+    """fb lines for the commands, as jocp_sender.c turns them into feedback."""
+    fb = [0, 0, 0, 0, 0, 0]     # rumble L/R, player LED, R, G, B
+    timed_end = None
+    out = []
+
+    def emit(t, new):
+        nonlocal fb
+        if new != fb:
+            fb = new
+            out.append((t, f"fb {t} " + " ".join(str(v) for v in fb)))
+
+    for t, text in sorted(cmds):
+        if timed_end is not None and timed_end <= t:
+            emit(timed_end, [0, 0] + fb[2:])
+            timed_end = None
+        words = text.split()
+        kind, args = words[0], [int(w) for w in words[1:] if w.isdigit()]
+        if kind == "rumble":
+            left, right, dur = args
+            emit(t, [left, right] + fb[2:])
+            timed_end = t + dur if dur and (left or right) else None
+        elif kind == "led":
+            emit(t, fb[:2] + [args[0]] + fb[3:])
+        elif kind == "rgb":
+            emit(t, fb[:3] + args)
+    if timed_end is not None:
+        emit(timed_end, [0, 0] + fb[2:])
+    return out
+
+
+# ============================================================================
+# TRACES
+# ============================================================================
+
+def taps():
+    """Single presses and releases with idle stretches past the heartbeat."""
+    rng = Lcg(100)
+    tr = Trace()
+    t = 20
+    analog = list(CENTER)
+    tr.input(t, 0, analog, battery=80)
+    while t < 2400:
+        button = rng.pick(BUTTONS)
+        t += rng.next(15, 120)
+        tr.input(t, button, analog, battery=80)
+        t += rng.next(30, 90)
+        tr.input(t, 0, analog, battery=80)
+        if rng.next(0, 4) == 0:
+            t += rng.next(300, 700)      # Idle: heartbeats only
+    tr.end_ms = t + 400
+    tr.write("taps.txt", """
+Single button taps, each JP button with a JOCP bit, some idle stretches
+longer than the heartbeat in between.
+""")
+
+
+def sticks():
+    """Every 8-bit value on every axis, one step every 3 ms."""
+    tr = Trace()
+    t = 20
+    for v in range(256):
+        analog = [v, 255 - v, (v * 7) & 0xFF, (v * 13 + 64) & 0xFF, v, 255 - v]
+        tr.input(t, 0, analog)
+        t += 3
+    tr.input(t, 0, CENTER)
+    tr.end_ms = t + 300
+    tr.write("sticks.txt", """
+Every 8-bit value on each stick axis and trigger, so the widening on the
+controller and the dongle's >> 8 are checked to give back the same byte.
+""")
+
+
+def coalesce():
+    """Several tap calls between two sends; only the last may go out."""
+    rng = Lcg(300)
+    tr = Trace()
+    t = 20
+    for _ in range(60):
+        for _ in range(rng.next(2, 5)):
+            buttons = 0
+            for _ in range(rng.next(0, 3)):
+                buttons |= rng.pick(BUTTONS)
+            analog = [rng.next(0, 255) for _ in range(4)] + [rng.next(0, 255) for _ in range(2)]
+            tr.input(t, buttons, analog)
+        t += rng.next(4, 30)
+    tr.input(t, 0, CENTER)
+    tr.end_ms = t + 300
+    tr.write("coalesce.txt", """
+Bursts of router outputs at the same millisecond: the sender must collapse
+them into one packet carrying the last state.
+""")
+
+
+def feedback():
+    """OUTPUT_CMDs over TCP, including bytes the parser has to skip."""
+    tr = Trace()
+    tr.input(20, 0, CENTER)
+    tr.input(900, B1, CENTER)
+    tr.input(1000, 0, CENTER)
+
+    tr.cmd(100, "led 1")
+    tr.cmd(200, "rgb 0 0 255")
+    tr.cmd(300, "rumble 255 128 0")       # Until changed
+    tr.cmd(400, "caps")                   # Bare CAPS_REQ, skipped quietly
+    tr.cmd(500, "rumble 0 0 0")
+    tr.cmd(600, "junk 01 02 03 4A 00 FF") # No magic: six bytes dropped
+    tr.cmd(700, "rumble 200 200 150")     # Stops by itself at 850
+    tr.cmd(1000, "rumble 90 0 400")       # Re-armed at 1200 with the same level
+    tr.cmd(1200, "rumble 90 0 300")       # ... so nothing changes until 1500
+    tr.cmd(1700, "led 3")
+    tr.cmd(1800, "rumble 40 60 200")      # Replaced before it runs out
+    tr.cmd(1900, "rumble 70 0 0")
+    tr.cmd(2200, "junk 7E 55")
+    tr.cmd(2300, "rgb 255 64 0")
+    tr.cmd(2400, "rumble 0 0 500")        # Zero amplitude: no timer
+    tr.end_ms = 2700
+    tr.write("feedback.txt", """
+Rumble, player LED and RGB from the dongle over the TCP control channel.
+Timed rumble stops by itself; a repeat re-arms it. Garbage and a CAPS_REQ
+sit between the commands. loopback.js splits every command across writes.
+""")
+
+
+def poll_rate():
+    """A POLL_RATE cap in the middle of a stream of changes."""
+    rng = Lcg(500)
+    tr = Trace()
+    t = 20
+    while t < 1400:
+        analog = [rng.next(0, 255), rng.next(0, 255), 128, 128, 0, 0]
+        tr.input(t, rng.pick(BUTTONS), analog)
+        t += rng.next(2, 6)
+    tr.input(t, 0, CENTER)
+    tr.cmd(300, "rate 50")                 # One packet per 20 ms at most
+    tr.cmd(900, "rate 0")                  # No limit again
+    tr.end_ms = t + 300
+    tr.write("pollrate.txt", """
+Input changing every few milliseconds. Between 300 and 900 ms the dongle
+caps the rate at 50 Hz; packets must keep 20 ms apart and still carry the
+latest state.
+""")
+
+
+def heartbeat():
+    """Long idle with a short heartbeat."""
+    tr = Trace(heartbeat_ms=100)
+    tr.input(20, 0, CENTER, battery=55)
+    tr.input(400, DU | B2, [128, 0, 128, 128, 0, 255], battery=55)
+    tr.input(1300, 0, CENTER, battery=54)
+    tr.end_ms = 2000
+    tr.write("heartbeat.txt", """
+Almost nothing happens: the state must be repeated every 100 ms, never
+sooner, and a change still goes out at once.
+""")
+
+
+def main():
+    os.makedirs(OUT, exist_ok=True)
+    taps()
+    sticks()
+    coalesce()
+    feedback()
+    poll_rate()
+    heartbeat()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,201 @@
+// sender.c - the firmware's JOCP sender on Linux sockets, driven by a trace
+//
+// Plays the controller: jocp_output.c with lwIP and CYW43 swapped for
+// POSIX sockets on 127.0.0.1. The trace's `in` lines are handed to
+// jocp_sender_set_state() at their time, as the router tap would; each
+// pass then reads the TCP control channel into jocp_sender_receive(),
+// sends an INPUT packet when jocp_sender_due() says so and polls
+// jocp_sender_get_feedback() the way the app does.
+//
+// tools/jocp-test-client/loopback.js plays the dongle and starts this
+// with the ports it listens on; see README.md. Times are microseconds
+// since the TCP connect, which is also what the packets carry.
+//
+// Usage: jocp-sender-loopback -u UDP_PORT -t TCP_PORT TRACE
+// Prints `fb T_US RL RR PLAYER R G B` per feedback change and, last,
+// `done sent=N dropped=N`.
+
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "jocp_sender.h"
+
+#define MAX_INPUTS          8192
+#define PASS_US             200         // Main loop pass, about the firmware's
+
+typedef struct {
+    uint32_t t_ms;
+    input_event_t event;
+} trace_input_t;
+
+static trace_input_t inputs[MAX_INPUTS];
+static int input_count;
+static uint32_t heartbeat_ms = 250;
+static uint32_t end_ms;
+
+// ============================================================================
+// TRACE
+// ============================================================================
+
+static bool load_trace(const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    char line[512];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        unsigned t, buttons, a[6], bat = 0;
+        int n;
+        if (sscanf(line, " hb %u", &t) == 1) {
+            heartbeat_ms = t;
+        } else if (sscanf(line, " end %u", &t) == 1) {
+            end_ms = t;
+        } else if ((n = sscanf(line, " in %u %x %u %u %u %u %u %u bat %u", &t, &buttons,
+                               &a[0], &a[1], &a[2], &a[3], &a[4], &a[5], &bat)) >= 8) {
+            if (input_count == MAX_INPUTS) {
+                fprintf(stderr, "%s:%d: more than %d inputs\n", path, lineno, MAX_INPUTS);
+                fclose(f);
+                return false;
+            }
+            trace_input_t* in = &inputs[input_count++];
+            in->t_ms = t;
+            init_input_event(&in->event);
+            in->event.buttons = buttons;
+            in->event.analog[ANALOG_LX] = (uint8_t)a[0];
+            in->event.analog[ANALOG_LY] = (uint8_t)a[1];
+            in->event.analog[ANALOG_RX] = (uint8_t)a[2];
+            in->event.analog[ANALOG_RY] = (uint8_t)a[3];
+            in->event.analog[ANALOG_L2] = (uint8_t)a[4];
+            in->event.analog[ANALOG_R2] = (uint8_t)a[5];
+            in->event.battery_level = (uint8_t)(n == 9 ? bat : 0);
+        }
+        // cmd and fb lines are for loopback.js
+    }
+
+    fclose(f);
+    return true;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static uint64_t mono_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+int main(int argc, char** argv)
+{
+    int udp_port = 0, tcp_port = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "u:t:")) != -1) {
+        switch (opt) {
+            case 'u': udp_port = atoi(optarg); break;
+            case 't': tcp_port = atoi(optarg); break;
+            default:  goto usage;
+        }
+    }
+    if (optind != argc - 1 || !udp_port || !tcp_port) goto usage;
+    if (!load_trace(argv[optind])) return 1;
+
+    struct sockaddr_in dongle = { .sin_family = AF_INET };
+    inet_pton(AF_INET, "127.0.0.1", &dongle.sin_addr);
+
+    int udp = socket(AF_INET, SOCK_DGRAM, 0);
+    int tcp = socket(AF_INET, SOCK_STREAM, 0);
+    if (udp < 0 || tcp < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    // Association: the control channel comes up first, as in link_up()
+    dongle.sin_port = htons((uint16_t)tcp_port);
+    if (connect(tcp, (struct sockaddr*)&dongle, sizeof(dongle)) < 0) {
+        perror("connect");
+        return 1;
+    }
+    fcntl(tcp, F_SETFL, fcntl(tcp, F_GETFL) | O_NONBLOCK);
+    dongle.sin_port = htons((uint16_t)udp_port);
+
+    static jocp_sender_t sender;
+    jocp_sender_init(&sender, heartbeat_ms);
+    jocp_sender_restart(&sender);
+
+    uint64_t t0 = mono_us();
+    uint32_t sent = 0;
+    bool tcp_open = true;
+    int next = 0;
+
+    for (;;) {
+        uint32_t now_us = (uint32_t)(mono_us() - t0);
+        if (now_us >= end_ms * 1000u) break;
+
+        // Router tap
+        while (next < input_count && inputs[next].t_ms * 1000u <= now_us) {
+            jocp_sender_set_state(&sender, &inputs[next++].event);
+        }
+
+        // Control channel
+        while (tcp_open) {
+            uint8_t buf[64];
+            ssize_t n = recv(tcp, buf, sizeof(buf), 0);
+            if (n > 0) {
+                jocp_sender_receive(&sender, buf, (uint16_t)n, now_us);
+            } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                tcp_open = false;
+            } else {
+                break;
+            }
+        }
+
+        if (jocp_sender_due(&sender, now_us)) {
+            jocp_input_packet_t packet;
+            jocp_sender_build(&sender, &packet, now_us);
+            if (sendto(udp, &packet, sizeof(packet), 0,
+                       (struct sockaddr*)&dongle, sizeof(dongle)) == sizeof(packet)) {
+                sent++;
+            } else {
+                sender.dirty = true;    // As send_input() does: retry next pass
+            }
+        }
+
+        output_feedback_t fb;
+        if (jocp_sender_get_feedback(&sender, &fb, now_us)) {
+            printf("fb %u %u %u %u %u %u %u\n", now_us, fb.rumble_left, fb.rumble_right,
+                   fb.led_player, fb.led_r, fb.led_g, fb.led_b);
+        }
+
+        usleep(PASS_US);
+    }
+
+    printf("done sent=%u dropped=%u\n", sent, sender.parser.dropped);
+    close(tcp);
+    close(udp);
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s -u UDP_PORT -t TCP_PORT TRACE\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,256 @@
+/**
+ * JOCP wire format
+ *
+ * Packet building and parsing shared by server.js (browser relay) and
+ * loopback.js (dongle stand-in for tools/jocp-sender-loopback). Node
+ * built-ins only, so the loopback check runs without `npm install`.
+ *
+ * Mirrors src/wifi/jocp/jocp.h. decodeToJoypad() does what the dongle's
+ * jocp_input.c does with a packet before it reaches the router.
+ */
+
+// Protocol constants
+const MAGIC = 0x4A50;  // "JP" little-endian
+const VERSION = 0x01;
+
+const UDP_PORT = 30100;
+const TCP_PORT = 30101;
+
+const MSG_INPUT = 0x01;
+const MSG_CAPS_REQ = 0x02;
+const MSG_CAPS_RES = 0x03;
+const MSG_OUTPUT_CMD = 0x04;
+const MSG_TIME_SYNC = 0x05;
+
+const FLAG_HAS_IMU = 0x01;
+const FLAG_HAS_TOUCH = 0x02;
+const FLAG_KEYFRAME = 0x04;
+
+const CMD_RUMBLE = 0x01;
+const CMD_PLAYER_LED = 0x02;
+const CMD_RGB_LED = 0x03;
+const CMD_POLL_RATE = 0x04;
+
+const HEADER_SIZE = 12;
+const INPUT_PACKET_SIZE = 76;
+
+// Payload length per OUTPUT_CMD
+const CMD_LEN = {
+    [CMD_RUMBLE]: 6,
+    [CMD_PLAYER_LED]: 1,
+    [CMD_RGB_LED]: 3,
+    [CMD_POLL_RATE]: 2,
+};
+
+// JOCP button bit -> Joypad (JP_BUTTON_*) bit, as jocp_input.c converts
+const BUTTON_MAP = [
+    [1 << 0, 1 << 0],    // SOUTH    -> B1
+    [1 << 1, 1 << 1],    // EAST     -> B2
+    [1 << 2, 1 << 2],    // WEST     -> B3
+    [1 << 3, 1 << 3],    // NORTH    -> B4
+    [1 << 4, 1 << 12],   // DU       -> DU
+    [1 << 5, 1 << 13],   // DD       -> DD
+    [1 << 6, 1 << 14],   // DL       -> DL
+    [1 << 7, 1 << 15],   // DR       -> DR
+    [1 << 8, 1 << 4],    // L1       -> L1
+    [1 << 9, 1 << 5],    // R1       -> R1
+    [1 << 10, 1 << 6],   // L2       -> L2
+    [1 << 11, 1 << 7],   // R2       -> R2
+    [1 << 12, 1 << 10],  // L3       -> L3
+    [1 << 13, 1 << 11],  // R3       -> R3
+    [1 << 16, 1 << 9],   // START    -> S2
+    [1 << 17, 1 << 8],   // BACK     -> S1
+    [1 << 18, 1 << 16],  // GUIDE    -> A1
+    [1 << 19, 1 << 17],  // CAPTURE  -> A2
+    [1 << 14, 1 << 20],  // L_PADDLE1 -> L4
+    [1 << 15, 1 << 21],  // R_PADDLE1 -> R4
+];
+
+// JP buttons that have a JOCP bit
+const JP_MAPPABLE = BUTTON_MAP.reduce((mask, [, jp]) => mask | jp, 0) >>> 0;
+
+function jpToJocpButtons(jp) {
+    let out = 0;
+    for (const [jocp, bit] of BUTTON_MAP) {
+        if (jp & bit) out |= jocp;
+    }
+    return out >>> 0;
+}
+
+function jocpToJpButtons(jocp) {
+    let out = 0;
+    for (const [bit, jp] of BUTTON_MAP) {
+        if (jocp & bit) out |= jp;
+    }
+    return out >>> 0;
+}
+
+// 0-255 (128 = center) -> int16, the controller side's widening
+function axisFromU8(v) {
+    return v >= 128 ? Math.trunc((v - 128) * 32767 / 127) : (v - 128) * 256;
+}
+
+// 0-255 -> uint16
+function triggerFromU8(v) {
+    return v * 257;
+}
+
+// Header (12 bytes) into buf at offset 0
+function writeHeader(buf, msgType, seq, flags, timestampUs) {
+    buf.writeUInt16LE(MAGIC, 0);
+    buf.writeUInt8(VERSION, 2);
+    buf.writeUInt8(msgType, 3);
+    buf.writeUInt16LE(seq & 0xFFFF, 4);
+    buf.writeUInt16LE(flags & 0xFFFF, 6);
+    buf.writeUInt32LE(timestampUs >>> 0, 8);
+}
+
+function parseHeader(buf) {
+    if (buf.length < HEADER_SIZE) return null;
+    return {
+        magic: buf.readUInt16LE(0),
+        version: buf.readUInt8(2),
+        msgType: buf.readUInt8(3),
+        seq: buf.readUInt16LE(4),
+        flags: buf.readUInt16LE(6),
+        timestampUs: buf.readUInt32LE(8),
+    };
+}
+
+/**
+ * Build a 76-byte INPUT packet.
+ *
+ * state: { buttons (JOCP bits), lx, ly, rx, ry (int16), lt, rt (uint16) }
+ * opts:  { flags, battery, plugStatus, controllerId }
+ * The IMU timestamp is the header timestamp.
+ */
+function buildInputPacket(state, seq, timestampUs, opts = {}) {
+    const buffer = Buffer.alloc(INPUT_PACKET_SIZE);
+    writeHeader(buffer, MSG_INPUT, seq, opts.flags ?? FLAG_KEYFRAME, timestampUs);
+
+    let offset = HEADER_SIZE;
+
+    // Buttons (4 bytes)
+    buffer.writeUInt32LE(state.buttons >>> 0, offset); offset += 4;
+
+    // Sticks (8 bytes) - signed 16-bit
+    buffer.writeInt16LE(state.lx, offset); offset += 2;
+    buffer.writeInt16LE(state.ly, offset); offset += 2;
+    buffer.writeInt16LE(state.rx, offset); offset += 2;
+    buffer.writeInt16LE(state.ry, offset); offset += 2;
+
+    // Triggers (4 bytes) - unsigned 16-bit
+    buffer.writeUInt16LE(state.lt, offset); offset += 2;
+    buffer.writeUInt16LE(state.rt, offset); offset += 2;
+
+    // IMU (12 bytes) - zeros
+    offset += 12;
+
+    // IMU timestamp (4 bytes)
+    buffer.writeUInt32LE(timestampUs >>> 0, offset); offset += 4;
+
+    // Touch (12 bytes) - zeros
+    offset += 12;
+
+    // Battery/status (2 bytes)
+    buffer.writeUInt8(opts.battery ?? 0, offset); offset += 1;
+    buffer.writeUInt8(opts.plugStatus ?? 0, offset); offset += 1;
+
+    // Controller ID (1 byte)
+    buffer.writeUInt8(opts.controllerId ?? 0, offset);
+
+    // Reserved (17 bytes) - already zeroed by Buffer.alloc
+    return buffer;
+}
+
+// INPUT packet -> header + payload fields
+function parseInputPacket(buf) {
+    const header = parseHeader(buf);
+    if (!header || buf.length < INPUT_PACKET_SIZE) return null;
+    return {
+        header,
+        buttons: buf.readUInt32LE(12),
+        lx: buf.readInt16LE(16),
+        ly: buf.readInt16LE(18),
+        rx: buf.readInt16LE(20),
+        ry: buf.readInt16LE(22),
+        lt: buf.readUInt16LE(24),
+        rt: buf.readUInt16LE(26),
+        imuTimestamp: buf.readUInt32LE(40),
+        battery: buf.readUInt8(56),
+        plugStatus: buf.readUInt8(57),
+        controllerId: buf.readUInt8(58),
+    };
+}
+
+// Parsed INPUT -> what the dongle hands its router (JP buttons, 8-bit axes)
+function decodeToJoypad(input) {
+    return {
+        buttons: jocpToJpButtons(input.buttons),
+        analog: [
+            (input.lx + 32768) >> 8,
+            (input.ly + 32768) >> 8,
+            (input.rx + 32768) >> 8,
+            (input.ry + 32768) >> 8,
+            input.lt >> 8,
+            input.rt >> 8,
+        ],
+    };
+}
+
+/**
+ * Build an OUTPUT_CMD packet.
+ *
+ * rumble:     { left, right, leftBrake, rightBrake, durationMs }
+ * player_led: { index }
+ * rgb_led:    { r, g, b }
+ * poll_rate:  { hz }
+ */
+function buildOutputCmd(cmd, args, timestampUs = 0) {
+    const buffer = Buffer.alloc(HEADER_SIZE + 1 + CMD_LEN[cmd]);
+    writeHeader(buffer, MSG_OUTPUT_CMD, 0, 0, timestampUs);
+    buffer.writeUInt8(cmd, HEADER_SIZE);
+
+    const p = HEADER_SIZE + 1;
+    switch (cmd) {
+        case CMD_RUMBLE:
+            buffer.writeUInt8(args.left, p);
+            buffer.writeUInt8(args.leftBrake ? 1 : 0, p + 1);
+            buffer.writeUInt8(args.right, p + 2);
+            buffer.writeUInt8(args.rightBrake ? 1 : 0, p + 3);
+            buffer.writeUInt16LE(args.durationMs || 0, p + 4);
+            break;
+        case CMD_PLAYER_LED:
+            buffer.writeUInt8(args.index, p);
+            break;
+        case CMD_RGB_LED:
+            buffer.writeUInt8(args.r, p);
+            buffer.writeUInt8(args.g, p + 1);
+            buffer.writeUInt8(args.b, p + 2);
+            break;
+        case CMD_POLL_RATE:
+            buffer.writeUInt16LE(args.hz, p);
+            break;
+        default:
+            throw new Error(`unknown OUTPUT_CMD ${cmd}`);
+    }
+    return buffer;
+}
+
+// Bare header (CAPS_REQ, TIME_SYNC probes)
+function buildHeaderOnly(msgType, timestampUs = 0) {
+    const buffer = Buffer.alloc(HEADER_SIZE);
+    writeHeader(buffer, msgType, 0, 0, timestampUs);
+    return buffer;
+}
+
+module.exports = {
+    MAGIC, VERSION, UDP_PORT, TCP_PORT,
+    MSG_INPUT, MSG_CAPS_REQ, MSG_CAPS_RES, MSG_OUTPUT_CMD, MSG_TIME_SYNC,
+    FLAG_HAS_IMU, FLAG_HAS_TOUCH, FLAG_KEYFRAME,
+    CMD_RUMBLE, CMD_PLAYER_LED, CMD_RGB_LED, CMD_POLL_RATE, CMD_LEN,
+    HEADER_SIZE, INPUT_PACKET_SIZE, JP_MAPPABLE,
+    jpToJocpButtons, jocpToJpButtons, axisFromU8, triggerFromU8,
+    writeHeader, parseHeader, buildInputPacket, parseInputPacket,
+    decodeToJoypad, buildOutputCmd, buildHeaderOnly,
+};
@@ -0,0 +1,374 @@
+#!/usr/bin/env node
+/**
+ * JOCP Loopback Check
+ *
+ * Plays the dongle for tools/jocp-sender-loopback, the firmware's JOCP
+ * sender built for Linux. For each trace it listens on 127.0.0.1 (UDP for
+ * INPUT, TCP for the control channel, ephemeral ports), starts the sender
+ * on the trace, sends the trace's `cmd` lines as OUTPUT_CMDs at their time
+ * and checks everything that comes back against jocp.js.
+ *
+ * Usage:
+ *   node loopback.js --sender PATH [-v] TRACE...
+ *
+ * Exit status 1 if any check fails. Built-in modules only.
+ */
+
+const dgram = require('dgram');
+const net = require('net');
+const fs = require('fs');
+const path = require('path');
+const { spawn } = require('child_process');
+const jocp = require('./jocp');
+
+// Scheduling jitter allowed on the host, in microseconds. Checks that
+// only involve the sender's own clock (heartbeat floor, poll rate) are
+// exact.
+const SLACK_US = 30000;
+
+// ============================================================================
+// TRACE
+// ============================================================================
+
+function parseTrace(file) {
+    const trace = { hb: 250, end: 0, inputs: [], cmds: [], fb: [] };
+
+    fs.readFileSync(file, 'utf8').split('\n').forEach((raw, i) => {
+        const line = raw.replace(/#.*/, '').trim();
+        if (!line) return;
+        const w = line.split(/\s+/);
+        const num = (s) => parseInt(s, 10);
+
+        switch (w[0]) {
+            case 'hb': trace.hb = num(w[1]); break;
+            case 'end': trace.end = num(w[1]); break;
+            case 'in':
+                trace.inputs.push({
+                    t: num(w[1]),
+                    buttons: parseInt(w[2], 16) >>> 0,
+                    analog: w.slice(3, 9).map(num),
+                    battery: w[9] === 'bat' ? num(w[10]) : 0,
+                });
+                break;
+            case 'cmd':
+                trace.cmds.push({ t: num(w[1]), kind: w[2], bytes: cmdBytes(w[2], w.slice(3)) });
+                break;
+            case 'fb':
+                trace.fb.push({ t: num(w[1]), values: w.slice(2, 8).map(num) });
+                break;
+            default:
+                throw new Error(`${file}:${i + 1}: unknown line '${line}'`);
+        }
+    });
+
+    return trace;
+}
+
+function cmdBytes(kind, args) {
+    const n = args.map((a) => parseInt(a, 10));
+    switch (kind) {
+        case 'rumble':
+            return jocp.buildOutputCmd(jocp.CMD_RUMBLE, { left: n[0], right: n[1], durationMs: n[2] });
+        case 'led':
+            return jocp.buildOutputCmd(jocp.CMD_PLAYER_LED, { index: n[0] });
+        case 'rgb':
+            return jocp.buildOutputCmd(jocp.CMD_RGB_LED, { r: n[0], g: n[1], b: n[2] });
+        case 'rate':
+            return jocp.buildOutputCmd(jocp.CMD_POLL_RATE, { hz: n[0] });
+        case 'caps':
+            return jocp.buildHeaderOnly(jocp.MSG_CAPS_REQ);
+        case 'junk':
+            return Buffer.from(args.map((a) => parseInt(a, 16)));
+        default:
+            throw new Error(`unknown cmd '${kind}'`);
+    }
+}
+
+// Router output state -> the INPUT packet the sender must send for it
+function referencePacket(input, seq, timestampUs) {
+    const state = {
+        buttons: jocp.jpToJocpButtons(input.buttons),
+        lx: jocp.axisFromU8(input.analog[0]),
+        ly: jocp.axisFromU8(input.analog[1]),
+        rx: jocp.axisFromU8(input.analog[2]),
+        ry: jocp.axisFromU8(input.analog[3]),
+        lt: jocp.triggerFromU8(input.analog[4]),
+        rt: jocp.triggerFromU8(input.analog[5]),
+    };
+    return jocp.buildInputPacket(state, seq, timestampUs, { battery: input.battery });
+}
+
+// Bytes that make two inputs the same on the wire (header and timestamps aside)
+function wireKey(input) {
+    const pkt = referencePacket(input, 0, 0);
+    return pkt.subarray(jocp.HEADER_SIZE).toString('hex');
+}
+
+// ============================================================================
+// RUN
+// ============================================================================
+
+// Deterministic chunk sizes for splitting commands across TCP writes
+function makeLcg(seed) {
+    let s = seed >>> 0;
+    return (lo, hi) => {
+        s = (Math.imul(s, 1103515245) + 12345) >>> 0;
+        return lo + ((s >>> 8) % (hi - lo + 1));
+    };
+}
+
+function writeSplit(sock, bytes, rng) {
+    const chunks = [];
+    for (let i = 0; i < bytes.length;) {
+        const n = rng(1, 5);
+        chunks.push(bytes.subarray(i, i + n));
+        i += n;
+    }
+    const next = () => {
+        const chunk = chunks.shift();
+        if (!chunk || sock.destroyed) return;
+        sock.write(chunk);
+        setImmediate(next);
+    };
+    next();
+}
+
+function runSender(sender, file, trace) {
+    return new Promise((resolve, reject) => {
+        const packets = [];
+        const udp = dgram.createSocket('udp4');
+        udp.on('message', (msg) => packets.push(Buffer.from(msg)));
+
+        const timers = [];
+        const server = net.createServer((sock) => {
+            sock.setNoDelay(true);
+            sock.on('error', () => {});
+            const rng = makeLcg(trace.cmds.length + 1);
+            for (const cmd of trace.cmds) {
+                timers.push(setTimeout(() => writeSplit(sock, cmd.bytes, rng), cmd.t));
+            }
+        });
+
+        udp.bind(0, '127.0.0.1', () => {
+            server.listen(0, '127.0.0.1', () => {
+                const args = ['-u', String(udp.address().port), '-t', String(server.address().port), file];
+                const child = spawn(sender, args, { stdio: ['ignore', 'pipe', 'inherit'] });
+                let stdout = '';
+                child.stdout.on('data', (d) => { stdout += d; });
+                child.on('error', reject);
+                child.on('close', (code) => {
+                    timers.forEach(clearTimeout);
+                    // Let the last datagrams drain before closing
+                    setTimeout(() => {
+                        udp.close();
+                        server.close();
+                        resolve({ code, stdout, packets });
+                    }, 50);
+                });
+            });
+        });
+    });
+}
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+function check(trace, run, verbose) {
+    const errors = [];
+    const fail = (msg) => { if (errors.length < 20) errors.push(msg); };
+
+    if (run.code !== 0) fail(`sender exited with status ${run.code}`);
+
+    const out = run.stdout.split('\n').filter(Boolean);
+    const done = out.find((l) => l.startsWith('done'));
+    const m = done && /sent=(\d+) dropped=(\d+)/.exec(done);
+    if (!m) {
+        fail('no summary line from the sender');
+        return { errors, summary: '' };
+    }
+    const sent = parseInt(m[1], 10);
+    const dropped = parseInt(m[2], 10);
+
+    // State the tap had handed over by time ts (µs): inputs apply at their
+    // millisecond, before that pass's send
+    const inputs = trace.inputs;
+    const stateAt = (ts) => {
+        let s = null;
+        for (const input of inputs) {
+            if (input.t * 1000 > ts) break;
+            s = input;
+        }
+        return s;
+    };
+
+    // Poll-rate cap in force: [from, to) with the interval; from is moved
+    // past the command's travel time, to is the lifting command's send time
+    const caps = [];
+    trace.cmds.filter((c) => c.kind === 'rate').forEach((c) => {
+        const hz = c.bytes.readUInt16LE(jocp.HEADER_SIZE + 1);
+        if (caps.length && caps[caps.length - 1].to === Infinity) caps[caps.length - 1].to = c.t * 1000;
+        if (hz) caps.push({ from: c.t * 1000 + SLACK_US, to: Infinity, interval: Math.floor(1e6 / hz) });
+    });
+    const capAround = (ts) => caps.reduce((max, c) =>
+        (ts >= c.from - 2 * SLACK_US && ts < c.to + SLACK_US ? Math.max(max, c.interval) : max), 0);
+
+    // -- Every packet: framing, sequence, exact bytes, what the dongle makes of it
+    if (run.packets.length !== sent) fail(`sender sent ${sent} packets, ${run.packets.length} arrived`);
+
+    const pkts = [];
+    run.packets.forEach((buf, i) => {
+        if (buf.length !== jocp.INPUT_PACKET_SIZE) {
+            fail(`packet ${i}: ${buf.length} bytes`);
+            return;
+        }
+        const p = jocp.parseInputPacket(buf);
+        const h = p.header;
+        pkts.push(h.timestampUs);
+
+        if (h.magic !== jocp.MAGIC || h.version !== jocp.VERSION || h.msgType !== jocp.MSG_INPUT) {
+            fail(`packet ${i}: bad header ${buf.subarray(0, 4).toString('hex')}`);
+            return;
+        }
+        if (h.seq !== (i & 0xFFFF)) fail(`packet ${i}: seq ${h.seq}`);
+        if (h.flags !== jocp.FLAG_KEYFRAME) fail(`packet ${i}: flags 0x${h.flags.toString(16)}`);
+
+        const expected = stateAt(h.timestampUs);
+        if (!expected) {
+            fail(`packet ${i}: sent at ${h.timestampUs} µs, before the first input`);
+            return;
+        }
+        const ref = referencePacket(expected, i, h.timestampUs);
+        if (!ref.equals(buf)) {
+            fail(`packet ${i} at ${h.timestampUs} µs: got ${buf.subarray(12, 28).toString('hex')}, ` +
+                 `want ${ref.subarray(12, 28).toString('hex')} (input at ${expected.t} ms)`);
+        }
+
+        const decoded = jocp.decodeToJoypad(p);
+        const want = expected.buttons & jocp.JP_MAPPABLE;
+        if (decoded.buttons !== want || decoded.analog.some((v, k) => v !== expected.analog[k])) {
+            fail(`packet ${i}: dongle reads ${decoded.buttons.toString(16)} [${decoded.analog}], ` +
+                 `want ${want.toString(16)} [${expected.analog}]`);
+        }
+
+        if (verbose) {
+            console.log(`  #${i} ${(h.timestampUs / 1000).toFixed(1)} ms ` +
+                        `buttons=${decoded.buttons.toString(16)} analog=[${decoded.analog}]`);
+        }
+    });
+
+    // -- Wire changes: which tap calls changed the bytes, and when
+    const changes = [];
+    let lastKey = null;
+    for (const input of inputs) {
+        const key = wireKey(input);
+        if (key !== lastKey) changes.push(input.t * 1000);
+        lastKey = key;
+    }
+    const changedIn = (a, b) => changes.some((t) => t > a && t <= b);
+
+    // -- Gaps: heartbeat never early, never late; poll rate cap held
+    let maxGap = 0;
+    for (let i = 1; i < pkts.length; i++) {
+        const a = pkts[i - 1], b = pkts[i];
+        const gap = b - a;
+        if (gap < 0) fail(`packet ${i}: timestamp went back ${-gap} µs`);
+        maxGap = Math.max(maxGap, gap);
+
+        if (!changedIn(a, b) && gap < trace.hb * 1000) {
+            fail(`packet ${i}: repeat after ${gap} µs, heartbeat is ${trace.hb} ms`);
+        }
+        if (gap > trace.hb * 1000 + SLACK_US) {
+            fail(`packets ${i - 1}-${i}: ${gap} µs apart, heartbeat is ${trace.hb} ms`);
+        }
+        for (const c of caps) {
+            if (a >= c.from && b < c.to && gap < c.interval) {
+                fail(`packets ${i - 1}-${i}: ${gap} µs apart under a ${c.interval} µs poll-rate cap`);
+            }
+        }
+    }
+
+    // -- Latency: a change that stands long enough goes out within the cap
+    let maxLatency = 0;
+    changes.forEach((t, k) => {
+        const next = k + 1 < changes.length ? changes[k + 1] : trace.end * 1000;
+        const bound = capAround(t) + SLACK_US;
+        if (next - t <= bound) return;      // Superseded (or cut off) before it had to go
+        const p = pkts.find((ts) => ts >= t);
+        const latency = p === undefined ? Infinity : p - t;
+        if (latency > bound) fail(`change at ${t / 1000} ms: first sent ${latency} µs later`);
+        else maxLatency = Math.max(maxLatency, latency);
+    });
+
+    // -- Feedback the app reads
+    const fbLines = out.filter((l) => l.startsWith('fb ')).map((l) => {
+        const v = l.split(/\s+/).slice(1).map((s) => parseInt(s, 10));
+        return { t: v[0], values: v.slice(1) };
+    });
+    if (fbLines.length !== trace.fb.length) {
+        fail(`${fbLines.length} feedback changes, want ${trace.fb.length}`);
+    }
+    trace.fb.forEach((want, k) => {
+        const got = fbLines[k];
+        if (!got) return;
+        if (got.values.join(' ') !== want.values.join(' ')) {
+            fail(`feedback ${k}: got ${got.values.join(' ')}, want ${want.values.join(' ')} (at ${want.t} ms)`);
+        } else if (Math.abs(got.t - want.t * 1000) > SLACK_US) {
+            fail(`feedback ${k} (${want.values.join(' ')}): at ${got.t} µs, want ${want.t} ms`);
+        }
+    });
+
+    const junk = trace.cmds.filter((c) => c.kind === 'junk').reduce((n, c) => n + c.bytes.length, 0);
+    if (dropped !== junk) fail(`parser skipped ${dropped} bytes, want ${junk}`);
+
+    const summary = `${pkts.length} packets for ${inputs.length} taps, ` +
+                    `max gap ${(maxGap / 1000).toFixed(1)} ms, ` +
+                    `max latency ${(maxLatency / 1000).toFixed(1)} ms, ` +
+                    `${fbLines.length} feedback changes`;
+    return { errors, summary };
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+async function main() {
+    const argv = process.argv.slice(2);
+    let sender = null;
+    let verbose = false;
+    const files = [];
+    for (let i = 0; i < argv.length; i++) {
+        if (argv[i] === '--sender') sender = argv[++i];
+        else if (argv[i] === '-v') verbose = true;
+        else files.push(argv[i]);
+    }
+    if (!sender || files.length === 0) {
+        console.error('usage: node loopback.js --sender PATH [-v] TRACE...');
+        process.exit(2);
+    }
+    sender = path.resolve(sender);
+
+    let failed = 0;
+    for (const file of files) {
+        const name = path.basename(file);
+        const trace = parseTrace(file);
+        if (verbose) console.log(`${name}:`);
+        const run = await runSender(sender, file, trace);
+        const { errors, summary } = check(trace, run, verbose);
+        if (errors.length) {
+            failed++;
+            console.log(`${name}: FAIL`);
+            errors.forEach((e) => console.log(`  ${e}`));
+        } else {
+            console.log(`${name}: ok — ${summary}`);
+        }
+    }
+
+    console.log(failed ? `${failed} of ${files.length} traces failed` : `all ${files.length} traces passed`);
+    process.exit(failed ? 1 : 0);
+}
+
+main().catch((e) => {
+    console.error(e.message);
+    process.exit(1);
+});
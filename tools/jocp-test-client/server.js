@@ -17,12 +17,13 @@ const http = require('http');
 const fs = require('fs');
 const path = require('path');
 const WebSocket = require('ws');
+const jocp = require('./jocp');
 
 // Configuration
 const CONFIG = {
     // Dongle IP (default for Joypad AP)
     dongleIp: process.env.DONGLE_IP || '192.168.4.1',
-    donglePort: parseInt(process.env.DONGLE_PORT || '30100'),
+    donglePort: parseInt(process.env.DONGLE_PORT || String(jocp.UDP_PORT)),
 
     // Local server
     httpPort: parseInt(process.env.HTTP_PORT || '3001'),
@@ -31,12 +32,6 @@ const CONFIG = {
     pollRate: parseInt(process.env.POLL_RATE || '125'),
 };
 
-// JOCP Protocol Constants
-const JOCP_MAGIC = 0x4A50;  // "JP" little-endian
-const JOCP_VERSION = 0x01;
-const JOCP_MSG_INPUT = 0x01;
-const JOCP_FLAG_KEYFRAME = 0x04;
-
 // Current controller state
 let controllerState = {
     buttons: 0,
@@ -55,53 +50,11 @@ udpSocket.bind(CONFIG.donglePort, () => {
 
 // Build JOCP input packet (76 bytes)
 function buildJocpPacket() {
-    const buffer = Buffer.alloc(76);
-    let offset = 0;
-
-    // Header (12 bytes)
-    buffer.writeUInt16LE(JOCP_MAGIC, offset); offset += 2;
-    buffer.writeUInt8(JOCP_VERSION, offset); offset += 1;
-    buffer.writeUInt8(JOCP_MSG_INPUT, offset); offset += 1;
-    buffer.writeUInt16LE(sequenceNumber++ & 0xFFFF, offset); offset += 2;
-    buffer.writeUInt16LE(JOCP_FLAG_KEYFRAME, offset); offset += 2;
     // Timestamp in microseconds, wrapped to 32-bit
     const timestamp = Number(BigInt(Date.now()) * 1000n % 0x100000000n);
-    buffer.writeUInt32LE(timestamp, offset); offset += 4;
-
-    // Payload (64 bytes)
-    // Buttons (4 bytes)
-    buffer.writeUInt32LE(controllerState.buttons, offset); offset += 4;
-
-    // Sticks (8 bytes) - signed 16-bit
-    buffer.writeInt16LE(controllerState.lx, offset); offset += 2;
-    buffer.writeInt16LE(controllerState.ly, offset); offset += 2;
-    buffer.writeInt16LE(controllerState.rx, offset); offset += 2;
-    buffer.writeInt16LE(controllerState.ry, offset); offset += 2;
-
-    // Triggers (4 bytes) - unsigned 16-bit
-    buffer.writeUInt16LE(controllerState.lt, offset); offset += 2;
-    buffer.writeUInt16LE(controllerState.rt, offset); offset += 2;
-
-    // IMU (12 bytes) - zeros for now
-    offset += 12;
-
-    // IMU timestamp (4 bytes)
-    buffer.writeUInt32LE(timestamp, offset); offset += 4;
-
-    // Touch (12 bytes) - zeros
-    offset += 12;
-
-    // Battery/status (2 bytes)
-    buffer.writeUInt8(100, offset); offset += 1;  // Battery 100%
-    buffer.writeUInt8(0, offset); offset += 1;    // Not charging/wired
-
-    // Controller ID (1 byte)
-    buffer.writeUInt8(0, offset); offset += 1;
-
-    // Reserved (17 bytes) - zeros
-    // Already zeroed by Buffer.alloc
-
-    return buffer;
+    return jocp.buildInputPacket(controllerState, sequenceNumber++, timestamp, {
+        battery: 100,   // Battery 100%, not charging/wired
+    });
 }
 
 // Send packet to dongle
@@ -232,14 +185,11 @@ Environment variables:
 udpSocket.on('message', (msg, rinfo) => {
     if (msg.length < 12) return;  // Too short for header
 
-    const magic = msg.readUInt16LE(0);
-    const version = msg.readUInt8(2);
-    const msgType = msg.readUInt8(3);
+    const header = jocp.parseHeader(msg);
 
-    if (magic !== JOCP_MAGIC || version !== JOCP_VERSION) return;
+    if (header.magic !== jocp.MAGIC || header.version !== jocp.VERSION) return;
 
-    // OUTPUT_CMD = 0x04
-    if (msgType === 0x04 && msg.length >= 13) {
+    if (header.msgType === jocp.MSG_OUTPUT_CMD && msg.length >= 13) {
         const cmdType = msg.readUInt8(12);
 
         let feedback = null;
@@ -0,0 +1,316 @@
+// conformance.c - plays mainboard JVS traffic into the firmware's jvs_node.c
+// and checks every reply byte for byte
+//
+// Packets go in one byte at a time, the way jvs_device.c feeds the UART, with
+// jvs_node_prepare() run before each one as the device's idle loop does. Each
+// reply is also checked against a copy of the node that has no precomputed
+// frame, so the fast path can never answer differently from the slow one.
+//
+// Usage: jvs-device-conformance [-v] traffic.txt...
+//   -v  print every packet and reply
+// Exit status 1 if any check fails.
+//
+// File format, one item per line, '#' starts a comment:
+//   > <hex>                    bytes from the mainboard, as on the wire
+//   < <hex> | none             the reply that must follow, as on the wire
+//   in p<n> <sw0> <sw1>        player n switch bytes
+//   in system <byte>           system switch byte (0x80 = TEST)
+//   in analog <ch> <hex16>     analog channel value
+//   in rotary <ch> <hex16>     rotary channel position
+//   in coin <slot> <count>     that many coin presses on slot 1 or 2
+//   expect sense <0|1>         sense line released / pulled low (addressed)
+//   expect fast                last reply came from the precomputed frame
+//   expect slow                last reply was built on arrival
+//   expect gpo <hex>           general-purpose output bytes (after idle time)
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "native/device/jvs/jvs_node.h"
+
+#define MAX_LINE    2048
+#define MAX_BYTES   (JVS_NODE_MAX_FRAME * 2)
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+static jvs_node_t node;
+static jvs_node_t shadow;
+static jvs_node_inputs_t inputs;
+static uint8_t reply[MAX_BYTES];
+static uint16_t reply_len;
+static bool reply_pending;          // A '>' line still waiting for its '<'
+static bool last_fast;
+static bool verbose = false;
+static int failures = 0;
+static int checks = 0;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static int parse_hex(const char* s, uint8_t* out, int max)
+{
+    int n = 0;
+    int nibble = -1;
+    for (; *s && *s != '#'; s++) {
+        int v;
+        if (*s >= '0' && *s <= '9') v = *s - '0';
+        else if (*s >= 'a' && *s <= 'f') v = *s - 'a' + 10;
+        else if (*s >= 'A' && *s <= 'F') v = *s - 'A' + 10;
+        else if (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r') {
+            if (nibble >= 0) return -1;
+            continue;
+        }
+        else return -1;
+
+        if (nibble < 0) {
+            nibble = v;
+        } else {
+            if (n >= max) return -1;
+            out[n++] = (uint8_t)((nibble << 4) | v);
+            nibble = -1;
+        }
+    }
+    return nibble < 0 ? n : -1;
+}
+
+__attribute__((format(printf, 3, 4)))
+static void fail(const char* file, int line, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%s:%d: ", file, line);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    failures++;
+}
+
+static void print_bytes(FILE* f, const uint8_t* b, int n)
+{
+    if (n == 0) fprintf(f, "none");
+    for (int i = 0; i < n; i++) fprintf(f, "%s%02x", i ? " " : "", b[i]);
+}
+
+// ============================================================================
+// TRAFFIC
+// ============================================================================
+
+static void mainboard_sends(const char* file, int line, const uint8_t* b, int n)
+{
+    // Idle time before the packet, as in jvs_device_core1_task
+    jvs_node_prepare(&node);
+
+    // The same traffic into a copy with no precomputed frame
+    shadow = node;
+    shadow.poll_tx_len = 0;
+    shadow.poll_replayed = false;
+
+    uint32_t fast_before = node.polls_fast;
+    reply_len = 0;
+    uint8_t shadow_reply[MAX_BYTES];
+    uint16_t shadow_len = 0;
+
+    for (int i = 0; i < n; i++) {
+        const uint8_t* r = NULL;
+        uint16_t len = jvs_node_rx(&node, b[i], &r);
+        if (len) {
+            if (i != n - 1) fail(file, line, "reply before the packet's last byte (%d of %d)", i + 1, n);
+            memcpy(reply, r, len);
+            reply_len = len;
+        }
+        len = jvs_node_rx(&shadow, b[i], &r);
+        if (len) {
+            memcpy(shadow_reply, r, len);
+            shadow_len = len;
+        }
+    }
+    last_fast = node.polls_fast != fast_before;
+
+    checks++;
+    if (reply_len != shadow_len || memcmp(reply, shadow_reply, reply_len) != 0) {
+        fprintf(stderr, "%s:%d: precomputed reply ", file, line);
+        print_bytes(stderr, reply, reply_len);
+        fprintf(stderr, " differs from built ");
+        print_bytes(stderr, shadow_reply, shadow_len);
+        fputc('\n', stderr);
+        failures++;
+    }
+
+    if (verbose) {
+        printf("%s:%d: > ", file, line);
+        print_bytes(stdout, b, n);
+        printf("\n%s:%d: < ", file, line);
+        print_bytes(stdout, reply, reply_len);
+        printf("%s\n", last_fast ? "  (precomputed)" : "");
+    }
+    reply_pending = true;
+}
+
+static void expect_reply(const char* file, int line, const char* args)
+{
+    uint8_t want[MAX_BYTES];
+    int n;
+
+    checks++;
+    if (!reply_pending) {
+        fail(file, line, "'<' without a packet before it");
+        return;
+    }
+    reply_pending = false;
+
+    while (*args == ' ' || *args == '\t') args++;
+    if (strncmp(args, "none", 4) == 0) {
+        n = 0;
+    } else {
+        n = parse_hex(args, want, sizeof(want));
+        if (n <= 0) {
+            fail(file, line, "bad reply bytes");
+            return;
+        }
+    }
+
+    if (n != reply_len || memcmp(want, reply, n) != 0) {
+        fprintf(stderr, "%s:%d: reply ", file, line);
+        print_bytes(stderr, reply, reply_len);
+        fprintf(stderr, ", expected ");
+        print_bytes(stderr, want, n);
+        fputc('\n', stderr);
+        failures++;
+    }
+}
+
+static void set_input(const char* file, int line, const char* args)
+{
+    unsigned a, b, c;
+    if (sscanf(args, "p%u %x %x", &a, &b, &c) == 3 && a >= 1 && a <= JVS_NODE_PLAYERS) {
+        inputs.sw[a - 1][0] = (uint8_t)b;
+        inputs.sw[a - 1][1] = (uint8_t)c;
+    } else if (sscanf(args, "system %x", &a) == 1) {
+        inputs.system = (uint8_t)a;
+    } else if (sscanf(args, "analog %u %x", &a, &b) == 2 && a < JVS_NODE_ANALOG_CHANNELS) {
+        inputs.analog[a] = (uint16_t)b;
+    } else if (sscanf(args, "rotary %u %x", &a, &b) == 2 && a < JVS_NODE_ROTARY_CHANNELS) {
+        inputs.rotary[a] = (uint16_t)b;
+    } else if (sscanf(args, "coin %u %u", &a, &b) == 2 && a >= 1 && a <= JVS_NODE_COIN_SLOTS) {
+        inputs.coin_presses[a - 1] = (uint16_t)(inputs.coin_presses[a - 1] + b);
+    } else {
+        fail(file, line, "bad input line");
+        return;
+    }
+    jvs_node_set_inputs(&node, &inputs);
+}
+
+static void check_expect(const char* file, int line, const char* args)
+{
+    int v;
+    checks++;
+    if (sscanf(args, "sense %d", &v) == 1) {
+        if (jvs_node_addressed(&node) != (v != 0)) {
+            fail(file, line, "sense %s, expected %s", jvs_node_addressed(&node) ? "low (addressed)" : "released",
+                 v ? "low (addressed)" : "released");
+        }
+    } else if (strncmp(args, "fast", 4) == 0) {
+        if (!last_fast) fail(file, line, "reply was built on arrival, expected precomputed");
+    } else if (strncmp(args, "slow", 4) == 0) {
+        if (last_fast) fail(file, line, "reply was precomputed, expected built on arrival");
+    } else if (strncmp(args, "gpo ", 4) == 0) {
+        uint8_t want[JVS_NODE_GPO_BYTES];
+        if (parse_hex(args + 4, want, sizeof(want)) != JVS_NODE_GPO_BYTES) {
+            fail(file, line, "expect gpo needs %d bytes", JVS_NODE_GPO_BYTES);
+            return;
+        }
+        // Writes from a precomputed reply land in idle time
+        jvs_node_prepare(&node);
+        if (memcmp(want, node.gpo, sizeof(want)) != 0) {
+            fail(file, line, "gpo %02x %02x, expected %02x %02x",
+                 node.gpo[0], node.gpo[1], want[0], want[1]);
+        }
+    } else {
+        fail(file, line, "unknown expectation");
+    }
+}
+
+// ============================================================================
+// FILES
+// ============================================================================
+
+static void run_file(const char* file)
+{
+    FILE* f = fopen(file, "r");
+    if (!f) {
+        perror(file);
+        failures++;
+        return;
+    }
+
+    jvs_node_init(&node);
+    inputs = node.in;
+    reply_pending = false;
+    last_fast = false;
+
+    char buf[MAX_LINE];
+    int line = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        line++;
+        char* s = buf;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#' || *s == '\n' || *s == '\0') continue;
+
+        if (reply_pending && *s != '<') {
+            fail(file, line, "packet without a '<' line after it");
+            reply_pending = false;
+        }
+
+        if (*s == '>') {
+            uint8_t b[MAX_BYTES];
+            int n = parse_hex(s + 1, b, sizeof(b));
+            if (n <= 0) {
+                fail(file, line, "bad packet bytes");
+                continue;
+            }
+            mainboard_sends(file, line, b, n);
+        } else if (*s == '<') {
+            expect_reply(file, line, s + 1);
+        } else if (strncmp(s, "in ", 3) == 0) {
+            set_input(file, line, s + 3);
+        } else if (strncmp(s, "expect ", 7) == 0) {
+            check_expect(file, line, s + 7);
+        } else {
+            fail(file, line, "unrecognised line");
+        }
+    }
+    if (reply_pending) fail(file, line, "packet without a '<' line after it");
+    fclose(f);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        if (opt == 'v') verbose = true;
+        else {
+            fprintf(stderr, "usage: %s [-v] traffic.txt...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-v] traffic.txt...\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        run_file(argv[i]);
+    }
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
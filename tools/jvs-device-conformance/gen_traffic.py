@@ -0,0 +1,325 @@
+#!/usr/bin/env python3
+"""Generate the JVS traffic files in traffic/.
+
+Each file is mainboard traffic in the order a capture shows it: the packets a
+Naomi-class mainboard sends, each followed by the reply an I/O board owes it.
+Replies come from a small reference model of the JVS spec written here,
+separately from the firmware's jvs_node.c, so the two check each other.
+
+Deterministic: running it again rewrites identical files.
+"""
+
+import os
+
+OUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "traffic")
+
+SYNC, MARK = 0xE0, 0xD0
+BROADCAST = 0xFF
+
+# Must match jvs_node.h
+IDENT = b"SEGA ENTERPRISES,LTD.;I/O BD JVS;837-13551 ;Ver1.00;98/10\x00"
+FEATURES = [0x01, 2, 13, 0, 0x02, 2, 0, 0, 0x03, 8, 10, 0, 0x04, 2, 0, 0,
+            0x12, 16, 0, 0, 0x00]
+COIN_MAX = 0x3FFF
+
+
+def frame(addr, data):
+    """A packet as it goes over the wire: escaped, with its checksum."""
+    body = [addr, len(data) + 1] + list(data)
+    body.append(sum(body) & 0xFF)
+    out = [SYNC]
+    for b in body:
+        if b in (SYNC, MARK):
+            out += [MARK, b - 1]
+        else:
+            out.append(b)
+    return out
+
+
+class Board:
+    """What a spec-following I/O board answers."""
+
+    def __init__(self):
+        self.addr = 0
+        self.system = 0
+        self.sw = [[0, 0], [0, 0]]
+        self.analog = [0x8000] * 8
+        self.rotary = [0, 0]
+        self.coins = [0, 0]
+        self.last = None
+
+    def reset(self):
+        self.addr = 0
+        self.coins = [0, 0]
+        self.last = None
+
+    def packet(self, addr, data):
+        if addr == BROADCAST:
+            if data[:2] == [0xF0, 0xD9]:
+                self.reset()
+            elif data[0] == 0xF1 and self.addr == 0:
+                self.addr = data[1]
+                self.last = frame(0, [0x01, 0x01])
+                return self.last
+            return None
+        if self.addr == 0 or addr != self.addr:
+            return None
+        if data[0] == 0x2F:
+            return self.last
+        status, payload = self.run(data)
+        self.last = frame(0, [status] + payload)
+        return self.last
+
+    def run(self, d):
+        r = []
+        i = 0
+        while i < len(d):
+            c = d[i]
+            if c == 0x10:
+                r += [1] + list(IDENT)
+                i += 1
+            elif c in (0x11, 0x12, 0x13):
+                r += [1, {0x11: 0x13, 0x12: 0x30, 0x13: 0x10}[c]]
+                i += 1
+            elif c == 0x14:
+                r += [1] + FEATURES
+                i += 1
+            elif c == 0x15:
+                end = d.index(0, i + 1)
+                r += [1]
+                i = end + 1
+            elif c == 0x20:
+                if i + 3 > len(d):
+                    r.append(2)
+                    break
+                players, nbytes = d[i + 1], d[i + 2]
+                r += [1, self.system]
+                for p in range(players):
+                    for b in range(nbytes):
+                        r.append(self.sw[p][b] if p < 2 and b < 2 else 0)
+                i += 3
+            elif c == 0x21:
+                r.append(1)
+                for s in range(d[i + 1]):
+                    v = self.coins[s] if s < 2 else 0
+                    r += [(v >> 8) & 0x3F, v & 0xFF]
+                i += 2
+            elif c in (0x22, 0x23):
+                r.append(1)
+                vals = self.analog if c == 0x22 else self.rotary
+                pad = 0x8000 if c == 0x22 else 0
+                for ch in range(d[i + 1]):
+                    v = vals[ch] if ch < len(vals) else pad
+                    r += [v >> 8, v & 0xFF]
+                i += 2
+            elif c in (0x30, 0x35):
+                slot, amount = d[i + 1], (d[i + 2] << 8) | d[i + 3]
+                if not 1 <= slot <= 2:
+                    r.append(3)
+                else:
+                    r.append(1)
+                    if c == 0x30:
+                        self.coins[slot - 1] = max(0, self.coins[slot - 1] - amount)
+                    else:
+                        self.coins[slot - 1] = min(COIN_MAX, self.coins[slot - 1] + amount)
+                i += 4
+            elif c == 0x32:
+                r.append(1)
+                i += 2 + d[i + 1]
+            elif c == 0x37:
+                r.append(1 if d[i + 1] < 2 else 3)
+                i += 3
+            else:
+                return 0x02, []
+        return 0x01, r
+
+
+class Capture:
+    def __init__(self, name, comment):
+        self.name = name
+        self.lines = [f"# {name} - generated by gen_traffic.py, do not edit", f"# {comment}"]
+        self.board = Board()
+
+    def hexs(self, bs):
+        return " ".join(f"{b:02x}" for b in bs)
+
+    def send(self, addr, data, note=None):
+        """Mainboard packet, then the reply expected for it."""
+        if note:
+            self.lines.append(f"# {note}")
+        self.lines.append("> " + self.hexs(frame(addr, data)))
+        reply = self.board.packet(addr, data)
+        self.lines.append("< " + (self.hexs(reply) if reply else "none"))
+
+    def expect(self, text):
+        self.lines.append("expect " + text)
+
+    def set_sw(self, player, b0, b1):
+        self.board.sw[player] = [b0, b1]
+        self.lines.append(f"in p{player + 1} {b0:02x} {b1:02x}")
+
+    def set_system(self, v):
+        self.board.system = v
+        self.lines.append(f"in system {v:02x}")
+
+    def set_analog(self, ch, v):
+        self.board.analog[ch] = v
+        self.lines.append(f"in analog {ch} {v:04x}")
+
+    def set_rotary(self, ch, v):
+        self.board.rotary[ch] = v & 0xFFFF
+        self.lines.append(f"in rotary {ch} {v & 0xFFFF:04x}")
+
+    def coin(self, slot, presses=1):
+        self.board.coins[slot - 1] = min(COIN_MAX, self.board.coins[slot - 1] + presses)
+        self.lines.append(f"in coin {slot} {presses}")
+
+    def boot(self, addr=1):
+        self.send(BROADCAST, [0xF0, 0xD9], note="reset, twice as mainboards do")
+        self.send(BROADCAST, [0xF0, 0xD9])
+        self.expect("sense 0")
+        self.send(BROADCAST, [0xF1, addr], note="address assignment")
+        self.expect("sense 1")
+
+    def write(self):
+        with open(os.path.join(OUT, self.name), "w") as f:
+            f.write("\n".join(self.lines) + "\n")
+
+
+# Switches, coins, 8 analog channels and a lamp write: the poll a Naomi
+# sends every frame
+NAOMI_POLL = [0x20, 0x02, 0x02, 0x21, 0x02, 0x22, 0x08, 0x32, 0x01, 0x00]
+
+
+def naomi_boot():
+    c = Capture("naomi_boot.txt", "power-on enumeration, then the first polls")
+    c.expect("sense 0")
+    c.boot()
+    c.send(1, [0x10], note="identification")
+    c.send(1, [0x11])
+    c.send(1, [0x12])
+    c.send(1, [0x13])
+    c.send(1, [0x14], note="feature check")
+    c.send(1, [0x15] + list(b"SEGA ENTERPRISES,LTD.;NAOMI;Ver1.00\x00"), note="main board ID")
+    c.send(1, NAOMI_POLL, note="polling starts")
+    c.expect("slow")
+    for _ in range(3):
+        c.send(1, NAOMI_POLL)
+        c.expect("fast")
+    c.send(BROADCAST, [0xF0, 0xD9], note="mainboard reboots: address released")
+    c.expect("sense 0")
+    c.send(1, NAOMI_POLL, note="not addressed: silent")
+    c.write()
+
+
+def poll_inputs():
+    c = Capture("poll_inputs.txt", "input changes between polls: every reply current, answered ahead of time")
+    c.boot()
+    c.send(1, NAOMI_POLL)
+    c.send(1, NAOMI_POLL)
+    c.expect("fast")
+    c.set_sw(0, 0x80 | 0x20, 0x00)          # P1 start + up
+    c.send(1, NAOMI_POLL)
+    c.expect("fast")
+    c.set_sw(1, 0x02 | 0x01, 0x80 | 0x01)   # P2 push 1, 2, 3, 10
+    c.set_system(0x80)                      # Test
+    c.send(1, NAOMI_POLL)
+    c.expect("fast")
+    c.set_system(0x00)
+    c.set_analog(0, 0x0000)
+    c.set_analog(1, 0xFFFF)
+    # Values that need escaping in the reply
+    c.set_analog(2, 0xE0D0)
+    c.set_analog(7, 0xD0E0)
+    c.send(1, NAOMI_POLL)
+    c.expect("fast")
+    # A different poll takes over as the one precomputed
+    rot = [0x20, 0x01, 0x02, 0x23, 0x02]
+    c.set_rotary(0, 0x0123)
+    c.set_rotary(1, -5)
+    c.send(1, rot, note="trackball game: switches + rotary")
+    c.expect("slow")
+    c.send(1, rot)
+    c.expect("fast")
+    c.set_rotary(0, 0x01E0)
+    c.send(1, rot)
+    c.expect("fast")
+    # A lamp write with an escaped data byte: repeatable, still precomputed
+    lamp = [0x20, 0x02, 0x02, 0x32, 0x01, 0xE0]
+    c.send(1, lamp, note="lamp data 0xE0 arrives escaped")
+    c.expect("slow")
+    c.send(1, [0x37, 0x01, 0x55], note="second lamp byte")
+    c.expect("gpo e0 55")
+    c.send(1, [0x32, 0x02, 0x00, 0x00], note="lamps off, now the cached poll")
+    c.expect("gpo 00 00")
+    c.send(1, lamp, note="back to the lamp poll: built once, then precomputed")
+    c.expect("slow")
+    c.send(1, lamp)
+    c.expect("fast")
+    c.expect("gpo e0 00")
+    c.write()
+
+
+def coins():
+    c = Capture("coins.txt", "coin presses, the mainboard taking and adding credit")
+    c.boot()
+    poll = [0x20, 0x02, 0x02, 0x21, 0x02]
+    c.send(1, poll)
+    c.coin(1)
+    c.coin(1)
+    c.coin(2, 3)
+    c.send(1, poll)
+    c.expect("fast")
+    c.send(1, [0x30, 0x01, 0x00, 0x01], note="game takes a credit")
+    c.expect("slow")
+    c.send(1, poll)
+    c.expect("fast")
+    c.send(1, [0x30, 0x02, 0x00, 0x09], note="takes more than there is: stops at 0")
+    c.send(1, [0x35, 0x01, 0x00, 0x05], note="service credit")
+    c.send(1, [0x30, 0x03, 0x00, 0x01], note="no slot 3")
+    c.send(1, poll)
+    c.send(1, [0x35, 0x02, 0x7F, 0xFF], note="counter saturates at 14 bits")
+    c.coin(2)
+    c.send(1, poll)
+    c.write()
+
+
+def errors():
+    c = Capture("errors.txt", "bad checksums, unknown commands, other boards' traffic, retransmit")
+    c.lines.append("# line noise before the first sync")
+    c.lines.append("> 12 34 d0 56")
+    c.lines.append("< none")
+    c.boot(addr=2)
+    c.send(BROADCAST, [0xF1, 0x03], note="next board's address: we already have one")
+    c.send(1, [0x20, 0x02, 0x02], note="for board 1, not us")
+    good = frame(2, [0x20, 0x02, 0x02])
+    bad = good[:-1] + [(good[-1] + 1) & 0xFF]
+    c.lines.append("# corrupted checksum")
+    c.lines.append("> " + c.hexs(bad))
+    c.lines.append("< " + c.hexs(frame(0, [0x03])))
+    c.board.last = frame(0, [0x03])
+    c.send(2, [0x20, 0x02, 0x02])
+    c.send(2, [0x2F], note="retransmit: the last reply again")
+    c.send(2, [0x11, 0x26, 0x01], note="command this board doesn't have")
+    c.send(2, [0x2F])
+    # SWINP with its arguments cut off by the length byte
+    c.lines.append("# switch read cut short")
+    c.lines.append("> " + c.hexs(frame(2, [0x13, 0x20, 0x02])))
+    c.lines.append("< " + c.hexs(frame(0, [0x01, 0x01, 0x10, 0x02])))
+    c.board.last = frame(0, [0x01, 0x01, 0x10, 0x02])
+    c.send(2, [0x37, 0x05, 0x01], note="output byte out of range")
+    c.send(2, [0x20, 0x03, 0x03], note="more players and bytes than we have: zeros")
+    # A sync in the middle of a packet restarts reception
+    half = frame(2, [0x20, 0x02, 0x02])[:4]
+    c.lines.append("# packet cut off by a new sync")
+    c.lines.append("> " + c.hexs(half + frame(2, [0x12])))
+    c.lines.append("< " + c.hexs(frame(0, [0x01, 0x01, 0x30])))
+    c.write()
+
+
+if __name__ == "__main__":
+    os.makedirs(OUT, exist_ok=True)
+    naomi_boot()
+    poll_inputs()
+    coins()
+    errors()
@@ -0,0 +1,742 @@
+// accum.c - replays mouse streams through KB/Mouse mode on a simulated host
+//
+// Builds kbmouse.c and kbmouse_mode.c from src/ against stub/tusb.h and runs
+// them on a virtual clock. Each trace in streams/ is fed to the mode the way
+// usbd feeds it: on_input for every event, then the usbd_send_kbmouse_report()
+// path once per main-loop pass. The host takes at most one report per
+// endpoint per poll, optionally missing polls (-n) or refusing reports (-f).
+//
+// Checks, per trace:
+//   - the host receives exactly the motion and wheel the trace contains;
+//   - once input has been quiet for two polls (plus any the report range
+//     needs to drain the backlog), nothing is still pending;
+//   - every button press reaches the host, even one shorter than a poll;
+//   - no report repeats the previous one with zero motion;
+//   - a plain mouse never produces keyboard reports.
+// Built-in gamepad checks: stick pointer speed per second whatever the poll
+// rate, a key tap shorter than a poll, the NKRO report layout, and the 6KRO
+// report a host gets after selecting boot protocol.
+//
+// Usage: kbmouse-accum [-v] [-p poll_us] [-l loop_us] [-n miss_every]
+//                      [-f fail_every] trace...
+//        kbmouse-accum -R /dev/input/eventN > streams/name.trace
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/input.h>
+
+#include "usbd_mode.h"
+#include "kbmouse/kbmouse.h"
+#include "descriptors/kbmouse_descriptors.h"
+#include "descriptors/sinput_descriptors.h"
+#include "core/buttons.h"
+
+#define MAX_EVENTS      200000
+#define MAX_PRESSES     4096
+#define MOUSE_BUTTONS   3
+
+static bool verbose;
+static int failures;
+
+static uint32_t poll_us = 1000;         // Host interrupt polling interval
+static uint32_t loop_us = 250;          // Firmware main-loop pass
+static uint32_t miss_every;             // Host skips every Nth poll
+static uint32_t fail_every;             // Every Nth tud_hid_n_report() fails
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+// ============================================================================
+// PLATFORM
+// ============================================================================
+
+static uint32_t now_us;
+
+uint32_t platform_time_us(void)
+{
+    return now_us;
+}
+
+// ============================================================================
+// SIMULATED HOST
+// ============================================================================
+
+typedef struct {
+    bool     busy;                      // Report queued, waiting for a poll
+    uint8_t  report_id;
+    uint16_t len;
+    uint8_t  data[64];
+} endpoint_t;
+
+static endpoint_t endpoints[3];         // Indexed by ITF_NUM_HID_*
+static uint32_t report_calls;
+static uint32_t poll_count;
+static uint32_t last_hiccup_us;         // Last missed poll or refused report
+static bool hiccup_seen;
+
+static uint8_t kb_protocol = HID_PROTOCOL_REPORT;   // Set by the host
+
+uint8_t tud_hid_n_get_protocol(uint8_t instance)
+{
+    return instance == ITF_NUM_HID_KEYBOARD ? kb_protocol : HID_PROTOCOL_REPORT;
+}
+
+bool tud_hid_n_ready(uint8_t instance)
+{
+    return instance < 3 && !endpoints[instance].busy;
+}
+
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const* report, uint16_t len)
+{
+    if (instance >= 3 || endpoints[instance].busy || len > sizeof(endpoints[0].data)) return false;
+    if (fail_every && ++report_calls % fail_every == 0) {
+        last_hiccup_us = now_us;
+        hiccup_seen = true;
+        return false;
+    }
+    endpoint_t* ep = &endpoints[instance];
+    ep->busy = true;
+    ep->report_id = report_id;
+    ep->len = len;
+    memcpy(ep->data, report, len);
+    return true;
+}
+
+// What the host has received
+typedef struct {
+    int64_t  x, y, wheel, pan;
+    uint32_t mouse_reports;
+    uint32_t kb_reports;
+    uint8_t  buttons;
+    bool     have_mouse;
+    kbmouse_mouse_report_t last_mouse;
+    kbmouse_nkro_report_t  kb;
+    kbmouse_keyboard_report_t boot;     // Last keyboard report in boot protocol
+    // Times each mouse button was seen held, for the press checks
+    uint32_t held_us[MOUSE_BUTTONS][MAX_PRESSES];
+    uint32_t held_count[MOUSE_BUTTONS];
+} host_t;
+
+static host_t host;
+
+static void host_take_mouse(const endpoint_t* ep)
+{
+    if (ep->report_id != 0 || ep->len != sizeof(kbmouse_mouse_report_t)) {
+        fail("mouse report id %u len %u, want id 0 len %zu",
+             ep->report_id, ep->len, sizeof(kbmouse_mouse_report_t));
+        return;
+    }
+    kbmouse_mouse_report_t r;
+    memcpy(&r, ep->data, sizeof(r));
+    if (host.have_mouse && r.x == 0 && r.y == 0 && r.wheel == 0 && r.pan == 0 &&
+        r.buttons == host.last_mouse.buttons) {
+        fail("t=%u us: mouse report repeats the previous one with no motion", now_us);
+    }
+    host.x += r.x;
+    host.y += r.y;
+    host.wheel += r.wheel;
+    host.pan += r.pan;
+    host.buttons = r.buttons;
+    host.last_mouse = r;
+    host.have_mouse = true;
+    host.mouse_reports++;
+    for (int b = 0; b < MOUSE_BUTTONS; b++) {
+        if ((r.buttons & (1u << b)) && host.held_count[b] < MAX_PRESSES) {
+            host.held_us[b][host.held_count[b]++] = now_us;
+        }
+    }
+    if (verbose) {
+        printf("    %8u us  mouse btn %02X x %6d y %6d wheel %4d\n",
+               now_us, r.buttons, r.x, r.y, r.wheel);
+    }
+}
+
+static void host_take_keyboard(const endpoint_t* ep)
+{
+    if (kb_protocol == HID_PROTOCOL_BOOT) {
+        if (ep->report_id != 0 || ep->len != sizeof(kbmouse_keyboard_report_t)) {
+            fail("boot keyboard report id %u len %u, want id 0 len %zu",
+                 ep->report_id, ep->len, sizeof(kbmouse_keyboard_report_t));
+            return;
+        }
+        memcpy(&host.boot, ep->data, sizeof(host.boot));
+        host.kb_reports++;
+        return;
+    }
+    if (ep->report_id != 0 || ep->len != sizeof(kbmouse_nkro_report_t)) {
+        fail("keyboard report id %u len %u, want id 0 len %zu (NKRO, no report ID)",
+             ep->report_id, ep->len, sizeof(kbmouse_nkro_report_t));
+        return;
+    }
+    memcpy(&host.kb, ep->data, sizeof(host.kb));
+    host.kb_reports++;
+    if (verbose) printf("    %8u us  keyboard mod %02X\n", now_us, host.kb.modifier);
+}
+
+static void host_poll(void)
+{
+    poll_count++;
+    if (miss_every && poll_count % miss_every == 0) {
+        last_hiccup_us = now_us;
+        hiccup_seen = true;
+        return;
+    }
+    if (endpoints[ITF_NUM_HID_KEYBOARD].busy) {
+        host_take_keyboard(&endpoints[ITF_NUM_HID_KEYBOARD]);
+        endpoints[ITF_NUM_HID_KEYBOARD].busy = false;
+    }
+    if (endpoints[ITF_NUM_HID_MOUSE].busy) {
+        host_take_mouse(&endpoints[ITF_NUM_HID_MOUSE]);
+        endpoints[ITF_NUM_HID_MOUSE].busy = false;
+    }
+}
+
+// ============================================================================
+// FIRMWARE SIDE (mirrors usbd_on_input / usbd_send_kbmouse_report)
+// ============================================================================
+
+static input_event_t pending_event;
+static bool pending_flag;
+
+static void fw_reset(void)
+{
+    memset(endpoints, 0, sizeof(endpoints));
+    memset(&host, 0, sizeof(host));
+    report_calls = 0;
+    poll_count = 0;
+    hiccup_seen = false;
+    pending_flag = false;
+    kb_protocol = HID_PROTOCOL_REPORT;
+    now_us = 0;
+    kbmouse_mode.init();
+}
+
+static void fw_input(const input_event_t* ev)
+{
+    kbmouse_mode.on_input(0, ev);
+    pending_event = *ev;
+    pending_flag = true;
+}
+
+// Identity profile: buttons pass through, sticks from the event
+static uint32_t fw_profile(const input_event_t* ev, profile_output_t* out)
+{
+    memset(out, 0, sizeof(*out));
+    out->left_x = ev->analog[ANALOG_LX];
+    out->left_y = ev->analog[ANALOG_LY];
+    out->right_x = ev->analog[ANALOG_RX];
+    out->right_y = ev->analog[ANALOG_RY];
+    return ev->buttons;
+}
+
+static void fw_loop(void)
+{
+    if (kbmouse_mode.is_ready && !kbmouse_mode.is_ready()) return;
+
+    if ((!pending_flag && !kbmouse_mode_has_latched_buttons()) ||
+        kbmouse_mode_frame_unsent()) {
+        kbmouse_mode_send_idle_mouse();
+        return;
+    }
+
+    input_event_t event = pending_event;
+    pending_flag = false;
+    event.buttons = kbmouse_mode_merge_buttons(event.buttons);
+
+    profile_output_t profile_out;
+    uint32_t buttons = fw_profile(&event, &profile_out);
+    kbmouse_mode.send_report(0, &event, &profile_out, buttons);
+}
+
+// Advance the virtual clock to t, running loop passes and host polls
+static void run_until(uint32_t t)
+{
+    while (now_us < t) {
+        uint32_t next_loop = (now_us / loop_us + 1) * loop_us;
+        uint32_t next_poll = (now_us / poll_us + 1) * poll_us;
+        uint32_t next = next_loop < next_poll ? next_loop : next_poll;
+        if (next > t) {
+            now_us = t;
+            break;
+        }
+        now_us = next;
+        if (now_us == next_poll) host_poll();
+        if (now_us == next_loop) fw_loop();
+    }
+}
+
+static void neutral_event(input_event_t* ev, input_device_type_t type)
+{
+    memset(ev, 0, sizeof(*ev));
+    ev->type = type;
+    for (int i = 0; i < 4; i++) ev->analog[i] = 128;
+}
+
+// ============================================================================
+// TRACES
+// ============================================================================
+
+// One line per input report: t_us dx dy wheel buttons (bit 0 left, 1 right,
+// 2 middle). '#' starts a comment.
+typedef struct {
+    uint32_t t_us;
+    int16_t  dx, dy;
+    int8_t   wheel;
+    uint8_t  buttons;
+} trace_event_t;
+
+static trace_event_t trace[MAX_EVENTS];
+
+static int load_trace(const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fail("%s: %s", path, strerror(errno));
+        return -1;
+    }
+    char line[256];
+    int n = 0, lineno = 0;
+    uint32_t prev_t = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\0') continue;
+        unsigned t, b;
+        int dx, dy, w;
+        if (sscanf(p, "%u %d %d %d %x", &t, &dx, &dy, &w, &b) != 5 ||
+            dx < -32767 || dx > 32767 || dy < -32767 || dy > 32767 ||
+            w < -127 || w > 127 || t < prev_t || n == MAX_EVENTS) {
+            fail("%s:%d: bad line", path, lineno);
+            fclose(f);
+            return -1;
+        }
+        trace[n++] = (trace_event_t){ t, (int16_t)dx, (int16_t)dy, (int8_t)w, (uint8_t)b };
+        prev_t = t;
+    }
+    fclose(f);
+    return n;
+}
+
+static const uint32_t mouse_button_map[MOUSE_BUTTONS] = {
+    JP_BUTTON_B1, JP_BUTTON_B2, JP_BUTTON_B3,
+};
+
+// Was button b seen held by the host between from and to?
+static bool host_held_between(int b, uint32_t from, uint32_t to)
+{
+    for (uint32_t i = 0; i < host.held_count[b]; i++) {
+        if (host.held_us[b][i] >= from && host.held_us[b][i] <= to) return true;
+    }
+    return false;
+}
+
+static void replay(const char* path)
+{
+    int n = load_trace(path);
+    if (n <= 0) return;
+    int failures_before = failures;
+    fw_reset();
+
+    int64_t want_x = 0, want_y = 0, want_wheel = 0;
+    uint32_t last_input_us = 0;
+    uint32_t max_lag_us = 0;
+    bool backlog = false;
+    uint32_t presses = 0, late_presses = 0;
+    uint32_t drain_polls = 0;
+
+    // How long a press may take to show: two polls and a loop pass, plus a
+    // poll per missed poll or refused report along the way
+    uint32_t grace = 2 * poll_us + loop_us + ((miss_every || fail_every) ? 2 * poll_us : 0);
+
+    uint8_t prev_buttons = 0;
+
+    for (int i = 0; i < n; i++) {
+        // Between events: check at every poll that quiet input means nothing
+        // is pending on the device
+        while (now_us < trace[i].t_us) {
+            uint32_t next_poll = (now_us / poll_us + 1) * poll_us;
+            run_until(next_poll < trace[i].t_us ? next_poll : trace[i].t_us);
+            if (now_us % poll_us != 0) continue;
+
+            // Settle time: from the last input to nothing pending
+            bool pending = host.x != want_x || host.y != want_y || host.wheel != want_wheel;
+            if (!pending && backlog) {
+                backlog = false;
+                if (now_us - last_input_us > max_lag_us) max_lag_us = now_us - last_input_us;
+            }
+            uint32_t quiet_from = last_input_us;
+            if (hiccup_seen && last_hiccup_us > quiet_from) quiet_from = last_hiccup_us;
+            if (pending && now_us - quiet_from >= (2 + drain_polls) * poll_us + loop_us) {
+                fail("%s: t=%u us: motion still pending %u us after the last input "
+                     "(x %+lld y %+lld wheel %+lld)", path, now_us, now_us - quiet_from,
+                     (long long)(want_x - host.x), (long long)(want_y - host.y),
+                     (long long)(want_wheel - host.wheel));
+                want_x = host.x;            // Report once per stall
+                want_y = host.y;
+                want_wheel = host.wheel;
+            }
+        }
+
+        const trace_event_t* te = &trace[i];
+        input_event_t ev;
+        neutral_event(&ev, INPUT_TYPE_MOUSE);
+        ev.delta_x = te->dx;
+        ev.delta_y = te->dy;
+        ev.delta_wheel = te->wheel;
+        for (int b = 0; b < MOUSE_BUTTONS; b++) {
+            if (te->buttons & (1u << b)) ev.buttons |= mouse_button_map[b];
+        }
+        fw_input(&ev);
+        want_x += te->dx;
+        want_y += te->dy;
+        want_wheel += te->wheel;
+        last_input_us = now_us;
+        backlog = true;
+
+        // Polls the backlog needs at the report range (the wheel is int8)
+        int64_t bx = llabs(want_x - host.x), by = llabs(want_y - host.y);
+        int64_t bw = llabs(want_wheel - host.wheel);
+        int64_t need = (bx > by ? bx : by) / 32767;
+        if (bw / 127 > need) need = bw / 127;
+        drain_polls = (uint32_t)need;
+
+        for (int b = 0; b < MOUSE_BUTTONS; b++) {
+            uint8_t bit = (uint8_t)(1u << b);
+            if (!(te->buttons & bit) && (prev_buttons & bit)) presses++;
+        }
+        prev_buttons = te->buttons;
+    }
+
+    // Drain: let everything pending go out
+    run_until(now_us + 20 * poll_us + 100000);
+
+    if (host.x != want_x || host.y != want_y || host.wheel != want_wheel) {
+        fail("%s: host total x %lld y %lld wheel %lld, trace x %lld y %lld wheel %lld",
+             path, (long long)host.x, (long long)host.y, (long long)host.wheel,
+             (long long)want_x, (long long)want_y, (long long)want_wheel);
+    }
+    if (host.pan != 0) fail("%s: pan %lld from a mouse without a pan axis", path, (long long)host.pan);
+    if (host.buttons != prev_buttons) {
+        fail("%s: host ends with buttons %02X, trace %02X", path, host.buttons, prev_buttons);
+    }
+    if (host.kb_reports != 0) {
+        fail("%s: %u keyboard reports from a plain mouse", path, host.kb_reports);
+    }
+
+    // Every press must have been seen held by the host between its start
+    // and the grace period after its release
+    uint32_t press_start[MOUSE_BUTTONS] = {0};
+    uint8_t held = 0;
+    for (int i = 0; i < n; i++) {
+        for (int b = 0; b < MOUSE_BUTTONS; b++) {
+            uint8_t bit = (uint8_t)(1u << b);
+            if ((trace[i].buttons & bit) && !(held & bit)) press_start[b] = trace[i].t_us;
+            if (!(trace[i].buttons & bit) && (held & bit)) {
+                uint32_t to = trace[i].t_us + grace;
+                if (!host_held_between(b, press_start[b], to)) {
+                    late_presses++;
+                    if (late_presses <= 5) {
+                        fail("%s: button %d press at %u us (released %u us) never reached the host",
+                             path, b, press_start[b], trace[i].t_us);
+                    }
+                }
+            }
+        }
+        held = trace[i].buttons;
+    }
+    if (late_presses > 5) fail("%s: %u more presses lost", path, late_presses - 5);
+
+    const char* name = strrchr(path, '/');
+    printf("  %-24s %6d events %6u reports  %3u presses  settle %4.1f ms  %s\n",
+           name ? name + 1 : path, n, host.mouse_reports, presses, max_lag_us / 1000.0,
+           failures == failures_before ? "ok" : "FAILED");
+}
+
+// ============================================================================
+// GAMEPAD CHECKS
+// ============================================================================
+
+// Full right stick for one second: 1875 px at default sensitivity, whatever
+// the poll rate, and nothing on Y
+static void check_stick(void)
+{
+    fw_reset();
+    input_event_t ev;
+    neutral_event(&ev, INPUT_TYPE_GAMEPAD);
+    fw_input(&ev);
+    run_until(10000);
+
+    int64_t x0 = host.x;
+    ev.analog[ANALOG_RX] = 255;
+    fw_input(&ev);
+    run_until(now_us + 1000000);
+    ev.analog[ANALOG_RX] = 128;
+    fw_input(&ev);
+    run_until(now_us + 100000);
+
+    int64_t moved = host.x - x0;
+    if (moved < 1875 * 98 / 100 || moved > 1875 * 102 / 100 || host.y != 0) {
+        fail("stick: full deflection for 1 s moved x %lld y %lld, want 1875 +-2%% and 0",
+             (long long)moved, (long long)host.y);
+    } else {
+        printf("  %-24s moved %lld px in 1 s  ok\n", "stick (gamepad)", (long long)moved);
+    }
+}
+
+// A face button tapped for less than a poll still presses its key once, and
+// keyboard reports use the NKRO layout with no report ID
+static void check_key_tap(void)
+{
+    fw_reset();
+    input_event_t ev;
+    neutral_event(&ev, INPUT_TYPE_GAMEPAD);
+    fw_input(&ev);
+    run_until(10000);
+
+    uint32_t reports = host.kb_reports;
+    ev.buttons = JP_BUTTON_B1;              // Space in the default map
+    fw_input(&ev);
+    run_until(now_us + loop_us / 2 + 1);    // Released before the next poll
+    ev.buttons = 0;
+    fw_input(&ev);
+
+    bool seen = false;
+    uint32_t deadline = now_us + 3 * poll_us + loop_us;
+    while (now_us < deadline) {
+        run_until(now_us + loop_us);
+        if (host.kb.bitmap[HID_KEY_SPACE >> 3] & (1u << (HID_KEY_SPACE & 7))) seen = true;
+    }
+    run_until(now_us + 5 * poll_us);
+
+    bool released = !(host.kb.bitmap[HID_KEY_SPACE >> 3] & (1u << (HID_KEY_SPACE & 7)));
+    if (!seen || !released || host.kb_reports - reports != 2) {
+        fail("key tap: seen %d, released %d, %u keyboard reports (want 2)",
+             seen, released, host.kb_reports - reports);
+    } else {
+        printf("  %-24s pressed and released  ok\n", "key tap (gamepad)");
+    }
+}
+
+static bool boot_has(uint8_t usage)
+{
+    return memchr(host.boot.keycode, usage, sizeof(host.boot.keycode)) != NULL;
+}
+
+// A host in boot protocol gets the 8-byte 6KRO report: the held keys,
+// ErrorRollOver past six, nothing after the release. Switching back to
+// report protocol sends the held keys again as NKRO.
+static void check_boot_protocol(void)
+{
+    int before = failures;
+    fw_reset();
+    input_event_t ev;
+    neutral_event(&ev, INPUT_TYPE_GAMEPAD);
+    fw_input(&ev);
+    run_until(10000);
+
+    kb_protocol = HID_PROTOCOL_BOOT;        // SET_PROTOCOL(Boot)
+    ev.buttons = JP_BUTTON_B1 | JP_BUTTON_B2 | JP_BUTTON_B3;
+    fw_input(&ev);
+    run_until(now_us + 5 * poll_us);
+    if (!boot_has(HID_KEY_SPACE) || !boot_has(HID_KEY_E) || !boot_has(HID_KEY_R) ||
+        host.boot.keycode[3] != 0) {
+        fail("boot protocol: three held keys not reported as Space, E, R");
+    }
+
+    ev.buttons |= JP_BUTTON_B4 | JP_BUTTON_S1 | JP_BUTTON_S2 | JP_BUTTON_L3;
+    fw_input(&ev);
+    run_until(now_us + 5 * poll_us);
+    for (int i = 0; i < 6; i++) {
+        if (host.boot.keycode[i] != 0x01) {
+            fail("boot protocol: seven held keys not reported as ErrorRollOver");
+            break;
+        }
+    }
+
+    ev.buttons = JP_BUTTON_B1;
+    fw_input(&ev);
+    run_until(now_us + 5 * poll_us);
+    if (!boot_has(HID_KEY_SPACE) || host.boot.keycode[1] != 0) {
+        fail("boot protocol: back to one key, host still sees others");
+    }
+
+    kb_protocol = HID_PROTOCOL_REPORT;      // SET_PROTOCOL(Report), Space still held
+    memset(&host.kb, 0, sizeof(host.kb));
+    run_until(now_us + 5 * poll_us);
+    if (!(host.kb.bitmap[HID_KEY_SPACE >> 3] & (1u << (HID_KEY_SPACE & 7)))) {
+        fail("report protocol: held key not sent again after the switch back");
+    }
+    if (failures == before) printf("  %-24s 6KRO, rollover, switch back  ok\n", "boot protocol (gamepad)");
+}
+
+// ============================================================================
+// DESCRIPTORS
+// ============================================================================
+
+typedef struct {
+    uint32_t input_bits;
+    uint32_t output_bits;
+    uint8_t  report_ids[8];
+    int      id_count;
+} hid_summary_t;
+
+// Walk the short items of a report descriptor: Input/Output sizes and IDs
+static hid_summary_t hid_walk(const uint8_t* d, size_t len)
+{
+    hid_summary_t s = {0};
+    uint32_t size = 0, count = 0;
+    for (size_t i = 0; i < len;) {
+        uint8_t prefix = d[i];
+        uint8_t n = prefix & 3;
+        if (n == 3) n = 4;
+        uint32_t v = 0;
+        for (uint8_t k = 0; k < n && i + 1 + k < len; k++) v |= (uint32_t)d[i + 1 + k] << (8 * k);
+        switch (prefix & 0xFC) {
+            case 0x74: size = v; break;                 // Report Size
+            case 0x94: count = v; break;                // Report Count
+            case 0x80: s.input_bits += size * count; break;
+            case 0x90: s.output_bits += size * count; break;
+            case 0x84:                                  // Report ID
+                if (s.id_count < 8) s.report_ids[s.id_count++] = (uint8_t)v;
+                break;
+        }
+        i += 1 + n;
+    }
+    return s;
+}
+
+static void check_descriptors(void)
+{
+    int before = failures;
+    hid_summary_t kb = hid_walk(kbmouse_keyboard_report_descriptor,
+                                sizeof(kbmouse_keyboard_report_descriptor));
+    if (kb.id_count != 0) fail("KB/Mouse keyboard descriptor declares report IDs");
+    if (kb.input_bits != 8 * sizeof(kbmouse_nkro_report_t)) {
+        fail("KB/Mouse keyboard input is %u bits, kbmouse_nkro_report_t is %zu bytes",
+             kb.input_bits, sizeof(kbmouse_nkro_report_t));
+    }
+    if (kb.input_bits > 16 * 8) fail("KB/Mouse keyboard report exceeds the 16-byte endpoint");
+    if (kb.output_bits != 8) fail("KB/Mouse keyboard LED output is %u bits, want 8", kb.output_bits);
+
+    hid_summary_t si = hid_walk(sinput_keyboard_report_descriptor,
+                                sizeof(sinput_keyboard_report_descriptor));
+    if (si.id_count != 2 || si.report_ids[0] != SINPUT_KB_REPORT_ID_KEYBOARD ||
+        si.report_ids[1] != SINPUT_KB_REPORT_ID_CONSUMER) {
+        fail("SInput keyboard descriptor should carry only its keyboard and consumer reports");
+    }
+
+    hid_summary_t mouse = hid_walk(sinput_mouse_report_descriptor,
+                                   sizeof(sinput_mouse_report_descriptor));
+    if (mouse.id_count != 0 || mouse.input_bits != 8 * sizeof(kbmouse_mouse_report_t)) {
+        fail("SInput mouse input is %u bits, kbmouse_mouse_report_t is %zu bytes",
+             mouse.input_bits, sizeof(kbmouse_mouse_report_t));
+    }
+    if (failures == before) printf("  %-24s ok\n", "descriptors");
+}
+
+// ============================================================================
+// RECORDER
+// ============================================================================
+
+static volatile sig_atomic_t stop_recording;
+
+static void on_sigint(int sig)
+{
+    (void)sig;
+    stop_recording = 1;
+}
+
+// Write one trace line per SYN_REPORT from an evdev mouse, until Ctrl-C
+static int record(const char* dev)
+{
+    int fd = open(dev, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", dev, strerror(errno));
+        return 1;
+    }
+    signal(SIGINT, on_sigint);
+    printf("# recorded from %s\n# t_us dx dy wheel buttons\n", dev);
+
+    struct input_event ie;
+    int dx = 0, dy = 0, wheel = 0;
+    unsigned buttons = 0;
+    bool dirty = false, have_t0 = false;
+    uint64_t t0 = 0;
+    while (!stop_recording && read(fd, &ie, sizeof(ie)) == (ssize_t)sizeof(ie)) {
+        uint64_t t = (uint64_t)ie.input_event_sec * 1000000u + (uint64_t)ie.input_event_usec;
+        if (ie.type == EV_REL) {
+            if (ie.code == REL_X) dx += ie.value;
+            if (ie.code == REL_Y) dy += ie.value;
+            if (ie.code == REL_WHEEL) wheel += ie.value;
+            dirty = true;
+        } else if (ie.type == EV_KEY && ie.code >= BTN_LEFT && ie.code <= BTN_MIDDLE) {
+            unsigned bit = 1u << (ie.code - BTN_LEFT);
+            buttons = ie.value ? (buttons | bit) : (buttons & ~bit);
+            dirty = true;
+        } else if (ie.type == EV_SYN && ie.code == SYN_REPORT && dirty) {
+            if (!have_t0) {
+                t0 = t;
+                have_t0 = true;
+            }
+            printf("%llu %d %d %d %X\n", (unsigned long long)(t - t0), dx, dy, wheel, buttons);
+            dx = dy = wheel = 0;
+            dirty = false;
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "vp:l:n:f:R:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 'p': poll_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l': loop_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': miss_every = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'f': fail_every = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'R': return record(optarg);
+            default:
+                fprintf(stderr, "usage: %s [-v] [-p poll_us] [-l loop_us] [-n miss_every] "
+                        "[-f fail_every] trace...\n       %s -R /dev/input/eventN\n",
+                        argv[0], argv[0]);
+                return 2;
+        }
+    }
+    if (poll_us == 0 || loop_us == 0) {
+        fprintf(stderr, "poll and loop intervals must be non-zero\n");
+        return 2;
+    }
+
+    printf("poll %u us, loop %u us, miss every %u, fail every %u\n",
+           poll_us, loop_us, miss_every, fail_every);
+    check_descriptors();
+    for (int i = optind; i < argc; i++) replay(argv[i]);
+    check_stick();
+    check_key_tap();
+    check_boot_protocol();
+
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
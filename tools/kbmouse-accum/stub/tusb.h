@@ -0,0 +1,134 @@
+// tusb.h - minimal TinyUSB surface for building kbmouse.c and kbmouse_mode.c
+// on the host. Only what those files, usbd_mode.h and the SInput/KB-Mouse
+// descriptor headers touch.
+
+#ifndef KBMOUSE_ACCUM_TUSB_H
+#define KBMOUSE_ACCUM_TUSB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define TU_ATTR_PACKED        __attribute__((packed))
+#define TU_BIT(n)             (1UL << (n))
+#define U16_TO_U8S_LE(u16)    (uint8_t)((u16) & 0xFF), (uint8_t)(((u16) >> 8) & 0xFF)
+
+#define CFG_TUD_ENDPOINT0_SIZE  64
+#define CFG_TUD_HID_EP_BUFSIZE  64
+
+typedef enum {
+    TUSB_DESC_DEVICE        = 0x01,
+    TUSB_DESC_CONFIGURATION = 0x02,
+    TUSB_DESC_INTERFACE     = 0x04,
+    TUSB_DESC_ENDPOINT      = 0x05,
+} tusb_desc_type_t;
+
+typedef enum {
+    TUSB_XFER_INTERRUPT = 3,
+} tusb_xfer_type_t;
+
+#define TUSB_CLASS_HID   0x03
+#define TUSB_CLASS_MISC  0xEF
+
+#define TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP  TU_BIT(5)
+
+typedef enum {
+    HID_DESC_TYPE_HID    = 0x21,
+    HID_DESC_TYPE_REPORT = 0x22,
+} hid_descriptor_type_t;
+
+typedef enum {
+    HID_REPORT_TYPE_INVALID = 0,
+    HID_REPORT_TYPE_INPUT,
+    HID_REPORT_TYPE_OUTPUT,
+    HID_REPORT_TYPE_FEATURE,
+} hid_report_type_t;
+
+#define HID_SUBCLASS_BOOT        1
+#define HID_ITF_PROTOCOL_NONE    0
+#define HID_ITF_PROTOCOL_KEYBOARD 1
+
+#define HID_PROTOCOL_BOOT        0
+#define HID_PROTOCOL_REPORT      1
+
+// Keys the default KB/Mouse map uses
+#define HID_KEY_A       0x04
+#define HID_KEY_D       0x07
+#define HID_KEY_E       0x08
+#define HID_KEY_F       0x09
+#define HID_KEY_M       0x10
+#define HID_KEY_Q       0x14
+#define HID_KEY_R       0x15
+#define HID_KEY_S       0x16
+#define HID_KEY_V       0x19
+#define HID_KEY_W       0x1A
+#define HID_KEY_1       0x1E
+#define HID_KEY_2       0x1F
+#define HID_KEY_3       0x20
+#define HID_KEY_4       0x21
+#define HID_KEY_ESCAPE  0x29
+#define HID_KEY_TAB     0x2B
+#define HID_KEY_SPACE   0x2C
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t  iManufacturer;
+    uint8_t  iProduct;
+    uint8_t  iSerialNumber;
+    uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bmRequestType;
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+typedef enum {
+    XFER_RESULT_SUCCESS = 0,
+    XFER_RESULT_FAILED,
+} xfer_result_t;
+
+#define TUD_CONFIG_DESC_LEN     9
+#define TUD_HID_DESC_LEN        (9 + 9 + 7)
+
+#define TUD_CONFIG_DESCRIPTOR(config_num, _itfcount, _stridx, _total_len, _attribute, _power_ma) \
+    9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(_total_len), _itfcount, config_num, _stridx, \
+    TU_BIT(7) | _attribute, (_power_ma) / 2
+
+#define TUD_HID_DESCRIPTOR(_itfnum, _stridx, _boot_protocol, _report_desc_len, _epin, _epsize, _ep_interval) \
+    9, TUSB_DESC_INTERFACE, _itfnum, 0, 1, TUSB_CLASS_HID, \
+    (uint8_t)((_boot_protocol) ? (uint8_t)HID_SUBCLASS_BOOT : 0), _boot_protocol, _stridx, \
+    9, HID_DESC_TYPE_HID, U16_TO_U8S_LE(0x0111), 0, 1, HID_DESC_TYPE_REPORT, U16_TO_U8S_LE(_report_desc_len), \
+    7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(_epsize), _ep_interval
+
+// IN endpoints and SET_PROTOCOL state, implemented by accum.c against its
+// simulated host
+bool tud_hid_n_ready(uint8_t instance);
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const* report, uint16_t len);
+uint8_t tud_hid_n_get_protocol(uint8_t instance);
+
+#endif // KBMOUSE_ACCUM_TUSB_H
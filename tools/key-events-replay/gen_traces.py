@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+"""Generate the synthetic keyboard traces in traces/.
+
+Each trace is HID boot keyboard reports the way hid_keyboard.c hands them
+to the router: microseconds since the previous report, the modifier byte
+and six key slots, in hex. After each report that changes something comes
+an `e` line with the transitions it makes, worked out here from the
+reports alone: key releases (sorted by usage, their order isn't part of
+the contract), modifier releases, modifier presses, then key presses in
+report order.
+
+Deterministic: running it again rewrites identical files.
+"""
+
+import os
+
+OUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "traces")
+
+LCTRL, LSHIFT, LALT, LGUI = 0x01, 0x02, 0x04, 0x08
+RCTRL, RSHIFT, RALT = 0x10, 0x20, 0x40
+
+# Letters, digits, punctuation, Space, Return, Backspace
+TYPING = list(range(0x04, 0x1E)) + list(range(0x1E, 0x28)) + [0x2C, 0x28, 0x2A, 0x36, 0x37]
+# Arrows, Insert/Home/PgUp/Delete/End/PgDn, keypad / and Enter, F-keys
+EXTENDED = [0x4F, 0x50, 0x51, 0x52, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x54, 0x58]
+FKEYS = list(range(0x3A, 0x46))
+PRINT_SCREEN, PAUSE, CAPS_LOCK = 0x46, 0x48, 0x39
+
+
+class Lcg:
+    def __init__(self, seed):
+        self.s = seed
+
+    def next(self, lo, hi):
+        self.s = (self.s * 1103515245 + 12345) & 0xFFFFFFFF
+        return lo + (self.s >> 8) % (hi - lo + 1)
+
+    def pick(self, items):
+        return items[self.next(0, len(items) - 1)]
+
+
+class Trace:
+    def __init__(self):
+        self.lines = []
+        self.mod = 0
+        self.keys = []
+        self.transitions = 0
+
+    def report(self, dt, mod, keys):
+        keys = list(keys)[:6]
+        slots = keys + [0] * (6 - len(keys))
+        self.lines.append(f"r {dt} {mod:02X} " + " ".join(f"{k:02X}" for k in slots))
+        if all(k == 0x01 for k in slots):
+            return      # ErrorRollOver: the keyboard's state is unknown, keep the last
+
+        held = []
+        for k in slots:
+            if k >= 0x04 and k not in held:
+                held.append(k)
+
+        ev = [f"-{k:02X}" for k in sorted(self.keys) if k not in held]
+        ev += [f"-{0xE0 + b:02X}" for b in range(8) if self.mod & ~mod & (1 << b)]
+        ev += [f"+{0xE0 + b:02X}" for b in range(8) if mod & ~self.mod & (1 << b)]
+        ev += [f"+{k:02X}" for k in held if k not in self.keys]
+        if ev:
+            self.lines.append("e " + " ".join(ev))
+        self.transitions += len(ev)
+        self.mod, self.keys = mod, held
+
+    def write(self, name, comment):
+        head = [f"# {name} - generated by gen_traces.py, do not edit"]
+        head += [f"# {c}" for c in comment]
+        head.append(f"# {self.transitions} transitions")
+        with open(os.path.join(OUT, name), "w") as f:
+            f.write("\n".join(head + self.lines) + "\n")
+
+
+def type_text(t, rng, keys, count, hold, gap, overlap, mod_every=0):
+    """Type `count` keys: each held `hold` us, the next one starting `gap`
+    us after it, with up to `overlap` keys still down (rollover)"""
+    down = []           # (key, release_at)
+    now = 0
+    last = 0
+    start = 0
+    typed = 0
+    mod = 0
+    while typed < count or down:
+        # Next thing to happen: a press or the earliest release
+        nxt_press = start if typed < count and len(down) <= overlap else None
+        nxt_rel = min(down, key=lambda d: d[1])[1] if down else None
+        if nxt_rel is not None and (nxt_press is None or nxt_rel <= nxt_press):
+            now = nxt_rel
+            down = [d for d in down if d[1] != nxt_rel]
+            if not down:
+                mod = 0
+        else:
+            now = nxt_press
+            k = rng.pick(keys)
+            if any(d[0] == k for d in down):
+                start += gap
+                continue
+            if mod_every and typed % mod_every == 0:
+                mod = rng.pick([LSHIFT, RSHIFT, LCTRL])
+            down.append((k, now + hold + rng.next(0, hold // 2)))
+            typed += 1
+            start = now + gap + rng.next(0, gap // 2)
+        t.report(max(1, now - last), mod, [d[0] for d in down])
+        last = now
+    return now
+
+
+def rollover():
+    # Fast typist: the next key goes down before the last one comes up,
+    # up to six keys at once, reports only on change
+    t = Trace()
+    rng = Lcg(3)
+    t.report(8000, 0, [])
+    type_text(t, rng, TYPING, 400, 90000, 30000, 5)
+    t.report(8000, 0, [])
+    t.write("rollover.txt", ["Typing with heavy rollover, up to six keys down"])
+
+
+def chords():
+    # Modifier and key in one report, both released in one report; Ctrl+Alt
+    # chords, both Shifts and both Ctrls, Alt-Tab style hold and tap
+    t = Trace()
+    rng = Lcg(7)
+    for _ in range(120):
+        k = rng.pick(TYPING)
+        mod = rng.pick([LSHIFT, RSHIFT, LCTRL | LALT, LSHIFT | RSHIFT, LCTRL | RCTRL, RALT, LGUI])
+        t.report(rng.next(4000, 60000), mod, [k])
+        t.report(rng.next(1000, 40000), 0, [])
+    for _ in range(20):
+        t.report(20000, LALT, [])
+        for _ in range(rng.next(1, 4)):
+            t.report(rng.next(20000, 90000), LALT, [0x2B])
+            t.report(rng.next(20000, 90000), LALT, [])
+        t.report(rng.next(20000, 90000), 0, [])
+    t.write("chords.txt", ["Modifier + key in one report, two-handed chords, Alt-Tab"])
+
+
+def taps():
+    # 1 kHz keyboard: taps of 1-3 ms, shorter than one console read, and
+    # the same key twice in a row (the 3DO stream needs a spacer between
+    # equal bytes). Spaced out enough for the 3DO's one byte per frame.
+    t = Trace()
+    rng = Lcg(13)
+    for i in range(150):
+        k = rng.pick(TYPING)
+        t.report(rng.next(60000, 120000), 0, [k])
+        t.report(rng.next(1000, 3000), 0, [])
+        if i % 4 == 0:
+            t.report(rng.next(1000, 3000), 0, [k])
+            t.report(rng.next(1000, 3000), 0, [])
+    t.write("taps.txt", ["1 kHz, 1-3 ms taps and double taps"])
+
+
+def typing():
+    # Ordinary typing, ~7 keys a second with some overlap and shifted
+    # letters: slow enough for every output, the 3DO included
+    t = Trace()
+    rng = Lcg(31)
+    t.report(8000, 0, [])
+    type_text(t, rng, TYPING, 200, 70000, 120000, 1, mod_every=6)
+    t.report(8000, 0, [])
+    t.write("typing.txt", ["~7 keys/s, light rollover, Shift now and then"])
+
+
+def phantom():
+    # Too many keys for the matrix: ErrorRollOver reports (all 0x01) in the
+    # middle of typing must neither release nor press anything
+    t = Trace()
+    rng = Lcg(17)
+    held = []
+    for i in range(500):
+        if i % 9 == 4:
+            t.report(rng.next(1000, 8000), LSHIFT if i % 2 else 0, [0x01] * 6)
+            continue
+        if len(held) < 4 and (not held or rng.next(0, 2)):
+            k = rng.pick(TYPING)
+            if k not in held:
+                held.append(k)
+        elif held:
+            held.pop(rng.next(0, len(held) - 1))
+        t.report(rng.next(1000, 8000), 0, held)
+    t.report(8000, 0, [])
+    t.write("phantom.txt", ["Random holds with ErrorRollOver reports mixed in"])
+
+
+def burst():
+    # Everything with a multi-byte code: extended keys, F-keys, PrintScreen,
+    # Pause, Caps Lock (Amiga latches it), keypad, in quick bursts
+    t = Trace()
+    rng = Lcg(23)
+    keys = EXTENDED + FKEYS + [PRINT_SCREEN, PAUSE, CAPS_LOCK] + list(range(0x54, 0x64))
+    for _ in range(6):
+        type_text(t, rng, keys, 40, 6000, 4000, 2, mod_every=5)
+        t.report(200000, 0, [])
+    t.write("burst.txt", ["Extended keys, PrintScreen, Pause, Caps Lock, keypad, in bursts"])
+
+
+def long_burst():
+    # Key mashing, ~50 keys a second for 5 s: more than the 3DO's one byte
+    # per frame can carry, so its backlog overflows
+    t = Trace()
+    rng = Lcg(29)
+    type_text(t, rng, TYPING + EXTENDED, 240, 25000, 16000, 3, mod_every=7)
+    t.report(8000, 0, [])
+    t.write("long_burst.txt", ["~50 keys/s for 5 s, more than the slowest output keeps up with"])
+
+
+if __name__ == "__main__":
+    os.makedirs(OUT, exist_ok=True)
+    rollover()
+    chords()
+    taps()
+    typing()
+    phantom()
+    burst()
+    long_burst()
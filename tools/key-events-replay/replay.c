@@ -0,0 +1,796 @@
+// replay.c - replays USB keyboard traces through the firmware's key event
+// queue and keyboard protocols and checks that no transition is lost
+//
+// Reports are fed to a key_events_t the way router.c does on the input
+// side; each keyboard output drains its own queue at its wire's pace:
+//   - PS/2:  ps2_kbd.c, ~1 ms per byte, with the host inhibiting the clock
+//            mid-byte, asking for resends and setting the LEDs
+//   - Amiga: amiga_kb.c, ~0.6 ms per byte plus handshake, with the computer
+//            booting late and now and then missing a handshake (lost sync)
+//   - 3DO:   one byte per 60 Hz PBUS poll, the way 3do_keyboard.c paces it
+//            (mirrored here: the real file needs the router and pico-sdk)
+// A model of the receiving end decodes each wire stream back into key
+// transitions. For every run:
+//   - the queue alone gives the trace's `e` transitions, in order
+//   - each decoded stream matches them too, in that output's code space
+//   - if the backlog overflowed, the stream is still consistent (no
+//     release without its press) and ends with the keyboard's real state
+// Reading level state once per 3DO poll is run beside it for comparison.
+//
+// Usage: key-events-replay [-v] trace.txt...
+//   -v  print every run, not just failures and the per-trace summary
+// Exit status 1 if any check fails.
+//
+// Trace format, one item per line, '#' starts a comment:
+//   r <dt_us> <mod> <k1> .. <k6>       one HID boot keyboard report (hex)
+//   e <+XX|-XX> ...                    transitions the report above makes
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "core/router/key_events.h"
+#include "core/services/keymap/ps2_set2.h"
+#include "native/device/ps2/ps2_kbd.h"
+#include "native/device/amiga/amiga_kb.h"
+
+#define MAX_REPORTS     20000
+#define MAX_EVENTS      (MAX_REPORTS * 4)
+#define MAX_LINE        256
+#define FLUSH_US        5000000     // Wire time after the trace to drain what's left
+
+#define TDO_POLL_US     16667
+#define PS2_BYTE_US     935         // 11 bits at ~12 kHz
+#define PS2_HOST_BYTE_US 1100       // Request-to-send, 11 bits, ACK
+#define PS2_LEDS_EVERY_US 150000
+#define AMIGA_BYTE_US   480         // 8 bits of 60 us
+#define AMIGA_HS_US     100         // Handshake pulse and release
+
+// Code space markers for the sequences that aren't one key code
+#define CODE_PRINT_SCREEN   0x17C   // E0 7C (its fake-shift E0 12 is skipped)
+#define CODE_PAUSE          0x277   // E1 14 77 E1 F0 14 F0 77, make only
+#define CODE_FAKE_SHIFT     0x112
+#define CODE_SPACE          0x300
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+typedef struct {
+    uint32_t dt_us;
+    uint8_t modifier;
+    uint8_t keys[KEY_EVENTS_ROLLOVER];
+    int first_event;            // Its transitions in trace.events[]
+    int event_count;
+} report_t;
+
+typedef struct {
+    char name[64];
+    int count;
+    report_t reports[MAX_REPORTS];
+    int event_count;
+    key_event_t events[MAX_EVENTS];
+} trace_t;
+
+// One transition in an output's own code space
+typedef struct {
+    uint16_t code;
+    bool pressed;
+} code_event_t;
+
+typedef struct output output_t;
+
+struct output {
+    const char* name;
+    // Trace transition -> code space; false if the output doesn't send it
+    bool (*map)(output_t* o, const key_event_t* ev, code_event_t* out);
+    void (*start)(output_t* o);
+    // Move bytes over the wire until `until`
+    void (*advance)(output_t* o, uint64_t until);
+
+    key_events_t queue;
+    uint64_t now;
+    uint32_t rng;
+    bool overflowed;            // The queue filled at least once
+    bool map_caps;              // Caps Lock latch while mapping the trace
+
+    code_event_t got[MAX_EVENTS];
+    int got_count;
+    uint8_t down[CODE_SPACE];   // Receiver's key matrix
+
+    // Receiver's Set 2 decoder
+    bool ext, brk;
+    int skip;
+
+    // Protocol state
+    ps2_kbd_t ps2;
+    amiga_kb_t amiga;
+    struct {
+        uint8_t bytes[PS2_SET2_MAX_BYTES];
+        uint8_t len, pos;
+        uint8_t last_sent;
+        bool initialized;
+        uint8_t host_last;
+    } tdo;
+
+    // PS/2 host: 0 idle, 1 waiting for the FA to ED, 2 for the FA to its argument
+    int host_state;
+    bool host_resend;           // Asked for a resend, waiting for the byte
+    uint8_t host_last;          // For the keyboard's Resend
+    uint64_t host_leds_at;
+
+    int bytes, aborts, resends, host_commands, lost_sync, resets;
+};
+
+static trace_t trace;
+static bool verbose = false;
+static int failures = 0;
+static int checks = 0;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+__attribute__((format(printf, 1, 2)))
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%s: ", trace.name);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    failures++;
+}
+
+// 1 in `n`, from the output's own LCG so runs don't depend on each other
+static bool chance(output_t* o, uint32_t n)
+{
+    o->rng = o->rng * 1103515245u + 12345u;
+    return ((o->rng >> 8) % n) == 0;
+}
+
+static uint32_t rand_below(output_t* o, uint32_t n)
+{
+    o->rng = o->rng * 1103515245u + 12345u;
+    return (o->rng >> 8) % n;
+}
+
+static void receive(output_t* o, uint16_t code, bool pressed)
+{
+    if (o->got_count < MAX_EVENTS) {
+        o->got[o->got_count].code = code;
+        o->got[o->got_count].pressed = pressed;
+        o->got_count++;
+    }
+}
+
+// Host side of a Set 2 stream: prefixes, PrintScreen's fake shift, Pause,
+// and typematic repeats (a make for a key already down) dropped
+static void set2_receive(output_t* o, uint8_t byte)
+{
+    if (o->skip) {
+        o->skip--;
+        return;
+    }
+    switch (byte) {
+        case 0xE0: o->ext = true; return;
+        case 0xF0: o->brk = true; return;
+        case 0xE1:
+            o->skip = 7;
+            receive(o, CODE_PAUSE, true);
+            return;
+    }
+
+    uint16_t code = (uint16_t)(byte | (o->ext ? PS2_SET2_EXTENDED : 0));
+    bool pressed = !o->brk;
+    o->ext = o->brk = false;
+    if (code == CODE_FAKE_SHIFT) return;
+    if (pressed && o->down[code]) return;
+    o->down[code] = pressed;
+    receive(o, code, pressed);
+}
+
+// Has the queue taken every transition in so far?
+static bool caught_up(const key_events_t* q)
+{
+    if (q->queued_modifier != q->held_modifier) return false;
+    for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) {
+        bool found = !q->held_keys[i];
+        for (int j = 0; j < KEY_EVENTS_ROLLOVER && !found; j++) {
+            found = q->queued_keys[j] == q->held_keys[i];
+        }
+        if (!found) return false;
+    }
+    for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) {
+        bool found = !q->queued_keys[i];
+        for (int j = 0; j < KEY_EVENTS_ROLLOVER && !found; j++) {
+            found = q->held_keys[j] == q->queued_keys[i];
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+static bool is_modifier(uint8_t usage)
+{
+    return usage >= 0xE0;
+}
+
+// ============================================================================
+// PS/2
+// ============================================================================
+
+static bool ps2_map(output_t* o, const key_event_t* ev, code_event_t* out)
+{
+    (void)o;
+    out->pressed = ev->pressed;
+    if (ev->usage == PS2_SET2_PRINT_SCREEN) out->code = CODE_PRINT_SCREEN;
+    else if (ev->usage == PS2_SET2_PAUSE) out->code = CODE_PAUSE;
+    else out->code = ps2_set2_from_hid(ev->usage);
+    // Pause has no break code
+    return out->code && !(ev->usage == PS2_SET2_PAUSE && !ev->pressed);
+}
+
+static void ps2_start(output_t* o)
+{
+    ps2_kbd_init(&o->ps2, &o->queue);
+    o->host_leds_at = PS2_LEDS_EVERY_US;
+}
+
+static void ps2_host_send(output_t* o, uint8_t byte)
+{
+    o->now += PS2_HOST_BYTE_US;
+    o->host_commands++;
+    o->host_last = byte;
+    // Now and then the frame arrives damaged: the keyboard answers FE
+    if (chance(o, 40)) ps2_kbd_host_error(&o->ps2);
+    else ps2_kbd_host_byte(&o->ps2, byte);
+}
+
+static void ps2_advance(output_t* o, uint64_t until)
+{
+    while (o->now < until) {
+        key_events_pump(&o->queue);
+
+        // Host: LED update (ED, then the LED bits once ED is acknowledged)
+        if (o->host_state == 0 && !o->host_resend && o->now >= o->host_leds_at) {
+            o->host_leds_at = o->now + PS2_LEDS_EVERY_US;
+            o->host_state = 1;
+            ps2_host_send(o, 0xED);
+            continue;
+        }
+
+        uint8_t byte;
+        if (!ps2_kbd_next(&o->ps2, (uint32_t)o->now, &byte)) {
+            o->now = o->now + 1000 < until ? o->now + 1000 : until;
+            continue;
+        }
+
+        if (chance(o, 30)) {
+            // Host pulls CLK low partway through: the byte goes again
+            o->now += rand_below(o, PS2_BYTE_US) + 100;
+            ps2_kbd_sent(&o->ps2, false, (uint32_t)o->now);
+            o->aborts++;
+            continue;
+        }
+
+        o->now += PS2_BYTE_US;
+        ps2_kbd_sent(&o->ps2, true, (uint32_t)o->now);
+        o->bytes++;
+        o->host_resend = false;
+
+        if (chance(o, 60)) {
+            // Host saw a parity error: throw the byte away, ask for it again
+            o->resends++;
+            o->host_resend = true;
+            ps2_host_send(o, PS2_KBD_RESEND);
+            continue;
+        }
+
+        if (byte == PS2_KBD_RESEND) {
+            ps2_host_send(o, o->host_last);
+            continue;
+        }
+        if (byte == PS2_KBD_ACK) {
+            if (o->host_state == 1) {
+                o->host_state = 2;
+                ps2_host_send(o, (uint8_t)(o->host_commands & 7));
+            } else {
+                o->host_state = 0;
+            }
+            continue;
+        }
+        if (byte == PS2_KBD_BAT_OK || byte == PS2_KBD_ECHO) continue;
+        set2_receive(o, byte);
+    }
+}
+
+// ============================================================================
+// AMIGA
+// ============================================================================
+
+static bool amiga_map(output_t* o, const key_event_t* ev, code_event_t* out)
+{
+    uint8_t code = amiga_kb_from_hid(ev->usage);
+    if (code == AMIGA_KB_UNMAPPED) return false;
+    if (code == AMIGA_KB_CAPS_LOCK) {
+        // Latched: each press is a toggle, the release isn't sent
+        if (!ev->pressed) return false;
+        o->map_caps = !o->map_caps;
+        out->code = code;
+        out->pressed = o->map_caps;
+        return true;
+    }
+    out->code = code;
+    out->pressed = ev->pressed;
+    return true;
+}
+
+static void amiga_start(output_t* o)
+{
+    amiga_kb_init(&o->amiga, &o->queue);
+}
+
+static void amiga_advance(output_t* o, uint64_t until)
+{
+    while (o->now < until) {
+        key_events_pump(&o->queue);
+
+        uint8_t byte = 0;
+        amiga_kb_action_t action = amiga_kb_next(&o->amiga, &byte);
+        switch (action) {
+            case AMIGA_KB_IDLE:
+                o->now = o->now + 1000 < until ? o->now + 1000 : until;
+                break;
+
+            case AMIGA_KB_RESET:
+                o->resets++;
+                o->now += AMIGA_KB_RESET_US;
+                amiga_kb_restart(&o->amiga);
+                break;
+
+            case AMIGA_KB_SYNC:
+                // The computer is still booting for the first one
+                o->now += 60;
+                if (o->now < 100000) {
+                    o->now += AMIGA_KB_HANDSHAKE_US;
+                    amiga_kb_done(&o->amiga, false);
+                } else {
+                    o->now += AMIGA_HS_US;
+                    amiga_kb_done(&o->amiga, true);
+                }
+                break;
+
+            case AMIGA_KB_BYTE:
+                o->now += AMIGA_BYTE_US;
+                o->bytes++;
+                if (chance(o, 150)) {
+                    // Missed: no handshake, the keyboard times out and resyncs
+                    o->now += AMIGA_KB_HANDSHAKE_US;
+                    o->lost_sync++;
+                    amiga_kb_done(&o->amiga, false);
+                    break;
+                }
+                o->now += AMIGA_HS_US;
+                amiga_kb_done(&o->amiga, true);
+                if (byte == AMIGA_KB_LOST_SYNC || byte == AMIGA_KB_POWERUP_START ||
+                    byte == AMIGA_KB_POWERUP_END) {
+                    break;
+                }
+                receive(o, byte & 0x7F, !(byte & AMIGA_KB_KEY_UP));
+                break;
+        }
+    }
+}
+
+// ============================================================================
+// 3DO
+// ============================================================================
+// Same pacing as tdo_kb_next_byte() in src/native/device/3do/3do_keyboard.c
+
+static bool tdo_map(output_t* o, const key_event_t* ev, code_event_t* out)
+{
+    (void)o;
+    if (ev->usage == PS2_SET2_PRINT_SCREEN || ev->usage == PS2_SET2_PAUSE) return false;
+    out->code = ps2_set2_from_hid(ev->usage);
+    out->pressed = ev->pressed;
+    return out->code != 0;
+}
+
+static void tdo_start(output_t* o)
+{
+    memset(&o->tdo, 0, sizeof(o->tdo));
+    o->now = TDO_POLL_US;
+}
+
+static bool tdo_fill(output_t* o)
+{
+    if (o->tdo.pos < o->tdo.len) return true;
+
+    o->tdo.len = o->tdo.pos = 0;
+    if (!o->tdo.initialized) {
+        o->tdo.bytes[o->tdo.len++] = 0xAA;
+        o->tdo.initialized = true;
+        return true;
+    }
+
+    key_event_t ev;
+    while (o->tdo.len == 0 && key_events_pop(&o->queue, &ev)) {
+        if (ev.usage == PS2_SET2_PRINT_SCREEN || ev.usage == PS2_SET2_PAUSE) continue;
+        o->tdo.len = ps2_set2_encode(ev.usage, ev.pressed, o->tdo.bytes);
+    }
+    return o->tdo.len > 0;
+}
+
+static uint8_t tdo_next_byte(output_t* o)
+{
+    uint8_t next;
+    if (!tdo_fill(o)) {
+        next = 0x00;
+    } else {
+        uint8_t peek = o->tdo.bytes[o->tdo.pos];
+        if (peek == o->tdo.last_sent && peek != 0x00) next = 0x00;
+        else next = o->tdo.bytes[o->tdo.pos++];
+    }
+    o->tdo.last_sent = next;
+    return next;
+}
+
+static void tdo_advance(output_t* o, uint64_t until)
+{
+    while (o->now < until) {
+        key_events_pump(&o->queue);
+        uint8_t byte = tdo_next_byte(o);
+        o->now += TDO_POLL_US;
+
+        // Driverlet: a byte counts only if nonzero and not the last one
+        bool fresh = byte != 0 && byte != o->tdo.host_last;
+        o->tdo.host_last = byte;
+        if (!fresh) continue;
+        o->bytes++;
+        if (byte == PS2_KBD_BAT_OK) continue;
+        set2_receive(o, byte);
+    }
+}
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+static int compare_code(const void* a, const void* b)
+{
+    const code_event_t* x = a;
+    const code_event_t* y = b;
+    return (int)x->code - (int)y->code;
+}
+
+// What the output should have sent, report by report, with each report's
+// key releases sorted (their order isn't part of the contract)
+static int expected(output_t* o, code_event_t* exp, int* chunk_len, int* chunk_releases)
+{
+    int n = 0;
+    o->map_caps = false;
+    for (int r = 0; r < trace.count; r++) {
+        const report_t* rep = &trace.reports[r];
+        chunk_len[r] = chunk_releases[r] = 0;
+        for (int e = 0; e < rep->event_count; e++) {
+            const key_event_t* ev = &trace.events[rep->first_event + e];
+            code_event_t c;
+            if (!o->map(o, ev, &c)) continue;
+            exp[n++] = c;
+            chunk_len[r]++;
+            if (!ev->pressed && !is_modifier(ev->usage)) chunk_releases[r]++;
+        }
+        qsort(&exp[n - chunk_len[r]], (size_t)chunk_releases[r], sizeof(*exp), compare_code);
+    }
+    return n;
+}
+
+static void check_exact(output_t* o, const code_event_t* exp, int n,
+                        const int* chunk_len, const int* chunk_releases)
+{
+    checks++;
+    if (o->got_count != n) {
+        fail("%s: %d transitions received, %d expected", o->name, o->got_count, n);
+    }
+
+    int at = 0;
+    for (int r = 0; r < trace.count && at < o->got_count; r++) {
+        int len = chunk_len[r];
+        if (at + len > o->got_count) len = o->got_count - at;
+        int releases = chunk_releases[r] < len ? chunk_releases[r] : len;
+        qsort(&o->got[at], (size_t)releases, sizeof(*o->got), compare_code);
+        for (int i = at; i < at + len; i++) {
+            checks++;
+            if (o->got[i].code != exp[i].code || o->got[i].pressed != exp[i].pressed) {
+                fail("%s: report %d: transition %d is %c%03X, expected %c%03X", o->name, r, i,
+                     o->got[i].pressed ? '+' : '-', o->got[i].code,
+                     exp[i].pressed ? '+' : '-', exp[i].code);
+                return;
+            }
+        }
+        at += len;
+    }
+}
+
+// Backlog overflowed: transitions can be missing, but the stream has to
+// make sense and end where the keyboard did
+static void check_consistent(output_t* o, const code_event_t* exp, int n, uint16_t caps_code)
+{
+    static int down[CODE_SPACE], want[CODE_SPACE];
+    memset(down, 0, sizeof(down));
+    memset(want, 0, sizeof(want));
+
+    for (int i = 0; i < n; i++) {
+        if (exp[i].code == caps_code || exp[i].code == CODE_PAUSE) continue;
+        want[exp[i].code] += exp[i].pressed ? 1 : -1;
+    }
+    for (int i = 0; i < o->got_count; i++) {
+        const code_event_t* c = &o->got[i];
+        if (c->code == caps_code || c->code == CODE_PAUSE) continue;
+        down[c->code] += c->pressed ? 1 : -1;
+        checks++;
+        if (down[c->code] < 0) {
+            fail("%s: transition %d releases %03X, which isn't down", o->name, i, c->code);
+            return;
+        }
+    }
+    for (int code = 0; code < CODE_SPACE; code++) {
+        checks++;
+        if (down[code] != want[code]) {
+            fail("%s: %03X ends %s, keyboard has it %s", o->name, code,
+                 down[code] ? "down" : "up", want[code] ? "down" : "up");
+        }
+    }
+}
+
+// Level state read once per poll, the way the outputs used to: transitions
+// that came and went between two reads never show
+static int level_state_seen(uint32_t poll_us)
+{
+    uint8_t seen_mod = 0, seen_keys[KEY_EVENTS_ROLLOVER] = { 0 };
+    uint8_t mod = 0, keys[KEY_EVENTS_ROLLOVER] = { 0 };
+    uint64_t t = 0, next_read = poll_us;
+    int seen = 0;
+
+    for (int r = 0; r <= trace.count; r++) {
+        uint64_t at = r < trace.count ? t + trace.reports[r].dt_us : t + poll_us;
+        while (next_read <= at) {
+            seen += __builtin_popcount((unsigned)(seen_mod ^ mod));
+            for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) {
+                bool was = false, now = false;
+                for (int j = 0; j < KEY_EVENTS_ROLLOVER; j++) {
+                    if (keys[i] && seen_keys[j] == keys[i]) now = true;
+                    if (seen_keys[i] && keys[j] == seen_keys[i]) was = true;
+                }
+                seen += (keys[i] && !now) + (seen_keys[i] && !was);
+            }
+            seen_mod = mod;
+            memcpy(seen_keys, keys, sizeof(keys));
+            next_read += poll_us;
+        }
+        if (r == trace.count) break;
+
+        t = at;
+        const report_t* rep = &trace.reports[r];
+        bool rollover = true;
+        for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) rollover &= rep->keys[i] == 0x01;
+        if (rollover) continue;
+        mod = rep->modifier;
+        for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) {
+            keys[i] = rep->keys[i] >= 0x04 ? rep->keys[i] : 0;
+            for (int j = 0; j < i; j++) {
+                if (keys[j] == keys[i]) keys[i] = 0;
+            }
+        }
+    }
+    return seen;
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+// The queue on its own, drained after every report
+static void replay_queue(void)
+{
+    key_events_t q;
+    key_events_init(&q);
+
+    for (int r = 0; r < trace.count; r++) {
+        const report_t* rep = &trace.reports[r];
+        key_events_update(&q, rep->modifier, rep->keys);
+
+        key_event_t got[KEY_EVENTS_QUEUE_SIZE];
+        int n = 0;
+        while (n < KEY_EVENTS_QUEUE_SIZE && key_events_pop(&q, &got[n])) n++;
+
+        checks++;
+        if (n != rep->event_count) {
+            fail("queue: report %d gave %d transitions, expected %d", r, n, rep->event_count);
+            return;
+        }
+
+        // Releases of keys first, in any order
+        bool ok = true;
+        const key_event_t* exp = &trace.events[rep->first_event];
+        int releases = 0;
+        while (releases < n && !exp[releases].pressed && !is_modifier(exp[releases].usage)) releases++;
+        for (int i = 0; i < n && ok; i++) {
+            if (i < releases) {
+                bool found = false;
+                for (int j = 0; j < releases; j++) {
+                    found |= got[i].usage == exp[j].usage && got[i].pressed == exp[j].pressed;
+                }
+                ok = found;
+            } else {
+                ok = got[i].usage == exp[i].usage && got[i].pressed == exp[i].pressed;
+            }
+        }
+        checks++;
+        if (!ok) {
+            fail("queue: report %d transitions out of order", r);
+            return;
+        }
+    }
+    if (verbose) printf("%-16s %-6s %5d transitions in order\n", trace.name, "queue", trace.event_count);
+}
+
+static void replay(output_t* o)
+{
+    key_events_init(&o->queue);
+    o->now = 0;
+    o->rng = 1;
+    o->overflowed = false;
+    o->got_count = 0;
+    memset(o->down, 0, sizeof(o->down));
+    o->ext = o->brk = false;
+    o->skip = 0;
+    o->host_state = 0;
+    o->host_resend = false;
+    o->bytes = o->aborts = o->resends = o->host_commands = o->lost_sync = o->resets = 0;
+    o->start(o);
+
+    uint64_t t = 0;
+    for (int r = 0; r < trace.count; r++) {
+        const report_t* rep = &trace.reports[r];
+        t += rep->dt_us;
+        o->advance(o, t);
+        key_events_update(&o->queue, rep->modifier, rep->keys);
+        if (!caught_up(&o->queue)) o->overflowed = true;
+    }
+    o->advance(o, (o->now > t ? o->now : t) + FLUSH_US);
+}
+
+static output_t outputs[] = {
+    { .name = "PS/2",  .map = ps2_map,   .start = ps2_start,   .advance = ps2_advance },
+    { .name = "Amiga", .map = amiga_map, .start = amiga_start, .advance = amiga_advance },
+    { .name = "3DO",   .map = tdo_map,   .start = tdo_start,   .advance = tdo_advance },
+};
+#define OUTPUT_COUNT    (int)(sizeof(outputs) / sizeof(outputs[0]))
+
+static void run_trace(void)
+{
+    static code_event_t exp[MAX_EVENTS];
+    static int chunk_len[MAX_REPORTS], chunk_releases[MAX_REPORTS];
+
+    replay_queue();
+
+    for (int oi = 0; oi < OUTPUT_COUNT; oi++) {
+        output_t* o = &outputs[oi];
+        replay(o);
+        int n = expected(o, exp, chunk_len, chunk_releases);
+        uint16_t caps_code = o->map == amiga_map ? AMIGA_KB_CAPS_LOCK : CODE_SPACE;
+
+        if (!o->overflowed) check_exact(o, exp, n, chunk_len, chunk_releases);
+        else check_consistent(o, exp, n, caps_code);
+
+        printf("%-16s %-6s %5d/%5d transitions%s", trace.name, o->name, o->got_count, n,
+               o->overflowed ? " (backlog overflowed)" : "");
+        if (verbose) {
+            printf(", %d bytes, %d inhibited, %d resent, %d host bytes, %d lost sync",
+                   o->bytes, o->aborts, o->resends, o->host_commands, o->lost_sync);
+        }
+        putchar('\n');
+    }
+
+    int seen = level_state_seen(TDO_POLL_US);
+    printf("%-16s level state once per 3DO poll loses %d of %d transitions\n",
+           trace.name, trace.event_count - seen, trace.event_count);
+}
+
+// ============================================================================
+// FILES
+// ============================================================================
+
+static bool load_trace(const char* file)
+{
+    FILE* f = fopen(file, "r");
+    if (!f) {
+        perror(file);
+        failures++;
+        return false;
+    }
+
+    memset(&trace, 0, sizeof(trace));
+    const char* base = strrchr(file, '/');
+    snprintf(trace.name, sizeof(trace.name), "%s", base ? base + 1 : file);
+
+    char buf[MAX_LINE];
+    int line = 0;
+    bool ok = true;
+    while (ok && fgets(buf, sizeof(buf), f)) {
+        line++;
+        char* s = buf;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#' || *s == '\n' || *s == '\0') continue;
+
+        unsigned dt, mod, k[KEY_EVENTS_ROLLOVER];
+        if (s[0] == 'r' && sscanf(s + 1, "%u %x %x %x %x %x %x %x", &dt, &mod,
+                                  &k[0], &k[1], &k[2], &k[3], &k[4], &k[5]) == 8) {
+            if (trace.count >= MAX_REPORTS) {
+                fprintf(stderr, "%s:%d: more than %d reports\n", file, line, MAX_REPORTS);
+                ok = false;
+                break;
+            }
+            report_t* rep = &trace.reports[trace.count++];
+            rep->dt_us = dt;
+            rep->modifier = (uint8_t)mod;
+            for (int i = 0; i < KEY_EVENTS_ROLLOVER; i++) rep->keys[i] = (uint8_t)k[i];
+            rep->first_event = trace.event_count;
+        } else if (s[0] == 'e' && trace.count > 0) {
+            report_t* rep = &trace.reports[trace.count - 1];
+            char* p = s + 1;
+            char sign;
+            unsigned usage;
+            int used;
+            while (sscanf(p, " %c%x%n", &sign, &usage, &used) == 2) {
+                if ((sign != '+' && sign != '-') || trace.event_count >= MAX_EVENTS) {
+                    fprintf(stderr, "%s:%d: bad transition\n", file, line);
+                    ok = false;
+                    break;
+                }
+                key_event_t* ev = &trace.events[trace.event_count++];
+                ev->usage = (uint8_t)usage;
+                ev->pressed = sign == '+';
+                rep->event_count++;
+                p += used;
+            }
+        } else {
+            fprintf(stderr, "%s:%d: unrecognised line\n", file, line);
+            ok = false;
+        }
+    }
+    fclose(f);
+    if (!ok) failures++;
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        if (opt == 'v') verbose = true;
+        else {
+            fprintf(stderr, "usage: %s [-v] trace.txt...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-v] trace.txt...\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        if (load_trace(argv[i])) run_trace();
+    }
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
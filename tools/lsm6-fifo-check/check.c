@@ -0,0 +1,338 @@
+// check.c - drives the firmware's lsm6_fifo.c against a simulated
+// LSM6DS3TR-C FIFO and checks the samples and their timestamps
+//
+// The simulated chip takes a sample every ODR period (off nominal by the
+// scenario's clock error) into a 2048-word FIFO that overwrites its oldest
+// words when full, as continuous mode does. The reader follows imu_nrf.c:
+// it waits for the watermark edge (or the fallback poll), reads the status,
+// reads the counted words capped at IMU_FIFO_MAX_SETS, parses and stamps.
+// Interrupt latency, bus time and main loop stalls come from the scenario.
+//
+// Every sample carries its own index in its words, so the check knows
+// exactly which sample came out and when it was really taken.
+//
+// Usage: lsm6-fifo-check [-v]
+//   -v  print every burst
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lsm6_fifo.h"
+
+// Must match imu_nrf.c
+#define ODR_HZ              416
+#define WATERMARK_SETS      4
+#define MAX_SETS            32
+#define POLL_US             20000
+
+#define FIFO_CAP_WORDS      2048
+#define RUN_US              10000000.0      // 10 s per scenario
+#define SETTLE_US           1000000.0       // Timestamp checks start after this
+
+// ============================================================================
+// SCENARIOS
+// ============================================================================
+
+typedef struct {
+    const char* name;
+    double clock_err;           // Real ODR = nominal x (1 + clock_err)
+    bool irq;                   // INT1 wired (else polled)
+    double lat_min_us;          // Interrupt / loop latency before the status read
+    double lat_max_us;
+    double stall_at_us;         // One main loop stall (0 = none)
+    double stall_us;
+    // Timestamp tolerances after settling
+    double max_jitter_us;       // Error about the run's mean offset
+    double max_rate_err;        // Tracked period vs real
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "nominal",        0.0,    true,  100, 500,   0, 0,      500, 0.002 },
+    { "fast_clock",     0.03,   true,  100, 500,   0, 0,      500, 0.002 },
+    { "slow_jittery",  -0.025,  true,  100, 4000,  0, 0,      1200, 0.004 },
+    { "polled",         0.01,   false, 0,   1000,  0, 0,      800, 0.003 },
+    { "stall_catchup",  0.0,    true,  100, 500,   3e6, 600000, 500, 0.002 },
+    { "stall_overrun", -0.01,   true,  100, 500,   3e6, 1500000, 500, 0.002 },
+};
+
+// ============================================================================
+// SIMULATED CHIP
+// ============================================================================
+
+static uint16_t fifo[FIFO_CAP_WORDS];
+static int fifo_head, fifo_count;
+static uint16_t head_pattern;           // Set position of the word at the head
+static bool fifo_overrun;
+static uint32_t next_k;                 // Next sample index the chip takes
+static double period_true;
+
+static void sample_words(uint32_t k, uint16_t w[LSM6_FIFO_SET_WORDS])
+{
+    w[0] = (uint16_t)(k & 0xFFFF);              // gyro X, Y: the index
+    w[1] = (uint16_t)(k >> 16);
+    w[2] = (uint16_t)~k;                        // gyro Z, accel: checks
+    w[3] = (uint16_t)(k * 7);
+    w[4] = (uint16_t)(k * 13);
+    w[5] = (uint16_t)(0x5A5A ^ k);
+}
+
+static double sample_time(uint32_t k)
+{
+    return 1000.0 + k * period_true;
+}
+
+static void fifo_push_until(double t)
+{
+    while (sample_time(next_k) <= t) {
+        uint16_t w[LSM6_FIFO_SET_WORDS];
+        sample_words(next_k++, w);
+        for (int i = 0; i < LSM6_FIFO_SET_WORDS; i++) {
+            if (fifo_count == FIFO_CAP_WORDS) {
+                fifo_head = (fifo_head + 1) % FIFO_CAP_WORDS;
+                fifo_count--;
+                head_pattern = (head_pattern + 1) % LSM6_FIFO_SET_WORDS;
+                fifo_overrun = true;
+            }
+            fifo[(fifo_head + fifo_count++) % FIFO_CAP_WORDS] = w[i];
+        }
+    }
+}
+
+static void fifo_status_bytes(uint8_t st[LSM6_FIFO_STATUS_LEN])
+{
+    int words = fifo_count > 2047 ? 2047 : fifo_count;     // 11-bit DIFF_FIFO
+    st[0] = (uint8_t)(words & 0xFF);
+    st[1] = (uint8_t)((words >> 8) & 0x07);
+    if (fifo_count >= WATERMARK_SETS * LSM6_FIFO_SET_WORDS) st[1] |= 0x80;
+    if (fifo_overrun) st[1] |= 0x40;
+    if (fifo_count == 0) st[1] |= 0x10;
+    st[2] = (uint8_t)head_pattern;
+    st[3] = 0;
+}
+
+static void fifo_read(uint8_t* out, int words)
+{
+    for (int i = 0; i < words; i++) {
+        uint16_t w = fifo[fifo_head];
+        out[i * 2] = (uint8_t)(w & 0xFF);
+        out[i * 2 + 1] = (uint8_t)(w >> 8);
+        fifo_head = (fifo_head + 1) % FIFO_CAP_WORDS;
+        fifo_count--;
+        head_pattern = (head_pattern + 1) % LSM6_FIFO_SET_WORDS;
+    }
+    if (words >= LSM6_FIFO_SET_WORDS) fifo_overrun = false;
+}
+
+// Time the FIFO next reaches the watermark from below
+static double watermark_time(void)
+{
+    int need = WATERMARK_SETS * LSM6_FIFO_SET_WORDS - fifo_count;
+    if (need <= 0) return -1;
+    uint32_t sets = (uint32_t)((need + LSM6_FIFO_SET_WORDS - 1) / LSM6_FIFO_SET_WORDS);
+    return sample_time(next_k + sets - 1);
+}
+
+// ============================================================================
+// RUN
+// ============================================================================
+
+static bool verbose = false;
+static int failures = 0;
+static int checks = 0;
+static uint32_t rng = 12345;
+
+static double jitter(double lo, double hi)
+{
+    rng = rng * 1103515245u + 12345u;
+    return lo + (hi - lo) * ((rng >> 8) & 0xFFFF) / 65535.0;
+}
+
+#define CHECK(sc, cond, ...) do { \
+    checks++; \
+    if (!(cond)) { \
+        failures++; \
+        fprintf(stderr, "%s: ", (sc)->name); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+    } \
+} while (0)
+
+static void run(const scenario_t* sc)
+{
+    memset(fifo, 0, sizeof(fifo));
+    fifo_head = fifo_count = 0;
+    head_pattern = 0;
+    fifo_overrun = false;
+    next_k = 0;
+    period_true = 1e6 / (ODR_HZ * (1.0 + sc->clock_err));
+
+    lsm6_fifo_clock_t clk;
+    lsm6_fifo_clock_init(&clk, ODR_HZ);
+
+    static uint8_t buf[MAX_SETS * LSM6_FIFO_SET_WORDS * 2];
+    onboard_motion_sample_t samples[MAX_SETS];
+
+    double t = 0;
+    double last_read = 0;
+    bool pending = false;
+    int64_t prev_k = -1;
+    uint32_t first_k = 0;
+    uint32_t prev_t = 0;
+    bool have_prev = false;
+    uint32_t received = 0, lost = 0, bursts = 0, ordering_errors = 0;
+    bool lost_without_overrun = false;
+
+    // Timestamp error stats after settling
+    double err_sum = 0, err_min = 1e18, err_max = -1e18;
+    uint32_t err_n = 0;
+    double first_t = 0, first_true = 0, last_t = 0, last_true = 0;
+    bool span_started = false;
+
+    while (t < RUN_US) {
+        // When the reader next starts a status read
+        double next;
+        if (pending) {
+            next = t + jitter(20, 200);
+        } else {
+            double wm = sc->irq ? watermark_time() : -1;
+            double poll = last_read + POLL_US;
+            next = (wm >= 0 && wm < poll) ? wm : poll;
+            if (next < t) next = t;
+            next += jitter(sc->lat_min_us, sc->lat_max_us);
+        }
+        if (sc->stall_us > 0 && next >= sc->stall_at_us && next < sc->stall_at_us + sc->stall_us) {
+            next = sc->stall_at_us + sc->stall_us;
+        }
+        t = next;
+        pending = false;
+        last_read = t;
+
+        // Status read: counted now, completes after the bus time
+        fifo_push_until(t);
+        uint8_t st[LSM6_FIFO_STATUS_LEN];
+        fifo_status_bytes(st);
+        double status_done = t + 110;
+        lsm6_fifo_status_t status;
+        lsm6_fifo_decode_status(st, &status);
+
+        uint16_t words = lsm6_fifo_words_to_read(&status, MAX_SETS * LSM6_FIFO_SET_WORDS);
+        if (words == 0) continue;
+
+        // Data read: a loop pass later, only the counted words
+        t = status_done + jitter(20, 300);
+        fifo_push_until(t);
+        fifo_read(buf, words);
+        t += 25.0 * words + 50;
+
+        uint16_t n = lsm6_fifo_parse(buf, words, status.pattern, samples, MAX_SETS);
+        uint16_t unread = (uint16_t)((status.words - words) / LSM6_FIFO_SET_WORDS);
+        lsm6_fifo_clock_stamp(&clk, samples, n, (uint32_t)status_done, unread, status.overrun);
+        bursts++;
+
+        if (verbose) {
+            printf("%s: t %9.0f  words %4u pattern %u%s -> %u samples, period %.2f us\n",
+                   sc->name, t, words, status.pattern, status.overrun ? " OVERRUN" : "",
+                   n, clk.period_q8 / 256.0);
+        }
+
+        for (uint16_t i = 0; i < n; i++) {
+            const onboard_motion_sample_t* s = &samples[i];
+            uint32_t k = (uint16_t)s->gyro[0] | ((uint32_t)(uint16_t)s->gyro[1] << 16);
+            uint16_t w[LSM6_FIFO_SET_WORDS];
+            sample_words(k, w);
+            bool intact = (uint16_t)s->gyro[2] == w[2] && (uint16_t)s->accel[0] == w[3] &&
+                          (uint16_t)s->accel[1] == w[4] && (uint16_t)s->accel[2] == w[5];
+            CHECK(sc, intact, "sample %u: words out of place", k);
+
+            if (prev_k >= 0 && (int64_t)k != prev_k + 1) {
+                if ((int64_t)k <= prev_k) ordering_errors++;
+                else {
+                    lost += (uint32_t)(k - prev_k - 1);
+                    if (!status.overrun) lost_without_overrun = true;
+                }
+            }
+            if (prev_k < 0) first_k = k;
+            prev_k = k;
+            received++;
+
+            if (have_prev) {
+                CHECK(sc, (int32_t)(s->t_us - prev_t) > 0,
+                      "sample %u: time %u not after %u", k, s->t_us, prev_t);
+            }
+            prev_t = s->t_us;
+            have_prev = true;
+
+            double truth = sample_time(k);
+            if (truth >= SETTLE_US && !(sc->stall_us > 0 && truth >= sc->stall_at_us &&
+                                        truth < sc->stall_at_us + sc->stall_us + SETTLE_US)) {
+                double e = (double)s->t_us - truth;
+                err_sum += e;
+                if (e < err_min) err_min = e;
+                if (e > err_max) err_max = e;
+                err_n++;
+                if (!span_started) {
+                    first_t = s->t_us;
+                    first_true = truth;
+                    span_started = true;
+                }
+                last_t = s->t_us;
+                last_true = truth;
+            }
+        }
+
+        // imu_task goes straight back when the burst was capped
+        if (status.words > words + LSM6_FIFO_SET_WORDS) pending = true;
+    }
+
+    double mean = err_n ? err_sum / err_n : 0;
+    double spread = err_n ? fmax(err_max - mean, mean - err_min) : 0;
+    double rate_err = fabs(clk.period_q8 / 256.0 - period_true) / period_true;
+    double span_err = last_true > first_true
+                    ? fabs((last_t - first_t) - (last_true - first_true)) / (last_true - first_true) : 0;
+
+    printf("%-14s %6u samples in %5u bursts, %5u lost | offset %6.0f us, jitter %4.0f us, "
+           "period err %.3f%%, span err %.3f%%\n",
+           sc->name, received, bursts, lost, mean, spread, rate_err * 100, span_err * 100);
+
+    CHECK(sc, ordering_errors == 0, "%u samples out of order", ordering_errors);
+    CHECK(sc, !lost_without_overrun, "samples lost without an overrun");
+    if (sc->stall_us == 0 || sc->stall_us < 0.8e6) {
+        CHECK(sc, lost == 0, "%u samples lost", lost);
+    } else {
+        CHECK(sc, lost > 0, "overrun scenario lost nothing");
+    }
+    CHECK(sc, first_k == 0, "first sample out was %u", first_k);
+    CHECK(sc, (int64_t)(next_k - (prev_k + 1)) * LSM6_FIFO_SET_WORDS <= fifo_count + LSM6_FIFO_SET_WORDS,
+          "samples %u-%u neither read nor in the FIFO", (uint32_t)(prev_k + 1), next_k - 1);
+    CHECK(sc, err_n > 0, "no samples after settling");
+    CHECK(sc, fabs(mean) < period_true + sc->lat_max_us, "offset %.0f us", mean);
+    CHECK(sc, spread < sc->max_jitter_us, "jitter %.0f us, max %.0f", spread, sc->max_jitter_us);
+    CHECK(sc, rate_err < sc->max_rate_err, "period error %.3f%%", rate_err * 100);
+    CHECK(sc, span_err < sc->max_rate_err, "span error %.3f%%", span_err * 100);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        if (opt == 'v') verbose = true;
+        else {
+            fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        run(&scenarios[i]);
+    }
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Generate the synthetic mouse traces in traces/.
+
+Each trace is HID mouse reports the way hid_mouse.c hands them to the
+router: microseconds since the previous report, then x, y and wheel
+counts. `expect total` is the plain sum of the deltas.
+
+Deterministic: running it again rewrites identical files.
+"""
+
+import math
+import os
+
+OUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "traces")
+
+
+class Lcg:
+    def __init__(self, seed):
+        self.s = seed
+
+    def next(self, lo, hi):
+        self.s = (self.s * 1103515245 + 12345) & 0xFFFFFFFF
+        return lo + (self.s >> 8) % (hi - lo + 1)
+
+
+def write(name, comment, reports):
+    """reports: list of (dt_us, dx, dy, wheel)"""
+    lines = [f"# {name} - generated by gen_traces.py, do not edit"]
+    lines += [f"# {c}" for c in comment]
+    tx = sum(r[1] for r in reports)
+    ty = sum(r[2] for r in reports)
+    tw = sum(r[3] for r in reports)
+    lines.append(f"expect total {tx} {ty} {tw}")
+    for dt, dx, dy, w in reports:
+        lines.append(f"{dt} {dx} {dy} {w}" if w else f"{dt} {dx} {dy}")
+    with open(os.path.join(OUT, name), "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def slow_drift():
+    # 125 Hz mouse creeping one count per report: at 0.25x every report on
+    # its own rounds to nothing
+    r = []
+    for i in range(1500):
+        r.append((8000, 1 if i % 3 else 0, -1 if i % 5 == 0 else 0, 0))
+    write("slow_drift.txt", ["125 Hz, one count at a time"], r)
+
+
+def fast_swipe():
+    # 1 kHz mouse: a 150 ms flick right and back, far more per console
+    # frame than one read can carry
+    r = [(1000, 0, 0, 0)] * 50
+    for i in range(150):
+        v = int(round(40 * math.sin(math.pi * i / 150)))
+        r.append((1000, v, v // 4, 0))
+    r += [(1000, 0, 0, 0)] * 100
+    for i in range(150):
+        v = int(round(-25 * math.sin(math.pi * i / 150)))
+        r.append((1000, v, 0, 0))
+    write("fast_swipe.txt", ["1 kHz flick, several reads' worth per frame"], r)
+
+
+def jitter_8k():
+    # 8 kHz mouse with jittery arrival, small deltas, for 1.5 seconds
+    rng = Lcg(11)
+    r = []
+    t = 0
+    while t < 1500000:
+        dt = rng.next(90, 180)
+        t += dt
+        phase = t / 1e6
+        dx = rng.next(0, 2) if math.sin(2 * math.pi * 0.5 * phase) > 0 else -rng.next(0, 2)
+        dy = rng.next(-1, 1)
+        r.append((dt, dx, dy, 0))
+    write("jitter_8k.txt", ["8 kHz, jittered 90-180 us, 0-2 counts per report"], r)
+
+
+def circles():
+    # 500 Hz mouse drawing circles at different speeds
+    r = []
+    for speed, secs in ((1.0, 2.0), (3.0, 1.0), (0.3, 3.0)):
+        n = int(secs * 500)
+        for i in range(n):
+            a = 2 * math.pi * speed * i / 500
+            radius = 60 * speed
+            dx = int(round(-radius * math.sin(a) * 2 * math.pi * speed / 500))
+            dy = int(round(radius * math.cos(a) * 2 * math.pi * speed / 500))
+            r.append((2000, dx, dy, 0))
+    write("circles.txt", ["500 Hz circles at 1, 3 and 0.3 turns per second"], r)
+
+
+def wheel():
+    # Notched wheel ticks, including a fast spin, with a little drift
+    rng = Lcg(5)
+    r = []
+    for i in range(400):
+        w = 0
+        if i % 25 == 0:
+            w = 1
+        if 200 <= i < 220:
+            w = -3
+        r.append((4000, rng.next(-1, 1), 0, w))
+    write("wheel.txt", ["250 Hz, single notches and a fast spin down"], r)
+
+
+if __name__ == "__main__":
+    os.makedirs(OUT, exist_ok=True)
+    slow_drift()
+    fast_swipe()
+    jitter_8k()
+    circles()
+    wheel()
@@ -0,0 +1,349 @@
+// replay.c - replays USB mouse traces through the firmware's mouse_motion.c
+// and checks that no motion is lost between mouse reports and console reads
+//
+// Each trace is played against every console mouse output: its gain, how
+// often the console reads the mouse and how far one read can move. Reports
+// are added to a mouse_motion_accum_t the way router.c does on the input
+// side; reads take from it the way the output drivers do. For every run:
+//   - counts read + motion still pending == motion added, exactly (less
+//     anything refused at the backlog cap, which is reported)
+//   - no read goes past the output's limit
+//   - after a flush, less than one count is left pending
+//   - at flat gain, motion added == the trace's counts x gain
+// The old per-read approach (latest report wins, scaled on its own) is run
+// beside it and compared by distance travelled.
+//
+// Usage: mouse-motion-replay [-v] trace.txt...
+//   -v  print every run, not just the per-output summary
+// Exit status 1 if any check fails.
+//
+// Trace format, one item per line, '#' starts a comment:
+//   <dt_us> <dx> <dy> [wheel]          one HID mouse report (x right, y down)
+//   expect total <x> <y> <wheel>       sum of the report deltas
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "core/router/mouse_motion.h"
+
+#define MAX_REPORTS     200000
+#define MAX_LINE        128
+#define FLUSH_US        2000000     // Reads after the trace to drain what's left
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+typedef struct {
+    uint32_t dt_us;
+    int16_t delta[MOUSE_MOTION_AXES];
+} report_t;
+
+typedef struct {
+    char name[64];
+    int count;
+    report_t reports[MAX_REPORTS];
+    bool has_total;
+    int64_t total[MOUSE_MOTION_AXES];
+} trace_t;
+
+// One console mouse output, as its driver reads the accumulator
+typedef struct {
+    const char* name;
+    uint32_t read_us;           // Console read interval
+    int32_t limit;              // Most counts one read carries
+    mouse_motion_config_t cfg;
+} output_t;
+
+typedef struct {
+    int64_t added[MOUSE_MOTION_AXES];     // What mouse_motion_add put in, 1/256 counts
+    int64_t clipped[MOUSE_MOTION_AXES];   // Refused at MOUSE_MOTION_PENDING_MAX
+    int64_t emitted[MOUSE_MOTION_AXES];   // Counts read
+    int64_t pending[MOUSE_MOTION_AXES];   // Left in the accumulator, 1/256 counts
+    int64_t travel[MOUSE_MOTION_AXES];    // Sum of |counts| per read
+    int64_t legacy[MOUSE_MOTION_AXES];    // Same for the per-read baseline
+    int32_t peak[MOUSE_MOTION_AXES];      // Largest single read
+    int reads;
+} result_t;
+
+// Read pace and limits match the drivers in src/native/device/
+static const output_t outputs[] = {
+    { "pcengine",  16667, 127, { .sens_min = 64,  .sens_max = 64  } },
+    { "dreamcast", 16667, 511, { .sens_min = 256, .sens_max = 256 } },
+    { "3do",       16667, 511, { .sens_min = 256, .sens_max = 256 } },
+    { "n64",       16667, 127, { .sens_min = 128, .sens_max = 128 } },
+    { "accel",     16667, 511, { .sens_min = 128, .sens_max = 512, .accel_cps = 4000 } },
+};
+#define OUTPUT_COUNT    (int)(sizeof(outputs) / sizeof(outputs[0]))
+
+static const char* const axis_names[MOUSE_MOTION_AXES] = { "x", "y", "wheel" };
+
+static trace_t trace;
+static bool verbose = false;
+static int failures = 0;
+static int checks = 0;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+__attribute__((format(printf, 1, 2)))
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%s: ", trace.name);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    failures++;
+}
+
+static int64_t abs64(int64_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+static int32_t clamp32(int32_t v, int32_t limit)
+{
+    return v > limit ? limit : (v < -limit ? -limit : v);
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+static void console_read(mouse_motion_accum_t* acc, const output_t* o,
+                         const report_t* latest, result_t* r)
+{
+    for (int a = 0; a < MOUSE_MOTION_AXES; a++) {
+        int32_t counts = mouse_motion_take(acc, a, o->limit);
+        r->emitted[a] += counts;
+        r->travel[a] += abs64(counts);
+        if (abs64(counts) > r->peak[a]) r->peak[a] = (int32_t)abs64(counts);
+    }
+
+    // Baseline: only the latest report reaches the console, scaled on its own
+    if (latest) {
+        for (int a = 0; a < MOUSE_MOTION_AXES; a++) {
+            int32_t gain = a == MOUSE_MOTION_WHEEL ? MOUSE_MOTION_ONE : o->cfg.sens_min;
+            r->legacy[a] += abs64(clamp32((latest->delta[a] * gain) / MOUSE_MOTION_ONE, o->limit));
+        }
+    }
+    r->reads++;
+}
+
+static void replay(const output_t* o, result_t* r)
+{
+    mouse_motion_accum_t acc;
+    mouse_motion_init(&acc);
+    memset(r, 0, sizeof(*r));
+
+    uint64_t t_report = 0;
+    uint64_t t_read = o->read_us;
+    const report_t* latest = NULL;
+    int32_t gain_lo = o->cfg.sens_min, gain_hi = o->cfg.sens_max;
+
+    int i = 0;
+    while (i < trace.count) {
+        const report_t* rep = &trace.reports[i];
+        if (t_report + rep->dt_us <= t_read) {
+            t_report += rep->dt_us;
+            int32_t before[MOUSE_MOTION_AXES];
+            for (int a = 0; a < MOUSE_MOTION_AXES; a++) before[a] = mouse_motion_pending(&acc, a);
+            mouse_motion_add(&acc, &o->cfg, rep->delta[MOUSE_MOTION_X], rep->delta[MOUSE_MOTION_Y],
+                             rep->delta[MOUSE_MOTION_WHEEL], (uint32_t)t_report);
+            for (int a = 0; a < MOUSE_MOTION_AXES; a++) {
+                int64_t got = mouse_motion_pending(&acc, a) - before[a];
+                int64_t d = rep->delta[a];
+                bool capped = abs64(mouse_motion_pending(&acc, a)) == MOUSE_MOTION_PENDING_MAX;
+
+                // Each report's gain stays inside the configured curve
+                if (!capped) {
+                    checks++;
+                    int64_t lo = a == MOUSE_MOTION_WHEEL ? d * MOUSE_MOTION_ONE : d * gain_lo;
+                    int64_t hi = a == MOUSE_MOTION_WHEEL ? d * MOUSE_MOTION_ONE : d * gain_hi;
+                    if (d < 0) { int64_t t = lo; lo = hi; hi = t; }
+                    if (got < lo || got > hi) {
+                        fail("%s report %d %s: added %lld, outside %lld..%lld", o->name, i,
+                             axis_names[a], (long long)got, (long long)lo, (long long)hi);
+                    }
+                }
+
+                // At flat gain the cap is the only thing that can refuse motion
+                if (o->cfg.sens_min == o->cfg.sens_max || a == MOUSE_MOTION_WHEEL) {
+                    int64_t want = a == MOUSE_MOTION_WHEEL ? d * MOUSE_MOTION_ONE : d * gain_lo;
+                    r->clipped[a] += want - got;
+                }
+                r->added[a] += got;
+            }
+            latest = rep;
+            i++;
+        } else {
+            console_read(&acc, o, latest, r);
+            latest = NULL;      // The driver only sees reports since its last read
+            t_read += o->read_us;
+        }
+    }
+
+    // Flush: keep reading with the mouse at rest
+    uint64_t end = t_read + FLUSH_US;
+    while (t_read < end) {
+        console_read(&acc, o, latest, r);
+        latest = NULL;
+        t_read += o->read_us;
+    }
+
+    for (int a = 0; a < MOUSE_MOTION_AXES; a++) r->pending[a] = mouse_motion_pending(&acc, a);
+}
+
+static void run_trace(void)
+{
+    for (int oi = 0; oi < OUTPUT_COUNT; oi++) {
+        const output_t* o = &outputs[oi];
+        bool flat = o->cfg.sens_min == o->cfg.sens_max;
+        result_t r;
+        replay(o, &r);
+
+        for (int a = 0; a < MOUSE_MOTION_AXES; a++) {
+            // Nothing lost: what was read plus what's left is what went in
+            checks++;
+            int64_t lost = r.added[a] - r.emitted[a] * MOUSE_MOTION_ONE - r.pending[a];
+            if (lost != 0) {
+                fail("%s %s: %lld/256 counts lost", o->name, axis_names[a], (long long)lost);
+            }
+
+            // Never past what one console read can carry
+            checks++;
+            if (r.peak[a] > o->limit) {
+                fail("%s %s: read of %d counts, limit %d", o->name, axis_names[a],
+                     r.peak[a], o->limit);
+            }
+
+            // Drained: less than one count left after the flush
+            checks++;
+            if (abs64(r.pending[a]) >= MOUSE_MOTION_ONE) {
+                fail("%s %s: %lld/256 counts never read", o->name, axis_names[a],
+                     (long long)r.pending[a]);
+            }
+
+            // The trace's own total, scaled by the flat gain
+            if (trace.has_total && (flat || a == MOUSE_MOTION_WHEEL)) {
+                checks++;
+                int64_t gain = a == MOUSE_MOTION_WHEEL ? MOUSE_MOTION_ONE : o->cfg.sens_min;
+                int64_t want = trace.total[a] * gain;
+                if (r.added[a] + r.clipped[a] != want) {
+                    fail("%s %s: added %lld/256 counts, expected %lld", o->name,
+                         axis_names[a], (long long)(r.added[a] + r.clipped[a]),
+                         (long long)want);
+                }
+            }
+        }
+
+        if (verbose) {
+            printf("%-18s %-9s in %8lld %8lld %5lld  out %7lld %7lld %5lld"
+                   "  left %4lld %4lld  peak %3d %3d  capped %lld %lld\n",
+                   trace.name, o->name,
+                   (long long)(r.added[0] / MOUSE_MOTION_ONE), (long long)(r.added[1] / MOUSE_MOTION_ONE),
+                   (long long)(r.added[2] / MOUSE_MOTION_ONE),
+                   (long long)r.emitted[0], (long long)r.emitted[1], (long long)r.emitted[2],
+                   (long long)r.pending[0], (long long)r.pending[1],
+                   r.peak[0], r.peak[1],
+                   (long long)r.clipped[0], (long long)r.clipped[1]);
+        }
+
+        // The baseline is only comparable at flat gain. Compared as distance
+        // travelled, so motion back and forth doesn't cancel out.
+        if (flat) {
+            printf("%-18s %-9s %4d reads, per-read baseline loses %5.1f%% x %5.1f%% y %5.1f%% wheel\n",
+                   trace.name, o->name, r.reads,
+                   r.travel[0] ? 100.0 * (r.travel[0] - r.legacy[0]) / r.travel[0] : 0.0,
+                   r.travel[1] ? 100.0 * (r.travel[1] - r.legacy[1]) / r.travel[1] : 0.0,
+                   r.travel[2] ? 100.0 * (r.travel[2] - r.legacy[2]) / r.travel[2] : 0.0);
+        }
+    }
+}
+
+// ============================================================================
+// FILES
+// ============================================================================
+
+static bool load_trace(const char* file)
+{
+    FILE* f = fopen(file, "r");
+    if (!f) {
+        perror(file);
+        failures++;
+        return false;
+    }
+
+    memset(&trace, 0, sizeof(trace));
+    const char* base = strrchr(file, '/');
+    snprintf(trace.name, sizeof(trace.name), "%s", base ? base + 1 : file);
+
+    char buf[MAX_LINE];
+    int line = 0;
+    bool ok = true;
+    while (fgets(buf, sizeof(buf), f)) {
+        line++;
+        char* s = buf;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#' || *s == '\n' || *s == '\0') continue;
+
+        long long a, b, c;
+        int dt, dx, dy, wheel = 0;
+        int n;
+        if (sscanf(s, "expect total %lld %lld %lld", &a, &b, &c) == 3) {
+            trace.has_total = true;
+            trace.total[MOUSE_MOTION_X] = a;
+            trace.total[MOUSE_MOTION_Y] = b;
+            trace.total[MOUSE_MOTION_WHEEL] = c;
+        } else if ((n = sscanf(s, "%d %d %d %d", &dt, &dx, &dy, &wheel)) >= 3 && dt > 0) {
+            if (trace.count >= MAX_REPORTS) {
+                fprintf(stderr, "%s:%d: more than %d reports\n", file, line, MAX_REPORTS);
+                ok = false;
+                break;
+            }
+            report_t* rep = &trace.reports[trace.count++];
+            rep->dt_us = (uint32_t)dt;
+            rep->delta[MOUSE_MOTION_X] = (int16_t)dx;
+            rep->delta[MOUSE_MOTION_Y] = (int16_t)dy;
+            rep->delta[MOUSE_MOTION_WHEEL] = (int16_t)(n == 4 ? wheel : 0);
+        } else {
+            fprintf(stderr, "%s:%d: unrecognised line\n", file, line);
+            ok = false;
+        }
+    }
+    fclose(f);
+    if (!ok) failures++;
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        if (opt == 'v') verbose = true;
+        else {
+            fprintf(stderr, "usage: %s [-v] trace.txt...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-v] trace.txt...\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        if (load_trace(argv[i])) run_trace();
+    }
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,346 @@
+// check.c - host check of the MouthPad relay codec
+//
+// Builds mp_relay.c from src/ and scripts one host->device CDC stream:
+// passthrough frames (with and without a destination field, payloads up to
+// the NUS maximum) and the dongle-level reads, mixed with garbage and broken
+// frames (bad CRC, implausible length, lone 0xAA, and frames cut short so the
+// next frame starts inside their declared length). The stream is fed to
+// mp_relay_rx_feed() whole and in chunks, and every request the callback
+// reports is logged.
+//
+// Checks:
+//   - fed whole, the reconstructor reports exactly the well-formed frames, in
+//     order, with their payloads;
+//   - fed in chunks of 1, 3, 64 and 700 bytes, and in random chunks, the log
+//     is identical to the whole feed's;
+//   - mp_relay_encode_to_app() and mp_relay_to_app_header() (with the CRC
+//     continued over the payload) produce the same frame, which parses back
+//     to the payload; the dongle responses are well-formed frames.
+//
+// Usage: mp-relay-check [-v] [-s seed] [-n frames]
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mp_relay.h"
+
+#define MAX_STREAM  (1 << 20)
+#define MAX_LOG     (1 << 20)
+
+static bool verbose;
+static int failures;
+static uint32_t seed = 1;
+static int frames = 400;
+
+typedef struct {
+    uint8_t bytes[MAX_LOG];
+    size_t len;
+    int requests;
+} req_log_t;
+
+static uint8_t stream[MAX_STREAM];
+static size_t stream_len;
+static req_log_t expected, whole, chunked;
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static void log_request(req_log_t* log, mp_relay_req_t type, const uint8_t* data, uint16_t len)
+{
+    if (log->len + 3 + len > MAX_LOG) return;
+    log->bytes[log->len++] = (uint8_t)type;
+    log->bytes[log->len++] = (uint8_t)(len >> 8);
+    log->bytes[log->len++] = (uint8_t)len;
+    if (len) memcpy(log->bytes + log->len, data, len);
+    log->len += len;
+    log->requests++;
+}
+
+static void on_request(mp_relay_req_t type, const uint8_t* data, uint16_t len, void* ctx)
+{
+    log_request(ctx, type, data, len);
+}
+
+// -----------------------------------------------------------------------------
+// Stream script
+// -----------------------------------------------------------------------------
+
+static void put(const uint8_t* p, size_t n)
+{
+    if (stream_len + n > MAX_STREAM) return;
+    memcpy(stream + stream_len, p, n);
+    stream_len += n;
+}
+
+static size_t put_varint(uint8_t* buf, size_t pos, uint32_t v)
+{
+    while (v >= 0x80) {
+        buf[pos++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    buf[pos++] = (uint8_t)v;
+    return pos;
+}
+
+// Frame a protobuf as the utility's PacketFramer does
+static size_t frame(const uint8_t* proto, size_t plen, uint8_t* out)
+{
+    uint16_t crc = mp_relay_crc16(proto, plen);
+    out[0] = 0xAA;
+    out[1] = 0x55;
+    out[2] = (uint8_t)(plen >> 8);
+    out[3] = (uint8_t)plen;
+    memcpy(out + 4, proto, plen);
+    out[4 + plen] = (uint8_t)(crc >> 8);
+    out[5 + plen] = (uint8_t)crc;
+    return plen + 6;
+}
+
+// A random well-formed AppToRelayMessage; logs what the callback should see
+static size_t make_request(uint8_t* proto)
+{
+    size_t p = 0;
+    uint32_t kind = rnd() % 8;
+
+    if (rnd() % 3 == 0) {               // destination (varint field 1)
+        proto[p++] = 0x08;
+        p = put_varint(proto, p, rnd() % 3);
+    }
+    if (kind < 4) {
+        uint8_t data[MP_RELAY_MAX_NUS_PAYLOAD];
+        uint16_t len = (uint16_t)(kind == 0 ? rnd() % (MP_RELAY_MAX_NUS_PAYLOAD + 1) : rnd() % 24);
+        for (uint16_t i = 0; i < len; i++) data[i] = (uint8_t)(rnd() % 4 ? rnd() : 0xAA);
+        size_t inner = 1 + (len >= 0x80 ? 2 : 1) + len;
+        proto[p++] = 0x1A;              // pass_through_to_mouthpad
+        p = put_varint(proto, p, (uint32_t)inner);
+        proto[p++] = 0x0A;              // data
+        p = put_varint(proto, p, len);
+        memcpy(proto + p, data, len);
+        p += len;
+        log_request(&expected, MP_RELAY_REQ_PASSTHROUGH, data, len);
+    } else {
+        static const struct { uint8_t key; mp_relay_req_t type; } reads[] = {
+            { 0x22, MP_RELAY_REQ_DEVICE_INFO_READ },
+            { 0x12, MP_RELAY_REQ_CONN_STATUS_READ },
+            { 0x2A, MP_RELAY_REQ_CLEAR_BONDS },
+            { 0x32, MP_RELAY_REQ_OTHER },
+        };
+        proto[p++] = reads[kind - 4].key;
+        proto[p++] = 0;
+        log_request(&expected, reads[kind - 4].type, NULL, 0);
+    }
+    return p;
+}
+
+// Noise ahead of a frame: garbage, or a frame that's broken some way
+static void make_noise(void)
+{
+    uint8_t buf[MP_RELAY_MAX_FRAME + 64], proto[MP_RELAY_MAX_FRAME];
+    size_t keep_len = expected.len;
+    int keep_requests = expected.requests;
+    size_t n;
+
+    switch (rnd() % 10) {
+        case 0:                         // garbage, 0xAA and 0x55 heavy
+            n = 1 + rnd() % 40;
+            for (size_t i = 0; i < n; i++) {
+                uint32_t r = rnd() % 6;
+                buf[i] = r == 0 ? 0xAA : r == 1 ? 0x55 : (uint8_t)rnd();
+            }
+            put(buf, n);
+            break;
+        case 1:                         // bad CRC
+            n = frame(proto, make_request(proto), buf);
+            buf[n - 1 - rnd() % 2] ^= (uint8_t)(1 + rnd() % 255);
+            put(buf, n);
+            break;
+        case 2:                         // implausible length
+            buf[0] = 0xAA;
+            buf[1] = 0x55;
+            buf[2] = (uint8_t)(0x02 + rnd() % 0xFE);
+            buf[3] = (uint8_t)rnd();
+            put(buf, 4);
+            break;
+        case 3:                         // lone magic byte
+            buf[0] = 0xAA;
+            put(buf, 1);
+            break;
+        case 4:
+        case 5:                         // cut short: the next frame starts inside it
+            n = frame(proto, make_request(proto), buf);
+            put(buf, 4 + rnd() % (n - 5));
+            break;
+        default:
+            break;
+    }
+    expected.len = keep_len;            // none of these are requests
+    expected.requests = keep_requests;
+}
+
+static void make_stream(void)
+{
+    uint8_t buf[MP_RELAY_MAX_FRAME], proto[MP_RELAY_MAX_FRAME];
+
+    stream_len = 0;
+    memset(&expected, 0, sizeof expected);
+    for (int i = 0; i < frames; i++) {
+        make_noise();
+        put(buf, frame(proto, make_request(proto), buf));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Checks
+// -----------------------------------------------------------------------------
+
+// chunk 0 = whole stream, -1 = random chunks
+static void feed(req_log_t* log, int chunk)
+{
+    mp_relay_rx_t rx;
+    size_t pos = 0;
+
+    memset(log, 0, sizeof *log);
+    mp_relay_rx_init(&rx, on_request, log);
+    while (pos < stream_len) {
+        size_t n = chunk > 0 ? (size_t)chunk : chunk < 0 ? 1 + rnd() % 300 : stream_len;
+        if (n > stream_len - pos) n = stream_len - pos;
+        mp_relay_rx_feed(&rx, stream + pos, n);
+        pos += n;
+    }
+}
+
+// Index of the first differing request, or -1
+static int first_difference(const req_log_t* a, const req_log_t* b)
+{
+    size_t pa = 0, pb = 0;
+    for (int i = 0;; i++) {
+        if (pa >= a->len || pb >= b->len) return (pa >= a->len && pb >= b->len) ? -1 : i;
+        size_t la = 3 + ((a->bytes[pa + 1] << 8) | a->bytes[pa + 2]);
+        size_t lb = 3 + ((b->bytes[pb + 1] << 8) | b->bytes[pb + 2]);
+        if (la != lb || memcmp(a->bytes + pa, b->bytes + pb, la) != 0) return i;
+        pa += la;
+        pb += lb;
+    }
+}
+
+static void check_chunks(void)
+{
+    static const int sizes[] = { 1, 3, 64, 700, -1 };
+    int d;
+
+    feed(&whole, 0);
+    if ((d = first_difference(&expected, &whole)) >= 0)
+        fail("whole feed: %d requests, expected %d; first difference at request %d",
+             whole.requests, expected.requests, d);
+
+    for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; i++) {
+        feed(&chunked, sizes[i]);
+        if ((d = first_difference(&whole, &chunked)) >= 0) {
+            if (sizes[i] > 0)
+                fail("%d-byte chunks: %d requests, whole feed %d; first difference at request %d",
+                     sizes[i], chunked.requests, whole.requests, d);
+            else
+                fail("random chunks: %d requests, whole feed %d; first difference at request %d",
+                     chunked.requests, whole.requests, d);
+        }
+        if (verbose) {
+            if (sizes[i] > 0) printf("  %4d-byte chunks: %d requests\n", sizes[i], chunked.requests);
+            else printf("  random chunks:    %d requests\n", chunked.requests);
+        }
+    }
+}
+
+// A device->host frame: magic, length and CRC agree with its size
+static bool well_formed(const uint8_t* f, size_t n)
+{
+    if (n < 6 || f[0] != 0xAA || f[1] != 0x55) return false;
+    size_t plen = ((size_t)f[2] << 8) | f[3];
+    if (plen + 6 != n) return false;
+    return mp_relay_crc16(f + 4, plen) == (((uint16_t)f[4 + plen] << 8) | f[5 + plen]);
+}
+
+static void check_encoders(void)
+{
+    uint8_t payload[MP_RELAY_MAX_NUS_PAYLOAD + 1], out[MP_RELAY_MAX_FRAME], split[MP_RELAY_MAX_FRAME];
+    uint8_t hdr[MP_RELAY_TO_APP_HEADER_MAX];
+
+    for (uint16_t len = 0; len <= MP_RELAY_MAX_NUS_PAYLOAD; len++) {
+        for (uint16_t i = 0; i < len; i++) payload[i] = (uint8_t)rnd();
+        size_t n = mp_relay_encode_to_app(payload, len, out, sizeof out);
+        uint16_t crc;
+        size_t h = mp_relay_to_app_header(len, hdr, &crc);
+        if (!n || !h || h > MP_RELAY_TO_APP_HEADER_MAX) {
+            fail("to_app encode of %u bytes failed", len);
+            continue;
+        }
+        memcpy(split, hdr, h);
+        memcpy(split + h, payload, len);
+        crc = mp_relay_crc16_update(crc, payload, len);
+        split[h + len] = (uint8_t)(crc >> 8);
+        split[h + len + 1] = (uint8_t)crc;
+        if (h + len + 2 != n || memcmp(split, out, n) != 0)
+            fail("to_app header + payload + CRC differs from the whole encode at %u bytes", len);
+        if (!well_formed(out, n) || n - len - 2 != h || memcmp(out + h, payload, len) != 0)
+            fail("to_app frame of %u bytes doesn't carry its payload", len);
+        if (mp_relay_encode_to_app(payload, len, out, n - 1) != 0)
+            fail("to_app encode of %u bytes ignored out_cap", len);
+    }
+    if (mp_relay_encode_to_app(payload, MP_RELAY_MAX_NUS_PAYLOAD + 1, out, sizeof out) != 0)
+        fail("to_app encode accepted an oversized payload");
+
+    mp_relay_device_info_t info = {
+        .name = "MouthPad", .firmware = "1.2.3", .address = "AA:BB:CC:DD:EE:FF",
+        .vid = 0x1915, .pid = 0x520F, .family = MP_RELAY_FAMILY_NRF,
+        .board = MP_RELAY_BOARD_APRBROTHER_NRF52840,
+    };
+    size_t n = mp_relay_encode_device_info(&info, out, sizeof out);
+    if (!well_formed(out, n)) fail("device_info response isn't a well-formed frame");
+    n = mp_relay_encode_conn_status(MP_RELAY_CONN_CONNECTED, -60, 87, out, sizeof out);
+    if (!well_formed(out, n)) fail("conn_status response isn't a well-formed frame");
+    n = mp_relay_encode_clear_bonds_response(true, out, sizeof out);
+    if (!well_formed(out, n)) fail("clear_bonds response isn't a well-formed frame");
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "vs:n:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': frames = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-s seed] [-n frames]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    printf("mp-relay-check seed %u: ", seed);
+    make_stream();
+    printf("%d requests in %zu bytes\n", expected.requests, stream_len);
+    check_chunks();
+    check_encoders();
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,303 @@
+// check.c - compares the PS4 auth CRT engine against mbedTLS on the host
+//
+// Builds ps4_rsa_crt.c from src/ and links it against mbedTLS, configured
+// as the firmware configures it (ps4_mbedtls_config.h, plus key generation).
+// For every key it generates, it loads the CRT engine the way
+// ps4_local_auth.c does (import P, Q, E and let mbedtls_rsa_complete() fill
+// in the rest) and then, for each message:
+//   - runs the CRT engine in slices of one unit, of 1 ms and in one go;
+//   - compares each result with mbedtls_rsa_private();
+//   - checks result^e mod N against the message with mbedtls_rsa_public(),
+//     the fault check the firmware runs before sending.
+//
+// Messages are random values below N plus the edge cases of CRT and Garner
+// recombination: 0, 1, N-1, P, Q and multiples of them. Restarting an
+// operation halfway (the firmware's retry after a failed check) must give
+// the new message's result. Keys whose primes do not fit the engine must be
+// refused.
+//
+// Usage: ps4-rsa-crt-check [-v] [-k keys] [-m messages] [-s seed]
+//   -k  RSA-2048 keys to generate (default 4)
+//   -m  random messages per key (default 16)
+// Exit status 1 if any result differs.
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mbedtls/rsa.h"
+#include "mbedtls/bignum.h"
+#include "ps4_rsa_crt.h"
+
+#define MAX_BYTES 512               // Up to RSA-4096 for the refusal check
+
+static bool verbose;
+static int failures;
+
+// ============================================================================
+// PLATFORM
+// ============================================================================
+
+uint32_t platform_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+// Deterministic byte source for key generation, messages and blinding, so
+// a failing run can be repeated with the same -s
+static uint32_t rng_state;
+
+static uint32_t lcg_next(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+static int rng_fn(void* ctx, unsigned char* out, size_t len)
+{
+    (void)ctx;
+    for (size_t i = 0; i < len; i++) out[i] = (unsigned char)lcg_next();
+    return 0;
+}
+
+// ============================================================================
+// KEYS
+// ============================================================================
+
+// Generate a key, then rebuild it from P, Q and E as ps4_local_auth_init()
+// does, so the CRT engine loads from the same kind of context
+static bool make_key(mbedtls_rsa_context* out, unsigned bits)
+{
+    mbedtls_rsa_context gen;
+    mbedtls_rsa_init(&gen);
+    mbedtls_mpi P, Q, E;
+    mbedtls_mpi_init(&P);
+    mbedtls_mpi_init(&Q);
+    mbedtls_mpi_init(&E);
+
+    int ret = mbedtls_rsa_gen_key(&gen, rng_fn, NULL, bits, 65537);
+    if (ret == 0) ret = mbedtls_rsa_export(&gen, NULL, &P, &Q, NULL, &E);
+
+    mbedtls_rsa_init(out);
+    mbedtls_rsa_set_padding(out, MBEDTLS_RSA_PKCS_V21, MBEDTLS_MD_SHA256);
+    if (ret == 0) ret = mbedtls_rsa_import(out, NULL, &P, &Q, NULL, &E);
+    if (ret == 0) ret = mbedtls_rsa_complete(out);
+    if (ret == 0) ret = mbedtls_rsa_check_privkey(out);
+
+    mbedtls_mpi_free(&P);
+    mbedtls_mpi_free(&Q);
+    mbedtls_mpi_free(&E);
+    mbedtls_rsa_free(&gen);
+    if (ret != 0) {
+        printf("  FAIL: %u-bit key generation/import returned -0x%04X\n", bits, (unsigned)-ret);
+        failures++;
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// MESSAGES
+// ============================================================================
+
+typedef struct {
+    char    what[32];
+    uint8_t m[MAX_BYTES];
+} message_t;
+
+static void mpi_message(message_t* msg, const char* what, const mbedtls_mpi* x, size_t len)
+{
+    snprintf(msg->what, sizeof(msg->what), "%s", what);
+    mbedtls_mpi_write_binary(x, msg->m, len);
+}
+
+// Edge cases: 0, 1, N-1, P, Q, 2P, N-Q; then random values below N
+static int build_messages(const mbedtls_rsa_context* rsa, message_t* msgs, int random_count)
+{
+    size_t len = mbedtls_rsa_get_len(rsa);
+    mbedtls_mpi N, P, Q, t;
+    mbedtls_mpi_init(&N);
+    mbedtls_mpi_init(&P);
+    mbedtls_mpi_init(&Q);
+    mbedtls_mpi_init(&t);
+    mbedtls_rsa_export(rsa, &N, &P, &Q, NULL, NULL);
+
+    int n = 0;
+    mbedtls_mpi_lset(&t, 0);                 mpi_message(&msgs[n++], "0", &t, len);
+    mbedtls_mpi_lset(&t, 1);                 mpi_message(&msgs[n++], "1", &t, len);
+    mbedtls_mpi_sub_int(&t, &N, 1);          mpi_message(&msgs[n++], "N-1", &t, len);
+    mpi_message(&msgs[n++], "P", &P, len);
+    mpi_message(&msgs[n++], "Q", &Q, len);
+    mbedtls_mpi_add_mpi(&t, &P, &P);         mpi_message(&msgs[n++], "2P", &t, len);
+    mbedtls_mpi_sub_mpi(&t, &N, &Q);         mpi_message(&msgs[n++], "N-Q", &t, len);
+
+    for (int i = 0; i < random_count; i++) {
+        do {
+            rng_fn(NULL, msgs[n].m, len);
+            mbedtls_mpi_read_binary(&t, msgs[n].m, len);
+        } while (mbedtls_mpi_cmp_mpi(&t, &N) >= 0);
+        snprintf(msgs[n].what, sizeof(msgs[n].what), "random %d", i);
+        n++;
+    }
+
+    mbedtls_mpi_free(&N);
+    mbedtls_mpi_free(&P);
+    mbedtls_mpi_free(&Q);
+    mbedtls_mpi_free(&t);
+    return n;
+}
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+typedef struct {
+    uint64_t crt_us;
+    uint64_t mbedtls_us;
+    uint32_t ops;
+    uint32_t max_steps;
+} timing_t;
+
+// Run the engine to completion; returns the number of step calls
+static uint32_t crt_run(const uint8_t* m, uint8_t* out, size_t len, uint32_t budget_us)
+{
+    ps4_rsa_crt_start(m, len);
+    uint32_t steps = 1;
+    while (!ps4_rsa_crt_step(budget_us)) steps++;
+    ps4_rsa_crt_result(out, len);
+    return steps;
+}
+
+static void check_message(mbedtls_rsa_context* rsa, const message_t* msg, timing_t* t)
+{
+    size_t len = mbedtls_rsa_get_len(rsa);
+    uint8_t want[MAX_BYTES], got[MAX_BYTES], back[MAX_BYTES];
+
+    uint32_t t0 = platform_time_us();
+    int ret = mbedtls_rsa_private(rsa, rng_fn, NULL, msg->m, want);
+    t->mbedtls_us += platform_time_us() - t0;
+    if (ret != 0) {
+        printf("  FAIL %s: mbedtls_rsa_private returned -0x%04X\n", msg->what, (unsigned)-ret);
+        failures++;
+        return;
+    }
+
+    // Firmware budgets: one unit per call, a Core 0 slice, all at once
+    static const struct { uint32_t budget_us; const char* name; } runs[] = {
+        { 0, "1 unit" }, { 1000, "1 ms" }, { UINT32_MAX, "one go" },
+    };
+    for (size_t r = 0; r < sizeof(runs) / sizeof(runs[0]); r++) {
+        t0 = platform_time_us();
+        uint32_t steps = crt_run(msg->m, got, len, runs[r].budget_us);
+        if (runs[r].budget_us == UINT32_MAX) {
+            t->crt_us += platform_time_us() - t0;
+            t->ops++;
+        }
+        if (runs[r].budget_us == 0 && steps > t->max_steps) t->max_steps = steps;
+
+        if (memcmp(got, want, len) != 0) {
+            printf("  FAIL %s (%s): CRT result differs from mbedtls_rsa_private\n",
+                   msg->what, runs[r].name);
+            failures++;
+            return;
+        }
+    }
+
+    // The firmware's fault check: s^e mod N must give the message back
+    if (mbedtls_rsa_public(rsa, got, back) != 0 || memcmp(back, msg->m, len) != 0) {
+        printf("  FAIL %s: s^e mod N is not the message\n", msg->what);
+        failures++;
+    }
+    if (verbose) printf("  %-10s ok\n", msg->what);
+}
+
+// A new start() halfway through an operation must give the new message's
+// result, as the firmware's recompute after a failed check relies on
+static void check_restart(const message_t* a, const message_t* b, size_t len)
+{
+    uint8_t want[MAX_BYTES], got[MAX_BYTES];
+    crt_run(b->m, want, len, UINT32_MAX);
+
+    ps4_rsa_crt_start(a->m, len);
+    for (int i = 0; i < 100; i++) ps4_rsa_crt_step(0);
+    crt_run(b->m, got, len, 0);
+    if (memcmp(got, want, len) != 0) {
+        printf("  FAIL restart: %s started over %s gives a different result\n", b->what, a->what);
+        failures++;
+    }
+}
+
+static void check_key(unsigned bits, int random_count)
+{
+    mbedtls_rsa_context rsa;
+    if (!make_key(&rsa, bits)) return;
+
+    if (!ps4_rsa_crt_load(&rsa)) {
+        printf("  FAIL: %u-bit key refused by ps4_rsa_crt_load\n", bits);
+        failures++;
+        mbedtls_rsa_free(&rsa);
+        return;
+    }
+
+    static message_t msgs[7 + 256];
+    int n = build_messages(&rsa, msgs, random_count > 256 ? 256 : random_count);
+    timing_t t = {0};
+    for (int i = 0; i < n; i++) check_message(&rsa, &msgs[i], &t);
+    if (n > 8) check_restart(&msgs[7], &msgs[8], mbedtls_rsa_get_len(&rsa));
+
+    printf("  %u-bit: %d messages, crt %.2f ms, mbedtls %.2f ms, %u steps at one unit each\n",
+           bits, n, t.ops ? t.crt_us / 1000.0 / t.ops : 0.0,
+           n ? t.mbedtls_us / 1000.0 / n : 0.0, t.max_steps);
+
+    ps4_rsa_crt_clear();
+    mbedtls_rsa_free(&rsa);
+}
+
+// Primes wider than 1024 bits don't fit the engine; the caller keeps mbedTLS
+static void check_refused(unsigned bits)
+{
+    mbedtls_rsa_context rsa;
+    if (!make_key(&rsa, bits)) return;
+    if (ps4_rsa_crt_load(&rsa) || ps4_rsa_crt_is_loaded()) {
+        printf("  FAIL: %u-bit key accepted, its primes don't fit\n", bits);
+        failures++;
+    } else {
+        printf("  %u-bit: refused\n", bits);
+    }
+    ps4_rsa_crt_clear();
+    mbedtls_rsa_free(&rsa);
+}
+
+int main(int argc, char** argv)
+{
+    int keys = 4, random_count = 16;
+    rng_state = 0x5041;
+    int opt;
+    while ((opt = getopt(argc, argv, "vk:m:s:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 'k': keys = atoi(optarg); break;
+            case 'm': random_count = atoi(optarg); break;
+            case 's': rng_state = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-k keys] [-m messages] [-s seed]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    printf("seed 0x%X\n", rng_state);
+    for (int k = 0; k < keys; k++) check_key(2048, random_count);
+    check_key(1024, random_count);      // Narrower primes load too
+    check_refused(3072);
+    check_refused(4096);
+
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
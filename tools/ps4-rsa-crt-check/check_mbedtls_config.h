@@ -0,0 +1,11 @@
+// check_mbedtls_config.h - the firmware's mbedTLS configuration plus the
+// prime generation the check needs to make its own keys
+
+#ifndef CHECK_MBEDTLS_CONFIG_H
+#define CHECK_MBEDTLS_CONFIG_H
+
+#include "ps4_mbedtls_config.h"
+
+#define MBEDTLS_GENPRIME
+
+#endif
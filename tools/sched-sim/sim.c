@@ -0,0 +1,543 @@
+// sim.c - host simulation of the Core 0 budgeted scheduler
+//
+// Builds sched.c from src/ and drives it on a simulated microsecond clock.
+// Each scenario registers synthetic tasks shaped after the main loop's
+// (inputs and outputs on the hot path, the app, player feedback, a display
+// flush split into steps, LEDs, storage), each with a scripted cost range
+// and occasional spikes. A task's run or step advances the clock by its
+// cost. Input events arrive at random times; the input task picks them up
+// and the output task that follows in the same pass delivers them.
+//
+// Checks:
+//   - the gap between hot-path runs never exceeds the bound in sched.h: hot
+//     path + pass budget + two of the longest non-hot runs, and the
+//     scheduler's own hot_gap_max_us is the gap the simulation measured;
+//   - every input event reaches the output within that gap plus one hot
+//     path;
+//   - no due task waits more than SCHED_MAX_DEFERRALS passes plus one per
+//     other non-hot task, even when non-hot work exceeds the budget every
+//     pass;
+//   - periodic tasks never run more often than their period and, when the
+//     budget allows, keep their rate; a budgeted step task stops within its
+//     budget plus one step, and one without a budget takes one step a pass;
+//   - per-task runs, max and total time, overruns and the pass count match
+//     the scheduler's statistics;
+//   - the clock wraps 32 bits early in every run.
+//
+// Usage: sched-sim [-v] [-s seed] [-t sim_ms] scenario
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "core/sched.h"
+#include "pico/stdlib.h"
+
+static bool verbose;
+static int failures;
+static uint32_t seed = 1;
+static uint32_t sim_ms = 3000;
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static uint32_t rnd_range(uint32_t lo, uint32_t hi)
+{
+    return hi > lo ? lo + rnd() % (hi - lo + 1) : lo;
+}
+
+// ============================================================================
+// SIMULATED CLOCK
+// ============================================================================
+
+// Starts just short of the 32-bit wrap so every run crosses it
+#define CLOCK_START 0xFFFF0000u
+
+static uint64_t clock_us;
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)clock_us;
+}
+
+// ============================================================================
+// TASK MODELS
+// ============================================================================
+
+typedef struct {
+    const char*   name;
+    sched_class_t cls;
+    uint8_t       priority;
+    uint32_t      period_us;
+    uint32_t      budget_us;
+    uint32_t      cost_min, cost_max;   // Per run, or per step for step tasks
+    uint32_t      spike_us;             // Occasional long run instead
+    uint32_t      spike_one_in;         // 1 in N runs (0 = never)
+    uint32_t      work_every_us;        // Step task: a job arrives this often...
+    uint16_t      work_steps;           // ...with this many steps (0 = run task)
+} model_t;
+
+#define MAX_MODELS 12
+
+enum {
+    LOAD_FITS,      // Non-hot work fits the pass budget
+    LOAD_TIGHT,     // Often past the budget: periodic tasks may lose rate
+    LOAD_OVER,      // Past the budget every pass
+};
+
+typedef struct {
+    const char* name;
+    const char* about;
+    uint8_t     load;
+    model_t     tasks[MAX_MODELS];
+} scenario_t;
+
+// Costs follow the main loop on an RP2040: host/device USB tasks of tens
+// of microseconds, an app task up to its budget, a 300 us display step
+// budget with ~60 us page writes, and storage that occasionally erases.
+static const scenario_t scenarios[] = {
+    { "idle", "main-loop tasks at rest", LOAD_FITS, {
+        { "input",   SCHED_HOT,        0, 0,     0,    5,  15 },
+        { "output",  SCHED_HOT,       64, 0,     0,   10,  30 },
+        { "app",     SCHED_NORMAL,     0, 0,     1000, 5,  20 },
+        { "players", SCHED_NORMAL,     1, 1000,  0,    5,  10 },
+        { "display", SCHED_NORMAL,     2, 0,     300,  50, 70, 0, 0, 50000, 16 },
+        { "leds",    SCHED_BACKGROUND, 0, 2000,  0,    5,  20 },
+        { "storage", SCHED_BACKGROUND, 1, 10000, 0,    5,  10 },
+    } },
+    { "loop", "main-loop tasks with a playing controller", LOAD_FITS, {
+        { "input",   SCHED_HOT,        0, 0,     0,    10, 60 },
+        { "input2",  SCHED_HOT,        1, 0,     0,    5,  20 },
+        { "output",  SCHED_HOT,       64, 0,     0,    20, 80 },
+        { "app",     SCHED_NORMAL,     0, 0,     1000, 50, 250 },
+        { "players", SCHED_NORMAL,     1, 1000,  0,    10, 40 },
+        { "display", SCHED_NORMAL,     2, 0,     300,  50, 70, 0, 0, 50000, 16 },
+        { "leds",    SCHED_BACKGROUND, 0, 2000,  0,    10, 30 },
+        { "storage", SCHED_BACKGROUND, 1, 10000, 0,    5,  15 },
+    } },
+    { "busy", "heavy app and a display redrawn every 20 ms", LOAD_TIGHT, {
+        { "input",   SCHED_HOT,        0, 0,     0,    10, 60 },
+        { "output",  SCHED_HOT,       64, 0,     0,    20, 80 },
+        { "app",     SCHED_NORMAL,     0, 0,     1000, 200, 700 },
+        { "players", SCHED_NORMAL,     1, 1000,  0,    10, 40 },
+        { "display", SCHED_NORMAL,     2, 0,     300,  50, 70, 0, 0, 20000, 16 },
+        { "leds",    SCHED_BACKGROUND, 0, 2000,  0,    10, 30 },
+        { "storage", SCHED_BACKGROUND, 1, 10000, 0,    5,  15 },
+    } },
+    { "spikes", "rare long runs: app stalls and a storage erase", LOAD_TIGHT, {
+        { "input",   SCHED_HOT,        0, 0,     0,    10, 60,  250,   200 },
+        { "output",  SCHED_HOT,       64, 0,     0,    20, 80 },
+        { "app",     SCHED_NORMAL,     0, 0,     1000, 50, 250, 3000,  150 },
+        { "players", SCHED_NORMAL,     1, 1000,  0,    10, 40 },
+        { "display", SCHED_NORMAL,     2, 0,     0,    50, 70, 0, 0, 50000, 16 },
+        { "leds",    SCHED_BACKGROUND, 0, 2000,  0,    10, 30 },
+        { "storage", SCHED_BACKGROUND, 1, 10000, 0,    5,  15, 45000, 40 },
+    } },
+    { "overload", "more non-hot work than the budget, every pass", LOAD_OVER, {
+        { "input",   SCHED_HOT,        0, 0,     0,    10, 40 },
+        { "output",  SCHED_HOT,       64, 0,     0,    20, 60 },
+        { "app",     SCHED_NORMAL,     0, 0,     1000, 300, 600 },
+        { "players", SCHED_NORMAL,     1, 0,     0,    200, 400 },
+        { "display", SCHED_NORMAL,     2, 0,     300,  50, 70, 0, 0, 5000, 16 },
+        { "task3",   SCHED_NORMAL,     3, 0,     0,    200, 400 },
+        { "task4",   SCHED_NORMAL,     4, 0,     0,    200, 400 },
+        { "task5",   SCHED_NORMAL,     5, 0,     0,    200, 400 },
+        { "leds",    SCHED_BACKGROUND, 0, 2000,  0,    100, 300 },
+        { "bg2",     SCHED_BACKGROUND, 1, 0,     0,    100, 300 },
+        { "storage", SCHED_BACKGROUND, 2, 10000, 0,    50,  150 },
+    } },
+};
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static const scenario_t* scn;
+static uint8_t model_count;
+static int input_model = -1;    // "input": first on the hot path
+static int output_model = -1;   // "output": last on the hot path
+
+// What the simulation saw of each task
+typedef struct {
+    uint32_t runs;              // Scheduler runs (consecutive steps are one run)
+    uint32_t steps;             // Steps taken, or runs for a run task
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t overruns;
+    uint32_t run_start;
+    uint32_t run_steps;         // Steps in the current run
+    uint32_t max_run_steps;
+    uint32_t pending;           // Step task: steps still to do
+    uint32_t pending_max;
+    uint64_t next_work_us;      // Step task: next job arrival
+    uint32_t jobs;
+    uint8_t  max_deferred;
+} seen_t;
+
+static seen_t seen[MAX_MODELS];
+static int current = -1;        // Model whose run is in progress
+
+static uint32_t step_cost_max(const model_t* m)
+{
+    return m->cost_max > m->spike_us ? m->cost_max : m->spike_us;
+}
+
+// A run or step is starting: close the previous task's run
+static void begin(int i)
+{
+    if (current == i) return;
+    if (current >= 0) {
+        seen_t* p = &seen[current];
+        uint32_t took = time_us_32() - p->run_start;
+        p->runs++;
+        p->total_us += took;
+        if (took > p->max_us) p->max_us = took;
+        if (scn->tasks[current].budget_us && took > scn->tasks[current].budget_us) p->overruns++;
+        if (p->run_steps > p->max_run_steps) p->max_run_steps = p->run_steps;
+    }
+    current = i;
+    if (i >= 0) {
+        seen[i].run_start = time_us_32();
+        seen[i].run_steps = 0;
+    }
+}
+
+static uint32_t cost(const model_t* m)
+{
+    if (m->spike_one_in && rnd() % m->spike_one_in == 0) return m->spike_us;
+    return rnd_range(m->cost_min, m->cost_max);
+}
+
+// ============================================================================
+// INPUT EVENTS
+// ============================================================================
+
+#define MAX_EVENTS 4096
+
+static uint64_t next_event_us;
+static uint64_t waiting[MAX_EVENTS];    // Arrived or not, not yet picked up
+static uint32_t waiting_count;
+static uint64_t picked[MAX_EVENTS];     // Picked up this pass, not yet sent
+static uint32_t picked_count;
+static uint32_t* latencies;
+static uint32_t latency_count;
+static uint32_t latency_cap;
+
+static void events_arrive_until(uint64_t t)
+{
+    while (next_event_us <= t && waiting_count < MAX_EVENTS) {
+        waiting[waiting_count++] = next_event_us;
+        next_event_us += rnd_range(100, 2000);
+    }
+}
+
+static void input_poll(void)
+{
+    events_arrive_until(clock_us);
+    uint32_t keep = 0;
+    for (uint32_t e = 0; e < waiting_count; e++) {
+        if (waiting[e] <= clock_us && picked_count < MAX_EVENTS) picked[picked_count++] = waiting[e];
+        else waiting[keep++] = waiting[e];
+    }
+    waiting_count = keep;
+}
+
+static void output_sent(void)
+{
+    for (uint32_t e = 0; e < picked_count; e++) {
+        if (latency_count == latency_cap) {
+            latency_cap = latency_cap ? latency_cap * 2 : 4096;
+            latencies = realloc(latencies, latency_cap * sizeof(*latencies));
+        }
+        latencies[latency_count++] = (uint32_t)(clock_us - picked[e]);
+    }
+    picked_count = 0;
+}
+
+// ============================================================================
+// TASK ENTRY POINTS
+// ============================================================================
+
+static uint64_t hot_last_us;
+static uint32_t hot_gap_max;
+static uint32_t hot_runs;
+
+static void sim_run(int i)
+{
+    const model_t* m = &scn->tasks[i];
+    begin(i);
+    if (i == input_model) {
+        if (hot_runs && clock_us - hot_last_us > hot_gap_max)
+            hot_gap_max = (uint32_t)(clock_us - hot_last_us);
+        hot_last_us = clock_us;
+        hot_runs++;
+        input_poll();
+    }
+    clock_us += cost(m);
+    if (i == output_model) output_sent();
+    seen[i].steps++;
+    seen[i].run_steps++;
+}
+
+static bool sim_step(int i)
+{
+    const model_t* m = &scn->tasks[i];
+    seen_t* s = &seen[i];
+    begin(i);
+    while (s->next_work_us <= clock_us) {
+        s->pending += m->work_steps;
+        s->next_work_us += m->work_every_us;
+        s->jobs++;
+    }
+    if (s->pending > s->pending_max) s->pending_max = s->pending;
+    s->run_steps++;
+    if (s->pending == 0) {
+        clock_us += 1;
+        return false;
+    }
+    clock_us += cost(m);
+    s->pending--;
+    s->steps++;
+    return s->pending > 0;
+}
+
+#define THUNKS(n) \
+    static void run##n(void) { sim_run(n); } \
+    static bool step##n(void) { return sim_step(n); }
+THUNKS(0) THUNKS(1) THUNKS(2) THUNKS(3) THUNKS(4) THUNKS(5)
+THUNKS(6) THUNKS(7) THUNKS(8) THUNKS(9) THUNKS(10) THUNKS(11)
+
+static void (*const run_fns[MAX_MODELS])(void) = {
+    run0, run1, run2, run3, run4, run5, run6, run7, run8, run9, run10, run11,
+};
+static bool (*const step_fns[MAX_MODELS])(void) = {
+    step0, step1, step2, step3, step4, step5, step6, step7, step8, step9, step10, step11,
+};
+
+// ============================================================================
+// SIMULATION
+// ============================================================================
+
+static int cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static const model_t* model_of(const sched_task_t* t)
+{
+    for (uint8_t i = 0; i < model_count; i++) {
+        if (strcmp(scn->tasks[i].name, t->name) == 0) return &scn->tasks[i];
+    }
+    return NULL;
+}
+
+static void simulate(void)
+{
+    // Register in reverse so sched_add() has to sort by class and priority
+    uint8_t nonhot = 0;
+    for (int i = model_count - 1; i >= 0; i--) {
+        const model_t* m = &scn->tasks[i];
+        sched_task_t t = {
+            .name = m->name, .cls = m->cls, .priority = m->priority,
+            .period_us = m->period_us, .budget_us = m->budget_us,
+        };
+        if (m->work_steps) t.step = step_fns[i];
+        else t.run = run_fns[i];
+        if (!sched_add(&t)) fail("sched_add refused %s", m->name);
+        if (m->cls != SCHED_HOT) nonhot++;
+        seen[i].next_work_us = clock_us;
+    }
+    next_event_us = clock_us + rnd_range(0, 500);
+
+    for (uint8_t k = 1; k < sched_task_count(); k++) {
+        const sched_task_t* a = sched_get_task(k - 1);
+        const sched_task_t* b = sched_get_task(k);
+        if (a->cls > b->cls || (a->cls == b->cls && a->priority > b->priority))
+            fail("task table out of order at %s, %s", a->name, b->name);
+    }
+
+    // Bounds from the models (see sched.h)
+    uint32_t hot_max = 0, longest = 0;
+    for (uint8_t i = 0; i < model_count; i++) {
+        const model_t* m = &scn->tasks[i];
+        uint32_t c = step_cost_max(m);
+        if (m->cls == SCHED_HOT) {
+            hot_max += c;
+            continue;
+        }
+        uint32_t run_max = c;
+        if (m->work_steps && m->budget_us) {
+            uint32_t window = m->budget_us < SCHED_PASS_BUDGET_US ? m->budget_us : SCHED_PASS_BUDGET_US;
+            run_max = window + c;
+        }
+        if (run_max > longest) longest = run_max;
+    }
+    uint32_t gap_bound = hot_max + SCHED_PASS_BUDGET_US + 2 * longest;
+    uint32_t latency_bound = gap_bound + hot_max;
+    uint32_t deferral_bound = SCHED_MAX_DEFERRALS + nonhot - 1;
+
+    uint64_t end = clock_us + (uint64_t)sim_ms * 1000;
+    uint64_t start = clock_us;
+    uint32_t passes = 0;
+    while (clock_us < end) {
+        sched_run_pass();
+        begin(-1);
+        passes++;
+        for (uint8_t k = 0; k < sched_task_count(); k++) {
+            const sched_task_t* t = sched_get_task(k);
+            const model_t* m = model_of(t);
+            if (!m) continue;
+            seen_t* s = &seen[m - scn->tasks];
+            if (t->deferred > s->max_deferred) s->max_deferred = t->deferred;
+        }
+    }
+    uint64_t span = clock_us - start;
+
+    // Hot path and latency
+    sched_stats_t st;
+    sched_get_stats(&st);
+    if (st.passes != passes) fail("scheduler counted %u passes, ran %u", st.passes, passes);
+    if (hot_gap_max > gap_bound)
+        fail("hot path gap %u us exceeds the bound %u us", hot_gap_max, gap_bound);
+    if (st.hot_gap_max_us != hot_gap_max)
+        fail("scheduler reports hot gap %u us, measured %u us", st.hot_gap_max_us, hot_gap_max);
+
+    if (latency_count == 0) {
+        fail("no input event reached the output");
+    } else {
+        qsort(latencies, latency_count, sizeof(*latencies), cmp_u32);
+        uint32_t p50 = latencies[(latency_count - 1) / 2];
+        uint32_t p99 = latencies[(latency_count - 1) * 99 / 100];
+        uint32_t worst = latencies[latency_count - 1];
+        if (worst > latency_bound)
+            fail("input latency %u us exceeds the bound %u us", worst, latency_bound);
+        printf("  %u passes, %u events: latency p50 %u  p99 %u  max %u us (bound %u); "
+               "hot gap max %u us (bound %u)\n",
+               passes, latency_count, p50, p99, worst, latency_bound, hot_gap_max, gap_bound);
+    }
+
+    // Per task
+    for (uint8_t k = 0; k < sched_task_count(); k++) {
+        const sched_task_t* t = sched_get_task(k);
+        const model_t* m = model_of(t);
+        if (!m) {
+            fail("unknown task %s", t->name);
+            continue;
+        }
+        seen_t* s = &seen[m - scn->tasks];
+
+        if (t->stats.runs != s->runs || t->stats.max_us != s->max_us ||
+            t->stats.total_us != s->total_us || t->stats.overruns != s->overruns)
+            fail("%s: stats runs %u max %u total %llu overruns %u, "
+                 "seen %u / %u / %llu / %u", t->name,
+                 t->stats.runs, t->stats.max_us, (unsigned long long)t->stats.total_us,
+                 t->stats.overruns, s->runs, s->max_us, (unsigned long long)s->total_us,
+                 s->overruns);
+
+        if (m->cls == SCHED_HOT) {
+            if (s->runs != passes) fail("%s: ran %u times in %u passes", t->name, s->runs, passes);
+            continue;
+        }
+
+        if (s->runs == 0) fail("%s: never ran", t->name);
+        if (s->max_deferred > deferral_bound)
+            fail("%s: waited %u passes, bound %u", t->name, s->max_deferred, deferral_bound);
+
+        if (m->period_us) {
+            uint32_t most = (uint32_t)(span / m->period_us) + 1;
+            if (s->runs > most)
+                fail("%s: %u runs in %llu us, period allows %u", t->name, s->runs,
+                     (unsigned long long)span, most);
+            if (scn->load == LOAD_FITS && s->runs < most - most / 50 - 1)
+                fail("%s: %u runs in %llu us, expected about %u", t->name, s->runs,
+                     (unsigned long long)span, most);
+        }
+
+        if (m->work_steps) {
+            if (m->budget_us && s->max_us > m->budget_us + step_cost_max(m))
+                fail("%s: a run took %u us, budget %u us plus one step", t->name, s->max_us,
+                     m->budget_us);
+            if (!m->budget_us && s->max_run_steps > 1)
+                fail("%s: unbudgeted step task took %u steps in one run", t->name, s->max_run_steps);
+            if (scn->load != LOAD_OVER && s->pending_max > 2u * m->work_steps)
+                fail("%s: %u steps backed up, jobs are %u steps", t->name, s->pending_max,
+                     m->work_steps);
+        }
+
+        if (verbose)
+            printf("    %-8s runs %-6u max %-6u mean %-5llu overruns %-4u deferrals %-6u "
+                   "max wait %u\n", t->name, t->stats.runs, t->stats.max_us,
+                   (unsigned long long)(t->stats.runs ? t->stats.total_us / t->stats.runs : 0),
+                   t->stats.overruns, t->stats.deferrals, s->max_deferred);
+    }
+
+    // Reset clears the counters and restarts gap tracking
+    sched_reset_stats();
+    sched_get_stats(&st);
+    if (st.passes || st.hot_gap_max_us || sched_get_task(0)->stats.runs)
+        fail("sched_reset_stats left counters set");
+    clock_us += 100000;
+    sched_run_pass();
+    begin(-1);
+    sched_get_stats(&st);
+    if (st.hot_gap_max_us != 0) fail("first pass after reset counted a %u us gap", st.hot_gap_max_us);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "vs:t:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 't': sim_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-s seed] [-t sim_ms] scenario\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-v] [-s seed] [-t sim_ms] scenario\nscenarios:\n", argv[0]);
+        for (size_t i = 0; i < SCENARIO_COUNT; i++)
+            fprintf(stderr, "  %-9s %s\n", scenarios[i].name, scenarios[i].about);
+        return 2;
+    }
+    for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+        if (strcmp(scenarios[i].name, argv[optind]) == 0) scn = &scenarios[i];
+    }
+    if (!scn) {
+        fprintf(stderr, "unknown scenario %s\n", argv[optind]);
+        return 2;
+    }
+    while (model_count < MAX_MODELS && scn->tasks[model_count].name) {
+        if (strcmp(scn->tasks[model_count].name, "input") == 0) input_model = model_count;
+        if (strcmp(scn->tasks[model_count].name, "output") == 0) output_model = model_count;
+        model_count++;
+    }
+
+    printf("sched-sim %s seed %u\n", scn->name, seed);
+    clock_us = CLOCK_START;
+    simulate();
+
+    free(latencies);
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,13 @@
+// Minimal pico/stdlib.h for the host build of sched.c. time_us_32() is the
+// simulated clock in sim.c, and nothing is placed in RAM on the host.
+#ifndef PICO_STDLIB_H
+#define PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define __not_in_flash_func(func_name) func_name
+
+uint32_t time_us_32(void);
+
+#endif
@@ -0,0 +1,69 @@
+// cdc_frame.h - Joypad CDC command framing shared by latency.c and loopback.c.
+// Frame: [0xAA][len:2 LE][type:1][seq:1][payload][crc:2 LE]
+// CRC-16-CCITT (poly 0x1021, init 0xFFFF) over type+seq+payload.
+
+#ifndef CDC_FRAME_H
+#define CDC_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CDC_SYNC        0xAA
+#define CDC_MSG_CMD     0x01
+#define CDC_MSG_RSP     0x02
+#define CDC_MAX_PAYLOAD 1024
+
+static inline uint16_t cdc_crc16(uint16_t crc, const uint8_t *d, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        crc ^= (uint16_t)d[i] << 8;
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
+}
+
+// Build a frame into out (at least len + 7 bytes). Returns the frame length.
+static inline size_t cdc_frame_build(uint8_t *out, uint8_t type, uint8_t seq,
+                                     const char *payload, size_t len) {
+    out[0] = CDC_SYNC;
+    out[1] = len & 0xFF;
+    out[2] = (len >> 8) & 0xFF;
+    out[3] = type;
+    out[4] = seq;
+    memcpy(out + 5, payload, len);
+    uint16_t crc = cdc_crc16(0xFFFF, out + 3, 2 + len);
+    out[5 + len] = crc & 0xFF;
+    out[6 + len] = (crc >> 8) & 0xFF;
+    return len + 7;
+}
+
+// Find the next complete, CRC-valid frame in buf[0..*got). Bytes before it
+// (and any corrupt frame) are dropped. On success the frame is copied out,
+// consumed from buf and 1 is returned; 0 means more data is needed.
+static inline int cdc_frame_next(uint8_t *buf, size_t *got, uint8_t *type,
+                                 uint8_t *seq, char *payload, size_t *len) {
+    size_t p = 0;
+    int found = 0;
+    while (p + 7 <= *got) {
+        if (buf[p] != CDC_SYNC) { p++; continue; }
+        size_t n = buf[p + 1] | (buf[p + 2] << 8);
+        if (n > CDC_MAX_PAYLOAD) { p++; continue; }
+        if (p + 7 + n > *got) break;
+        uint16_t crc = buf[p + 5 + n] | (buf[p + 6 + n] << 8);
+        if (cdc_crc16(0xFFFF, buf + p + 3, 2 + n) != crc) { p++; continue; }
+        *type = buf[p + 3];
+        *seq = buf[p + 4];
+        memcpy(payload, buf + p + 5, n);
+        payload[n] = '\0';
+        *len = n;
+        p += 7 + n;
+        found = 1;
+        break;
+    }
+    memmove(buf, buf + p, *got - p);
+    *got -= p;
+    return found;
+}
+
+#endif
@@ -0,0 +1,566 @@
+// latency.c - closed-loop input-to-report latency measurement (Linux).
+//
+// Sends timestamped INPUT.INJECT press/release bursts over the Joypad CDC
+// port and timestamps the matching HID input reports read straight from
+// hidraw (no SDL event queue in between). Latency is host send -> report
+// readable on the host, so it covers CDC OUT, the router, the output mode's
+// report path and the USB polling interval.
+//
+// Matching is report-format agnostic, so it works for any USB output mode
+// with a HID interface: a calibration window records the idle report and
+// masks bytes that change on their own (IMU, timestamps, stick noise); a
+// press is the first report differing from idle in a stable byte, a release
+// the first report matching idle again.
+//
+// INPUT.INJECT is OR'd into real input events in the router, so an input
+// device must be connected (and left alone) while measuring.
+//
+// Usage: sinput-latency --cdc <tty> [--hidraw <dev>] [options]
+//   --count N          press/release cycles per mode (default 200)
+//   --gap-ms N         base gap between edges; a random 0..N ms is added
+//                      so edges don't lock to the polling interval (20)
+//   --timeout-ms N     edge counts as lost after this long (250)
+//   --button MASK      JP_BUTTON_* mask to inject (0x1, B1)
+//   --modes A,B,...    USB output modes to sweep via MODE.SET (default:
+//                      the current mode only)
+//   --interval-us N    polling interval when sysfs can't tell (FIFO/loopback)
+//   --csv FILE         one row per edge
+//   --json FILE        per-mode distributions
+//
+// The hidraw node is found from the CDC tty's USB device when --hidraw is
+// omitted. Use a /dev/serial/by-id path for --cdc when sweeping modes, as
+// the device re-enumerates after each MODE.SET.
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <limits.h>
+#include <math.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cdc_frame.h"
+
+#define MAX_REPORT      64
+#define MAX_MODES       24
+#define CALIB_MS        300
+#define ENUM_TIMEOUT_MS 10000
+
+typedef struct {
+    const char *cdc_path;
+    const char *hidraw_path;
+    int count;
+    int gap_ms;
+    int timeout_ms;
+    uint32_t button;
+    int modes[MAX_MODES];
+    int mode_count;
+    uint32_t interval_us;
+    const char *csv_path;
+    const char *json_path;
+} opts_t;
+
+typedef struct {
+    int64_t *us;        // -1 = lost
+    int n;
+} edge_samples_t;
+
+typedef struct {
+    int mode;
+    char name[32];
+    uint32_t interval_us;
+    char speed[16];
+    edge_samples_t press, release;
+} run_t;
+
+static int cdc_fd = -1, hid_fd = -1;
+static uint8_t cdc_seq;
+static uint8_t cdc_rx[4096];
+static size_t cdc_rx_len;
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// ============================================================================
+// CDC
+// ============================================================================
+
+static int cdc_open(const char *path) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) return -1;
+    struct termios t;
+    if (tcgetattr(fd, &t) == 0) {
+        cfmakeraw(&t);
+        cfsetspeed(&t, 115200);
+        t.c_cc[VMIN] = 0; t.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &t);
+    }
+    tcflush(fd, TCIOFLUSH);
+    cdc_rx_len = 0;
+    return fd;
+}
+
+static int cdc_send(const char *json) {
+    uint8_t frame[CDC_MAX_PAYLOAD + 8];
+    size_t len = strlen(json);
+    if (len > CDC_MAX_PAYLOAD) return -1;
+    size_t n = cdc_frame_build(frame, CDC_MSG_CMD, ++cdc_seq, json, len);
+    return write(cdc_fd, frame, n) == (ssize_t)n ? 0 : -1;
+}
+
+// Consume whatever the port has; returns 1 and the payload when a response
+// frame was completed.
+static int cdc_pump(char *rsp, size_t *rsp_len) {
+    ssize_t n = read(cdc_fd, cdc_rx + cdc_rx_len, sizeof(cdc_rx) - cdc_rx_len);
+    if (n > 0) cdc_rx_len += n;
+    if (cdc_rx_len == sizeof(cdc_rx)) cdc_rx_len = 0;     // garbage, resync
+    uint8_t type, seq;
+    while (cdc_frame_next(cdc_rx, &cdc_rx_len, &type, &seq, rsp, rsp_len)) {
+        if (type == CDC_MSG_RSP) return 1;
+    }
+    return 0;
+}
+
+static int cdc_request(const char *json, char *rsp, int timeout_ms) {
+    size_t len;
+    if (cdc_send(json) < 0) return -1;
+    int64_t deadline = now_us() + (int64_t)timeout_ms * 1000;
+    while (now_us() < deadline) {
+        struct pollfd p = { .fd = cdc_fd, .events = POLLIN };
+        poll(&p, 1, 10);
+        if (cdc_pump(rsp, &len)) return 0;
+    }
+    return -1;
+}
+
+static bool json_int(const char *json, const char *key, int *out) {
+    char pat[48];
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    const char *p = strstr(json, pat);
+    if (!p) return false;
+    *out = (int)strtol(p + strlen(pat), NULL, 0);
+    return true;
+}
+
+static void json_str(const char *json, const char *key, char *out, size_t max) {
+    char pat[48];
+    snprintf(pat, sizeof(pat), "\"%s\":\"", key);
+    const char *p = strstr(json, pat);
+    out[0] = '\0';
+    if (!p) return;
+    p += strlen(pat);
+    size_t i = 0;
+    while (*p && *p != '"' && i + 1 < max) out[i++] = *p++;
+    out[i] = '\0';
+}
+
+// ============================================================================
+// HIDRAW DISCOVERY (sysfs)
+// ============================================================================
+
+// USB device directory that owns a tty/hidraw node
+static bool usb_device_of(const char *class_link, char *out, size_t max) {
+    char real[PATH_MAX];
+    if (!realpath(class_link, real)) return false;
+    // Walk up to the directory holding idVendor (the USB device)
+    for (;;) {
+        char probe[PATH_MAX + 16];
+        snprintf(probe, sizeof(probe), "%s/idVendor", real);
+        if (access(probe, F_OK) == 0) break;
+        char *slash = strrchr(real, '/');
+        if (!slash || slash == real) return false;
+        *slash = '\0';
+    }
+    snprintf(out, max, "%s", real);
+    return true;
+}
+
+static bool find_hidraw(const char *cdc_path, char *out, size_t max) {
+    char tty[PATH_MAX], link[PATH_MAX + 32], cdc_dev[PATH_MAX], dev[PATH_MAX];
+    if (!realpath(cdc_path, tty)) return false;
+    const char *base = strrchr(tty, '/');
+    snprintf(link, sizeof(link), "/sys/class/tty/%s/device", base ? base + 1 : tty);
+    if (!usb_device_of(link, cdc_dev, sizeof(cdc_dev))) return false;
+
+    glob_t g;
+    bool found = false;
+    if (glob("/sys/class/hidraw/hidraw*", 0, NULL, &g) == 0) {
+        for (size_t i = 0; i < g.gl_pathc && !found; i++) {
+            snprintf(link, sizeof(link), "%s/device", g.gl_pathv[i]);
+            if (usb_device_of(link, dev, sizeof(dev)) && strcmp(dev, cdc_dev) == 0) {
+                snprintf(out, max, "/dev/%s", strrchr(g.gl_pathv[i], '/') + 1);
+                found = true;
+            }
+        }
+        globfree(&g);
+    }
+    return found;
+}
+
+// Interrupt IN endpoint interval of the hidraw node's interface
+static uint32_t hidraw_interval_us(const char *hidraw_path, char *speed, size_t max) {
+    char link[PATH_MAX + 32], real[PATH_MAX], pat[PATH_MAX + 16], buf[16];
+    const char *base = strrchr(hidraw_path, '/');
+    speed[0] = '\0';
+    snprintf(link, sizeof(link), "/sys/class/hidraw/%s/device", base ? base + 1 : hidraw_path);
+    if (!realpath(link, real)) return 0;
+    char *slash = strrchr(real, '/');           // HID device -> USB interface
+    if (!slash) return 0;
+    *slash = '\0';
+
+    uint32_t us = 0;
+    glob_t g;
+    snprintf(pat, sizeof(pat), "%s/ep_8*/interval", real);
+    if (glob(pat, 0, NULL, &g) == 0) {
+        FILE *f = fopen(g.gl_pathv[0], "r");
+        if (f && fgets(buf, sizeof(buf), f)) {
+            char *end;
+            double v = strtod(buf, &end);
+            us = (uint32_t)(strncmp(end, "ms", 2) == 0 ? v * 1000 : v);
+        }
+        if (f) fclose(f);
+        globfree(&g);
+    }
+
+    slash = strrchr(real, '/');                 // USB interface -> device
+    if (slash) {
+        *slash = '\0';
+        snprintf(pat, sizeof(pat), "%s/speed", real);
+        FILE *f = fopen(pat, "r");
+        if (f && fgets(buf, sizeof(buf), f)) {
+            buf[strcspn(buf, "\n")] = '\0';
+            snprintf(speed, max, "%.15s", buf);
+        }
+        if (f) fclose(f);
+    }
+    return us;
+}
+
+// ============================================================================
+// MEASUREMENT
+// ============================================================================
+
+static uint8_t idle_report[MAX_REPORT];
+static uint8_t stable_mask[MAX_REPORT];
+static int idle_len;
+
+static void hid_drain(void) {
+    uint8_t buf[MAX_REPORT];
+    while (read(hid_fd, buf, sizeof(buf)) > 0) {}
+}
+
+static bool report_is_idle(const uint8_t *r, int n) {
+    if (n != idle_len) return false;
+    for (int i = 0; i < n; i++)
+        if ((r[i] ^ idle_report[i]) & stable_mask[i]) return false;
+    return true;
+}
+
+static bool inject(uint32_t buttons) {
+    char json[64];
+    snprintf(json, sizeof(json), "{\"cmd\":\"INPUT.INJECT\",\"buttons\":%u}", buttons);
+    return cdc_send(json) == 0;
+}
+
+// Record the idle report and the bytes that move without input
+static bool calibrate(void) {
+    char rsp[CDC_MAX_PAYLOAD + 1];
+    cdc_request("{\"cmd\":\"INPUT.INJECT\",\"buttons\":0}", rsp, 500);
+    usleep(50000);
+    hid_drain();
+
+    int reports = 0;
+    memset(stable_mask, 0xFF, sizeof(stable_mask));
+    int64_t end = now_us() + CALIB_MS * 1000;
+    while (now_us() < end) {
+        struct pollfd p = { .fd = hid_fd, .events = POLLIN };
+        if (poll(&p, 1, 20) <= 0) continue;
+        uint8_t r[MAX_REPORT];
+        int n = (int)read(hid_fd, r, sizeof(r));
+        if (n <= 0) continue;
+        if (reports++ == 0 || n != idle_len) {
+            memcpy(idle_report, r, n);
+            idle_len = n;
+            continue;
+        }
+        for (int i = 0; i < n; i++) {
+            if (r[i] != idle_report[i]) stable_mask[i] = 0;
+        }
+    }
+    return reports > 0;
+}
+
+// Time from sending buttons to the first report matching want_idle
+static int64_t measure_edge(uint32_t buttons, bool want_idle, int timeout_ms) {
+    char rsp[CDC_MAX_PAYLOAD + 1];
+    size_t len;
+    hid_drain();
+    int64_t t0 = now_us();
+    if (!inject(buttons)) return -1;
+
+    int64_t deadline = t0 + (int64_t)timeout_ms * 1000;
+    for (;;) {
+        int64_t left = deadline - now_us();
+        if (left <= 0) return -1;
+        struct pollfd p[2] = {
+            { .fd = hid_fd, .events = POLLIN },
+            { .fd = cdc_fd, .events = POLLIN },
+        };
+        if (poll(p, 2, (int)((left + 999) / 1000)) <= 0) continue;
+        if (p[1].revents & POLLIN) cdc_pump(rsp, &len);
+        if (!(p[0].revents & POLLIN)) continue;
+
+        uint8_t r[MAX_REPORT];
+        int n = (int)read(hid_fd, r, sizeof(r));
+        int64_t t = now_us();
+        if (n > 0 && report_is_idle(r, n) == want_idle) return t - t0;
+    }
+}
+
+static void sleep_gap(int gap_ms) {
+    usleep((useconds_t)(gap_ms * 1000 + rand() % (gap_ms * 1000 + 1)));
+}
+
+static bool run_mode(const opts_t *o, run_t *run) {
+    char rsp[CDC_MAX_PAYLOAD + 1];
+    if (cdc_request("{\"cmd\":\"MODE.GET\"}", rsp, 1000) == 0) {
+        json_int(rsp, "mode", &run->mode);
+        json_str(rsp, "name", run->name, sizeof(run->name));
+    }
+
+    char hidraw[PATH_MAX];
+    if (o->hidraw_path) {
+        snprintf(hidraw, sizeof(hidraw), "%s", o->hidraw_path);
+    } else if (!find_hidraw(o->cdc_path, hidraw, sizeof(hidraw))) {
+        fprintf(stderr, "mode %d (%s): no hidraw interface on this device, skipped\n",
+                run->mode, run->name);
+        return false;
+    }
+    hid_fd = open(hidraw, O_RDONLY | O_NONBLOCK);
+    if (hid_fd < 0) {
+        fprintf(stderr, "open %s: %s\n", hidraw, strerror(errno));
+        return false;
+    }
+    run->interval_us = o->interval_us ? o->interval_us
+                                      : hidraw_interval_us(hidraw, run->speed, sizeof(run->speed));
+
+    printf("mode %d (%s): %s, interval %u us%s%s\n", run->mode, run->name, hidraw,
+           run->interval_us, run->speed[0] ? ", speed " : "", run->speed);
+
+    if (!calibrate()) {
+        fprintf(stderr, "no HID reports during calibration; INPUT.INJECT needs a "
+                        "connected input device to ride on\n");
+        close(hid_fd);
+        return false;
+    }
+
+    run->press.us = calloc(o->count, sizeof(int64_t));
+    run->release.us = calloc(o->count, sizeof(int64_t));
+    for (int i = 0; i < o->count; i++) {
+        sleep_gap(o->gap_ms);
+        run->press.us[run->press.n++] = measure_edge(o->button, false, o->timeout_ms);
+        sleep_gap(o->gap_ms);
+        run->release.us[run->release.n++] = measure_edge(0, true, o->timeout_ms);
+        if (run->release.us[i] < 0) {
+            // Lost release: make sure the next press starts from idle
+            inject(0);
+            usleep(o->timeout_ms * 1000);
+        }
+    }
+    close(hid_fd);
+    hid_fd = -1;
+    return true;
+}
+
+// Reopen the CDC port after MODE.SET re-enumerates the device
+static bool switch_mode(const opts_t *o, int mode) {
+    char json[64], rsp[CDC_MAX_PAYLOAD + 1];
+    snprintf(json, sizeof(json), "{\"cmd\":\"MODE.SET\",\"mode\":%d}", mode);
+    if (cdc_request(json, rsp, 1000) < 0) return false;
+    if (!strstr(rsp, "\"reboot\":true")) return true;
+
+    close(cdc_fd);
+    cdc_fd = -1;
+    usleep(1000000);
+    int64_t deadline = now_us() + (int64_t)ENUM_TIMEOUT_MS * 1000;
+    while (now_us() < deadline) {
+        cdc_fd = cdc_open(o->cdc_path);
+        if (cdc_fd >= 0) {
+            usleep(500000);     // let the HID interfaces bind
+            return true;
+        }
+        usleep(100000);
+    }
+    return false;
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+typedef struct {
+    int n, lost;
+    double mean, stddev;
+    int64_t min, p50, p90, p99, max;
+} dist_t;
+
+static int cmp_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static dist_t summarize(const edge_samples_t *s) {
+    dist_t d = {0};
+    int64_t *v = malloc(sizeof(int64_t) * (s->n ? s->n : 1));
+    for (int i = 0; i < s->n; i++) {
+        if (s->us[i] < 0) d.lost++;
+        else v[d.n++] = s->us[i];
+    }
+    if (d.n) {
+        qsort(v, d.n, sizeof(int64_t), cmp_i64);
+        double sum = 0, sq = 0;
+        for (int i = 0; i < d.n; i++) sum += v[i];
+        d.mean = sum / d.n;
+        for (int i = 0; i < d.n; i++) sq += (v[i] - d.mean) * (v[i] - d.mean);
+        d.stddev = sqrt(sq / d.n);
+        d.min = v[0];
+        d.p50 = v[(d.n - 1) * 50 / 100];
+        d.p90 = v[(d.n - 1) * 90 / 100];
+        d.p99 = v[(d.n - 1) * 99 / 100];
+        d.max = v[d.n - 1];
+    }
+    free(v);
+    return d;
+}
+
+static void print_dist(const char *edge, const dist_t *d) {
+    printf("  %-8s n=%-4d lost=%-3d min %6lld  p50 %6lld  p90 %6lld  p99 %6lld  "
+           "max %6lld  mean %8.1f  sd %7.1f us\n", edge, d->n, d->lost,
+           (long long)d->min, (long long)d->p50, (long long)d->p90, (long long)d->p99,
+           (long long)d->max, d->mean, d->stddev);
+}
+
+static void json_dist(FILE *f, const char *edge, const dist_t *d) {
+    fprintf(f, "\"%s\":{\"n\":%d,\"lost\":%d,\"min_us\":%lld,\"p50_us\":%lld,"
+               "\"p90_us\":%lld,\"p99_us\":%lld,\"max_us\":%lld,\"mean_us\":%.1f,"
+               "\"stddev_us\":%.1f}", edge, d->n, d->lost, (long long)d->min,
+            (long long)d->p50, (long long)d->p90, (long long)d->p99, (long long)d->max,
+            d->mean, d->stddev);
+}
+
+static void write_outputs(const opts_t *o, const run_t *runs, int nruns) {
+    if (o->csv_path) {
+        FILE *f = fopen(o->csv_path, "w");
+        if (!f) { perror(o->csv_path); return; }
+        fprintf(f, "mode,name,interval_us,seq,edge,latency_us\n");
+        for (int r = 0; r < nruns; r++) {
+            for (int i = 0; i < runs[r].press.n; i++) {
+                fprintf(f, "%d,%s,%u,%d,press,%lld\n", runs[r].mode, runs[r].name,
+                        runs[r].interval_us, i, (long long)runs[r].press.us[i]);
+                fprintf(f, "%d,%s,%u,%d,release,%lld\n", runs[r].mode, runs[r].name,
+                        runs[r].interval_us, i, (long long)runs[r].release.us[i]);
+            }
+        }
+        fclose(f);
+    }
+    if (o->json_path) {
+        FILE *f = fopen(o->json_path, "w");
+        if (!f) { perror(o->json_path); return; }
+        fprintf(f, "{\"button\":%u,\"count\":%d,\"runs\":[", o->button, o->count);
+        for (int r = 0; r < nruns; r++) {
+            dist_t p = summarize(&runs[r].press), rl = summarize(&runs[r].release);
+            fprintf(f, "%s\n {\"mode\":%d,\"name\":\"%s\",\"interval_us\":%u,\"speed\":\"%s\",",
+                    r ? "," : "", runs[r].mode, runs[r].name, runs[r].interval_us, runs[r].speed);
+            json_dist(f, "press", &p);
+            fputc(',', f);
+            json_dist(f, "release", &rl);
+            fputc('}', f);
+        }
+        fprintf(f, "\n]}\n");
+        fclose(f);
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s --cdc <tty> [--hidraw <dev>] [--count N] [--gap-ms N]\n"
+        "          [--timeout-ms N] [--button MASK] [--modes A,B,...]\n"
+        "          [--interval-us N] [--csv FILE] [--json FILE]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    opts_t o = { .count = 200, .gap_ms = 20, .timeout_ms = 250, .button = 0x1 };
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i], *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!v) { usage(argv[0]); return 2; }
+        if      (!strcmp(a, "--cdc"))         o.cdc_path = v;
+        else if (!strcmp(a, "--hidraw"))      o.hidraw_path = v;
+        else if (!strcmp(a, "--count"))       o.count = atoi(v);
+        else if (!strcmp(a, "--gap-ms"))      o.gap_ms = atoi(v);
+        else if (!strcmp(a, "--timeout-ms"))  o.timeout_ms = atoi(v);
+        else if (!strcmp(a, "--button"))      o.button = (uint32_t)strtoul(v, NULL, 0);
+        else if (!strcmp(a, "--interval-us")) o.interval_us = (uint32_t)strtoul(v, NULL, 0);
+        else if (!strcmp(a, "--csv"))         o.csv_path = v;
+        else if (!strcmp(a, "--json"))        o.json_path = v;
+        else if (!strcmp(a, "--modes")) {
+            for (char *s = (char *)v; *s && o.mode_count < MAX_MODES; ) {
+                o.modes[o.mode_count++] = (int)strtol(s, &s, 0);
+                if (*s == ',') s++;
+                else break;
+            }
+        } else { usage(argv[0]); return 2; }
+        i++;
+    }
+    if (!o.cdc_path || o.count <= 0 || o.gap_ms < 0 || !o.button) { usage(argv[0]); return 2; }
+
+    srand((unsigned)now_us());
+    cdc_fd = cdc_open(o.cdc_path);
+    if (cdc_fd < 0) { perror(o.cdc_path); return 1; }
+
+    run_t runs[MAX_MODES];
+    int nruns = 0;
+    int passes = o.mode_count ? o.mode_count : 1;
+    for (int m = 0; m < passes; m++) {
+        if (o.mode_count && !switch_mode(&o, o.modes[m])) {
+            fprintf(stderr, "mode %d: MODE.SET failed or device did not come back\n", o.modes[m]);
+            if (cdc_fd < 0) break;
+            continue;
+        }
+        run_t *run = &runs[nruns];
+        memset(run, 0, sizeof(*run));
+        run->mode = o.mode_count ? o.modes[m] : -1;
+        if (!run_mode(&o, run)) continue;
+
+        dist_t p = summarize(&run->press), r = summarize(&run->release);
+        print_dist("press", &p);
+        print_dist("release", &r);
+        nruns++;
+    }
+
+    write_outputs(&o, runs, nruns);
+    if (cdc_fd >= 0) {
+        inject(0);
+        close(cdc_fd);
+    }
+    for (int r = 0; r < nruns; r++) {
+        free(runs[r].press.us);
+        free(runs[r].release.us);
+    }
+    return nruns ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+// loopback.c - stand-in for a Joypad device, for testing sinput-latency
+// without hardware (Linux).
+//
+// Creates <dir>/cdc (symlink to a pty speaking the CDC command framing) and
+// <dir>/hid (a FIFO carrying fixed 64-byte SInput-style input reports, one
+// per polling interval). INPUT.INJECT button changes reach the reports after
+// a configurable delay, quantised to the next poll like a real interrupt
+// endpoint, so the expected latency is delay + U(0, interval) (+ jitter).
+// Bytes 19-22 carry a running timestamp, as on the real IMU report, so
+// the latency tool's volatile-byte masking is exercised too.
+//
+// Usage: sinput-loopback [--dir D] [--delay-us N] [--jitter-us N]
+//                        [--interval-us N] [--mode N]
+// Then:  sinput-latency --cdc D/cdc --hidraw D/hid --interval-us N
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cdc_frame.h"
+
+#define REPORT_LEN  64
+#define MAX_PENDING 64
+
+static volatile sig_atomic_t stop = 0;
+static void on_sig(int s) { (void)s; stop = 1; }
+
+static const char *mode_names[] = {
+    "DInput", "SInput", "XInput", "PS3", "PS4", "Switch", "PS Classic",
+    "Xbox OG", "Xbox One", "XAC", "KB/Mouse", "GC Adapter", "PCE Mini",
+    "CDC", "GBA Link", "Switch Pro", "Xbox OG 4P",
+};
+#define MODE_COUNT (int)(sizeof(mode_names) / sizeof(mode_names[0]))
+
+// Button changes waiting for their delay to elapse
+static struct { int64_t due_us; uint32_t buttons; } pending[MAX_PENDING];
+static int pending_count;
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static bool json_int(const char *json, const char *key, int *out) {
+    char pat[48];
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    const char *p = strstr(json, pat);
+    if (!p) return false;
+    *out = (int)strtol(p + strlen(pat), NULL, 0);
+    return true;
+}
+
+static void respond(int fd, uint8_t seq, const char *json) {
+    uint8_t frame[CDC_MAX_PAYLOAD + 8];
+    size_t n = cdc_frame_build(frame, CDC_MSG_RSP, seq, json, strlen(json));
+    if (write(fd, frame, n) != (ssize_t)n) perror("cdc write");
+}
+
+int main(int argc, char **argv) {
+    const char *dir = "/tmp/sinput-loopback";
+    int delay_us = 500, jitter_us = 0, interval_us = 1000, mode = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if      (!strcmp(argv[i], "--dir"))         dir = argv[i + 1];
+        else if (!strcmp(argv[i], "--delay-us"))    delay_us = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--jitter-us"))   jitter_us = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--interval-us")) interval_us = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--mode"))        mode = atoi(argv[i + 1]);
+        else {
+            fprintf(stderr, "usage: %s [--dir D] [--delay-us N] [--jitter-us N] "
+                            "[--interval-us N] [--mode N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (interval_us <= 0 || delay_us < 0 || jitter_us < 0 || mode < 0 || mode >= MODE_COUNT) {
+        fprintf(stderr, "bad arguments\n");
+        return 2;
+    }
+
+    signal(SIGINT, on_sig);
+    signal(SIGTERM, on_sig);
+    signal(SIGPIPE, SIG_IGN);
+
+    // CDC: pty master here, slave held open in raw mode (no echo, and no
+    // EIO on the master while the latency tool isn't attached)
+    int cdc = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (cdc < 0 || grantpt(cdc) < 0 || unlockpt(cdc) < 0) { perror("pty"); return 1; }
+    const char *slave_name = ptsname(cdc);
+    int slave = open(slave_name, O_RDWR | O_NOCTTY);
+    struct termios t;
+    if (slave < 0 || tcgetattr(slave, &t) < 0) { perror(slave_name); return 1; }
+    cfmakeraw(&t);
+    tcsetattr(slave, TCSANOW, &t);
+
+    // HID: FIFO opened read-write so writes never block on a missing reader
+    char cdc_link[4096], hid_path[4096];
+    mkdir(dir, 0755);
+    snprintf(cdc_link, sizeof(cdc_link), "%s/cdc", dir);
+    snprintf(hid_path, sizeof(hid_path), "%s/hid", dir);
+    unlink(cdc_link);
+    unlink(hid_path);
+    if (symlink(slave_name, cdc_link) < 0 || mkfifo(hid_path, 0644) < 0) {
+        perror(dir);
+        return 1;
+    }
+    int hid = open(hid_path, O_RDWR | O_NONBLOCK);
+    if (hid < 0) { perror(hid_path); return 1; }
+
+    printf("loopback: cdc %s -> %s, hid %s\n", cdc_link, slave_name, hid_path);
+    printf("loopback: delay %d us, jitter %d us, interval %d us, mode %d (%s)\n",
+           delay_us, jitter_us, interval_us, mode, mode_names[mode]);
+    fflush(stdout);
+
+    uint8_t rx[4096];
+    size_t rx_len = 0;
+    uint32_t buttons = 0;
+    uint32_t reports = 0, dropped = 0;
+    int64_t next_poll = now_us() + interval_us;
+    srand((unsigned)next_poll);
+
+    while (!stop) {
+        int64_t wait = next_poll - now_us();
+        struct timespec ts = { 0, wait > 0 ? wait * 1000 : 0 };
+        struct pollfd p = { .fd = cdc, .events = POLLIN };
+        ppoll(&p, 1, &ts, NULL);
+
+        if (p.revents & POLLIN) {
+            ssize_t n = read(cdc, rx + rx_len, sizeof(rx) - rx_len);
+            if (n > 0) rx_len += n;
+            if (rx_len == sizeof(rx)) rx_len = 0;
+
+            uint8_t type, seq;
+            char payload[CDC_MAX_PAYLOAD + 1], rsp[128];
+            size_t len;
+            while (cdc_frame_next(rx, &rx_len, &type, &seq, payload, &len)) {
+                if (type != CDC_MSG_CMD) continue;
+                int value;
+                if (strstr(payload, "\"INPUT.INJECT\"") && json_int(payload, "buttons", &value)) {
+                    if (pending_count < MAX_PENDING) {
+                        int64_t due = now_us() + delay_us + (jitter_us ? rand() % (jitter_us + 1) : 0);
+                        pending[pending_count].due_us = due;
+                        pending[pending_count].buttons = (uint32_t)value;
+                        pending_count++;
+                    }
+                    snprintf(rsp, sizeof(rsp), "{\"ok\":true,\"buttons\":%u}", (unsigned)value);
+                } else if (strstr(payload, "\"MODE.GET\"")) {
+                    snprintf(rsp, sizeof(rsp), "{\"mode\":%d,\"name\":\"%s\"}", mode, mode_names[mode]);
+                } else if (strstr(payload, "\"MODE.SET\"") && json_int(payload, "mode", &value)
+                           && value >= 0 && value < MODE_COUNT) {
+                    mode = value;
+                    snprintf(rsp, sizeof(rsp), "{\"mode\":%d,\"name\":\"%s\",\"reboot\":false}",
+                             mode, mode_names[mode]);
+                } else {
+                    snprintf(rsp, sizeof(rsp), "{\"error\":\"unsupported\"}");
+                }
+                respond(cdc, seq, rsp);
+            }
+        }
+
+        int64_t now = now_us();
+        if (now < next_poll) continue;
+
+        // Poll: latch every change whose delay has elapsed
+        int keep = 0;
+        for (int i = 0; i < pending_count; i++) {
+            if (pending[i].due_us <= next_poll) buttons = pending[i].buttons;
+            else pending[keep++] = pending[i];
+        }
+        pending_count = keep;
+
+        uint8_t r[REPORT_LEN] = {0};
+        r[0] = 0x01;
+        r[3] = buttons & 0xFF;
+        r[4] = (buttons >> 8) & 0xFF;
+        r[5] = (buttons >> 16) & 0xFF;
+        r[6] = (buttons >> 24) & 0xFF;
+        uint32_t stamp = (uint32_t)now;
+        memcpy(&r[19], &stamp, sizeof(stamp));
+        if (write(hid, r, sizeof(r)) == (ssize_t)sizeof(r)) reports++;
+        else dropped++;
+
+        next_poll += interval_us;
+        if (next_poll < now) next_poll = now + interval_us;     // fell behind
+    }
+
+    printf("loopback: %u reports, %u dropped\n", reports, dropped);
+    unlink(cdc_link);
+    unlink(hid_path);
+    close(hid);
+    close(slave);
+    close(cdc);
+    return 0;
+}
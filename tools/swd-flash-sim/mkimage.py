@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+# Write a synthetic B-side image for swd-flash-sim: usage: mkimage.py <out.bin>
+#
+# Deterministic. Shaped like a firmware image so every sector kind the
+# flasher handles shows up: a boot2 block, compressible code, repetitive
+# tables, blank (all 0xff) sectors, an incompressible sector that is stored
+# raw, full 64K blocks and a last sector that needs padding.
+import random
+import sys
+
+SECTOR = 4096
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.stderr.write("usage: mkimage.py <out.bin>\n")
+        sys.exit(2)
+
+    rng = random.Random(2040)
+    out = bytearray()
+
+    # boot2 + vectors
+    out += bytes(rng.randrange(256) for _ in range(256))
+    out += b"\x00\x10\x04\x20" + bytes(rng.randrange(256) for _ in range(252))
+
+    # "code": short opcodes from a small alphabet, with repeated idioms
+    idioms = [bytes(rng.randrange(256) for _ in range(rng.randrange(4, 24))) for _ in range(200)]
+    while len(out) < 70 * SECTOR:
+        if rng.random() < 0.6:
+            out += rng.choice(idioms)
+        else:
+            out += bytes(rng.choice(b"\x00\x01\x08\x10\x20\x46\x47\x4b\x68\xb5\xbd\xd0\xe7\xf0\xff")
+                         for _ in range(rng.randrange(1, 8)))
+    del out[70 * SECTOR:]
+
+    # blank sectors (reserved space)
+    out += b"\xff" * (3 * SECTOR)
+
+    # an incompressible sector (stored raw)
+    out += bytes(rng.randrange(256) for _ in range(SECTOR))
+
+    # tables: repeated records with a counter
+    for i in range(24 * SECTOR // 16):
+        out += bytes([i & 0xff, (i >> 8) & 0xff, 0, 0]) + b"JOYPAD\x00\x00" + bytes([0x55] * 4)
+
+    # partial last sector
+    out += bytes(rng.randrange(256) for _ in range(1234))
+
+    with open(sys.argv[1], "wb") as f:
+        f.write(out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,697 @@
+// sim.c - host model of the SWD B-side flasher
+//
+// Builds flash.c from src/swd_flash and runs rp2040_flash_image() with both
+// halves on the host. The target's RAM and flash are mapped at the RP2040's
+// own addresses, so the target half of flash.c (crc_sectors() and
+// program_batch()) runs unmodified; the ROM flash calls and boot2 it looks up
+// are replaced by a model of a NOR flash behind an XIP cache. This file
+// stands in for the SWD link (adi.h): block reads and writes go straight to
+// the mapped RAM and a started call runs when the host waits for it. Time is
+// modelled from the SWD clock and typical flash timings.
+//
+// Checks:
+//   - a flash pass that reports success leaves the target flash holding the
+//     image, and flash past the image is never touched;
+//   - only sectors that differ are erased, each exactly once, with one
+//     64k (or 32k) block erase wherever a whole aligned block changed;
+//   - the flash is only programmed where erased, in whole pages, and only
+//     read with XIP back on and the cache flushed since the last write;
+//   - boot2 runs from the image's copy, the target code is the one copied
+//     over, and batches fit their buffer;
+//   - the host never writes a batch buffer the target is still working on,
+//     never starts a call while one is running, and while the target
+//     programs one batch the next is already going over the wire;
+//   - a corrupted transfer or a failed SWD write fails the pass and the retry
+//     (as in flash_b_side.c) gets it right; a sector that won't decode is
+//     reported and never erased.
+//
+// Usage: swd-flash-sim [-v] [-s seed] scenario
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "flash.h"
+#include "swd.h"
+#include "adi.h"
+#include "pico/stdlib.h"
+#include "image.h"
+
+// Target memory map (as in flash.c)
+#define RAM_BASE            0x20000000u
+#define RAM_SIZE            0x42000u
+#define FLASH_BASE          0x10000000u
+#define FLASH_SIZE          (FLASH_MAX_SECTORS * FLASH_SECTOR_SIZE)
+#define BATCH_BUFFER_0      0x20000000u
+#define BATCH_BUFFER_SIZE   32768u
+#define CODE_START          0x20010000u
+#define BOOT2_START         0x20020000u
+#define PAGE_SIZE_NOR       256u
+
+// Batch layout and flags, mirroring flash.c
+#define FLASH_BATCH_MAX     32
+#define BATCH_ERASE_64K     (1 << 8)
+#define BATCH_ERASE_32K     (1 << 9)
+#define BATCH_NO_ERASE      (1 << 10)
+
+typedef struct {
+    uint32_t offset;
+    uint16_t length;
+    uint16_t flags;
+} sim_batch_entry_t;
+
+typedef struct {
+    uint32_t          count;
+    sim_batch_entry_t entry[FLASH_BATCH_MAX];
+} sim_batch_t;
+
+// Typical timings: SWD block transfers cost ~50 bit times a word at two PIO
+// cycles a bit of a 125 MHz clock; the flash figures are a W25Q16's.
+#define SWD_BITS_PER_WORD   50
+#define SYS_CLK_MHZ         125
+#define CRC_US_PER_SECTOR   400
+#define DECODE_US           150
+#define ERASE_4K_US         45000
+#define ERASE_32K_US        120000
+#define ERASE_64K_US        150000
+#define PROGRAM_US_PER_PAGE 400
+
+#define MAX_ATTEMPTS        4
+
+int crc_sectors(uint32_t offset, uint32_t count, uint32_t* out);
+int program_batch(void* batch);
+extern char __start_for_target[];
+extern char __stop_for_target[];
+
+static bool verbose;
+static int failures;
+static uint32_t seed = 1;
+
+static uint8_t* const ram = (uint8_t*)(uintptr_t)RAM_BASE;
+static uint8_t* const flash = (uint8_t*)(uintptr_t)FLASH_BASE;
+static flash_image_t image;
+static uint8_t* padded;         // the image as it should end up in flash
+static uint8_t* data_copy;      // sector streams, writable for bad-stream
+
+// SWD link
+static int clkdiv = SWD_CLKDIV_SAFE;
+static uint64_t now_us;
+static bool pending;
+static uint32_t pending_addr, pending_args[4];
+static uint64_t pending_start;
+static uint64_t target_us;      // target time used by the running call
+
+// Fault injection
+static int write_error_at;      // fail this mem_write_block (1-based), 0 = off
+static int corrupt_at;          // flip a byte in this payload write, 0 = off
+static int writes, payload_writes;
+static bool injected;
+
+// Flash model
+static bool in_call, connected, xip, stale;
+static uint16_t rom_table[8];
+
+// Per-pass accounting
+static bool changed[FLASH_MAX_SECTORS];
+static int erased[FLASH_MAX_SECTORS];
+static int erase_4k, erase_32k, erase_64k, batches, overlapped;
+static uint64_t swd_us, busy_us, bytes_sent;
+static int bad_index = -1;      // sector of the broken stream, if any
+static bool bad_reported;
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static uint32_t target_addr(void* fn)
+{
+    return CODE_START + (uint32_t)((uintptr_t)fn - (uintptr_t)__start_for_target);
+}
+
+// flash.c's progress lines, shown with -v. They print uint32_t with %lu,
+// which is right on the target (long is 32 bits there) but not here, so the
+// l length modifiers are dropped before the arguments are read.
+int sim_log(const char* fmt, ...)
+{
+    char host_fmt[256];
+    size_t o = 0;
+    va_list ap;
+    int n = 0;
+
+    if (!verbose)
+        return 0;
+    for (const char* f = fmt; *f && o < sizeof(host_fmt) - 1; f++) {
+        host_fmt[o++] = *f;
+        if (*f == '%' && f[1] != '%') {
+            while (f[1] && strchr("-+ #0123456789", f[1]) && o < sizeof(host_fmt) - 1)
+                host_fmt[o++] = *++f;
+            while (f[1] == 'l')
+                f++;
+        } else if (*f == '%' && o < sizeof(host_fmt) - 1) {
+            host_fmt[o++] = *++f;
+        }
+    }
+    host_fmt[o] = '\0';
+
+    va_start(ap, fmt);
+    printf("    ");
+    n = vprintf(host_fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)now_us;
+}
+
+static void swd_cost(uint32_t bytes)
+{
+    uint64_t us = ((bytes + 3) / 4) * SWD_BITS_PER_WORD * 2 * clkdiv / SYS_CLK_MHZ;
+    now_us += us;
+    swd_us += us;
+}
+
+static void flash_access(bool readable)
+{
+    mprotect(flash, FLASH_SIZE, readable ? PROT_READ : PROT_NONE);
+}
+
+static void on_segv(int sig, siginfo_t* info, void* ctx)
+{
+    uintptr_t a = (uintptr_t)info->si_addr;
+    char msg[128];
+    int n;
+
+    if (a >= FLASH_BASE && a < FLASH_BASE + FLASH_SIZE)
+        n = snprintf(msg, sizeof msg, "  FAIL: target read flash at 0x%08lx with XIP off\nFAILED\n",
+                     (unsigned long)a);
+    else
+        n = snprintf(msg, sizeof msg, "  FAIL: bad access at 0x%08lx\nFAILED\n", (unsigned long)a);
+    if (write(1, msg, n) < 0) _exit(1);
+    _exit(1);
+}
+
+// -----------------------------------------------------------------------------
+// ROM and boot2 model (what the target half of flash.c calls)
+// -----------------------------------------------------------------------------
+
+static void* rom_connect(void)
+{
+    if (!in_call) fail("ROM called outside a target call");
+    connected = true;
+    xip = false;
+    flash_access(false);
+    return NULL;
+}
+
+static void* rom_exit_xip(void)
+{
+    if (!connected) fail("flash_exit_xip before connect_internal_flash");
+    xip = false;
+    flash_access(false);
+    return NULL;
+}
+
+static void* rom_erase(uint32_t addr, size_t count, uint32_t block_size, uint8_t cmd)
+{
+    uint32_t want = cmd == 0xD8 ? 65536 : cmd == 0x52 ? 32768 : cmd == 0x20 ? 4096 : 0;
+
+    if (!connected || xip) fail("erase at 0x%06x with the flash in XIP mode", addr);
+    if (!want || block_size != want) {
+        fail("erase cmd 0x%02x with block size %u", cmd, block_size);
+        return NULL;
+    }
+    if (addr % block_size || count != block_size || addr + count > FLASH_SIZE) {
+        fail("erase of %zu at 0x%06x isn't one aligned %u block", count, addr, block_size);
+        return NULL;
+    }
+    mprotect(flash, FLASH_SIZE, PROT_READ | PROT_WRITE);
+    memset(flash + addr, 0xff, count);
+    flash_access(false);
+    for (uint32_t s = addr / FLASH_SECTOR_SIZE; s < (addr + count) / FLASH_SECTOR_SIZE; s++) {
+        erased[s]++;
+    }
+    if (bad_index >= 0 && addr == (uint32_t)bad_index * FLASH_SECTOR_SIZE)
+        fail("sector %d erased although its stream doesn't decode", bad_index);
+    if (want == 65536) erase_64k++;
+    else if (want == 32768) erase_32k++;
+    else erase_4k++;
+    target_us += want == 65536 ? ERASE_64K_US : want == 32768 ? ERASE_32K_US : ERASE_4K_US;
+    stale = true;
+    return NULL;
+}
+
+static void* rom_program(uint32_t addr, const uint8_t* data, size_t count)
+{
+    uintptr_t d = (uintptr_t)data;
+
+    if (!connected || xip) fail("program at 0x%06x with the flash in XIP mode", addr);
+    if (addr % PAGE_SIZE_NOR || count % PAGE_SIZE_NOR || addr + count > FLASH_SIZE) {
+        fail("program of %zu at 0x%06x isn't whole pages", count, addr);
+        return NULL;
+    }
+    if (d < RAM_BASE || d + count > RAM_BASE + RAM_SIZE) {
+        fail("program source %p isn't target RAM", (void*)data);
+        return NULL;
+    }
+    mprotect(flash, FLASH_SIZE, PROT_READ | PROT_WRITE);
+    for (size_t i = 0; i < count; i++) {
+        if (data[i] & ~flash[addr + i]) {
+            fail("program at 0x%06x needs an erase first", (uint32_t)(addr + i));
+            break;
+        }
+    }
+    for (size_t i = 0; i < count; i++) flash[addr + i] &= data[i];
+    flash_access(false);
+    target_us += (count / PAGE_SIZE_NOR) * PROGRAM_US_PER_PAGE;
+    stale = true;
+    return NULL;
+}
+
+static void* rom_flush_cache(void)
+{
+    stale = false;
+    return NULL;
+}
+
+void sim_boot2(void)
+{
+    if (!connected) fail("boot2 run before connect_internal_flash");
+    if (stale) fail("XIP re-enabled without flushing the cache after a write");
+    if (memcmp(ram + (BOOT2_START - RAM_BASE), image.boot2, 256) != 0)
+        fail("boot2 copy on the target isn't the image's");
+    xip = true;
+    flash_access(true);
+}
+
+static void* rom_table_lookup(uint16_t* table, uint32_t code)
+{
+    if (table != rom_table) fail("ROM lookup with the wrong function table");
+    switch (code) {
+        case 'I' | 'F' << 8: return (void*)rom_connect;
+        case 'E' | 'X' << 8: return (void*)rom_exit_xip;
+        case 'R' | 'E' << 8: return (void*)rom_erase;
+        case 'R' | 'P' << 8: return (void*)rom_program;
+        case 'F' | 'C' << 8: return (void*)rom_flush_cache;
+    }
+    fail("ROM lookup of unknown function %c%c", code & 0xff, code >> 8);
+    return NULL;
+}
+
+void* sim_rom_hword(uint32_t rom_address)
+{
+    if (rom_address == 0x18) return (void*)rom_table_lookup;
+    if (rom_address == 0x14) return rom_table;
+    fail("read of ROM pointer 0x%02x", rom_address);
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// The SWD link (adi.h)
+// -----------------------------------------------------------------------------
+
+static bool batch_in_use(uint32_t addr, uint32_t count)
+{
+    if (!pending || pending_addr != target_addr(program_batch)) return false;
+    uint32_t b = pending_args[0];
+    return addr < b + BATCH_BUFFER_SIZE && addr + count > b;
+}
+
+int mem_write_block(uint32_t addr, uint32_t count, const uint8_t* src)
+{
+    writes++;
+    if (write_error_at && writes == write_error_at) {
+        injected = true;
+        return SWD_ERROR;
+    }
+    bool code = addr >= CODE_START && addr + count <= BOOT2_START;
+    bool boot2 = addr >= BOOT2_START && addr + count <= BOOT2_START + 256;
+    bool batch = addr >= BATCH_BUFFER_0 && addr + count <= CODE_START;
+    if (!code && !boot2 && !batch) {
+        fail("write of %u bytes to 0x%08x, outside the areas the host owns", count, addr);
+        return SWD_ERROR;
+    }
+    if (batch_in_use(addr, count)) fail("write to 0x%08x while the target works on that batch", addr);
+    if ((code || boot2) && pending) fail("code written while a call is running");
+
+    memcpy(ram + (addr - RAM_BASE), src, count);
+    if (batch && addr % BATCH_BUFFER_SIZE) {
+        payload_writes++;
+        if (corrupt_at && payload_writes == corrupt_at) {
+            ram[addr - RAM_BASE + count / 2] ^= 0x40;
+            injected = true;
+        }
+    }
+    if (pending) overlapped++;
+    bytes_sent += count;
+    swd_cost(count);
+    return SWD_OK;
+}
+
+int mem_read_block(uint32_t addr, uint32_t count, uint8_t* dest)
+{
+    if (addr < RAM_BASE || addr + count > RAM_BASE + RAM_SIZE) {
+        fail("read of %u bytes from 0x%08x", count, addr);
+        return SWD_ERROR;
+    }
+    if (pending) fail("read of 0x%08x while a call is running", addr);
+    memcpy(dest, ram + (addr - RAM_BASE), count);
+    swd_cost(count);
+    return SWD_OK;
+}
+
+int rp2040_call_start(uint32_t addr, uint32_t args[], int argc)
+{
+    if (pending) {
+        fail("call to 0x%08x started while another is running", addr);
+        return SWD_ERROR;
+    }
+    if (argc > 4) fail("call with %d arguments", argc);
+    pending = true;
+    pending_addr = addr;
+    memcpy(pending_args, args, argc * sizeof(uint32_t));
+    pending_start = now_us;
+    swd_cost(4 * (argc + 4));
+    return SWD_OK;
+}
+
+static void check_batch(const sim_batch_t* b)
+{
+    uint32_t size = sizeof(sim_batch_t), last = 0;
+
+    if (b->count == 0 || b->count > FLASH_BATCH_MAX) {
+        fail("batch of %u sectors", b->count);
+        return;
+    }
+    for (uint32_t i = 0; i < b->count; i++) {
+        if (i && b->entry[i].offset <= last) fail("batch sectors out of order");
+        last = b->entry[i].offset;
+        size += (b->entry[i].length + 3) & ~3u;
+    }
+    if (size > BATCH_BUFFER_SIZE) fail("batch of %u bytes overruns its buffer", size);
+}
+
+int rp2040_call_wait(uint32_t* result)
+{
+    if (!pending) {
+        fail("wait with no call running");
+        return SWD_ERROR;
+    }
+    uint32_t len = (uint32_t)(__stop_for_target - __start_for_target);
+    if (memcmp(ram + (CODE_START - RAM_BASE), __start_for_target, len) != 0)
+        fail("call into target code that wasn't copied over");
+
+    // Run the call to completion now; it started at pending_start
+    in_call = true;
+    connected = false;
+    target_us = 0;
+    if (pending_addr == target_addr(crc_sectors)) {
+        *result = crc_sectors(pending_args[0], pending_args[1], (uint32_t*)(uintptr_t)pending_args[2]);
+        target_us += pending_args[1] * CRC_US_PER_SECTOR;
+    } else if (pending_addr == target_addr(program_batch)) {
+        const sim_batch_t* b = (const sim_batch_t*)(uintptr_t)pending_args[0];
+        check_batch(b);
+        for (uint32_t i = 0; i < b->count; i++) {
+            if (!(b->entry[i].flags & (FLASH_SECTOR_RAW | FLASH_SECTOR_BLANK))) target_us += DECODE_US;
+        }
+        *result = program_batch((void*)(uintptr_t)pending_args[0]);
+        if ((*result & 0x80000000u) && bad_index >= 0 &&
+            b->entry[*result & 0xff].offset == (uint32_t)bad_index * FLASH_SECTOR_SIZE)
+            bad_reported = true;
+        batches++;
+    } else {
+        fail("call to 0x%08x, which isn't a target function", pending_addr);
+        *result = 0;
+    }
+    in_call = false;
+    if (!xip) fail("target call returned with XIP off");
+    pending = false;
+
+    busy_us += target_us;
+    if (now_us < pending_start + target_us) now_us = pending_start + target_us;
+    swd_cost(8);
+    return SWD_OK;
+}
+
+// -----------------------------------------------------------------------------
+// Scenarios
+// -----------------------------------------------------------------------------
+
+static void fill_random(uint8_t* p, size_t n)
+{
+    for (size_t i = 0; i < n; i++) p[i] = (uint8_t)rnd();
+}
+
+static void set_flash(const char* how)
+{
+    mprotect(flash, FLASH_SIZE, PROT_READ | PROT_WRITE);
+    if (strcmp(how, "blank") == 0) {
+        memset(flash, 0xff, FLASH_SIZE);
+    } else if (strcmp(how, "garbage") == 0) {
+        fill_random(flash, FLASH_SIZE);
+    } else {
+        fill_random(flash, FLASH_SIZE);
+        memcpy(flash, padded, image.sector_count * FLASH_SECTOR_SIZE);
+        if (strcmp(how, "delta") == 0) {
+            // two bytes in different sectors, one of them inside a run of
+            // sectors that otherwise match
+            for (int i = 0; i < 2; i++) {
+                uint32_t s = rnd() % image.sector_count;
+                flash[s * FLASH_SECTOR_SIZE + rnd() % FLASH_SECTOR_SIZE] ^= 0x5a;
+            }
+        }
+    }
+    flash_access(true);
+}
+
+// A 64k (or 32k) block erase is right where every sector of the block changed
+static void expected_erases(int* e64, int* e32, int* e4)
+{
+    uint32_t n = image.sector_count;
+    *e64 = *e32 = *e4 = 0;
+    for (uint32_t s = 0; s < n; s++) {
+        if (!changed[s]) continue;
+        uint32_t size = 0;
+        if (s % 16 == 0 && s + 16 <= n) size = 16;
+        for (uint32_t i = 0; size && i < size; i++) {
+            if (!changed[s + i]) size = 0;
+        }
+        if (!size && s % 8 == 0 && s + 8 <= n) {
+            size = 8;
+            for (uint32_t i = 0; i < size; i++) {
+                if (!changed[s + i]) size = 0;
+            }
+        }
+        if (size == 16) (*e64)++;
+        else if (size == 8) (*e32)++;
+        else (*e4)++;
+        if (size) s += size - 1;
+    }
+}
+
+static int flash_pass(int attempt)
+{
+    static uint8_t beyond[FLASH_SIZE];
+    uint32_t n = image.sector_count, image_len = n * FLASH_SECTOR_SIZE;
+
+    clkdiv = attempt == 0 ? SWD_CLKDIV_FAST : SWD_CLKDIV_SAFE;
+    memset(erased, 0, sizeof erased);
+    erase_4k = erase_32k = erase_64k = batches = overlapped = 0;
+    swd_us = busy_us = bytes_sent = 0;
+    writes = payload_writes = 0;
+    int nchanged = 0;
+    for (uint32_t s = 0; s < n; s++) {
+        changed[s] = memcmp(flash + s * FLASH_SECTOR_SIZE, padded + s * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE) != 0;
+        nchanged += changed[s];
+    }
+    memcpy(beyond, flash + image_len, FLASH_SIZE - image_len);
+
+    uint64_t start = now_us;
+    int rc = rp2040_flash_image(&image);
+    uint64_t took = now_us - start;
+
+    // A reset before the retry stops whatever the target was doing
+    pending = false;
+
+    bool good = memcmp(flash, padded, image_len) == 0;
+    if (memcmp(beyond, flash + image_len, FLASH_SIZE - image_len) != 0)
+        fail("flash past the image was changed");
+    if (rc == SWD_OK && !good) fail("pass %d reported success but the flash doesn't match", attempt + 1);
+    for (uint32_t s = 0; s < n; s++) {
+        if (erased[s] > 1) fail("sector %u erased %d times", s, erased[s]);
+        if (erased[s] && !changed[s]) fail("sector %u erased although it matched", s);
+        if (rc == SWD_OK && changed[s] && !erased[s]) fail("changed sector %u never erased", s);
+    }
+    if (rc == SWD_OK) {
+        int e64, e32, e4;
+        expected_erases(&e64, &e32, &e4);
+        if (erase_64k != e64 || erase_32k != e32 || erase_4k != e4)
+            fail("erases 64k/32k/4k %d/%d/%d, expected %d/%d/%d", erase_64k, erase_32k, erase_4k,
+                 e64, e32, e4);
+        if (!nchanged && batches) fail("%d batches sent with nothing changed", batches);
+        if (batches > 1 && !overlapped) fail("%d batches and none streamed while the target was busy", batches);
+    }
+
+    if (verbose) {
+        printf("  pass %d (clkdiv %d): %s, %d of %u sectors changed, %d batches, "
+               "erases 64k/32k/4k %d/%d/%d\n",
+               attempt + 1, clkdiv, rc == SWD_OK ? "ok" : "failed", nchanged, n, batches,
+               erase_64k, erase_32k, erase_4k);
+        printf("    %llu bytes sent, %llu ms (SWD %llu ms, target %llu ms, %d writes overlapped)\n",
+               (unsigned long long)bytes_sent, (unsigned long long)took / 1000,
+               (unsigned long long)swd_us / 1000, (unsigned long long)busy_us / 1000, overlapped);
+    }
+    return rc;
+}
+
+typedef struct {
+    const char* name;
+    const char* about;
+    const char* flash;      // starting flash contents
+    int passes;             // expected passes, 0 = every pass fails
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "blank",      "erased flash",                                 "blank",   1 },
+    { "garbage",    "random flash, every sector changes",           "garbage", 1 },
+    { "same",       "flash already holds the image",                "same",    1 },
+    { "delta",      "two bytes differ",                             "delta",   1 },
+    { "corrupt",    "a payload byte flips on the wire in pass 1",   "garbage", 2 },
+    { "swd-error",  "an SWD write fails in pass 1",                 "garbage", 2 },
+    { "bad-stream", "one sector's stream doesn't decode",           "garbage", 0 },
+};
+#define SCENARIO_COUNT (sizeof scenarios / sizeof scenarios[0])
+
+static void run(const scenario_t* scn)
+{
+    set_flash(scn->flash);
+
+    if (strcmp(scn->name, "corrupt") == 0) corrupt_at = 1 + rnd() % 40;
+    if (strcmp(scn->name, "swd-error") == 0) write_error_at = 3 + rnd() % 40;
+    if (strcmp(scn->name, "bad-stream") == 0) {
+        // a match with distance 0 at the start of a compressed sector
+        uint32_t s;
+        do {
+            s = rnd() % image.sector_count;
+        } while (image.sectors[s].flags & (FLASH_SECTOR_RAW | FLASH_SECTOR_BLANK));
+        data_copy[image.sectors[s].offset + 0] = 0x80;
+        data_copy[image.sectors[s].offset + 1] = 0;
+        data_copy[image.sectors[s].offset + 2] = 0;
+        bad_index = (int)s;
+    }
+
+    // As flash_b_side.c: fast clock first, then retry at the safe one
+    int passes = 0, rc = SWD_ERROR;
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+        passes++;
+        rc = flash_pass(attempt);
+        corrupt_at = write_error_at = 0;
+        if (rc == SWD_OK) break;
+    }
+
+    if (scn->passes == 0) {
+        if (rc == SWD_OK) fail("flashing succeeded with a broken sector");
+        if (!bad_reported) fail("program_batch didn't report the broken sector");
+    } else {
+        if (rc != SWD_OK) fail("flashing failed after %d passes", passes);
+        else if (passes != scn->passes) fail("took %d passes, expected %d", passes, scn->passes);
+        if (scn->passes > 1 && !injected) fail("fault was never injected");
+    }
+}
+
+static void setup(void)
+{
+    struct sigaction sa = { 0 };
+
+    if (mmap(ram, RAM_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+             -1, 0) != ram ||
+        mmap(flash, FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+             -1, 0) != flash) {
+        perror("mmap of the target address space");
+        exit(2);
+    }
+    sa.sa_sigaction = on_segv;
+    sa.sa_flags = SA_SIGINFO;
+    sigaction(SIGSEGV, &sa, NULL);
+
+    uint32_t n = sim_image_sector_count;
+    padded = malloc(n * FLASH_SECTOR_SIZE);
+    memset(padded, 0xff, n * FLASH_SECTOR_SIZE);
+    // What the flash should end up holding: the original binary, 0xff padded
+    FILE* f = fopen("image.bin", "rb");
+    if (!f || fread(padded, 1, n * FLASH_SECTOR_SIZE, f) != sim_image_length) {
+        fprintf(stderr, "can't read image.bin\n");
+        exit(2);
+    }
+    fclose(f);
+
+    uint32_t data_len = 0;
+    for (uint32_t s = 0; s < n; s++) {
+        uint32_t end = sim_image_sectors[s].offset + sim_image_sectors[s].length;
+        if (end > data_len) data_len = end;
+    }
+    data_copy = malloc(data_len + 4);
+    memcpy(data_copy, sim_image_data, data_len);
+
+    image.data = data_copy;
+    image.sectors = sim_image_sectors;
+    image.sector_count = n;
+    image.boot2 = sim_image_boot2;
+}
+
+int main(int argc, char** argv)
+{
+    const scenario_t* scn = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "vs:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-s seed] scenario\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-v] [-s seed] scenario\nscenarios:\n", argv[0]);
+        for (size_t i = 0; i < SCENARIO_COUNT; i++)
+            fprintf(stderr, "  %-11s %s\n", scenarios[i].name, scenarios[i].about);
+        return 2;
+    }
+    for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+        if (strcmp(scenarios[i].name, argv[optind]) == 0) scn = &scenarios[i];
+    }
+    if (!scn) {
+        fprintf(stderr, "unknown scenario %s\n", argv[optind]);
+        return 2;
+    }
+
+    setup();
+
+    printf("swd-flash-sim %s seed %u\n", scn->name, seed);
+    run(scn);
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
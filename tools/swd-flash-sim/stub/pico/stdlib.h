@@ -0,0 +1,11 @@
+// Minimal pico/stdlib.h for the host build of flash.c. time_us_32() is the
+// modelled clock in sim.c.
+#ifndef PICO_STDLIB_H
+#define PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+uint32_t time_us_32(void);
+
+#endif
@@ -0,0 +1,17 @@
+// Force-included ahead of flash.c: point the target side's ROM table and
+// boot2 entry at the models in sim.c instead of fixed RP2040 addresses, and
+// send the progress printf()s to sim.c's log.
+#ifndef SIM_TARGET_H
+#define SIM_TARGET_H
+
+#include <stdint.h>
+
+void* sim_rom_hword(uint32_t rom_address);
+void sim_boot2(void);
+int sim_log(const char* fmt, ...);
+
+#define rom_hword_as_ptr(rom_address)   sim_rom_hword(rom_address)
+#define BOOT2_ENTRY                     ((uintptr_t)sim_boot2)
+#define printf                          sim_log
+
+#endif
@@ -0,0 +1,268 @@
+// decode.c - decodes recorded Switch Pro / Joy-Con reports through the
+// firmware's switch_cal.c and checks the results against expectations
+//
+// Each file is one controller: its SPI calibration reads, then a run of
+// 0x30 input reports with the values the host drivers should produce. The
+// SPI data goes through switch_cal_spi_reply wrapped in a 0x21 reply
+// exactly as the controller sends it, and sticks are scaled and Y-inverted
+// the way switch_pro.c / switch_pro_bt.c do.
+//
+// Usage: switch-cal-decode [-v] report.txt...
+//   -v  print every decoded report, not just mismatches
+// Exit status 1 if any expectation fails.
+//
+// File format, one item per line, '#' starts a comment, hex may be split by
+// spaces:
+//   spi <addr> <hex>                   SPI read reply data for <addr> (hex)
+//   report <hex>                       0x30 input report, 49+ bytes
+//   expect sticks <lx> <ly> <rx> <ry>  HID order, 0-255; '-' = stick has no calibration
+//   expect fresh <n>                   IMU frames new since the previous report
+//   expect accel <x> <y> <z>           newest frame, calibrated
+//   expect gyro <x> <y> <z>
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "usb/usbh/hid/devices/vendors/nintendo/switch_cal.h"
+
+#define MAX_REPORT  64
+#define MAX_LINE    1024
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+typedef struct {
+    bool valid;             // A report has been decoded
+    int sticks[4];          // -1 = uncalibrated stick
+    uint8_t fresh;
+    int16_t accel[3];
+    int16_t gyro[3];
+} decoded_t;
+
+static bool verbose = false;
+static int failures = 0;
+static int checks = 0;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static int parse_hex(const char* s, uint8_t* out, int max)
+{
+    int n = 0;
+    int nibble = -1;
+    for (; *s && *s != '#'; s++) {
+        int v;
+        if (*s >= '0' && *s <= '9') v = *s - '0';
+        else if (*s >= 'a' && *s <= 'f') v = *s - 'a' + 10;
+        else if (*s >= 'A' && *s <= 'F') v = *s - 'A' + 10;
+        else if (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r') continue;
+        else return -1;
+
+        if (nibble < 0) {
+            nibble = v;
+        } else {
+            if (n >= max) return -1;
+            out[n++] = (uint8_t)((nibble << 4) | v);
+            nibble = -1;
+        }
+    }
+    return nibble < 0 ? n : -1;
+}
+
+__attribute__((format(printf, 3, 4)))
+static void fail(const char* file, int line, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%s:%d: ", file, line);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    failures++;
+}
+
+// ============================================================================
+// DECODE
+// ============================================================================
+
+// Wrap SPI data in a 0x21 reply and feed it to whichever region it answers
+static bool feed_spi(switch_cal_t* cal, uint16_t addr, const uint8_t* data, int len)
+{
+    uint8_t reply[MAX_REPORT] = { 0 };
+    if (20 + len > (int)sizeof(reply)) return false;
+
+    reply[0] = 0x21;
+    reply[13] = 0x90;                   // ACK with data
+    reply[14] = SWITCH_SUBCMD_SPI_READ;
+    reply[15] = addr & 0xFF;
+    reply[16] = addr >> 8;
+    reply[19] = (uint8_t)len;
+    memcpy(&reply[20], data, len);
+
+    for (uint8_t region = 0; region < SWITCH_CAL_REGION_COUNT; region++) {
+        if (switch_cal_spi_reply(cal, region, reply, (uint16_t)(20 + len))) return true;
+    }
+    return false;
+}
+
+static void decode_report(const switch_cal_t* cal, const uint8_t* report, uint8_t imu_last[],
+                          decoded_t* out)
+{
+    uint16_t raw[4];
+    switch_cal_unpack_stick(&report[6], &raw[0], &raw[1]);
+    switch_cal_unpack_stick(&report[9], &raw[2], &raw[3]);
+
+    for (int s = 0; s < 2; s++) {
+        const switch_stick_cal_t* sc = &cal->stick[s];
+        if (!sc->valid) {
+            out->sticks[s * 2] = out->sticks[s * 2 + 1] = -1;
+            continue;
+        }
+        out->sticks[s * 2] = switch_cal_stick_axis(sc, 0, raw[s * 2]);
+        out->sticks[s * 2 + 1] = 255 - switch_cal_stick_axis(sc, 1, raw[s * 2 + 1]);  // Invert Y
+    }
+
+    const uint8_t* imu = &report[SWITCH_IMU_OFFSET];
+    out->fresh = switch_cal_new_imu_frames(imu, imu_last);
+    switch_cal_imu_frame(&cal->imu, imu, out->accel, out->gyro);
+    out->valid = true;
+}
+
+static void print_decoded(const char* file, int line, const decoded_t* d)
+{
+    printf("%s:%d: sticks", file, line);
+    for (int i = 0; i < 4; i++) {
+        if (d->sticks[i] < 0) printf(" -");
+        else printf(" %d", d->sticks[i]);
+    }
+    printf("  fresh %u  accel %d %d %d  gyro %d %d %d\n", d->fresh,
+           d->accel[0], d->accel[1], d->accel[2], d->gyro[0], d->gyro[1], d->gyro[2]);
+}
+
+static void check_expect(const char* file, int line, const char* what, const char* args,
+                         const decoded_t* d)
+{
+    checks++;
+    if (!d->valid) {
+        fail(file, line, "expect %s before any report", what);
+        return;
+    }
+
+    char tok[4][16];
+    int n = sscanf(args, "%15s %15s %15s %15s", tok[0], tok[1], tok[2], tok[3]);
+
+    if (strcmp(what, "sticks") == 0) {
+        if (n != 4) { fail(file, line, "expect sticks needs 4 values"); return; }
+        for (int i = 0; i < 4; i++) {
+            int want = (strcmp(tok[i], "-") == 0) ? -1 : atoi(tok[i]);
+            if (want != d->sticks[i]) {
+                fail(file, line, "sticks[%d] = %d, expected %s", i, d->sticks[i], tok[i]);
+            }
+        }
+    } else if (strcmp(what, "fresh") == 0) {
+        if (n != 1) { fail(file, line, "expect fresh needs 1 value"); return; }
+        if (atoi(tok[0]) != d->fresh) {
+            fail(file, line, "fresh = %u, expected %s", d->fresh, tok[0]);
+        }
+    } else if (strcmp(what, "accel") == 0 || strcmp(what, "gyro") == 0) {
+        if (n != 3) { fail(file, line, "expect %s needs 3 values", what); return; }
+        const int16_t* v = (what[0] == 'a') ? d->accel : d->gyro;
+        for (int i = 0; i < 3; i++) {
+            if (atoi(tok[i]) != v[i]) {
+                fail(file, line, "%s[%d] = %d, expected %s", what, i, v[i], tok[i]);
+            }
+        }
+    } else {
+        fail(file, line, "unknown expectation '%s'", what);
+    }
+}
+
+// ============================================================================
+// FILES
+// ============================================================================
+
+static void run_file(const char* file)
+{
+    FILE* f = fopen(file, "r");
+    if (!f) {
+        perror(file);
+        failures++;
+        return;
+    }
+
+    switch_cal_t cal;
+    switch_cal_init(&cal);
+    uint8_t imu_last[SWITCH_IMU_FRAME_SIZE] = { 0 };
+    decoded_t dec = { 0 };
+
+    char buf[MAX_LINE];
+    int line = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        line++;
+        char* s = buf;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#' || *s == '\n' || *s == '\0') continue;
+
+        if (strncmp(s, "spi ", 4) == 0) {
+            char* end;
+            unsigned long addr = strtoul(s + 4, &end, 16);
+            uint8_t data[MAX_REPORT];
+            int len = parse_hex(end, data, sizeof(data));
+            if (len <= 0 || !feed_spi(&cal, (uint16_t)addr, data, len)) {
+                fail(file, line, "SPI data for %04lX not accepted", addr);
+            }
+        } else if (strncmp(s, "report ", 7) == 0) {
+            uint8_t report[MAX_REPORT];
+            int len = parse_hex(s + 7, report, sizeof(report));
+            if (len < SWITCH_IMU_REPORT_MIN_LEN || report[0] != 0x30) {
+                fail(file, line, "not a 0x30 report of at least %d bytes", SWITCH_IMU_REPORT_MIN_LEN);
+                dec.valid = false;
+                continue;
+            }
+            decode_report(&cal, report, imu_last, &dec);
+            if (verbose) print_decoded(file, line, &dec);
+        } else if (strncmp(s, "expect ", 7) == 0) {
+            char what[16];
+            int off = 0;
+            if (sscanf(s + 7, "%15s %n", what, &off) != 1) {
+                fail(file, line, "bad expect line");
+                continue;
+            }
+            check_expect(file, line, what, s + 7 + off, &dec);
+        } else {
+            fail(file, line, "unrecognised line");
+        }
+    }
+    fclose(f);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        if (opt == 'v') verbose = true;
+        else {
+            fprintf(stderr, "usage: %s [-v] report.txt...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-v] report.txt...\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        run_file(argv[i]);
+    }
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
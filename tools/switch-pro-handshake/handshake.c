@@ -0,0 +1,804 @@
+// handshake.c - plays a Switch console against the firmware's Switch Pro mode
+//
+// Builds switch_pro_mode.c from src/ against a stub TinyUSB (stub/) and runs
+// it on a virtual clock. The mode's task runs every LOOP_US; the console
+// polls the IN endpoint every bInterval, read from the mode's own config
+// descriptor, and takes one report per poll. OUT reports go straight to
+// handle_output(), as the interrupt OUT callback does.
+//
+// The console does what a real one does at connect: 80 01, 80 02, 80 03,
+// 80 02, 80 04, then device info, SPI calibration reads, input mode 0x30,
+// IMU and vibration on, player lights. Each step waits for its reply. It
+// then streams input with motion at the given IMU rate for the run length,
+// sending rumble and a few more subcommands on the way, and checks every
+// report that comes back.
+//
+// Usage: switch-pro-handshake [-v] [-r imu_hz] [-b burst] [-d ms]
+//   -v  show every report and the firmware log
+//   -r  IMU samples per second from the source controller (default 1000)
+//   -b  samples delivered together, like BT controllers do (default 1)
+//   -d  stream length after the handshake (default 2000 ms)
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#define HOST_CHECK_MAIN // host-stub/stdio.h: keep the real printf() here
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "platform/platform.h"
+#include "usbd_mode.h"
+#include "descriptors/switch_pro_descriptors.h"
+#include "core/buttons.h"
+
+#define LOOP_US          100
+#define STEP_TIMEOUT_US  (100 * 1000)
+#define INPUT_PERIOD_US  (40 * 1000)
+#define IMU_RING         16      // PRO_IMU_RING_SIZE in the mode
+
+static uint32_t now_us;
+static uint32_t poll_us;
+static bool verbose;
+static int failures;
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL %8.3f ms: ", now_us / 1000.0);
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+// ============================================================================
+// PLATFORM AND FIRMWARE LOG
+// ============================================================================
+
+uint32_t platform_time_us(void)
+{
+    return now_us;
+}
+
+// The model calls the mode task on its own schedule
+void platform_loop_wake_in(uint32_t ms)
+{
+    (void)ms;
+}
+
+void platform_get_unique_id(uint8_t* buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)(0xA0 + i);
+}
+
+int host_fw_log(const char* fmt, ...)
+{
+    if (!verbose) return 0;
+    va_list ap;
+    va_start(ap, fmt);
+    printf("           fw: ");
+    int n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+// ============================================================================
+// EXPECTED STATE
+// ============================================================================
+
+// What the console has been told and the router has handed the mode, kept
+// independently of the mode so reports can be checked against it.
+
+static const struct {
+    uint32_t jp;
+    uint8_t  byte;      // 0 right, 1 shared, 2 left
+    uint8_t  bit;
+} button_map[] = {
+    { JP_BUTTON_B1, 0, SWITCH_PRO_BTN_B },     { JP_BUTTON_B2, 0, SWITCH_PRO_BTN_A },
+    { JP_BUTTON_B3, 0, SWITCH_PRO_BTN_Y },     { JP_BUTTON_B4, 0, SWITCH_PRO_BTN_X },
+    { JP_BUTTON_R1, 0, SWITCH_PRO_BTN_R },     { JP_BUTTON_R2, 0, SWITCH_PRO_BTN_ZR },
+    { JP_BUTTON_S1, 1, SWITCH_PRO_BTN_MINUS }, { JP_BUTTON_S2, 1, SWITCH_PRO_BTN_PLUS },
+    { JP_BUTTON_R3, 1, SWITCH_PRO_BTN_RSTICK },{ JP_BUTTON_L3, 1, SWITCH_PRO_BTN_LSTICK },
+    { JP_BUTTON_A1, 1, SWITCH_PRO_BTN_HOME },  { JP_BUTTON_A2, 1, SWITCH_PRO_BTN_CAPTURE },
+    { JP_BUTTON_DD, 2, SWITCH_PRO_BTN_DOWN },  { JP_BUTTON_DU, 2, SWITCH_PRO_BTN_UP },
+    { JP_BUTTON_DR, 2, SWITCH_PRO_BTN_RIGHT }, { JP_BUTTON_DL, 2, SWITCH_PRO_BTN_LEFT },
+    { JP_BUTTON_L1, 2, SWITCH_PRO_BTN_L },     { JP_BUTTON_L2, 2, SWITCH_PRO_BTN_ZL },
+};
+#define BUTTON_COUNT (sizeof(button_map) / sizeof(button_map[0]))
+
+typedef struct {
+    uint8_t buttons[3];
+    uint8_t left_stick[3];
+    uint8_t right_stick[3];
+} pad_state_t;
+
+static pad_state_t expect_pad;
+static bool pad_changed;            // Since the last 0x30 was queued
+static uint32_t pad_changed_us;
+
+static bool imu_on;
+static bool simple_hid = true;      // Until an input mode is set: send on change
+static int16_t imu_recent[IMU_RING][6]; // Newest samples since the last drain, [0] newest
+static uint32_t imu_pending;        // Samples since the last drain
+static int16_t imu_last[6];         // Frame held when nothing new arrived
+static uint32_t imu_fed;
+static uint32_t imu_merged;         // Samples averaged into a frame with others
+static uint32_t imu_dropped;
+
+static void pack_stick_12(uint8_t out[3], uint8_t x, uint8_t y)
+{
+    // High nibble replicated so 0x00/0x80/0xFF land on 0x000/0x808/0xFFF;
+    // Switch Y points up
+    uint16_t x12 = (uint16_t)((x << 4) | (x >> 4));
+    uint16_t y12 = (uint16_t)(0xFFF - ((y << 4) | (y >> 4)));
+    out[0] = x12 & 0xFF;
+    out[1] = (uint8_t)((x12 >> 8) | ((y12 & 0x0F) << 4));
+    out[2] = (uint8_t)(y12 >> 4);
+}
+
+static int16_t to_pro_counts(int16_t v, uint16_t range, int32_t pro_range)
+{
+    int32_t c = (int32_t)v * range / pro_range;
+    return (int16_t)(c > 32767 ? 32767 : c < -32768 ? -32768 : c);
+}
+
+// ============================================================================
+// IN ENDPOINT
+// ============================================================================
+
+typedef struct {
+    uint8_t  id;
+    uint8_t  data[SWITCH_PRO_REPORT_SIZE - 1];
+    uint16_t len;
+    uint32_t queued_us;
+    // 0x30 only: what the console should see, fixed when the mode drained
+    int16_t  imu[3][6];
+    pad_state_t pad;
+    bool     pad_was_changed;
+    bool     simple_hid;        // Report mode when it was queued
+} in_report_t;
+
+static in_report_t ep_in;
+static bool ep_busy;
+
+bool tud_hid_ready(void)
+{
+    return !ep_busy;
+}
+
+bool tud_hid_report(uint8_t report_id, void const* report, uint16_t len)
+{
+    if (ep_busy) return false;
+    if (len > sizeof(ep_in.data)) {
+        fail("report 0x%02X is %u bytes, endpoint takes %u", report_id, len,
+             (unsigned)sizeof(ep_in.data));
+        len = sizeof(ep_in.data);
+    }
+    memset(&ep_in, 0, sizeof(ep_in));
+    ep_in.id = report_id;
+    memcpy(ep_in.data, report, len);
+    ep_in.len = len;
+    ep_in.queued_us = now_us;
+
+    if (report_id == SWITCH_PRO_IN_FULL) {
+        // The mode drains its IMU ring as it builds the report
+        if (imu_on) {
+            // The ring keeps the newest IMU_RING; the rest were overwritten
+            uint32_t n = imu_pending < IMU_RING ? imu_pending : IMU_RING;
+            imu_dropped += imu_pending - n;
+            for (uint32_t i = 0; i < 3; i++) {
+                if (n == 0) {
+                    memcpy(ep_in.imu[i], imu_last, sizeof(imu_last));
+                } else if (n < 3) {
+                    memcpy(ep_in.imu[i], imu_recent[i < n ? i : n - 1], sizeof(imu_last));
+                } else {
+                    // Frame i averages the samples aged [i*n/3, (i+1)*n/3)
+                    uint32_t first = i * n / 3, end = (i + 1) * n / 3;
+                    for (int k = 0; k < 6; k++) {
+                        int32_t sum = 0;
+                        for (uint32_t age = first; age < end; age++) sum += imu_recent[age][k];
+                        ep_in.imu[i][k] = (int16_t)(sum / (int32_t)(end - first));
+                    }
+                }
+            }
+            if (n > 0) memcpy(imu_last, ep_in.imu[0], sizeof(imu_last));
+            if (n > 3) imu_merged += n;
+            imu_pending = 0;
+        }
+        ep_in.pad = expect_pad;
+        ep_in.pad_was_changed = pad_changed;
+        ep_in.simple_hid = simple_hid;
+        pad_changed = false;
+    }
+    ep_busy = true;
+    return true;
+}
+
+// ============================================================================
+// CONSOLE SCRIPT
+// ============================================================================
+
+typedef struct {
+    uint32_t at_ms;     // Stream phase: send at this time after the handshake
+    uint8_t  report;    // 0x80 USB command, 0x01 subcommand, 0x10 rumble only
+    uint8_t  cmd;
+    uint8_t  args[8];
+    uint8_t  args_len;
+    uint8_t  ack;       // Expected 0x21 ack byte
+    uint8_t  rumble[8]; // Rumble only; all zero = neutral
+} step_t;
+
+#define NEUTRAL_RUMBLE { 0x00, 0x01, 0x40, 0x40, 0x00, 0x01, 0x40, 0x40 }
+
+static const step_t connect_script[] = {
+    { 0, 0x80, SWITCH_PRO_USB_STATUS },
+    { 0, 0x80, SWITCH_PRO_USB_HANDSHAKE },
+    { 0, 0x80, SWITCH_PRO_USB_BAUDRATE },
+    { 0, 0x80, SWITCH_PRO_USB_HANDSHAKE },
+    { 0, 0x80, SWITCH_PRO_USB_HID_ONLY },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_DEVICE_INFO, {0}, 0, 0x82 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_SHIPMENT, { 0x00 }, 1, 0x80 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x00, 0x60, 0, 0, 0x10 }, 5, 0x90 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x50, 0x60, 0, 0, 0x0C }, 5, 0x90 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x80, 0x60, 0, 0, 0x18 }, 5, 0x90 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x98, 0x60, 0, 0, 0x12 }, 5, 0x90 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x10, 0x80, 0, 0, 0x18 }, 5, 0x90 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x3D, 0x60, 0, 0, 0x19 }, 5, 0x90 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x26, 0x80, 0, 0, 0x1A }, 5, 0x90 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x20, 0x60, 0, 0, 0x18 }, 5, 0x90 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_REPORT_MODE, { SWITCH_PRO_MODE_FULL }, 1, 0x80 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_IMU_ENABLE, { 0x01 }, 1, 0x80 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_VIBRATION, { 0x01 }, 1, 0x80 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_PLAYER_LEDS, { 0x01 }, 1, 0x80 },
+    { 0, 0x01, SWITCH_PRO_SUBCMD_HOME_LED, { 0x0F, 0xF0, 0x00 }, 3, 0x80 },
+};
+
+// Stream phase, times relative to the end of the handshake. The last step
+// falls back to simple HID so the rest of the run checks send-on-change.
+static const step_t stream_script[] = {
+    { 300, 0x10, 0, {0}, 0, 0, { 0x00, 0xC8, 0x40, 0x40, 0x00, 0x01, 0x40, 0x59 } },
+    { 400, 0x10, 0, {0}, 0, 0, NEUTRAL_RUMBLE },
+    { 500, 0x01, SWITCH_PRO_SUBCMD_PLAYER_LEDS, { 0x0F }, 1, 0x80 },
+    { 700, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x18, 0x60, 0, 0, 0x1D }, 5, 0x90 },
+    { 710, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x86, 0x60, 0, 0, 0x30 }, 5, 0x90 },
+    { 720, 0x01, SWITCH_PRO_SUBCMD_SPI_READ, { 0x00, 0x60 }, 2, 0x00 },
+    { 800, 0x01, SWITCH_PRO_SUBCMD_MCU_CONFIG, { 0x21, 0x00, 0x00 }, 3, 0xA0 },
+    { 1500, 0x01, SWITCH_PRO_SUBCMD_REPORT_MODE, { SWITCH_PRO_MODE_SIMPLE_HID }, 1, 0x80 },
+};
+
+static uint8_t spi_image[0x10000];
+static bool spi_seen[0x10000];
+
+static uint8_t mac[6];
+static int last_timer = -1;
+
+static const step_t* waiting;       // Sent, reply not yet seen
+static uint32_t waiting_since;
+
+static void send_step(const step_t* s, uint8_t counter)
+{
+    uint8_t out[SWITCH_PRO_REPORT_SIZE] = { s->report };
+    uint16_t len;
+    if (s->report == SWITCH_PRO_OUT_USB_CMD) {
+        out[1] = s->cmd;
+        len = 2;
+    } else {
+        uint8_t neutral[8] = NEUTRAL_RUMBLE;
+        bool has_rumble = memcmp(s->rumble, (uint8_t[8]){0}, 8) != 0;
+        out[1] = counter & 0x0F;
+        memcpy(&out[2], has_rumble ? s->rumble : neutral, 8);
+        out[10] = s->cmd;
+        memcpy(&out[11], s->args, s->args_len);
+        len = s->report == SWITCH_PRO_OUT_RUMBLE_ONLY ? 10 : (uint16_t)(11 + s->args_len);
+    }
+
+    if (verbose) {
+        printf("%8.3f ms  OUT", now_us / 1000.0);
+        for (uint16_t i = 0; i < len; i++) printf(" %02X", out[i]);
+        printf("\n");
+    }
+
+    // Interrupt OUT: report ID 0 with the real ID in data[0]
+    switch_pro_mode.handle_output(0, out, len);
+
+    if (s->report == SWITCH_PRO_OUT_RUMBLE_SUBCMD) {
+        if (s->cmd == SWITCH_PRO_SUBCMD_IMU_ENABLE) {
+            imu_on = s->args[0] != 0;
+            imu_pending = 0;
+        }
+        if (s->cmd == SWITCH_PRO_SUBCMD_REPORT_MODE) {
+            simple_hid = s->args[0] != SWITCH_PRO_MODE_FULL;
+        }
+    }
+
+    // 80 04 and rumble-only get no reply
+    bool replies = !(s->report == SWITCH_PRO_OUT_USB_CMD && s->cmd == SWITCH_PRO_USB_HID_ONLY) &&
+                   s->report != SWITCH_PRO_OUT_RUMBLE_ONLY;
+    waiting = replies ? s : NULL;
+    waiting_since = now_us;
+}
+
+static void check_spi_reply(const step_t* s, const uint8_t* data)
+{
+    uint32_t addr = s->args[0] | (s->args[1] << 8) | (s->args[2] << 16) | ((uint32_t)s->args[3] << 24);
+    uint8_t want_len = s->args[4] > 0x1D ? 0x1D : s->args[4];
+    if (memcmp(data, s->args, 4) != 0 || data[4] != want_len) {
+        fail("SPI read 0x%04X: reply echoes %02X%02X%02X%02X len %u, want len %u",
+             addr, data[3], data[2], data[1], data[0], data[4], want_len);
+        return;
+    }
+    for (uint8_t i = 0; i < want_len; i++) {
+        uint32_t a = (addr + i) & 0xFFFF;
+        if (spi_seen[a] && spi_image[a] != data[5 + i]) {
+            fail("SPI 0x%04X reads 0x%02X, an earlier read gave 0x%02X", a, data[5 + i], spi_image[a]);
+            return;
+        }
+        spi_image[a] = data[5 + i];
+        spi_seen[a] = true;
+    }
+}
+
+static void check_subcmd_reply(const uint8_t* body)
+{
+    const switch_pro_subcmd_reply_t* r = (const switch_pro_subcmd_reply_t*)body;
+    const step_t* s = waiting;
+    if (!s || s->report != SWITCH_PRO_OUT_RUMBLE_SUBCMD) {
+        fail("0x21 reply (subcmd 0x%02X) nobody asked for", r->subcmd);
+        return;
+    }
+    if (r->subcmd != s->cmd || r->ack != s->ack) {
+        fail("subcmd 0x%02X: reply ack 0x%02X subcmd 0x%02X, want ack 0x%02X",
+             s->cmd, r->ack, r->subcmd, s->ack);
+    } else if (s->cmd == SWITCH_PRO_SUBCMD_DEVICE_INFO) {
+        uint8_t want[12] = { 0x03, 0x48, 0x03, 0x02 };
+        memcpy(&want[4], mac, 6);
+        want[10] = 0x01;
+        want[11] = 0x01;
+        if (memcmp(r->data, want, sizeof(want)) != 0) fail("device info: wrong body");
+    } else if (s->cmd == SWITCH_PRO_SUBCMD_SPI_READ && s->ack == 0x90) {
+        check_spi_reply(s, r->data);
+    }
+    if (r->std.battery_conn != 0x91) {
+        fail("subcmd 0x%02X reply: battery/connection 0x%02X", s->cmd, r->std.battery_conn);
+    }
+}
+
+static void check_usb_reply(const uint8_t* body)
+{
+    const step_t* s = waiting;
+    if (!s || s->report != SWITCH_PRO_OUT_USB_CMD) {
+        fail("0x81 reply (cmd 0x%02X) nobody asked for", body[0]);
+        return;
+    }
+    if (body[0] != s->cmd) {
+        fail("80 %02X: reply echoes 0x%02X", s->cmd, body[0]);
+        return;
+    }
+    if (s->cmd == SWITCH_PRO_USB_STATUS) {
+        // 00, type 03 (Pro Controller), MAC big-endian
+        if (body[1] != 0x00 || body[2] != 0x03) {
+            fail("80 01: type %02X %02X, want 00 03", body[1], body[2]);
+        }
+        memcpy(mac, &body[3], 6);
+        if ((mac[0] & 0x03) != 0x02) fail("80 01: MAC %02X:.. is not locally administered unicast", mac[0]);
+    }
+}
+
+// ============================================================================
+// REPORT CHECKS
+// ============================================================================
+
+static uint32_t full_reports;
+static uint32_t last_full_queued;
+static uint32_t longest_gap;
+static bool reply_since_full;       // A 0x21/0x81 took a poll since the last 0x30
+
+static void check_timer(uint8_t timer, uint8_t id)
+{
+    if (last_timer >= 0 && timer != (uint8_t)(last_timer + 1)) {
+        fail("report 0x%02X timer %u after %d", id, timer, last_timer);
+    }
+    last_timer = timer;
+}
+
+static void check_full_report(const in_report_t* in)
+{
+    const switch_pro_full_report_t* r = (const switch_pro_full_report_t*)in->data;
+    full_reports++;
+
+    if (in->len != sizeof(switch_pro_full_report_t)) fail("0x30 is %u bytes", in->len);
+    check_timer(r->std.timer, SWITCH_PRO_IN_FULL);
+
+    if (memcmp(r->std.buttons, in->pad.buttons, 3) != 0 ||
+        memcmp(r->std.left_stick, in->pad.left_stick, 3) != 0 ||
+        memcmp(r->std.right_stick, in->pad.right_stick, 3) != 0) {
+        fail("0x30 buttons %02X %02X %02X sticks %02X%02X%02X %02X%02X%02X, want "
+             "%02X %02X %02X sticks %02X%02X%02X %02X%02X%02X",
+             r->std.buttons[0], r->std.buttons[1], r->std.buttons[2],
+             r->std.left_stick[0], r->std.left_stick[1], r->std.left_stick[2],
+             r->std.right_stick[0], r->std.right_stick[1], r->std.right_stick[2],
+             in->pad.buttons[0], in->pad.buttons[1], in->pad.buttons[2],
+             in->pad.left_stick[0], in->pad.left_stick[1], in->pad.left_stick[2],
+             in->pad.right_stick[0], in->pad.right_stick[1], in->pad.right_stick[2]);
+    }
+
+    for (int i = 0; i < 3 && imu_on; i++) {
+        const switch_pro_imu_frame_t* f = &r->imu[i];
+        int16_t got[6] = { f->accel[0], f->accel[1], f->accel[2], f->gyro[0], f->gyro[1], f->gyro[2] };
+        if (memcmp(got, in->imu[i], sizeof(got)) != 0) {
+            fail("0x30 IMU frame %d: gyro %d %d %d, want %d %d %d", i,
+                 got[3], got[4], got[5], in->imu[i][3], in->imu[i][4], in->imu[i][5]);
+            break;
+        }
+    }
+
+    if (in->simple_hid) {
+        if (!in->pad_was_changed) fail("simple HID: 0x30 sent with nothing changed");
+    } else if (full_reports > 1 && !reply_since_full) {
+        uint32_t gap = in->queued_us - last_full_queued;
+        if (gap < SWITCH_PRO_REPORT_INTERVAL_US) fail("0x30 only %u us after the last", gap);
+        if (gap > longest_gap) longest_gap = gap;
+    }
+    last_full_queued = in->queued_us;
+    reply_since_full = false;
+}
+
+// Console side of one poll: take the queued report, if any
+static void poll_in(void)
+{
+    if (!ep_busy) return;
+    ep_busy = false;
+
+    // Replies go ahead of 0x30 streaming: at worst one report already on
+    // the endpoint is in front
+    if (waiting && ep_in.id != SWITCH_PRO_IN_FULL &&
+        now_us - waiting_since > 2 * poll_us + LOOP_US) {
+        fail("reply to %02X %02X took %u us", waiting->report, waiting->cmd, now_us - waiting_since);
+    }
+
+    if (verbose) {
+        printf("%8.3f ms  IN  %02X", now_us / 1000.0, ep_in.id);
+        for (uint16_t i = 0; i < 16 && i < ep_in.len; i++) printf(" %02X", ep_in.data[i]);
+        printf(" ...\n");
+    }
+
+    switch (ep_in.id) {
+        case SWITCH_PRO_IN_USB_REPLY:
+            check_usb_reply(ep_in.data);
+            waiting = NULL;
+            reply_since_full = true;
+            break;
+        case SWITCH_PRO_IN_SUBCMD_REPLY:
+            check_timer(ep_in.data[0], ep_in.id);
+            check_subcmd_reply(ep_in.data);
+            waiting = NULL;
+            reply_since_full = true;
+            break;
+        case SWITCH_PRO_IN_FULL:
+            check_full_report(&ep_in);
+            break;
+        default:
+            fail("unknown input report 0x%02X", ep_in.id);
+            break;
+    }
+}
+
+// ============================================================================
+// DESCRIPTORS
+// ============================================================================
+
+static void check_descriptors(void)
+{
+    const tusb_desc_device_t* dev = (const tusb_desc_device_t*)switch_pro_mode.get_device_descriptor();
+    if (dev->idVendor != 0x057E || dev->idProduct != 0x2009) {
+        fail("device descriptor %04X:%04X, want 057E:2009", dev->idVendor, dev->idProduct);
+    }
+
+    // Config: total length, one HID interface, report descriptor length, EP IN interval
+    const uint8_t* cfg = switch_pro_mode.get_config_descriptor();
+    uint16_t total = cfg[2] | (cfg[3] << 8);
+    if (total != sizeof(switch_pro_config_descriptor)) {
+        fail("config wTotalLength %u, descriptor is %zu bytes", total, sizeof(switch_pro_config_descriptor));
+    }
+    for (uint16_t off = 0; off < total && cfg[off]; off += cfg[off]) {
+        const uint8_t* d = &cfg[off];
+        if (d[1] == HID_DESC_TYPE_HID) {
+            uint16_t rlen = d[7] | (d[8] << 8);
+            if (rlen != sizeof(switch_pro_report_descriptor)) {
+                fail("HID descriptor says %u report bytes, report descriptor is %zu", rlen,
+                     sizeof(switch_pro_report_descriptor));
+            }
+        } else if (d[1] == TUSB_DESC_ENDPOINT && d[2] == 0x81) {
+            poll_us = d[6] * 1000u;     // Full-speed interrupt: bInterval in ms
+        }
+    }
+    if (!poll_us) {
+        fail("no IN endpoint 0x81 in the config descriptor");
+        poll_us = 8000;
+    }
+
+    // Report descriptor: every report the protocol uses is 63 bytes after the ID
+    struct { uint8_t id; bool input; } want[] = {
+        { SWITCH_PRO_IN_FULL, true }, { SWITCH_PRO_IN_SUBCMD_REPLY, true },
+        { SWITCH_PRO_IN_USB_REPLY, true }, { SWITCH_PRO_OUT_RUMBLE_SUBCMD, false },
+        { SWITCH_PRO_OUT_RUMBLE_ONLY, false }, { SWITCH_PRO_OUT_USB_CMD, false },
+    };
+    uint32_t in_bits[256] = {0}, out_bits[256] = {0};
+    const uint8_t* rd = switch_pro_mode.get_report_descriptor();
+    uint32_t size = 0, count = 0;
+    uint8_t id = 0;
+    for (size_t i = 0; i < sizeof(switch_pro_report_descriptor);) {
+        uint8_t prefix = rd[i];
+        uint8_t n = (prefix & 3) == 3 ? 4 : (prefix & 3);
+        uint32_t v = 0;
+        for (uint8_t b = 0; b < n; b++) v |= (uint32_t)rd[i + 1 + b] << (8 * b);
+        switch (prefix & 0xFC) {
+            case 0x74: size = v; break;
+            case 0x94: count = v; break;
+            case 0x84: id = (uint8_t)v; break;
+            case 0x80: in_bits[id] += size * count; break;
+            case 0x90: out_bits[id] += size * count; break;
+            default: break;
+        }
+        i += 1 + n;
+    }
+    for (size_t w = 0; w < sizeof(want) / sizeof(want[0]); w++) {
+        uint32_t bits = want[w].input ? in_bits[want[w].id] : out_bits[want[w].id];
+        if (bits != 63 * 8) {
+            fail("report descriptor: %s report 0x%02X is %u bits, want 504",
+                 want[w].input ? "input" : "output", want[w].id, bits);
+        }
+    }
+}
+
+// Calibration the console read during the handshake
+static void check_spi_image(void)
+{
+    static const struct { uint16_t addr; uint8_t len; bool erased; const char* what; } blocks[] = {
+        { SWITCH_PRO_SPI_SERIAL,         16, true,  "serial" },
+        { SWITCH_PRO_SPI_IMU_FACTORY,    24, false, "factory IMU cal" },
+        { SWITCH_PRO_SPI_STICK_FACTORY,  18, false, "factory stick cal" },
+        { SWITCH_PRO_SPI_COLORS,         12, false, "colors" },
+        { SWITCH_PRO_SPI_IMU_HORIZONTAL,  6, false, "IMU horizontal offsets" },
+        { SWITCH_PRO_SPI_STICK_PARAMS_L, 18, false, "left stick parameters" },
+        { SWITCH_PRO_SPI_STICK_PARAMS_R, 18, false, "right stick parameters" },
+        { SWITCH_PRO_SPI_STICK_USER,     22, true,  "user stick cal" },
+        { SWITCH_PRO_SPI_IMU_USER,       26, true,  "user IMU cal" },
+    };
+    for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+        bool all_ff = true;
+        for (uint8_t i = 0; i < blocks[b].len; i++) {
+            if (!spi_seen[blocks[b].addr + i]) {
+                fail("console never read %s at 0x%04X", blocks[b].what, blocks[b].addr + i);
+                return;
+            }
+            if (spi_image[blocks[b].addr + i] != 0xFF) all_ff = false;
+        }
+        if (all_ff != blocks[b].erased) {
+            fail("%s is %s", blocks[b].what, all_ff ? "erased" : "not erased");
+        }
+    }
+
+    // Stick factory cal, as hid-nintendo reads it. Left: max above center,
+    // center, min below center; right: center, min below, max above.
+    const uint8_t* c = &spi_image[SWITCH_PRO_SPI_STICK_FACTORY];
+    static const int center_slot[2] = { 1, 3 };
+    for (int s = 0; s < 2; s++) {
+        const uint8_t* p = &c[center_slot[s] * 3];
+        uint16_t cx = (uint16_t)(p[0] | ((p[1] & 0x0F) << 8));
+        uint16_t cy = (uint16_t)((p[1] >> 4) | (p[2] << 4));
+        if (cx < 0x700 || cx > 0x900 || cy < 0x700 || cy > 0x900) {
+            fail("%s stick factory center %03X,%03X is not near 0x800", s ? "right" : "left", cx, cy);
+        }
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+typedef struct {
+    uint32_t state;
+} lcg_t;
+
+static uint32_t lcg_next(lcg_t* r, uint32_t lo, uint32_t hi)
+{
+    r->state = r->state * 1103515245u + 12345u;
+    return lo + (r->state >> 8) % (hi - lo + 1);
+}
+
+static void feed_pad(lcg_t* rng)
+{
+    uint32_t buttons = 0;
+    for (uint32_t i = lcg_next(rng, 0, 3); i > 0; i--) {
+        buttons |= button_map[lcg_next(rng, 0, BUTTON_COUNT - 1)].jp;
+    }
+    profile_output_t out;
+    memset(&out, 0, sizeof(out));
+    out.left_x = (uint8_t)lcg_next(rng, 0, 255);
+    out.left_y = (uint8_t)lcg_next(rng, 0, 255);
+    out.right_x = (uint8_t)lcg_next(rng, 0, 255);
+    out.right_y = (uint8_t)lcg_next(rng, 0, 255);
+    if (lcg_next(rng, 0, 3) == 0) {
+        // Held still: the router calls again with the same state
+        buttons = 0;
+        out.left_x = out.left_y = out.right_x = out.right_y = 0x80;
+    }
+
+    pad_state_t next = {0};
+    for (size_t i = 0; i < BUTTON_COUNT; i++) {
+        if (buttons & button_map[i].jp) next.buttons[button_map[i].byte] |= button_map[i].bit;
+    }
+    pack_stick_12(next.left_stick, out.left_x, out.left_y);
+    pack_stick_12(next.right_stick, out.right_x, out.right_y);
+    if (memcmp(&next, &expect_pad, sizeof(next)) != 0) {
+        expect_pad = next;
+        if (!pad_changed) pad_changed_us = now_us;
+        pad_changed = true;
+    }
+
+    input_event_t event;
+    init_input_event(&event);
+    event.buttons = buttons;
+    switch_pro_mode.send_report(0, &event, &out, buttons);
+}
+
+static void feed_imu(lcg_t* rng)
+{
+    input_event_t event;
+    init_input_event(&event);
+    event.has_motion = true;
+    event.accel_range = 4000;   // DS4/DS5
+    event.gyro_range = 2000;
+    for (int i = 0; i < 3; i++) {
+        event.accel[i] = (int16_t)((int32_t)lcg_next(rng, 0, 65535) - 32768);
+        event.gyro[i] = (int16_t)((int32_t)lcg_next(rng, 0, 65535) - 32768);
+    }
+    // The mode reads only player 0; other players must not reach the ring
+    switch_pro_mode.on_input(1, &event);
+    switch_pro_mode.on_input(0, &event);
+    imu_fed++;
+
+    if (!imu_on) return;
+    memmove(imu_recent[1], imu_recent[0], (IMU_RING - 1) * sizeof(imu_recent[0]));
+    for (int i = 0; i < 3; i++) {
+        imu_recent[0][i] = to_pro_counts(event.accel[i], event.accel_range, 8000);
+        imu_recent[0][3 + i] = to_pro_counts(event.gyro[i], event.gyro_range, 2000);
+    }
+    imu_pending++;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t imu_hz = 1000, burst = 1, stream_ms = 2000;
+    int opt;
+    while ((opt = getopt(argc, argv, "vr:b:d:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 'r': imu_hz = (uint32_t)atoi(optarg); break;
+            case 'b': burst = (uint32_t)atoi(optarg); break;
+            case 'd': stream_ms = (uint32_t)atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-r imu_hz] [-b burst] [-d ms]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (burst == 0) burst = 1;
+
+    printf("imu %u Hz, burst %u, stream %u ms\n", imu_hz, burst, stream_ms);
+    check_descriptors();
+    switch_pro_mode.init();
+
+    lcg_t rng = { 0x5A17 + imu_hz * 31 + burst };
+    uint32_t imu_period = imu_hz ? 1000000u * burst / imu_hz : 0;
+    uint32_t next_imu = 0, next_pad = 0, next_poll = poll_us;
+    size_t connect_i = 0, stream_i = 0;
+    uint32_t stream_t0 = 0, handshake_us = 0;
+    uint32_t longest_wait = 0;
+    uint8_t counter = 0;
+    bool streaming = false;
+    bool done = false;
+
+    for (now_us = LOOP_US; !done; now_us += LOOP_US) {
+        // Source controller and router
+        if (imu_period && now_us >= next_imu) {
+            for (uint32_t i = 0; i < burst; i++) feed_imu(&rng);
+            next_imu += imu_period;
+        }
+        if (now_us >= next_pad) {
+            feed_pad(&rng);
+            next_pad += INPUT_PERIOD_US;
+        }
+
+        switch_pro_mode.task();
+
+        if (now_us >= next_poll) {
+            poll_in();
+            next_poll += poll_us;
+        }
+
+        // Nothing streams before 80 04 (the fifth step)
+        if (!streaming && full_reports && connect_i < 5) {
+            fail("0x30 report before the console asked for one");
+        }
+
+        if (waiting) {
+            uint32_t wait = now_us - waiting_since;
+            if (wait > longest_wait) longest_wait = wait;
+            if (wait > STEP_TIMEOUT_US) {
+                fail("no reply to %02X %02X within %u ms", waiting->report, waiting->cmd,
+                     STEP_TIMEOUT_US / 1000);
+                waiting = NULL;
+            }
+            continue;
+        }
+
+        if (!streaming) {
+            if (connect_i < sizeof(connect_script) / sizeof(connect_script[0])) {
+                send_step(&connect_script[connect_i++], counter++);
+            } else {
+                streaming = true;
+                handshake_us = now_us;
+                stream_t0 = now_us;
+                full_reports = 0;
+                check_spi_image();
+                output_feedback_t fb;
+                switch_pro_mode.get_feedback(&fb);
+                if (fb.led_player != 1) fail("player lights 0x01: feedback says player %u", fb.led_player);
+            }
+            continue;
+        }
+
+        uint32_t t_ms = (now_us - stream_t0) / 1000;
+        if (stream_i < sizeof(stream_script) / sizeof(stream_script[0]) &&
+            t_ms >= stream_script[stream_i].at_ms) {
+            const step_t* s = &stream_script[stream_i++];
+            send_step(s, counter++);
+
+            output_feedback_t fb;
+            if (s->report == SWITCH_PRO_OUT_RUMBLE_ONLY) {
+                // Left HF amplitude 0x64 (full), right LF amplitude 0x19 (half)
+                bool on = s->rumble[1] == 0xC8;
+                switch_pro_mode.get_feedback(&fb);
+                if (!fb.dirty || fb.rumble_left != (on ? 255 : 0) || fb.rumble_right != (on ? 127 : 0)) {
+                    fail("rumble: feedback %u/%u dirty %d, want %u/%u", fb.rumble_left,
+                         fb.rumble_right, fb.dirty, on ? 255 : 0, on ? 127 : 0);
+                }
+            } else if (s->cmd == SWITCH_PRO_SUBCMD_PLAYER_LEDS) {
+                switch_pro_mode.get_feedback(&fb);
+                if (fb.led_player != 4) fail("player lights 0x0F: feedback says player %u", fb.led_player);
+            }
+        }
+
+        // Simple HID: a change goes out by the next poll after the task sees it
+        if (simple_hid && pad_changed && now_us - pad_changed_us > 2 * poll_us + LOOP_US) {
+            fail("simple HID: change at %.3f ms not sent", pad_changed_us / 1000.0);
+            pad_changed = false;
+        }
+
+        if (t_ms >= stream_ms) done = true;
+    }
+
+    // Samples still pending past the ring size are already overwritten
+    if (imu_pending > IMU_RING) imu_dropped += imu_pending - IMU_RING;
+    if (switch_pro_mode_get_imu_dropped() != imu_dropped) {
+        fail("imu_dropped is %u, %u samples never reached a report",
+             switch_pro_mode_get_imu_dropped(), imu_dropped);
+    }
+
+    // Full mode runs at the controller's cadence; a reply can take one poll
+    uint32_t gap_limit = SWITCH_PRO_REPORT_INTERVAL_US + 2 * poll_us;
+    if (longest_gap > gap_limit) fail("longest 0x30 gap %u us, limit %u", longest_gap, gap_limit);
+
+    printf("  handshake %.1f ms, longest reply wait %.1f ms, %u reports, "
+           "longest gap %.1f ms, imu fed %u merged %u dropped %u\n",
+           handshake_us / 1000.0, longest_wait / 1000.0, full_reports, longest_gap / 1000.0,
+           imu_fed, imu_merged, imu_dropped);
+    printf("  %s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
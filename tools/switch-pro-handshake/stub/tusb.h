@@ -0,0 +1,93 @@
+// tusb.h - minimal TinyUSB surface for building switch_pro_mode.c on the
+// host. Only what that file, usbd_mode.h and switch_pro_descriptors.h touch.
+
+#ifndef HANDSHAKE_TUSB_H
+#define HANDSHAKE_TUSB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define TU_ATTR_PACKED        __attribute__((packed))
+#define TU_BIT(n)             (1UL << (n))
+#define U16_TO_U8S_LE(u16)    (uint8_t)((u16) & 0xFF), (uint8_t)(((u16) >> 8) & 0xFF)
+
+typedef enum {
+    TUSB_DESC_DEVICE        = 0x01,
+    TUSB_DESC_CONFIGURATION = 0x02,
+    TUSB_DESC_INTERFACE     = 0x04,
+    TUSB_DESC_ENDPOINT      = 0x05,
+} tusb_desc_type_t;
+
+typedef enum {
+    TUSB_XFER_INTERRUPT = 3,
+} tusb_xfer_type_t;
+
+#define TUSB_CLASS_HID 0x03
+
+typedef enum {
+    HID_DESC_TYPE_HID    = 0x21,
+    HID_DESC_TYPE_REPORT = 0x22,
+} hid_descriptor_type_t;
+
+typedef enum {
+    HID_REPORT_TYPE_INVALID = 0,
+    HID_REPORT_TYPE_INPUT,
+    HID_REPORT_TYPE_OUTPUT,
+    HID_REPORT_TYPE_FEATURE,
+} hid_report_type_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t  iManufacturer;
+    uint8_t  iProduct;
+    uint8_t  iSerialNumber;
+    uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bmRequestType;
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+typedef enum {
+    XFER_RESULT_SUCCESS = 0,
+    XFER_RESULT_FAILED,
+} xfer_result_t;
+
+#define TUD_CONFIG_DESC_LEN     9
+#define TUD_HID_INOUT_DESC_LEN  (9 + 9 + 7 + 7)
+
+#define TUD_CONFIG_DESCRIPTOR(config_num, _itfcount, _stridx, _total_len, _attribute, _power_ma) \
+    9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(_total_len), _itfcount, config_num, _stridx, \
+    TU_BIT(7) | _attribute, (_power_ma) / 2
+
+// IN endpoint, implemented by handshake.c against its simulated console
+bool tud_hid_ready(void);
+bool tud_hid_report(uint8_t report_id, void const* report, uint16_t len);
+
+#endif // HANDSHAKE_TUSB_H
@@ -0,0 +1,548 @@
+// gate.c - host check of the USB report repeat policy and the reports it saves
+//
+// Builds usbd_report.c, hid_mode.c and pcemini_mode.c from src/ against
+// stub/tusb.h. usbd_report_send() and the idle repeat below have the same
+// shape as usbd.c's (which needs all of TinyUSB): one gate per interface and
+// report ID, check, send, commit on success.
+//
+// Checks:
+//   - the gate's compare matches memcmp for every length and alignment, and
+//     its policy, idle timing (including millisecond wrap) and reset rules;
+//   - replaying scripted sessions through the real modes on a simulated
+//     host, the host sees every change the mode built, in order, and ends on
+//     the last one;
+//   - with no idle rate an unchanged report never goes out twice, and with
+//     SET_IDLE the last report repeats once per idle period, never early;
+//   - the counts sent, suppressed and repeated are printed per session
+//     against the every-event baseline, with minimum savings checked.
+//
+// Usage: usbd-report-gate [-v] [-f fail_every]
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "usbd_mode.h"
+#include "usbd_report.h"
+#include "core/buttons.h"
+
+#define LOG_MAX     40000
+
+static bool verbose;
+static int failures;
+static uint32_t fail_every;             // Every Nth tud_hid_n_report() fails
+static uint32_t seed = 1;
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+// ============================================================================
+// PLATFORM
+// ============================================================================
+
+static uint32_t now_ms;
+
+uint32_t platform_time_ms(void)
+{
+    return now_ms;
+}
+
+// Sessions run the mode task every simulated millisecond
+void platform_loop_wake_in(uint32_t ms)
+{
+    (void)ms;
+}
+
+// ============================================================================
+// SIMULATED HOST
+// ============================================================================
+
+typedef struct {
+    uint8_t  bytes[USBD_REPORT_MAX_LEN];
+    uint16_t len;
+    uint32_t t;
+} logged_report_t;
+
+// Reports the mode built (before the gate) and reports the host received
+static logged_report_t built[LOG_MAX], received[LOG_MAX];
+static uint32_t built_count, received_count;
+
+static struct {
+    bool     busy;                      // Report queued, host hasn't polled yet
+    uint8_t  bytes[USBD_REPORT_MAX_LEN];
+    uint16_t len;
+    uint32_t calls;
+} ep;
+
+static bool same_report(const logged_report_t* a, const logged_report_t* b)
+{
+    return a->len == b->len && memcmp(a->bytes, b->bytes, a->len) == 0;
+}
+
+static void log_report(logged_report_t* log, uint32_t* count, const void* report, uint16_t len)
+{
+    if (*count >= LOG_MAX) return;
+    logged_report_t* r = &log[(*count)++];
+    r->len = len;
+    r->t = now_ms;
+    memcpy(r->bytes, report, len);
+}
+
+bool tud_hid_n_ready(uint8_t instance)
+{
+    return instance == 0 && !ep.busy;
+}
+
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const* report, uint16_t len)
+{
+    if (!tud_hid_n_ready(instance) || len > USBD_REPORT_MAX_LEN) return false;
+    if (fail_every && (++ep.calls % fail_every) == 0) return false;
+    ep.busy = true;
+    ep.len = len;
+    memcpy(ep.bytes, report, len);
+    return true;
+}
+
+// Host polls the IN endpoint once per bInterval
+static void host_poll(void)
+{
+    if (!ep.busy) return;
+    log_report(received, &received_count, ep.bytes, ep.len);
+    ep.busy = false;
+}
+
+// ============================================================================
+// USBD REPORT PATH (same shape as usbd.c)
+// ============================================================================
+
+#define GATES   4
+
+typedef struct {
+    bool used;
+    uint8_t itf;
+    uint8_t report_id;
+    usbd_report_gate_t gate;
+} slot_t;
+
+static slot_t slots[GATES];
+static const usbd_mode_t* current_mode;
+static uint8_t idle_rate;               // SET_IDLE for interface 0
+
+static usbd_repeat_policy_t repeat_policy(void)
+{
+    return current_mode ? current_mode->repeat_policy : USBD_REPEAT_EVERY_EVENT;
+}
+
+static usbd_report_gate_t* gate_for(uint8_t itf, uint8_t report_id)
+{
+    slot_t* free_slot = NULL;
+    for (int i = 0; i < GATES; i++) {
+        if (slots[i].used && slots[i].itf == itf && slots[i].report_id == report_id) {
+            return &slots[i].gate;
+        }
+        if (!slots[i].used && !free_slot) free_slot = &slots[i];
+    }
+    if (!free_slot) return NULL;
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->used = true;
+    free_slot->itf = itf;
+    free_slot->report_id = report_id;
+    free_slot->gate.idle_rate = (itf == 0) ? idle_rate : 0;
+    return &free_slot->gate;
+}
+
+bool usbd_report_send(uint8_t itf, uint8_t report_id, const void* report, uint16_t len)
+{
+    log_report(built, &built_count, report, len);
+
+    usbd_repeat_policy_t policy = repeat_policy();
+    if (policy == USBD_REPEAT_EVERY_EVENT) {
+        return tud_hid_n_report(itf, report_id, report, len);
+    }
+
+    usbd_report_gate_t* gate = gate_for(itf, report_id);
+    uint32_t now = platform_time_ms();
+    if (gate && !usbd_report_gate_check(gate, policy, report, len, now)) {
+        return false;
+    }
+    if (!tud_hid_n_report(itf, report_id, report, len)) {
+        return false;
+    }
+    if (gate) usbd_report_gate_commit(gate, report, len, now);
+    return true;
+}
+
+static void idle_task(void)
+{
+    usbd_repeat_policy_t policy = repeat_policy();
+    if (policy != USBD_REPEAT_HID_IDLE) return;
+
+    uint32_t now = platform_time_ms();
+    for (int i = 0; i < GATES; i++) {
+        slot_t* slot = &slots[i];
+        if (!slot->used || !usbd_report_gate_idle_due(&slot->gate, policy, now)) continue;
+        if (!tud_hid_n_ready(slot->itf)) continue;
+        if (tud_hid_n_report(slot->itf, slot->report_id, slot->gate.last, slot->gate.len)) {
+            usbd_report_gate_repeated(&slot->gate, now);
+        }
+    }
+}
+
+static void set_idle(uint8_t rate)
+{
+    idle_rate = rate;
+    for (int i = 0; i < GATES; i++) {
+        if (slots[i].used && slots[i].itf == 0) slots[i].gate.idle_rate = rate;
+    }
+}
+
+// ============================================================================
+// GATE UNIT CHECKS
+// ============================================================================
+
+static void check_gate(void)
+{
+    printf("gate\n");
+
+    // Compare agrees with memcmp at every length, alignment and position
+    static uint32_t words[USBD_REPORT_MAX_LEN / 4 + 2];
+    uint8_t* base = (uint8_t*)words;
+    for (int align = 0; align < 4; align++) {
+        for (uint16_t len = 1; len <= USBD_REPORT_MAX_LEN; len++) {
+            uint8_t* r = base + align;
+            for (uint16_t i = 0; i < len; i++) r[i] = (uint8_t)rnd();
+
+            usbd_report_gate_t g;
+            memset(&g, 0, sizeof(g));
+            if (usbd_report_gate_same(&g, r, len)) fail("empty gate matched a %u-byte report", len);
+            usbd_report_gate_commit(&g, r, len, 0);
+            if (!usbd_report_gate_same(&g, r, len)) {
+                fail("len %u align %d: identical report not matched", len, align);
+            }
+            if (len > 1 && usbd_report_gate_same(&g, r, (uint16_t)(len - 1))) {
+                fail("len %u: shorter report matched", len);
+            }
+            for (uint16_t i = 0; i < len; i++) {
+                r[i] ^= 0x01;
+                if (usbd_report_gate_same(&g, r, len)) {
+                    fail("len %u align %d: byte %u changed but matched", len, align, i);
+                }
+                r[i] ^= 0x01;
+            }
+        }
+    }
+
+    uint8_t a[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t big[USBD_REPORT_MAX_LEN + 1] = { 0 };
+    usbd_report_gate_t g;
+    memset(&g, 0, sizeof(g));
+
+    // Every event: always through, nothing counted
+    for (int i = 0; i < 3; i++) {
+        if (!usbd_report_gate_check(&g, USBD_REPEAT_EVERY_EVENT, a, sizeof(a), 0)) {
+            fail("every-event policy held a report");
+        }
+        usbd_report_gate_commit(&g, a, sizeof(a), 0);
+    }
+    if (g.suppressed != 0) fail("every-event policy counted %u suppressed", g.suppressed);
+
+    // On change: first and changed reports through, repeats held and counted
+    memset(&g, 0, sizeof(g));
+    if (!usbd_report_gate_check(&g, USBD_REPEAT_ON_CHANGE, a, sizeof(a), 0)) fail("first report held");
+    usbd_report_gate_commit(&g, a, sizeof(a), 0);
+    if (usbd_report_gate_check(&g, USBD_REPEAT_ON_CHANGE, a, sizeof(a), 1000)) fail("unchanged report sent");
+    a[7] = 9;
+    if (!usbd_report_gate_check(&g, USBD_REPEAT_ON_CHANGE, a, sizeof(a), 1001)) fail("changed report held");
+    if (g.suppressed != 1) fail("on-change counted %u suppressed, want 1", g.suppressed);
+
+    // Oversized reports bypass the gate and are not cached
+    if (!usbd_report_gate_check(&g, USBD_REPEAT_ON_CHANGE, big, sizeof(big), 0)) fail("oversized report held");
+    usbd_report_gate_commit(&g, a, sizeof(a), 0);
+    usbd_report_gate_commit(&g, big, sizeof(big), 0);
+    if (g.len != sizeof(a)) fail("oversized report replaced the cached one");
+
+    // Idle: rate 0 never repeats; rate 2 repeats at 8 ms, not 7
+    memset(&g, 0, sizeof(g));
+    if (usbd_report_gate_idle_due(&g, USBD_REPEAT_HID_IDLE, 100000)) fail("idle due with nothing sent");
+    usbd_report_gate_commit(&g, a, sizeof(a), 100);
+    if (usbd_report_gate_idle_due(&g, USBD_REPEAT_HID_IDLE, 100000)) fail("idle rate 0 repeated");
+    if (usbd_report_gate_idle_in_ms(&g, USBD_REPEAT_HID_IDLE, 100000) != UINT32_MAX) fail("idle rate 0 scheduled a repeat");
+    if (usbd_report_gate_check(&g, USBD_REPEAT_HID_IDLE, a, sizeof(a), 100000)) fail("idle rate 0 let a repeat through");
+    g.idle_rate = 2;
+    if (usbd_report_gate_idle_due(&g, USBD_REPEAT_HID_IDLE, 107)) fail("idle repeat due after 7 ms of 8");
+    if (usbd_report_gate_idle_in_ms(&g, USBD_REPEAT_HID_IDLE, 103) != 5) fail("idle repeat not 5 ms away after 3 ms of 8");
+    if (usbd_report_gate_idle_in_ms(&g, USBD_REPEAT_HID_IDLE, 120) != 0) fail("overdue idle repeat not due now");
+    if (usbd_report_gate_idle_in_ms(&g, USBD_REPEAT_ON_CHANGE, 103) != UINT32_MAX) fail("on-change policy scheduled an idle repeat");
+    if (!usbd_report_gate_idle_due(&g, USBD_REPEAT_HID_IDLE, 108)) fail("idle repeat not due after 8 ms");
+    if (usbd_report_gate_idle_due(&g, USBD_REPEAT_ON_CHANGE, 108)) fail("on-change policy asked for an idle repeat");
+    if (usbd_report_gate_check(&g, USBD_REPEAT_ON_CHANGE, a, sizeof(a), 108)) fail("on-change policy sent an idle repeat");
+    if (!usbd_report_gate_check(&g, USBD_REPEAT_HID_IDLE, a, sizeof(a), 108)) fail("expired idle period held the report");
+    usbd_report_gate_repeated(&g, 108);
+    if (usbd_report_gate_idle_due(&g, USBD_REPEAT_HID_IDLE, 115)) fail("idle repeat due 7 ms after a repeat");
+    if (g.repeated != 1) fail("repeated %u, want 1", g.repeated);
+
+    // Millisecond counter wrap
+    usbd_report_gate_commit(&g, a, sizeof(a), 0xFFFFFFFCu);
+    if (usbd_report_gate_idle_due(&g, USBD_REPEAT_HID_IDLE, 3)) fail("idle due 7 ms after the wrap");
+    if (!usbd_report_gate_idle_due(&g, USBD_REPEAT_HID_IDLE, 4)) fail("idle not due 8 ms after the wrap");
+    if (usbd_report_gate_idle_in_ms(&g, USBD_REPEAT_HID_IDLE, 1) != 3) fail("idle repeat not 3 ms away across the wrap");
+
+    // Reset forgets the report and counters, keeps the rate
+    usbd_report_gate_reset(&g);
+    if (g.len != 0 || g.sent != 0 || g.suppressed != 0 || g.repeated != 0) fail("reset kept state");
+    if (g.idle_rate != 2) fail("reset dropped the idle rate");
+    if (!usbd_report_gate_check(&g, USBD_REPEAT_HID_IDLE, a, sizeof(a), 0)) fail("report held after a reset");
+}
+
+// ============================================================================
+// SESSIONS
+// ============================================================================
+
+typedef struct {
+    uint32_t buttons;
+    uint8_t lx, ly, rx, ry, lt, rt;
+} pad_t;
+
+typedef void (*script_fn)(uint32_t t_ms, pad_t* pad);
+
+static void pad_neutral(pad_t* pad)
+{
+    memset(pad, 0, sizeof(*pad));
+    pad->lx = pad->ly = pad->rx = pad->ry = 128;
+}
+
+// Hands off the controller
+static void script_idle(uint32_t t, pad_t* pad)
+{
+    pad_neutral(pad);
+}
+
+// Menu navigation: a D-pad tap every 700 ms, a confirm every 3 s
+static void script_menu(uint32_t t, pad_t* pad)
+{
+    pad_neutral(pad);
+    if (t % 700 < 90) pad->buttons |= (t / 700) % 2 ? JP_BUTTON_DD : JP_BUTTON_DR;
+    if (t % 3000 >= 1500 && t % 3000 < 1580) pad->buttons |= JP_BUTTON_B1;
+}
+
+// A resting stick that flickers one count either side of center
+static void script_drift(uint32_t t, pad_t* pad)
+{
+    pad_neutral(pad);
+    uint32_t phase = (t / 47) % 5;
+    pad->lx = (uint8_t)(phase == 1 ? 127 : phase == 3 ? 129 : 128);
+}
+
+// Active play: sweeping sticks half the time, trigger pulls, face buttons
+static void script_play(uint32_t t, pad_t* pad)
+{
+    pad_neutral(pad);
+    if ((t / 1000) % 2 == 0) {
+        double a = t * 0.004;
+        pad->lx = (uint8_t)(128 + 100 * sin(a));
+        pad->ly = (uint8_t)(128 + 100 * cos(a));
+        pad->rx = (uint8_t)(128 + 60 * sin(a * 0.7));
+    }
+    if (t % 2500 < 600) pad->rt = (uint8_t)((t % 2500) < 100 ? (t % 2500) * 2 : 200);
+    if (t % 400 < 60) pad->buttons |= JP_BUTTON_B1;
+    if (t % 900 < 120) pad->buttons |= JP_BUTTON_B3;
+}
+
+// PC Engine turbo: II (B3) held, then released
+static void script_turbo(uint32_t t, pad_t* pad)
+{
+    pad_neutral(pad);
+    if (t >= 500 && t < 3500) pad->buttons |= JP_BUTTON_B3;
+}
+
+typedef struct {
+    const char* name;
+    const usbd_mode_t* mode;
+    script_fn script;
+    uint32_t event_hz;                  // Controller input rate
+    uint32_t duration_ms;
+    uint8_t idle_rate;                  // SET_IDLE from the host (4 ms units)
+    uint32_t quiet_ms;                  // Input stops here (0 = never), e.g. a
+                                        // controller that only reports changes
+    uint32_t min_saved_pct;             // Savings the policy must reach
+} session_t;
+
+static void run_session(const session_t* s)
+{
+    memset(&ep, 0, sizeof(ep));
+    memset(slots, 0, sizeof(slots));
+    built_count = received_count = 0;
+    now_ms = 1000;
+    current_mode = s->mode;
+    idle_rate = 0;
+    s->mode->init();
+    set_idle(s->idle_rate);
+
+    uint32_t events = 0;
+    uint32_t event_period_us = 1000000 / s->event_hz;
+    uint64_t next_event_us = 0;
+    bool pending = false;
+    pad_t pad;
+
+    for (uint32_t t = 0; t < s->duration_ms; t++) {
+        now_ms = 1000 + t;
+
+        // Controller input arriving this millisecond; the newest event wins
+        while (next_event_us <= (uint64_t)t * 1000 && (!s->quiet_ms || t < s->quiet_ms)) {
+            s->script(t, &pad);
+            pending = true;
+            events++;
+            next_event_us += event_period_us;
+        }
+
+        // usbd_task: send the pending event once the endpoint is free, run
+        // the mode task, then the idle repeat
+        if (pending && tud_hid_ready()) {
+            profile_output_t po;
+            memset(&po, 0, sizeof(po));
+            po.left_x = pad.lx;
+            po.left_y = pad.ly;
+            po.right_x = pad.rx;
+            po.right_y = pad.ry;
+            po.l2_analog = pad.lt;
+            po.r2_analog = pad.rt;
+            input_event_t ev;
+            memset(&ev, 0, sizeof(ev));
+            pending = false;
+            s->mode->send_report(0, &ev, &po, pad.buttons);
+        }
+        if (s->mode->task) s->mode->task();
+        idle_task();
+
+        host_poll();
+    }
+
+    // Correctness: the host sees every change the mode built, in order, and
+    // nothing else. A refused report is dropped (as in usbd), so with -f the
+    // host's changes need only be a subsequence of the mode's.
+    uint32_t idle_ms = (uint32_t)s->idle_rate * 4;
+    uint32_t bi = 0, changes = 0;
+    bool in_order = fail_every == 0;
+    for (uint32_t ri = 0; ri < received_count; ri++) {
+        const logged_report_t* rx = &received[ri];
+        if (ri > 0 && same_report(&received[ri - 1], rx)) {
+            // Only an idle repeat may resend an unchanged report, and only
+            // once the idle period has run out
+            uint32_t gap = rx->t - received[ri - 1].t;
+            if (idle_ms == 0) {
+                fail("%s: t=%u ms: unchanged report sent again with no idle rate", s->name, rx->t);
+            } else if (gap < idle_ms) {
+                fail("%s: t=%u ms: repeat %u ms after the last report, idle period %u ms",
+                     s->name, rx->t, gap, idle_ms);
+            }
+            continue;
+        }
+        changes++;
+        // Next distinct report the mode built; any change skipped on the way
+        // never reached the host
+        while (bi < built_count && !same_report(&built[bi], rx)) {
+            bool distinct = bi == 0 || !same_report(&built[bi - 1], &built[bi]);
+            if (in_order && distinct) {
+                fail("%s: t=%u ms: a changed report never reached the host", s->name, built[bi].t);
+                in_order = false;  // Report once
+            }
+            bi++;
+        }
+        if (bi == built_count) {
+            fail("%s: t=%u ms: host received a report the mode never built", s->name, rx->t);
+            break;
+        }
+        while (bi < built_count && same_report(&built[bi], rx)) bi++;
+    }
+    if (built_count && received_count &&
+        !same_report(&built[built_count - 1], &received[received_count - 1])) {
+        fail("%s: host did not end on the last report built", s->name);
+    }
+
+    // Idle repeats keep coming while the report holds still
+    if (idle_ms && received_count) {
+        uint32_t gap = (1000 + s->duration_ms) - received[received_count - 1].t;
+        if (gap > idle_ms + 2) fail("%s: no report for the last %u ms, idle period %u ms", s->name, gap, idle_ms);
+    }
+
+    uint32_t sent = 0, suppressed = 0, repeated = 0;
+    for (int i = 0; i < GATES; i++) {
+        if (!slots[i].used) continue;
+        sent += slots[i].gate.sent;
+        suppressed += slots[i].gate.suppressed;
+        repeated += slots[i].gate.repeated;
+    }
+    // Once input stops, only idle repeats keep the host's report fresh
+    if (idle_ms && s->quiet_ms) {
+        uint32_t want = (s->duration_ms - s->quiet_ms) / idle_ms;
+        if (repeated + 1 < want) fail("%s: %u idle repeats in the quiet tail, want %u", s->name, repeated, want);
+    }
+    // Every-event baseline: one report per report the mode built
+    uint32_t baseline = built_count;
+    uint32_t on_wire = sent + repeated;
+    uint32_t saved_pct = baseline ? (uint32_t)(100u * (baseline - (on_wire < baseline ? on_wire : baseline)) / baseline) : 0;
+    printf("  %-15s%5u events %6u built %6u sent %6u suppressed %4u repeated  %3u%% saved\n",
+           s->name, events, built_count, sent, suppressed, repeated, saved_pct);
+    if (verbose) printf("    %u host reports, %u changes\n", received_count, changes);
+    if (saved_pct < s->min_saved_pct) {
+        fail("%s: saved %u%%, want at least %u%%", s->name, saved_pct, s->min_saved_pct);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "vf:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 'f': fail_every = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-f fail_every]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    printf("fail every %u\n", fail_every);
+    check_gate();
+
+    // Savings floors are for a host that takes every report; refused
+    // reports are retried on the next event, which costs some of them.
+    bool strict = fail_every == 0;
+    const session_t sessions[] = {
+        { "idle",          &hid_mode,     script_idle,  250,  10000, 0,   0,    strict ? 99 : 90 },
+        { "idle+set_idle", &hid_mode,     script_idle,  250,  10000, 125, 0,    strict ? 99 : 90 },
+        { "menu",          &hid_mode,     script_menu,  250,  10000, 0,   0,    strict ? 95 : 80 },
+        { "quiet+set_idle",&hid_mode,     script_menu,  250,  10000, 125, 2000, strict ? 90 : 80 },
+        { "drift",         &hid_mode,     script_drift, 1000, 10000, 0,   0,    strict ? 90 : 70 },
+        { "play",          &hid_mode,     script_play,  1000, 10000, 0,   0,    strict ? 60 : 50 },
+        { "play+set_idle", &hid_mode,     script_play,  1000, 10000, 25,  0,    strict ? 60 : 50 },
+        { "pce turbo",     &pcemini_mode, script_turbo, 250,  4000,  0,   0,    strict ? 90 : 80 },
+    };
+
+    printf("sessions\n");
+    for (size_t i = 0; i < sizeof(sessions) / sizeof(sessions[0]); i++) run_session(&sessions[i]);
+
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+// tusb.h - minimal TinyUSB surface for building usbd_report.c, hid_mode.c
+// and pcemini_mode.c on the host. Only what those files, usbd_mode.h and
+// their descriptor headers touch.
+
+#ifndef USBD_REPORT_GATE_TUSB_H
+#define USBD_REPORT_GATE_TUSB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define TU_ATTR_PACKED        __attribute__((packed))
+#define TU_BIT(n)             (1UL << (n))
+#define U16_TO_U8S_LE(u16)    (uint8_t)((u16) & 0xFF), (uint8_t)(((u16) >> 8) & 0xFF)
+
+typedef enum {
+    TUSB_DESC_DEVICE        = 0x01,
+    TUSB_DESC_CONFIGURATION = 0x02,
+    TUSB_DESC_INTERFACE     = 0x04,
+    TUSB_DESC_ENDPOINT      = 0x05,
+} tusb_desc_type_t;
+
+typedef enum {
+    TUSB_XFER_INTERRUPT = 3,
+} tusb_xfer_type_t;
+
+#define TUSB_CLASS_HID   0x03
+
+typedef enum {
+    HID_DESC_TYPE_HID    = 0x21,
+    HID_DESC_TYPE_REPORT = 0x22,
+} hid_descriptor_type_t;
+
+typedef enum {
+    HID_REPORT_TYPE_INVALID = 0,
+    HID_REPORT_TYPE_INPUT,
+    HID_REPORT_TYPE_OUTPUT,
+    HID_REPORT_TYPE_FEATURE,
+} hid_report_type_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t  iManufacturer;
+    uint8_t  iProduct;
+    uint8_t  iSerialNumber;
+    uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bmRequestType;
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+typedef enum {
+    XFER_RESULT_SUCCESS = 0,
+    XFER_RESULT_FAILED,
+} xfer_result_t;
+
+// IN endpoint, implemented by gate.c against its simulated host
+bool tud_hid_n_ready(uint8_t instance);
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const* report, uint16_t len);
+
+static inline bool tud_hid_ready(void)
+{
+    return tud_hid_n_ready(0);
+}
+
+#endif // USBD_REPORT_GATE_TUSB_H
@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+"""Generate the synthetic Wiimote IR paths in paths/.
+
+A simple camera model: the pointer position on screen (0-1) sets where the
+sensor bar midpoint lands in the camera, the two dots sit either side of it,
+and the Wiimote's roll turns the picture (and sets the accelerometer). Dot
+positions get a pixel of deterministic noise. Each file interleaves the
+reports with expectations worked out from the true pointer.
+
+Deterministic: running it again rewrites identical files.
+"""
+
+import math
+import os
+
+OUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "paths")
+
+# Must match wiimote_ir.c
+SPAN_X = 768
+SPAN_Y = 576
+
+# Accelerometer calibration written as a "cal" line (10-bit zero 0x200,
+# 1 g 0x268; low bits in bytes 3 and 7 are zero)
+CAL = [0x80, 0x80, 0x80, 0x00, 0x9A, 0x9A, 0x9A, 0x00, 0x00]
+CAL.append((sum(CAL) + 0x55) & 0xFF)
+
+PERIOD_US = 10000           # Wiimote reports at ~100 Hz
+
+
+class Lcg:
+    def __init__(self, seed):
+        self.s = seed
+
+    def unit(self):
+        self.s = (self.s * 1103515245 + 12345) & 0xFFFFFFFF
+        return ((self.s >> 8) & 0xFFFF) / 65535.0
+
+
+def pointer(px, py):
+    return int(round(px * 65535)), int(round(py * 65535))
+
+
+class Path:
+    def __init__(self, name, comment, mode=0x33, seed=1):
+        self.name = name
+        self.lines = [f"# {name} - generated by gen_paths.py, do not edit", f"# {comment}",
+                      "cal " + " ".join(f"{b:02x}" for b in CAL)]
+        self.mode = mode
+        self.t = 0
+        self.rng = Lcg(seed)
+        self.noise = 1.0
+
+    def dots(self, px, py, roll_deg=0.0, sep=200, drop=(), extra=()):
+        """Camera dots for a pointer at (px, py), screen 0-1."""
+        mu = (px - 0.5) * SPAN_X
+        mv = (py - 0.5) * SPAN_Y
+        th = math.radians(roll_deg)
+        c, s = math.cos(th), math.sin(th)
+        out = []
+        for du in (-sep / 2, sep / 2):
+            u, v = mu + du, mv
+            # The tracker rotates by +roll to level the picture; undo that
+            ur = u * c + v * s
+            vr = -u * s + v * c
+            out.append((511.5 - ur, vr + 383.5))
+        out += list(extra)
+        res = []
+        for i, (x, y) in enumerate(out):
+            x += (self.rng.unit() - 0.5) * 2 * self.noise
+            y += (self.rng.unit() - 0.5) * 2 * self.noise
+            xi, yi = int(round(x)), int(round(y))
+            if i in drop or not (0 <= xi < 1024 and 0 <= yi < 768):
+                res.append(None)
+            else:
+                res.append((xi, yi))
+        return res, roll_deg
+
+    def report(self, dots, roll_deg):
+        th = math.radians(roll_deg)
+        span = 0x268 - 0x200
+        ax = int(round(0x200 + math.sin(th) * span))
+        az = int(round(0x200 + math.cos(th) * span)) & ~1     # Z has 9 bits
+        ay = 0x200
+        accel = [ax >> 2, ay >> 2, az >> 2]
+        # Low bits ride in the button bytes
+        buttons = [(ax & 0x03) << 5, ((ay & 0x02) << 4) | ((az & 0x02) << 5)]
+        dots = (dots + [None] * 4)[:4]
+        if self.mode == 0x33:
+            ir = []
+            for d in dots:
+                if d is None:
+                    ir += [0xFF, 0xFF, 0xFF]
+                else:
+                    x, y = d
+                    ir += [x & 0xFF, y & 0xFF, ((y >> 8) << 6) | ((x >> 8) << 4) | 0x03]
+            data = [0x33] + buttons + accel + ir
+        else:
+            ir = []
+            for p in range(2):
+                a, b = dots[p * 2], dots[p * 2 + 1]
+                ax_, ay_ = a if a else (0x3FF, 0x3FF)
+                bx_, by_ = b if b else (0x3FF, 0x3FF)
+                ir += [ax_ & 0xFF, ay_ & 0xFF,
+                       ((ay_ >> 8) << 6) | ((ax_ >> 8) << 4) | ((by_ >> 8) << 2) | (bx_ >> 8),
+                       bx_ & 0xFF, by_ & 0xFF]
+            ext = [0x80, 0x80, 0x80, 0x80, 0x80, 0xFF]      # Nunchuk at rest
+            data = [0x37] + buttons + accel + ir + ext
+        self.t += PERIOD_US
+        self.lines.append(f"report {self.t} " + "".join(f"{b:02x}" for b in data))
+
+    def step(self, px, py, **kw):
+        d, roll = self.dots(px, py, **kw)
+        self.report(d, roll)
+
+    def expect(self, text):
+        self.lines.append("expect " + text)
+
+    def write(self):
+        with open(os.path.join(OUT, self.name), "w") as f:
+            f.write("\n".join(self.lines) + "\n")
+
+
+def still_noise():
+    p = Path("still_noise.txt", "held still with a pixel of sensor noise: filtered away")
+    p.noise = 1.5
+    for _ in range(200):
+        p.step(0.3, 0.6)
+    x, y = pointer(0.3, 0.6)
+    p.expect(f"pointer {x} {y} 120")
+    # Raw midpoint noise spans ~250 units in X, ~330 in Y; the filter should
+    # hold it well inside that
+    p.expect("still 100 100")
+    p.write()
+
+
+def sweep():
+    p = Path("sweep.txt", "left to right at 1.5 screens/s and back: tracks without lag")
+    for _ in range(20):
+        p.step(0.1, 0.5)
+    p.expect("delta 0 0 3")
+    n = 54                              # 0.54 s for 0.8 screen
+    for i in range(1, n + 1):
+        px = 0.1 + 0.8 * i / n
+        p.step(px, 0.5)
+        if i in (18, 36):
+            # A plain low-pass at the same cutoff trails by ~1600 units here
+            x, y = pointer(px, 0.5)
+            p.expect(f"pointer {x} {y} 300")
+    for _ in range(40):
+        p.step(0.9, 0.5)
+    x, y = pointer(0.9, 0.5)
+    p.expect(f"pointer {x} {y} 150")
+    # 0.8 screen = 1638 counts
+    p.expect("delta 1638 0 12")
+    for i in range(1, n + 1):
+        p.step(0.9 - 0.8 * i / n, 0.5)
+    for _ in range(40):
+        p.step(0.1, 0.5)
+    x, y = pointer(0.1, 0.5)
+    p.expect(f"pointer {x} {y} 150")
+    p.expect("delta -1638 0 12")
+    p.write()
+
+
+def roll():
+    p = Path("roll.txt", "rolled from level to 90 degrees and back while aimed at one spot")
+    for _ in range(30):
+        p.step(0.7, 0.35)
+    x, y = pointer(0.7, 0.35)
+    p.expect(f"pointer {x} {y} 150")
+    # 90 degrees/s, then hold
+    for i in range(1, 101):
+        p.step(0.7, 0.35, roll_deg=90 * i / 100)
+        if i % 25 == 0:
+            p.expect(f"pointer {x} {y} 600")
+    for _ in range(50):
+        p.step(0.7, 0.35, roll_deg=90)
+    p.expect(f"pointer {x} {y} 250")
+    p.expect("still 20 120")
+    for i in range(1, 151):
+        p.step(0.7, 0.35, roll_deg=90 - 135 * i / 150)
+    for _ in range(50):
+        p.step(0.7, 0.35, roll_deg=-45)
+    p.expect(f"pointer {x} {y} 250")
+    p.write()
+
+
+def one_dot():
+    p = Path("one_dot.txt", "aimed past the right edge: the right dot leaves the frame, tracking carries on")
+    for _ in range(30):
+        p.step(0.5, 0.5)
+    n = 60
+    for i in range(1, n + 1):
+        px = 0.5 + 0.5 * i / n
+        # Right dot lands left of the camera edge; it drops out past ~0.86
+        p.step(px, 0.5)
+    for _ in range(30):
+        p.step(1.0, 0.5)
+    p.expect("pointer 65535 32768 300")
+    for i in range(1, 31):
+        p.step(1.0 - 0.2 * i / 30, 0.5)
+    for _ in range(30):
+        p.step(0.8, 0.5)
+    x, y = pointer(0.8, 0.5)
+    p.expect(f"pointer {x} {y} 200")
+    p.write()
+
+
+def reflection():
+    p = Path("reflection.txt", "a window reflection below the bar: the level pair wins")
+    extra = [(420.0, 650.0)]
+    for _ in range(60):
+        p.step(0.45, 0.4, extra=extra)
+    x, y = pointer(0.45, 0.4)
+    p.expect(f"pointer {x} {y} 150")
+    for _ in range(60):
+        p.step(0.45, 0.4, drop=(0,), extra=extra)
+    p.expect(f"pointer {x} {y} 200")
+    p.write()
+
+
+def offscreen():
+    p = Path("offscreen.txt", "pointed away and back elsewhere: hidden, then no glide from the old spot")
+    for _ in range(30):
+        p.step(0.2, 0.2)
+    p.expect("delta 0 0 3")
+    for _ in range(30):
+        p.step(0.2, 0.2, drop=(0, 1))
+    p.expect("hidden")
+    p.expect("delta 0 0 0")
+    p.step(0.8, 0.7)
+    x, y = pointer(0.8, 0.7)
+    p.expect(f"pointer {x} {y} 150")
+    p.expect("delta 0 0 0")
+    p.write()
+
+
+def basic_mode():
+    p = Path("basic_nunchuk.txt", "report 0x37 (basic IR, Nunchuk attached): same tracking", mode=0x37)
+    for _ in range(30):
+        p.step(0.6, 0.45)
+    x, y = pointer(0.6, 0.45)
+    p.expect(f"pointer {x} {y} 150")
+    for i in range(1, 31):
+        p.step(0.6 - 0.2 * i / 30, 0.45 + 0.2 * i / 30)
+    for _ in range(40):
+        p.step(0.4, 0.65)
+    x, y = pointer(0.4, 0.65)
+    p.expect(f"pointer {x} {y} 150")
+    p.write()
+
+
+if __name__ == "__main__":
+    os.makedirs(OUT, exist_ok=True)
+    still_noise()
+    sweep()
+    roll()
+    one_dot()
+    reflection()
+    offscreen()
+    basic_mode()
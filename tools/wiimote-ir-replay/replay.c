@@ -0,0 +1,225 @@
+// replay.c - plays recorded Wiimote IR reports through the firmware's
+// wiimote_ir.c and checks the pointer path against expectations
+//
+// Reports go through wiimote_ir_report exactly as wiimote_bt.c hands them
+// over, with the timestamps from the file, so decoding, roll compensation,
+// sensor bar pairing and the One-Euro filter are all exercised.
+//
+// Usage: wiimote-ir-replay [-v] path.txt...
+//   -v  print the pointer after every report
+// Exit status 1 if any expectation fails.
+//
+// File format, one item per line, '#' starts a comment, hex may be split by
+// spaces:
+//   cal <hex>                      10 bytes of EEPROM accel calibration (0x0016)
+//   report <t_us> <hex>            0x33 or 0x37 input report at time t_us
+//   expect pointer <x> <y> <tol>   pointer (0-65535) within tol of x, y
+//   expect hidden                  pointer off screen
+//   expect still <n> <max>         pointer moved at most max (per axis) over
+//                                  the last n reports
+//   expect delta <dx> <dy> <tol>   mouse counts since the previous expect delta
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bt/bthid/devices/vendors/nintendo/wiimote_ir.h"
+
+#define MAX_REPORT  32
+#define MAX_LINE    512
+#define HISTORY     512
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+static wiimote_ir_t ir;
+static uint16_t history[HISTORY][2];    // Pointer after each report (ring)
+static int reports;
+static int32_t delta_sum[2];
+static bool verbose = false;
+static int failures = 0;
+static int checks = 0;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static int parse_hex(const char* s, uint8_t* out, int max)
+{
+    int n = 0;
+    int nibble = -1;
+    for (; *s && *s != '#'; s++) {
+        int v;
+        if (*s >= '0' && *s <= '9') v = *s - '0';
+        else if (*s >= 'a' && *s <= 'f') v = *s - 'a' + 10;
+        else if (*s >= 'A' && *s <= 'F') v = *s - 'A' + 10;
+        else if (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r') continue;
+        else return -1;
+
+        if (nibble < 0) {
+            nibble = v;
+        } else {
+            if (n >= max) return -1;
+            out[n++] = (uint8_t)((nibble << 4) | v);
+            nibble = -1;
+        }
+    }
+    return nibble < 0 ? n : -1;
+}
+
+__attribute__((format(printf, 3, 4)))
+static void fail(const char* file, int line, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%s:%d: ", file, line);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    failures++;
+}
+
+// ============================================================================
+// EXPECTATIONS
+// ============================================================================
+
+static void check_expect(const char* file, int line, const char* what, const char* args)
+{
+    checks++;
+    long a, b, c;
+
+    if (strcmp(what, "pointer") == 0) {
+        if (sscanf(args, "%ld %ld %ld", &a, &b, &c) != 3) {
+            fail(file, line, "expect pointer needs x y tol");
+            return;
+        }
+        if (!ir.visible) {
+            fail(file, line, "pointer hidden, expected %ld %ld", a, b);
+        } else if (labs(ir.x - a) > c || labs(ir.y - b) > c) {
+            fail(file, line, "pointer %u %u, expected %ld %ld +/- %ld", ir.x, ir.y, a, b, c);
+        }
+    } else if (strcmp(what, "hidden") == 0) {
+        if (ir.visible) fail(file, line, "pointer %u %u, expected hidden", ir.x, ir.y);
+    } else if (strcmp(what, "still") == 0) {
+        if (sscanf(args, "%ld %ld", &a, &b) != 2 || a < 1 || a > HISTORY || a > reports) {
+            fail(file, line, "expect still needs n (1..reports so far) and max");
+            return;
+        }
+        for (int axis = 0; axis < 2; axis++) {
+            int lo = 65535, hi = 0;
+            for (int i = 0; i < a; i++) {
+                int v = history[(reports - 1 - i) % HISTORY][axis];
+                if (v < lo) lo = v;
+                if (v > hi) hi = v;
+            }
+            if (hi - lo > b) {
+                fail(file, line, "axis %d moved %d over %ld reports, max %ld", axis, hi - lo, a, b);
+            }
+        }
+    } else if (strcmp(what, "delta") == 0) {
+        if (sscanf(args, "%ld %ld %ld", &a, &b, &c) != 3) {
+            fail(file, line, "expect delta needs dx dy tol");
+            return;
+        }
+        if (labs(delta_sum[0] - a) > c || labs(delta_sum[1] - b) > c) {
+            fail(file, line, "delta %d %d, expected %ld %ld +/- %ld",
+                 (int)delta_sum[0], (int)delta_sum[1], a, b, c);
+        }
+        delta_sum[0] = delta_sum[1] = 0;
+    } else {
+        fail(file, line, "unknown expectation '%s'", what);
+    }
+}
+
+// ============================================================================
+// FILES
+// ============================================================================
+
+static void run_file(const char* file)
+{
+    FILE* f = fopen(file, "r");
+    if (!f) {
+        perror(file);
+        failures++;
+        return;
+    }
+
+    wiimote_ir_init(&ir);
+    reports = 0;
+    delta_sum[0] = delta_sum[1] = 0;
+
+    char buf[MAX_LINE];
+    int line = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        line++;
+        char* s = buf;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#' || *s == '\n' || *s == '\0') continue;
+
+        if (strncmp(s, "cal ", 4) == 0) {
+            uint8_t cal[WIIMOTE_ACCEL_CAL_LEN];
+            if (parse_hex(s + 4, cal, sizeof(cal)) != WIIMOTE_ACCEL_CAL_LEN ||
+                !wiimote_ir_set_accel_cal(&ir, cal)) {
+                fail(file, line, "calibration not accepted");
+            }
+        } else if (strncmp(s, "report ", 7) == 0) {
+            char* end;
+            unsigned long t = strtoul(s + 7, &end, 10);
+            uint8_t report[MAX_REPORT];
+            int len = parse_hex(end, report, sizeof(report));
+            if (len <= 0 || !wiimote_ir_report(&ir, report, (uint16_t)len, (uint32_t)t)) {
+                fail(file, line, "not an IR report");
+                continue;
+            }
+            history[reports % HISTORY][0] = ir.x;
+            history[reports % HISTORY][1] = ir.y;
+            reports++;
+            delta_sum[0] += ir.dx;
+            delta_sum[1] += ir.dy;
+            if (verbose) {
+                printf("%s:%d: t %lu  %s %5u %5u  d %4d %4d\n", file, line, t,
+                       ir.visible ? "at" : "--", ir.x, ir.y, ir.dx, ir.dy);
+            }
+        } else if (strncmp(s, "expect ", 7) == 0) {
+            char what[16];
+            int off = 0;
+            if (sscanf(s + 7, "%15s %n", what, &off) != 1) {
+                fail(file, line, "bad expect line");
+                continue;
+            }
+            check_expect(file, line, what, s + 7 + off);
+        } else {
+            fail(file, line, "unrecognised line");
+        }
+    }
+    fclose(f);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        if (opt == 'v') verbose = true;
+        else {
+            fprintf(stderr, "usage: %s [-v] path.txt...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-v] path.txt...\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        run_file(argv[i]);
+    }
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""Write synthetic Xbox One auth transcripts for xbone-auth-replay.
+
+The message sizes follow the shape of a console/controller handshake
+(hello, certificate fetch, key exchange, finish, status, auth-ready). Bytes
+are random. Messages marked static come out the same in every session, like
+a controller certificate; the rest change per session, like nonces and key
+material. Swap in transcripts captured from real hardware by writing them
+in the same format (see replay.c).
+
+Usage: gen_sessions.py <dir> [sessions]   (default 4 sessions)
+"""
+
+import os
+import random
+import sys
+
+GIP_AUTH = 0x06
+
+# (direction, length, static)
+PLAN = [
+    ("C", 36, False),   # console hello
+    ("R", 44, False),   # controller hello
+    ("C", 4, True),     # certificate request
+    ("R", 836, True),   # controller certificate
+    ("C", 4, True),     # second certificate part
+    ("R", 244, True),
+    ("C", 276, False),  # key exchange
+    ("R", 4, True),     # status
+    ("C", 132, False),  # finish
+    ("R", 36, False),
+    ("C", 4, True),     # status request
+    ("R", 20, True),
+    ("C", 2, True),     # auth ready (01 00)
+]
+
+
+def session(n):
+    static = random.Random(0x58B1)
+    dynamic = random.Random(1000 + n)
+    lines = [f"# synthetic session {n}"]
+    for i, (direction, length, fixed) in enumerate(PLAN):
+        # Draw from both streams every time so static bytes never depend on n
+        s = bytes(static.randrange(256) for _ in range(length))
+        d = bytes(dynamic.randrange(256) for _ in range(length))
+        data = s if fixed else d
+        if i == len(PLAN) - 1:
+            data = bytes([0x01, 0x00])
+        lines.append(f"{direction} {GIP_AUTH:02x} {data.hex()}")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+    out = sys.argv[1]
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 4
+    os.makedirs(out, exist_ok=True)
+    for n in range(1, count + 1):
+        with open(os.path.join(out, f"session{n}.txt"), "w") as f:
+            f.write(session(n))
+    print(f"wrote {count} sessions to {out}/")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
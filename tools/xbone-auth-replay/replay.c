@@ -0,0 +1,703 @@
+// replay.c - replays Xbox One auth transcripts through the GIP auth relay
+// (tud_xbone.c console side + xbone_auth.c controller side) against a
+// simulated console and controller on a virtual clock, and reports how long
+// each handshake takes.
+//
+// Every link is modelled as a full-speed interrupt endpoint: one 64-byte
+// packet per direction per 1 ms frame. The firmware main loop
+// (tud_xbone_update + xbone_auth_task) runs every LOOP_US, and endpoint
+// callbacks fire at frame boundaries as tud_task/tuh_task would deliver
+// them. Both simulated ends send like real hardware: stop-and-wait on
+// ACK-flagged chunks, ACK what asks for it.
+//
+// Usage: xbone-auth-replay [-v] [-r] [-c console_ms] [-t controller_ms] session.txt...
+//   -v  show firmware log
+//   -r  reconnect the controller between sessions too (default: console only)
+//   -c  console think time per message (default 5 ms)
+//   -t  controller think time per message (default 10 ms)
+// Each file is one handshake, run back to back. Exit status 1 if any
+// message arrived corrupted or a session never finished.
+//
+// Transcript: one message per line, "C <cmd> <hex>" for console to
+// controller, "R <cmd> <hex>" for the controller's reply to the C line
+// before it. '#' starts a comment. Hex may be split by spaces.
+
+#define _DEFAULT_SOURCE
+#define HOST_CHECK_MAIN // host-stub/stdio.h: keep the real printf() here
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "platform/platform.h"
+#include "usb/usbd/drivers/tud_xbone.h"
+#include "usb/usbh/xbone_auth/xbone_auth.h"
+
+#define LOOP_US          100
+#define FRAME_US         1000
+#define SESSION_LIMIT_US (30 * 1000000ULL)
+#define PEER_ACK_TIMEOUT_US (2000 * 1000ULL)
+#define MAX_STEPS        32
+#define CTRL_DEV_ADDR    1
+#define CTRL_INSTANCE    0
+
+// ============================================================================
+// TRANSCRIPTS
+// ============================================================================
+
+typedef struct {
+    uint8_t  cmd;
+    uint16_t len;
+    uint8_t  data[XGIP_MAX_DATA_SIZE];
+} message_t;
+
+typedef struct {
+    message_t c;
+    bool      has_r;
+    message_t r;
+} step_t;
+
+typedef struct {
+    const char* path;
+    step_t      steps[MAX_STEPS];
+    int         count;
+} transcript_t;
+
+static bool parse_message(const char* path, int line_no, char* text, message_t* m)
+{
+    char* end;
+    unsigned long cmd = strtoul(text, &end, 16);
+    if (end == text || cmd > 0xFF) {
+        fprintf(stderr, "%s:%d: bad command byte\n", path, line_no);
+        return false;
+    }
+    m->cmd = (uint8_t)cmd;
+    m->len = 0;
+
+    int nibble = -1;
+    for (char* p = end; *p; p++) {
+        int v;
+        if (*p >= '0' && *p <= '9') v = *p - '0';
+        else if (*p >= 'a' && *p <= 'f') v = *p - 'a' + 10;
+        else if (*p >= 'A' && *p <= 'F') v = *p - 'A' + 10;
+        else if (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') continue;
+        else {
+            fprintf(stderr, "%s:%d: bad hex\n", path, line_no);
+            return false;
+        }
+        if (nibble < 0) {
+            nibble = v;
+            continue;
+        }
+        if (m->len >= XGIP_MAX_DATA_SIZE) {
+            fprintf(stderr, "%s:%d: message over %d bytes\n", path, line_no, XGIP_MAX_DATA_SIZE);
+            return false;
+        }
+        m->data[m->len++] = (uint8_t)(nibble << 4 | v);
+        nibble = -1;
+    }
+    if (nibble >= 0) {
+        fprintf(stderr, "%s:%d: odd hex length\n", path, line_no);
+        return false;
+    }
+    return true;
+}
+
+static bool load_transcript(const char* path, transcript_t* t)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    static char line[8192];
+    int line_no = 0;
+    t->path = path;
+    t->count = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '\n' || *p == '\r') continue;
+
+        char dir = *p++;
+        if (dir == 'C') {
+            if (t->count >= MAX_STEPS) {
+                fprintf(stderr, "%s:%d: more than %d messages\n", path, line_no, MAX_STEPS);
+                fclose(f);
+                return false;
+            }
+            step_t* s = &t->steps[t->count++];
+            s->has_r = false;
+            if (!parse_message(path, line_no, p, &s->c)) {
+                fclose(f);
+                return false;
+            }
+        } else if (dir == 'R') {
+            if (t->count == 0 || t->steps[t->count - 1].has_r) {
+                fprintf(stderr, "%s:%d: R without a C before it\n", path, line_no);
+                fclose(f);
+                return false;
+            }
+            step_t* s = &t->steps[t->count - 1];
+            s->has_r = true;
+            if (!parse_message(path, line_no, p, &s->r)) {
+                fclose(f);
+                return false;
+            }
+        } else {
+            fprintf(stderr, "%s:%d: expected C or R\n", path, line_no);
+            fclose(f);
+            return false;
+        }
+    }
+    fclose(f);
+
+    if (t->count == 0) {
+        fprintf(stderr, "%s: no messages\n", path);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// VIRTUAL PLATFORM
+// ============================================================================
+
+static uint64_t now_us = 0;
+static uint64_t slept_us = 0;
+static bool verbose = false;
+
+uint32_t platform_time_ms(void) { return (uint32_t)(now_us / 1000); }
+uint32_t platform_time_us(void) { return (uint32_t)now_us; }
+
+// Blocks the whole main loop, as on the device
+void platform_sleep_ms(uint32_t ms)
+{
+    now_us += (uint64_t)ms * 1000;
+    slept_us += (uint64_t)ms * 1000;
+}
+
+void platform_sleep_us(uint32_t us)
+{
+    now_us += us;
+    slept_us += us;
+}
+
+void platform_loop_wake(void) {}
+void platform_loop_wake_in(uint32_t ms) { (void)ms; }
+
+// Firmware printf lands here (host-stub/stdio.h)
+int host_fw_log(const char* fmt, ...)
+{
+    if (!verbose) return 0;
+    va_list ap;
+    va_start(ap, fmt);
+    printf("%10.3f  ", now_us / 1000.0);
+    int n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+// ============================================================================
+// SIMULATED ENDPOINTS
+// ============================================================================
+
+// Console <-> device (tud_xbone)
+static struct {
+    uint8_t  ep_in;
+    uint8_t  ep_out;
+    bool     in_busy;
+    uint8_t  in_buf[64];
+    uint16_t in_len;
+    bool     out_armed;
+    uint8_t* out_buf;
+} dev;
+
+// Host (xbone_auth) -> controller
+static struct {
+    bool     out_busy;
+    uint8_t  buf[64];
+    uint16_t len;
+} host;
+
+bool tud_ready(void) { return true; }
+
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const* request,
+                      void* buffer, uint16_t len)
+{
+    (void)rhport; (void)request; (void)buffer; (void)len;
+    return true;
+}
+
+bool usbd_open_edpt_pair(uint8_t rhport, uint8_t const* p_desc, uint8_t ep_count,
+                         uint8_t xfer_type, uint8_t* ep_out, uint8_t* ep_in)
+{
+    (void)rhport; (void)xfer_type;
+    for (uint8_t i = 0; i < ep_count; i++) {
+        tusb_desc_endpoint_t const* ep = (tusb_desc_endpoint_t const*)p_desc;
+        if (ep->bEndpointAddress & 0x80) *ep_in = ep->bEndpointAddress;
+        else *ep_out = ep->bEndpointAddress;
+        p_desc = tu_desc_next(p_desc);
+    }
+    dev.ep_in = *ep_in;
+    dev.ep_out = *ep_out;
+    return true;
+}
+
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes)
+{
+    (void)rhport;
+    if (ep_addr == dev.ep_in) {
+        if (dev.in_busy || total_bytes > sizeof(dev.in_buf)) return false;
+        memcpy(dev.in_buf, buffer, total_bytes);
+        dev.in_len = total_bytes;
+        dev.in_busy = true;
+        return true;
+    }
+    if (ep_addr == dev.ep_out) {
+        dev.out_buf = buffer;
+        dev.out_armed = true;
+        return true;
+    }
+    return false;
+}
+
+bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr)
+{
+    (void)rhport;
+    if (ep_addr == dev.ep_in) return dev.in_busy;
+    if (ep_addr == dev.ep_out) return dev.out_armed;
+    return false;
+}
+
+bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr) { (void)rhport; (void)ep_addr; return true; }
+bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr) { (void)rhport; (void)ep_addr; return true; }
+
+bool tuh_xinput_send_report(uint8_t dev_addr, uint8_t instance,
+                            uint8_t const* report, uint16_t len)
+{
+    (void)dev_addr; (void)instance;
+    if (host.out_busy || len > sizeof(host.buf)) return false;
+    memcpy(host.buf, report, len);
+    host.len = len;
+    host.out_busy = true;
+    return true;
+}
+
+// ============================================================================
+// SIMULATED PEERS
+// ============================================================================
+
+// One end of a GIP link: reassembles what it receives, ACKs what asks for
+// it, and sends one message at a time, holding after each ACK-flagged chunk
+typedef struct {
+    xgip_t   rx;
+    xgip_t   tx;
+    bool     tx_active;
+    bool     tx_wait_ack;
+    bool     tx_no_wait;        // Ignore ACK flags (host stack handles this one)
+    uint16_t tx_wait_bytes;     // Receiver must report at least this many
+    uint64_t tx_wait_since;
+    uint8_t  tx_seq;
+    uint8_t  pend[8][64];       // ACKs and one-off packets go first
+    uint8_t  pend_len[8];
+    int      pend_count;
+    uint32_t ack_timeouts;
+} peer_t;
+
+static void peer_reset(peer_t* p)
+{
+    xgip_reset(&p->rx);
+    xgip_reset(&p->tx);
+    p->tx_active = false;
+    p->tx_wait_ack = false;
+    p->pend_count = 0;
+}
+
+static void peer_push(peer_t* p, const uint8_t* pkt, uint8_t len)
+{
+    if (p->pend_count >= 8) return;
+    memcpy(p->pend[p->pend_count], pkt, len);
+    p->pend_len[p->pend_count] = len;
+    p->pend_count++;
+}
+
+static void peer_send(peer_t* p, uint8_t cmd, const uint8_t* data, uint16_t len, bool needs_ack)
+{
+    xgip_reset(&p->tx);
+    if (++p->tx_seq == 0) p->tx_seq = 1;
+    xgip_set_attributes(&p->tx, cmd, p->tx_seq, 1, len > GIP_MAX_CHUNK_SIZE, needs_ack);
+    if (len) xgip_set_data(&p->tx, data, len);
+    p->tx_active = true;
+    p->tx_wait_ack = false;
+    p->tx_no_wait = false;
+}
+
+static bool peer_idle(const peer_t* p)
+{
+    return !p->tx_active && p->pend_count == 0;
+}
+
+// Next packet this peer puts on the wire this frame, or 0
+static uint8_t peer_next(peer_t* p, uint8_t* out)
+{
+    if (p->pend_count) {
+        uint8_t len = p->pend_len[0];
+        memcpy(out, p->pend[0], len);
+        p->pend_count--;
+        memmove(p->pend[0], p->pend[1], (size_t)p->pend_count * 64);
+        memmove(p->pend_len, p->pend_len + 1, (size_t)p->pend_count);
+        return len;
+    }
+    if (!p->tx_active) return 0;
+    if (p->tx_wait_ack) {
+        if (now_us - p->tx_wait_since < PEER_ACK_TIMEOUT_US) return 0;
+        p->tx_wait_ack = false;
+        p->ack_timeouts++;
+    }
+
+    uint8_t* pkt = xgip_generate_packet(&p->tx);
+    uint8_t len = xgip_get_packet_length(&p->tx);
+    memcpy(out, pkt, len);
+    if (xgip_get_packet_ack(&p->tx) && !p->tx_no_wait) {
+        p->tx_wait_ack = true;
+        p->tx_wait_bytes = p->tx.total_data_sent;
+        p->tx_wait_since = now_us;
+    }
+    if (!xgip_is_chunked(&p->tx) || xgip_end_of_chunk(&p->tx)) {
+        p->tx_active = false;
+    }
+    return len;
+}
+
+// Feed one received packet. Returns true when it completes a message, which
+// is then in p->rx until the caller resets it.
+static bool peer_receive(peer_t* p, const uint8_t* pkt, uint16_t len)
+{
+    if (len >= 9 && pkt[0] == GIP_ACK_RESPONSE) {
+        uint16_t received = pkt[7] | (pkt[8] << 8);
+        if (p->tx_wait_ack && pkt[5] == p->tx.header.command && received >= p->tx_wait_bytes) {
+            p->tx_wait_ack = false;
+        }
+        return false;
+    }
+
+    // Input reports and keep-alives interleave with auth chunks; real ends
+    // reassemble per command, so keep them out of the auth reassembly
+    if (len >= 1 && (pkt[0] == GIP_INPUT_REPORT || pkt[0] == GIP_KEEPALIVE)) {
+        return false;
+    }
+
+    xgip_parse(&p->rx, pkt, len);
+    if (!xgip_validate(&p->rx)) {
+        xgip_reset(&p->rx);
+        return false;
+    }
+    if (xgip_ack_required(&p->rx)) {
+        uint8_t* ack = xgip_generate_ack(&p->rx);
+        peer_push(p, ack, xgip_get_packet_length(&p->rx));
+    }
+    return !xgip_is_chunked(&p->rx) || xgip_end_of_chunk(&p->rx);
+}
+
+static bool message_matches(const message_t* m, xgip_t* rx)
+{
+    return xgip_get_command(rx) == m->cmd && xgip_get_data_length(rx) == m->len &&
+           (m->len == 0 || memcmp(xgip_get_data(rx), m->data, m->len) == 0);
+}
+
+// ============================================================================
+// SESSION
+// ============================================================================
+
+static const usbd_class_driver_t* driver;
+static peer_t console, controller;
+static bool controller_describe = false;
+
+static const uint8_t controller_announce[28] = {
+    0x7e, 0xed, 0x82, 0x1a, 0x2b, 0x3c,     // Address (keys the reply cache)
+    0x00, 0x00, 0x5e, 0x04, 0x12, 0x0b, 0x05, 0x00,
+    0x17, 0x0c, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static struct {
+    const transcript_t* t;
+    bool     described;         // Console got the device descriptor
+    int      c_next;            // Next console message to send
+    int      c_delivered;       // Console messages the controller has received
+    int      r_received;        // Replies the console has received
+    bool     awaiting_reply;
+    uint64_t console_at;        // Console sends c_next at this time
+    int      ctrl_step;         // Controller's position in the transcript
+    bool     ctrl_reply_pending;
+    uint64_t ctrl_reply_at;
+    uint64_t start_us;
+    uint64_t done_us;
+    int      errors;
+} s;
+
+static uint32_t console_think_us = 5000;
+static uint32_t controller_think_us = 10000;
+
+static void console_next_message(void)
+{
+    const step_t* st = &s.t->steps[s.c_next];
+    if (s.c_next == 0) s.start_us = now_us;
+    peer_send(&console, st->c.cmd, st->c.data, st->c.len, true);
+    s.awaiting_reply = st->has_r;
+    s.c_next++;
+}
+
+static void console_got(xgip_t* rx)
+{
+    uint8_t cmd = xgip_get_command(rx);
+
+    if (cmd == GIP_ANNOUNCE) {
+        peer_send(&console, GIP_DEVICE_DESCRIPTOR, NULL, 0, false);
+    } else if (cmd == GIP_DEVICE_DESCRIPTOR && !s.described) {
+        static const uint8_t power_on[] = { 0x00 };
+        s.described = true;
+        peer_send(&console, GIP_POWER_MODE_DEVICE_CONFIG, power_on, sizeof(power_on), false);
+        s.console_at = now_us + console_think_us;
+    } else if (cmd == GIP_AUTH || cmd == GIP_FINAL_AUTH) {
+        const step_t* st = &s.t->steps[s.c_next - 1];
+        if (!s.awaiting_reply) {
+            fprintf(stderr, "%s: console got an unexpected auth message\n", s.t->path);
+            s.errors++;
+        } else if (!message_matches(&st->r, rx)) {
+            fprintf(stderr, "%s: reply to message %d reached the console corrupted\n",
+                    s.t->path, s.c_next);
+            s.errors++;
+        }
+        s.awaiting_reply = false;
+        s.r_received++;
+        s.console_at = now_us + console_think_us;
+    }
+}
+
+static void controller_got(xgip_t* rx)
+{
+    uint8_t cmd = xgip_get_command(rx);
+
+    if (cmd == GIP_DEVICE_DESCRIPTOR) {
+        peer_send(&controller, GIP_DEVICE_DESCRIPTOR, xbone_gip_descriptor,
+                  sizeof(xbone_gip_descriptor), true);
+    } else if ((cmd == GIP_AUTH || cmd == GIP_FINAL_AUTH) && s.t) {
+        if (s.ctrl_step >= s.t->count) {
+            fprintf(stderr, "%s: controller got more messages than the transcript has\n",
+                    s.t->path);
+            s.errors++;
+            return;
+        }
+        const step_t* st = &s.t->steps[s.ctrl_step];
+        if (!message_matches(&st->c, rx)) {
+            fprintf(stderr, "%s: message %d reached the controller corrupted\n",
+                    s.t->path, s.ctrl_step + 1);
+            s.errors++;
+        }
+        s.c_delivered++;
+        if (st->has_r) {
+            s.ctrl_reply_pending = true;
+            s.ctrl_reply_at = now_us + controller_think_us;
+        } else {
+            s.ctrl_step++;
+        }
+    }
+}
+
+// One USB frame on every link
+static void frame(void)
+{
+    uint8_t pkt[64];
+    uint8_t len;
+
+    // Device IN -> console
+    if (dev.in_busy) {
+        uint16_t n = dev.in_len;
+        memcpy(pkt, dev.in_buf, n);
+        dev.in_busy = false;
+        if (peer_receive(&console, pkt, n)) {
+            console_got(&console.rx);
+            xgip_reset(&console.rx);
+        }
+        driver->xfer_cb(0, dev.ep_in, XFER_RESULT_SUCCESS, n);
+    }
+
+    // Console -> device OUT
+    if (dev.out_armed && (len = peer_next(&console, pkt)) != 0) {
+        memcpy(dev.out_buf, pkt, len);
+        dev.out_armed = false;
+        driver->xfer_cb(0, dev.ep_out, XFER_RESULT_SUCCESS, len);
+    }
+
+    // Host OUT -> controller
+    if (host.out_busy) {
+        host.out_busy = false;
+        if (peer_receive(&controller, host.buf, host.len)) {
+            controller_got(&controller.rx);
+            xgip_reset(&controller.rx);
+        }
+    }
+
+    // Controller -> host IN
+    if ((len = peer_next(&controller, pkt)) != 0) {
+        xbone_auth_report_received(CTRL_DEV_ADDR, CTRL_INSTANCE, pkt, len);
+    }
+
+    if (controller_describe && peer_idle(&controller)) {
+        peer_send(&controller, GIP_DEVICE_DESCRIPTOR, xbone_gip_descriptor,
+                  sizeof(xbone_gip_descriptor), false);
+        controller.tx_no_wait = true;
+        controller_describe = false;
+    }
+
+    // Think times
+    if (s.t && s.ctrl_reply_pending && now_us >= s.ctrl_reply_at && !controller.tx_active) {
+        const step_t* st = &s.t->steps[s.ctrl_step];
+        peer_send(&controller, st->r.cmd, st->r.data, st->r.len, true);
+        s.ctrl_reply_pending = false;
+        s.ctrl_step++;
+    }
+    if (s.t && s.described && !s.awaiting_reply && s.c_next < s.t->count &&
+        now_us >= s.console_at && peer_idle(&console)) {
+        console_next_message();
+    }
+}
+
+static bool session_done(void)
+{
+    int replies = 0;
+    for (int i = 0; i < s.t->count; i++) {
+        if (s.t->steps[i].has_r) replies++;
+    }
+    return s.c_delivered == s.t->count && s.r_received == replies &&
+           !s.ctrl_reply_pending && !controller.tx_active;
+}
+
+static void console_connect(void)
+{
+    // Interface 0 of the Xbox One configuration descriptor
+    const tusb_desc_interface_t* itf =
+        (const tusb_desc_interface_t*)&xbone_config_descriptor[9];
+
+    memset(&dev, 0, sizeof(dev));
+    driver->reset(0);
+    driver->open(0, itf, (uint16_t)(sizeof(xbone_config_descriptor) - 9));
+    peer_reset(&console);
+}
+
+// Controller follows its announce with the descriptor: on hardware the
+// xinput host driver's own init asks for it (xbone_auth's queued request
+// only goes out once the controller is ready)
+
+static void controller_connect(void)
+{
+    host.out_busy = false;
+    peer_reset(&controller);
+    xbone_auth_xmount(CTRL_DEV_ADDR, CTRL_INSTANCE, 0xFF, 0);
+    peer_send(&controller, GIP_ANNOUNCE, controller_announce, sizeof(controller_announce), false);
+    controller_describe = true;
+}
+
+// Runs one transcript; returns the handshake time in us, or 0 on timeout
+static uint64_t run_session(const transcript_t* t)
+{
+    memset(&s, 0, sizeof(s));
+    s.t = t;
+    uint64_t limit = now_us + SESSION_LIMIT_US;
+    uint64_t next_frame = (now_us / FRAME_US + 1) * FRAME_US;
+
+    while (!session_done()) {
+        if (now_us >= limit) return 0;
+        tud_xbone_update();
+        xbone_auth_task();
+        now_us += LOOP_US;
+        while (now_us >= next_frame) {
+            frame();
+            next_frame += FRAME_US;
+        }
+    }
+    s.done_us = now_us;
+    return s.done_us - s.start_us;
+}
+
+int main(int argc, char** argv)
+{
+    bool reconnect_controller = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "vrc:t:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 'r': reconnect_controller = true; break;
+            case 'c': console_think_us = (uint32_t)atoi(optarg) * 1000; break;
+            case 't': controller_think_us = (uint32_t)atoi(optarg) * 1000; break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-r] [-c console_ms] [-t controller_ms] session.txt...\n",
+                        argv[0]);
+                return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-v] [-r] [-c console_ms] [-t controller_ms] session.txt...\n",
+                argv[0]);
+        return 2;
+    }
+
+    int sessions = argc - optind;
+    transcript_t* transcripts = calloc((size_t)sessions, sizeof(transcript_t));
+    if (!transcripts) return 1;
+    for (int i = 0; i < sessions; i++) {
+        if (!load_transcript(argv[optind + i], &transcripts[i])) return 1;
+    }
+
+    driver = tud_xbone_class_driver();
+    driver->init();
+    xbone_auth_init();
+    controller_connect();
+
+    int errors = 0;
+    uint64_t total_us = 0;
+    printf("console think %u ms, controller think %u ms\n",
+           console_think_us / 1000, controller_think_us / 1000);
+
+    for (int i = 0; i < sessions; i++) {
+        const transcript_t* t = &transcripts[i];
+        if (i > 0 && reconnect_controller) {
+            xbone_auth_unregister(CTRL_DEV_ADDR);
+            controller_connect();
+        }
+        console_connect();
+
+        uint64_t slept_before = slept_us;
+        uint64_t us = run_session(t);
+        if (us == 0) {
+            printf("%-32s  did not finish (%d/%d messages delivered, %d replies)\n",
+                   t->path, s.c_delivered, t->count, s.r_received);
+            errors++;
+            continue;
+        }
+
+        int bytes = 0;
+        for (int k = 0; k < t->count; k++) {
+            bytes += t->steps[k].c.len + (t->steps[k].has_r ? t->steps[k].r.len : 0);
+        }
+        printf("%-32s  %8.1f ms  (%d messages, %d bytes, main loop blocked %.1f ms%s)\n",
+               t->path, us / 1000.0, t->count, bytes, (slept_us - slept_before) / 1000.0,
+               s.errors ? ", CORRUPTED" : "");
+        total_us += us;
+        errors += s.errors;
+    }
+
+    printf("total %.1f ms over %d session(s), peer ACK timeouts: console %u, controller %u\n",
+           total_us / 1000.0, sessions, console.ack_timeouts, controller.ack_timeouts);
+    free(transcripts);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+// tusb.h - minimal TinyUSB surface for building tud_xbone.c / xbone_auth.c
+// on the host. Only what those two files (and xbone_descriptors.h) touch.
+
+#ifndef REPLAY_TUSB_H
+#define REPLAY_TUSB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "tusb_option.h"
+
+#define TU_ATTR_PACKED        __attribute__((packed))
+#define CFG_TUSB_MEM_ALIGN    __attribute__((aligned(4)))
+#define CFG_TUSB_DEBUG        0
+#define TU_LOG1(...)          do { } while (0)
+// Every TU_ASSERT in these drivers fails with false / 0
+#define TU_ASSERT(cond, ...)  do { if (!(cond)) return 0; } while (0)
+
+typedef enum {
+    TUSB_DESC_DEVICE = 0x01,
+} tusb_desc_type_t;
+
+typedef enum {
+    TUSB_XFER_INTERRUPT = 3,
+} tusb_xfer_type_t;
+
+#define TUSB_CLASS_VENDOR_SPECIFIC 0xFF
+
+typedef enum {
+    XFER_RESULT_SUCCESS = 0,
+    XFER_RESULT_FAILED,
+} xfer_result_t;
+
+enum {
+    CONTROL_STAGE_IDLE = 0,
+    CONTROL_STAGE_SETUP,
+    CONTROL_STAGE_DATA,
+    CONTROL_STAGE_ACK,
+};
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t  iManufacturer;
+    uint8_t  iProduct;
+    uint8_t  iSerialNumber;
+    uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bEndpointAddress;
+    uint8_t  bmAttributes;
+    uint16_t wMaxPacketSize;
+    uint8_t  bInterval;
+} tusb_desc_endpoint_t;
+
+typedef enum {
+    TUSB_DIR_OUT = 0,
+    TUSB_DIR_IN  = 1,
+} tusb_dir_t;
+
+typedef struct TU_ATTR_PACKED {
+    union {
+        struct TU_ATTR_PACKED {
+            uint8_t recipient : 5;
+            uint8_t type      : 2;
+            uint8_t direction : 1;
+        } bmRequestType_bit;
+        uint8_t bmRequestType;
+    };
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+static inline uint8_t const* tu_desc_next(void const* desc)
+{
+    uint8_t const* p = (uint8_t const*)desc;
+    return p + p[0];
+}
+
+bool tud_ready(void);
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const* request,
+                      void* buffer, uint16_t len);
+
+#endif // REPLAY_TUSB_H
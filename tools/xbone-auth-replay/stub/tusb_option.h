@@ -0,0 +1,10 @@
+// tusb_option.h - pins the TinyUSB version seen by tusb_compat.h (0.20.0)
+
+#ifndef REPLAY_TUSB_OPTION_H
+#define REPLAY_TUSB_OPTION_H
+
+#define TUSB_VERSION_MAJOR    0
+#define TUSB_VERSION_MINOR    20
+#define TUSB_VERSION_REVISION 0
+
+#endif
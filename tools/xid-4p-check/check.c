@@ -0,0 +1,675 @@
+// check.c - host check of the XID descriptors and per-port report packing
+//
+// Builds tud_xid.c and xid_mode.c from src/ with CFG_TUD_XID_PORTS=4 against
+// stub/tusb.h and plays the console: it walks the configuration descriptors,
+// opens every interface through the class driver the way usbd does, sends
+// reports through the mode and reads them back off each port's IN endpoint,
+// and talks to each interface on the control pipe and OUT endpoint.
+//
+// Checks:
+//   - both configuration descriptors are well formed, interface N is port N
+//     with its own IN/OUT pair, and the XID descriptor and capabilities match
+//     the report structs;
+//   - the driver claims one port per interface, in interface order, arms each
+//     OUT endpoint and refuses a fifth interface;
+//   - a report sent for port N lands on port N's IN endpoint only, packed the
+//     way the Duke lays it out (checked against an independent packer);
+//   - a busy endpoint holds that port only;
+//   - GET_REPORT on interface N returns port N's last report, and rumble sent
+//     to interface N (control pipe or OUT endpoint) reaches port N only;
+//   - ports past the mode's port count are refused.
+//
+// Usage: xid-4p-check [-v] [-s seed] [-n reports]
+// Exit status 1 if any check fails.
+
+#define _DEFAULT_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "usbd_mode.h"
+#include "drivers/tud_xid.h"
+#include "descriptors/xbox_og_descriptors.h"
+#include "core/buttons.h"
+
+#define PORTS   XBOX_OG_4P_PORTS
+
+static bool verbose;
+static int failures;
+static uint32_t seed = 1;
+static unsigned report_count = 2000;
+
+static void fail(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  FAIL: ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    failures++;
+}
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+// ============================================================================
+// SIMULATED DEVICE STACK
+// ============================================================================
+
+typedef struct {
+    bool     open;
+    bool     busy;
+    uint8_t* buf;               // Buffer of the queued transfer
+    uint16_t len;
+    uint32_t xfers;             // Transfers queued since the last reset_counts()
+    uint8_t  last[64];          // Bytes of the last IN transfer
+    uint16_t last_len;
+} endpoint_t;
+
+static endpoint_t eps[256];
+
+static struct {
+    void*    buf;
+    uint16_t len;
+    uint32_t calls;
+} ctrl;
+
+static bool suspended;
+
+bool tud_ready(void) { return true; }
+bool tud_suspended(void) { return suspended; }
+bool tud_remote_wakeup(void) { suspended = false; return true; }
+
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const* request, void* buffer, uint16_t len)
+{
+    ctrl.buf = buffer;
+    ctrl.len = len;
+    ctrl.calls++;
+    return true;
+}
+
+bool usbd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const* desc_ep)
+{
+    endpoint_t* ep = &eps[desc_ep->bEndpointAddress];
+    if (ep->open) {
+        fail("endpoint 0x%02X opened twice", desc_ep->bEndpointAddress);
+        return false;
+    }
+    ep->open = true;
+    return true;
+}
+
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes)
+{
+    endpoint_t* ep = &eps[ep_addr];
+    if (!ep->open) {
+        fail("transfer on closed endpoint 0x%02X", ep_addr);
+        return false;
+    }
+    if (ep->busy) {
+        fail("transfer on busy endpoint 0x%02X", ep_addr);
+        return false;
+    }
+    ep->busy = true;
+    ep->buf = buffer;
+    ep->len = total_bytes;
+    ep->xfers++;
+    if (ep_addr & 0x80) {
+        ep->last_len = total_bytes < sizeof(ep->last) ? total_bytes : sizeof(ep->last);
+        memcpy(ep->last, buffer, ep->last_len);
+    }
+    return true;
+}
+
+bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr)
+{
+    return eps[ep_addr].busy;
+}
+
+static void reset_device(void)
+{
+    memset(eps, 0, sizeof(eps));
+    memset(&ctrl, 0, sizeof(ctrl));
+}
+
+static void reset_counts(void)
+{
+    for (int i = 0; i < 256; i++) eps[i].xfers = 0;
+}
+
+// Host reads port N's IN endpoint
+static void host_take_in(const usbd_class_driver_t* drv, uint8_t ep_addr)
+{
+    endpoint_t* ep = &eps[ep_addr];
+    if (!ep->busy) return;
+    ep->busy = false;
+    drv->xfer_cb(0, ep_addr, XFER_RESULT_SUCCESS, ep->len);
+}
+
+// Host writes bytes to an OUT endpoint
+static void host_send_out(const usbd_class_driver_t* drv, uint8_t ep_addr, const void* data, uint16_t len)
+{
+    endpoint_t* ep = &eps[ep_addr];
+    if (!ep->busy) {
+        fail("OUT endpoint 0x%02X not armed", ep_addr);
+        return;
+    }
+    memcpy(ep->buf, data, len < ep->len ? len : ep->len);
+    ep->busy = false;
+    drv->xfer_cb(0, ep_addr, XFER_RESULT_SUCCESS, len);
+    if (!ep->busy) fail("OUT endpoint 0x%02X not re-armed after a transfer", ep_addr);
+}
+
+// Control transfer on the default pipe. Returns false on STALL. For an OUT
+// data stage the host's bytes are written into the buffer the driver gave.
+static bool host_control(const usbd_class_driver_t* drv, uint8_t bm, uint8_t req, uint16_t value,
+                         uint16_t index, uint16_t length, const void* out_data)
+{
+    tusb_control_request_t r = {0};
+    r.bmRequestType = bm;
+    r.bRequest = req;
+    r.wValue = value;
+    r.wIndex = index;
+    r.wLength = length;
+
+    ctrl.buf = NULL;
+    ctrl.len = 0;
+    if (!drv->control_xfer_cb(0, CONTROL_STAGE_SETUP, &r)) return false;
+    if (out_data && ctrl.buf) memcpy(ctrl.buf, out_data, ctrl.len);
+    drv->control_xfer_cb(0, CONTROL_STAGE_ACK, &r);
+    return true;
+}
+
+// ============================================================================
+// REFERENCE PACKING
+// ============================================================================
+
+// The Duke's 20-byte input report, built from the wire layout rather than
+// from the firmware's struct
+static void put_s16(uint8_t* p, int32_t v)
+{
+    if (v < -32768) v = -32768;
+    if (v > 32767) v = 32767;
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+static void reference_report(uint32_t buttons, const profile_output_t* po, uint8_t out[20])
+{
+    memset(out, 0, 20);
+    out[1] = 20;
+
+    static const struct { uint32_t jp; uint8_t bit; } digital[] = {
+        { JP_BUTTON_DU, 0 }, { JP_BUTTON_DD, 1 }, { JP_BUTTON_DL, 2 }, { JP_BUTTON_DR, 3 },
+        { JP_BUTTON_S2, 4 }, { JP_BUTTON_S1, 5 }, { JP_BUTTON_L3, 6 }, { JP_BUTTON_R3, 7 },
+    };
+    for (size_t i = 0; i < sizeof(digital) / sizeof(digital[0]); i++) {
+        if (buttons & digital[i].jp) out[2] |= (uint8_t)(1u << digital[i].bit);
+    }
+
+    // Bytes 4-9: A, B, X, Y, Black, White. White is L1, Black is R1.
+    if (po->has_pressure) {
+        out[4] = po->pressure[10];
+        out[5] = po->pressure[9];
+        out[6] = po->pressure[11];
+        out[7] = po->pressure[8];
+        out[8] = po->pressure[7];
+        out[9] = po->pressure[6];
+    } else {
+        out[4] = (buttons & JP_BUTTON_B1) ? 0xFF : 0;
+        out[5] = (buttons & JP_BUTTON_B2) ? 0xFF : 0;
+        out[6] = (buttons & JP_BUTTON_B3) ? 0xFF : 0;
+        out[7] = (buttons & JP_BUTTON_B4) ? 0xFF : 0;
+        out[8] = (buttons & JP_BUTTON_R1) ? 0xFF : 0;
+        out[9] = (buttons & JP_BUTTON_L1) ? 0xFF : 0;
+    }
+
+    out[10] = po->l2_analog ? po->l2_analog : ((buttons & JP_BUTTON_L2) ? 0xFF : 0);
+    out[11] = po->r2_analog ? po->r2_analog : ((buttons & JP_BUTTON_R2) ? 0xFF : 0);
+
+    // Sticks are positive right and positive up; Y comes in as 0 = up
+    put_s16(&out[12], ((int32_t)po->left_x - 128) * 256);
+    put_s16(&out[14], (128 - (int32_t)po->left_y) * 256);
+    put_s16(&out[16], ((int32_t)po->right_x - 128) * 256);
+    put_s16(&out[18], (128 - (int32_t)po->right_y) * 256);
+}
+
+static void dump(const char* what, const uint8_t* p, unsigned len)
+{
+    printf("    %-6s", what);
+    for (unsigned i = 0; i < len; i++) printf(" %02X", p[i]);
+    printf("\n");
+}
+
+// ============================================================================
+// DESCRIPTORS
+// ============================================================================
+
+static void check_config(const char* name, const uint8_t* desc, size_t size, unsigned ports)
+{
+    if (size < TUD_CONFIG_DESC_LEN || desc[1] != TUSB_DESC_CONFIGURATION) {
+        fail("%s: no configuration descriptor", name);
+        return;
+    }
+    unsigned total = (unsigned)(desc[2] | (desc[3] << 8));
+    if (total != size) fail("%s: wTotalLength %u, descriptor is %zu bytes", name, total, size);
+    if (desc[4] != ports) fail("%s: bNumInterfaces %u, want %u", name, desc[4], ports);
+
+    unsigned itfs = 0, cur_itf = 0xFF;
+    bool seen[256] = {0};
+    const uint8_t* end = desc + size;
+    for (const uint8_t* p = desc + desc[0]; p < end; p += p[0]) {
+        if (p[0] < 2 || p + p[0] > end) {
+            fail("%s: descriptor at offset %td runs past the end", name, p - desc);
+            return;
+        }
+        if (p[1] == TUSB_DESC_INTERFACE) {
+            const tusb_desc_interface_t* itf = (const tusb_desc_interface_t*)p;
+            cur_itf = itf->bInterfaceNumber;
+            if (cur_itf != itfs) fail("%s: interface %u at position %u", name, cur_itf, itfs);
+            if (itf->bInterfaceClass != XID_INTERFACE_CLASS ||
+                itf->bInterfaceSubClass != XID_INTERFACE_SUBCLASS) {
+                fail("%s: interface %u is class %02X/%02X, not XID", name, cur_itf,
+                     itf->bInterfaceClass, itf->bInterfaceSubClass);
+            }
+            if (itf->bNumEndpoints != 2) {
+                fail("%s: interface %u has %u endpoints", name, cur_itf, itf->bNumEndpoints);
+            }
+            itfs++;
+        } else if (p[1] == TUSB_DESC_ENDPOINT) {
+            const tusb_desc_endpoint_t* ep = (const tusb_desc_endpoint_t*)p;
+            uint8_t addr = ep->bEndpointAddress;
+            if (seen[addr]) fail("%s: endpoint 0x%02X used twice", name, addr);
+            seen[addr] = true;
+            // Interface N is port N: IN 0x81+N, OUT 0x01+N
+            uint8_t want = (uint8_t)(((addr & 0x80) ? 0x81 : 0x01) + cur_itf);
+            if (addr != want) {
+                fail("%s: interface %u has endpoint 0x%02X, want 0x%02X", name, cur_itf, addr, want);
+            }
+            if ((ep->bmAttributes & 3) != TUSB_XFER_INTERRUPT) {
+                fail("%s: endpoint 0x%02X is not interrupt", name, addr);
+            }
+            uint16_t mps = ep->wMaxPacketSize;
+            uint16_t need = (addr & 0x80) ? sizeof(xbox_og_in_report_t) : sizeof(xbox_og_out_report_t);
+            if (mps != 32 || mps < need) {
+                fail("%s: endpoint 0x%02X wMaxPacketSize %u", name, addr, mps);
+            }
+        }
+    }
+    if (itfs != ports) fail("%s: %u interfaces, want %u", name, itfs, ports);
+    if (verbose) printf("  %s: %zu bytes, %u interfaces\n", name, size, itfs);
+}
+
+static void check_descriptors(void)
+{
+    printf("descriptors\n");
+
+    check_config("1-port", xbox_og_config_descriptor, sizeof(xbox_og_config_descriptor), 1);
+    check_config("4-port", xbox_og_4p_config_descriptor, sizeof(xbox_og_4p_config_descriptor), PORTS);
+
+    // The descriptor arrays are per translation unit; compare contents
+    if (memcmp(xid_4p_mode.get_config_descriptor(), xbox_og_4p_config_descriptor,
+               sizeof(xbox_og_4p_config_descriptor)) != 0) {
+        fail("4-port mode does not hand out the 4-port configuration");
+    }
+    if (memcmp(xid_mode.get_config_descriptor(), xbox_og_config_descriptor,
+               sizeof(xbox_og_config_descriptor)) != 0) {
+        fail("single-port mode does not hand out the 1-port configuration");
+    }
+    if (memcmp(xid_4p_mode.get_device_descriptor(), &xbox_og_device_descriptor,
+               sizeof(xbox_og_device_descriptor)) != 0) {
+        fail("4-port mode does not hand out the Xbox OG device descriptor");
+    }
+    if (xbox_og_device_descriptor.idVendor != XBOX_OG_VID ||
+        xbox_og_device_descriptor.idProduct != XBOX_OG_PID) {
+        fail("device descriptor is %04X:%04X", xbox_og_device_descriptor.idVendor,
+             xbox_og_device_descriptor.idProduct);
+    }
+
+    if (xbox_og_xid_descriptor[0] != sizeof(xbox_og_xid_descriptor)) {
+        fail("XID descriptor bLength %u, size %zu", xbox_og_xid_descriptor[0],
+             sizeof(xbox_og_xid_descriptor));
+    }
+    if (xbox_og_xid_descriptor[6] != sizeof(xbox_og_in_report_t) ||
+        xbox_og_xid_descriptor[7] != sizeof(xbox_og_out_report_t)) {
+        fail("XID descriptor report sizes %u/%u, structs are %zu/%zu", xbox_og_xid_descriptor[6],
+             xbox_og_xid_descriptor[7], sizeof(xbox_og_in_report_t), sizeof(xbox_og_out_report_t));
+    }
+    if (sizeof(xbox_og_xid_capabilities_in) != sizeof(xbox_og_in_report_t) ||
+        xbox_og_xid_capabilities_in[1] != sizeof(xbox_og_in_report_t)) {
+        fail("input capabilities are %zu bytes (bLength %u)", sizeof(xbox_og_xid_capabilities_in),
+             xbox_og_xid_capabilities_in[1]);
+    }
+    if (sizeof(xbox_og_xid_capabilities_out) != sizeof(xbox_og_out_report_t) ||
+        xbox_og_xid_capabilities_out[1] != sizeof(xbox_og_out_report_t)) {
+        fail("output capabilities are %zu bytes (bLength %u)", sizeof(xbox_og_xid_capabilities_out),
+             xbox_og_xid_capabilities_out[1]);
+    }
+}
+
+// ============================================================================
+// ENUMERATION
+// ============================================================================
+
+// Open every interface of a configuration through the driver, the way usbd
+// walks it
+static const usbd_class_driver_t* enumerate(const uint8_t* desc, size_t size)
+{
+    const usbd_class_driver_t* drv = tud_xid_class_driver();
+    reset_device();
+    drv->init();
+    drv->reset(0);
+
+    const uint8_t* p = desc + desc[0];
+    const uint8_t* end = desc + size;
+    while (p < end) {
+        if (p[1] != TUSB_DESC_INTERFACE) {
+            p += p[0];
+            continue;
+        }
+        uint16_t len = drv->open(0, (const tusb_desc_interface_t*)p, (uint16_t)(end - p));
+        if (len != TUD_XID_DESC_LEN) {
+            fail("open of interface %u took %u bytes, want %u", p[2], len, TUD_XID_DESC_LEN);
+            return drv;
+        }
+        p += len;
+    }
+    return drv;
+}
+
+static void check_enumeration(void)
+{
+    printf("enumeration\n");
+
+    const usbd_class_driver_t* drv =
+        enumerate(xbox_og_4p_config_descriptor, sizeof(xbox_og_4p_config_descriptor));
+
+    for (uint8_t port = 0; port < PORTS; port++) {
+        uint8_t in = (uint8_t)(0x81 + port), out = (uint8_t)(0x01 + port);
+        if (!eps[in].open || !eps[out].open) fail("port %u: endpoints 0x%02X/0x%02X not open", port, in, out);
+        if (!eps[out].busy) fail("port %u: OUT endpoint 0x%02X not armed", port, out);
+        if (!tud_xid_n_ready(port)) fail("port %u: not ready after enumeration", port);
+    }
+    if (tud_xid_n_ready(PORTS)) fail("port %u reports ready", PORTS);
+
+    // Every port is taken; a fifth XID interface must be refused
+    uint8_t extra[TUD_XID_DESC_LEN];
+    memcpy(extra, xbox_og_4p_config_descriptor + TUD_CONFIG_DESC_LEN, sizeof(extra));
+    extra[2] = PORTS;
+    extra[9 + 2] = 0x85;
+    extra[16 + 2] = 0x05;
+    if (drv->open(0, (const tusb_desc_interface_t*)extra, sizeof(extra)) != 0) {
+        fail("driver opened a fifth XID interface");
+    }
+
+    // A non-XID interface is not ours
+    uint8_t hid[9] = { 9, TUSB_DESC_INTERFACE, 0, 0, 0, 0x03, 0x00, 0x00, 0x00 };
+    if (drv->open(0, (const tusb_desc_interface_t*)hid, sizeof(hid)) != 0) {
+        fail("driver claimed a HID interface");
+    }
+
+    // Bus reset frees every port
+    drv->reset(0);
+    for (uint8_t port = 0; port < PORTS; port++) {
+        if (tud_xid_n_ready(port)) fail("port %u still ready after a bus reset", port);
+    }
+}
+
+// ============================================================================
+// REPORT PACKING
+// ============================================================================
+
+static void random_input(uint32_t* buttons, profile_output_t* po)
+{
+    memset(po, 0, sizeof(*po));
+    *buttons = rnd() & 0xFFFF;
+
+    // Half the reports hit the stick and trigger extremes
+    static const uint8_t edges[] = { 0, 1, 127, 128, 129, 254, 255 };
+    bool edge = rnd() & 1;
+    uint8_t* axes[] = { &po->left_x, &po->left_y, &po->right_x, &po->right_y };
+    for (int i = 0; i < 4; i++) {
+        *axes[i] = edge ? edges[rnd() % sizeof(edges)] : (uint8_t)rnd();
+    }
+    // Zero triggers half the time so the digital fallback is covered
+    po->l2_analog = (rnd() & 1) ? 0 : (uint8_t)rnd();
+    po->r2_analog = (rnd() & 1) ? 0 : (uint8_t)rnd();
+
+    po->has_pressure = (rnd() % 4) == 0;
+    if (po->has_pressure) {
+        for (int i = 0; i < 12; i++) po->pressure[i] = (uint8_t)rnd();
+    }
+}
+
+static void check_reports(void)
+{
+    printf("reports (%u per port, seed %u)\n", report_count, seed);
+
+    const usbd_class_driver_t* drv =
+        enumerate(xbox_og_4p_config_descriptor, sizeof(xbox_og_4p_config_descriptor));
+    xid_4p_mode.init();
+
+    input_event_t event;
+    memset(&event, 0, sizeof(event));
+    uint8_t last[PORTS][20];
+    bool have_last[PORTS] = {0};
+    unsigned mismatches = 0;
+
+    for (unsigned n = 0; n < report_count * PORTS; n++) {
+        uint8_t port = (uint8_t)(rnd() % PORTS);
+        uint32_t buttons;
+        profile_output_t po;
+        random_input(&buttons, &po);
+
+        uint8_t want[20];
+        reference_report(buttons, &po, want);
+
+        uint8_t in = (uint8_t)(0x81 + port);
+        reset_counts();
+        if (eps[in].busy) {
+            // The console hasn't polled this port yet; the report must wait
+            if (xid_4p_mode.send_report(port, &event, &po, buttons)) {
+                fail("port %u: send_report accepted on a busy endpoint", port);
+            }
+            host_take_in(drv, in);
+            continue;
+        }
+        if (!xid_4p_mode.send_report(port, &event, &po, buttons)) {
+            fail("port %u: send_report refused on a free endpoint", port);
+            continue;
+        }
+
+        for (uint8_t other = 0; other < PORTS; other++) {
+            uint32_t want_xfers = (other == port) ? 1 : 0;
+            if (eps[0x81 + other].xfers != want_xfers) {
+                fail("port %u report: %u transfers on port %u's endpoint", port,
+                     eps[0x81 + other].xfers, other);
+            }
+        }
+        if (eps[in].last_len != 20 || memcmp(eps[in].last, want, 20) != 0) {
+            if (mismatches++ < 5) {
+                fail("port %u: report differs from the Duke layout (buttons %04X%s)", port,
+                     buttons, po.has_pressure ? ", pressure" : "");
+                dump("got", eps[in].last, eps[in].last_len);
+                dump("want", want, 20);
+            }
+        }
+        memcpy(last[port], want, 20);
+        have_last[port] = true;
+
+        // The endpoint is busy until the host polls it; only this port waits
+        if (tud_xid_n_ready(port)) fail("port %u ready while its IN endpoint is busy", port);
+        if (xid_4p_mode.send_report(port, &event, &po, buttons)) {
+            fail("port %u: send_report accepted on a busy endpoint", port);
+        }
+        for (uint8_t other = 0; other < PORTS; other++) {
+            if (other != port && !eps[0x81 + other].busy && !tud_xid_n_ready(other)) {
+                fail("port %u held up by port %u's busy endpoint", other, port);
+            }
+        }
+        if (rnd() % 3) host_take_in(drv, in);
+        if (n % 97 == 0) {
+            for (uint8_t p = 0; p < PORTS; p++) host_take_in(drv, (uint8_t)(0x81 + p));
+        }
+    }
+    if (mismatches > 5) fail("%u more mismatched reports", mismatches - 5);
+
+    // GET_REPORT on interface N returns port N's last report
+    for (uint8_t port = 0; port < PORTS; port++) {
+        if (!have_last[port]) continue;
+        if (!host_control(drv, XID_REQ_GET_REPORT_TYPE, XID_REQ_GET_REPORT, XID_REQ_GET_REPORT_VAL,
+                          port, 20, NULL)) {
+            fail("GET_REPORT on interface %u stalled", port);
+        } else if (ctrl.len != 20 || memcmp(ctrl.buf, last[port], 20) != 0) {
+            fail("GET_REPORT on interface %u is not port %u's last report", port, port);
+        }
+    }
+
+    // Ports past the mode's count are refused without touching an endpoint
+    uint32_t buttons;
+    profile_output_t po;
+    random_input(&buttons, &po);
+    for (uint8_t p = 0; p < PORTS; p++) host_take_in(drv, (uint8_t)(0x81 + p));
+    reset_counts();
+    if (xid_4p_mode.send_report(PORTS, &event, &po, buttons)) fail("send_report accepted port %u", PORTS);
+    for (int i = 0; i < 256; i++) {
+        if (eps[i].xfers) fail("refused port %u queued a transfer on 0x%02X", PORTS, i);
+    }
+
+    // The single-port mode uses port 0 only
+    enumerate(xbox_og_config_descriptor, sizeof(xbox_og_config_descriptor));
+    xid_mode.init();
+    if (xid_mode.send_report(1, &event, &po, buttons)) fail("single-port mode accepted port 1");
+    if (!xid_mode.send_report(0, &event, &po, buttons)) fail("single-port mode refused port 0");
+    uint8_t want[20];
+    reference_report(buttons, &po, want);
+    if (memcmp(eps[0x81].last, want, 20) != 0) fail("single-port report differs from the Duke layout");
+}
+
+// ============================================================================
+// CONTROL PIPE AND RUMBLE
+// ============================================================================
+
+static void rumble_bytes(uint16_t l, uint16_t r, uint8_t out[6])
+{
+    out[0] = 0;
+    out[1] = 6;
+    out[2] = (uint8_t)l;
+    out[3] = (uint8_t)(l >> 8);
+    out[4] = (uint8_t)r;
+    out[5] = (uint8_t)(r >> 8);
+}
+
+static void check_feedback(const char* how, const uint16_t want[PORTS][2])
+{
+    xid_4p_mode.task();
+    for (uint8_t port = 0; port < PORTS; port++) {
+        output_feedback_t fb;
+        memset(&fb, 0, sizeof(fb));
+        if (!xid_mode_get_port_feedback(port, &fb)) {
+            fail("%s: no feedback for port %u", how, port);
+            continue;
+        }
+        uint8_t l = (uint8_t)(want[port][0] >> 8), r = (uint8_t)(want[port][1] >> 8);
+        if (fb.rumble_left != l || fb.rumble_right != r) {
+            fail("%s: port %u rumble %u/%u, want %u/%u", how, port, fb.rumble_left,
+                 fb.rumble_right, l, r);
+        }
+    }
+}
+
+static void check_control(void)
+{
+    printf("control pipe and rumble\n");
+
+    const usbd_class_driver_t* drv =
+        enumerate(xbox_og_4p_config_descriptor, sizeof(xbox_og_4p_config_descriptor));
+    xid_4p_mode.init();
+
+    // Every interface answers the XID descriptor and capability requests
+    for (uint8_t itf = 0; itf < PORTS; itf++) {
+        if (!host_control(drv, XID_REQ_GET_DESC_TYPE, XID_REQ_GET_DESC, XID_REQ_GET_DESC_VALUE,
+                          itf, 16, NULL) ||
+            ctrl.len != sizeof(xbox_og_xid_descriptor)) {
+            fail("GET_DESC on interface %u", itf);
+        }
+        if (!host_control(drv, XID_REQ_GET_CAP_TYPE, XID_REQ_GET_CAP, XID_REQ_GET_CAP_IN, itf, 20, NULL) ||
+            ctrl.len != sizeof(xbox_og_xid_capabilities_in)) {
+            fail("GET_CAP IN on interface %u", itf);
+        }
+        if (!host_control(drv, XID_REQ_GET_CAP_TYPE, XID_REQ_GET_CAP, XID_REQ_GET_CAP_OUT, itf, 6, NULL) ||
+            ctrl.len != sizeof(xbox_og_xid_capabilities_out)) {
+            fail("GET_CAP OUT on interface %u", itf);
+        }
+    }
+    if (host_control(drv, XID_REQ_GET_DESC_TYPE, XID_REQ_GET_DESC, XID_REQ_GET_DESC_VALUE, PORTS, 16, NULL)) {
+        fail("GET_DESC on interface %u (not XID) was answered", PORTS);
+    }
+    if (host_control(drv, 0xC0, XID_REQ_GET_DESC, XID_REQ_GET_DESC_VALUE, 0, 16, NULL)) {
+        fail("device-recipient request was answered");
+    }
+
+    // SET_REPORT rumble on interface N lands on port N only
+    uint16_t want[PORTS][2] = {{0}};
+    for (uint8_t itf = 0; itf < PORTS; itf++) {
+        uint16_t l = (uint16_t)(0x1100 * (itf + 1)), r = (uint16_t)(0xFF00 - 0x1000 * itf);
+        uint8_t data[6];
+        rumble_bytes(l, r, data);
+        if (!host_control(drv, XID_REQ_SET_REPORT_TYPE, XID_REQ_SET_REPORT, XID_REQ_SET_REPORT_VAL,
+                          itf, 6, data)) {
+            fail("SET_REPORT on interface %u stalled", itf);
+        }
+        want[itf][0] = l;
+        want[itf][1] = r;
+        check_feedback("SET_REPORT", (const uint16_t (*)[2])want);
+    }
+
+    // OUT endpoint rumble on 0x01+N lands on port N only; short packets are dropped
+    for (int n = 0; n < 64; n++) {
+        uint8_t port = (uint8_t)(rnd() % PORTS);
+        uint16_t l = (uint16_t)rnd(), r = (uint16_t)rnd();
+        uint8_t data[6];
+        rumble_bytes(l, r, data);
+        bool shortpkt = (n % 8) == 7;
+        host_send_out(drv, (uint8_t)(0x01 + port), data, shortpkt ? 4 : 6);
+        if (!shortpkt) {
+            want[port][0] = l;
+            want[port][1] = r;
+        }
+        check_feedback(shortpkt ? "short OUT packet" : "OUT endpoint", (const uint16_t (*)[2])want);
+    }
+
+    output_feedback_t fb;
+    if (xid_mode_get_port_feedback(PORTS, &fb)) fail("feedback reported for port %u", PORTS);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "vs:n:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': report_count = (unsigned)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-s seed] [-n reports]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    check_descriptors();
+    check_enumeration();
+    check_reports();
+    check_control();
+
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
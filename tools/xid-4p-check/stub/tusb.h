@@ -0,0 +1,147 @@
+// tusb.h - minimal TinyUSB surface for building tud_xid.c and xid_mode.c on
+// the host. Only what those files, usbd_mode.h and xbox_og_descriptors.h
+// touch.
+
+#ifndef XID_4P_CHECK_TUSB_H
+#define XID_4P_CHECK_TUSB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "tusb_option.h"
+
+#define TU_ATTR_PACKED        __attribute__((packed))
+#define TU_BIT(n)             (1UL << (n))
+#define TU_MIN(a, b)          (((a) < (b)) ? (a) : (b))
+#define U16_TO_U8S_LE(u16)    (uint8_t)((u16) & 0xFF), (uint8_t)(((u16) >> 8) & 0xFF)
+#define CFG_TUD_MEM_ALIGN     __attribute__((aligned(4)))
+
+// TU_VERIFY(cond) returns false, TU_VERIFY(cond, ret) returns ret
+#define TU_VERIFY_1(_cond)        do { if (!(_cond)) return false; } while (0)
+#define TU_VERIFY_2(_cond, _ret)  do { if (!(_cond)) return _ret; } while (0)
+#define TU_VERIFY_PICK(_1, _2, _m, ...) _m
+#define TU_VERIFY(...) TU_VERIFY_PICK(__VA_ARGS__, TU_VERIFY_2, TU_VERIFY_1, _)(__VA_ARGS__)
+
+#define TU_LOG1(...)  do { } while (0)
+#define TU_LOG2(...)  do { } while (0)
+
+typedef enum {
+    TUSB_DESC_DEVICE        = 0x01,
+    TUSB_DESC_CONFIGURATION = 0x02,
+    TUSB_DESC_INTERFACE     = 0x04,
+    TUSB_DESC_ENDPOINT      = 0x05,
+} tusb_desc_type_t;
+
+typedef enum {
+    TUSB_XFER_INTERRUPT = 3,
+} tusb_xfer_type_t;
+
+typedef enum {
+    TUSB_DIR_OUT = 0,
+    TUSB_DIR_IN  = 1,
+} tusb_dir_t;
+
+typedef enum {
+    TUSB_REQ_RCPT_DEVICE    = 0,
+    TUSB_REQ_RCPT_INTERFACE = 1,
+    TUSB_REQ_RCPT_ENDPOINT  = 2,
+} tusb_request_recipient_t;
+
+enum {
+    CONTROL_STAGE_IDLE = 0,
+    CONTROL_STAGE_SETUP,
+    CONTROL_STAGE_DATA,
+    CONTROL_STAGE_ACK,
+};
+
+#define TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP  TU_BIT(5)
+
+typedef enum {
+    HID_REPORT_TYPE_INVALID = 0,
+    HID_REPORT_TYPE_INPUT,
+    HID_REPORT_TYPE_OUTPUT,
+    HID_REPORT_TYPE_FEATURE,
+} hid_report_type_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t  iManufacturer;
+    uint8_t  iProduct;
+    uint8_t  iSerialNumber;
+    uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bEndpointAddress;
+    uint8_t  bmAttributes;
+    uint16_t wMaxPacketSize;
+    uint8_t  bInterval;
+} tusb_desc_endpoint_t;
+
+typedef struct TU_ATTR_PACKED {
+    union {
+        struct TU_ATTR_PACKED {
+            uint8_t recipient : 5;
+            uint8_t type      : 2;
+            uint8_t direction : 1;
+        } bmRequestType_bit;
+        uint8_t bmRequestType;
+    };
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+typedef enum {
+    XFER_RESULT_SUCCESS = 0,
+    XFER_RESULT_FAILED,
+} xfer_result_t;
+
+#define TUD_CONFIG_DESC_LEN     9
+
+#define TUD_CONFIG_DESCRIPTOR(config_num, _itfcount, _stridx, _total_len, _attribute, _power_ma) \
+    9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(_total_len), _itfcount, config_num, _stridx, \
+    TU_BIT(7) | _attribute, (_power_ma) / 2
+
+static inline uint8_t const* tu_desc_next(void const* desc)
+{
+    uint8_t const* p = (uint8_t const*)desc;
+    return p + p[0];
+}
+
+static inline tusb_dir_t tu_edpt_dir(uint8_t addr)
+{
+    return (addr & 0x80) ? TUSB_DIR_IN : TUSB_DIR_OUT;
+}
+
+// Device stack, implemented by check.c against its simulated host
+bool tud_ready(void);
+bool tud_suspended(void);
+bool tud_remote_wakeup(void);
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const* request, void* buffer, uint16_t len);
+
+#endif // XID_4P_CHECK_TUSB_H
@@ -0,0 +1,17 @@
+// tusb_option.h - build options for building tud_xid.c and xid_mode.c on the
+// host: device stack on, XID on with enough ports for the four-port mode.
+
+#ifndef XID_4P_CHECK_TUSB_OPTION_H
+#define XID_4P_CHECK_TUSB_OPTION_H
+
+// tinyusb 0.20.0: usbd_edpt_xfer() without the is_isr argument
+#define TUSB_VERSION_MAJOR     0
+#define TUSB_VERSION_MINOR     20
+#define TUSB_VERSION_REVISION  0
+
+#define CFG_TUD_ENABLED    1
+#define CFG_TUD_XID        1
+#define CFG_TUD_XID_PORTS  4
+#define CFG_TUSB_DEBUG     0
+
+#endif // XID_4P_CHECK_TUSB_OPTION_H